@@ -8,9 +8,12 @@
 #include <chrono>
 
 #include <VRHI/CommandBuffer.hpp>
+#include <VRHI/CommandPool.hpp>
+#include <VRHI/FrameContext.hpp>
 #include <VRHI/Pipeline.hpp>
 #include <VRHI/Resources.hpp>
 #include <VRHI/Shader.hpp>
+#include <VRHI/Sync.hpp>
 #include <VRHI/VRHI.hpp>
 #include <VRHI/Window.hpp>
 
@@ -329,21 +332,6 @@ int main() {
         auto indexBuffer = std::move(*indexBufferResult);
         std::cout << "Index buffer created\n";
 
-        // Create uniform buffer for MVP matrix
-        std::cout << "Creating uniform buffer...\n";
-        VRHI::BufferDesc ubDesc{};
-        ubDesc.size = sizeof(Matrix4x4);
-        ubDesc.usage = VRHI::BufferUsage::Uniform;
-        ubDesc.memoryAccess = VRHI::MemoryAccess::CpuToGpu;
-
-        auto uniformBufferResult = device->CreateBuffer(ubDesc);
-        if (!uniformBufferResult) {
-            std::cerr << "Failed to create uniform buffer: " << uniformBufferResult.error().message << "\n";
-            return 1;
-        }
-        auto uniformBuffer = std::move(*uniformBufferResult);
-        std::cout << "Uniform buffer created\n";
-
         // Create shaders
         std::cout << "Creating shaders...\n";
 
@@ -357,12 +345,12 @@ int main() {
             layout (location = 1) out vec3 Normal;
             layout (location = 2) out vec2 TexCoord;
 
-            layout (std140, binding = 0) uniform UniformBufferObject {
+            layout (push_constant) uniform PushConstants {
                 mat4 mvp;
-            } ubo;
+            } pc;
 
             void main() {
-                gl_Position = ubo.mvp * vec4(aPos, 1.0);
+                gl_Position = pc.mvp * vec4(aPos, 1.0);
                 FragPos = aPos;
                 Normal = aNormal;
                 TexCoord = aTexCoord;
@@ -489,6 +477,10 @@ int main() {
         while (!window->ShouldClose()) {
             window->PollEvents();
 
+            // Waits only if the GPU is still on the frame that last used this
+            // context; its command buffers are recycled instead of reallocated
+            VRHI::FrameContext& frame = device->BeginFrame();
+
             // Calculate elapsed time
             auto currentTime = std::chrono::high_resolution_clock::now();
             float time = std::chrono::duration<float>(currentTime - startTime).count();
@@ -502,10 +494,9 @@ int main() {
             Matrix4x4 projection = Matrix4x4::Perspective(45.0f * 3.14159f / 180.0f, aspect, 0.1f, 100.0f);
             
             Matrix4x4 mvp = Matrix4x4::Multiply(projection, Matrix4x4::Multiply(view, model));
-            uniformBuffer->Update(&mvp, sizeof(Matrix4x4), 0);
 
-            // Create command buffer
-            auto cmd = device->CreateCommandBuffer();
+            // Get a command buffer from this frame's pool
+            VRHI::CommandBuffer* cmd = frame.GetCommandPool().Allocate();
             cmd->Begin();
 
             // Clear screen and depth buffer
@@ -550,8 +541,8 @@ int main() {
             // Bind pipeline
             cmd->BindPipeline(pipeline.get());
             
-            // Bind uniform buffer and texture
-            cmd->BindUniformBuffer(0, uniformBuffer.get());
+            // Push the MVP matrix and bind the texture
+            cmd->PushConstants(VRHI::ShaderStage::Vertex, 0, std::as_bytes(std::span(&mvp, 1)));
             cmd->BindTexture(1, texture.get(), sampler.get());
 
             // Bind vertex and index buffers
@@ -565,8 +556,9 @@ int main() {
 
             cmd->End();
 
-            // Submit and present
-            device->Submit(std::move(cmd));
+            // Submit, fence the frame and present
+            device->Submit(cmd);
+            device->EndFrame();
             window->SwapBuffers();
         }
 
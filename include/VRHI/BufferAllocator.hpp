@@ -0,0 +1,84 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "VRHI.hpp"
+#include "Resources.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <vector>
+
+namespace VRHI {
+
+// ============================================================================
+// Buffer Allocator
+// ============================================================================
+
+/// Sub-allocates long-lived buffers out of a few large ones.
+///
+/// Every combination of BufferUsage and MemoryAccess gets its own blocks of
+/// `blockSize` bytes, created on demand; Allocate() returns an aligned range
+/// of one of them as a BufferView. Thousands of meshes or constant blocks
+/// then live in a handful of API buffers, and binding them mostly changes
+/// offsets. Free ranges are tracked with a two-level segregated fit (TLSF)
+/// allocator, so allocating and freeing take constant time.
+///
+/// @code
+/// BufferAllocator allocator(*device);
+/// auto vertices = allocator.Allocate({.size = sizeof(mesh), .usage = BufferUsage::Vertex,
+///                                     .initialData = &mesh});
+/// cmd->BindVertexBuffers(0, std::span(&*vertices, 1));
+/// ...
+/// allocator.Free(*vertices);
+/// @endcode
+///
+/// Ranges larger than half a block get a buffer of their own. A block that
+/// becomes empty is released unless it is the last one of its class. Views
+/// must be freed before the allocator is destroyed, and the GPU must be done
+/// with a range before it is freed. The allocator is not thread-safe.
+class BufferAllocator {
+public:
+    static constexpr uint64_t DefaultBlockSize = 16ull << 20;
+
+    explicit BufferAllocator(Device& device, uint64_t blockSize = DefaultBlockSize);
+    ~BufferAllocator();
+
+    // Buffer allocator cannot be copied
+    BufferAllocator(const BufferAllocator&) = delete;
+    BufferAllocator& operator=(const BufferAllocator&) = delete;
+
+    /// Allocate a range described like a buffer; `initialData` is uploaded into it
+    /// @param alignment Offset alignment; 0 uses the device's minimum alignment
+    ///        for the usage (at least 16 bytes)
+    std::expected<BufferView, Error> Allocate(const BufferDesc& desc, uint64_t alignment = 0);
+
+    /// Release a range returned by Allocate()
+    void Free(const BufferView& view);
+
+    /// Bytes handed out, with sizes rounded up to 16 bytes
+    uint64_t GetAllocatedBytes() const noexcept { return m_allocatedBytes; }
+
+    /// Size of all blocks and dedicated buffers
+    uint64_t GetReservedBytes() const noexcept;
+
+    /// Buffers created, including dedicated ones
+    size_t GetBlockCount() const noexcept { return m_blocks.size(); }
+
+private:
+    struct Block;
+
+    /// Default offset alignment of a usage class
+    uint64_t GetAlignment(BufferUsage usage) const noexcept;
+
+    std::expected<Block*, Error> CreateBlock(const BufferDesc& desc, uint64_t size, bool dedicated);
+
+    Device* m_device;
+    uint64_t m_blockSize;
+    std::vector<std::unique_ptr<Block>> m_blocks;
+    uint64_t m_allocatedBytes = 0;
+};
+
+} // namespace VRHI
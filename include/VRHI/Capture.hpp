@@ -0,0 +1,80 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "VRHI.hpp"
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+
+namespace VRHI {
+
+// ============================================================================
+// Capture
+// ============================================================================
+
+/// Wrap a device so that everything done through it is written to a trace.
+///
+/// The returned device forwards every call to `device`. Resource creations
+/// (including initial data and shader code), buffer and texture uploads,
+/// writes through mapped buffers, recorded command buffers, submissions and
+/// presents are appended to the binary trace at `tracePath`. Fences and
+/// semaphores are passed through but not captured.
+///
+/// @code
+/// auto device = VRHI::CreateDevice(config);
+/// auto captured = VRHI::CreateCaptureDevice(std::move(*device), "frame.vrhitrace");
+/// @endcode
+///
+/// @return Capturing device, or an error if the trace file cannot be opened
+std::expected<std::unique_ptr<Device>, Error>
+CreateCaptureDevice(std::unique_ptr<Device> device, const std::filesystem::path& tracePath);
+
+// ============================================================================
+// Replay
+// ============================================================================
+
+/// Totals of a loaded trace
+struct TraceStats {
+    uint32_t frameCount = 0;
+    uint32_t resourceCount = 0;       // Buffers, textures, samplers, shaders, pipelines, render passes, framebuffers
+    uint32_t commandBufferCount = 0;  // Distinct command buffers recorded
+    uint64_t commandCount = 0;        // Commands recorded over all frames
+    uint64_t uploadBytes = 0;         // Buffer and texture update bytes over all frames
+};
+
+/// Replays a trace written by a capture device on any device.
+///
+/// Prepare() creates every resource of the trace up front. A frame is
+/// everything between two Device::Present() calls of the captured
+/// application; ReplayFrame() re-issues its uploads, recordings and
+/// submissions, so frames can be replayed any number of times and in any
+/// order, e.g. in a tight loop to measure backend CPU overhead.
+class TracePlayer {
+public:
+    /// Read a trace file into memory
+    static std::expected<std::unique_ptr<TracePlayer>, Error>
+    Load(const std::filesystem::path& tracePath);
+
+    virtual ~TracePlayer() = default;
+
+    // Trace player cannot be copied
+    TracePlayer(const TracePlayer&) = delete;
+    TracePlayer& operator=(const TracePlayer&) = delete;
+
+    virtual const TraceStats& GetStats() const noexcept = 0;
+
+    /// Create the resources and command buffers of the trace on `device`,
+    /// which must outlive the player. Must succeed before ReplayFrame().
+    virtual std::expected<void, Error> Prepare(Device& device) = 0;
+
+    /// Replay one frame, ending with Device::Present() if the captured frame did
+    virtual void ReplayFrame(uint32_t frame) = 0;
+
+protected:
+    TracePlayer() = default;
+};
+
+} // namespace VRHI
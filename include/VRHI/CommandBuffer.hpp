@@ -3,7 +3,12 @@
 
 #pragma once
 
+#include "VRHI.hpp"
 #include "Resources.hpp"
+#include "Shader.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <span>
 
@@ -93,6 +98,20 @@ struct ClearDepthStencilValue {
     uint32_t stencil = 0;
 };
 
+/// Clear value of one render pass attachment; `color` is used for color
+/// attachments and `depthStencil` for the depth/stencil attachment
+struct ClearValue {
+    ClearColorValue color;
+    ClearDepthStencilValue depthStencil;
+};
+
+// ============================================================================
+// Push Constants
+// ============================================================================
+
+/// Size of the push constant block available to shaders on every backend
+inline constexpr uint32_t MaxPushConstantSize = 128;
+
 // ============================================================================
 // Command Buffer Interface
 // ============================================================================
@@ -124,16 +143,25 @@ public:
     /// Get current command buffer state
     virtual CommandBufferState GetState() const noexcept = 0;
     
+    /// Get whether this is a primary or a secondary command buffer
+    virtual CommandBufferLevel GetLevel() const noexcept = 0;
+    
     // ========================================================================
     // Render Pass
     // ========================================================================
     
     /// Begin a render pass
+    /// Attachments with AttachmentLoadOp::Clear are cleared within `renderArea`;
+    /// a null framebuffer renders to the swap chain's back buffer.
+    /// @param clearValues Indexed like RenderPassDesc::attachments; attachments
+    ///        without an entry are cleared to zero (depth to 1)
     virtual void BeginRenderPass(RenderPass* renderPass, 
                                 Framebuffer* framebuffer,
-                                const Rect2D& renderArea) = 0;
+                                const Rect2D& renderArea,
+                                std::span<const ClearValue> clearValues = {}) = 0;
     
     /// End current render pass
+    /// Attachment contents with AttachmentStoreOp::DontCare are undefined afterwards
     virtual void EndRenderPass() = 0;
     
     // ========================================================================
@@ -160,9 +188,56 @@ public:
     virtual void BindUniformBuffer(uint32_t binding, Buffer* buffer, 
                                    uint64_t offset = 0, uint64_t size = 0) = 0;
     
+    /// Bind a storage buffer (`buffer` block in GLSL) to binding point
+    /// Requires Feature::Compute; a size of 0 binds the rest of the buffer
+    virtual void BindStorageBuffer(uint32_t binding, Buffer* buffer,
+                                   uint64_t offset = 0, uint64_t size = 0) = 0;
+    
     /// Bind texture to binding point
     virtual void BindTexture(uint32_t binding, Texture* texture, Sampler* sampler = nullptr) = 0;
     
+    /// Bind buffer views (e.g. BufferAllocator sub-allocations) as vertex buffers
+    void BindVertexBuffers(uint32_t firstBinding, std::span<const BufferView> views) {
+        constexpr size_t BatchSize = 16;
+        for (size_t first = 0; first < views.size(); first += BatchSize) {
+            const size_t count = std::min(BatchSize, views.size() - first);
+            std::array<Buffer*, BatchSize> buffers;
+            std::array<uint64_t, BatchSize> offsets;
+            for (size_t i = 0; i < count; ++i) {
+                buffers[i] = views[first + i].buffer;
+                offsets[i] = views[first + i].offset;
+            }
+            BindVertexBuffers(firstBinding + static_cast<uint32_t>(first),
+                              std::span(buffers.data(), count), std::span(offsets.data(), count));
+        }
+    }
+    
+    /// Bind a buffer view as index buffer
+    void BindIndexBuffer(const BufferView& view, bool use16BitIndices = false) {
+        BindIndexBuffer(view.buffer, view.offset, use16BitIndices);
+    }
+    
+    /// Bind a buffer view as uniform buffer; the binding covers the view
+    void BindUniformBuffer(uint32_t binding, const BufferView& view) {
+        BindUniformBuffer(binding, view.buffer, view.offset, view.size);
+    }
+    
+    /// Bind a buffer view as storage buffer; the binding covers the view
+    void BindStorageBuffer(uint32_t binding, const BufferView& view) {
+        BindStorageBuffer(binding, view.buffer, view.offset, view.size);
+    }
+    
+    // ========================================================================
+    // Push Constants
+    // ========================================================================
+    
+    /// Update bytes [offset, offset + data.size()) of the push constant block
+    /// (`layout(push_constant) uniform` in GLSL) read by `stages`. Values stay
+    /// set for all following draws until overwritten; offset + size must not
+    /// exceed MaxPushConstantSize. Contents are undefined at the start of a
+    /// command buffer and after ExecuteCommands.
+    virtual void PushConstants(ShaderStage stages, uint32_t offset, std::span<const std::byte> data) = 0;
+    
     // ========================================================================
     // Dynamic State
     // ========================================================================
@@ -245,12 +320,12 @@ public:
     // Clear Commands
     // ========================================================================
     
-    /// Clear color attachment
+    /// Clear `rect` of a color attachment of the current framebuffer
     virtual void ClearColorAttachment(uint32_t attachment,
                                      const ClearColorValue& color,
                                      const Rect2D& rect) = 0;
     
-    /// Clear depth/stencil attachment
+    /// Clear `rect` of the depth/stencil attachment of the current framebuffer
     virtual void ClearDepthStencilAttachment(const ClearDepthStencilValue& value,
                                             const Rect2D& rect) = 0;
     
@@ -278,6 +353,17 @@ public:
                             uint32_t srcMipLevel = 0, uint32_t srcArrayLayer = 0,
                             uint32_t dstMipLevel = 0, uint32_t dstArrayLayer = 0) = 0;
     
+    // ========================================================================
+    // Secondary Command Buffers
+    // ========================================================================
+    
+    /// Execute secondary command buffers inline (primary command buffers only).
+    /// Secondaries may be recorded on any thread. They are referenced, not
+    /// copied: each must stay alive and unchanged until this command buffer
+    /// has been submitted, and may be executed again in later frames without
+    /// being re-recorded. Bound state is undefined after this call.
+    virtual void ExecuteCommands(std::span<CommandBuffer* const> secondaries) = 0;
+    
     // ========================================================================
     // Synchronization
     // ========================================================================
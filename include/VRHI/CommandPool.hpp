@@ -0,0 +1,65 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "VRHI.hpp"
+#include <cstdint>
+
+namespace VRHI {
+
+// Forward declarations
+class CommandBuffer;
+
+// ============================================================================
+// Command Pool Interface
+// ============================================================================
+
+/// Recycles command buffers across frames.
+///
+/// Buffers handed out by Allocate() are owned by the pool and stay valid
+/// until the pool is destroyed. Reset() returns all of them to the pool at
+/// once while keeping their recording memory, so once a pool has been warmed
+/// up recording a frame performs no heap allocations. Use one pool per frame
+/// in flight and reset it after the fence of that frame's submission has
+/// signaled:
+///
+/// @code
+/// frameFence[i]->Wait();
+/// frameFence[i]->Reset();
+/// pools[i]->Reset();
+/// CommandBuffer* cmd = pools[i]->Allocate();
+/// cmd->Begin();
+/// // ... record ...
+/// cmd->End();
+/// device->Submit(cmd, frameFence[i].get());
+/// @endcode
+///
+/// A pool must only be used from one thread at a time.
+class CommandPool {
+public:
+    virtual ~CommandPool() = default;
+
+    // Command pool cannot be copied
+    CommandPool(const CommandPool&) = delete;
+    CommandPool& operator=(const CommandPool&) = delete;
+
+    /// Get a command buffer in the Initial state
+    /// @return Pool-owned command buffer, or nullptr if the device cannot create one
+    virtual CommandBuffer* Allocate(CommandBufferLevel level = CommandBufferLevel::Primary) = 0;
+
+    /// Return every allocated command buffer to the pool.
+    /// The GPU must be done with them, i.e. the fence of their submission has signaled.
+    virtual void Reset() = 0;
+
+    /// Number of command buffers handed out since the last Reset()
+    virtual uint32_t GetAllocatedCount() const noexcept = 0;
+
+    /// Number of command buffers owned by the pool
+    virtual uint32_t GetCapacity() const noexcept = 0;
+
+protected:
+    CommandPool() = default;
+};
+
+} // namespace VRHI
@@ -0,0 +1,483 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "CommandBuffer.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+
+namespace VRHI {
+
+class Pipeline;
+class RenderPass;
+class Framebuffer;
+
+// ============================================================================
+// Command Types
+// ============================================================================
+
+enum class CommandType : uint16_t {
+    BeginRenderPass,
+    EndRenderPass,
+    BindPipeline,
+    BindVertexBuffers,
+    BindIndexBuffer,
+    BindUniformBuffer,
+    BindTexture,
+    SetViewports,
+    SetScissors,
+    SetLineWidth,
+    SetBlendConstants,
+    SetDepthBias,
+    SetDepthBounds,
+    SetStencilCompareMask,
+    SetStencilWriteMask,
+    SetStencilReference,
+    Draw,
+    DrawIndexed,
+    DrawIndirect,
+    DrawIndexedIndirect,
+    Dispatch,
+    DispatchIndirect,
+    ClearColorAttachment,
+    ClearDepthStencilAttachment,
+    CopyBuffer,
+    CopyBufferToTexture,
+    CopyTextureToBuffer,
+    CopyTexture,
+    PipelineBarrier,
+    BeginDebugMarker,
+    EndDebugMarker,
+    InsertDebugMarker,
+    ExecuteCommands,
+    PushConstants,
+    BindStorageBuffer,
+};
+
+/// Header preceding every command in a stream.
+/// `size` covers the header, the command struct and any trailing data, so a
+/// reader can skip commands it does not understand.
+struct CommandHeader {
+    CommandType type;
+    uint16_t reserved = 0;
+    uint32_t size = 0;
+
+    /// Payload of the command following this header
+    template<typename T>
+    const T& As() const noexcept {
+        return *reinterpret_cast<const T*>(this + 1);
+    }
+
+    template<typename T>
+    T& As() noexcept {
+        return *reinterpret_cast<T*>(this + 1);
+    }
+};
+
+// ============================================================================
+// Command Payloads
+// ============================================================================
+//
+// All payloads are trivially copyable. Resources are referenced by pointer and
+// resolved to backend handles at replay time. Variable-length data (spans,
+// strings) is stored directly after the payload; see GetTrailingData().
+
+/// Trailing data: ClearValue[clearValueCount]
+struct CmdBeginRenderPass {
+    static constexpr CommandType Type = CommandType::BeginRenderPass;
+    RenderPass* renderPass;
+    Framebuffer* framebuffer;
+    Rect2D renderArea;
+    uint32_t clearValueCount;
+
+    std::span<const ClearValue> GetClearValues() const noexcept;
+};
+
+struct CmdEndRenderPass {
+    static constexpr CommandType Type = CommandType::EndRenderPass;
+};
+
+struct CmdBindPipeline {
+    static constexpr CommandType Type = CommandType::BindPipeline;
+    Pipeline* pipeline;
+};
+
+/// Trailing data: Buffer*[bufferCount], then uint64_t offsets[bufferCount]
+struct CmdBindVertexBuffers {
+    static constexpr CommandType Type = CommandType::BindVertexBuffers;
+    uint32_t firstBinding;
+    uint32_t bufferCount;
+
+    std::span<Buffer* const> GetBuffers() const noexcept;
+    std::span<const uint64_t> GetOffsets() const noexcept;
+};
+
+struct CmdBindIndexBuffer {
+    static constexpr CommandType Type = CommandType::BindIndexBuffer;
+    Buffer* buffer;
+    uint64_t offset;
+    bool use16BitIndices;
+};
+
+struct CmdBindUniformBuffer {
+    static constexpr CommandType Type = CommandType::BindUniformBuffer;
+    uint32_t binding;
+    Buffer* buffer;
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct CmdBindStorageBuffer {
+    static constexpr CommandType Type = CommandType::BindStorageBuffer;
+    uint32_t binding;
+    Buffer* buffer;
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct CmdBindTexture {
+    static constexpr CommandType Type = CommandType::BindTexture;
+    uint32_t binding;
+    Texture* texture;
+    Sampler* sampler;
+};
+
+/// Trailing data: std::byte[size]
+struct CmdPushConstants {
+    static constexpr CommandType Type = CommandType::PushConstants;
+    ShaderStage stages;
+    uint32_t offset;
+    uint32_t size;
+
+    std::span<const std::byte> GetData() const noexcept;
+};
+
+/// Trailing data: Viewport[count]
+struct CmdSetViewports {
+    static constexpr CommandType Type = CommandType::SetViewports;
+    uint32_t count;
+
+    std::span<const Viewport> GetViewports() const noexcept;
+};
+
+/// Trailing data: Rect2D[count]
+struct CmdSetScissors {
+    static constexpr CommandType Type = CommandType::SetScissors;
+    uint32_t count;
+
+    std::span<const Rect2D> GetScissors() const noexcept;
+};
+
+struct CmdSetLineWidth {
+    static constexpr CommandType Type = CommandType::SetLineWidth;
+    float width;
+};
+
+struct CmdSetBlendConstants {
+    static constexpr CommandType Type = CommandType::SetBlendConstants;
+    float constants[4];
+};
+
+struct CmdSetDepthBias {
+    static constexpr CommandType Type = CommandType::SetDepthBias;
+    float constantFactor;
+    float clamp;
+    float slopeFactor;
+};
+
+struct CmdSetDepthBounds {
+    static constexpr CommandType Type = CommandType::SetDepthBounds;
+    float minDepth;
+    float maxDepth;
+};
+
+/// Shared payload of the three stencil dynamic state commands
+struct CmdSetStencilValue {
+    bool frontFace;
+    uint32_t value;
+};
+
+struct CmdSetStencilCompareMask : CmdSetStencilValue {
+    static constexpr CommandType Type = CommandType::SetStencilCompareMask;
+};
+
+struct CmdSetStencilWriteMask : CmdSetStencilValue {
+    static constexpr CommandType Type = CommandType::SetStencilWriteMask;
+};
+
+struct CmdSetStencilReference : CmdSetStencilValue {
+    static constexpr CommandType Type = CommandType::SetStencilReference;
+};
+
+struct CmdDraw {
+    static constexpr CommandType Type = CommandType::Draw;
+    DrawParams params;
+};
+
+struct CmdDrawIndexed {
+    static constexpr CommandType Type = CommandType::DrawIndexed;
+    DrawIndexedParams params;
+};
+
+/// Shared payload of the indirect draw commands
+struct CmdDrawIndirectBase {
+    Buffer* buffer;
+    uint64_t offset;
+    uint32_t drawCount;
+    uint32_t stride;
+};
+
+struct CmdDrawIndirect : CmdDrawIndirectBase {
+    static constexpr CommandType Type = CommandType::DrawIndirect;
+};
+
+struct CmdDrawIndexedIndirect : CmdDrawIndirectBase {
+    static constexpr CommandType Type = CommandType::DrawIndexedIndirect;
+};
+
+struct CmdDispatch {
+    static constexpr CommandType Type = CommandType::Dispatch;
+    DispatchParams params;
+};
+
+struct CmdDispatchIndirect {
+    static constexpr CommandType Type = CommandType::DispatchIndirect;
+    Buffer* buffer;
+    uint64_t offset;
+};
+
+struct CmdClearColorAttachment {
+    static constexpr CommandType Type = CommandType::ClearColorAttachment;
+    uint32_t attachment;
+    ClearColorValue color;
+    Rect2D rect;
+};
+
+struct CmdClearDepthStencilAttachment {
+    static constexpr CommandType Type = CommandType::ClearDepthStencilAttachment;
+    ClearDepthStencilValue value;
+    Rect2D rect;
+};
+
+struct CmdCopyBuffer {
+    static constexpr CommandType Type = CommandType::CopyBuffer;
+    Buffer* src;
+    Buffer* dst;
+    uint64_t srcOffset;
+    uint64_t dstOffset;
+    uint64_t size;
+};
+
+struct CmdCopyBufferToTexture {
+    static constexpr CommandType Type = CommandType::CopyBufferToTexture;
+    Buffer* src;
+    Texture* dst;
+    uint32_t mipLevel;
+    uint32_t arrayLayer;
+};
+
+struct CmdCopyTextureToBuffer {
+    static constexpr CommandType Type = CommandType::CopyTextureToBuffer;
+    Texture* src;
+    Buffer* dst;
+    uint32_t mipLevel;
+    uint32_t arrayLayer;
+};
+
+struct CmdCopyTexture {
+    static constexpr CommandType Type = CommandType::CopyTexture;
+    Texture* src;
+    Texture* dst;
+    uint32_t srcMipLevel;
+    uint32_t srcArrayLayer;
+    uint32_t dstMipLevel;
+    uint32_t dstArrayLayer;
+};
+
+struct CmdPipelineBarrier {
+    static constexpr CommandType Type = CommandType::PipelineBarrier;
+};
+
+/// Trailing data: null-terminated name. Used by Begin/InsertDebugMarker.
+struct CmdDebugMarker {
+    float color[4];
+    bool hasColor;
+
+    const char* GetName() const noexcept;
+};
+
+struct CmdBeginDebugMarker : CmdDebugMarker {
+    static constexpr CommandType Type = CommandType::BeginDebugMarker;
+};
+
+struct CmdInsertDebugMarker : CmdDebugMarker {
+    static constexpr CommandType Type = CommandType::InsertDebugMarker;
+};
+
+struct CmdEndDebugMarker {
+    static constexpr CommandType Type = CommandType::EndDebugMarker;
+};
+
+/// Trailing data: CommandBuffer*[count] (secondaries, referenced not copied)
+struct CmdExecuteCommands {
+    static constexpr CommandType Type = CommandType::ExecuteCommands;
+    uint32_t count;
+
+    std::span<CommandBuffer* const> GetCommandBuffers() const noexcept;
+};
+
+// ============================================================================
+// Command Stream
+// ============================================================================
+
+/// Linear arena of POD commands.
+///
+/// Commands are written back to back into one contiguous allocation which is
+/// kept across Reset(), so a command buffer that is re-recorded every frame
+/// stops allocating once it has reached its steady-state size. Recording
+/// touches no API state and may happen on any thread; replay is done by the
+/// backend that owns the stream.
+class CommandStream {
+public:
+    static constexpr size_t Alignment = 8;
+
+    CommandStream() = default;
+    ~CommandStream() = default;
+
+    CommandStream(const CommandStream&) = delete;
+    CommandStream& operator=(const CommandStream&) = delete;
+    CommandStream(CommandStream&&) noexcept = default;
+    CommandStream& operator=(CommandStream&&) noexcept = default;
+
+    /// Append a command of type T followed by `trailingBytes` of extra storage.
+    /// The returned reference is valid until the next Emit() or Reset().
+    template<typename T>
+    T& Emit(size_t trailingBytes = 0) {
+        static_assert(std::is_trivially_copyable_v<T>, "Commands must be trivially copyable");
+        static_assert(alignof(T) <= Alignment, "Command alignment exceeds stream alignment");
+
+        const size_t size = AlignUp(sizeof(CommandHeader) + PayloadSize<T>() + trailingBytes);
+        std::byte* ptr = Allocate(size);
+        auto* header = new (ptr) CommandHeader{T::Type, 0, static_cast<uint32_t>(size)};
+        ++m_commandCount;
+        return *new (header + 1) T{};
+    }
+
+    /// Rewind the stream, keeping its storage
+    void Reset() noexcept {
+        m_size = 0;
+        m_commandCount = 0;
+    }
+
+    /// Pre-allocate storage for `bytes` of commands
+    void Reserve(size_t bytes);
+
+    [[nodiscard]] bool IsEmpty() const noexcept { return m_commandCount == 0; }
+    [[nodiscard]] size_t GetCommandCount() const noexcept { return m_commandCount; }
+    [[nodiscard]] size_t GetSize() const noexcept { return m_size; }
+    [[nodiscard]] size_t GetCapacity() const noexcept { return m_capacity; }
+
+    /// Raw bytes of the recorded commands, e.g. for copying them elsewhere
+    [[nodiscard]] std::span<const std::byte> GetData() const noexcept { return {m_data.get(), m_size}; }
+
+    /// Forward iterator over the command headers of a stream
+    class Iterator {
+    public:
+        explicit Iterator(const std::byte* ptr) noexcept : m_ptr(ptr) {}
+
+        const CommandHeader& operator*() const noexcept {
+            return *reinterpret_cast<const CommandHeader*>(m_ptr);
+        }
+        const CommandHeader* operator->() const noexcept { return &**this; }
+
+        Iterator& operator++() noexcept {
+            m_ptr += (**this).size;
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const noexcept = default;
+
+    private:
+        const std::byte* m_ptr;
+    };
+
+    [[nodiscard]] Iterator begin() const noexcept { return Iterator(m_data.get()); }
+    [[nodiscard]] Iterator end() const noexcept { return Iterator(m_data.get() + m_size); }
+
+    /// Offset of the payload's trailing data, relative to the payload start
+    template<typename T>
+    static constexpr size_t PayloadSize() noexcept {
+        return AlignUp(sizeof(T));
+    }
+
+    /// Trailing data stored after a payload emitted with Emit<T>(trailingBytes)
+    template<typename U, typename T>
+    static U* GetTrailingData(T& payload) noexcept {
+        using Byte = std::conditional_t<std::is_const_v<T>, const std::byte, std::byte>;
+        return reinterpret_cast<U*>(reinterpret_cast<Byte*>(&payload) + PayloadSize<std::remove_const_t<T>>());
+    }
+
+    static constexpr size_t AlignUp(size_t value) noexcept {
+        return (value + Alignment - 1) & ~(Alignment - 1);
+    }
+
+private:
+    std::byte* Allocate(size_t size) {
+        if (m_size + size > m_capacity) {
+            Grow(m_size + size);
+        }
+        std::byte* ptr = m_data.get() + m_size;
+        m_size += size;
+        return ptr;
+    }
+
+    void Grow(size_t required);
+
+    std::unique_ptr<std::byte[]> m_data;
+    size_t m_size = 0;
+    size_t m_capacity = 0;
+    size_t m_commandCount = 0;
+};
+
+// ============================================================================
+// Trailing Data Accessors
+// ============================================================================
+
+inline std::span<Buffer* const> CmdBindVertexBuffers::GetBuffers() const noexcept {
+    return {CommandStream::GetTrailingData<Buffer* const>(*this), bufferCount};
+}
+
+inline std::span<const uint64_t> CmdBindVertexBuffers::GetOffsets() const noexcept {
+    return {reinterpret_cast<const uint64_t*>(GetBuffers().data() + bufferCount), bufferCount};
+}
+
+inline std::span<const ClearValue> CmdBeginRenderPass::GetClearValues() const noexcept {
+    return {CommandStream::GetTrailingData<const ClearValue>(*this), clearValueCount};
+}
+
+inline std::span<const std::byte> CmdPushConstants::GetData() const noexcept {
+    return {CommandStream::GetTrailingData<const std::byte>(*this), size};
+}
+
+inline std::span<const Viewport> CmdSetViewports::GetViewports() const noexcept {
+    return {CommandStream::GetTrailingData<const Viewport>(*this), count};
+}
+
+inline std::span<const Rect2D> CmdSetScissors::GetScissors() const noexcept {
+    return {CommandStream::GetTrailingData<const Rect2D>(*this), count};
+}
+
+inline const char* CmdDebugMarker::GetName() const noexcept {
+    return CommandStream::GetTrailingData<const char>(*this);
+}
+
+inline std::span<CommandBuffer* const> CmdExecuteCommands::GetCommandBuffers() const noexcept {
+    return {CommandStream::GetTrailingData<CommandBuffer* const>(*this), count};
+}
+
+} // namespace VRHI
@@ -0,0 +1,174 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "CommandBuffer.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace VRHI {
+
+// Forward declarations
+class Pipeline;
+class Buffer;
+class Texture;
+class Sampler;
+
+// ============================================================================
+// Sort Keys
+// ============================================================================
+
+/// Build a draw sort key. Draws are emitted in ascending key order, so the
+/// fields are ordered by how expensive a change of them is:
+///
+///   63..56 layer     render order (opaque, sky, transparent, UI, ...)
+///   55..40 pipeline  application-assigned pipeline index
+///   39..16 material  application-assigned texture/material set index (24 bits)
+///   15..0  depth     quantized view depth, see QuantizeSortDepth()
+constexpr uint64_t MakeDrawSortKey(uint8_t layer, uint16_t pipeline,
+                                   uint32_t material, uint16_t depth) noexcept {
+    return (static_cast<uint64_t>(layer) << 56) |
+           (static_cast<uint64_t>(pipeline) << 40) |
+           (static_cast<uint64_t>(material & 0xFFFFFFu) << 16) |
+           static_cast<uint64_t>(depth);
+}
+
+/// Quantize a view depth in [nearZ, farZ] to 16 bits for MakeDrawSortKey().
+/// Front to back for opaque draws, back to front for blended ones.
+constexpr uint16_t QuantizeSortDepth(float depth, float nearZ, float farZ,
+                                     bool backToFront = false) noexcept {
+    float t = farZ > nearZ ? (depth - nearZ) / (farZ - nearZ) : 0.0f;
+    t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+    const auto quantized = static_cast<uint16_t>(t * 65535.0f + 0.5f);
+    return backToFront ? static_cast<uint16_t>(0xFFFF - quantized) : quantized;
+}
+
+// ============================================================================
+// Draw Items
+// ============================================================================
+
+inline constexpr uint32_t MaxDrawVertexBuffers = 4;
+inline constexpr uint32_t MaxDrawUniformBuffers = 4;
+inline constexpr uint32_t MaxDrawTextures = 8;
+
+struct DrawUniformBinding {
+    uint32_t binding = 0;
+    Buffer* buffer = nullptr;
+    uint64_t offset = 0;
+    uint64_t size = 0;  // 0 = whole buffer
+};
+
+struct DrawTextureBinding {
+    uint32_t binding = 0;
+    Texture* texture = nullptr;
+    Sampler* sampler = nullptr;
+};
+
+/// Everything needed to issue one draw. Indexed if `indexBuffer` is set,
+/// in which case `indexed` is used, otherwise `vertices`.
+struct DrawItem {
+    Pipeline* pipeline = nullptr;
+
+    std::array<Buffer*, MaxDrawVertexBuffers> vertexBuffers{};  // Bindings 0..vertexBufferCount-1
+    std::array<uint64_t, MaxDrawVertexBuffers> vertexOffsets{};
+    uint32_t vertexBufferCount = 0;
+
+    Buffer* indexBuffer = nullptr;
+    uint64_t indexOffset = 0;
+    bool use16BitIndices = false;
+
+    std::array<DrawUniformBinding, MaxDrawUniformBuffers> uniformBuffers{};
+    uint32_t uniformBufferCount = 0;
+
+    std::array<DrawTextureBinding, MaxDrawTextures> textures{};
+    uint32_t textureCount = 0;
+
+    DrawParams vertices;
+    DrawIndexedParams indexed;
+};
+
+/// Commands issued by DrawList::Emit()
+struct DrawListStats {
+    uint32_t drawCount = 0;
+    uint32_t pipelineBinds = 0;
+    uint32_t vertexBufferBinds = 0;
+    uint32_t indexBufferBinds = 0;
+    uint32_t uniformBufferBinds = 0;
+    uint32_t textureBinds = 0;
+};
+
+// ============================================================================
+// Draw List
+// ============================================================================
+
+/// Collects draws in scene traversal order and emits them sorted by key.
+///
+/// Sort() orders the draws by their 64-bit key with a parallel LSD radix
+/// sort; draws with equal keys keep their submission order. Emit() then
+/// records them into a command buffer, skipping every pipeline, vertex
+/// buffer, index buffer, uniform buffer and texture bind that would not
+/// change the bound state. Keys that group draws by pipeline and material
+/// (see MakeDrawSortKey()) minimize the binds that remain.
+///
+/// @code
+/// drawList.Clear();
+/// for (const Object& object : visibleObjects) {
+///     drawList.Add(MakeDrawSortKey(0, object.pipelineIndex, object.materialIndex,
+///                                  QuantizeSortDepth(object.viewDepth, nearZ, farZ)),
+///                  object.draw);
+/// }
+/// drawList.Sort();
+/// drawList.Emit(*cmd);
+/// @endcode
+///
+/// Clear() keeps the allocated memory, so a draw list reused every frame
+/// stops allocating once warmed up. A draw list must only be used from one
+/// thread at a time; Sort() spreads its work over worker threads itself.
+class DrawList {
+public:
+    DrawList() = default;
+
+    /// Reserve memory for `count` draws
+    void Reserve(size_t count);
+
+    /// Remove all draws, keeping the allocated memory
+    void Clear() noexcept;
+
+    /// Add a draw. Referenced objects must stay alive until Emit().
+    void Add(uint64_t sortKey, const DrawItem& item);
+
+    /// Number of draws added since the last Clear()
+    size_t GetSize() const noexcept { return m_items.size(); }
+
+    /// Sort the draws by key.
+    /// @param threadCount Worker threads to use, 0 for one per hardware thread.
+    ///                    Small lists are always sorted on the calling thread.
+    void Sort(uint32_t threadCount = 0);
+
+    /// Sort key of the i-th draw in emission order
+    uint64_t GetSortedKey(size_t index) const noexcept { return m_order[index].key; }
+
+    /// Submission index of the i-th draw in emission order
+    size_t GetSortedIndex(size_t index) const noexcept { return static_cast<size_t>(m_order[index].index); }
+
+    /// Record the draws into `cmd` in emission order (submission order if
+    /// Sort() was not called). `cmd` must be recording inside a render pass;
+    /// no state is assumed to be bound beforehand.
+    DrawListStats Emit(CommandBuffer& cmd) const;
+
+private:
+    /// Entry of the sort order; 16 bytes so that sorting never moves DrawItems
+    struct SortEntry {
+        uint64_t key;
+        uint64_t index;
+    };
+
+    std::vector<DrawItem> m_items;
+    std::vector<SortEntry> m_order;
+    std::vector<SortEntry> m_scratch;  // Radix sort ping-pong buffer
+};
+
+} // namespace VRHI
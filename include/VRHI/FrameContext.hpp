@@ -0,0 +1,100 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "VRHI.hpp"
+#include "CommandPool.hpp"
+#include "Sync.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace VRHI {
+
+// ============================================================================
+// Frame Context
+// ============================================================================
+
+/// Resources of one frame in flight, handed out by Device::BeginFrame().
+///
+/// A device keeps DeviceConfig::maxFramesInFlight contexts and uses them in
+/// turn. Everything a context owns is recycled when it comes around again,
+/// once the fence EndFrame() signaled for it has completed, so the CPU runs
+/// at most that many frames ahead of the GPU:
+///
+/// @code
+/// while (running) {
+///     FrameContext& frame = device->BeginFrame();
+///     CommandBuffer* cmd = frame.GetCommandPool().Allocate();
+///     cmd->Begin();
+///     // ... record, using frame.GetTransientAllocator() for dynamic data ...
+///     cmd->End();
+///     device->Submit(cmd);
+///     frame.DeferDelete(std::move(oldMesh));  // still read by submitted draws
+///     device->EndFrame();
+/// }
+/// @endcode
+///
+/// Slices of the device's transient allocator are per frame already, since
+/// EndFrame() ends the allocator's frame through Present(). A context must
+/// only be used from the thread that drives the frames.
+class FrameContext {
+public:
+    ~FrameContext();
+
+    // Frame context cannot be copied
+    FrameContext(const FrameContext&) = delete;
+    FrameContext& operator=(const FrameContext&) = delete;
+
+    /// Slot of the context, in [0, Device::GetMaxFramesInFlight())
+    uint32_t GetIndex() const noexcept { return m_index; }
+
+    /// Number of the frame, counting every BeginFrame() from 0
+    uint64_t GetFrameNumber() const noexcept { return m_frameNumber; }
+
+    /// Pool reset when the context is reused; allocate the frame's command buffers here
+    CommandPool& GetCommandPool() noexcept { return *m_commandPool; }
+
+    /// Fence signaled once the GPU has finished the frame; nullptr on
+    /// devices without fences, which finish work as it is submitted
+    Fence* GetFence() noexcept { return m_fence.get(); }
+
+    /// The device's per-frame upload heap, or nullptr if it has none
+    TransientAllocator* GetTransientAllocator() noexcept;
+
+    /// Run `callback` once the GPU has finished this frame
+    void Defer(std::function<void()> callback) { m_deferred.push_back(std::move(callback)); }
+
+    /// Destroy `object` once the GPU has finished this frame
+    template <typename T>
+    void DeferDelete(std::unique_ptr<T> object) {
+        if (object) {
+            m_deferred.push_back([object = std::shared_ptr<T>(std::move(object))] {});
+        }
+    }
+
+    /// Callbacks and deletions waiting for this frame to finish
+    size_t GetDeferredCount() const noexcept { return m_deferred.size(); }
+
+private:
+    friend class Device;
+
+    FrameContext(Device& device, uint32_t index);
+
+    /// Wait for the GPU to finish the frame that last used the context
+    void WaitForGpu();
+
+    /// Run deferred work and recycle the command pool; the GPU must be done
+    void Recycle();
+
+    Device* m_device;
+    uint32_t m_index;
+    uint64_t m_frameNumber = 0;
+    std::unique_ptr<CommandPool> m_commandPool;
+    std::unique_ptr<Fence> m_fence;
+    std::vector<std::function<void()>> m_deferred;
+};
+
+} // namespace VRHI
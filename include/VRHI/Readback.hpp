@@ -0,0 +1,116 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "VRHI.hpp"
+#include "Resources.hpp"
+#include "Sync.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <vector>
+
+namespace VRHI {
+
+class CommandBuffer;
+class ReadbackQueue;
+struct ReadbackRequest;
+struct ReadbackBatch;
+
+// ============================================================================
+// Readback
+// ============================================================================
+
+/// Future-like handle to data a ReadbackQueue copies back from the GPU.
+///
+/// The data becomes available once the command buffer the copy was
+/// recorded into has been submitted through ReadbackQueue::Submit() and the
+/// GPU has executed it. Poll IsReady() a frame or more later instead of
+/// waiting, and the CPU never stalls on the GPU.
+class ReadbackTicket {
+public:
+    ReadbackTicket() = default;
+
+    explicit operator bool() const noexcept { return m_request != nullptr; }
+
+    /// Size of the data in bytes
+    uint64_t GetSize() const noexcept;
+
+    /// Whether the copy has executed; never blocks
+    bool IsReady() const;
+
+    /// Wait for the copy to execute
+    /// @param timeout Timeout in nanoseconds
+    /// @return False on timeout, or if the copy has not been submitted
+    bool Wait(uint64_t timeout = UINT64_MAX) const;
+
+    /// Wait for the copy, then copy up to `size` bytes of the data into `data`
+    /// @return False if the copy has not been submitted
+    bool Read(void* data, size_t size) const;
+
+private:
+    friend class ReadbackQueue;
+    explicit ReadbackTicket(std::shared_ptr<ReadbackRequest> request) : m_request(std::move(request)) {}
+
+    std::shared_ptr<ReadbackRequest> m_request;
+};
+
+/// Records copies from textures and buffers into GpuToCpu staging buffers,
+/// and fences them so that the data can be collected frames later.
+///
+/// @code
+/// ReadbackQueue readbacks(*device);
+/// auto ticket = readbacks.ReadTexture(*cmd, *colorTarget);
+/// cmd->End();
+/// readbacks.Submit(*cmd);
+/// ...
+/// if (ticket->IsReady()) {
+///     ticket->Read(pixels.data(), pixels.size());
+/// }
+/// @endcode
+///
+/// Staging buffers are recycled once their tickets are gone and the GPU is
+/// done with them. Textures are copied tightly packed, a whole mip level
+/// of one array layer (or cube face) at a time. The queue is not
+/// thread-safe, and tickets must not outlive the device.
+class ReadbackQueue {
+public:
+    explicit ReadbackQueue(Device& device);
+    ~ReadbackQueue();
+
+    // Readback queue cannot be copied
+    ReadbackQueue(const ReadbackQueue&) = delete;
+    ReadbackQueue& operator=(const ReadbackQueue&) = delete;
+
+    /// Record a copy of a mip level of one layer of `texture` into `cmd`
+    std::expected<ReadbackTicket, Error> ReadTexture(CommandBuffer& cmd, Texture& texture,
+                                                     uint32_t mipLevel = 0, uint32_t arrayLayer = 0);
+
+    /// Record a copy of `size` bytes of `buffer` at `offset` into `cmd`
+    std::expected<ReadbackTicket, Error> ReadBuffer(CommandBuffer& cmd, Buffer& buffer,
+                                                    uint64_t offset, uint64_t size);
+
+    /// Submit `cmd` with a fence that completes every readback recorded
+    /// since the last Submit(); use it instead of Device::Submit()
+    void Submit(CommandBuffer& cmd);
+
+    /// Staging buffers owned by the queue, in use or waiting for reuse
+    size_t GetStagingBufferCount() const noexcept;
+
+private:
+    /// Start a readback of `size` bytes in the pending batch, reusing a free
+    /// staging buffer if one is large enough
+    std::expected<ReadbackTicket, Error> CreateRequest(uint64_t size);
+
+    /// Return the buffers of released, completed requests to the free list
+    void Recycle();
+
+    Device* m_device;
+    std::shared_ptr<ReadbackBatch> m_pending;  ///< Readbacks recorded since the last Submit()
+    std::vector<std::shared_ptr<ReadbackRequest>> m_requests;
+    std::vector<std::unique_ptr<Buffer>> m_freeBuffers;
+};
+
+} // namespace VRHI
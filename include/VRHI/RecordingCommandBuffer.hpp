@@ -0,0 +1,432 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "CommandStream.hpp"
+#include "CommandBuffer.hpp"
+#include <cassert>
+#include <cstring>
+
+namespace VRHI {
+
+/// Command buffer that encodes every call into a CommandStream.
+///
+/// Recording is pure CPU work and does not touch the graphics API, so it can
+/// be done on any thread. Backends derive from this class and replay the
+/// stream on the thread that owns the API context when the buffer is
+/// submitted. A recorded stream can be replayed any number of times.
+///
+/// Every device records through this class, so its recording calls are
+/// `final` and defined inline below: code that knows the static type (see
+/// Devirtualize()) compiles them to direct stream writes.
+class RecordingCommandBuffer : public CommandBuffer {
+public:
+    ~RecordingCommandBuffer() override = default;
+
+    // Command buffer lifecycle
+    void Begin() override;
+    void End() override;
+    void Reset() override;
+    CommandBufferState GetState() const noexcept override;
+    CommandBufferLevel GetLevel() const noexcept override { return m_level; }
+
+    // Render pass
+    void BeginRenderPass(RenderPass* renderPass, Framebuffer* framebuffer, const Rect2D& renderArea,
+                         std::span<const ClearValue> clearValues = {}) final;
+    void EndRenderPass() final;
+
+    // Pipeline binding
+    void BindPipeline(Pipeline* pipeline) final;
+
+    // Resource binding
+    void BindVertexBuffers(uint32_t firstBinding, std::span<Buffer* const> buffers, std::span<const uint64_t> offsets = {}) final;
+    void BindIndexBuffer(Buffer* buffer, uint64_t offset = 0, bool use16BitIndices = false) final;
+    void BindUniformBuffer(uint32_t binding, Buffer* buffer, uint64_t offset = 0, uint64_t size = 0) final;
+    void BindStorageBuffer(uint32_t binding, Buffer* buffer, uint64_t offset = 0, uint64_t size = 0) final;
+    void BindTexture(uint32_t binding, Texture* texture, Sampler* sampler = nullptr) final;
+    using CommandBuffer::BindVertexBuffers;
+    using CommandBuffer::BindIndexBuffer;
+    using CommandBuffer::BindUniformBuffer;
+    using CommandBuffer::BindStorageBuffer;
+
+    // Push constants
+    void PushConstants(ShaderStage stages, uint32_t offset, std::span<const std::byte> data) final;
+
+    // Dynamic state
+    void SetViewport(const Viewport& viewport) final;
+    void SetViewports(std::span<const Viewport> viewports) final;
+    void SetScissor(const Rect2D& scissor) final;
+    void SetScissors(std::span<const Rect2D> scissors) final;
+    void SetLineWidth(float width) final;
+    void SetBlendConstants(const float blendConstants[4]) final;
+    void SetDepthBias(float constantFactor, float clamp, float slopeFactor) final;
+    void SetDepthBounds(float minDepth, float maxDepth) final;
+    void SetStencilCompareMask(bool frontFace, uint32_t compareMask) final;
+    void SetStencilWriteMask(bool frontFace, uint32_t writeMask) final;
+    void SetStencilReference(bool frontFace, uint32_t reference) final;
+
+    // Drawing commands
+    void Draw(const DrawParams& params) final;
+    void Draw(uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0) final;
+    void DrawIndexed(const DrawIndexedParams& params) final;
+    void DrawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0) final;
+    void DrawIndirect(Buffer* buffer, uint64_t offset, uint32_t drawCount, uint32_t stride) final;
+    void DrawIndexedIndirect(Buffer* buffer, uint64_t offset, uint32_t drawCount, uint32_t stride) final;
+
+    // Compute commands
+    void Dispatch(const DispatchParams& params) final;
+    void Dispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1) final;
+    void DispatchIndirect(Buffer* buffer, uint64_t offset) final;
+
+    // Clear commands
+    void ClearColorAttachment(uint32_t attachment, const ClearColorValue& color, const Rect2D& rect) final;
+    void ClearDepthStencilAttachment(const ClearDepthStencilValue& value, const Rect2D& rect) final;
+
+    // Copy commands
+    void CopyBuffer(Buffer* src, Buffer* dst, uint64_t srcOffset, uint64_t dstOffset, uint64_t size) final;
+    void CopyBufferToTexture(Buffer* src, Texture* dst, uint32_t mipLevel = 0, uint32_t arrayLayer = 0) final;
+    void CopyTextureToBuffer(Texture* src, Buffer* dst, uint32_t mipLevel = 0, uint32_t arrayLayer = 0) final;
+    void CopyTexture(Texture* src, Texture* dst, uint32_t srcMipLevel = 0, uint32_t srcArrayLayer = 0, uint32_t dstMipLevel = 0, uint32_t dstArrayLayer = 0) final;
+
+    // Secondary command buffers
+    void ExecuteCommands(std::span<CommandBuffer* const> secondaries) final;
+
+    // Synchronization
+    void PipelineBarrier() final;
+
+    // Debug markers
+    void BeginDebugMarker(const char* name, const float color[4] = nullptr) final;
+    void EndDebugMarker() final;
+    void InsertDebugMarker(const char* name, const float color[4] = nullptr) final;
+
+    /// Recorded commands
+    [[nodiscard]] const CommandStream& GetCommandStream() const noexcept { return m_stream; }
+
+protected:
+    explicit RecordingCommandBuffer(CommandBufferLevel level = CommandBufferLevel::Primary) : m_level(level) {}
+
+    /// Append a command, warning when the buffer is not recording
+    template<typename T>
+    T& Record(size_t trailingBytes = 0) {
+        if (m_state != CommandBufferState::Recording) [[unlikely]] {
+            WarnNotRecording();
+        }
+        return m_stream.Emit<T>(trailingBytes);
+    }
+
+    /// Called by backends once the stream has been handed to the device
+    void MarkSubmitted() noexcept { m_state = CommandBufferState::Submitted; }
+
+    CommandStream m_stream;
+    CommandBufferState m_state = CommandBufferState::Initial;
+    CommandBufferLevel m_level;
+
+private:
+    void WarnNotRecording() const;
+    void WarnPushConstantRange(uint32_t offset, size_t size) const;
+};
+
+// ============================================================================
+// Render Pass
+// ============================================================================
+
+inline void RecordingCommandBuffer::BeginRenderPass(RenderPass* renderPass, Framebuffer* framebuffer, const Rect2D& renderArea,
+                                                    std::span<const ClearValue> clearValues) {
+    auto& cmd = Record<CmdBeginRenderPass>(clearValues.size_bytes());
+    cmd.renderPass = renderPass;
+    cmd.framebuffer = framebuffer;
+    cmd.renderArea = renderArea;
+    cmd.clearValueCount = static_cast<uint32_t>(clearValues.size());
+    if (!clearValues.empty()) {
+        std::memcpy(CommandStream::GetTrailingData<ClearValue>(cmd), clearValues.data(), clearValues.size_bytes());
+    }
+}
+
+inline void RecordingCommandBuffer::EndRenderPass() {
+    Record<CmdEndRenderPass>();
+}
+
+// ============================================================================
+// Pipeline and Resource Binding
+// ============================================================================
+
+inline void RecordingCommandBuffer::BindPipeline(Pipeline* pipeline) {
+    Record<CmdBindPipeline>().pipeline = pipeline;
+}
+
+inline void RecordingCommandBuffer::BindVertexBuffers(uint32_t firstBinding, std::span<Buffer* const> buffers, std::span<const uint64_t> offsets) {
+    const size_t count = buffers.size();
+    auto& cmd = Record<CmdBindVertexBuffers>(count * (sizeof(Buffer*) + sizeof(uint64_t)));
+    cmd.firstBinding = firstBinding;
+    cmd.bufferCount = static_cast<uint32_t>(count);
+
+    auto** dstBuffers = CommandStream::GetTrailingData<Buffer*>(cmd);
+    auto* dstOffsets = reinterpret_cast<uint64_t*>(dstBuffers + count);
+    for (size_t i = 0; i < count; ++i) {
+        dstBuffers[i] = buffers[i];
+        dstOffsets[i] = i < offsets.size() ? offsets[i] : 0;
+    }
+}
+
+inline void RecordingCommandBuffer::BindIndexBuffer(Buffer* buffer, uint64_t offset, bool use16BitIndices) {
+    auto& cmd = Record<CmdBindIndexBuffer>();
+    cmd.buffer = buffer;
+    cmd.offset = offset;
+    cmd.use16BitIndices = use16BitIndices;
+}
+
+inline void RecordingCommandBuffer::BindUniformBuffer(uint32_t binding, Buffer* buffer, uint64_t offset, uint64_t size) {
+    auto& cmd = Record<CmdBindUniformBuffer>();
+    cmd.binding = binding;
+    cmd.buffer = buffer;
+    cmd.offset = offset;
+    cmd.size = size;
+}
+
+inline void RecordingCommandBuffer::BindStorageBuffer(uint32_t binding, Buffer* buffer, uint64_t offset, uint64_t size) {
+    auto& cmd = Record<CmdBindStorageBuffer>();
+    cmd.binding = binding;
+    cmd.buffer = buffer;
+    cmd.offset = offset;
+    cmd.size = size;
+}
+
+inline void RecordingCommandBuffer::BindTexture(uint32_t binding, Texture* texture, Sampler* sampler) {
+    auto& cmd = Record<CmdBindTexture>();
+    cmd.binding = binding;
+    cmd.texture = texture;
+    cmd.sampler = sampler;
+}
+
+inline void RecordingCommandBuffer::PushConstants(ShaderStage stages, uint32_t offset, std::span<const std::byte> data) {
+    if (offset + data.size() > MaxPushConstantSize) [[unlikely]] {
+        WarnPushConstantRange(offset, data.size());
+        return;
+    }
+    auto& cmd = Record<CmdPushConstants>(data.size());
+    cmd.stages = stages;
+    cmd.offset = offset;
+    cmd.size = static_cast<uint32_t>(data.size());
+    if (!data.empty()) {
+        std::memcpy(CommandStream::GetTrailingData<std::byte>(cmd), data.data(), data.size());
+    }
+}
+
+// ============================================================================
+// Dynamic State
+// ============================================================================
+
+inline void RecordingCommandBuffer::SetViewport(const Viewport& viewport) {
+    SetViewports({&viewport, 1});
+}
+
+inline void RecordingCommandBuffer::SetViewports(std::span<const Viewport> viewports) {
+    auto& cmd = Record<CmdSetViewports>(viewports.size_bytes());
+    cmd.count = static_cast<uint32_t>(viewports.size());
+    if (!viewports.empty()) {
+        std::memcpy(CommandStream::GetTrailingData<Viewport>(cmd), viewports.data(), viewports.size_bytes());
+    }
+}
+
+inline void RecordingCommandBuffer::SetScissor(const Rect2D& scissor) {
+    SetScissors({&scissor, 1});
+}
+
+inline void RecordingCommandBuffer::SetScissors(std::span<const Rect2D> scissors) {
+    auto& cmd = Record<CmdSetScissors>(scissors.size_bytes());
+    cmd.count = static_cast<uint32_t>(scissors.size());
+    if (!scissors.empty()) {
+        std::memcpy(CommandStream::GetTrailingData<Rect2D>(cmd), scissors.data(), scissors.size_bytes());
+    }
+}
+
+inline void RecordingCommandBuffer::SetLineWidth(float width) {
+    Record<CmdSetLineWidth>().width = width;
+}
+
+inline void RecordingCommandBuffer::SetBlendConstants(const float blendConstants[4]) {
+    auto& cmd = Record<CmdSetBlendConstants>();
+    std::memcpy(cmd.constants, blendConstants, sizeof(cmd.constants));
+}
+
+inline void RecordingCommandBuffer::SetDepthBias(float constantFactor, float clamp, float slopeFactor) {
+    auto& cmd = Record<CmdSetDepthBias>();
+    cmd.constantFactor = constantFactor;
+    cmd.clamp = clamp;
+    cmd.slopeFactor = slopeFactor;
+}
+
+inline void RecordingCommandBuffer::SetDepthBounds(float minDepth, float maxDepth) {
+    auto& cmd = Record<CmdSetDepthBounds>();
+    cmd.minDepth = minDepth;
+    cmd.maxDepth = maxDepth;
+}
+
+inline void RecordingCommandBuffer::SetStencilCompareMask(bool frontFace, uint32_t compareMask) {
+    auto& cmd = Record<CmdSetStencilCompareMask>();
+    cmd.frontFace = frontFace;
+    cmd.value = compareMask;
+}
+
+inline void RecordingCommandBuffer::SetStencilWriteMask(bool frontFace, uint32_t writeMask) {
+    auto& cmd = Record<CmdSetStencilWriteMask>();
+    cmd.frontFace = frontFace;
+    cmd.value = writeMask;
+}
+
+inline void RecordingCommandBuffer::SetStencilReference(bool frontFace, uint32_t reference) {
+    auto& cmd = Record<CmdSetStencilReference>();
+    cmd.frontFace = frontFace;
+    cmd.value = reference;
+}
+
+// ============================================================================
+// Drawing and Compute
+// ============================================================================
+
+inline void RecordingCommandBuffer::Draw(const DrawParams& params) {
+    Record<CmdDraw>().params = params;
+}
+
+inline void RecordingCommandBuffer::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) {
+    Draw(DrawParams{vertexCount, instanceCount, firstVertex, firstInstance});
+}
+
+inline void RecordingCommandBuffer::DrawIndexed(const DrawIndexedParams& params) {
+    Record<CmdDrawIndexed>().params = params;
+}
+
+inline void RecordingCommandBuffer::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) {
+    DrawIndexed(DrawIndexedParams{indexCount, instanceCount, firstIndex, vertexOffset, firstInstance});
+}
+
+inline void RecordingCommandBuffer::DrawIndirect(Buffer* buffer, uint64_t offset, uint32_t drawCount, uint32_t stride) {
+    auto& cmd = Record<CmdDrawIndirect>();
+    cmd.buffer = buffer;
+    cmd.offset = offset;
+    cmd.drawCount = drawCount;
+    cmd.stride = stride;
+}
+
+inline void RecordingCommandBuffer::DrawIndexedIndirect(Buffer* buffer, uint64_t offset, uint32_t drawCount, uint32_t stride) {
+    auto& cmd = Record<CmdDrawIndexedIndirect>();
+    cmd.buffer = buffer;
+    cmd.offset = offset;
+    cmd.drawCount = drawCount;
+    cmd.stride = stride;
+}
+
+inline void RecordingCommandBuffer::Dispatch(const DispatchParams& params) {
+    Record<CmdDispatch>().params = params;
+}
+
+inline void RecordingCommandBuffer::Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
+    Dispatch(DispatchParams{groupCountX, groupCountY, groupCountZ});
+}
+
+inline void RecordingCommandBuffer::DispatchIndirect(Buffer* buffer, uint64_t offset) {
+    auto& cmd = Record<CmdDispatchIndirect>();
+    cmd.buffer = buffer;
+    cmd.offset = offset;
+}
+
+// ============================================================================
+// Clear and Copy
+// ============================================================================
+
+inline void RecordingCommandBuffer::ClearColorAttachment(uint32_t attachment, const ClearColorValue& color, const Rect2D& rect) {
+    auto& cmd = Record<CmdClearColorAttachment>();
+    cmd.attachment = attachment;
+    cmd.color = color;
+    cmd.rect = rect;
+}
+
+inline void RecordingCommandBuffer::ClearDepthStencilAttachment(const ClearDepthStencilValue& value, const Rect2D& rect) {
+    auto& cmd = Record<CmdClearDepthStencilAttachment>();
+    cmd.value = value;
+    cmd.rect = rect;
+}
+
+inline void RecordingCommandBuffer::CopyBuffer(Buffer* src, Buffer* dst, uint64_t srcOffset, uint64_t dstOffset, uint64_t size) {
+    auto& cmd = Record<CmdCopyBuffer>();
+    cmd.src = src;
+    cmd.dst = dst;
+    cmd.srcOffset = srcOffset;
+    cmd.dstOffset = dstOffset;
+    cmd.size = size;
+}
+
+inline void RecordingCommandBuffer::CopyBufferToTexture(Buffer* src, Texture* dst, uint32_t mipLevel, uint32_t arrayLayer) {
+    auto& cmd = Record<CmdCopyBufferToTexture>();
+    cmd.src = src;
+    cmd.dst = dst;
+    cmd.mipLevel = mipLevel;
+    cmd.arrayLayer = arrayLayer;
+}
+
+inline void RecordingCommandBuffer::CopyTextureToBuffer(Texture* src, Buffer* dst, uint32_t mipLevel, uint32_t arrayLayer) {
+    auto& cmd = Record<CmdCopyTextureToBuffer>();
+    cmd.src = src;
+    cmd.dst = dst;
+    cmd.mipLevel = mipLevel;
+    cmd.arrayLayer = arrayLayer;
+}
+
+inline void RecordingCommandBuffer::CopyTexture(Texture* src, Texture* dst, uint32_t srcMipLevel, uint32_t srcArrayLayer, uint32_t dstMipLevel, uint32_t dstArrayLayer) {
+    auto& cmd = Record<CmdCopyTexture>();
+    cmd.src = src;
+    cmd.dst = dst;
+    cmd.srcMipLevel = srcMipLevel;
+    cmd.srcArrayLayer = srcArrayLayer;
+    cmd.dstMipLevel = dstMipLevel;
+    cmd.dstArrayLayer = dstArrayLayer;
+}
+
+// ============================================================================
+// Synchronization and Debug Markers
+// ============================================================================
+
+inline void RecordingCommandBuffer::PipelineBarrier() {
+    Record<CmdPipelineBarrier>();
+}
+
+inline void RecordingCommandBuffer::EndDebugMarker() {
+    Record<CmdEndDebugMarker>();
+}
+
+// ============================================================================
+// Devirtualization
+// ============================================================================
+
+/// Static type to record through in hot loops.
+///
+/// With VRHI_DEVIRTUALIZE (CMake option of the same name) this is
+/// RecordingCommandBuffer, whose final, inline recording calls compile to
+/// direct stream writes in user code. Otherwise it is the CommandBuffer
+/// interface and calls stay virtual. The option asserts that every command
+/// buffer passed to Devirtualize() was created by a VRHI device, which debug
+/// builds check; custom Device implementations with their own command buffers
+/// must leave it off. DrawList::Emit() checks the type itself and accepts any
+/// command buffer.
+#if VRHI_DEVIRTUALIZE
+using CommandRecorder = RecordingCommandBuffer;
+#else
+using CommandRecorder = CommandBuffer;
+#endif
+
+/// @code
+/// VRHI::CommandRecorder& rec = VRHI::Devirtualize(*cmd);
+/// for (const Mesh& mesh : meshes) {
+///     rec.BindIndexBuffer(mesh.indices);
+///     rec.DrawIndexed(mesh.indexCount);
+/// }
+/// @endcode
+inline CommandRecorder& Devirtualize(CommandBuffer& cmd) noexcept {
+#if VRHI_DEVIRTUALIZE
+    assert(dynamic_cast<RecordingCommandBuffer*>(&cmd) && "Devirtualize() needs a command buffer of a VRHI device");
+#endif
+    return static_cast<CommandRecorder&>(cmd);
+}
+
+} // namespace VRHI
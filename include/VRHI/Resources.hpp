@@ -5,6 +5,7 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <span>
 
 namespace VRHI {
 
@@ -55,14 +56,54 @@ enum class MemoryAccess {
     CpuOnly,      // CPU only access
 };
 
+/// How a buffer rewritten by the CPU every frame avoids waiting for the GPU
+/// to finish reading what the previous frames wrote. Backends that cannot
+/// honour a policy update in place.
+enum class BufferStreaming {
+    Auto,            // RoundRobin for CpuToGpu buffers, None otherwise
+    None,            // Update in place
+    Orphan,          // Re-specify the storage before the first whole-buffer write of a frame
+    RoundRobin,      // Rotate between streamingCopies copies, moving on at the first write of a frame
+    Unsynchronized,  // RoundRobin whose first write of a frame maps the copy unsynchronized once its fence passed
+};
+
 struct BufferDesc {
     size_t size = 0;
     BufferUsage usage = BufferUsage::Vertex;
     MemoryAccess memoryAccess = MemoryAccess::GpuOnly;
+    BufferStreaming streaming = BufferStreaming::Auto;
+    uint32_t streamingCopies = 3;  // Copies kept by RoundRobin and Unsynchronized, at least 2
     const void* initialData = nullptr;
     const char* debugName = nullptr;
 };
 
+/// How a mapping is used, as in glMapBufferRange
+enum class MapAccess : uint32_t {
+    Read             = 1 << 0,  // The CPU reads the range
+    Write            = 1 << 1,  // The CPU writes the range
+    InvalidateRange  = 1 << 2,  // The range's previous contents may be discarded
+    InvalidateBuffer = 1 << 3,  // The whole buffer's previous contents may be discarded
+    Unsynchronized   = 1 << 4,  // Do not wait for the GPU; the caller avoids ranges it still uses
+    FlushExplicit    = 1 << 5,  // Writes reach the GPU only through Buffer::FlushRange()
+};
+
+constexpr MapAccess operator|(MapAccess lhs, MapAccess rhs) noexcept {
+    return static_cast<MapAccess>(
+        static_cast<uint32_t>(lhs) | static_cast<uint32_t>(rhs)
+    );
+}
+
+constexpr MapAccess operator&(MapAccess lhs, MapAccess rhs) noexcept {
+    return static_cast<MapAccess>(
+        static_cast<uint32_t>(lhs) & static_cast<uint32_t>(rhs)
+    );
+}
+
+constexpr MapAccess& operator|=(MapAccess& lhs, MapAccess rhs) noexcept {
+    lhs = lhs | rhs;
+    return lhs;
+}
+
 class Buffer {
 public:
     virtual ~Buffer() = default;
@@ -89,6 +130,25 @@ public:
     /// @return Pointer to mapped memory
     virtual void* Map(size_t offset, size_t size) = 0;
     
+    /// Map buffer memory range for the given kind of access. Write-only maps
+    /// let the driver skip reading back and waiting for the GPU; reads may not
+    /// be combined with InvalidateRange, InvalidateBuffer or Unsynchronized,
+    /// and FlushExplicit needs Write. Backends that cannot use the flags map
+    /// with Map(offset, size).
+    /// @return Pointer to mapped memory, or nullptr if the range or flags are invalid
+    virtual void* Map(size_t offset, size_t size, MapAccess access) {
+        (void)access;
+        return Map(offset, size);
+    }
+    
+    /// Make writes to a range of a FlushExplicit mapping visible to the GPU
+    /// @param offset Offset in bytes from the start of the buffer, inside the mapped range
+    /// @param size Size in bytes
+    virtual void FlushRange(size_t offset, size_t size) {
+        (void)offset;
+        (void)size;
+    }
+    
     /// Unmap buffer memory
     virtual void Unmap() = 0;
     
@@ -98,16 +158,33 @@ public:
     /// @param offset Offset in bytes
     virtual void Update(const void* data, size_t size, size_t offset = 0) = 0;
     
+    /// Update buffer data, batching the GPU-side copy with other updates
+    /// The data is copied before returning; the GPU sees it from the next
+    /// Device::Submit() on. Backends without batching fall back to Update().
+    virtual void UpdateAsync(const void* data, size_t size, size_t offset = 0) {
+        Update(data, size, offset);
+    }
+    
     /// Read buffer data (only supported for CpuToGpu or GpuToCpu)
     /// @param data Destination buffer
     /// @param size Size in bytes
     /// @param offset Offset in bytes
     virtual void Read(void* data, size_t size, size_t offset = 0) = 0;
-    
+
 protected:
     Buffer() = default;
 };
 
+/// A range of a buffer, such as a BufferAllocator sub-allocation.
+/// The CommandBuffer binding calls accept it in place of a buffer and offset.
+struct BufferView {
+    Buffer* buffer = nullptr;
+    uint64_t offset = 0;  // Offset of the range in `buffer`
+    uint64_t size = 0;
+
+    explicit operator bool() const noexcept { return buffer != nullptr; }
+};
+
 // ============================================================================
 // Texture
 // ============================================================================
@@ -207,6 +284,14 @@ struct TextureDesc {
     const char* debugName = nullptr;
 };
 
+/// Where one subresource lies in the data passed to Texture::UpdateSubresources()
+struct TextureSubresourceData {
+    uint32_t mipLevel = 0;
+    uint32_t arrayLayer = 0;  // Cube face, or layer * 6 + face for cube arrays
+    size_t offset = 0;        // Byte offset of the tightly packed texels or blocks
+    size_t size = 0;          // Bytes of the subresource
+};
+
 class Texture {
 public:
     virtual ~Texture() = default;
@@ -248,6 +333,24 @@ public:
                              uint32_t width, uint32_t height, uint32_t depth,
                              uint32_t mipLevel = 0, uint32_t arrayLayer = 0) = 0;
     
+    /// Update texture region, batching the GPU-side copy like Buffer::UpdateAsync()
+    virtual void UpdateRegionAsync(const void* data,
+                                   uint32_t x, uint32_t y, uint32_t z,
+                                   uint32_t width, uint32_t height, uint32_t depth,
+                                   uint32_t mipLevel = 0, uint32_t arrayLayer = 0) {
+        UpdateRegion(data, x, y, z, width, height, depth, mipLevel, arrayLayer);
+    }
+    
+    /// Replace whole subresources from one block of memory, such as every
+    /// mip level and layer of an asset file, in a single call. `data` holds
+    /// each subresource at the place its entry describes.
+    virtual void UpdateSubresources(const void* data, std::span<const TextureSubresourceData> subresources) {
+        for (const TextureSubresourceData& subresource : subresources) {
+            Update(static_cast<const std::byte*>(data) + subresource.offset, subresource.size,
+                   subresource.mipLevel, subresource.arrayLayer);
+        }
+    }
+    
     /// Generate mipmaps
     virtual void GenerateMipmaps(CommandBuffer* cmd) = 0;
     
@@ -15,6 +15,18 @@ namespace VRHI {
 // Forward declare Error from VRHI
 struct Error;
 
+// ============================================================================
+// Push Constant Emulation
+// ============================================================================
+
+/// Uniform block name given to `layout(push_constant)` blocks when SPIR-V is
+/// converted to GLSL, where push constants do not exist
+inline constexpr const char* PushConstantBlockName = "VRHI_PushConstants";
+
+/// Uniform buffer binding reserved for the push constant block on backends
+/// that emulate push constants (the last binding OpenGL 3.3 guarantees)
+inline constexpr uint32_t PushConstantBinding = 35;
+
 // ============================================================================
 // Custom Includer Interface
 // ============================================================================
@@ -41,6 +53,25 @@ public:
 // Shader Compilation Result
 // ============================================================================
 
+/// Kind of resource a shader reads through a descriptor binding
+enum class ShaderResourceType {
+    UniformBuffer,
+    StorageBuffer,
+    SampledTexture,   // Combined image sampler
+    StorageTexture,   // Storage image
+    SeparateTexture,  // Texture without a sampler
+    SeparateSampler,
+};
+
+/// A descriptor binding declared by a shader
+struct ShaderResourceBinding {
+    std::string name;
+    ShaderResourceType type = ShaderResourceType::UniformBuffer;
+    uint32_t set = 0;
+    uint32_t binding = 0;
+    uint32_t count = 1;  // Array size; 0 for runtime-sized arrays
+};
+
 /// Result of shader compilation
 struct ShaderCompilationResult {
     /// SPIR-V bytecode
@@ -59,6 +90,13 @@ struct ShaderCompilationResult {
         
         // Texture samplers
         std::vector<std::string> samplers;
+        
+        // Every descriptor binding, for backends that build binding layouts
+        std::vector<ShaderResourceBinding> bindings;
+        
+        // Size in bytes of the push constant block, 0 if the shader has none.
+        // Converted GLSL reads it from PushConstantBinding.
+        uint32_t pushConstantSize = 0;
     };
     
     std::optional<ReflectionData> reflection;
@@ -86,6 +124,8 @@ public:
     );
     
     /// Convert SPIR-V to GLSL
+    /// A push constant block becomes a std140 uniform block named
+    /// PushConstantBlockName, which the backend binds to PushConstantBinding.
     /// @param spirv SPIR-V bytecode
     /// @param targetVersion Target GLSL version (e.g., 330, 410, 460)
     /// @return GLSL source code or error
@@ -0,0 +1,79 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace VRHI {
+
+// Forward declarations
+class Buffer;
+
+// ============================================================================
+// Transient Allocations
+// ============================================================================
+
+/// A slice of a device-owned buffer that lives for one frame
+struct TransientAllocation {
+    Buffer* buffer = nullptr;  // Bind with the offset below
+    uint64_t offset = 0;       // Offset of the slice in `buffer`
+    void* data = nullptr;      // CPU pointer to write the slice through
+    uint64_t size = 0;
+
+    explicit operator bool() const noexcept { return data != nullptr; }
+};
+
+/// Per-frame upload heap for dynamic vertex, index and uniform data.
+///
+/// Allocate() hands out slices of large ring buffers owned by the device, so
+/// debug lines, UI geometry or per-draw constants need neither CreateBuffer()
+/// nor Buffer::Update(). A slice is used for the frame it was allocated in;
+/// its memory is recycled automatically once the GPU has finished that frame.
+/// A frame ends at Device::Present().
+///
+/// @code
+/// TransientAllocator* transient = device->GetTransientAllocator();
+/// TransientAllocation verts = transient->Upload(lines.data(), lines.size() * sizeof(Line));
+/// uint64_t offset = verts.offset;
+/// cmd->BindVertexBuffers(0, std::span(&verts.buffer, 1), std::span(&offset, 1));
+/// @endcode
+///
+/// Write a slice before submitting the command buffer that uses it: the data
+/// pointers of all slices become invalid at the next Device::Submit(). The
+/// allocator must only be used from the thread that submits.
+class TransientAllocator {
+public:
+    virtual ~TransientAllocator() = default;
+
+    // Transient allocator cannot be copied
+    TransientAllocator(const TransientAllocator&) = delete;
+    TransientAllocator& operator=(const TransientAllocator&) = delete;
+
+    /// Allocate `size` bytes for the current frame
+    /// @param alignment Offset alignment; 0 uses FeatureSet::memory.minUniformBufferAlignment
+    /// @return The slice, or an empty allocation if no memory could be obtained
+    virtual TransientAllocation Allocate(uint64_t size, uint64_t alignment = 0) = 0;
+
+    /// Allocate a slice and copy `size` bytes of `data` into it
+    TransientAllocation Upload(const void* data, uint64_t size, uint64_t alignment = 0) {
+        TransientAllocation allocation = Allocate(size, alignment);
+        if (allocation) {
+            std::memcpy(allocation.data, data, static_cast<size_t>(size));
+        }
+        return allocation;
+    }
+
+    /// Bytes allocated in the current frame, including alignment padding
+    virtual uint64_t GetFrameUsage() const noexcept = 0;
+
+    /// Size of the ring buffer; it grows when frames in flight do not fit
+    virtual uint64_t GetCapacity() const noexcept = 0;
+
+protected:
+    TransientAllocator() = default;
+};
+
+} // namespace VRHI
@@ -21,6 +21,9 @@ class Sampler;
 class Shader;
 class Pipeline;
 class CommandBuffer;
+class CommandPool;
+class FrameContext;
+class TransientAllocator;
 class RenderPass;
 class Framebuffer;
 class Fence;
@@ -49,9 +52,17 @@ enum class BackendType {
     // Future/Experimental
     WebGPU,        // Planned: Web and cross-platform backend
     
+    // CPU
+    Software,      // Multithreaded rasterizer; deterministic, needs no GPU
+    
     Auto,          // Automatically select the best backend
 };
 
+enum class CommandBufferLevel {
+    Primary,       // Submitted to the device
+    Secondary,     // Executed from a primary command buffer (ExecuteCommands)
+};
+
 enum class Feature {
     // Core features
     Compute,
@@ -246,6 +257,22 @@ struct DeviceProperties {
     uint32_t maxThreadsPerGroup = 0;
 };
 
+// ============================================================================
+// Frame Statistics
+// ============================================================================
+
+/// Per-frame counters collected by the backend.
+/// A frame ends when Device::Present() is called.
+struct FrameStats {
+    uint64_t stateChangesEmitted = 0;   // State-setting API calls sent to the driver
+    uint64_t stateChangesFiltered = 0;  // Redundant state calls skipped by the backend
+    uint64_t drawCalls = 0;             // Draw API calls sent to the driver
+    uint64_t drawsMerged = 0;           // Recorded draws folded into multi-draw calls (DeviceConfig::mergeDraws)
+    uint64_t vertexArrayMisses = 0;     // Vertex array objects built because none was cached (OpenGL)
+    uint64_t bytesUploaded = 0;         // Buffer and texture update data sent to the GPU
+    double uploadMegabytesPerSecond = 0.0;  // bytesUploaded over the CPU time spent uploading it
+};
+
 // ============================================================================
 // Configuration
 // ============================================================================
@@ -264,6 +291,20 @@ struct DeviceConfig {
     bool vsync = true;
     uint32_t backBufferCount = 2;
     
+    /// Frames the CPU may record ahead of the GPU when frames are driven by
+    /// Device::BeginFrame()/EndFrame(); at least 1
+    uint32_t maxFramesInFlight = 2;
+    
+    /// Coalesce runs of consecutive non-instanced DrawIndexed commands into
+    /// multi-draw calls at submission. A run ends at any other command, so
+    /// draws must be recorded without binds in between (e.g. via DrawList).
+    bool mergeDraws = false;
+    
+    /// Threads the software backend renders with, and OpenGL 3.3 runs compute
+    /// shaders on, the submitting thread included; 0 uses one per hardware
+    /// thread. Other backends ignore it.
+    uint32_t workerThreads = 0;
+    
     LogLevel logLevel = LogLevel::Info;
 };
 
@@ -317,7 +358,7 @@ void SetLogLevel(LogLevel level) noexcept;
 
 class Device {
 public:
-    virtual ~Device() = default;
+    virtual ~Device();
     
     // Device cannot be copied, only moved
     Device(const Device&) = delete;
@@ -381,13 +422,28 @@ public:
     // ========================================================================
     
     /// Create a command buffer
-    virtual std::unique_ptr<CommandBuffer> CreateCommandBuffer() = 0;
+    virtual std::unique_ptr<CommandBuffer>
+    CreateCommandBuffer(CommandBufferLevel level = CommandBufferLevel::Primary) = 0;
+    
+    /// Create a pool that recycles command buffers across frames
+    /// Backends without a native pool get one built on CreateCommandBuffer()
+    virtual std::unique_ptr<CommandPool> CreateCommandPool();
+    
+    /// Get the per-frame upload heap for dynamic vertex, index and uniform data
+    /// @return Device-owned allocator, or nullptr if the backend has none
+    virtual TransientAllocator* GetTransientAllocator() noexcept { return nullptr; }
     
     /// Submit a command buffer
-    virtual void Submit(std::unique_ptr<CommandBuffer> cmd) = 0;
+    /// @param signalFence Optional fence signaled once the GPU has finished the commands
+    virtual void Submit(std::unique_ptr<CommandBuffer> cmd, Fence* signalFence = nullptr) = 0;
+    
+    /// Submit a command buffer without taking ownership (e.g. one from a CommandPool)
+    /// @param signalFence Optional fence signaled once the GPU has finished the commands
+    virtual void Submit(CommandBuffer* cmd, Fence* signalFence = nullptr) = 0;
     
     /// Submit multiple command buffers
-    virtual void Submit(std::span<std::unique_ptr<CommandBuffer>> cmds) = 0;
+    /// @param signalFence Optional fence signaled once the GPU has finished all of them
+    virtual void Submit(std::span<std::unique_ptr<CommandBuffer>> cmds, Fence* signalFence = nullptr) = 0;
     
     /// Wait for device to be idle
     virtual void WaitIdle() = 0;
@@ -418,8 +474,50 @@ public:
     /// Resize swap chain
     virtual void Resize(uint32_t width, uint32_t height) = 0;
     
+    // ========================================================================
+    // Statistics
+    // ========================================================================
+    
+    /// Get statistics of the last completed frame
+    /// Backends that do not collect statistics report zeros
+    virtual FrameStats GetFrameStats() const noexcept { return {}; }
+    
+    // ========================================================================
+    // Frames in Flight
+    // ========================================================================
+    
+    /// Start a frame and get its context (see FrameContext.hpp).
+    /// Blocks only while the GPU has not finished the frame recorded
+    /// GetMaxFramesInFlight() frames earlier, then recycles that frame's
+    /// command pool and runs its deferred deletions.
+    FrameContext& BeginFrame();
+    
+    /// Fence everything submitted since BeginFrame() with the frame's fence,
+    /// then Present()
+    void EndFrame();
+    
+    /// Context of the frame between BeginFrame() and EndFrame(), or nullptr
+    FrameContext* GetCurrentFrame() noexcept { return m_currentFrame; }
+    
+    /// Number of frame contexts, from DeviceConfig::maxFramesInFlight
+    uint32_t GetMaxFramesInFlight() const noexcept { return m_maxFramesInFlight; }
+    
 protected:
-    Device() = default;
+    Device();
+    
+    /// Set the number of frame contexts; takes effect before the first BeginFrame()
+    void SetMaxFramesInFlight(uint32_t count) noexcept;
+    
+    /// Wait for the frames in flight, run their deferred deletions and free
+    /// their contexts; backends call this from their destructor, while the
+    /// objects the contexts hold can still be destroyed
+    void ReleaseFrameContexts();
+    
+private:
+    std::vector<std::unique_ptr<FrameContext>> m_frameContexts;
+    FrameContext* m_currentFrame = nullptr;
+    uint64_t m_framesBegun = 0;
+    uint32_t m_maxFramesInFlight = 2;
 };
 
 } // namespace VRHI
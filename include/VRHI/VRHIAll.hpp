@@ -15,6 +15,15 @@
 
 // Command recording
 #include "CommandBuffer.hpp"
+#include "CommandPool.hpp"
+#include "FrameContext.hpp"
+#include "TransientAllocator.hpp"
+#include "BufferAllocator.hpp"
+#include "Readback.hpp"
+#include "DrawList.hpp"
 
 // Backend abstraction
 #include "Backend.hpp"
+
+// Capture and replay
+#include "Capture.hpp"
@@ -157,14 +157,55 @@ GLenum GLFormatUtils::GetTextureTarget(TextureType type) {
         case TextureType::TextureCube: return GL_TEXTURE_CUBE_MAP;
         case TextureType::Texture1DArray: return GL_TEXTURE_1D_ARRAY;
         case TextureType::Texture2DArray: return GL_TEXTURE_2D_ARRAY;
-        case TextureType::TextureCubeArray:
-            // GL_TEXTURE_CUBE_MAP_ARRAY is GL 4.0+, not available in 3.3
-            // Fall back to regular cube map
-            return GL_TEXTURE_CUBE_MAP;
+        // GL 4.0 or ARB_texture_cube_map_array; OpenGL33Texture checks for it
+        case TextureType::TextureCubeArray: return GL_TEXTURE_CUBE_MAP_ARRAY;
         default: return GL_TEXTURE_2D;
     }
 }
 
+uint32_t GLFormatUtils::GetTexelSize(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::R8_UNorm: return 1;
+        case TextureFormat::RG8_UNorm: return 2;
+        case TextureFormat::RGBA8_UNorm:
+        case TextureFormat::RGBA8_SRGB: return 4;
+        case TextureFormat::R16_Float: return 2;
+        case TextureFormat::RG16_Float: return 4;
+        case TextureFormat::RGBA16_Float: return 8;
+        case TextureFormat::R32_Float:
+        case TextureFormat::R32_UInt: return 4;
+        case TextureFormat::RG32_Float:
+        case TextureFormat::RG32_UInt: return 8;
+        case TextureFormat::RGB32_Float:
+        case TextureFormat::RGB32_UInt: return 12;
+        case TextureFormat::RGBA32_Float:
+        case TextureFormat::RGBA32_UInt: return 16;
+        case TextureFormat::Depth16: return 2;
+        case TextureFormat::Depth24Stencil8:
+        case TextureFormat::Depth32F: return 4;
+        case TextureFormat::Depth32FStencil8: return 8;
+        default: return 0;
+    }
+}
+
+uint64_t GLFormatUtils::GetImageSize(TextureFormat format, uint32_t width, uint32_t height, uint32_t depth) {
+    uint64_t blockSize = 0;
+    switch (format) {
+        case TextureFormat::BC1_UNorm:
+        case TextureFormat::ETC2_RGB8:
+            blockSize = 8;
+            break;
+        case TextureFormat::BC3_UNorm:
+        case TextureFormat::BC7_UNorm:
+        case TextureFormat::ASTC_4x4:
+            blockSize = 16;
+            break;
+        default:
+            return uint64_t{width} * height * depth * GetTexelSize(format);
+    }
+    return uint64_t{(width + 3) / 4} * ((height + 3) / 4) * depth * blockSize;
+}
+
 bool GLFormatUtils::IsCompressedFormat(TextureFormat format) {
     switch (format) {
         case TextureFormat::BC1_UNorm:
@@ -190,4 +231,96 @@ bool GLFormatUtils::IsDepthStencilFormat(TextureFormat format) {
     }
 }
 
+bool GLFormatUtils::HasStencil(TextureFormat format) {
+    return format == TextureFormat::Depth24Stencil8 || format == TextureFormat::Depth32FStencil8;
+}
+
+bool GLFormatUtils::IsUnsignedIntegerFormat(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::R32_UInt:
+        case TextureFormat::RG32_UInt:
+        case TextureFormat::RGB32_UInt:
+        case TextureFormat::RGBA32_UInt:
+            return true;
+        default:
+            return false;
+    }
+}
+
+GLenum GLFormatUtils::GetCompareFunc(CompareOp op) {
+    switch (op) {
+        case CompareOp::Never: return GL_NEVER;
+        case CompareOp::Less: return GL_LESS;
+        case CompareOp::Equal: return GL_EQUAL;
+        case CompareOp::LessOrEqual: return GL_LEQUAL;
+        case CompareOp::Greater: return GL_GREATER;
+        case CompareOp::NotEqual: return GL_NOTEQUAL;
+        case CompareOp::GreaterOrEqual: return GL_GEQUAL;
+        case CompareOp::Always: return GL_ALWAYS;
+        default: return GL_LESS;
+    }
+}
+
+GLenum GLFormatUtils::GetBlendFactor(BlendFactor factor) {
+    switch (factor) {
+        case BlendFactor::Zero: return GL_ZERO;
+        case BlendFactor::One: return GL_ONE;
+        case BlendFactor::SrcColor: return GL_SRC_COLOR;
+        case BlendFactor::OneMinusSrcColor: return GL_ONE_MINUS_SRC_COLOR;
+        case BlendFactor::DstColor: return GL_DST_COLOR;
+        case BlendFactor::OneMinusDstColor: return GL_ONE_MINUS_DST_COLOR;
+        case BlendFactor::SrcAlpha: return GL_SRC_ALPHA;
+        case BlendFactor::OneMinusSrcAlpha: return GL_ONE_MINUS_SRC_ALPHA;
+        case BlendFactor::DstAlpha: return GL_DST_ALPHA;
+        case BlendFactor::OneMinusDstAlpha: return GL_ONE_MINUS_DST_ALPHA;
+        case BlendFactor::ConstantColor: return GL_CONSTANT_COLOR;
+        case BlendFactor::OneMinusConstantColor: return GL_ONE_MINUS_CONSTANT_COLOR;
+        case BlendFactor::ConstantAlpha: return GL_CONSTANT_ALPHA;
+        case BlendFactor::OneMinusConstantAlpha: return GL_ONE_MINUS_CONSTANT_ALPHA;
+        case BlendFactor::SrcAlphaSaturate: return GL_SRC_ALPHA_SATURATE;
+        default: return GL_ONE;
+    }
+}
+
+GLenum GLFormatUtils::GetBlendEquation(BlendOp op) {
+    switch (op) {
+        case BlendOp::Add: return GL_FUNC_ADD;
+        case BlendOp::Subtract: return GL_FUNC_SUBTRACT;
+        case BlendOp::ReverseSubtract: return GL_FUNC_REVERSE_SUBTRACT;
+        case BlendOp::Min: return GL_MIN;
+        case BlendOp::Max: return GL_MAX;
+        default: return GL_FUNC_ADD;
+    }
+}
+
+GLenum GLFormatUtils::GetStencilOp(StencilOp op) {
+    switch (op) {
+        case StencilOp::Keep: return GL_KEEP;
+        case StencilOp::Zero: return GL_ZERO;
+        case StencilOp::Replace: return GL_REPLACE;
+        case StencilOp::IncrementAndClamp: return GL_INCR;
+        case StencilOp::DecrementAndClamp: return GL_DECR;
+        case StencilOp::Invert: return GL_INVERT;
+        case StencilOp::IncrementAndWrap: return GL_INCR_WRAP;
+        case StencilOp::DecrementAndWrap: return GL_DECR_WRAP;
+        default: return GL_KEEP;
+    }
+}
+
+GLenum GLFormatUtils::GetPrimitiveMode(PrimitiveTopology topology) {
+    switch (topology) {
+        case PrimitiveTopology::PointList: return GL_POINTS;
+        case PrimitiveTopology::LineList: return GL_LINES;
+        case PrimitiveTopology::LineStrip: return GL_LINE_STRIP;
+        case PrimitiveTopology::TriangleList: return GL_TRIANGLES;
+        case PrimitiveTopology::TriangleStrip: return GL_TRIANGLE_STRIP;
+        case PrimitiveTopology::TriangleFan: return GL_TRIANGLE_FAN;
+        case PrimitiveTopology::LineListWithAdjacency: return GL_LINES_ADJACENCY;
+        case PrimitiveTopology::LineStripWithAdjacency: return GL_LINE_STRIP_ADJACENCY;
+        case PrimitiveTopology::TriangleListWithAdjacency: return GL_TRIANGLES_ADJACENCY;
+        case PrimitiveTopology::TriangleStripWithAdjacency: return GL_TRIANGLE_STRIP_ADJACENCY;
+        default: return GL_TRIANGLES;  // Patches need tessellation (GL 4.0+)
+    }
+}
+
 } // namespace VRHI
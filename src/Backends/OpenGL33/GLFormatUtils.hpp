@@ -4,6 +4,7 @@
 #pragma once
 
 #include <VRHI/Resources.hpp>
+#include <VRHI/Pipeline.hpp>
 #include <glad/glad.h>
 
 namespace VRHI {
@@ -28,6 +29,14 @@ public:
     /// @return OpenGL texture target (e.g., GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP)
     static GLenum GetTextureTarget(TextureType type);
     
+    /// Bytes per texel of an uncompressed format as uploaded with GetFormatAndType()
+    /// @return 0 for compressed formats
+    static uint32_t GetTexelSize(TextureFormat format);
+    
+    /// Bytes of a tightly packed width x height x depth image, compressed
+    /// formats counting whole 4x4 blocks
+    static uint64_t GetImageSize(TextureFormat format, uint32_t width, uint32_t height, uint32_t depth);
+    
     /// Check if a texture format is a compressed format
     /// @param format VRHI texture format
     /// @return True if compressed, false otherwise
@@ -37,6 +46,27 @@ public:
     /// @param format VRHI texture format
     /// @return True if depth/stencil, false otherwise
     static bool IsDepthStencilFormat(TextureFormat format);
+    
+    /// Check if a depth/stencil format has a stencil component
+    static bool HasStencil(TextureFormat format);
+    
+    /// Check if a color format holds unsigned integers (cleared with glClearBufferuiv)
+    static bool IsUnsignedIntegerFormat(TextureFormat format);
+    
+    /// Convert VRHI CompareOp to an OpenGL comparison function (e.g., GL_LESS)
+    static GLenum GetCompareFunc(CompareOp op);
+    
+    /// Convert VRHI BlendFactor to an OpenGL blend factor (e.g., GL_SRC_ALPHA)
+    static GLenum GetBlendFactor(BlendFactor factor);
+    
+    /// Convert VRHI BlendOp to an OpenGL blend equation (e.g., GL_FUNC_ADD)
+    static GLenum GetBlendEquation(BlendOp op);
+    
+    /// Convert VRHI StencilOp to an OpenGL stencil operation (e.g., GL_KEEP)
+    static GLenum GetStencilOp(StencilOp op);
+    
+    /// Convert VRHI PrimitiveTopology to an OpenGL primitive mode (e.g., GL_TRIANGLES)
+    static GLenum GetPrimitiveMode(PrimitiveTopology topology);
 };
 
 } // namespace VRHI
@@ -245,7 +245,7 @@ float OpenGL33Backend::CalculateScore(const FeatureRequirements& requirements) c
     }
     
     // Use the scoring system from BackendScorer
-    return BackendScorer::CalculateScore(BackendType::OpenGL33, m_features, requirements);
+    return BackendScorer::CalculateScore(GetType(), m_features, requirements);
 }
 
 std::expected<std::unique_ptr<Device>, Error>
@@ -26,7 +26,7 @@ public:
     std::expected<std::unique_ptr<Device>, Error>
     CreateDevice(const DeviceConfig& config) override;
     
-private:
+protected:
     void DetectFeatures();
     
     FeatureSet m_features;
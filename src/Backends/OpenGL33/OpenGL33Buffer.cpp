@@ -2,7 +2,11 @@
 // SPDX-License-Identifier: MIT
 
 #include "OpenGL33Buffer.hpp"
+#include "OpenGL33Device.hpp"
+#include "Core/BufferMapping.hpp"
+#include "Core/BufferStreaming.hpp"
 #include <VRHI/Logging.hpp>
+#include <cstring>
 
 namespace VRHI {
 
@@ -34,21 +38,29 @@ namespace {
     }
 }
 
-OpenGL33Buffer::OpenGL33Buffer(const BufferDesc& desc, GLuint buffer, GLenum target)
-    : m_desc(desc)
+OpenGL33Buffer::OpenGL33Buffer(OpenGL33Device& device, const BufferDesc& desc, GLuint buffer, GLenum target)
+    : m_device(&device)
+    , m_desc(desc)
     , m_buffer(buffer)
     , m_target(target)
 {
 }
 
 OpenGL33Buffer::~OpenGL33Buffer() {
-    if (m_buffer != 0) {
-        glDeleteBuffers(1, &m_buffer);
+    // Submitted draws may still read the buffer, and this may not be the context thread
+    auto& deletions = m_device->GetDeletionQueue();
+    if (!m_copies.empty()) {
+        for (const StreamCopy& copy : m_copies) {
+            deletions.Retire(copy.fence);
+            deletions.Retire(OpenGL33DeletionQueue::ObjectType::Buffer, copy.buffer);
+        }
+    } else {
+        deletions.Retire(OpenGL33DeletionQueue::ObjectType::Buffer, m_buffer);
     }
 }
 
 std::expected<std::unique_ptr<Buffer>, Error>
-OpenGL33Buffer::Create(const BufferDesc& desc) {
+OpenGL33Buffer::Create(OpenGL33Device& device, const BufferDesc& desc) {
     if (desc.size == 0) {
         return std::unexpected(Error{
             Error::Code::InvalidConfig,
@@ -56,6 +68,12 @@ OpenGL33Buffer::Create(const BufferDesc& desc) {
         });
     }
     
+    const BufferStreaming streaming = ResolveStreaming(desc);
+    if (const char* error = ValidateStreaming(desc, streaming)) {
+        return std::unexpected(Error{Error::Code::InvalidConfig, error});
+    }
+    const bool rotates = StreamingRotates(streaming);
+    
     GLuint buffer = 0;
     glGenBuffers(1, &buffer);
     
@@ -69,11 +87,15 @@ OpenGL33Buffer::Create(const BufferDesc& desc) {
     GLenum target = GetGLBufferTarget(desc.usage);
     GLenum usage = GetGLBufferUsage(desc.memoryAccess);
     
-    glBindBuffer(target, buffer);
-    glBufferData(target, desc.size, desc.initialData, usage);
+    // Uploads go through the copy-write target so that neither the bound VAO's
+    // index buffer nor any cached vertex/uniform binding is disturbed
+    auto& stateCache = device.GetStateCache();
+    stateCache.BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, desc.size, desc.initialData, usage);
     
     GLenum error = glGetError();
     if (error != GL_NO_ERROR) {
+        stateCache.OnBufferDeleted(buffer);
         glDeleteBuffers(1, &buffer);
         return std::unexpected(Error{
             Error::Code::InitializationFailed,
@@ -81,11 +103,29 @@ OpenGL33Buffer::Create(const BufferDesc& desc) {
         });
     }
     
-    glBindBuffer(target, 0);
-    
-    auto bufferObj = std::unique_ptr<Buffer>(
-        new OpenGL33Buffer(desc, buffer, target)
+    auto bufferObj = std::unique_ptr<OpenGL33Buffer>(
+        new OpenGL33Buffer(device, desc, buffer, target)
     );
+    bufferObj->m_streaming = streaming;
+    
+    // Every copy starts with the initial data; the destructor owns them from here
+    if (rotates) {
+        bufferObj->m_copies.resize(desc.streamingCopies);
+        bufferObj->m_copies[0].buffer = buffer;
+        for (uint32_t i = 1; i < desc.streamingCopies; ++i) {
+            GLuint copy = 0;
+            glGenBuffers(1, &copy);
+            stateCache.BindBuffer(GL_COPY_WRITE_BUFFER, copy);
+            glBufferData(GL_COPY_WRITE_BUFFER, desc.size, desc.initialData, usage);
+            bufferObj->m_copies[i].buffer = copy;
+            if (copy == 0 || glGetError() != GL_NO_ERROR) {
+                return std::unexpected(Error{
+                    Error::Code::OutOfMemory,
+                    "Failed to allocate streaming buffer copies"
+                });
+            }
+        }
+    }
     
     return bufferObj;
 }
@@ -103,58 +143,237 @@ void* OpenGL33Buffer::Map() {
 }
 
 void* OpenGL33Buffer::Map(size_t offset, size_t size) {
+    return Map(offset, size, MapAccess::Read | MapAccess::Write);
+}
+
+void* OpenGL33Buffer::Map(size_t offset, size_t size, MapAccess access) {
     if (m_mappedPtr != nullptr) {
         LogWarning("Buffer already mapped");
         return m_mappedPtr;
     }
+    if (const char* error = ValidateMapRequest(m_desc.size, offset, size, access)) {
+        LogError("%s", error);
+        return nullptr;
+    }
     
-    glBindBuffer(m_target, m_buffer);
+    FlushUploads();
     
-    // GL 3.0+ supports glMapBufferRange
-    GLbitfield access = GL_MAP_READ_BIT | GL_MAP_WRITE_BIT;
-    m_mappedPtr = glMapBufferRange(m_target, offset, size, access);
+    // A write-only map that discards its range is the frame's write of a
+    // streaming buffer; once the policy has found an idle copy, nothing has
+    // to wait for the GPU
+    const bool invalidates = static_cast<uint32_t>(access & (MapAccess::InvalidateRange | MapAccess::InvalidateBuffer));
+    if (invalidates && !HasMapAccess(access, MapAccess::Read)) {
+        const bool wholeBuffer = HasMapAccess(access, MapAccess::InvalidateBuffer);
+        if (BeginStreamingWrite(wholeBuffer ? 0 : offset, wholeBuffer ? m_desc.size : size)) {
+            access |= MapAccess::Unsynchronized;
+        }
+    }
+    
+    m_device->GetStateCache().BindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    m_mappedPtr = glMapBufferRange(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset),
+                                   static_cast<GLsizeiptr>(size), GetGLMapAccess(access));
     
     if (m_mappedPtr == nullptr) {
         LogError("Failed to map buffer");
+        return nullptr;
     }
-    
-    glBindBuffer(m_target, 0);
-    
+    m_mapOffset = offset;
+    m_mapSize = size;
+    m_mapAccess = access;
     return m_mappedPtr;
 }
 
+void OpenGL33Buffer::FlushRange(size_t offset, size_t size) {
+    if (m_mappedPtr == nullptr) {
+        LogError("FlushRange on a buffer that is not mapped");
+        return;
+    }
+    if (const char* error = ValidateFlushRange(m_mapOffset, m_mapSize, m_mapAccess, offset, size)) {
+        LogError("%s", error);
+        return;
+    }
+    
+    m_device->GetStateCache().BindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    glFlushMappedBufferRange(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset - m_mapOffset),
+                             static_cast<GLsizeiptr>(size));
+}
+
 void OpenGL33Buffer::Unmap() {
     if (m_mappedPtr == nullptr) {
         return;
     }
     
-    glBindBuffer(m_target, m_buffer);
-    glUnmapBuffer(m_target);
-    glBindBuffer(m_target, 0);
+    m_device->GetStateCache().BindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
     
     m_mappedPtr = nullptr;
 }
 
 void OpenGL33Buffer::Update(const void* data, size_t size, size_t offset) {
+    Upload(data, size, offset, false);
+}
+
+void OpenGL33Buffer::UpdateAsync(const void* data, size_t size, size_t offset) {
+    Upload(data, size, offset, true);
+}
+
+void OpenGL33Buffer::Read(void* data, size_t size, size_t offset) {
     if (offset + size > m_desc.size) {
-        LogError("Buffer update out of bounds");
+        LogError("Buffer read out of bounds");
         return;
     }
     
-    glBindBuffer(m_target, m_buffer);
-    glBufferSubData(m_target, offset, size, data);
-    glBindBuffer(m_target, 0);
+    FlushUploads();
+    m_device->GetStateCache().BindBuffer(GL_COPY_READ_BUFFER, m_buffer);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, offset, size, data);
 }
 
-void OpenGL33Buffer::Read(void* data, size_t size, size_t offset) {
+void OpenGL33Buffer::Upload(const void* data, size_t size, size_t offset, bool async) {
     if (offset + size > m_desc.size) {
-        LogError("Buffer read out of bounds");
+        LogError("Buffer update out of bounds");
+        return;
+    }
+    
+    auto& stateCache = m_device->GetStateCache();
+    const bool directStateAccess = m_device->GetProfile().directStateAccess;
+    if (BeginStreamingWrite(offset, size)) {
+        if (m_persistentPtr != nullptr) {
+            std::memcpy(static_cast<std::byte*>(m_persistentPtr) + offset, data, size);
+            return;
+        }
+        // No draw reads the range, so the driver has nothing to wait for
+        constexpr GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+        void* ptr = nullptr;
+        if (directStateAccess) {
+            ptr = glMapNamedBufferRange(m_buffer, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), access);
+        } else {
+            stateCache.BindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+            ptr = glMapBufferRange(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), access);
+        }
+        if (ptr) {
+            std::memcpy(ptr, data, size);
+            if (directStateAccess) {
+                glUnmapNamedBuffer(m_buffer);
+            } else {
+                glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            }
+            return;
+        }
+    }
+    
+    if (auto* uploads = m_device->GetUploadQueue()) {
+        uploads->UpdateBuffer(m_buffer, offset, data, size, async);
+        return;
+    }
+    if (directStateAccess) {
+        glNamedBufferSubData(m_buffer, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
         return;
     }
+    stateCache.BindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+}
+
+bool OpenGL33Buffer::BeginStreamingWrite(size_t offset, size_t size) {
+    const uint64_t frame = m_device->GetFrameNumber();
+    if (m_streaming == BufferStreaming::None || m_streamingFrame == frame) {
+        return false;
+    }
+    m_streamingFrame = frame;
     
-    glBindBuffer(m_target, m_buffer);
-    glGetBufferSubData(m_target, offset, size, data);
-    glBindBuffer(m_target, 0);
+    // Present() flushed the upload queue, so no staged copy targets the old contents
+    switch (m_streaming) {
+        case BufferStreaming::Orphan: {
+            // Orphaning drops the old contents, so partial writes update in place
+            if (offset != 0 || size != m_desc.size) {
+                return false;
+            }
+            m_device->GetStateCache().BindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+            glBufferData(GL_COPY_WRITE_BUFFER, m_desc.size, nullptr, GetGLBufferUsage(m_desc.memoryAccess));
+            return true;
+        }
+        case BufferStreaming::RoundRobin:
+            // Persistently mapped copies are fenced, so the next one is idle
+            Rotate(offset, size);
+            return m_persistentPtr != nullptr;
+        case BufferStreaming::Unsynchronized:
+            Rotate(offset, size);
+            return true;
+        default:
+            return false;
+    }
+}
+
+void OpenGL33Buffer::Rotate(size_t offset, size_t size) {
+    StreamCopy& previous = m_copies[m_currentCopy];
+    if (m_streaming == BufferStreaming::Unsynchronized || previous.persistent) {
+        // Every draw reading the retired copy has been submitted by now
+        previous.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    
+    m_currentCopy = (m_currentCopy + 1) % m_copies.size();
+    StreamCopy& next = m_copies[m_currentCopy];
+    if (next.fence) {
+        // Only stalls when the GPU is streamingCopies frames behind
+        GLenum status = GL_TIMEOUT_EXPIRED;
+        while (status == GL_TIMEOUT_EXPIRED) {
+            status = glClientWaitSync(next.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        }
+        glDeleteSync(next.fence);
+        next.fence = nullptr;
+    }
+    
+    // The copy is streamingCopies - 1 frames old; bring over what the write does not replace
+    const bool directStateAccess = m_device->GetProfile().directStateAccess;
+    if (!directStateAccess) {
+        auto& stateCache = m_device->GetStateCache();
+        stateCache.BindBuffer(GL_COPY_READ_BUFFER, previous.buffer);
+        stateCache.BindBuffer(GL_COPY_WRITE_BUFFER, next.buffer);
+    }
+    auto carryOver = [&](GLintptr start, GLsizeiptr length) {
+        if (directStateAccess) {
+            glCopyNamedBufferSubData(previous.buffer, next.buffer, start, start, length);
+        } else {
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, start, start, length);
+        }
+    };
+    if (offset > 0) {
+        carryOver(0, static_cast<GLsizeiptr>(offset));
+    }
+    if (offset + size < m_desc.size) {
+        const auto tail = static_cast<GLintptr>(offset + size);
+        carryOver(tail, static_cast<GLsizeiptr>(m_desc.size) - tail);
+    }
+    m_buffer = next.buffer;
+    m_persistentPtr = next.persistent;
+}
+
+GLbitfield OpenGL33Buffer::GetGLMapAccess(MapAccess access) noexcept {
+    GLbitfield bits = 0;
+    if (HasMapAccess(access, MapAccess::Read)) {
+        bits |= GL_MAP_READ_BIT;
+    }
+    if (HasMapAccess(access, MapAccess::Write)) {
+        bits |= GL_MAP_WRITE_BIT;
+    }
+    if (HasMapAccess(access, MapAccess::InvalidateRange)) {
+        bits |= GL_MAP_INVALIDATE_RANGE_BIT;
+    }
+    if (HasMapAccess(access, MapAccess::InvalidateBuffer)) {
+        bits |= GL_MAP_INVALIDATE_BUFFER_BIT;
+    }
+    if (HasMapAccess(access, MapAccess::Unsynchronized)) {
+        bits |= GL_MAP_UNSYNCHRONIZED_BIT;
+    }
+    if (HasMapAccess(access, MapAccess::FlushExplicit)) {
+        bits |= GL_MAP_FLUSH_EXPLICIT_BIT;
+    }
+    return bits;
+}
+
+void OpenGL33Buffer::FlushUploads() {
+    if (auto* uploads = m_device->GetUploadQueue()) {
+        uploads->Flush();
+    }
 }
 
 } // namespace VRHI
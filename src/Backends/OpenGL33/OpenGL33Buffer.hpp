@@ -8,16 +8,25 @@
 #include <glad/glad.h>
 #include <expected>
 #include <memory>
+#include <vector>
 
 namespace VRHI {
 
+class OpenGL33Device;
+
 /// OpenGL 3.3 buffer implementation
+///
+/// Streaming buffers (BufferDesc::streaming) keep several copies and move to
+/// the next one at the first write of each frame, so that the write does not
+/// have to wait for draws still reading the previous frame's contents.
+/// GetHandle() always names the current copy and command buffers resolve it
+/// when they execute.
 class OpenGL33Buffer : public Buffer {
 public:
     ~OpenGL33Buffer() override;
     
     static std::expected<std::unique_ptr<Buffer>, Error>
-    Create(const BufferDesc& desc);
+    Create(OpenGL33Device& device, const BufferDesc& desc);
     
     // Buffer interface
     size_t GetSize() const noexcept override;
@@ -25,22 +34,66 @@ public:
     
     void* Map() override;
     void* Map(size_t offset, size_t size) override;
+    void* Map(size_t offset, size_t size, MapAccess access) override;
+    void FlushRange(size_t offset, size_t size) override;
     void Unmap() override;
     
     void Update(const void* data, size_t size, size_t offset = 0) override;
+    void UpdateAsync(const void* data, size_t size, size_t offset = 0) override;
     void Read(void* data, size_t size, size_t offset = 0) override;
     
-    // OpenGL-specific
+    // OpenGL-specific: the current copy of streaming buffers
     GLuint GetHandle() const noexcept { return m_buffer; }
     GLenum GetTarget() const noexcept { return m_target; }
     
-private:
-    OpenGL33Buffer(const BufferDesc& desc, GLuint buffer, GLenum target);
+    /// OpenGL-specific: start of a persistent, coherent mapping of the whole
+    /// buffer (see OpenGL46Buffer), or nullptr
+    void* GetPersistentMapping() const noexcept { return m_persistentPtr; }
+    
+protected:
+    OpenGL33Buffer(OpenGL33Device& device, const BufferDesc& desc, GLuint buffer, GLenum target);
+    
+    /// Write through the device's upload queue, or directly if it is gone
+    void Upload(const void* data, size_t size, size_t offset, bool async);
+    
+    /// Issue staged updates before the CPU touches the buffer's contents
+    void FlushUploads();
+    
+    /// glMapBufferRange access bits for Map() flags
+    static GLbitfield GetGLMapAccess(MapAccess access) noexcept;
     
+    /// A RoundRobin or Unsynchronized copy and the fence of the draws that
+    /// read it before the buffer moved on (Unsynchronized and persistently
+    /// mapped copies only)
+    struct StreamCopy {
+        GLuint buffer = 0;
+        GLsync fence = nullptr;
+        void* persistent = nullptr;  ///< Persistent mapping of the copy, if any
+    };
+    
+    /// Apply the streaming policy before the first write of a frame
+    /// @return True if the written range is known not to be read by the GPU
+    bool BeginStreamingWrite(size_t offset, size_t size);
+    
+    OpenGL33Device* m_device = nullptr;
     BufferDesc m_desc;
     GLuint m_buffer = 0;
     GLenum m_target = GL_ARRAY_BUFFER;
     void* m_mappedPtr = nullptr;
+    void* m_persistentPtr = nullptr;  ///< Mapping of the current copy
+    size_t m_mapOffset = 0;  ///< Range and flags of the current Map()
+    size_t m_mapSize = 0;
+    MapAccess m_mapAccess = MapAccess::Read;
+    
+    BufferStreaming m_streaming = BufferStreaming::None;
+    std::vector<StreamCopy> m_copies;  ///< Every copy, m_buffer among them; empty unless rotating
+    
+private:
+    /// Move to the next copy and carry over what the write leaves untouched
+    void Rotate(size_t offset, size_t size);
+    
+    size_t m_currentCopy = 0;
+    uint64_t m_streamingFrame = ~0ull;  ///< Frame of the last write
 };
 
 } // namespace VRHI
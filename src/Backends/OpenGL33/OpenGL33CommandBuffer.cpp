@@ -2,374 +2,937 @@
 // SPDX-License-Identifier: MIT
 
 #include "OpenGL33CommandBuffer.hpp"
+#include "OpenGL33Device.hpp"
 #include "OpenGL33Buffer.hpp"
 #include "OpenGL33Pipeline.hpp"
 #include "OpenGL33Texture.hpp"
 #include "OpenGL33Sampler.hpp"
+#include "OpenGL33RenderPass.hpp"
+#include "OpenGL33Framebuffer.hpp"
+#include "GLFormatUtils.hpp"
 #include <VRHI/Logging.hpp>
+#include <VRHI/ShaderCompiler.hpp>
 #include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
 
 namespace VRHI {
 
 namespace {
-    // Helper function to convert VertexFormat to OpenGL type info
-    struct VertexFormatInfo {
-        GLint componentCount;
-        GLenum type;
-        GLboolean normalized;
-    };
-    
-    VertexFormatInfo GetVertexFormatInfo(VertexFormat format) {
-        switch (format) {
-            case VertexFormat::Float:    return {1, GL_FLOAT, GL_FALSE};
-            case VertexFormat::Float2:   return {2, GL_FLOAT, GL_FALSE};
-            case VertexFormat::Float3:   return {3, GL_FLOAT, GL_FALSE};
-            case VertexFormat::Float4:   return {4, GL_FLOAT, GL_FALSE};
-            case VertexFormat::Int:      return {1, GL_INT, GL_FALSE};
-            case VertexFormat::Int2:     return {2, GL_INT, GL_FALSE};
-            case VertexFormat::Int3:     return {3, GL_INT, GL_FALSE};
-            case VertexFormat::Int4:     return {4, GL_INT, GL_FALSE};
-            case VertexFormat::UInt:     return {1, GL_UNSIGNED_INT, GL_FALSE};
-            case VertexFormat::UInt2:    return {2, GL_UNSIGNED_INT, GL_FALSE};
-            case VertexFormat::UInt3:    return {3, GL_UNSIGNED_INT, GL_FALSE};
-            case VertexFormat::UInt4:    return {4, GL_UNSIGNED_INT, GL_FALSE};
-            default:                     return {3, GL_FLOAT, GL_FALSE};
+    /// Translates a recorded command stream into GL calls.
+    /// Holds the state that GL needs at draw time but only learns from
+    /// earlier commands (bound pipeline, vertex input, index type). All state
+    /// changes go through the device's state cache so redundant calls are
+    /// dropped; vertex input is resolved to a cached VAO at draw time.
+    ///
+    /// Push constants live in a uniform block at PushConstantBinding. Before
+    /// replaying, every block state a draw will see is snapshotted and all
+    /// snapshots are uploaded to the device's uniform ring at once; draws then
+    /// only bind their range.
+    ///
+    /// Indirect draws need a device whose profile enables them (the GL 4.6
+    /// backend); otherwise they are skipped with a warning. Without that
+    /// profile, compute pipelines hold a kernel compiled for the CPU: storage
+    /// and uniform buffer bindings are remembered, and dispatches copy the
+    /// bound ranges to memory, run the kernel there and copy back the
+    /// buffers it may write.
+    class CommandReplayer {
+    public:
+        CommandReplayer(OpenGL33Device& device, OpenGL33CommandBuffer::ReplayScratch& scratch)
+            : m_device(device)
+            , m_state(device.GetStateCache())
+            , m_vertexArrays(device.GetVertexArrayCache())
+            , m_uniformRing(device.GetUniformRing())
+            , m_scratch(scratch)
+            , m_mergeDraws(device.IsDrawMergingEnabled())
+            , m_computeAndIndirect(device.GetProfile().computeAndIndirect)
+            , m_pushConstantStride(AlignUp(MaxPushConstantSize, m_uniformRing.GetAlignment()))
+        {
         }
-    }
-} // anonymous namespace
-
-void OpenGL33CommandBuffer::Begin() {
-    m_state = CommandBufferState::Recording;
-}
-
-void OpenGL33CommandBuffer::End() {
-    m_state = CommandBufferState::Executable;
-}
-
-void OpenGL33CommandBuffer::Reset() {
-    m_state = CommandBufferState::Initial;
-}
-
-CommandBufferState OpenGL33CommandBuffer::GetState() const noexcept {
-    return m_state;
-}
-
-void OpenGL33CommandBuffer::BeginRenderPass(RenderPass* renderPass, Framebuffer* framebuffer, const Rect2D& renderArea) {
-    // In OpenGL, we would bind the framebuffer here
-}
-
-void OpenGL33CommandBuffer::EndRenderPass() {
-    // Unbind framebuffer
-}
-
-void OpenGL33CommandBuffer::BindPipeline(Pipeline* pipeline) {
-    // Bind shader program
-    if (pipeline) {
-        auto* glPipeline = static_cast<OpenGL33Pipeline*>(pipeline);
-        glUseProgram(glPipeline->GetHandle());
-        m_currentPipeline = pipeline;  // Track for vertex layout
-        
-        // Apply pipeline state for graphics pipelines
-        if (glPipeline->GetType() == PipelineType::Graphics) {
-            const auto& depthStencil = glPipeline->GetDepthStencilState();
-            const auto& rasterization = glPipeline->GetRasterizationState();
-            
-            // Depth test
-            if (depthStencil.depthTestEnable) {
-                glEnable(GL_DEPTH_TEST);
-                glDepthFunc(GL_LESS);  // TODO: Map from depthCompareOp
-                glDepthMask(depthStencil.depthWriteEnable ? GL_TRUE : GL_FALSE);
-            } else {
-                glDisable(GL_DEPTH_TEST);
+        
+        /// Replay a primary command stream
+        void Replay(const CommandStream& stream) {
+            UploadPushConstants(stream);
+            Execute(stream);
+        }
+        
+        void Execute(const CommandStream& stream) {
+            for (auto it = stream.begin(); it != stream.end();) {
+                if (m_mergeDraws && IsMergeable(*it)) {
+                    it = DrawIndexedRun(it, stream.end());
+                } else {
+                    Dispatch(*it);
+                    ++it;
+                }
+            }
+        }
+        
+        uint64_t GetDrawCalls() const noexcept { return m_drawCalls; }
+        uint64_t GetDrawsMerged() const noexcept { return m_drawsMerged; }
+        
+    private:
+        static GLsizeiptr AlignUp(GLsizeiptr value, GLsizeiptr alignment) noexcept {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+        
+        /// Secondaries that Execute() replays; others are skipped
+        static const RecordingCommandBuffer* GetReplayable(CommandBuffer* secondary) noexcept {
+            auto* recorded = static_cast<const RecordingCommandBuffer*>(secondary);
+            return recorded->GetState() == CommandBufferState::Recording ? nullptr : recorded;
+        }
+        
+        void UploadPushConstants(const CommandStream& stream) {
+            m_scratch.pushConstants.clear();
+            GatherPushConstants(stream);
+            m_pushConstantsDirty = false;
+            if (!m_scratch.pushConstants.empty()) {
+                m_pushConstantBase = m_uniformRing.Upload(m_scratch.pushConstants);
+            }
+        }
+        
+        /// Snapshot the block at every draw that Execute() will flush it for
+        void GatherPushConstants(const CommandStream& stream) {
+            for (const CommandHeader& header : stream) {
+                switch (header.type) {
+                    case CommandType::PushConstants: {
+                        const auto& cmd = header.As<CmdPushConstants>();
+                        std::ranges::copy(cmd.GetData(), m_pushConstants.begin() + cmd.offset);
+                        m_pushConstantsDirty = true;
+                        break;
+                    }
+                    case CommandType::Draw:
+                    case CommandType::DrawIndexed:
+                    case CommandType::DrawIndirect:
+                    case CommandType::DrawIndexedIndirect:
+                    case CommandType::Dispatch:
+                    case CommandType::DispatchIndirect:
+                        if (m_pushConstantsDirty) {
+                            const size_t offset = m_scratch.pushConstants.size();
+                            m_scratch.pushConstants.resize(offset + static_cast<size_t>(m_pushConstantStride));
+                            std::memcpy(m_scratch.pushConstants.data() + offset, m_pushConstants.data(), m_pushConstants.size());
+                            m_pushConstantsDirty = false;
+                        }
+                        break;
+                    case CommandType::ExecuteCommands:
+                        for (CommandBuffer* secondary : header.As<CmdExecuteCommands>().GetCommandBuffers()) {
+                            if (const RecordingCommandBuffer* recorded = GetReplayable(secondary)) {
+                                GatherPushConstants(recorded->GetCommandStream());
+                            }
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+        
+        /// Bind the next snapshot if the block changed since the last draw
+        void FlushPushConstants() {
+            if (!m_pushConstantsDirty) {
+                return;
             }
+            m_state.BindBufferRange(GL_UNIFORM_BUFFER, PushConstantBinding, m_uniformRing.GetHandle(),
+                                    m_pushConstantBase, MaxPushConstantSize);
+            m_pushConstantBase += m_pushConstantStride;
+            m_pushConstantSnapshot = m_nextPushConstantSnapshot;
+            m_nextPushConstantSnapshot += static_cast<size_t>(m_pushConstantStride);
+            m_pushConstantsDirty = false;
+        }
+        
+        void Dispatch(const CommandHeader& header) {
+            switch (header.type) {
+                case CommandType::BeginRenderPass:
+                    BeginRenderPass(header.As<CmdBeginRenderPass>());
+                    break;
+                case CommandType::EndRenderPass:
+                    // Nothing to resolve; only discarded contents are dropped
+                    InvalidateAttachments(false);
+                    m_renderPass = nullptr;
+                    break;
+                case CommandType::BindPipeline:
+                    BindPipeline(header.As<CmdBindPipeline>());
+                    break;
+                case CommandType::BindVertexBuffers:
+                    BindVertexBuffers(header.As<CmdBindVertexBuffers>());
+                    break;
+                case CommandType::BindIndexBuffer:
+                    BindIndexBuffer(header.As<CmdBindIndexBuffer>());
+                    break;
+                case CommandType::BindUniformBuffer:
+                    BindUniformBuffer(header.As<CmdBindUniformBuffer>());
+                    break;
+                case CommandType::BindTexture:
+                    BindTexture(header.As<CmdBindTexture>());
+                    break;
+                case CommandType::PushConstants:
+                    // Uploaded by UploadPushConstants(); bound at the next draw
+                    m_pushConstantsDirty = true;
+                    break;
+                case CommandType::BindStorageBuffer:
+                    BindStorageBuffer(header.As<CmdBindStorageBuffer>());
+                    break;
+                case CommandType::SetViewports: {
+                    // GL 3.3 has a single viewport
+                    auto viewports = header.As<CmdSetViewports>().GetViewports();
+                    if (!viewports.empty()) {
+                        const Viewport& viewport = viewports[0];
+                        m_state.SetViewport(static_cast<GLint>(viewport.x), static_cast<GLint>(viewport.y),
+                                            static_cast<GLsizei>(viewport.width), static_cast<GLsizei>(viewport.height));
+                        m_state.SetDepthRange(viewport.minDepth, viewport.maxDepth);
+                    }
+                    break;
+                }
+                case CommandType::SetScissors: {
+                    auto scissors = header.As<CmdSetScissors>().GetScissors();
+                    if (!scissors.empty()) {
+                        m_state.SetScissor(scissors[0].x, scissors[0].y,
+                                           static_cast<GLsizei>(scissors[0].width), static_cast<GLsizei>(scissors[0].height));
+                    }
+                    break;
+                }
+                case CommandType::SetLineWidth:
+                    m_state.SetLineWidth(header.As<CmdSetLineWidth>().width);
+                    break;
+                case CommandType::SetBlendConstants: {
+                    const auto& cmd = header.As<CmdSetBlendConstants>();
+                    m_state.SetBlendColor(cmd.constants[0], cmd.constants[1], cmd.constants[2], cmd.constants[3]);
+                    break;
+                }
+                case CommandType::SetDepthBias: {
+                    const auto& cmd = header.As<CmdSetDepthBias>();
+                    m_state.SetPolygonOffset(cmd.slopeFactor, cmd.constantFactor);
+                    break;
+                }
+                case CommandType::SetDepthBounds:
+                    // Not directly supported in GL 3.3
+                    break;
+                case CommandType::SetStencilCompareMask: {
+                    const auto& cmd = header.As<CmdSetStencilValue>();
+                    m_state.SetStencilCompareMask(cmd.frontFace ? GL_FRONT : GL_BACK, cmd.value);
+                    break;
+                }
+                case CommandType::SetStencilWriteMask: {
+                    const auto& cmd = header.As<CmdSetStencilValue>();
+                    m_stencilWriteMasks[cmd.frontFace ? 0 : 1] = cmd.value;
+                    m_state.SetStencilWriteMask(cmd.frontFace ? GL_FRONT : GL_BACK, cmd.value);
+                    break;
+                }
+                case CommandType::SetStencilReference: {
+                    const auto& cmd = header.As<CmdSetStencilValue>();
+                    m_state.SetStencilReference(cmd.frontFace ? GL_FRONT : GL_BACK, static_cast<GLint>(cmd.value));
+                    break;
+                }
+                case CommandType::Draw:
+                    Draw(header.As<CmdDraw>().params);
+                    break;
+                case CommandType::DrawIndexed:
+                    DrawIndexed(header.As<CmdDrawIndexed>().params);
+                    break;
+                case CommandType::DrawIndirect:
+                    DrawIndirect(header.As<CmdDrawIndirect>(), false);
+                    break;
+                case CommandType::DrawIndexedIndirect:
+                    DrawIndirect(header.As<CmdDrawIndexedIndirect>(), true);
+                    break;
+                case CommandType::Dispatch:
+                    Dispatch(header.As<CmdDispatch>().params);
+                    break;
+                case CommandType::DispatchIndirect:
+                    DispatchIndirect(header.As<CmdDispatchIndirect>());
+                    break;
+                case CommandType::ClearColorAttachment: {
+                    const auto& cmd = header.As<CmdClearColorAttachment>();
+                    ScissorClears(cmd.rect);
+                    ClearColor(cmd.attachment, IsUnsignedIntegerAttachment(cmd.attachment), cmd.color);
+                    m_state.SetScissorTest(false);
+                    RestoreWriteMasks();
+                    break;
+                }
+                case CommandType::ClearDepthStencilAttachment: {
+                    const auto& cmd = header.As<CmdClearDepthStencilAttachment>();
+                    ScissorClears(cmd.rect);
+                    ClearDepthStencil(true, true, cmd.value);
+                    m_state.SetScissorTest(false);
+                    RestoreWriteMasks();
+                    break;
+                }
+                case CommandType::CopyBuffer:
+                    CopyBuffer(header.As<CmdCopyBuffer>());
+                    break;
+                case CommandType::CopyTextureToBuffer:
+                    CopyTextureToBuffer(header.As<CmdCopyTextureToBuffer>());
+                    break;
+                case CommandType::CopyBufferToTexture:
+                case CommandType::CopyTexture:
+                    // Would use PBO uploads or FBO blits
+                    break;
+                case CommandType::PipelineBarrier:
+                    // Only incoherent shader writes (storage buffers) need
+                    // one; other GL hazards are tracked by the driver
+                    if (m_computeAndIndirect) {
+                        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+                    }
+                    break;
+                case CommandType::BeginDebugMarker:
+                    if (GLAD_GL_KHR_debug) {
+                        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, header.As<CmdBeginDebugMarker>().GetName());
+                    }
+                    break;
+                case CommandType::EndDebugMarker:
+                    if (GLAD_GL_KHR_debug) {
+                        glPopDebugGroup();
+                    }
+                    break;
+                case CommandType::InsertDebugMarker:
+                    if (GLAD_GL_KHR_debug) {
+                        glDebugMessageInsert(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_MARKER, 0,
+                                             GL_DEBUG_SEVERITY_NOTIFICATION, -1,
+                                             header.As<CmdInsertDebugMarker>().GetName());
+                    }
+                    break;
+                case CommandType::ExecuteCommands:
+                    ExecuteCommands(header.As<CmdExecuteCommands>());
+                    break;
+            }
+        }
+        
+        void BeginRenderPass(const CmdBeginRenderPass& cmd) {
+            m_renderPass = static_cast<const OpenGL33RenderPass*>(cmd.renderPass);
+            m_framebuffer = static_cast<const OpenGL33Framebuffer*>(cmd.framebuffer);
+            m_renderArea = cmd.renderArea;
+            m_state.BindFramebuffer(m_framebuffer ? m_framebuffer->GetHandle() : 0);
+            if (!m_renderPass) {
+                return;
+            }
+            
+            // Contents that are not loaded need not be read back into the tiler
+            InvalidateAttachments(true);
+            
+            // All Clear load ops in one pass, confined to the render area
+            auto clearValues = cmd.GetClearValues();
+            const auto& attachments = m_renderPass->GetAttachments();
+            for (size_t i = 0; i < attachments.size(); ++i) {
+                const GLRenderPassAttachment& attachment = attachments[i];
+                const ClearValue value = i < clearValues.size() ? clearValues[i] : ClearValue{};
+                const bool clear = attachment.desc.loadOp == AttachmentLoadOp::Clear;
+                if (!attachment.isDepthStencil) {
+                    if (clear) {
+                        ScissorClears(m_renderArea);
+                        ClearColor(attachment.colorIndex, attachment.isUnsignedInteger, value.color);
+                    }
+                    continue;
+                }
+                
+                const bool clearStencil = attachment.hasStencil && attachment.desc.stencilLoadOp == AttachmentLoadOp::Clear;
+                if (clear || clearStencil) {
+                    ScissorClears(m_renderArea);
+                    ClearDepthStencil(clear, clearStencil, value.depthStencil);
+                }
+            }
+            m_state.SetScissorTest(false);
+            RestoreWriteMasks();
+        }
+        
+        /// Discard the attachments whose load (or store) op is DontCare
+        void InvalidateAttachments(bool atLoad) {
+            if (!m_renderPass || !GLAD_GL_ARB_invalidate_subdata) {
+                return;
+            }
+            
+            auto discarded = [atLoad](AttachmentLoadOp loadOp, AttachmentStoreOp storeOp) {
+                return atLoad ? loadOp == AttachmentLoadOp::DontCare : storeOp == AttachmentStoreOp::DontCare;
+            };
             
-            // Face culling
-            if (rasterization.cullMode != CullMode::None) {
-                glEnable(GL_CULL_FACE);
-                glCullFace(rasterization.cullMode == CullMode::Front ? GL_FRONT : GL_BACK);
-                glFrontFace(rasterization.frontFace == FrontFace::Clockwise ? GL_CW : GL_CCW);
+            // The default framebuffer names its buffers differently
+            const bool isDefault = !m_framebuffer;
+            auto& targets = m_scratch.invalidatedAttachments;
+            targets.clear();
+            for (const GLRenderPassAttachment& attachment : m_renderPass->GetAttachments()) {
+                const AttachmentDesc& desc = attachment.desc;
+                if (!attachment.isDepthStencil) {
+                    if (discarded(desc.loadOp, desc.storeOp)) {
+                        targets.push_back(isDefault ? GL_COLOR : GL_COLOR_ATTACHMENT0 + attachment.colorIndex);
+                    }
+                    continue;
+                }
+                if (discarded(desc.loadOp, desc.storeOp)) {
+                    targets.push_back(isDefault ? GL_DEPTH : GL_DEPTH_ATTACHMENT);
+                }
+                if (attachment.hasStencil && discarded(desc.stencilLoadOp, desc.stencilStoreOp)) {
+                    targets.push_back(isDefault ? GL_STENCIL : GL_STENCIL_ATTACHMENT);
+                }
+            }
+            if (targets.empty()) {
+                return;
+            }
+            
+            const auto count = static_cast<GLsizei>(targets.size());
+            const bool wholeFramebuffer = m_framebuffer && m_renderArea.x == 0 && m_renderArea.y == 0 &&
+                m_renderArea.width >= m_framebuffer->GetWidth() && m_renderArea.height >= m_framebuffer->GetHeight();
+            if (wholeFramebuffer) {
+                glInvalidateFramebuffer(GL_FRAMEBUFFER, count, targets.data());
             } else {
-                glDisable(GL_CULL_FACE);
+                glInvalidateSubFramebuffer(GL_FRAMEBUFFER, count, targets.data(), m_renderArea.x, m_renderArea.y,
+                                           static_cast<GLsizei>(m_renderArea.width), static_cast<GLsizei>(m_renderArea.height));
             }
         }
-    }
-}
-
-void OpenGL33CommandBuffer::BindVertexBuffers(uint32_t firstBinding, std::span<Buffer* const> buffers, std::span<const uint64_t> offsets) {
-    // Get vertex layout from the currently bound pipeline
-    if (!m_currentPipeline) {
-        LogWarning("BindVertexBuffers called without a bound pipeline");
-        return;
-    }
-    
-    auto* glPipeline = static_cast<OpenGL33Pipeline*>(m_currentPipeline);
-    const auto& vertexInput = glPipeline->GetVertexInputState();
-    
-    if (vertexInput.attributes.empty() || vertexInput.bindings.empty()) {
-        LogWarning("Pipeline has no vertex input layout defined");
-        return;
-    }
-    
-    // Bind vertex buffers and set up attributes according to the pipeline's vertex layout
-    for (const auto& binding : vertexInput.bindings) {
-        if (binding.binding < firstBinding || binding.binding >= firstBinding + buffers.size()) {
-            continue;
+        
+        /// Confine the following glClearBuffer* calls to `rect`
+        void ScissorClears(const Rect2D& rect) {
+            m_state.SetScissor(rect.x, rect.y, static_cast<GLsizei>(rect.width), static_cast<GLsizei>(rect.height));
+            m_state.SetScissorTest(true);
+        }
+        
+        void ClearColor(uint32_t drawBuffer, bool isUnsignedInteger, const ClearColorValue& color) {
+            m_state.SetColorMask(0xF);  // Clears honour the write mask
+            const auto buffer = static_cast<GLint>(drawBuffer);
+            if (isUnsignedInteger) {
+                glClearBufferuiv(GL_COLOR, buffer, color.uint32);
+            } else {
+                glClearBufferfv(GL_COLOR, buffer, color.float32);
+            }
+        }
+        
+        void ClearDepthStencil(bool depth, bool stencil, const ClearDepthStencilValue& value) {
+            // Clears honour the write masks
+            if (depth) {
+                m_state.SetDepthMask(true);
+            }
+            if (stencil) {
+                m_state.SetStencilWriteMask(GL_FRONT, 0xFF);
+                m_state.SetStencilWriteMask(GL_BACK, 0xFF);
+            }
+            
+            const auto stencilValue = static_cast<GLint>(value.stencil);
+            if (depth && stencil) {
+                glClearBufferfi(GL_DEPTH_STENCIL, 0, value.depth, stencilValue);
+            } else if (depth) {
+                glClearBufferfv(GL_DEPTH, 0, &value.depth);
+            } else if (stencil) {
+                glClearBufferiv(GL_STENCIL, 0, &stencilValue);
+            }
         }
         
-        uint32_t bufferIndex = binding.binding - firstBinding;
-        if (!buffers[bufferIndex]) {
-            continue;
+        /// Put back the write masks of the bound graphics pipeline, which
+        /// clears override; the next draw would otherwise write through them
+        void RestoreWriteMasks() {
+            if (!m_graphicsState) {
+                return;
+            }
+            m_state.SetColorMask(m_graphicsState->colorWriteMask);
+            if (m_graphicsState->depthTest) {
+                m_state.SetDepthMask(m_graphicsState->depthWrite);
+            }
+            if (m_graphicsState->stencilTest) {
+                m_state.SetStencilWriteMask(GL_FRONT, m_stencilWriteMasks[0]);
+                m_state.SetStencilWriteMask(GL_BACK, m_stencilWriteMasks[1]);
+            }
         }
         
-        auto* glBuffer = static_cast<OpenGL33Buffer*>(buffers[bufferIndex]);
-        glBindBuffer(GL_ARRAY_BUFFER, glBuffer->GetHandle());
+        /// Whether color attachment `drawBuffer` of the current pass stores unsigned integers
+        bool IsUnsignedIntegerAttachment(uint32_t drawBuffer) const noexcept {
+            if (!m_renderPass) {
+                return false;
+            }
+            for (const GLRenderPassAttachment& attachment : m_renderPass->GetAttachments()) {
+                if (!attachment.isDepthStencil && attachment.colorIndex == drawBuffer) {
+                    return attachment.isUnsignedInteger;
+                }
+            }
+            return false;
+        }
+        
+        void ExecuteCommands(const CmdExecuteCommands& cmd) {
+            // Secondaries are replayed inline from their own streams, so a
+            // bundle recorded once can be executed every frame
+            for (CommandBuffer* secondary : cmd.GetCommandBuffers()) {
+                const RecordingCommandBuffer* recorded = GetReplayable(secondary);
+                if (!recorded) {
+                    LogWarning("Skipping a secondary command buffer that is still recording");
+                    continue;
+                }
+                Execute(recorded->GetCommandStream());
+            }
+        }
         
-        // Set up all attributes that use this binding
-        for (const auto& attr : vertexInput.attributes) {
-            if (attr.binding == binding.binding) {
-                auto formatInfo = GetVertexFormatInfo(attr.format);
+        void BindPipeline(const CmdBindPipeline& cmd) {
+            if (!cmd.pipeline) {
+                return;
+            }
+            
+            auto* glPipeline = static_cast<OpenGL33Pipeline*>(cmd.pipeline);
+            m_cpuKernel = glPipeline->GetCpuKernel();
+            if (m_cpuKernel) {
+                return;
+            }
+            m_state.UseProgram(glPipeline->GetHandle());
+            
+            // Apply pipeline state for graphics pipelines
+            if (glPipeline->GetType() == PipelineType::Graphics) {
+                m_graphicsState = &glPipeline->GetGLState();
+                m_state.ApplyPipelineState(*m_graphicsState);
+                m_primitiveMode = m_graphicsState->primitiveMode;
+                m_stencilWriteMasks = {m_graphicsState->stencilFront.writeMask, m_graphicsState->stencilBack.writeMask};
                 
-                glEnableVertexAttribArray(attr.location);
-                glVertexAttribPointer(
-                    attr.location,
-                    formatInfo.componentCount,
-                    formatInfo.type,
-                    formatInfo.normalized,
-                    binding.stride,
-                    reinterpret_cast<const void*>(static_cast<uintptr_t>(attr.offset))
-                );
+                const GLVertexLayout* layout = &glPipeline->GetVertexLayout();
+                if (layout != m_vertexArrayKey.layout) {
+                    m_vertexArrayKey.layout = layout;
+                    m_vertexInputDirty = true;
+                }
             }
         }
-    }
-}
-
-void OpenGL33CommandBuffer::BindIndexBuffer(Buffer* buffer, uint64_t offset, bool use16BitIndices) {
-    if (!buffer) {
-        LogWarning("BindIndexBuffer called with null buffer");
-        return;
-    }
-    
-    // Store the index type for later use in DrawIndexed
-    m_indexType = use16BitIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
-    
-    // Bind the index buffer
-    auto* glBuffer = static_cast<OpenGL33Buffer*>(buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, glBuffer->GetHandle());
-}
-
-void OpenGL33CommandBuffer::SetViewport(const Viewport& viewport) {
-    glViewport(static_cast<GLint>(viewport.x), static_cast<GLint>(viewport.y),
-              static_cast<GLsizei>(viewport.width), static_cast<GLsizei>(viewport.height));
-    glDepthRange(viewport.minDepth, viewport.maxDepth);
-}
-
-void OpenGL33CommandBuffer::SetViewports(std::span<const Viewport> viewports) {
-    if (!viewports.empty()) {
-        SetViewport(viewports[0]);
-    }
-}
-
-void OpenGL33CommandBuffer::SetScissor(const Rect2D& scissor) {
-    glScissor(scissor.x, scissor.y, scissor.width, scissor.height);
-}
-
-void OpenGL33CommandBuffer::SetScissors(std::span<const Rect2D> scissors) {
-    if (!scissors.empty()) {
-        SetScissor(scissors[0]);
-    }
-}
-
-void OpenGL33CommandBuffer::SetLineWidth(float width) {
-    glLineWidth(width);
-}
-
-void OpenGL33CommandBuffer::SetBlendConstants(const float blendConstants[4]) {
-    glBlendColor(blendConstants[0], blendConstants[1], blendConstants[2], blendConstants[3]);
-}
-
-void OpenGL33CommandBuffer::SetDepthBias(float constantFactor, float clamp, float slopeFactor) {
-    glPolygonOffset(slopeFactor, constantFactor);
-}
-
-void OpenGL33CommandBuffer::SetDepthBounds(float minDepth, float maxDepth) {
-    // Not directly supported in GL 3.3
-}
-
-void OpenGL33CommandBuffer::SetStencilCompareMask(bool frontFace, uint32_t compareMask) {
-    glStencilMaskSeparate(frontFace ? GL_FRONT : GL_BACK, compareMask);
-}
-
-void OpenGL33CommandBuffer::SetStencilWriteMask(bool frontFace, uint32_t writeMask) {
-    glStencilMaskSeparate(frontFace ? GL_FRONT : GL_BACK, writeMask);
-}
-
-void OpenGL33CommandBuffer::SetStencilReference(bool frontFace, uint32_t reference) {
-    // Store for later use with glStencilFunc
-}
-
-void OpenGL33CommandBuffer::Draw(const DrawParams& params) {
-    Draw(params.vertexCount, params.instanceCount, params.firstVertex, params.firstInstance);
-}
-
-void OpenGL33CommandBuffer::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) {
-    if (instanceCount > 1) {
-        glDrawArraysInstanced(GL_TRIANGLES, firstVertex, vertexCount, instanceCount);
-    } else {
-        glDrawArrays(GL_TRIANGLES, firstVertex, vertexCount);
-    }
-}
-
-void OpenGL33CommandBuffer::DrawIndexed(const DrawIndexedParams& params) {
-    DrawIndexed(params.indexCount, params.instanceCount, params.firstIndex, params.vertexOffset, params.firstInstance);
-}
-
-void OpenGL33CommandBuffer::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) {
-    // Calculate index offset based on the actual index type size
-    size_t indexSize = (m_indexType == GL_UNSIGNED_SHORT) ? sizeof(uint16_t) : sizeof(uint32_t);
-    const void* indices = reinterpret_cast<const void*>(static_cast<uintptr_t>(firstIndex * indexSize));
-    
-    if (instanceCount > 1) {
-        glDrawElementsInstanced(GL_TRIANGLES, indexCount, m_indexType, indices, instanceCount);
-    } else {
-        glDrawElements(GL_TRIANGLES, indexCount, m_indexType, indices);
-    }
-}
-
-void OpenGL33CommandBuffer::DrawIndirect(Buffer* buffer, uint64_t offset, uint32_t drawCount, uint32_t stride) {
-    // GL 4.0+ feature
-    LogWarning("DrawIndirect not supported in OpenGL 3.3");
-}
-
-void OpenGL33CommandBuffer::DrawIndexedIndirect(Buffer* buffer, uint64_t offset, uint32_t drawCount, uint32_t stride) {
-    // GL 4.0+ feature
-    LogWarning("DrawIndexedIndirect not supported in OpenGL 3.3");
-}
-
-void OpenGL33CommandBuffer::Dispatch(const DispatchParams& params) {
-    LogWarning("Compute shaders not supported in OpenGL 3.3");
-}
-
-void OpenGL33CommandBuffer::Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
-    LogWarning("Compute shaders not supported in OpenGL 3.3");
-}
-
-void OpenGL33CommandBuffer::DispatchIndirect(Buffer* buffer, uint64_t offset) {
-    LogWarning("Compute shaders not supported in OpenGL 3.3");
-}
-
-void OpenGL33CommandBuffer::ClearColorAttachment(uint32_t attachment, const ClearColorValue& color, const Rect2D& rect) {
-    glClearColor(color.float32[0], color.float32[1], color.float32[2], color.float32[3]);
-    glClear(GL_COLOR_BUFFER_BIT);
-}
-
-void OpenGL33CommandBuffer::ClearDepthStencilAttachment(const ClearDepthStencilValue& value, const Rect2D& rect) {
-    glClearDepth(value.depth);
-    glClearStencil(value.stencil);
-    glClear(GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-}
-
-void OpenGL33CommandBuffer::CopyBuffer(Buffer* src, Buffer* dst, uint64_t srcOffset, uint64_t dstOffset, uint64_t size) {
-    // Use glCopyBufferSubData (GL 3.1+)
-    auto* glSrc = static_cast<OpenGL33Buffer*>(src);
-    auto* glDst = static_cast<OpenGL33Buffer*>(dst);
-    
-    glBindBuffer(GL_COPY_READ_BUFFER, glSrc->GetHandle());
-    glBindBuffer(GL_COPY_WRITE_BUFFER, glDst->GetHandle());
-    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, srcOffset, dstOffset, size);
-    glBindBuffer(GL_COPY_READ_BUFFER, 0);
-    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
-}
-
-void OpenGL33CommandBuffer::CopyBufferToTexture(Buffer* src, Texture* dst, uint32_t mipLevel, uint32_t arrayLayer) {
-    // Implementation would use glBindBuffer + glTexSubImage
-}
-
-void OpenGL33CommandBuffer::CopyTextureToBuffer(Texture* src, Buffer* dst, uint32_t mipLevel, uint32_t arrayLayer) {
-    // Implementation would use glGetTexImage
-}
-
-void OpenGL33CommandBuffer::CopyTexture(Texture* src, Texture* dst, uint32_t srcMipLevel, uint32_t srcArrayLayer, uint32_t dstMipLevel, uint32_t dstArrayLayer) {
-    // Implementation would use glCopyImageSubData (GL 4.3+) or FBO blitting
-}
-
-void OpenGL33CommandBuffer::PipelineBarrier() {
-    // OpenGL has implicit barriers
-}
-
-void OpenGL33CommandBuffer::BindUniformBuffer(uint32_t binding, Buffer* buffer, uint64_t offset, uint64_t size) {
-    if (!buffer) {
-        LogWarning("BindUniformBuffer called with null buffer");
-        return;
-    }
-    
-    auto* glBuffer = static_cast<OpenGL33Buffer*>(buffer);
-    
-    if (size == 0) {
-        size = buffer->GetSize() - offset;
-    }
-    
-    glBindBufferRange(GL_UNIFORM_BUFFER, binding, glBuffer->GetHandle(), offset, size);
-}
+        
+        void BindVertexBuffers(const CmdBindVertexBuffers& cmd) {
+            auto buffers = cmd.GetBuffers();
+            auto offsets = cmd.GetOffsets();
+            
+            // Only remember the bindings; the VAO is resolved at the next draw
+            for (size_t i = 0; i < buffers.size(); ++i) {
+                uint32_t binding = cmd.firstBinding + static_cast<uint32_t>(i);
+                if (binding >= m_vertexBuffers.size()) {
+                    LogWarning("BindVertexBuffers binding index exceeds the supported vertex bindings");
+                    break;
+                }
+                
+                GLuint handle = buffers[i] ? static_cast<OpenGL33Buffer*>(buffers[i])->GetHandle() : 0;
+                m_vertexBuffers[binding] = {handle, offsets[i]};
+            }
+            m_vertexInputDirty = true;
+        }
+        
+        void BindIndexBuffer(const CmdBindIndexBuffer& cmd) {
+            if (!cmd.buffer) {
+                LogWarning("BindIndexBuffer called with null buffer");
+                return;
+            }
+            
+            // Store the index type and offset for later use in DrawIndexed
+            m_indexType = cmd.use16BitIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+            m_indexOffset = cmd.offset;
+            
+            // The element array binding is VAO state
+            auto* glBuffer = static_cast<OpenGL33Buffer*>(cmd.buffer);
+            if (m_vertexArrayKey.indexBuffer != glBuffer->GetHandle()) {
+                m_vertexArrayKey.indexBuffer = glBuffer->GetHandle();
+                m_vertexInputDirty = true;
+            }
+        }
+        
+        /// Bind the VAO matching the current pipeline layout and buffers.
+        /// Per-vertex streams bound a whole number of vertices into their
+        /// buffers share the VAO of the buffers' start and draw from a base
+        /// vertex instead, so views sub-allocated from one block do not each
+        /// build a VAO. Indirect draws read their base vertex from the GPU,
+        /// so they pass `foldOffsets` = false to keep the offsets in the VAO.
+        void FlushVertexInput(bool foldOffsets = true) {
+            if (!m_vertexArrayKey.layout || (!m_vertexInputDirty && (foldOffsets || m_baseVertex == 0))) {
+                return;
+            }
+            
+            const GLVertexLayout& layout = *m_vertexArrayKey.layout;
+            bool fold = foldOffsets;
+            bool found = false;
+            uint64_t baseVertex = 0;
+            for (uint32_t i = 0; i < layout.streamCount; ++i) {
+                uint32_t binding = layout.streams[i].binding;
+                const GLVertexArrayKey::Stream& source = binding < m_vertexBuffers.size()
+                    ? m_vertexBuffers[binding] : GLVertexArrayKey::Stream{};
+                m_vertexArrayKey.streams[i] = source;
+                
+                // The base vertex moves every per-vertex stream alike, and no instanced one
+                const auto stride = static_cast<uint64_t>(layout.streams[i].stride);
+                if (layout.streams[i].divisor != 0 || source.buffer == 0) {
+                    continue;
+                }
+                if (stride == 0 || source.offset % stride != 0 || (found && source.offset / stride != baseVertex)) {
+                    fold = false;
+                }
+                baseVertex = stride != 0 ? source.offset / stride : 0;
+                found = true;
+            }
+            
+            m_baseVertex = 0;
+            if (fold && baseVertex != 0 && baseVertex <= static_cast<uint64_t>(std::numeric_limits<GLint>::max())) {
+                for (uint32_t i = 0; i < layout.streamCount; ++i) {
+                    if (layout.streams[i].divisor == 0) {
+                        m_vertexArrayKey.streams[i].offset = 0;
+                    }
+                }
+                m_baseVertex = static_cast<GLint>(baseVertex);
+            }
+            
+            m_vertexArrays.Bind(m_vertexArrayKey);
+            m_vertexInputDirty = false;
+        }
+        
+        void BindUniformBuffer(const CmdBindUniformBuffer& cmd) {
+            if (!cmd.buffer) {
+                LogWarning("BindUniformBuffer called with null buffer");
+                return;
+            }
+            
+            auto* glBuffer = static_cast<OpenGL33Buffer*>(cmd.buffer);
+            uint64_t size = cmd.size == 0 ? cmd.buffer->GetSize() - cmd.offset : cmd.size;
+            
+            if (!m_computeAndIndirect && cmd.binding < CpuComputeKernel::MaxBindings) {
+                m_cpuUniformBuffers[cmd.binding] = {glBuffer, cmd.offset, size};
+            }
+            m_state.BindBufferRange(GL_UNIFORM_BUFFER, cmd.binding, glBuffer->GetHandle(),
+                                    static_cast<GLintptr>(cmd.offset), static_cast<GLsizeiptr>(size));
+        }
+        
+        void BindStorageBuffer(const CmdBindStorageBuffer& cmd) {
+            if (!cmd.buffer) {
+                LogWarning("BindStorageBuffer called with null buffer");
+                return;
+            }
+            
+            auto* glBuffer = static_cast<OpenGL33Buffer*>(cmd.buffer);
+            uint64_t size = cmd.size == 0 ? cmd.buffer->GetSize() - cmd.offset : cmd.size;
+            
+            // Only compute shaders running on the CPU can read them in GL 3.3
+            if (!m_computeAndIndirect) {
+                if (cmd.binding < CpuComputeKernel::MaxBindings) {
+                    m_cpuStorageBuffers[cmd.binding] = {glBuffer, cmd.offset, size};
+                }
+                return;
+            }
+            m_state.BindBufferRange(GL_SHADER_STORAGE_BUFFER, cmd.binding, glBuffer->GetHandle(),
+                                    static_cast<GLintptr>(cmd.offset), static_cast<GLsizeiptr>(size));
+        }
+        
+        void BindTexture(const CmdBindTexture& cmd) {
+            if (!cmd.texture) {
+                LogWarning("BindTexture called with null texture");
+                return;
+            }
+            
+            auto* glTexture = static_cast<OpenGL33Texture*>(cmd.texture);
+            
+            m_state.BindTexture(cmd.binding, GLFormatUtils::GetTextureTarget(glTexture->GetType()), glTexture->GetHandle());
+            
+            // Without a sampler the texture's own parameters apply
+            GLuint sampler = cmd.sampler ? static_cast<OpenGL33Sampler*>(cmd.sampler)->GetHandle() : 0;
+            m_state.BindSampler(cmd.binding, sampler);
+        }
+        
+        void Draw(const DrawParams& params) {
+            FlushVertexInput();
+            FlushPushConstants();
+            ++m_drawCalls;
+            const GLint firstVertex = static_cast<GLint>(params.firstVertex) + m_baseVertex;
+            if (params.instanceCount > 1) {
+                glDrawArraysInstanced(m_primitiveMode, firstVertex, params.vertexCount, params.instanceCount);
+            } else {
+                glDrawArrays(m_primitiveMode, firstVertex, params.vertexCount);
+            }
+        }
+        
+        void DrawIndexed(const DrawIndexedParams& params) {
+            FlushVertexInput();
+            FlushPushConstants();
+            ++m_drawCalls;
+            
+            const void* indices = GetIndexPointer(params.firstIndex);
+            const GLint baseVertex = params.vertexOffset + m_baseVertex;
+            if (params.instanceCount > 1) {
+                glDrawElementsInstancedBaseVertex(m_primitiveMode, params.indexCount, m_indexType, indices,
+                                                  params.instanceCount, baseVertex);
+            } else if (baseVertex != 0) {
+                glDrawElementsBaseVertex(m_primitiveMode, params.indexCount, m_indexType, indices, baseVertex);
+            } else {
+                glDrawElements(m_primitiveMode, params.indexCount, m_indexType, indices);
+            }
+        }
+        
+        /// Issue all draws of an indirect command as one glMultiDraw*Indirect
+        void DrawIndirect(const CmdDrawIndirectBase& cmd, bool indexed) {
+            // GatherPushConstants() took a snapshot for this command even if
+            // it is skipped, so bind it first to keep later draws in step
+            FlushPushConstants();
+            if (!m_computeAndIndirect) {
+                LogWarning("Indirect draws not supported in OpenGL 3.3");
+                return;
+            }
+            if (!cmd.buffer || cmd.drawCount == 0) {
+                return;
+            }
+            if (indexed && m_indexOffset != 0) {
+                // The indirect commands address indices from the start of the buffer
+                LogWarning("DrawIndexedIndirect ignores the index buffer offset");
+            }
+            
+            FlushVertexInput(false);
+            m_state.BindBuffer(GL_DRAW_INDIRECT_BUFFER, static_cast<OpenGL33Buffer*>(cmd.buffer)->GetHandle());
+            
+            const void* indirect = reinterpret_cast<const void*>(static_cast<uintptr_t>(cmd.offset));
+            const auto drawCount = static_cast<GLsizei>(cmd.drawCount);
+            const auto stride = static_cast<GLsizei>(cmd.stride);
+            if (indexed) {
+                glMultiDrawElementsIndirect(m_primitiveMode, m_indexType, indirect, drawCount, stride);
+            } else {
+                glMultiDrawArraysIndirect(m_primitiveMode, indirect, drawCount, stride);
+            }
+            ++m_drawCalls;
+        }
+        
+        void Dispatch(const DispatchParams& params) {
+            if (!m_computeAndIndirect) {
+                DispatchOnCpu(params.groupCountX, params.groupCountY, params.groupCountZ);
+                return;
+            }
+            FlushPushConstants();
+            glDispatchCompute(params.groupCountX, params.groupCountY, params.groupCountZ);
+        }
+        
+        void DispatchIndirect(const CmdDispatchIndirect& cmd) {
+            if (!cmd.buffer) {
+                LogWarning("DispatchIndirect called with null buffer");
+                FlushPushConstants();  // Consume this command's snapshot, as in DrawIndirect()
+                return;
+            }
+            if (!m_computeAndIndirect) {
+                std::array<uint32_t, 3> groupCount{};
+                cmd.buffer->Read(groupCount.data(), sizeof(groupCount), cmd.offset);
+                DispatchOnCpu(groupCount[0], groupCount[1], groupCount[2]);
+                return;
+            }
+            FlushPushConstants();
+            m_state.BindBuffer(GL_DISPATCH_INDIRECT_BUFFER, static_cast<OpenGL33Buffer*>(cmd.buffer)->GetHandle());
+            glDispatchComputeIndirect(static_cast<GLintptr>(cmd.offset));
+        }
+        
+        /// Run the bound compute pipeline's CPU kernel on copies of its buffers
+        void DispatchOnCpu(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
+            // Consume this command's snapshot even if it is skipped, as in DrawIndirect()
+            FlushPushConstants();
+            if (!m_cpuKernel) {
+                LogWarning("Dispatch without a compute pipeline bound");
+                return;
+            }
+            
+            auto bindings = m_cpuKernel->GetBindings();
+            m_scratch.cpuBuffers.resize(bindings.size());
+            m_scratch.cpuBufferPointers.resize(bindings.size());
+            for (size_t i = 0; i < bindings.size(); ++i) {
+                const CpuComputeKernel::Binding& binding = bindings[i];
+                const CpuBufferBinding& bound =
+                    (binding.storage ? m_cpuStorageBuffers : m_cpuUniformBuffers)[binding.binding];
+                if (!bound.buffer || bound.size < binding.minSize) {
+                    LogWarning("Dispatch skipped: %s buffer binding %u is missing or smaller than the shader's block",
+                               binding.storage ? "storage" : "uniform", binding.binding);
+                    return;
+                }
+                auto& memory = m_scratch.cpuBuffers[i];
+                memory.resize(static_cast<size_t>(bound.size));
+                bound.buffer->Read(memory.data(), memory.size(), static_cast<size_t>(bound.offset));
+                m_scratch.cpuBufferPointers[i] = memory.data();
+            }
+            
+            std::array<std::byte, MaxPushConstantSize> noPushConstants{};
+            const void* pushConstants = m_pushConstantSnapshot == NoPushConstantSnapshot
+                ? noPushConstants.data()
+                : m_scratch.pushConstants.data() + m_pushConstantSnapshot;
+            m_cpuKernel->Dispatch(m_device.GetThreadPool(), m_scratch.cpuBufferPointers, pushConstants,
+                                  groupCountX, groupCountY, groupCountZ);
+            
+            for (size_t i = 0; i < bindings.size(); ++i) {
+                if (bindings[i].writable) {
+                    const CpuBufferBinding& bound = m_cpuStorageBuffers[bindings[i].binding];
+                    bound.buffer->Update(m_scratch.cpuBuffers[i].data(), m_scratch.cpuBuffers[i].size(),
+                                         static_cast<size_t>(bound.offset));
+                }
+            }
+        }
+        
+        /// Offset of the first index in the bound index buffer, as GL expects it
+        const void* GetIndexPointer(uint32_t firstIndex) const noexcept {
+            size_t indexSize = (m_indexType == GL_UNSIGNED_SHORT) ? sizeof(uint16_t) : sizeof(uint32_t);
+            return reinterpret_cast<const void*>(static_cast<uintptr_t>(m_indexOffset + firstIndex * indexSize));
+        }
+        
+        /// Draws that glMultiDrawElementsBaseVertex can express: one instance, no base instance
+        static bool IsMergeable(const CommandHeader& header) noexcept {
+            if (header.type != CommandType::DrawIndexed) {
+                return false;
+            }
+            const DrawIndexedParams& params = header.As<CmdDrawIndexed>().params;
+            return params.instanceCount == 1 && params.firstInstance == 0;
+        }
+        
+        /// Issue the run of mergeable draws starting at `first` as one multi-draw.
+        /// No other command sits between them, so they share all bound state.
+        /// @return The command after the run
+        CommandStream::Iterator DrawIndexedRun(CommandStream::Iterator first, CommandStream::Iterator end) {
+            auto last = first;
+            size_t runLength = 0;
+            while (last != end && IsMergeable(*last)) {
+                ++last;
+                ++runLength;
+            }
+            if (runLength == 1) {
+                DrawIndexed(first->As<CmdDrawIndexed>().params);
+                return last;
+            }
+            
+            FlushVertexInput();
+            FlushPushConstants();
+            m_scratch.counts.clear();
+            m_scratch.indices.clear();
+            m_scratch.baseVertices.clear();
+            for (auto it = first; it != last; ++it) {
+                const DrawIndexedParams& params = it->As<CmdDrawIndexed>().params;
+                m_scratch.counts.push_back(static_cast<GLsizei>(params.indexCount));
+                m_scratch.indices.push_back(GetIndexPointer(params.firstIndex));
+                m_scratch.baseVertices.push_back(params.vertexOffset + m_baseVertex);
+            }
+            
+            const auto drawCount = static_cast<GLsizei>(m_scratch.counts.size());
+            glMultiDrawElementsBaseVertex(m_primitiveMode, m_scratch.counts.data(), m_indexType,
+                                          m_scratch.indices.data(), drawCount,
+                                          m_scratch.baseVertices.data());
+            ++m_drawCalls;
+            m_drawsMerged += static_cast<uint64_t>(drawCount);
+            return last;
+        }
+        
+        void CopyBuffer(const CmdCopyBuffer& cmd) {
+            // Use glCopyBufferSubData (GL 3.1+)
+            auto* glSrc = static_cast<OpenGL33Buffer*>(cmd.src);
+            auto* glDst = static_cast<OpenGL33Buffer*>(cmd.dst);
+            
+            m_state.BindBuffer(GL_COPY_READ_BUFFER, glSrc->GetHandle());
+            m_state.BindBuffer(GL_COPY_WRITE_BUFFER, glDst->GetHandle());
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                static_cast<GLintptr>(cmd.srcOffset), static_cast<GLintptr>(cmd.dstOffset),
+                                static_cast<GLsizeiptr>(cmd.size));
+        }
+        
+        void CopyTextureToBuffer(const CmdCopyTextureToBuffer& cmd) {
+            if (!cmd.src || !cmd.dst) {
+                return;
+            }
+            const auto* texture = static_cast<const OpenGL33Texture*>(cmd.src);
+            const TextureType type = texture->GetType();
+            const bool isCube = type == TextureType::TextureCube || type == TextureType::TextureCubeArray;
+            const uint32_t layers = texture->GetArrayLayers() * (isCube ? 6 : 1);
+            const TextureFormat format = texture->GetFormat();
+            const bool compressed = GLFormatUtils::IsCompressedFormat(format);
+            const bool isArray = type == TextureType::Texture1DArray || type == TextureType::Texture2DArray ||
+                                 type == TextureType::TextureCubeArray;
+            
+            const GLsizei width = static_cast<GLsizei>(std::max(texture->GetWidth() >> cmd.mipLevel, 1u));
+            const GLsizei height = type == TextureType::Texture1D || type == TextureType::Texture1DArray
+                ? 1 : static_cast<GLsizei>(std::max(texture->GetHeight() >> cmd.mipLevel, 1u));
+            const GLsizei depth = type == TextureType::Texture3D
+                ? static_cast<GLsizei>(std::max(texture->GetDepth() >> cmd.mipLevel, 1u)) : 1;
+            // Compressed levels are read whole 4x4 blocks at a time
+            const uint64_t size = GLFormatUtils::GetImageSize(format, static_cast<uint32_t>(width),
+                                                              static_cast<uint32_t>(height),
+                                                              static_cast<uint32_t>(depth));
+            if (cmd.mipLevel >= texture->GetMipLevels() || cmd.arrayLayer >= layers || size == 0 ||
+                cmd.dst->GetSize() < size || (compressed && isArray)) {
+                LogWarning("CopyTextureToBuffer out of bounds or unsupported; skipped");
+                return;
+            }
+            
+            // With a pixel pack buffer bound, the pixel pointer is an offset
+            // into it and the GPU writes the buffer without the CPU waiting
+            GLenum glFormat, glType;
+            GLFormatUtils::GetFormatAndType(format, glFormat, glType);
+            m_state.BindBuffer(GL_PIXEL_PACK_BUFFER, static_cast<OpenGL33Buffer*>(cmd.dst)->GetHandle());
+            
+            if (isArray) {
+                // glGetTexImage returns every layer; read the one layer through the
+                // device's read framebuffer
+                m_state.BindFramebuffer(m_device.GetReadFramebuffer());
+                const GLenum attachment = !GLFormatUtils::IsDepthStencilFormat(format) ? GL_COLOR_ATTACHMENT0
+                    : GLFormatUtils::HasStencil(format) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+                glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, attachment, texture->GetHandle(),
+                                          static_cast<GLint>(cmd.mipLevel), static_cast<GLint>(cmd.arrayLayer));
+                glReadPixels(0, 0, width, height, glFormat, glType, nullptr);
+                // Detach so the framebuffer does not keep a destroyed texture alive
+                glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, attachment, 0, 0, 0);
+                m_state.BindFramebuffer(m_framebuffer ? m_framebuffer->GetHandle() : 0);
+            } else {
+                const GLenum target = GLFormatUtils::GetTextureTarget(type);
+                const GLenum image = isCube ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + cmd.arrayLayer : target;
+                m_state.BindTextureForUpdate(target, texture->GetHandle());
+                if (compressed) {
+                    glGetCompressedTexImage(image, static_cast<GLint>(cmd.mipLevel), nullptr);
+                } else {
+                    glGetTexImage(image, static_cast<GLint>(cmd.mipLevel), glFormat, glType, nullptr);
+                }
+            }
+            
+            m_state.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+        
+        OpenGL33Device& m_device;
+        OpenGL33StateCache& m_state;
+        OpenGL33VertexArrayCache& m_vertexArrays;
+        OpenGL33UniformRing& m_uniformRing;
+        OpenGL33CommandBuffer::ReplayScratch& m_scratch;
+        bool m_mergeDraws;
+        bool m_computeAndIndirect;
+        
+        uint64_t m_drawCalls = 0;
+        uint64_t m_drawsMerged = 0;
+        
+        // Vertex input, indexed by binding number
+        std::array<GLVertexArrayKey::Stream, GLVertexLayout::MaxStreams> m_vertexBuffers{};
+        GLVertexArrayKey m_vertexArrayKey;
+        GLint m_baseVertex = 0;  ///< Vertex offsets folded out of the bound VAO
+        bool m_vertexInputDirty = true;
+        
+        // Current render pass; clears and invalidation follow its attachments
+        const OpenGL33RenderPass* m_renderPass = nullptr;
+        const OpenGL33Framebuffer* m_framebuffer = nullptr;
+        Rect2D m_renderArea;
+        
+        // Bound graphics pipeline and the stencil write masks (front, back)
+        // in effect, dynamic state included, for RestoreWriteMasks()
+        const GLPipelineState* m_graphicsState = nullptr;
+        std::array<GLuint, 2> m_stencilWriteMasks{0xFF, 0xFF};
+        
+        GLenum m_primitiveMode = GL_TRIANGLES;
+        GLenum m_indexType = GL_UNSIGNED_INT;
+        uint64_t m_indexOffset = 0;
+        
+        // Push constants: the block as the recorded commands leave it, and
+        // the ring offset of the next snapshot
+        std::array<std::byte, MaxPushConstantSize> m_pushConstants{};
+        bool m_pushConstantsDirty = false;
+        GLsizeiptr m_pushConstantStride;
+        GLintptr m_pushConstantBase = 0;
+        
+        // Scratch offset of the bound push constant snapshot, for CPU kernels
+        static constexpr size_t NoPushConstantSnapshot = SIZE_MAX;
+        size_t m_pushConstantSnapshot = NoPushConstantSnapshot;
+        size_t m_nextPushConstantSnapshot = 0;
+        
+        // Compute on the CPU (no GL 4.3): the bound kernel and buffer ranges
+        struct CpuBufferBinding {
+            OpenGL33Buffer* buffer = nullptr;
+            uint64_t offset = 0;
+            uint64_t size = 0;
+        };
+        CpuComputeKernel* m_cpuKernel = nullptr;
+        std::array<CpuBufferBinding, CpuComputeKernel::MaxBindings> m_cpuUniformBuffers{};
+        std::array<CpuBufferBinding, CpuComputeKernel::MaxBindings> m_cpuStorageBuffers{};
+    };
+} // anonymous namespace
 
-void OpenGL33CommandBuffer::BindTexture(uint32_t binding, Texture* texture, Sampler* sampler) {
-    if (!texture) {
-        LogWarning("BindTexture called with null texture");
-        return;
-    }
-    
-    auto* glTexture = static_cast<OpenGL33Texture*>(texture);
-    
-    // Activate texture unit and bind texture
-    glActiveTexture(GL_TEXTURE0 + binding);
-    
-    GLenum target = GL_TEXTURE_2D;
-    switch (glTexture->GetType()) {
-        case TextureType::Texture1D:
-            target = GL_TEXTURE_1D;
-            break;
-        case TextureType::Texture2D:
-            target = GL_TEXTURE_2D;
-            break;
-        case TextureType::Texture3D:
-            target = GL_TEXTURE_3D;
-            break;
-        case TextureType::TextureCube:
-            target = GL_TEXTURE_CUBE_MAP;
-            break;
-        default:
-            target = GL_TEXTURE_2D;
-            break;
-    }
-    
-    glBindTexture(target, glTexture->GetHandle());
-    
-    // If sampler is provided, bind it to the same texture unit
-    if (sampler) {
-        auto* glSampler = static_cast<OpenGL33Sampler*>(sampler);
-        glBindSampler(binding, glSampler->GetHandle());
+void OpenGL33CommandBuffer::Execute(OpenGL33Device& device) {
+    if (m_state == CommandBufferState::Recording) {
+        LogWarning("Submitting a command buffer that is still recording");
     }
     
-    // Note: We don't reset to texture unit 0 here because that would
-    // interfere with the binding we just set up. The active texture unit
-    // will be changed as needed by subsequent bind calls.
-}
-
-void OpenGL33CommandBuffer::BeginDebugMarker(const char* name, const float color[4]) {
-    // Use GL_KHR_debug extension if available
-}
-
-void OpenGL33CommandBuffer::EndDebugMarker() {
-    // Use GL_KHR_debug extension if available
-}
-
-void OpenGL33CommandBuffer::InsertDebugMarker(const char* name, const float color[4]) {
-    // Use GL_KHR_debug extension if available
-}
-
-void OpenGL33CommandBuffer::Execute() {
-    // In OpenGL, commands are executed immediately
-    // This is a no-op for compatibility with the API
-    m_state = CommandBufferState::Submitted;
+    CommandReplayer replayer(device, m_replayScratch);
+    replayer.Replay(m_stream);
+    device.CountDraws(replayer.GetDrawCalls(), replayer.GetDrawsMerged());
+    MarkSubmitted();
 }
 
 } // namespace VRHI
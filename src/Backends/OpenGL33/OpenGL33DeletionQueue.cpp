@@ -0,0 +1,173 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "OpenGL33DeletionQueue.hpp"
+#include "OpenGL33Device.hpp"
+
+namespace VRHI {
+
+namespace {
+
+void FreeNodes(auto* node) {
+    while (node) {
+        auto* next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+} // anonymous namespace
+
+OpenGL33DeletionQueue::OpenGL33DeletionQueue(OpenGL33Device& device)
+    : m_device(&device)
+{
+}
+
+OpenGL33DeletionQueue::~OpenGL33DeletionQueue() {
+    // The device deletes everything while the context is current; whatever
+    // is left can only be freed
+    for (const Batch& batch : m_batches) {
+        FreeNodes(batch.objects);
+    }
+    FreeNodes(TakeRetired());
+}
+
+void OpenGL33DeletionQueue::Retire(ObjectType type, GLuint name) {
+    if (name == 0) {
+        return;
+    }
+    auto* node = new Node;
+    node->type = type;
+    node->name = name;
+    Push(node);
+}
+
+void OpenGL33DeletionQueue::Retire(GLsync sync) {
+    if (!sync) {
+        return;
+    }
+    auto* node = new Node;
+    node->type = ObjectType::Sync;
+    node->sync = sync;
+    Push(node);
+}
+
+void OpenGL33DeletionQueue::Retire(GLuint program, std::unique_ptr<GLVertexLayout> layout) {
+    if (program == 0 && !layout) {
+        return;
+    }
+    auto* node = new Node;
+    node->type = ObjectType::Program;
+    node->name = program;
+    node->layout = std::move(layout);
+    Push(node);
+}
+
+void OpenGL33DeletionQueue::Push(Node* node) {
+    m_pendingCount.fetch_add(1, std::memory_order_relaxed);
+    node->next = m_retired.load(std::memory_order_relaxed);
+    while (!m_retired.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+    }
+}
+
+OpenGL33DeletionQueue::Node* OpenGL33DeletionQueue::TakeRetired() {
+    // Taking the whole stack at once leaves no room for ABA
+    return m_retired.exchange(nullptr, std::memory_order_acquire);
+}
+
+void OpenGL33DeletionQueue::EndFrame() {
+    if (Node* objects = TakeRetired()) {
+        m_batches.push_back({objects, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)});
+    }
+
+    while (!m_batches.empty()) {
+        Batch& batch = m_batches.front();
+        const GLenum status = glClientWaitSync(batch.fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            break;
+        }
+        glDeleteSync(batch.fence);
+        Delete(batch.objects);
+        m_batches.pop_front();
+    }
+}
+
+void OpenGL33DeletionQueue::DeleteAll() {
+    for (const Batch& batch : m_batches) {
+        glDeleteSync(batch.fence);
+        Delete(batch.objects);
+    }
+    m_batches.clear();
+    Delete(TakeRetired());
+}
+
+void OpenGL33DeletionQueue::Delete(Node* objects) {
+    auto& stateCache = m_device->GetStateCache();
+    auto& vertexArrays = m_device->GetVertexArrayCache();
+    auto* uploads = m_device->GetUploadQueue();
+
+    size_t count = 0;
+    for (Node* node = objects; node; node = node->next, ++count) {
+        switch (node->type) {
+            case ObjectType::Buffer:
+                if (uploads) {
+                    uploads->OnBufferDeleted(node->name);
+                }
+                stateCache.OnBufferDeleted(node->name);
+                vertexArrays.OnBufferDeleted(node->name);
+                m_buffers.push_back(node->name);
+                break;
+            case ObjectType::Texture:
+                if (uploads) {
+                    uploads->OnTextureDeleted(node->name);
+                }
+                stateCache.OnTextureDeleted(node->name);
+                m_textures.push_back(node->name);
+                break;
+            case ObjectType::Sampler:
+                stateCache.OnSamplerDeleted(node->name);
+                m_samplers.push_back(node->name);
+                break;
+            case ObjectType::Framebuffer:
+                stateCache.OnFramebufferDeleted(node->name);
+                m_framebuffers.push_back(node->name);
+                break;
+            case ObjectType::Program:
+                if (node->layout) {
+                    vertexArrays.OnLayoutDeleted(node->layout.get());
+                }
+                if (node->name != 0) {
+                    stateCache.OnProgramDeleted(node->name);
+                    glDeleteProgram(node->name);
+                }
+                break;
+            case ObjectType::Sync:
+                glDeleteSync(node->sync);
+                break;
+        }
+    }
+
+    // Programs and syncs have no array form
+    if (!m_buffers.empty()) {
+        glDeleteBuffers(static_cast<GLsizei>(m_buffers.size()), m_buffers.data());
+    }
+    if (!m_textures.empty()) {
+        glDeleteTextures(static_cast<GLsizei>(m_textures.size()), m_textures.data());
+    }
+    if (!m_samplers.empty()) {
+        glDeleteSamplers(static_cast<GLsizei>(m_samplers.size()), m_samplers.data());
+    }
+    if (!m_framebuffers.empty()) {
+        glDeleteFramebuffers(static_cast<GLsizei>(m_framebuffers.size()), m_framebuffers.data());
+    }
+    m_buffers.clear();
+    m_textures.clear();
+    m_samplers.clear();
+    m_framebuffers.clear();
+
+    FreeNodes(objects);
+    m_pendingCount.fetch_sub(count, std::memory_order_relaxed);
+}
+
+} // namespace VRHI
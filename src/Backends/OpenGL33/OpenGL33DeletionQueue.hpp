@@ -0,0 +1,103 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "OpenGL33VertexArrayCache.hpp"
+#include <glad/glad.h>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace VRHI {
+
+class OpenGL33Device;
+
+/// GL objects released by resource destructors, deleted once the GPU is
+/// done with the frame they were released in.
+///
+/// Retire() only pushes onto a lock-free stack, so buffers, textures,
+/// samplers, framebuffers and pipelines can be destroyed from any thread
+/// without touching the context. At the end of each frame the device moves
+/// everything retired so far into a batch fenced with glFenceSync; batches
+/// whose fence has signaled are deleted on the context thread with one
+/// glDelete* call per object type, after the state and vertex array caches
+/// have forgotten the names. A GL name is not reused before it is deleted,
+/// so caches that still hold a retired name cannot confuse it with a new
+/// object.
+class OpenGL33DeletionQueue {
+public:
+    enum class ObjectType : uint8_t {
+        Buffer,
+        Texture,
+        Sampler,
+        Framebuffer,
+        Program,
+        Sync,
+    };
+
+    explicit OpenGL33DeletionQueue(OpenGL33Device& device);
+    ~OpenGL33DeletionQueue();
+
+    OpenGL33DeletionQueue(const OpenGL33DeletionQueue&) = delete;
+    OpenGL33DeletionQueue& operator=(const OpenGL33DeletionQueue&) = delete;
+
+    /// Delete `name` once the GPU has finished the current frame; any thread
+    void Retire(ObjectType type, GLuint name);
+
+    /// Delete a sync object once the GPU has finished the current frame; any thread
+    void Retire(GLsync sync);
+
+    /// Delete a pipeline's program and drop the VAOs built from its vertex
+    /// layout, which stays alive until then; any thread
+    void Retire(GLuint program, std::unique_ptr<GLVertexLayout> layout);
+
+    /// Fence the objects retired during the frame and delete the batches of
+    /// earlier frames that the GPU has finished
+    void EndFrame();
+
+    /// Delete everything retired so far; the GPU must be idle
+    void DeleteAll();
+
+    /// Objects retired but not deleted yet
+    size_t GetPendingCount() const noexcept { return m_pendingCount.load(std::memory_order_relaxed); }
+
+private:
+    /// An object in the lock-free stack
+    struct Node {
+        Node* next = nullptr;
+        ObjectType type = ObjectType::Buffer;
+        GLuint name = 0;
+        GLsync sync = nullptr;
+        std::unique_ptr<GLVertexLayout> layout;
+    };
+
+    /// Objects retired during one frame and the fence that completes it
+    struct Batch {
+        Node* objects = nullptr;
+        GLsync fence = nullptr;
+    };
+
+    void Push(Node* node);
+
+    /// Pop everything retired since the last call
+    Node* TakeRetired();
+
+    /// Delete a list of objects with batched glDelete* calls
+    void Delete(Node* objects);
+
+    OpenGL33Device* m_device;
+    std::atomic<Node*> m_retired{nullptr};
+    std::atomic<size_t> m_pendingCount{0};
+    std::deque<Batch> m_batches;  // Oldest first; context thread only
+
+    // Scratch arrays for the batched deletes
+    std::vector<GLuint> m_buffers;
+    std::vector<GLuint> m_textures;
+    std::vector<GLuint> m_samplers;
+    std::vector<GLuint> m_framebuffers;
+};
+
+} // namespace VRHI
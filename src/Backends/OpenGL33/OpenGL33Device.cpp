@@ -13,24 +13,41 @@
 #include "OpenGL33CommandBuffer.hpp"
 #include "OpenGL33Sync.hpp"
 #include "OpenGL33SwapChain.hpp"
+#include "Core/ThreadPool.hpp"
 #include <VRHI/Logging.hpp>
 #include <VRHI/BackendScoring.hpp>
 #include <glad/glad.h>
 
 namespace VRHI {
 
-OpenGL33Device::OpenGL33Device(const DeviceConfig& config, OpenGL33Backend* backend)
-    : m_config(config)
+OpenGL33Device::OpenGL33Device(const DeviceConfig& config, OpenGL33Backend* backend, const GLDeviceProfile& profile)
+    : m_profile(profile)
+    , m_config(config)
     , m_backend(backend)
 {
+    SetMaxFramesInFlight(config.maxFramesInFlight);
 }
 
 OpenGL33Device::~OpenGL33Device() {
     if (m_initialized) {
+        ReleaseFrameContexts();
         WaitIdle();
         
+        m_uploadQueue.reset();
+        m_transientAllocator.reset();
+        m_deletionQueue.DeleteAll();
+        m_vertexArrayCache.Clear();
+        m_uniformRing.Release();
+        
+        if (m_readFramebuffer != 0) {
+            m_stateCache.OnFramebufferDeleted(m_readFramebuffer);
+            glDeleteFramebuffers(1, &m_readFramebuffer);
+            m_readFramebuffer = 0;
+        }
+        
         // Clean up default VAO
         if (m_defaultVAO != 0) {
+            m_stateCache.OnVertexArrayDeleted(m_defaultVAO);
             glDeleteVertexArrays(1, &m_defaultVAO);
             m_defaultVAO = 0;
         }
@@ -85,18 +102,25 @@ std::expected<void, Error> OpenGL33Device::Initialize() {
     if (renderer) m_properties.deviceName = reinterpret_cast<const char*>(renderer);
     if (version) m_properties.driverVersion = reinterpret_cast<const char*>(version);
     
-    m_properties.apiVersion = "OpenGL 3.3";
+    m_properties.apiVersion = GetBackendInfo().name;
     
     // Note: Features will be obtained from backend after DetectFeatures() is called
     // This happens in Backend::CreateDevice() after Initialize() returns
     
     // Create and bind a default VAO (required for OpenGL 3.3 core profile)
     glGenVertexArrays(1, &m_defaultVAO);
-    glBindVertexArray(m_defaultVAO);
+    m_stateCache.Invalidate();
+    m_stateCache.BindVertexArray(m_defaultVAO);
+    
+    m_uniformRing.Initialize();
+    
+    // Texture data is tightly packed on every backend; the default pads rows to 4 bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
     
     m_initialized = true;
     
-    LogInfo("OpenGL 3.3 Device initialized");
+    LogInfo("%s Device initialized", m_properties.apiVersion.c_str());
     if (!m_properties.deviceName.empty()) {
         LogInfo(m_properties.deviceName);
     }
@@ -113,6 +137,12 @@ void OpenGL33Device::UpdateFeatures() {
         // This shouldn't happen after Initialize() succeeds
         LogWarning("Failed to get features from backend: " + featuresResult.error().message);
     }
+    
+    m_transientAllocator = std::make_unique<OpenGL33TransientAllocator>(
+        *this, m_features.memory.minUniformBufferAlignment);
+    if (!m_uploadQueue) {
+        m_uploadQueue = std::make_unique<OpenGL33UploadQueue>(*this);
+    }
 }
 
 BackendType OpenGL33Device::GetBackendType() const noexcept {
@@ -144,27 +174,27 @@ const DeviceProperties& OpenGL33Device::GetProperties() const noexcept {
 
 std::expected<std::unique_ptr<Buffer>, Error>
 OpenGL33Device::CreateBuffer(const BufferDesc& desc) {
-    return OpenGL33Buffer::Create(desc);
+    return OpenGL33Buffer::Create(*this, desc);
 }
 
 std::expected<std::unique_ptr<Texture>, Error>
 OpenGL33Device::CreateTexture(const TextureDesc& desc) {
-    return OpenGL33Texture::Create(desc);
+    return OpenGL33Texture::Create(*this, desc);
 }
 
 std::expected<std::unique_ptr<Sampler>, Error>
 OpenGL33Device::CreateSampler(const SamplerDesc& desc) {
-    return OpenGL33Sampler::Create(desc);
+    return OpenGL33Sampler::Create(*this, desc);
 }
 
 std::expected<std::unique_ptr<Shader>, Error>
 OpenGL33Device::CreateShader(const ShaderDesc& desc) {
-    return OpenGL33Shader::Create(desc);
+    return OpenGL33Shader::Create(desc, m_profile.glslVersion);
 }
 
 std::expected<std::unique_ptr<Pipeline>, Error>
 OpenGL33Device::CreatePipeline(const PipelineDesc& desc) {
-    return OpenGL33Pipeline::Create(desc);
+    return OpenGL33Pipeline::Create(*this, desc);
 }
 
 std::expected<std::unique_ptr<RenderPass>, Error>
@@ -174,29 +204,76 @@ OpenGL33Device::CreateRenderPass(const RenderPassDesc& desc) {
 
 std::expected<std::unique_ptr<Framebuffer>, Error>
 OpenGL33Device::CreateFramebuffer(const FramebufferDesc& desc) {
-    return OpenGL33Framebuffer::Create(desc);
+    return OpenGL33Framebuffer::Create(*this, desc);
+}
+
+std::unique_ptr<CommandBuffer> OpenGL33Device::CreateCommandBuffer(CommandBufferLevel level) {
+    return std::make_unique<OpenGL33CommandBuffer>(level);
 }
 
-std::unique_ptr<CommandBuffer> OpenGL33Device::CreateCommandBuffer() {
-    return std::make_unique<OpenGL33CommandBuffer>();
+TransientAllocator* OpenGL33Device::GetTransientAllocator() noexcept {
+    return m_transientAllocator.get();
 }
 
-void OpenGL33Device::Submit(std::unique_ptr<CommandBuffer> cmd) {
-    // In OpenGL, commands are typically executed immediately
-    // The command buffer pattern is less relevant, but we maintain it for API consistency
-    auto* glCmd = static_cast<OpenGL33CommandBuffer*>(cmd.get());
-    glCmd->Execute();
+ThreadPool& OpenGL33Device::GetThreadPool() {
+    if (!m_threads) {
+        m_threads = std::make_unique<ThreadPool>(m_config.workerThreads);
+    }
+    return *m_threads;
+}
+
+unsigned int OpenGL33Device::GetReadFramebuffer() {
+    if (m_readFramebuffer == 0) {
+        glGenFramebuffers(1, &m_readFramebuffer);
+    }
+    return m_readFramebuffer;
+}
+
+void OpenGL33Device::Submit(std::unique_ptr<CommandBuffer> cmd, Fence* signalFence) {
+    Submit(cmd.get(), signalFence);
+}
+
+void OpenGL33Device::Submit(CommandBuffer* cmd, Fence* signalFence) {
+    // Slices written since the last submission must be unmapped before draws read them
+    if (m_transientAllocator) {
+        m_transientAllocator->FlushWrites();
+    }
+    if (m_uploadQueue) {
+        m_uploadQueue->Flush();
+    }
+    
+    // Commands were only encoded while recording; replay them on the context thread
+    if (cmd) {
+        if (cmd->GetLevel() != CommandBufferLevel::Primary) {
+            LogWarning("Secondary command buffers cannot be submitted; use ExecuteCommands");
+            return;
+        }
+        auto* glCmd = static_cast<OpenGL33CommandBuffer*>(cmd);
+        glCmd->Execute(*this);
+    }
+    
+    if (signalFence) {
+        static_cast<OpenGL33Fence*>(signalFence)->Signal();
+    }
 }
 
-void OpenGL33Device::Submit(std::span<std::unique_ptr<CommandBuffer>> cmds) {
-    for (auto& cmd : cmds) {
-        Submit(std::move(cmd));
+void OpenGL33Device::Submit(std::span<std::unique_ptr<CommandBuffer>> cmds, Fence* signalFence) {
+    for (size_t i = 0; i < cmds.size(); ++i) {
+        Submit(std::move(cmds[i]), i + 1 == cmds.size() ? signalFence : nullptr);
+    }
+    if (cmds.empty() && signalFence) {
+        Submit(nullptr, signalFence);
     }
 }
 
 void OpenGL33Device::WaitIdle() {
+    if (m_uploadQueue) {
+        m_uploadQueue->Flush();
+    }
+    
     // In OpenGL, glFinish waits for all commands to complete
     glFinish();
+    m_deletionQueue.DeleteAll();
 }
 
 std::unique_ptr<Fence> OpenGL33Device::CreateFence(bool signaled) {
@@ -208,6 +285,10 @@ std::unique_ptr<Semaphore> OpenGL33Device::CreateSemaphore() {
 }
 
 void OpenGL33Device::Flush() {
+    if (m_uploadQueue) {
+        m_uploadQueue->Flush();
+    }
+    
     // glFlush suggests the GPU should execute pending commands
     glFlush();
 }
@@ -219,9 +300,40 @@ SwapChain* OpenGL33Device::GetSwapChain() noexcept {
 }
 
 void OpenGL33Device::Present() {
+    // Fence the frame's transient and staging memory before the flush sends it to the GPU
+    if (m_transientAllocator) {
+        m_transientAllocator->EndFrame();
+    }
+    if (m_uploadQueue) {
+        m_uploadQueue->EndFrame();
+    }
+    m_deletionQueue.EndFrame();
+    
     // Present would be handled by the swap chain/window system
     // For now, we just flush
     glFlush();
+    
+    // Close the frame's statistics
+    const auto& counters = m_stateCache.GetCounters();
+    m_lastFrameStats = FrameStats{};
+    m_lastFrameStats.stateChangesEmitted = counters.emitted;
+    m_lastFrameStats.stateChangesFiltered = counters.filtered;
+    m_lastFrameStats.drawCalls = m_drawCalls;
+    m_lastFrameStats.drawsMerged = m_drawsMerged;
+    m_lastFrameStats.vertexArrayMisses = m_vertexArrayCache.GetMissCount();
+    if (m_uploadQueue) {
+        m_lastFrameStats.bytesUploaded = m_uploadQueue->GetLastFrameBytes();
+        m_lastFrameStats.uploadMegabytesPerSecond = m_uploadQueue->GetLastFrameMegabytesPerSecond();
+    }
+    m_stateCache.ResetCounters();
+    m_vertexArrayCache.ResetMissCount();
+    m_drawCalls = 0;
+    m_drawsMerged = 0;
+    ++m_frameNumber;
+}
+
+FrameStats OpenGL33Device::GetFrameStats() const noexcept {
+    return m_lastFrameStats;
 }
 
 void OpenGL33Device::Resize(uint32_t width, uint32_t height) {
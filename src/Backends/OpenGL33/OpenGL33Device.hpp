@@ -4,16 +4,32 @@
 #pragma once
 
 #include <VRHI/VRHI.hpp>
+#include "OpenGL33StateCache.hpp"
+#include "OpenGL33VertexArrayCache.hpp"
+#include "OpenGL33UniformRing.hpp"
+#include "OpenGL33TransientAllocator.hpp"
+#include "OpenGL33UploadQueue.hpp"
+#include "OpenGL33DeletionQueue.hpp"
+#include <memory>
 #include <expected>
 
 namespace VRHI {
 
 class OpenGL33Backend;
+class ThreadPool;
+
+/// What the context allows beyond OpenGL 3.3. OpenGL33Device runs with the
+/// defaults; OpenGL46Device enables everything.
+struct GLDeviceProfile {
+    int glslVersion = 330;            // Target of SPIR-V cross-compilation
+    bool computeAndIndirect = false;  // Dispatch, indirect draws, storage buffers, memory barriers
+    bool directStateAccess = false;   // Edit buffers and textures by name instead of binding them
+};
 
 /// OpenGL 3.3 device implementation
 class OpenGL33Device : public Device {
 public:
-    OpenGL33Device(const DeviceConfig& config, OpenGL33Backend* backend);
+    OpenGL33Device(const DeviceConfig& config, OpenGL33Backend* backend, const GLDeviceProfile& profile = {});
     ~OpenGL33Device() override;
     
     // Initialize the device (create context, etc.)
@@ -52,9 +68,11 @@ public:
     CreateFramebuffer(const struct FramebufferDesc& desc) override;
     
     // Command Execution
-    std::unique_ptr<CommandBuffer> CreateCommandBuffer() override;
-    void Submit(std::unique_ptr<CommandBuffer> cmd) override;
-    void Submit(std::span<std::unique_ptr<CommandBuffer>> cmds) override;
+    std::unique_ptr<CommandBuffer> CreateCommandBuffer(CommandBufferLevel level = CommandBufferLevel::Primary) override;
+    TransientAllocator* GetTransientAllocator() noexcept override;
+    void Submit(std::unique_ptr<CommandBuffer> cmd, Fence* signalFence = nullptr) override;
+    void Submit(CommandBuffer* cmd, Fence* signalFence = nullptr) override;
+    void Submit(std::span<std::unique_ptr<CommandBuffer>> cmds, Fence* signalFence = nullptr) override;
     void WaitIdle() override;
     
     // Synchronization
@@ -67,6 +85,50 @@ public:
     void Present() override;
     void Resize(uint32_t width, uint32_t height) override;
     
+    // Statistics
+    FrameStats GetFrameStats() const noexcept override;
+    
+    // OpenGL-specific: shadow of the context state shared by all resources
+    OpenGL33StateCache& GetStateCache() noexcept { return m_stateCache; }
+    
+    // OpenGL-specific: VAOs keyed by vertex layout and bound buffers
+    OpenGL33VertexArrayCache& GetVertexArrayCache() noexcept { return m_vertexArrayCache; }
+    
+    // OpenGL-specific: streaming uniform buffer backing push constants
+    OpenGL33UniformRing& GetUniformRing() noexcept { return m_uniformRing; }
+    
+    // OpenGL-specific: staging ring for Buffer/Texture updates; nullptr while
+    // the device is being destroyed
+    OpenGL33UploadQueue* GetUploadQueue() noexcept { return m_uploadQueue.get(); }
+    
+    // OpenGL-specific: GL objects of destroyed resources, deleted once the GPU is done with them
+    OpenGL33DeletionQueue& GetDeletionQueue() noexcept { return m_deletionQueue; }
+    
+    // OpenGL-specific: GLSL target and the GL 4.x commands replay may use
+    const GLDeviceProfile& GetProfile() const noexcept { return m_profile; }
+    
+    // OpenGL-specific: threads running compute shaders compiled for the CPU, started on first use
+    ThreadPool& GetThreadPool();
+    
+    // OpenGL-specific: framebuffer replay attaches single texture layers to for reading,
+    // created on first use
+    unsigned int GetReadFramebuffer();
+    
+    // OpenGL-specific: whether submission coalesces draws (DeviceConfig::mergeDraws)
+    bool IsDrawMergingEnabled() const noexcept { return m_config.mergeDraws; }
+    
+    // OpenGL-specific: frames presented so far; streaming buffers rotate when it changes
+    uint64_t GetFrameNumber() const noexcept { return m_frameNumber; }
+    
+    // OpenGL-specific: draw calls issued by a command buffer replay, for the frame stats
+    void CountDraws(uint64_t drawCalls, uint64_t drawsMerged) noexcept {
+        m_drawCalls += drawCalls;
+        m_drawsMerged += drawsMerged;
+    }
+    
+protected:
+    GLDeviceProfile m_profile;  // Derived devices may refine it once the context is known
+    
 private:
     DeviceConfig m_config;
     OpenGL33Backend* m_backend;
@@ -80,6 +142,19 @@ private:
     
     // Default VAO (required for OpenGL 3.3 core profile)
     unsigned int m_defaultVAO = 0;
+    unsigned int m_readFramebuffer = 0;
+    
+    OpenGL33StateCache m_stateCache;
+    OpenGL33VertexArrayCache m_vertexArrayCache{m_stateCache};
+    OpenGL33UniformRing m_uniformRing{m_stateCache};
+    std::unique_ptr<OpenGL33TransientAllocator> m_transientAllocator;  // Created once features are known
+    std::unique_ptr<OpenGL33UploadQueue> m_uploadQueue;
+    OpenGL33DeletionQueue m_deletionQueue{*this};
+    std::unique_ptr<ThreadPool> m_threads;  // DeviceConfig::workerThreads
+    FrameStats m_lastFrameStats;
+    uint64_t m_drawCalls = 0;    // Current frame
+    uint64_t m_drawsMerged = 0;  // Current frame
+    uint64_t m_frameNumber = 0;
     
     bool m_initialized = false;
 };
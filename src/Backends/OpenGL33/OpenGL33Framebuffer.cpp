@@ -2,18 +2,21 @@
 // SPDX-License-Identifier: MIT
 
 #include "OpenGL33Framebuffer.hpp"
+#include "OpenGL33Device.hpp"
+#include "OpenGL33Texture.hpp"
+#include "GLFormatUtils.hpp"
 #include <VRHI/Logging.hpp>
+#include <string>
+#include <vector>
 
 namespace VRHI {
 
 OpenGL33Framebuffer::~OpenGL33Framebuffer() {
-    if (m_framebuffer != 0) {
-        glDeleteFramebuffers(1, &m_framebuffer);
-    }
+    m_device->GetDeletionQueue().Retire(OpenGL33DeletionQueue::ObjectType::Framebuffer, m_framebuffer);
 }
 
 std::expected<std::unique_ptr<Framebuffer>, Error>
-OpenGL33Framebuffer::Create(const FramebufferDesc& desc) {
+OpenGL33Framebuffer::Create(OpenGL33Device& device, const FramebufferDesc& desc) {
     GLuint framebuffer = 0;
     glGenFramebuffers(1, &framebuffer);
     
@@ -24,18 +27,51 @@ OpenGL33Framebuffer::Create(const FramebufferDesc& desc) {
         });
     }
     
-    // Simplified implementation - in a real implementation, we would:
-    // 1. Bind the framebuffer
-    // 2. Attach color/depth textures from desc
-    // 3. Check framebuffer completeness
-    // 4. Unbind
+    device.GetStateCache().BindFramebuffer(framebuffer);
+    
+    // Color attachments take draw buffers in order, matching OpenGL33RenderPass
+    std::vector<GLenum> drawBuffers;
+    for (Texture* texture : desc.attachments) {
+        if (!texture) {
+            continue;
+        }
+        
+        GLenum attachment;
+        if (GLFormatUtils::IsDepthStencilFormat(texture->GetFormat())) {
+            attachment = GLFormatUtils::HasStencil(texture->GetFormat())
+                ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+        } else {
+            attachment = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(drawBuffers.size());
+            drawBuffers.push_back(attachment);
+        }
+        
+        GLuint handle = static_cast<OpenGL33Texture*>(texture)->GetHandle();
+        if (texture->GetType() == TextureType::Texture2D) {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, handle, 0);
+        } else {
+            // Layered attachment; the geometry shader selects the layer
+            glFramebufferTexture(GL_FRAMEBUFFER, attachment, handle, 0);
+        }
+    }
+    
+    if (drawBuffers.empty()) {
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    } else {
+        glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+    }
     
-    // For now, assume default dimensions
-    uint32_t width = 1280;
-    uint32_t height = 720;
-    uint32_t layers = 1;
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        device.GetStateCache().OnFramebufferDeleted(framebuffer);
+        glDeleteFramebuffers(1, &framebuffer);
+        return std::unexpected(Error{
+            Error::Code::InitializationFailed,
+            "Incomplete OpenGL framebuffer (status " + std::to_string(status) + ")"
+        });
+    }
     
-    return std::unique_ptr<Framebuffer>(new OpenGL33Framebuffer(framebuffer, width, height, layers));
+    return std::unique_ptr<Framebuffer>(new OpenGL33Framebuffer(device, framebuffer, desc.width, desc.height, desc.layers));
 }
 
 } // namespace VRHI
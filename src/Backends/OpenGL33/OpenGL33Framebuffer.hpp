@@ -11,12 +11,14 @@
 
 namespace VRHI {
 
+class OpenGL33Device;
+
 class OpenGL33Framebuffer : public Framebuffer {
 public:
     ~OpenGL33Framebuffer() override;
     
     static std::expected<std::unique_ptr<Framebuffer>, Error>
-    Create(const FramebufferDesc& desc);
+    Create(OpenGL33Device& device, const FramebufferDesc& desc);
     
     uint32_t GetWidth() const noexcept override { return m_width; }
     uint32_t GetHeight() const noexcept override { return m_height; }
@@ -25,9 +27,10 @@ public:
     GLuint GetHandle() const noexcept { return m_framebuffer; }
     
 private:
-    OpenGL33Framebuffer(GLuint framebuffer, uint32_t width, uint32_t height, uint32_t layers)
-        : m_framebuffer(framebuffer), m_width(width), m_height(height), m_layers(layers) {}
+    OpenGL33Framebuffer(OpenGL33Device& device, GLuint framebuffer, uint32_t width, uint32_t height, uint32_t layers)
+        : m_device(&device), m_framebuffer(framebuffer), m_width(width), m_height(height), m_layers(layers) {}
     
+    OpenGL33Device* m_device = nullptr;
     GLuint m_framebuffer = 0;
     uint32_t m_width = 0;
     uint32_t m_height = 0;
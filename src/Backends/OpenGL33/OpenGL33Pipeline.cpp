@@ -2,13 +2,154 @@
 // SPDX-License-Identifier: MIT
 
 #include "OpenGL33Pipeline.hpp"
+#include "OpenGL33Device.hpp"
 #include "OpenGL33Shader.hpp"
+#include "GLFormatUtils.hpp"
 #include <VRHI/Logging.hpp>
+#include <VRHI/ShaderCompiler.hpp>
 
 namespace VRHI {
 
+namespace {
+    // Helper function to convert VertexFormat to OpenGL type info
+    struct VertexFormatInfo {
+        GLint componentCount;
+        GLenum type;
+        GLboolean normalized;
+    };
+    
+    VertexFormatInfo GetVertexFormatInfo(VertexFormat format) {
+        switch (format) {
+            case VertexFormat::Float:    return {1, GL_FLOAT, GL_FALSE};
+            case VertexFormat::Float2:   return {2, GL_FLOAT, GL_FALSE};
+            case VertexFormat::Float3:   return {3, GL_FLOAT, GL_FALSE};
+            case VertexFormat::Float4:   return {4, GL_FLOAT, GL_FALSE};
+            case VertexFormat::Int:      return {1, GL_INT, GL_FALSE};
+            case VertexFormat::Int2:     return {2, GL_INT, GL_FALSE};
+            case VertexFormat::Int3:     return {3, GL_INT, GL_FALSE};
+            case VertexFormat::Int4:     return {4, GL_INT, GL_FALSE};
+            case VertexFormat::UInt:     return {1, GL_UNSIGNED_INT, GL_FALSE};
+            case VertexFormat::UInt2:    return {2, GL_UNSIGNED_INT, GL_FALSE};
+            case VertexFormat::UInt3:    return {3, GL_UNSIGNED_INT, GL_FALSE};
+            case VertexFormat::UInt4:    return {4, GL_UNSIGNED_INT, GL_FALSE};
+            default:                     return {3, GL_FLOAT, GL_FALSE};
+        }
+    }
+    
+    GLVertexLayout BakeVertexLayout(const VertexInputState& vertexInput) {
+        GLVertexLayout layout{};
+        
+        for (const auto& binding : vertexInput.bindings) {
+            if (layout.streamCount == GLVertexLayout::MaxStreams) {
+                LogWarning("Pipeline vertex input has too many bindings; extra bindings are ignored");
+                break;
+            }
+            auto& stream = layout.streams[layout.streamCount++];
+            stream.binding = binding.binding;
+            stream.stride = static_cast<GLsizei>(binding.stride);
+            stream.divisor = binding.inputRate == VertexInputRate::Instance ? 1 : 0;
+        }
+        
+        for (const auto& attr : vertexInput.attributes) {
+            uint32_t streamIndex = 0;
+            while (streamIndex < layout.streamCount && layout.streams[streamIndex].binding != attr.binding) {
+                ++streamIndex;
+            }
+            if (streamIndex == layout.streamCount) {
+                LogWarning("Vertex attribute references an undeclared binding; attribute is ignored");
+                continue;
+            }
+            if (layout.attributeCount == GLVertexLayout::MaxAttributes) {
+                LogWarning("Pipeline vertex input has too many attributes; extra attributes are ignored");
+                break;
+            }
+            
+            auto formatInfo = GetVertexFormatInfo(attr.format);
+            auto& glAttr = layout.attributes[layout.attributeCount++];
+            glAttr.location = attr.location;
+            glAttr.componentCount = formatInfo.componentCount;
+            glAttr.type = formatInfo.type;
+            glAttr.normalized = formatInfo.normalized;
+            glAttr.stream = streamIndex;
+            glAttr.offset = attr.offset;
+        }
+        
+        layout.hash = ComputeVertexLayoutHash(layout);
+        return layout;
+    }
+    
+    GLStencilFaceState BakeStencilFace(const StencilOpState& state) {
+        GLStencilFaceState face{};
+        face.func = GLFormatUtils::GetCompareFunc(state.compareOp);
+        face.reference = static_cast<GLint>(state.reference);
+        face.compareMask = state.compareMask;
+        face.writeMask = state.writeMask;
+        face.failOp = GLFormatUtils::GetStencilOp(state.failOp);
+        face.depthFailOp = GLFormatUtils::GetStencilOp(state.depthFailOp);
+        face.passOp = GLFormatUtils::GetStencilOp(state.passOp);
+        return face;
+    }
+    
+    GLPipelineState BakePipelineState(const GraphicsPipelineDesc& desc) {
+        GLPipelineState state{};
+        state.primitiveMode = GLFormatUtils::GetPrimitiveMode(desc.inputAssembly.topology);
+        
+        const auto& depthStencil = desc.depthStencil;
+        state.depthTest = depthStencil.depthTestEnable;
+        state.depthWrite = depthStencil.depthWriteEnable;
+        state.depthFunc = GLFormatUtils::GetCompareFunc(depthStencil.depthCompareOp);
+        state.stencilTest = depthStencil.stencilTestEnable;
+        state.stencilFront = BakeStencilFace(depthStencil.front);
+        state.stencilBack = BakeStencilFace(depthStencil.back);
+        
+        const auto& rasterization = desc.rasterization;
+        state.cullFace = rasterization.cullMode != CullMode::None;
+        switch (rasterization.cullMode) {
+            case CullMode::Front:        state.cullMode = GL_FRONT; break;
+            case CullMode::FrontAndBack: state.cullMode = GL_FRONT_AND_BACK; break;
+            default:                     state.cullMode = GL_BACK; break;
+        }
+        state.frontFace = rasterization.frontFace == FrontFace::Clockwise ? GL_CW : GL_CCW;
+        state.polygonOffset = rasterization.depthBiasEnable;
+        state.polygonOffsetFactor = rasterization.depthBiasSlopeFactor;
+        state.polygonOffsetUnits = rasterization.depthBiasConstantFactor;
+        
+        // GL 3.3 shares one blend function across attachments; use the first
+        if (!desc.colorBlend.attachments.empty()) {
+            const auto& blend = desc.colorBlend.attachments[0];
+            state.blend = blend.blendEnable;
+            state.blendSrcColor = GLFormatUtils::GetBlendFactor(blend.srcColorBlendFactor);
+            state.blendDstColor = GLFormatUtils::GetBlendFactor(blend.dstColorBlendFactor);
+            state.blendSrcAlpha = GLFormatUtils::GetBlendFactor(blend.srcAlphaBlendFactor);
+            state.blendDstAlpha = GLFormatUtils::GetBlendFactor(blend.dstAlphaBlendFactor);
+            state.blendEquationColor = GLFormatUtils::GetBlendEquation(blend.colorBlendOp);
+            state.blendEquationAlpha = GLFormatUtils::GetBlendEquation(blend.alphaBlendOp);
+            state.colorWriteMask = static_cast<uint8_t>(static_cast<uint32_t>(blend.colorWriteMask) & 0xF);
+        }
+        
+        return state;
+    }
+} // anonymous namespace
+
 std::expected<std::unique_ptr<Pipeline>, Error>
-OpenGL33Pipeline::Create(const PipelineDesc& desc) {
+OpenGL33Pipeline::Create(OpenGL33Device& device, const PipelineDesc& desc) {
+    // Compute shaders need GL 4.3; before that they run on the CPU
+    if (desc.type == PipelineType::Compute && !device.GetProfile().computeAndIndirect) {
+        if (!desc.compute.computeShader) {
+            return std::unexpected(Error{
+                Error::Code::ValidationError,
+                "Compute pipeline requires a compute shader"
+            });
+        }
+        auto kernel = CpuComputeKernel::Create(static_cast<OpenGL33Shader*>(desc.compute.computeShader)->GetSPIRV());
+        if (!kernel) {
+            return std::unexpected(kernel.error());
+        }
+        auto pipeline = std::unique_ptr<OpenGL33Pipeline>(new OpenGL33Pipeline(device, 0, desc.type, {}));
+        pipeline->m_cpuKernel = std::move(*kernel);
+        return pipeline;
+    }
+    
     // For OpenGL 3.3, we need to create a shader program
     GLuint program = glCreateProgram();
     
@@ -61,12 +202,14 @@ OpenGL33Pipeline::Create(const PipelineDesc& desc) {
             glAttachShader(program, glShader->GetHandle());
         }
     } else if (desc.type == PipelineType::Compute) {
-        // Compute shaders not supported in OpenGL 3.3
-        glDeleteProgram(program);
-        return std::unexpected(Error{
-            Error::Code::UnsupportedFeature,
-            "Compute shaders not supported in OpenGL 3.3"
-        });
+        if (!desc.compute.computeShader) {
+            glDeleteProgram(program);
+            return std::unexpected(Error{
+                Error::Code::ValidationError,
+                "Compute pipeline requires a compute shader"
+            });
+        }
+        glAttachShader(program, static_cast<OpenGL33Shader*>(desc.compute.computeShader)->GetHandle());
     }
     
     // Link the program
@@ -94,6 +237,12 @@ OpenGL33Pipeline::Create(const PipelineDesc& desc) {
         });
     }
     
+    // Push constants are emulated with a uniform block at a reserved binding
+    GLuint pushConstantBlock = glGetUniformBlockIndex(program, PushConstantBlockName);
+    if (pushConstantBlock != GL_INVALID_INDEX) {
+        glUniformBlockBinding(program, pushConstantBlock, PushConstantBinding);
+    }
+    
     // Detach shaders after linking (they're no longer needed)
     if (desc.type == PipelineType::Graphics) {
         if (desc.graphics.vertexShader) {
@@ -116,18 +265,21 @@ OpenGL33Pipeline::Create(const PipelineDesc& desc) {
             auto* glShader = static_cast<OpenGL33Shader*>(desc.graphics.tessEvalShader);
             glDetachShader(program, glShader->GetHandle());
         }
+    } else {
+        glDetachShader(program, static_cast<OpenGL33Shader*>(desc.compute.computeShader)->GetHandle());
     }
     
     // Copy vertex input state for graphics pipelines
     if (desc.type == PipelineType::Graphics) {
-        return std::unique_ptr<Pipeline>(new OpenGL33Pipeline(program, desc.type, desc.graphics));
+        return std::unique_ptr<Pipeline>(new OpenGL33Pipeline(device, program, desc.type, desc.graphics));
     } else {
-        return std::unique_ptr<Pipeline>(new OpenGL33Pipeline(program, desc.type, {}));
+        return std::unique_ptr<Pipeline>(new OpenGL33Pipeline(device, program, desc.type, {}));
     }
 }
 
-OpenGL33Pipeline::OpenGL33Pipeline(GLuint program, PipelineType type, const GraphicsPipelineDesc& desc)
-    : m_program(program)
+OpenGL33Pipeline::OpenGL33Pipeline(OpenGL33Device& device, GLuint program, PipelineType type, const GraphicsPipelineDesc& desc)
+    : m_device(&device)
+    , m_program(program)
     , m_type(type)
 {
     // Copy vertex attributes and bindings to internal storage
@@ -152,14 +304,16 @@ OpenGL33Pipeline::OpenGL33Pipeline(GLuint program, PipelineType type, const Grap
             m_colorBlendAttachments.assign(desc.colorBlend.attachments.begin(), desc.colorBlend.attachments.end());
             m_colorBlendState.attachments = m_colorBlendAttachments;
         }
+        
+        m_glState = BakePipelineState(desc);
+        *m_vertexLayout = BakeVertexLayout(desc.vertexInput);
     }
 }
 
 OpenGL33Pipeline::~OpenGL33Pipeline() {
-    if (m_program != 0) {
-        glDeleteProgram(m_program);
-        m_program = 0;
-    }
+    // The layout keys cached VAOs, so it lives until the program is deleted
+    m_device->GetDeletionQueue().Retire(m_program, std::move(m_vertexLayout));
+    m_program = 0;
 }
 
 } // namespace VRHI
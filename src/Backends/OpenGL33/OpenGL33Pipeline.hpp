@@ -7,16 +7,21 @@
 #include <memory>
 
 #include <VRHI/Pipeline.hpp>
+#include "OpenGL33StateCache.hpp"
+#include "OpenGL33VertexArrayCache.hpp"
+#include "Core/CpuComputeKernel.hpp"
 #include <glad/glad.h>
 
 namespace VRHI {
 
+class OpenGL33Device;
+
 class OpenGL33Pipeline : public Pipeline {
 public:
     ~OpenGL33Pipeline() override;
     
     static std::expected<std::unique_ptr<Pipeline>, Error>
-    Create(const PipelineDesc& desc);
+    Create(OpenGL33Device& device, const PipelineDesc& desc);
     
     PipelineType GetType() const noexcept override { return m_type; }
     
@@ -27,9 +32,19 @@ public:
     const RasterizationState& GetRasterizationState() const noexcept { return m_rasterizationState; }
     const ColorBlendState& GetColorBlendState() const noexcept { return m_colorBlendState; }
     
+    /// Fixed-function state translated to GL, applied through the state cache
+    const GLPipelineState& GetGLState() const noexcept { return m_glState; }
+    
+    /// Vertex input translated to GL, used to look up vertex array objects
+    const GLVertexLayout& GetVertexLayout() const noexcept { return *m_vertexLayout; }
+    
+    /// Compute shader compiled for the CPU, on contexts without compute shaders
+    CpuComputeKernel* GetCpuKernel() const noexcept { return m_cpuKernel.get(); }
+    
 private:
-    OpenGL33Pipeline(GLuint program, PipelineType type, const GraphicsPipelineDesc& desc);
+    OpenGL33Pipeline(OpenGL33Device& device, GLuint program, PipelineType type, const GraphicsPipelineDesc& desc);
     
+    OpenGL33Device* m_device = nullptr;
     GLuint m_program = 0;
     PipelineType m_type = PipelineType::Graphics;
     
@@ -43,6 +58,10 @@ private:
     RasterizationState m_rasterizationState;
     ColorBlendState m_colorBlendState;
     std::vector<ColorBlendAttachment> m_colorBlendAttachments;
+    GLPipelineState m_glState;
+    std::unique_ptr<GLVertexLayout> m_vertexLayout = std::make_unique<GLVertexLayout>();
+    
+    std::unique_ptr<CpuComputeKernel> m_cpuKernel;  // Program is 0 when set
 };
 
 } // namespace VRHI
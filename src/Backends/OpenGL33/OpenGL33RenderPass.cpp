@@ -2,14 +2,31 @@
 // SPDX-License-Identifier: MIT
 
 #include "OpenGL33RenderPass.hpp"
+#include "GLFormatUtils.hpp"
 
 namespace VRHI {
 
 std::expected<std::unique_ptr<RenderPass>, Error>
 OpenGL33RenderPass::Create(const RenderPassDesc& desc) {
-    // In OpenGL, render passes are not explicit objects
-    // We just store the descriptor for later use
-    return std::unique_ptr<RenderPass>(new OpenGL33RenderPass());
+    // In OpenGL, render passes are not explicit objects; the load and store
+    // ops are applied when the command buffer begins and ends the pass
+    std::unique_ptr<OpenGL33RenderPass> renderPass(new OpenGL33RenderPass());
+    renderPass->m_attachments.reserve(desc.attachments.size());
+    
+    uint32_t colorCount = 0;
+    for (const AttachmentDesc& attachmentDesc : desc.attachments) {
+        GLRenderPassAttachment attachment{};
+        attachment.desc = attachmentDesc;
+        attachment.isDepthStencil = GLFormatUtils::IsDepthStencilFormat(attachmentDesc.format);
+        attachment.hasStencil = GLFormatUtils::HasStencil(attachmentDesc.format);
+        attachment.isUnsignedInteger = GLFormatUtils::IsUnsignedIntegerFormat(attachmentDesc.format);
+        if (!attachment.isDepthStencil) {
+            attachment.colorIndex = colorCount++;
+        }
+        renderPass->m_attachments.push_back(attachment);
+    }
+    
+    return std::unique_ptr<RenderPass>(std::move(renderPass));
 }
 
 } // namespace VRHI
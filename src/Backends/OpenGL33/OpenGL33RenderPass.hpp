@@ -5,11 +5,21 @@
 #include <VRHI/VRHI.hpp>
 #include <expected>
 #include <memory>
+#include <vector>
 
 #include <VRHI/RenderPass.hpp>
 
 namespace VRHI {
 
+/// Attachment of a render pass as OpenGL addresses it
+struct GLRenderPassAttachment {
+    AttachmentDesc desc;
+    bool isDepthStencil = false;
+    bool hasStencil = false;
+    bool isUnsignedInteger = false;
+    uint32_t colorIndex = 0;  // Draw buffer of a color attachment
+};
+
 class OpenGL33RenderPass : public RenderPass {
 public:
     ~OpenGL33RenderPass() override = default;
@@ -17,8 +27,14 @@ public:
     static std::expected<std::unique_ptr<RenderPass>, Error>
     Create(const RenderPassDesc& desc);
     
+    /// Attachments in RenderPassDesc order; color attachments take draw
+    /// buffers in the order they appear
+    const std::vector<GLRenderPassAttachment>& GetAttachments() const noexcept { return m_attachments; }
+    
 private:
     OpenGL33RenderPass() = default;
+    
+    std::vector<GLRenderPassAttachment> m_attachments;
 };
 
 } // namespace VRHI
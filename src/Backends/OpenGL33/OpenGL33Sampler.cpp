@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: MIT
 
 #include "OpenGL33Sampler.hpp"
+#include "OpenGL33Device.hpp"
 #include <VRHI/Logging.hpp>
 
 namespace VRHI {
@@ -40,19 +41,18 @@ namespace {
     }
 }
 
-OpenGL33Sampler::OpenGL33Sampler(GLuint sampler)
-    : m_sampler(sampler)
+OpenGL33Sampler::OpenGL33Sampler(OpenGL33Device& device, GLuint sampler)
+    : m_device(&device)
+    , m_sampler(sampler)
 {
 }
 
 OpenGL33Sampler::~OpenGL33Sampler() {
-    if (m_sampler != 0) {
-        glDeleteSamplers(1, &m_sampler);
-    }
+    m_device->GetDeletionQueue().Retire(OpenGL33DeletionQueue::ObjectType::Sampler, m_sampler);
 }
 
 std::expected<std::unique_ptr<Sampler>, Error>
-OpenGL33Sampler::Create(const SamplerDesc& desc) {
+OpenGL33Sampler::Create(OpenGL33Device& device, const SamplerDesc& desc) {
     GLuint sampler = 0;
     glGenSamplers(1, &sampler);
     
@@ -108,7 +108,7 @@ OpenGL33Sampler::Create(const SamplerDesc& desc) {
     glSamplerParameterfv(sampler, GL_TEXTURE_BORDER_COLOR, desc.borderColor);
     
     auto samplerObj = std::unique_ptr<Sampler>(
-        new OpenGL33Sampler(sampler)
+        new OpenGL33Sampler(device, sampler)
     );
     
     return samplerObj;
@@ -11,18 +11,21 @@
 
 namespace VRHI {
 
+class OpenGL33Device;
+
 class OpenGL33Sampler : public Sampler {
 public:
     ~OpenGL33Sampler() override;
     
     static std::expected<std::unique_ptr<Sampler>, Error>
-    Create(const SamplerDesc& desc);
+    Create(OpenGL33Device& device, const SamplerDesc& desc);
     
     GLuint GetHandle() const noexcept { return m_sampler; }
     
 private:
-    OpenGL33Sampler(GLuint sampler);
+    OpenGL33Sampler(OpenGL33Device& device, GLuint sampler);
     
+    OpenGL33Device* m_device = nullptr;
     GLuint m_sampler = 0;
 };
 
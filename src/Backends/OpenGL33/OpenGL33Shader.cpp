@@ -15,15 +15,17 @@ namespace {
             case ShaderStage::Vertex: return GL_VERTEX_SHADER;
             case ShaderStage::Fragment: return GL_FRAGMENT_SHADER;
             case ShaderStage::Geometry: return GL_GEOMETRY_SHADER;
+            case ShaderStage::TessControl: return GL_TESS_CONTROL_SHADER;
+            case ShaderStage::TessEval: return GL_TESS_EVALUATION_SHADER;
+            case ShaderStage::Compute: return GL_COMPUTE_SHADER;
             default:
-                LogError("Unsupported shader stage for OpenGL 3.3");
-                return GL_VERTEX_SHADER;
+                return GL_NONE;
         }
     }
 }
 
 std::expected<std::unique_ptr<Shader>, Error>
-OpenGL33Shader::Create(const ShaderDesc& desc) {
+OpenGL33Shader::Create(const ShaderDesc& desc, int glslVersion) {
     if (desc.code == nullptr || desc.codeSize == 0) {
         return std::unexpected(Error{
             Error::Code::InvalidConfig,
@@ -31,10 +33,21 @@ OpenGL33Shader::Create(const ShaderDesc& desc) {
         });
     }
     
+    // Tessellation needs GL 4.0; glCreateShader rejects it on older contexts
     GLenum shaderType = GetGLShaderStage(desc.stage);
-    GLuint shader = glCreateShader(shaderType);
+    if (shaderType == GL_NONE) {
+        return std::unexpected(Error{
+            Error::Code::UnsupportedFeature,
+            "Unsupported shader stage for OpenGL"
+        });
+    }
+    
+    // Contexts without GLSL 4.30 get compute shaders as SPIR-V, which the
+    // pipeline compiles for the CPU
+    const bool cpuCompute = desc.stage == ShaderStage::Compute && glslVersion < 430;
+    GLuint shader = cpuCompute ? 0 : glCreateShader(shaderType);
     
-    if (shader == 0) {
+    if (shader == 0 && !cpuCompute) {
         return std::unexpected(Error{
             Error::Code::InitializationFailed,
             "Failed to create OpenGL shader"
@@ -42,7 +55,7 @@ OpenGL33Shader::Create(const ShaderDesc& desc) {
     }
     
     // Determine the shader source to compile
-    // Always go through GLSL -> SPIR-V -> GLSL 3.30 pipeline to ensure compatibility
+    // Always go through GLSL -> SPIR-V -> GLSL (3.30 unless the device targets a newer version)
     std::string glslSource;
     
     std::vector<uint32_t> spirvData;
@@ -75,15 +88,20 @@ OpenGL33Shader::Create(const ShaderDesc& desc) {
         });
     }
     
-    // Step 2: Convert SPIR-V to GLSL 3.30 for OpenGL 3.3 compatibility
-    auto glslResult = ShaderCompiler::ConvertSPIRVToGLSL(spirvData, 330);
+    std::string entryPoint = desc.entryPoint ? desc.entryPoint : "main";
+    if (cpuCompute) {
+        return std::unique_ptr<Shader>(new OpenGL33Shader(0, desc.stage, desc.language, std::move(entryPoint),
+                                                          std::move(spirvData)));
+    }
+    
+    // Step 2: Convert SPIR-V to the GLSL version of the context
+    auto glslResult = ShaderCompiler::ConvertSPIRVToGLSL(spirvData, glslVersion);
     if (!glslResult) {
         glDeleteShader(shader);
         return std::unexpected(glslResult.error());
     }
     
     glslSource = std::move(*glslResult);
-    LogInfo("Converted SPIR-V to GLSL 3.30 for OpenGL 3.3");
     
     // Compile the GLSL source
     const char* source = glslSource.c_str();
@@ -114,7 +132,6 @@ OpenGL33Shader::Create(const ShaderDesc& desc) {
         });
     }
     
-    std::string entryPoint = desc.entryPoint ? desc.entryPoint : "main";
     return std::unique_ptr<Shader>(new OpenGL33Shader(shader, desc.stage, desc.language, std::move(entryPoint)));
 }
 
@@ -4,6 +4,8 @@
 #pragma once
 #include <expected>
 #include <memory>
+#include <span>
+#include <vector>
 
 #include <VRHI/VRHI.hpp>
 #include <VRHI/Shader.hpp>
@@ -16,7 +18,7 @@ public:
     ~OpenGL33Shader() override = default;
     
     static std::expected<std::unique_ptr<Shader>, Error>
-    Create(const ShaderDesc& desc);
+    Create(const ShaderDesc& desc, int glslVersion = 330);
     
     ShaderStage GetStage() const noexcept override { return m_stage; }
     ShaderLanguage GetLanguage() const noexcept override { return m_language; }
@@ -24,14 +26,21 @@ public:
     
     GLuint GetHandle() const noexcept { return m_shader; }
     
+    /// SPIR-V of compute shaders the context cannot compile, which run on
+    /// the CPU instead; empty for shaders with a GL handle
+    std::span<const uint32_t> GetSPIRV() const noexcept { return m_spirv; }
+    
 private:
-    OpenGL33Shader(GLuint shader, ShaderStage stage, ShaderLanguage language, std::string entryPoint)
-        : m_shader(shader), m_stage(stage), m_language(language), m_entryPoint(std::move(entryPoint)) {}
+    OpenGL33Shader(GLuint shader, ShaderStage stage, ShaderLanguage language, std::string entryPoint,
+                   std::vector<uint32_t> spirv = {})
+        : m_shader(shader), m_stage(stage), m_language(language), m_entryPoint(std::move(entryPoint))
+        , m_spirv(std::move(spirv)) {}
     
     GLuint m_shader = 0;
     ShaderStage m_stage;
     ShaderLanguage m_language;
     std::string m_entryPoint;
+    std::vector<uint32_t> m_spirv;
 };
 
 } // namespace VRHI
@@ -0,0 +1,361 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "OpenGL33StateCache.hpp"
+
+namespace VRHI {
+
+int OpenGL33StateCache::GetBufferSlot(GLenum target) noexcept {
+    switch (target) {
+        case GL_ARRAY_BUFFER:         return SlotArray;
+        case GL_ELEMENT_ARRAY_BUFFER: return SlotElementArray;
+        case GL_UNIFORM_BUFFER:       return SlotUniform;
+        case GL_COPY_READ_BUFFER:     return SlotCopyRead;
+        case GL_COPY_WRITE_BUFFER:    return SlotCopyWrite;
+        case GL_PIXEL_PACK_BUFFER:    return SlotPixelPack;
+        case GL_PIXEL_UNPACK_BUFFER:  return SlotPixelUnpack;
+        case GL_DRAW_INDIRECT_BUFFER: return SlotDrawIndirect;
+        case GL_DISPATCH_INDIRECT_BUFFER: return SlotDispatchIndirect;
+        default:                      return -1;
+    }
+}
+
+int OpenGL33StateCache::GetTextureSlot(GLenum target) noexcept {
+    switch (target) {
+        case GL_TEXTURE_1D:       return Slot1D;
+        case GL_TEXTURE_2D:       return Slot2D;
+        case GL_TEXTURE_3D:       return Slot3D;
+        case GL_TEXTURE_CUBE_MAP: return SlotCube;
+        case GL_TEXTURE_1D_ARRAY: return Slot1DArray;
+        case GL_TEXTURE_2D_ARRAY: return Slot2DArray;
+        case GL_TEXTURE_CUBE_MAP_ARRAY: return SlotCubeArray;
+        default:                  return -1;
+    }
+}
+
+void OpenGL33StateCache::Invalidate() {
+    // Keep the counters, everything else becomes unknown
+    Counters counters = m_counters;
+    *this = OpenGL33StateCache{};
+    m_counters = counters;
+}
+
+// ============================================================================
+// Objects
+// ============================================================================
+
+void OpenGL33StateCache::UseProgram(GLuint program) {
+    if (Update(m_program, program)) {
+        glUseProgram(program);
+    }
+}
+
+void OpenGL33StateCache::BindVertexArray(GLuint vao) {
+    if (Update(m_vertexArray, vao)) {
+        glBindVertexArray(vao);
+        // The element array binding is part of the VAO
+        m_buffers[SlotElementArray].valid = false;
+    }
+}
+
+void OpenGL33StateCache::BindFramebuffer(GLuint framebuffer) {
+    if (Update(m_framebuffer, framebuffer)) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    }
+}
+
+void OpenGL33StateCache::BindBuffer(GLenum target, GLuint buffer) {
+    int slot = GetBufferSlot(target);
+    if (slot < 0) {
+        ++m_counters.emitted;
+        glBindBuffer(target, buffer);
+        return;
+    }
+    if (Update(m_buffers[slot], buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void OpenGL33StateCache::BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    if (target != GL_UNIFORM_BUFFER || index >= MaxUniformBufferBindings) {
+        ++m_counters.emitted;
+        glBindBufferRange(target, index, buffer, offset, size);
+        // Indexed binds also replace the generic binding point
+        int slot = GetBufferSlot(target);
+        if (slot >= 0) {
+            m_buffers[slot].valid = false;
+        }
+        return;
+    }
+    if (Update(m_uniformRanges[index], BufferRange{buffer, offset, size})) {
+        glBindBufferRange(target, index, buffer, offset, size);
+        // Indexed binds also replace the generic binding point
+        m_buffers[SlotUniform].value = buffer;
+        m_buffers[SlotUniform].valid = true;
+    }
+}
+
+void OpenGL33StateCache::SetActiveTexture(GLuint unit) {
+    if (Update(m_activeTexture, unit)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+}
+
+void OpenGL33StateCache::BindTexture(GLuint unit, GLenum target, GLuint texture) {
+    int slot = GetTextureSlot(target);
+    if (slot < 0 || unit >= MaxTextureUnits) {
+        SetActiveTexture(unit);
+        ++m_counters.emitted;
+        glBindTexture(target, texture);
+        return;
+    }
+    if (m_textures[unit][slot].valid && m_textures[unit][slot].value == texture) {
+        ++m_counters.filtered;
+        return;
+    }
+    SetActiveTexture(unit);
+    Update(m_textures[unit][slot], texture);
+    glBindTexture(target, texture);
+}
+
+void OpenGL33StateCache::BindTextureForUpdate(GLenum target, GLuint texture) {
+    BindTexture(m_activeTexture.valid ? m_activeTexture.value : 0, target, texture);
+}
+
+void OpenGL33StateCache::BindSampler(GLuint unit, GLuint sampler) {
+    if (unit >= MaxTextureUnits) {
+        ++m_counters.emitted;
+        glBindSampler(unit, sampler);
+        return;
+    }
+    if (Update(m_samplers[unit], sampler)) {
+        glBindSampler(unit, sampler);
+    }
+}
+
+// ============================================================================
+// Fixed-Function State
+// ============================================================================
+
+void OpenGL33StateCache::SetCapability(Capability cap, GLenum glCap, bool enabled) {
+    if (Update(m_capabilities[cap], enabled)) {
+        if (enabled) {
+            glEnable(glCap);
+        } else {
+            glDisable(glCap);
+        }
+    }
+}
+
+void OpenGL33StateCache::ApplyPipelineState(const GLPipelineState& state) {
+    // Depth
+    SetCapability(CapDepthTest, GL_DEPTH_TEST, state.depthTest);
+    if (state.depthTest) {
+        if (Update(m_depthFunc, state.depthFunc)) {
+            glDepthFunc(state.depthFunc);
+        }
+        SetDepthMask(state.depthWrite);
+    }
+
+    // Rasterization
+    SetCapability(CapCullFace, GL_CULL_FACE, state.cullFace);
+    if (state.cullFace) {
+        if (Update(m_cullFace, state.cullMode)) {
+            glCullFace(state.cullMode);
+        }
+    }
+    if (Update(m_frontFace, state.frontFace)) {
+        glFrontFace(state.frontFace);
+    }
+    SetCapability(CapPolygonOffsetFill, GL_POLYGON_OFFSET_FILL, state.polygonOffset);
+    if (state.polygonOffset) {
+        SetPolygonOffset(state.polygonOffsetFactor, state.polygonOffsetUnits);
+    }
+
+    // Blending
+    SetCapability(CapBlend, GL_BLEND, state.blend);
+    if (state.blend) {
+        BlendFunc func{state.blendSrcColor, state.blendDstColor, state.blendSrcAlpha, state.blendDstAlpha};
+        if (Update(m_blendFunc, func)) {
+            glBlendFuncSeparate(func.srcColor, func.dstColor, func.srcAlpha, func.dstAlpha);
+        }
+        BlendEquation equation{state.blendEquationColor, state.blendEquationAlpha};
+        if (Update(m_blendEquation, equation)) {
+            glBlendEquationSeparate(equation.color, equation.alpha);
+        }
+    }
+    SetColorMask(state.colorWriteMask);
+
+    // Stencil
+    SetCapability(CapStencilTest, GL_STENCIL_TEST, state.stencilTest);
+    if (state.stencilTest) {
+        ApplyStencilFace(GL_FRONT, m_stencilFront, state.stencilFront);
+        ApplyStencilFace(GL_BACK, m_stencilBack, state.stencilBack);
+    }
+}
+
+void OpenGL33StateCache::ApplyStencilFace(GLenum face, StencilFace& state, const GLStencilFaceState& desired) {
+    state.desired = StencilFunc{desired.func, desired.reference, desired.compareMask};
+    ApplyStencilFunc(face, state);
+
+    StencilOps ops{desired.failOp, desired.depthFailOp, desired.passOp};
+    if (Update(state.ops, ops)) {
+        glStencilOpSeparate(face, ops.fail, ops.depthFail, ops.pass);
+    }
+    SetStencilWriteMask(face, desired.writeMask);
+}
+
+void OpenGL33StateCache::ApplyStencilFunc(GLenum face, StencilFace& state) {
+    if (Update(state.func, state.desired)) {
+        glStencilFuncSeparate(face, state.desired.func, state.desired.reference, state.desired.mask);
+    }
+}
+
+void OpenGL33StateCache::SetViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    if (Update(m_viewport, Rect{x, y, width, height})) {
+        glViewport(x, y, width, height);
+    }
+}
+
+void OpenGL33StateCache::SetDepthRange(GLdouble nearVal, GLdouble farVal) {
+    if (Update(m_depthRange, DepthRange{nearVal, farVal})) {
+        glDepthRange(nearVal, farVal);
+    }
+}
+
+void OpenGL33StateCache::SetScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+    if (Update(m_scissor, Rect{x, y, width, height})) {
+        glScissor(x, y, width, height);
+    }
+}
+
+void OpenGL33StateCache::SetScissorTest(bool enabled) {
+    SetCapability(CapScissorTest, GL_SCISSOR_TEST, enabled);
+}
+
+void OpenGL33StateCache::SetLineWidth(GLfloat width) {
+    if (Update(m_lineWidth, width)) {
+        glLineWidth(width);
+    }
+}
+
+void OpenGL33StateCache::SetBlendColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+    if (Update(m_blendColor, Color{r, g, b, a})) {
+        glBlendColor(r, g, b, a);
+    }
+}
+
+void OpenGL33StateCache::SetPolygonOffset(GLfloat factor, GLfloat units) {
+    if (Update(m_polygonOffset, PolygonOffset{factor, units})) {
+        glPolygonOffset(factor, units);
+    }
+}
+
+void OpenGL33StateCache::SetDepthMask(bool enabled) {
+    if (Update(m_depthMask, enabled)) {
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    }
+}
+
+void OpenGL33StateCache::SetColorMask(uint8_t mask) {
+    if (Update(m_colorMask, mask)) {
+        glColorMask((mask & 0x1) ? GL_TRUE : GL_FALSE, (mask & 0x2) ? GL_TRUE : GL_FALSE,
+                    (mask & 0x4) ? GL_TRUE : GL_FALSE, (mask & 0x8) ? GL_TRUE : GL_FALSE);
+    }
+}
+
+void OpenGL33StateCache::SetStencilReference(GLenum face, GLint reference) {
+    StencilFace& state = GetStencilFace(face);
+    state.desired.reference = reference;
+    ApplyStencilFunc(face, state);
+}
+
+void OpenGL33StateCache::SetStencilCompareMask(GLenum face, GLuint mask) {
+    StencilFace& state = GetStencilFace(face);
+    state.desired.mask = mask;
+    ApplyStencilFunc(face, state);
+}
+
+void OpenGL33StateCache::SetStencilWriteMask(GLenum face, GLuint mask) {
+    if (Update(GetStencilFace(face).writeMask, mask)) {
+        glStencilMaskSeparate(face, mask);
+    }
+}
+
+// ============================================================================
+// Clear Values
+// ============================================================================
+
+void OpenGL33StateCache::SetClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+    if (Update(m_clearColor, Color{r, g, b, a})) {
+        glClearColor(r, g, b, a);
+    }
+}
+
+void OpenGL33StateCache::SetClearDepth(GLdouble depth) {
+    if (Update(m_clearDepth, depth)) {
+        glClearDepth(depth);
+    }
+}
+
+void OpenGL33StateCache::SetClearStencil(GLint stencil) {
+    if (Update(m_clearStencil, stencil)) {
+        glClearStencil(stencil);
+    }
+}
+
+// ============================================================================
+// Deletion Hooks
+// ============================================================================
+
+void OpenGL33StateCache::OnBufferDeleted(GLuint buffer) {
+    for (auto& binding : m_buffers) {
+        if (binding.value == buffer) {
+            binding.valid = false;
+        }
+    }
+    for (auto& range : m_uniformRanges) {
+        if (range.value.buffer == buffer) {
+            range.valid = false;
+        }
+    }
+}
+
+void OpenGL33StateCache::OnTextureDeleted(GLuint texture) {
+    for (auto& unit : m_textures) {
+        for (auto& binding : unit) {
+            if (binding.value == texture) {
+                binding.valid = false;
+            }
+        }
+    }
+}
+
+void OpenGL33StateCache::OnSamplerDeleted(GLuint sampler) {
+    for (auto& binding : m_samplers) {
+        if (binding.value == sampler) {
+            binding.valid = false;
+        }
+    }
+}
+
+void OpenGL33StateCache::OnProgramDeleted(GLuint program) {
+    if (m_program.value == program) {
+        m_program.valid = false;
+    }
+}
+
+void OpenGL33StateCache::OnVertexArrayDeleted(GLuint vao) {
+    if (m_vertexArray.value == vao) {
+        m_vertexArray.valid = false;
+        m_buffers[SlotElementArray].valid = false;
+    }
+}
+
+void OpenGL33StateCache::OnFramebufferDeleted(GLuint framebuffer) {
+    if (m_framebuffer.value == framebuffer) {
+        m_framebuffer.valid = false;
+    }
+}
+
+} // namespace VRHI
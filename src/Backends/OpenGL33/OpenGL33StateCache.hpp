@@ -0,0 +1,288 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <glad/glad.h>
+#include <array>
+#include <cstdint>
+
+namespace VRHI {
+
+// ============================================================================
+// Baked Pipeline State
+// ============================================================================
+
+/// Stencil state of one face, already translated to GL enums
+struct GLStencilFaceState {
+    GLenum func = GL_ALWAYS;
+    GLint reference = 0;
+    GLuint compareMask = 0xFF;
+    GLuint writeMask = 0xFF;
+    GLenum failOp = GL_KEEP;
+    GLenum depthFailOp = GL_KEEP;
+    GLenum passOp = GL_KEEP;
+};
+
+/// Fixed-function state of a graphics pipeline, translated to GL enums once
+/// at pipeline creation so binding a pipeline is a series of compares.
+struct GLPipelineState {
+    GLenum primitiveMode = GL_TRIANGLES;
+
+    // Depth
+    bool depthTest = true;
+    bool depthWrite = true;
+    GLenum depthFunc = GL_LESS;
+
+    // Rasterization
+    bool cullFace = true;
+    GLenum cullMode = GL_BACK;
+    GLenum frontFace = GL_CCW;
+    bool polygonOffset = false;
+    GLfloat polygonOffsetFactor = 0.0f;
+    GLfloat polygonOffsetUnits = 0.0f;
+
+    // Blending (attachment 0; GL 3.3 has no per-attachment blend functions)
+    bool blend = false;
+    GLenum blendSrcColor = GL_ONE;
+    GLenum blendDstColor = GL_ZERO;
+    GLenum blendSrcAlpha = GL_ONE;
+    GLenum blendDstAlpha = GL_ZERO;
+    GLenum blendEquationColor = GL_FUNC_ADD;
+    GLenum blendEquationAlpha = GL_FUNC_ADD;
+    uint8_t colorWriteMask = 0xF;  // RGBA bits
+
+    // Stencil
+    bool stencilTest = false;
+    GLStencilFaceState stencilFront{};
+    GLStencilFaceState stencilBack{};
+};
+
+// ============================================================================
+// State Cache
+// ============================================================================
+
+/// Shadow copy of the GL context state owned by the device.
+///
+/// Every setter compares against the last value it sent to the driver and
+/// skips the call when nothing changed. Entries start out unknown, so the
+/// first call for each piece of state is always issued. All GL state changes
+/// made by the backend must go through the cache, otherwise it goes stale;
+/// resources report their deletion so that recycled GL names are not
+/// mistaken for bindings that are still current.
+class OpenGL33StateCache {
+public:
+    static constexpr uint32_t MaxTextureUnits = 32;
+    static constexpr uint32_t MaxUniformBufferBindings = 36;
+
+    /// Counters since the last ResetCounters()
+    struct Counters {
+        uint64_t emitted = 0;   ///< State calls sent to GL
+        uint64_t filtered = 0;  ///< Redundant state calls skipped
+    };
+
+    /// Forget all cached state (e.g. after foreign code touched the context)
+    void Invalidate();
+
+    // Objects
+    void UseProgram(GLuint program);
+    void BindVertexArray(GLuint vao);
+    void BindFramebuffer(GLuint framebuffer);  // Draw and read
+    void BindBuffer(GLenum target, GLuint buffer);
+    void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+    void BindTexture(GLuint unit, GLenum target, GLuint texture);
+    void BindSampler(GLuint unit, GLuint sampler);
+
+    /// Bind a texture on whichever unit is active, for uploads and queries
+    void BindTextureForUpdate(GLenum target, GLuint texture);
+
+    // Fixed-function state
+    void ApplyPipelineState(const GLPipelineState& state);
+    void SetViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+    void SetDepthRange(GLdouble nearVal, GLdouble farVal);
+    void SetScissor(GLint x, GLint y, GLsizei width, GLsizei height);
+    void SetScissorTest(bool enabled);
+    void SetLineWidth(GLfloat width);
+    void SetBlendColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+    void SetPolygonOffset(GLfloat factor, GLfloat units);
+    void SetDepthMask(bool enabled);
+    void SetColorMask(uint8_t mask);
+    void SetStencilReference(GLenum face, GLint reference);
+    void SetStencilCompareMask(GLenum face, GLuint mask);
+    void SetStencilWriteMask(GLenum face, GLuint mask);
+
+    // Clear values
+    void SetClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+    void SetClearDepth(GLdouble depth);
+    void SetClearStencil(GLint stencil);
+
+    // Deletion hooks: drop any binding of the deleted object
+    void OnBufferDeleted(GLuint buffer);
+    void OnTextureDeleted(GLuint texture);
+    void OnSamplerDeleted(GLuint sampler);
+    void OnProgramDeleted(GLuint program);
+    void OnVertexArrayDeleted(GLuint vao);
+    void OnFramebufferDeleted(GLuint framebuffer);
+
+    const Counters& GetCounters() const noexcept { return m_counters; }
+    void ResetCounters() noexcept { m_counters = {}; }
+
+private:
+    /// A cached value that is either unknown or mirrors the GL context
+    template<typename T>
+    struct Cached {
+        T value{};
+        bool valid = false;
+    };
+
+    /// Record `value`; returns true if the GL call has to be issued
+    template<typename T>
+    bool Update(Cached<T>& cached, const T& value) {
+        if (cached.valid && cached.value == value) {
+            ++m_counters.filtered;
+            return false;
+        }
+        cached.value = value;
+        cached.valid = true;
+        ++m_counters.emitted;
+        return true;
+    }
+
+    enum Capability : uint32_t {
+        CapDepthTest,
+        CapCullFace,
+        CapBlend,
+        CapStencilTest,
+        CapPolygonOffsetFill,
+        CapScissorTest,
+        CapCount
+    };
+
+    enum BufferSlot : uint32_t {
+        SlotArray,
+        SlotElementArray,
+        SlotUniform,
+        SlotCopyRead,
+        SlotCopyWrite,
+        SlotPixelPack,
+        SlotPixelUnpack,
+        SlotDrawIndirect,      // GL 4.0
+        SlotDispatchIndirect,  // GL 4.3
+        BufferSlotCount
+    };
+
+    enum TextureSlot : uint32_t {
+        Slot1D,
+        Slot2D,
+        Slot3D,
+        SlotCube,
+        Slot1DArray,
+        Slot2DArray,
+        SlotCubeArray,  // GL 4.0
+        TextureSlotCount
+    };
+
+    struct Rect {
+        GLint x, y;
+        GLsizei width, height;
+        bool operator==(const Rect&) const = default;
+    };
+
+    struct DepthRange {
+        GLdouble nearVal, farVal;
+        bool operator==(const DepthRange&) const = default;
+    };
+
+    struct Color {
+        GLfloat r, g, b, a;
+        bool operator==(const Color&) const = default;
+    };
+
+    struct BufferRange {
+        GLuint buffer;
+        GLintptr offset;
+        GLsizeiptr size;
+        bool operator==(const BufferRange&) const = default;
+    };
+
+    struct BlendFunc {
+        GLenum srcColor, dstColor, srcAlpha, dstAlpha;
+        bool operator==(const BlendFunc&) const = default;
+    };
+
+    struct BlendEquation {
+        GLenum color, alpha;
+        bool operator==(const BlendEquation&) const = default;
+    };
+
+    struct PolygonOffset {
+        GLfloat factor, units;
+        bool operator==(const PolygonOffset&) const = default;
+    };
+
+    struct StencilFunc {
+        GLenum func;
+        GLint reference;
+        GLuint mask;
+        bool operator==(const StencilFunc&) const = default;
+    };
+
+    struct StencilOps {
+        GLenum fail, depthFail, pass;
+        bool operator==(const StencilOps&) const = default;
+    };
+
+    /// Per-face stencil state; the func is tracked even while unknown to GL so
+    /// dynamic reference/mask updates can be combined with it
+    struct StencilFace {
+        Cached<StencilFunc> func;
+        Cached<StencilOps> ops;
+        Cached<GLuint> writeMask;
+        StencilFunc desired{GL_ALWAYS, 0, 0xFF};
+    };
+
+    static int GetBufferSlot(GLenum target) noexcept;
+    static int GetTextureSlot(GLenum target) noexcept;
+
+    void SetCapability(Capability cap, GLenum glCap, bool enabled);
+    void SetActiveTexture(GLuint unit);
+    void ApplyStencilFace(GLenum face, StencilFace& state, const GLStencilFaceState& desired);
+    void ApplyStencilFunc(GLenum face, StencilFace& state);
+    StencilFace& GetStencilFace(GLenum face) noexcept { return face == GL_BACK ? m_stencilBack : m_stencilFront; }
+
+    Counters m_counters;
+
+    Cached<GLuint> m_program;
+    Cached<GLuint> m_vertexArray;
+    Cached<GLuint> m_framebuffer;
+    std::array<Cached<GLuint>, BufferSlotCount> m_buffers;
+    std::array<Cached<BufferRange>, MaxUniformBufferBindings> m_uniformRanges;
+
+    Cached<GLuint> m_activeTexture;
+    std::array<std::array<Cached<GLuint>, TextureSlotCount>, MaxTextureUnits> m_textures;
+    std::array<Cached<GLuint>, MaxTextureUnits> m_samplers;
+
+    std::array<Cached<bool>, CapCount> m_capabilities;
+    Cached<bool> m_depthMask;
+    Cached<GLenum> m_depthFunc;
+    Cached<GLenum> m_cullFace;
+    Cached<GLenum> m_frontFace;
+    Cached<PolygonOffset> m_polygonOffset;
+    Cached<BlendFunc> m_blendFunc;
+    Cached<BlendEquation> m_blendEquation;
+    Cached<Color> m_blendColor;
+    Cached<uint8_t> m_colorMask;
+    StencilFace m_stencilFront;
+    StencilFace m_stencilBack;
+
+    Cached<Rect> m_viewport;
+    Cached<DepthRange> m_depthRange;
+    Cached<Rect> m_scissor;
+    Cached<GLfloat> m_lineWidth;
+
+    Cached<Color> m_clearColor;
+    Cached<GLdouble> m_clearDepth;
+    Cached<GLint> m_clearStencil;
+};
+
+} // namespace VRHI
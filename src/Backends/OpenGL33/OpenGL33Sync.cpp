@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: MIT
 
 #include "OpenGL33Sync.hpp"
+#include <VRHI/Logging.hpp>
 
 namespace VRHI {
 
@@ -10,18 +11,66 @@ OpenGL33Fence::OpenGL33Fence(bool signaled)
 {
 }
 
+OpenGL33Fence::~OpenGL33Fence() {
+    DeleteSync();
+}
+
 bool OpenGL33Fence::Wait(uint64_t timeout) {
-    // In OpenGL, fences are implemented via glFenceSync/glClientWaitSync
-    // For now, we use a simple boolean flag
-    return m_signaled;
+    if (m_signaled) {
+        return true;
+    }
+    // Nothing was submitted with this fence, so nothing can signal it
+    if (!m_sync) {
+        return false;
+    }
+    return ClientWait(timeout);
 }
 
 void OpenGL33Fence::Reset() {
+    DeleteSync();
     m_signaled = false;
 }
 
 bool OpenGL33Fence::IsSignaled() const noexcept {
-    return m_signaled;
+    if (m_signaled) {
+        return true;
+    }
+    return m_sync && ClientWait(0);
+}
+
+void OpenGL33Fence::Signal() {
+    // A resubmitted fence tracks the latest submission only
+    DeleteSync();
+    m_sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_signaled = false;
+    m_flushed = false;
+}
+
+bool OpenGL33Fence::ClientWait(uint64_t timeout) const {
+    // Without a flush the sync object may sit in the command queue forever
+    const GLbitfield flags = m_flushed ? 0 : GL_SYNC_FLUSH_COMMANDS_BIT;
+    m_flushed = true;
+    
+    // UINT64_MAX is GL_TIMEOUT_IGNORED
+    const GLenum result = glClientWaitSync(m_sync, flags, static_cast<GLuint64>(timeout));
+    if (result == GL_WAIT_FAILED) {
+        LogError("glClientWaitSync failed");
+        return false;
+    }
+    if (result == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+    
+    m_signaled = true;
+    DeleteSync();
+    return true;
+}
+
+void OpenGL33Fence::DeleteSync() const {
+    if (m_sync) {
+        glDeleteSync(m_sync);
+        m_sync = nullptr;
+    }
 }
 
 } // namespace VRHI
@@ -4,20 +4,41 @@
 #pragma once
 
 #include <VRHI/Sync.hpp>
+#include <glad/glad.h>
 
 namespace VRHI {
 
+/// Fence backed by a GL sync object.
+///
+/// Each submission that signals the fence inserts a glFenceSync after its
+/// commands; Wait() blocks in glClientWaitSync and IsSignaled() polls it
+/// with a zero timeout. The first wait or poll flushes the context so that
+/// the sync object is guaranteed to be reached. Like every GL object, the
+/// fence must only be used on the thread that owns the context.
 class OpenGL33Fence : public Fence {
 public:
     OpenGL33Fence(bool signaled);
-    ~OpenGL33Fence() override = default;
+    ~OpenGL33Fence() override;
     
     bool Wait(uint64_t timeout = UINT64_MAX) override;
     void Reset() override;
     bool IsSignaled() const noexcept override;
     
+    void* GetNativeHandle() const noexcept override { return m_sync; }
+    
+    /// Called by the device after the commands of a submission have been
+    /// issued; the fence signals once the GPU has executed them
+    void Signal();
+    
 private:
-    bool m_signaled;
+    /// Wait up to `timeout` nanoseconds for the sync object
+    bool ClientWait(uint64_t timeout) const;
+    
+    void DeleteSync() const;
+    
+    mutable GLsync m_sync = nullptr;
+    mutable bool m_signaled;
+    mutable bool m_flushed = false;
 };
 
 class OpenGL33Semaphore : public Semaphore {
@@ -2,27 +2,206 @@
 // SPDX-License-Identifier: MIT
 
 #include "OpenGL33Texture.hpp"
+#include "OpenGL33Device.hpp"
 #include "GLFormatUtils.hpp"
 #include <VRHI/Logging.hpp>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
 
 namespace VRHI {
 
-OpenGL33Texture::OpenGL33Texture(const TextureDesc& desc, GLuint texture)
-    : m_desc(desc)
+namespace {
+    /// Layers of the GL texture; cube faces count as layers
+    uint32_t CountLayers(const TextureDesc& desc) {
+        const uint32_t layers = std::max(desc.arrayLayers, 1u);
+        switch (desc.type) {
+            case TextureType::Texture1D:
+            case TextureType::Texture2D:
+            case TextureType::Texture3D:
+                return 1;
+            case TextureType::TextureCube:
+                return 6;
+            case TextureType::TextureCubeArray:
+                return 6 * layers;
+            default:
+                return layers;
+        }
+    }
+    
+    struct MipExtent {
+        uint32_t width;
+        uint32_t height;
+        uint32_t depth;
+    };
+    
+    /// Size of one layer of a mip level
+    MipExtent GetMipExtent(const TextureDesc& desc, uint32_t mipLevel) {
+        const bool is1D = desc.type == TextureType::Texture1D || desc.type == TextureType::Texture1DArray;
+        return {
+            std::max(desc.width >> mipLevel, 1u),
+            is1D ? 1u : std::max(desc.height >> mipLevel, 1u),
+            desc.type == TextureType::Texture3D ? std::max(desc.depth >> mipLevel, 1u) : 1u,
+        };
+    }
+    
+    /// Levels down to 1x1x1
+    uint32_t CountFullMipChain(const TextureDesc& desc) {
+        const MipExtent extent = GetMipExtent(desc, 0);
+        uint32_t size = std::max({extent.width, extent.height, extent.depth});
+        uint32_t levels = 1;
+        while (size > 1) {
+            size >>= 1;
+            ++levels;
+        }
+        return levels;
+    }
+    
+    /// Allocate every level and layer at once with immutable storage (GL 4.2 / ARB_texture_storage)
+    void AllocateImmutable(GLenum target, const TextureDesc& desc, GLenum internalFormat) {
+        const auto levels = static_cast<GLsizei>(desc.mipLevels);
+        const auto width = static_cast<GLsizei>(desc.width);
+        const auto height = static_cast<GLsizei>(desc.height);
+        const auto layers = static_cast<GLsizei>(CountLayers(desc));
+        switch (target) {
+            case GL_TEXTURE_1D:
+                glTexStorage1D(target, levels, internalFormat, width);
+                break;
+            case GL_TEXTURE_1D_ARRAY:
+                glTexStorage2D(target, levels, internalFormat, width, layers);
+                break;
+            case GL_TEXTURE_3D:
+                glTexStorage3D(target, levels, internalFormat, width, height, static_cast<GLsizei>(desc.depth));
+                break;
+            case GL_TEXTURE_2D_ARRAY:
+            case GL_TEXTURE_CUBE_MAP_ARRAY:
+                glTexStorage3D(target, levels, internalFormat, width, height, layers);
+                break;
+            default:
+                glTexStorage2D(target, levels, internalFormat, width, height);
+                break;
+        }
+    }
+    
+    /// AllocateImmutable() by texture name (GL 4.5 direct state access)
+    void AllocateImmutableByName(GLuint texture, GLenum target, const TextureDesc& desc, GLenum internalFormat) {
+        const auto levels = static_cast<GLsizei>(desc.mipLevels);
+        const auto width = static_cast<GLsizei>(desc.width);
+        const auto height = static_cast<GLsizei>(desc.height);
+        const auto layers = static_cast<GLsizei>(CountLayers(desc));
+        switch (target) {
+            case GL_TEXTURE_1D:
+                glTextureStorage1D(texture, levels, internalFormat, width);
+                break;
+            case GL_TEXTURE_1D_ARRAY:
+                glTextureStorage2D(texture, levels, internalFormat, width, layers);
+                break;
+            case GL_TEXTURE_3D:
+                glTextureStorage3D(texture, levels, internalFormat, width, height, static_cast<GLsizei>(desc.depth));
+                break;
+            case GL_TEXTURE_2D_ARRAY:
+            case GL_TEXTURE_CUBE_MAP_ARRAY:
+                glTextureStorage3D(texture, levels, internalFormat, width, height, layers);
+                break;
+            default:
+                glTextureStorage2D(texture, levels, internalFormat, width, height);
+                break;
+        }
+    }
+    
+    /// Allocate every level and layer with glTexImage*, one level (and cube face) at a time
+    void AllocateMutable(GLenum target, const TextureDesc& desc, GLenum internalFormat) {
+        GLenum format, type;
+        GLFormatUtils::GetFormatAndType(desc.format, format, type);
+        const auto layers = static_cast<GLsizei>(CountLayers(desc));
+        for (uint32_t mip = 0; mip < desc.mipLevels; ++mip) {
+            const MipExtent extent = GetMipExtent(desc, mip);
+            const auto level = static_cast<GLint>(mip);
+            const auto width = static_cast<GLsizei>(extent.width);
+            const auto height = static_cast<GLsizei>(extent.height);
+            switch (target) {
+                case GL_TEXTURE_1D:
+                    glTexImage1D(target, level, internalFormat, width, 0, format, type, nullptr);
+                    break;
+                case GL_TEXTURE_1D_ARRAY:
+                    glTexImage2D(target, level, internalFormat, width, layers, 0, format, type, nullptr);
+                    break;
+                case GL_TEXTURE_CUBE_MAP:
+                    for (GLenum face = 0; face < 6; ++face) {
+                        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, level, internalFormat,
+                                     width, height, 0, format, type, nullptr);
+                    }
+                    break;
+                case GL_TEXTURE_3D:
+                    glTexImage3D(target, level, internalFormat, width, height, static_cast<GLsizei>(extent.depth),
+                                 0, format, type, nullptr);
+                    break;
+                case GL_TEXTURE_2D_ARRAY:
+                case GL_TEXTURE_CUBE_MAP_ARRAY:
+                    glTexImage3D(target, level, internalFormat, width, height, layers, 0, format, type, nullptr);
+                    break;
+                default:
+                    glTexImage2D(target, level, internalFormat, width, height, 0, format, type, nullptr);
+                    break;
+            }
+        }
+    }
+}
+
+OpenGL33Texture::OpenGL33Texture(OpenGL33Device& device, const TextureDesc& desc, GLuint texture)
+    : m_device(&device)
+    , m_desc(desc)
     , m_texture(texture)
 {
 }
 
 OpenGL33Texture::~OpenGL33Texture() {
-    if (m_texture != 0) {
-        glDeleteTextures(1, &m_texture);
-    }
+    m_device->GetDeletionQueue().Retire(OpenGL33DeletionQueue::ObjectType::Texture, m_texture);
 }
 
 std::expected<std::unique_ptr<Texture>, Error>
-OpenGL33Texture::Create(const TextureDesc& desc) {
+OpenGL33Texture::Create(OpenGL33Device& device, const TextureDesc& desc) {
+    const bool isCube = desc.type == TextureType::TextureCube || desc.type == TextureType::TextureCubeArray;
+    if (desc.width == 0 || desc.height == 0 || desc.depth == 0) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Texture dimensions must be greater than 0"
+        });
+    }
+    if (desc.mipLevels == 0 || desc.mipLevels > CountFullMipChain(desc)) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Texture mip level count must be between 1 and the full mip chain"
+        });
+    }
+    if (isCube && desc.width != desc.height) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Cube map faces must be square"
+        });
+    }
+    if (desc.type == TextureType::TextureCubeArray && !GLAD_GL_VERSION_4_0 && !GLAD_GL_ARB_texture_cube_map_array) {
+        return std::unexpected(Error{
+            Error::Code::UnsupportedFeature,
+            "Cube map arrays need OpenGL 4.0 or GL_ARB_texture_cube_map_array"
+        });
+    }
+    
+    GLenum target = GLFormatUtils::GetTextureTarget(desc.type);
+    GLenum internalFormat = GLFormatUtils::GetInternalFormat(desc.format);
+    const bool directStateAccess = device.GetProfile().directStateAccess;
+    
+    // Errors left by earlier calls must not be taken for this allocation's
+    while (glGetError() != GL_NO_ERROR) {
+    }
+    
     GLuint texture = 0;
-    glGenTextures(1, &texture);
+    if (directStateAccess) {
+        glCreateTextures(target, 1, &texture);
+    } else {
+        glGenTextures(1, &texture);
+    }
     
     if (texture == 0) {
         return std::unexpected(Error{
@@ -31,53 +210,69 @@ OpenGL33Texture::Create(const TextureDesc& desc) {
         });
     }
     
-    GLenum target = GLFormatUtils::GetTextureTarget(desc.type);
-    GLenum internalFormat = GLFormatUtils::GetInternalFormat(desc.format);
-    
-    glBindTexture(target, texture);
-    
-    // Get the appropriate format and type for this texture format
-    GLenum format, type;
-    GLFormatUtils::GetFormatAndType(desc.format, format, type);
+    // Every level and layer exists up front, so uploads never reallocate
+    // and the driver needs no mip chain completeness checks at draw time
+    if (directStateAccess) {
+        AllocateImmutableByName(texture, target, desc, internalFormat);
+    } else {
+        device.GetStateCache().BindTextureForUpdate(target, texture);
+        if (GLAD_GL_VERSION_4_2 || GLAD_GL_ARB_texture_storage) {
+            AllocateImmutable(target, desc, internalFormat);
+        } else {
+            AllocateMutable(target, desc, internalFormat);
+        }
+    }
     
-    // Allocate storage based on texture type
-    switch (desc.type) {
-        case TextureType::Texture2D:
-            glTexImage2D(target, 0, internalFormat, desc.width, desc.height,
-                        0, format, type, desc.initialData);
-            break;
-        case TextureType::Texture3D:
-            glTexImage3D(target, 0, internalFormat, desc.width, desc.height, desc.depth,
-                        0, format, type, desc.initialData);
-            break;
-        default:
-            // Simplified for other types
-            glTexImage2D(target, 0, internalFormat, desc.width, desc.height,
-                        0, format, type, desc.initialData);
-            break;
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR) {
+        device.GetStateCache().OnTextureDeleted(texture);
+        glDeleteTextures(1, &texture);
+        return std::unexpected(Error{
+            Error::Code::InitializationFailed,
+            "Failed to allocate texture storage (GL error " + std::to_string(error) + ")"
+        });
     }
     
+    auto setParameter = [&](GLenum name, GLint value) {
+        if (directStateAccess) {
+            glTextureParameteri(texture, name, value);
+        } else {
+            glTexParameteri(target, name, value);
+        }
+    };
+    
     // Set default texture parameters
     // For textures with only 1 mip level, don't use mipmap filtering
     if (desc.mipLevels > 1) {
-        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        setParameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     } else {
-        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        setParameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     }
-    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    setParameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    setParameter(GL_TEXTURE_WRAP_S, GL_REPEAT);
+    setParameter(GL_TEXTURE_WRAP_T, GL_REPEAT);
     
     // Set mipmap levels - important for textures without full mipmap chains
-    glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
-    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, desc.mipLevels - 1);
-    
-    glBindTexture(target, 0);
+    setParameter(GL_TEXTURE_BASE_LEVEL, 0);
+    setParameter(GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(desc.mipLevels - 1));
     
-    auto textureObj = std::unique_ptr<Texture>(
-        new OpenGL33Texture(desc, texture)
+    auto textureObj = std::unique_ptr<OpenGL33Texture>(
+        new OpenGL33Texture(device, desc, texture)
     );
     
+    // Initial data holds mip 0 of every layer, one after another
+    if (desc.initialData) {
+        const MipExtent extent = GetMipExtent(desc, 0);
+        const uint64_t layerSize = GLFormatUtils::GetImageSize(desc.format, extent.width, extent.height, extent.depth);
+        std::vector<TextureSubresourceData> layers(CountLayers(desc));
+        for (uint32_t layer = 0; layer < layers.size(); ++layer) {
+            layers[layer].arrayLayer = layer;
+            layers[layer].offset = static_cast<size_t>(layerSize * layer);
+            layers[layer].size = static_cast<size_t>(layerSize);
+        }
+        textureObj->UpdateSubresources(desc.initialData, layers);
+    }
+    
     return textureObj;
 }
 
@@ -110,52 +305,221 @@ uint32_t OpenGL33Texture::GetArrayLayers() const noexcept {
 }
 
 void OpenGL33Texture::Update(const void* data, size_t size, uint32_t mipLevel, uint32_t arrayLayer) {
-    GLenum target = GLFormatUtils::GetTextureTarget(m_desc.type);
-    glBindTexture(target, m_texture);
-    
-    // Get the appropriate format and type for this texture format
-    GLenum format, type;
-    GLFormatUtils::GetFormatAndType(m_desc.format, format, type);
-    
-    glTexSubImage2D(target, mipLevel, 0, 0, m_desc.width, m_desc.height,
-                   format, type, data);
-    
-    glBindTexture(target, 0);
+    const MipExtent extent = GetMipExtent(m_desc, mipLevel);
+    const uint64_t imageSize = GLFormatUtils::GetImageSize(m_desc.format, extent.width, extent.height, extent.depth);
+    if (size < imageSize) {
+        LogWarning("Texture update of %zu bytes is smaller than mip %u (%llu bytes); skipped",
+                   size, mipLevel, static_cast<unsigned long long>(imageSize));
+        return;
+    }
+    Upload(data, 0, 0, 0, extent.width, extent.height, extent.depth, mipLevel, arrayLayer, false);
 }
 
 void OpenGL33Texture::UpdateRegion(const void* data, uint32_t x, uint32_t y, uint32_t z,
                                    uint32_t width, uint32_t height, uint32_t depth,
                                    uint32_t mipLevel, uint32_t arrayLayer) {
-    GLenum target = GLFormatUtils::GetTextureTarget(m_desc.type);
-    glBindTexture(target, m_texture);
+    Upload(data, x, y, z, width, height, depth, mipLevel, arrayLayer, false);
+}
+
+void OpenGL33Texture::UpdateRegionAsync(const void* data, uint32_t x, uint32_t y, uint32_t z,
+                                        uint32_t width, uint32_t height, uint32_t depth,
+                                        uint32_t mipLevel, uint32_t arrayLayer) {
+    Upload(data, x, y, z, width, height, depth, mipLevel, arrayLayer, true);
+}
+
+void OpenGL33Texture::UpdateSubresources(const void* data, std::span<const TextureSubresourceData> subresources) {
+    const uint32_t layers = CountLayers(m_desc);
+    std::vector<GLTextureUpload> uploads;
+    uploads.reserve(subresources.size());
+    uint64_t begin = ~0ull;
+    uint64_t end = 0;
+    for (const TextureSubresourceData& subresource : subresources) {
+        if (subresource.mipLevel >= m_desc.mipLevels || subresource.arrayLayer >= layers) {
+            LogWarning("Texture subresource (mip %u, layer %u) out of range; skipped",
+                       subresource.mipLevel, subresource.arrayLayer);
+            continue;
+        }
+        const MipExtent extent = GetMipExtent(m_desc, subresource.mipLevel);
+        const uint64_t imageSize = GLFormatUtils::GetImageSize(m_desc.format, extent.width, extent.height, extent.depth);
+        if (subresource.size < imageSize) {
+            LogWarning("Texture subresource (mip %u, layer %u) has %zu bytes of %llu; skipped",
+                       subresource.mipLevel, subresource.arrayLayer, subresource.size,
+                       static_cast<unsigned long long>(imageSize));
+            continue;
+        }
+        GLTextureUpload upload = DescribeUpload(0, 0, 0, extent.width, extent.height, extent.depth,
+                                                subresource.mipLevel, subresource.arrayLayer);
+        upload.dataOffset = subresource.offset;
+        begin = std::min<uint64_t>(begin, subresource.offset);
+        end = std::max<uint64_t>(end, subresource.offset + imageSize);
+        uploads.push_back(upload);
+    }
+    if (uploads.empty()) {
+        return;
+    }
     
-    // Get the appropriate format and type for this texture format
-    GLenum format, type;
-    GLFormatUtils::GetFormatAndType(m_desc.format, format, type);
+    // One staging copy of the bytes the entries cover, then a GPU-side copy per subresource
+    for (GLTextureUpload& upload : uploads) {
+        upload.dataOffset -= begin;
+    }
+    if (auto* queue = m_device->GetUploadQueue()) {
+        queue->UpdateTextures(uploads, static_cast<const std::byte*>(data) + begin, end - begin, false);
+    }
+}
+
+GLTextureUpload OpenGL33Texture::DescribeUpload(uint32_t x, uint32_t y, uint32_t z,
+                                                uint32_t width, uint32_t height, uint32_t depth,
+                                                uint32_t mipLevel, uint32_t arrayLayer) const {
+    GLTextureUpload upload;
+    upload.bindTarget = GLFormatUtils::GetTextureTarget(m_desc.type);
+    upload.imageTarget = upload.bindTarget;
+    upload.texture = m_texture;
+    upload.level = static_cast<GLint>(mipLevel);
+    upload.x = static_cast<GLint>(x);
+    upload.y = static_cast<GLint>(y);
+    upload.z = static_cast<GLint>(z);
+    upload.width = static_cast<GLsizei>(width);
+    upload.height = static_cast<GLsizei>(height);
+    upload.depth = static_cast<GLsizei>(depth);
+    GLFormatUtils::GetFormatAndType(m_desc.format, upload.format, upload.type);
     
-    glTexSubImage2D(target, mipLevel, x, y, width, height,
-                   format, type, data);
+    // Layers are a face, a row or a slice depending on the target
+    switch (upload.bindTarget) {
+        case GL_TEXTURE_CUBE_MAP:
+            upload.imageTarget = GL_TEXTURE_CUBE_MAP_POSITIVE_X + arrayLayer % 6;
+            break;
+        case GL_TEXTURE_1D_ARRAY:
+            upload.y = static_cast<GLint>(arrayLayer);
+            break;
+        case GL_TEXTURE_2D_ARRAY:
+        case GL_TEXTURE_CUBE_MAP_ARRAY:
+            upload.z = static_cast<GLint>(arrayLayer);
+            break;
+        default:
+            break;
+    }
     
-    glBindTexture(target, 0);
+    // Compressed data names its internal format and byte count instead
+    if (GLFormatUtils::IsCompressedFormat(m_desc.format)) {
+        upload.format = GLFormatUtils::GetInternalFormat(m_desc.format);
+        upload.compressedSize = static_cast<GLsizei>(GLFormatUtils::GetImageSize(m_desc.format, width, height, depth));
+    }
+    return upload;
+}
+
+void OpenGL33Texture::Upload(const void* data, uint32_t x, uint32_t y, uint32_t z,
+                             uint32_t width, uint32_t height, uint32_t depth,
+                             uint32_t mipLevel, uint32_t arrayLayer, bool async) {
+    // Data is read tightly packed, whatever size the caller passed
+    const uint64_t size = GLFormatUtils::GetImageSize(m_desc.format, width, height, depth);
+    if (auto* uploads = m_device->GetUploadQueue()) {
+        uploads->UpdateTexture(DescribeUpload(x, y, z, width, height, depth, mipLevel, arrayLayer), data, size, async);
+    }
 }
 
 void OpenGL33Texture::GenerateMipmaps(CommandBuffer* cmd) {
+    if (m_device->GetProfile().directStateAccess) {
+        glGenerateTextureMipmap(m_texture);
+        return;
+    }
     GLenum target = GLFormatUtils::GetTextureTarget(m_desc.type);
-    glBindTexture(target, m_texture);
+    m_device->GetStateCache().BindTextureForUpdate(target, m_texture);
     glGenerateMipmap(target);
-    glBindTexture(target, 0);
 }
 
 void OpenGL33Texture::Read(void* data, size_t size, uint32_t mipLevel, uint32_t arrayLayer) {
+    if (auto* uploads = m_device->GetUploadQueue()) {
+        uploads->Flush();
+    }
+    if (m_device->GetProfile().directStateAccess) {
+        ReadByName(data, size, mipLevel, arrayLayer);
+        return;
+    }
+    
     GLenum target = GLFormatUtils::GetTextureTarget(m_desc.type);
-    glBindTexture(target, m_texture);
+    m_device->GetStateCache().BindTextureForUpdate(target, m_texture);
     
     // Get the appropriate format and type for this texture format
     GLenum format, type;
     GLFormatUtils::GetFormatAndType(m_desc.format, format, type);
+    const bool compressed = GLFormatUtils::IsCompressedFormat(m_desc.format);
+    const auto level = static_cast<GLint>(mipLevel);
+    
+    auto getImage = [&](GLenum image, void* pixels) {
+        if (compressed) {
+            glGetCompressedTexImage(image, level, pixels);
+        } else {
+            glGetTexImage(image, level, format, type, pixels);
+        }
+    };
+    
+    switch (target) {
+        case GL_TEXTURE_CUBE_MAP:
+            getImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + arrayLayer % 6, data);
+            break;
+        case GL_TEXTURE_1D_ARRAY:
+        case GL_TEXTURE_2D_ARRAY:
+        case GL_TEXTURE_CUBE_MAP_ARRAY: {
+            // glGetTexImage returns every layer of the level; keep the one asked for
+            const uint32_t layers = CountLayers(m_desc);
+            const MipExtent extent = GetMipExtent(m_desc, mipLevel);
+            const auto layerSize = static_cast<size_t>(
+                GLFormatUtils::GetImageSize(m_desc.format, extent.width, extent.height, extent.depth));
+            if (arrayLayer >= layers) {
+                LogWarning("Texture read of layer %u out of range; skipped", arrayLayer);
+                break;
+            }
+            std::vector<std::byte> image(layerSize * layers);
+            getImage(target, image.data());
+            std::memcpy(data, image.data() + layerSize * arrayLayer, std::min(size, layerSize));
+            break;
+        }
+        default:
+            getImage(target, data);
+            break;
+    }
+}
+
+void OpenGL33Texture::ReadByName(void* data, size_t size, uint32_t mipLevel, uint32_t arrayLayer) {
+    const uint32_t layers = CountLayers(m_desc);
+    if (arrayLayer >= layers) {
+        LogWarning("Texture read of layer %u out of range; skipped", arrayLayer);
+        return;
+    }
+    
+    // Cube faces and array layers are slices; 1D array layers are rows
+    const MipExtent extent = GetMipExtent(m_desc, mipLevel);
+    GLint y = 0;
+    GLint z = 0;
+    auto height = static_cast<GLsizei>(extent.height);
+    auto depth = static_cast<GLsizei>(extent.depth);
+    if (m_desc.type == TextureType::Texture1DArray) {
+        y = static_cast<GLint>(arrayLayer);
+        height = 1;
+    } else if (layers > 1) {
+        z = static_cast<GLint>(arrayLayer);
+        depth = 1;
+    }
     
-    glGetTexImage(target, mipLevel, format, type, data);
-    glBindTexture(target, 0);
+    // A destination smaller than the layer gets its first `size` bytes
+    const auto layerSize = static_cast<size_t>(
+        GLFormatUtils::GetImageSize(m_desc.format, extent.width, extent.height, extent.depth));
+    std::vector<std::byte> scratch(size < layerSize ? layerSize : 0);
+    void* pixels = scratch.empty() ? data : scratch.data();
+    const auto level = static_cast<GLint>(mipLevel);
+    const auto width = static_cast<GLsizei>(extent.width);
+    if (GLFormatUtils::IsCompressedFormat(m_desc.format)) {
+        glGetCompressedTextureSubImage(m_texture, level, 0, y, z, width, height, depth,
+                                       static_cast<GLsizei>(layerSize), pixels);
+    } else {
+        GLenum format, type;
+        GLFormatUtils::GetFormatAndType(m_desc.format, format, type);
+        glGetTextureSubImage(m_texture, level, 0, y, z, width, height, depth, format, type,
+                             static_cast<GLsizei>(layerSize), pixels);
+    }
+    if (!scratch.empty()) {
+        std::memcpy(data, scratch.data(), size);
+    }
 }
 
 } // namespace VRHI
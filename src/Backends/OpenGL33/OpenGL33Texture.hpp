@@ -7,16 +7,19 @@
 
 #include <VRHI/VRHI.hpp>
 #include <VRHI/Resources.hpp>
+#include "OpenGL33UploadQueue.hpp"
 #include <glad/glad.h>
 
 namespace VRHI {
 
+class OpenGL33Device;
+
 class OpenGL33Texture : public Texture {
 public:
     ~OpenGL33Texture() override;
     
     static std::expected<std::unique_ptr<Texture>, Error>
-    Create(const TextureDesc& desc);
+    Create(OpenGL33Device& device, const TextureDesc& desc);
     
     // Texture interface
     TextureType GetType() const noexcept override;
@@ -31,14 +34,32 @@ public:
     void UpdateRegion(const void* data, uint32_t x, uint32_t y, uint32_t z,
                      uint32_t width, uint32_t height, uint32_t depth,
                      uint32_t mipLevel = 0, uint32_t arrayLayer = 0) override;
+    void UpdateRegionAsync(const void* data, uint32_t x, uint32_t y, uint32_t z,
+                           uint32_t width, uint32_t height, uint32_t depth,
+                           uint32_t mipLevel = 0, uint32_t arrayLayer = 0) override;
+    void UpdateSubresources(const void* data, std::span<const TextureSubresourceData> subresources) override;
     void GenerateMipmaps(CommandBuffer* cmd) override;
     void Read(void* data, size_t size, uint32_t mipLevel = 0, uint32_t arrayLayer = 0) override;
     
     GLuint GetHandle() const noexcept { return m_texture; }
     
 private:
-    OpenGL33Texture(const TextureDesc& desc, GLuint texture);
+    OpenGL33Texture(OpenGL33Device& device, const TextureDesc& desc, GLuint texture);
+    
+    /// The GL targets and extents of a region of one mip level of one layer
+    GLTextureUpload DescribeUpload(uint32_t x, uint32_t y, uint32_t z,
+                                   uint32_t width, uint32_t height, uint32_t depth,
+                                   uint32_t mipLevel, uint32_t arrayLayer) const;
+    
+    /// Write a region of one mip level of one layer through the device's upload queue
+    void Upload(const void* data, uint32_t x, uint32_t y, uint32_t z,
+                uint32_t width, uint32_t height, uint32_t depth,
+                uint32_t mipLevel, uint32_t arrayLayer, bool async);
+    
+    /// Read() of exactly one layer by texture name (GL 4.5 direct state access)
+    void ReadByName(void* data, size_t size, uint32_t mipLevel, uint32_t arrayLayer);
     
+    OpenGL33Device* m_device = nullptr;
     TextureDesc m_desc;
     GLuint m_texture = 0;
 };
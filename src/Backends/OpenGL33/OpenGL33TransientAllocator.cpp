@@ -0,0 +1,68 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "OpenGL33TransientAllocator.hpp"
+#include "OpenGL33Buffer.hpp"
+#include "OpenGL33Device.hpp"
+
+namespace VRHI {
+
+OpenGL33TransientAllocator::OpenGL33TransientAllocator(OpenGL33Device& device, uint64_t alignment,
+                                                       uint64_t capacity)
+    : TransientRingAllocator(device, alignment, capacity)
+    , m_device(&device)
+{
+}
+
+OpenGL33TransientAllocator::~OpenGL33TransientAllocator() {
+    Release();
+}
+
+void* OpenGL33TransientAllocator::MapRing(Buffer& buffer) {
+    auto& glBuffer = static_cast<OpenGL33Buffer&>(buffer);
+    if (void* persistent = glBuffer.GetPersistentMapping()) {
+        return persistent;  // Coherent; nothing to flush or unmap
+    }
+    m_device->GetStateCache().BindBuffer(GL_COPY_WRITE_BUFFER, glBuffer.GetHandle());
+    return glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, static_cast<GLsizeiptr>(glBuffer.GetSize()),
+                            GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_FLUSH_EXPLICIT_BIT);
+}
+
+void OpenGL33TransientAllocator::FlushRange(Buffer& buffer, uint64_t offset, uint64_t size) {
+    auto& glBuffer = static_cast<OpenGL33Buffer&>(buffer);
+    if (size == 0 || glBuffer.GetPersistentMapping()) {
+        return;
+    }
+    m_device->GetStateCache().BindBuffer(GL_COPY_WRITE_BUFFER, glBuffer.GetHandle());
+    glFlushMappedBufferRange(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset),
+                             static_cast<GLsizeiptr>(size));
+}
+
+void OpenGL33TransientAllocator::UnmapRing(Buffer& buffer) {
+    auto& glBuffer = static_cast<OpenGL33Buffer&>(buffer);
+    if (glBuffer.GetPersistentMapping()) {
+        return;
+    }
+    m_device->GetStateCache().BindBuffer(GL_COPY_WRITE_BUFFER, glBuffer.GetHandle());
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+}
+
+void* OpenGL33TransientAllocator::InsertFence() {
+    return glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool OpenGL33TransientAllocator::IsFenceSignaled(void* fence) {
+    if (!fence) {
+        return true;
+    }
+    GLenum status = glClientWaitSync(static_cast<GLsync>(fence), 0, 0);
+    return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
+
+void OpenGL33TransientAllocator::DeleteFence(void* fence) {
+    if (fence) {
+        glDeleteSync(static_cast<GLsync>(fence));
+    }
+}
+
+} // namespace VRHI
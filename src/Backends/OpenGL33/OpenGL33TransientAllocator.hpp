@@ -0,0 +1,37 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "Core/TransientRingAllocator.hpp"
+#include <glad/glad.h>
+
+namespace VRHI {
+
+class OpenGL33Device;
+
+/// Transient allocator whose ring is mapped with GL_MAP_UNSYNCHRONIZED_BIT.
+///
+/// The driver does not wait for draws that still read older parts of the
+/// ring; a glFenceSync per frame tells when those parts may be reused.
+/// Written ranges are flushed explicitly before each submission. Rings that
+/// are persistently mapped (OpenGL 4.6) are written in place instead.
+class OpenGL33TransientAllocator final : public TransientRingAllocator {
+public:
+    OpenGL33TransientAllocator(OpenGL33Device& device, uint64_t alignment,
+                               uint64_t capacity = DefaultCapacity);
+    ~OpenGL33TransientAllocator() override;
+
+protected:
+    void* MapRing(Buffer& buffer) override;
+    void FlushRange(Buffer& buffer, uint64_t offset, uint64_t size) override;
+    void UnmapRing(Buffer& buffer) override;
+    void* InsertFence() override;
+    bool IsFenceSignaled(void* fence) override;
+    void DeleteFence(void* fence) override;
+
+private:
+    OpenGL33Device* m_device;
+};
+
+} // namespace VRHI
@@ -0,0 +1,67 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "OpenGL33UniformRing.hpp"
+#include "OpenGL33StateCache.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace VRHI {
+
+OpenGL33UniformRing::OpenGL33UniformRing(OpenGL33StateCache& stateCache, GLsizeiptr capacity)
+    : m_stateCache(stateCache)
+    , m_capacity(capacity)
+{
+}
+
+void OpenGL33UniformRing::Initialize() {
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (alignment > 0) {
+        m_alignment = alignment;
+    }
+
+    glGenBuffers(1, &m_buffer);
+    Orphan();
+}
+
+void OpenGL33UniformRing::Release() {
+    if (m_buffer != 0) {
+        m_stateCache.OnBufferDeleted(m_buffer);
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+    }
+}
+
+void OpenGL33UniformRing::Orphan() {
+    m_stateCache.BindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, m_capacity, nullptr, GL_STREAM_DRAW);
+    m_head = 0;
+}
+
+GLintptr OpenGL33UniformRing::Upload(std::span<const std::byte> data) {
+    const auto size = static_cast<GLsizeiptr>(data.size());
+    if (size > m_capacity) {
+        m_capacity = std::max(size, m_capacity * 2);
+        Orphan();
+    } else if (m_head + size > m_capacity) {
+        Orphan();
+        ++m_orphanCount;
+    }
+
+    const GLintptr offset = m_head;
+    m_stateCache.BindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    void* ptr = glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, size,
+                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (ptr) {
+        std::memcpy(ptr, data.data(), data.size());
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    } else {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data.data());
+    }
+
+    m_head = (offset + size + m_alignment - 1) / m_alignment * m_alignment;
+    return offset;
+}
+
+} // namespace VRHI
@@ -0,0 +1,63 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace VRHI {
+
+class OpenGL33StateCache;
+
+/// Streaming uniform buffer for small, per-draw data such as emulated push
+/// constants.
+///
+/// Upload() appends to the ring through an unsynchronized map, so it never
+/// waits for draws that still read earlier ranges. When the ring is full its
+/// storage is orphaned with glBufferData: draws in flight keep the old
+/// memory, the driver hands out a fresh block and writing restarts at the
+/// beginning. Nothing is ever overwritten while the GPU may read it.
+class OpenGL33UniformRing {
+public:
+    static constexpr GLsizeiptr DefaultCapacity = 1 << 20;
+
+    explicit OpenGL33UniformRing(OpenGL33StateCache& stateCache, GLsizeiptr capacity = DefaultCapacity);
+    ~OpenGL33UniformRing() = default;
+
+    OpenGL33UniformRing(const OpenGL33UniformRing&) = delete;
+    OpenGL33UniformRing& operator=(const OpenGL33UniformRing&) = delete;
+
+    /// Create the buffer; requires a current context
+    void Initialize();
+
+    /// Delete the buffer; requires the context to still be current
+    void Release();
+
+    /// Copy `data` into the ring, growing it if `data` does not fit at all.
+    /// @return Offset of the copy in GetHandle(), a multiple of GetAlignment()
+    GLintptr Upload(std::span<const std::byte> data);
+
+    GLuint GetHandle() const noexcept { return m_buffer; }
+
+    /// Offset alignment required by glBindBufferRange on GL_UNIFORM_BUFFER
+    GLsizeiptr GetAlignment() const noexcept { return m_alignment; }
+
+    /// Times the storage was orphaned because the ring was full
+    uint64_t GetOrphanCount() const noexcept { return m_orphanCount; }
+
+private:
+    /// Replace the storage with a fresh, unused block of m_capacity bytes
+    void Orphan();
+
+    OpenGL33StateCache& m_stateCache;
+    GLuint m_buffer = 0;
+    GLsizeiptr m_capacity;
+    GLsizeiptr m_alignment = 256;
+    GLintptr m_head = 0;
+    uint64_t m_orphanCount = 0;
+};
+
+} // namespace VRHI
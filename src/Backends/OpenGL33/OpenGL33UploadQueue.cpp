@@ -0,0 +1,249 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "OpenGL33UploadQueue.hpp"
+#include "OpenGL33Buffer.hpp"
+#include "OpenGL33Device.hpp"
+#include <chrono>
+#include <cstring>
+
+namespace VRHI {
+
+namespace {
+
+/// Pixel unpack offsets must be multiples of the component size; 16 covers every format
+constexpr uint64_t StagingAlignment = 16;
+
+using Clock = std::chrono::steady_clock;
+
+double SecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void TexSubImage(const GLTextureUpload& t, const void* pixels) {
+    if (t.compressedSize > 0) {
+        switch (t.bindTarget) {
+            case GL_TEXTURE_1D:
+                glCompressedTexSubImage1D(t.imageTarget, t.level, t.x, t.width, t.format, t.compressedSize, pixels);
+                break;
+            case GL_TEXTURE_3D:
+            case GL_TEXTURE_2D_ARRAY:
+            case GL_TEXTURE_CUBE_MAP_ARRAY:
+                glCompressedTexSubImage3D(t.imageTarget, t.level, t.x, t.y, t.z, t.width, t.height, t.depth,
+                                          t.format, t.compressedSize, pixels);
+                break;
+            default:
+                glCompressedTexSubImage2D(t.imageTarget, t.level, t.x, t.y, t.width, t.height,
+                                          t.format, t.compressedSize, pixels);
+                break;
+        }
+        return;
+    }
+    switch (t.bindTarget) {
+        case GL_TEXTURE_1D:
+            glTexSubImage1D(t.imageTarget, t.level, t.x, t.width, t.format, t.type, pixels);
+            break;
+        case GL_TEXTURE_3D:
+        case GL_TEXTURE_2D_ARRAY:
+        case GL_TEXTURE_CUBE_MAP_ARRAY:
+            glTexSubImage3D(t.imageTarget, t.level, t.x, t.y, t.z, t.width, t.height, t.depth,
+                            t.format, t.type, pixels);
+            break;
+        default:
+            glTexSubImage2D(t.imageTarget, t.level, t.x, t.y, t.width, t.height, t.format, t.type, pixels);
+            break;
+    }
+}
+
+/// TexSubImage() by texture name (GL 4.5 direct state access); cube faces are layers
+void TextureSubImage(const GLTextureUpload& t, const void* pixels) {
+    GLint z = t.z;
+    if (t.bindTarget == GL_TEXTURE_CUBE_MAP) {
+        z = static_cast<GLint>(t.imageTarget - GL_TEXTURE_CUBE_MAP_POSITIVE_X);
+    }
+    const bool layered = t.bindTarget == GL_TEXTURE_3D || t.bindTarget == GL_TEXTURE_2D_ARRAY ||
+                         t.bindTarget == GL_TEXTURE_CUBE_MAP || t.bindTarget == GL_TEXTURE_CUBE_MAP_ARRAY;
+    if (t.compressedSize > 0) {
+        if (t.bindTarget == GL_TEXTURE_1D) {
+            glCompressedTextureSubImage1D(t.texture, t.level, t.x, t.width, t.format, t.compressedSize, pixels);
+        } else if (layered) {
+            glCompressedTextureSubImage3D(t.texture, t.level, t.x, t.y, z, t.width, t.height, t.depth,
+                                          t.format, t.compressedSize, pixels);
+        } else {
+            glCompressedTextureSubImage2D(t.texture, t.level, t.x, t.y, t.width, t.height,
+                                          t.format, t.compressedSize, pixels);
+        }
+        return;
+    }
+    if (t.bindTarget == GL_TEXTURE_1D) {
+        glTextureSubImage1D(t.texture, t.level, t.x, t.width, t.format, t.type, pixels);
+    } else if (layered) {
+        glTextureSubImage3D(t.texture, t.level, t.x, t.y, z, t.width, t.height, t.depth, t.format, t.type, pixels);
+    } else {
+        glTextureSubImage2D(t.texture, t.level, t.x, t.y, t.width, t.height, t.format, t.type, pixels);
+    }
+}
+
+} // anonymous namespace
+
+OpenGL33UploadQueue::OpenGL33UploadQueue(OpenGL33Device& device)
+    : m_device(&device)
+    , m_ring(device, StagingAlignment, RingCapacity)
+    , m_directStateAccess(device.GetProfile().directStateAccess)
+{
+}
+
+OpenGL33UploadQueue::~OpenGL33UploadQueue() = default;
+
+void OpenGL33UploadQueue::UpdateBuffer(GLuint buffer, uint64_t offset, const void* data, uint64_t size, bool async) {
+    const auto start = Clock::now();
+    Copy copy;
+    copy.buffer = buffer;
+    copy.offset = offset;
+    copy.size = size;
+    if (Stage(data, size, copy.source, copy.sourceOffset)) {
+        m_copies.push_back(copy);
+        m_frameSeconds += SecondsSince(start);
+        if (!async) {
+            Flush();
+        }
+        return;
+    }
+
+    // Staged copies into the same range must land first
+    Flush();
+    if (m_directStateAccess) {
+        glNamedBufferSubData(buffer, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+    } else {
+        m_device->GetStateCache().BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+    }
+    m_frameBytes += size;
+    m_frameSeconds += SecondsSince(start);
+}
+
+void OpenGL33UploadQueue::UpdateTexture(const GLTextureUpload& upload, const void* data, uint64_t size, bool async) {
+    UpdateTextures(std::span(&upload, 1), data, size, async);
+}
+
+void OpenGL33UploadQueue::UpdateTextures(std::span<const GLTextureUpload> uploads, const void* data,
+                                         uint64_t size, bool async) {
+    const auto start = Clock::now();
+    GLuint source = 0;
+    uint64_t sourceOffset = 0;
+    if (Stage(data, size, source, sourceOffset)) {
+        for (const GLTextureUpload& upload : uploads) {
+            Copy copy;
+            copy.source = source;
+            copy.sourceOffset = sourceOffset + upload.dataOffset;
+            copy.texture = upload;
+            m_copies.push_back(copy);
+        }
+        m_frameSeconds += SecondsSince(start);
+        if (!async) {
+            Flush();
+        }
+        return;
+    }
+
+    Flush();
+    for (const GLTextureUpload& upload : uploads) {
+        UploadTexture(upload, static_cast<const std::byte*>(data) + upload.dataOffset);
+    }
+    m_frameBytes += size;
+    m_frameSeconds += SecondsSince(start);
+}
+
+bool OpenGL33UploadQueue::Stage(const void* data, uint64_t size, GLuint& source, uint64_t& sourceOffset) {
+    if (size == 0 || size > MaxStagedSize) {
+        return false;
+    }
+    TransientAllocation staging = m_ring.Allocate(size);
+    if (!staging) {
+        return false;
+    }
+    std::memcpy(staging.data, data, static_cast<size_t>(size));
+
+    source = static_cast<OpenGL33Buffer*>(staging.buffer)->GetHandle();
+    sourceOffset = staging.offset;
+    m_frameBytes += size;
+    return true;
+}
+
+void OpenGL33UploadQueue::Flush() {
+    if (m_copies.empty()) {
+        return;
+    }
+    const auto start = Clock::now();
+
+    // Copies read the ring, which must not be mapped while they execute
+    m_ring.FlushWrites();
+
+    bool unpackBound = false;
+    for (const Copy& copy : m_copies) {
+        Issue(copy);
+        unpackBound |= copy.buffer == 0;
+    }
+    m_copies.clear();
+
+    // Texture uploads from client memory expect no unpack buffer
+    if (unpackBound) {
+        m_device->GetStateCache().BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    m_frameSeconds += SecondsSince(start);
+}
+
+void OpenGL33UploadQueue::OnBufferDeleted(GLuint buffer) {
+    std::erase_if(m_copies, [buffer](const Copy& copy) { return copy.buffer == buffer; });
+}
+
+void OpenGL33UploadQueue::OnTextureDeleted(GLuint texture) {
+    std::erase_if(m_copies, [texture](const Copy& copy) {
+        return copy.buffer == 0 && copy.texture.texture == texture;
+    });
+}
+
+void OpenGL33UploadQueue::Issue(const Copy& copy) {
+    auto& stateCache = m_device->GetStateCache();
+    if (copy.buffer != 0 && m_directStateAccess) {
+        glCopyNamedBufferSubData(copy.source, copy.buffer,
+                                 static_cast<GLintptr>(copy.sourceOffset), static_cast<GLintptr>(copy.offset),
+                                 static_cast<GLsizeiptr>(copy.size));
+        return;
+    }
+    if (copy.buffer != 0) {
+        stateCache.BindBuffer(GL_COPY_READ_BUFFER, copy.source);
+        stateCache.BindBuffer(GL_COPY_WRITE_BUFFER, copy.buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                            static_cast<GLintptr>(copy.sourceOffset), static_cast<GLintptr>(copy.offset),
+                            static_cast<GLsizeiptr>(copy.size));
+        return;
+    }
+
+    // With a pixel unpack buffer bound, the pixel pointer is an offset into it
+    stateCache.BindBuffer(GL_PIXEL_UNPACK_BUFFER, copy.source);
+    UploadTexture(copy.texture, reinterpret_cast<const void*>(static_cast<uintptr_t>(copy.sourceOffset)));
+}
+
+void OpenGL33UploadQueue::UploadTexture(const GLTextureUpload& upload, const void* pixels) {
+    if (m_directStateAccess) {
+        TextureSubImage(upload, pixels);
+        return;
+    }
+    m_device->GetStateCache().BindTextureForUpdate(upload.bindTarget, upload.texture);
+    TexSubImage(upload, pixels);
+}
+
+void OpenGL33UploadQueue::EndFrame() {
+    Flush();
+    m_ring.EndFrame();
+
+    m_lastFrameBytes = m_frameBytes;
+    m_lastFrameMegabytesPerSecond = m_frameSeconds > 0.0
+        ? static_cast<double>(m_frameBytes) / 1.0e6 / m_frameSeconds
+        : 0.0;
+    m_frameBytes = 0;
+    m_frameSeconds = 0.0;
+}
+
+} // namespace VRHI
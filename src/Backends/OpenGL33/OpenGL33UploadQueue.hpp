@@ -0,0 +1,117 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "OpenGL33TransientAllocator.hpp"
+#include <glad/glad.h>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace VRHI {
+
+class OpenGL33Device;
+
+/// A texture region written from a pixel unpack buffer
+struct GLTextureUpload {
+    GLenum bindTarget = GL_TEXTURE_2D;   ///< Target the texture is bound to
+    GLenum imageTarget = GL_TEXTURE_2D;  ///< Target passed to glTexSubImage* (a cube face)
+    GLuint texture = 0;
+    GLint level = 0;
+    GLint x = 0, y = 0, z = 0;  ///< z is the layer of array textures
+    GLsizei width = 0, height = 0, depth = 1;
+    GLenum format = GL_RGBA;  ///< Internal format of compressed data
+    GLenum type = GL_UNSIGNED_BYTE;
+    GLsizei compressedSize = 0;  ///< Bytes of block-compressed data; 0 if uncompressed
+    uint64_t dataOffset = 0;     ///< Of the region in the data passed to UpdateTextures()
+};
+
+/// Buffer and texture updates staged in a fenced ring.
+///
+/// Updates copy the data into a ring buffer mapped with
+/// GL_MAP_UNSYNCHRONIZED_BIT and record a GPU-side copy from it
+/// (glCopyBufferSubData, or glTexSubImage* from a pixel unpack buffer).
+/// Flush() unmaps the ring and issues the recorded copies in order, so the
+/// driver never has to wait for draws still reading the destination before
+/// it can take the data. Ring memory is recycled by the per-frame fence of
+/// OpenGL33TransientAllocator once the copies have executed.
+///
+/// Synchronous updates flush right away; asynchronous ones are batched
+/// until the device flushes at Submit(), Present() or before a read.
+/// Uploads larger than MaxStagedSize go straight to the driver. With direct
+/// state access (the GL 4.x profile) buffers and textures are written by
+/// name, so only the ring is ever bound.
+class OpenGL33UploadQueue {
+public:
+    static constexpr uint64_t RingCapacity = 8ull << 20;
+    static constexpr uint64_t MaxStagedSize = RingCapacity / 2;
+
+    explicit OpenGL33UploadQueue(OpenGL33Device& device);
+    ~OpenGL33UploadQueue();
+
+    OpenGL33UploadQueue(const OpenGL33UploadQueue&) = delete;
+    OpenGL33UploadQueue& operator=(const OpenGL33UploadQueue&) = delete;
+
+    /// Write `size` bytes of `buffer` at `offset`
+    /// @param async Leave the copy to the next Flush() instead of issuing it now
+    void UpdateBuffer(GLuint buffer, uint64_t offset, const void* data, uint64_t size, bool async);
+
+    /// Write a tightly packed texture region of `size` bytes
+    /// @param async Leave the copy to the next Flush() instead of issuing it now
+    void UpdateTexture(const GLTextureUpload& upload, const void* data, uint64_t size, bool async);
+
+    /// Write several texture regions held in one block of `size` bytes,
+    /// staged with a single copy into the ring
+    void UpdateTextures(std::span<const GLTextureUpload> uploads, const void* data, uint64_t size, bool async);
+
+    /// Issue every staged copy
+    void Flush();
+
+    /// Drop staged copies into a buffer or texture that is being deleted,
+    /// so that they cannot reach a later object reusing its name
+    void OnBufferDeleted(GLuint buffer);
+    void OnTextureDeleted(GLuint texture);
+
+    /// Flush, fence the frame's ring memory and close the frame's statistics
+    void EndFrame();
+
+    /// Bytes uploaded in the last frame and the CPU throughput of those uploads
+    uint64_t GetLastFrameBytes() const noexcept { return m_lastFrameBytes; }
+    double GetLastFrameMegabytesPerSecond() const noexcept { return m_lastFrameMegabytesPerSecond; }
+
+    /// The staging ring, for its usage and the frames it still holds
+    const OpenGL33TransientAllocator& GetRing() const noexcept { return m_ring; }
+
+private:
+    struct Copy {
+        GLuint source = 0;
+        uint64_t sourceOffset = 0;
+        uint64_t size = 0;
+        GLuint buffer = 0;  ///< Destination buffer; 0 for a texture upload
+        uint64_t offset = 0;
+        GLTextureUpload texture;
+    };
+
+    /// Claim ring memory and copy the data into it
+    /// @return False if the data must be uploaded directly instead
+    bool Stage(const void* data, uint64_t size, GLuint& source, uint64_t& sourceOffset);
+
+    /// Issue a copy reading the ring
+    void Issue(const Copy& copy);
+
+    /// glTexSubImage* into a region, by name if direct state access is available
+    void UploadTexture(const GLTextureUpload& upload, const void* pixels);
+
+    OpenGL33Device* m_device;
+    OpenGL33TransientAllocator m_ring;
+    std::vector<Copy> m_copies;
+    bool m_directStateAccess;
+
+    uint64_t m_frameBytes = 0;
+    double m_frameSeconds = 0.0;  ///< CPU time spent staging and issuing copies
+    uint64_t m_lastFrameBytes = 0;
+    double m_lastFrameMegabytesPerSecond = 0.0;
+};
+
+} // namespace VRHI
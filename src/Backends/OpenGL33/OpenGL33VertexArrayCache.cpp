@@ -0,0 +1,156 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "OpenGL33VertexArrayCache.hpp"
+#include "OpenGL33StateCache.hpp"
+#include <algorithm>
+#include <functional>
+
+namespace VRHI {
+
+namespace {
+    void HashCombine(size_t& seed, size_t value) noexcept {
+        seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+    }
+} // anonymous namespace
+
+size_t ComputeVertexLayoutHash(const GLVertexLayout& layout) noexcept {
+    size_t seed = 0;
+    HashCombine(seed, layout.attributeCount);
+    HashCombine(seed, layout.streamCount);
+    for (uint32_t i = 0; i < layout.attributeCount; ++i) {
+        const auto& attr = layout.attributes[i];
+        HashCombine(seed, attr.location);
+        HashCombine(seed, static_cast<size_t>(attr.componentCount));
+        HashCombine(seed, attr.type);
+        HashCombine(seed, attr.normalized);
+        HashCombine(seed, attr.stream);
+        HashCombine(seed, attr.offset);
+    }
+    for (uint32_t i = 0; i < layout.streamCount; ++i) {
+        const auto& stream = layout.streams[i];
+        HashCombine(seed, stream.binding);
+        HashCombine(seed, static_cast<size_t>(stream.stride));
+        HashCombine(seed, stream.divisor);
+    }
+    return seed;
+}
+
+bool GLVertexArrayKey::operator==(const GLVertexArrayKey& other) const noexcept {
+    if (indexBuffer != other.indexBuffer) {
+        return false;
+    }
+    if (layout != other.layout && !(layout && other.layout && *layout == *other.layout)) {
+        return false;
+    }
+    
+    // Slots past the layout's streams keep whatever was bound there before
+    // and are never read, so they must not tell equal keys apart
+    const uint32_t streamCount = layout ? layout->streamCount : 0;
+    return std::equal(streams.begin(), streams.begin() + streamCount, other.streams.begin());
+}
+
+size_t OpenGL33VertexArrayCache::KeyHash::operator()(const GLVertexArrayKey& key) const noexcept {
+    size_t seed = key.layout ? key.layout->hash : 0;
+    const uint32_t streamCount = key.layout ? key.layout->streamCount : 0;
+    for (uint32_t i = 0; i < streamCount; ++i) {
+        HashCombine(seed, key.streams[i].buffer);
+        HashCombine(seed, std::hash<uint64_t>{}(key.streams[i].offset));
+    }
+    HashCombine(seed, key.indexBuffer);
+    return seed;
+}
+
+OpenGL33VertexArrayCache::OpenGL33VertexArrayCache(OpenGL33StateCache& stateCache, size_t capacity)
+    : m_stateCache(stateCache)
+    , m_capacity(capacity > 0 ? capacity : 1)
+{
+}
+
+void OpenGL33VertexArrayCache::Bind(const GLVertexArrayKey& key) {
+    auto found = m_lookup.find(key);
+    if (found != m_lookup.end()) {
+        // Move to the front of the LRU list
+        m_entries.splice(m_entries.begin(), m_entries, found->second);
+        m_stateCache.BindVertexArray(found->second->vao);
+        return;
+    }
+
+    if (m_lookup.size() >= m_capacity) {
+        Evict(std::prev(m_entries.end()));
+    }
+
+    ++m_misses;
+    GLuint vao = Build(key);
+    m_entries.push_front(Entry{key, vao});
+    m_lookup.emplace(key, m_entries.begin());
+}
+
+GLuint OpenGL33VertexArrayCache::Build(const GLVertexArrayKey& key) {
+    GLuint vao = 0;
+    glGenVertexArrays(1, &vao);
+    m_stateCache.BindVertexArray(vao);
+
+    if (key.layout) {
+        const GLVertexLayout& layout = *key.layout;
+        for (uint32_t i = 0; i < layout.attributeCount; ++i) {
+            const auto& attr = layout.attributes[i];
+            const auto& source = key.streams[attr.stream];
+            if (source.buffer == 0) {
+                // Nothing bound to this slot; the attribute stays disabled
+                continue;
+            }
+
+            const auto& stream = layout.streams[attr.stream];
+            m_stateCache.BindBuffer(GL_ARRAY_BUFFER, source.buffer);
+            glEnableVertexAttribArray(attr.location);
+            glVertexAttribPointer(
+                attr.location,
+                attr.componentCount,
+                attr.type,
+                attr.normalized,
+                stream.stride,
+                reinterpret_cast<const void*>(static_cast<uintptr_t>(source.offset + attr.offset))
+            );
+            if (stream.divisor != 0) {
+                glVertexAttribDivisor(attr.location, stream.divisor);
+            }
+        }
+    }
+
+    if (key.indexBuffer != 0) {
+        m_stateCache.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, key.indexBuffer);
+    }
+
+    return vao;
+}
+
+void OpenGL33VertexArrayCache::Evict(EntryList::iterator entry) {
+    m_stateCache.OnVertexArrayDeleted(entry->vao);
+    glDeleteVertexArrays(1, &entry->vao);
+    m_lookup.erase(entry->key);
+    m_entries.erase(entry);
+}
+
+void OpenGL33VertexArrayCache::OnBufferDeleted(GLuint buffer) {
+    EvictIf([buffer](const GLVertexArrayKey& key) {
+        if (key.indexBuffer == buffer) {
+            return true;
+        }
+        const uint32_t streamCount = key.layout ? key.layout->streamCount : 0;
+        return std::any_of(key.streams.begin(), key.streams.begin() + streamCount,
+                           [buffer](const GLVertexArrayKey::Stream& stream) { return stream.buffer == buffer; });
+    });
+}
+
+void OpenGL33VertexArrayCache::OnLayoutDeleted(const GLVertexLayout* layout) {
+    EvictIf([layout](const GLVertexArrayKey& key) { return key.layout == layout; });
+}
+
+void OpenGL33VertexArrayCache::Clear() {
+    while (!m_entries.empty()) {
+        Evict(m_entries.begin());
+    }
+}
+
+} // namespace VRHI
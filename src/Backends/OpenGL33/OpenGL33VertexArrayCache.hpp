@@ -0,0 +1,148 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <glad/glad.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+
+namespace VRHI {
+
+class OpenGL33StateCache;
+
+// ============================================================================
+// Baked Vertex Layout
+// ============================================================================
+
+/// One vertex attribute, translated to glVertexAttribPointer arguments
+struct GLVertexAttribute {
+    GLuint location = 0;
+    GLint componentCount = 0;
+    GLenum type = GL_FLOAT;
+    GLboolean normalized = GL_FALSE;
+    uint32_t stream = 0;  ///< Index into GLVertexLayout::streams
+    uint32_t offset = 0;
+
+    bool operator==(const GLVertexAttribute&) const = default;
+};
+
+/// One vertex buffer slot read by a layout
+struct GLVertexStream {
+    uint32_t binding = 0;  ///< Binding index passed to BindVertexBuffers
+    GLsizei stride = 0;
+    GLuint divisor = 0;    ///< 1 for per-instance data
+
+    bool operator==(const GLVertexStream&) const = default;
+};
+
+/// Vertex input state of a pipeline, baked once at pipeline creation
+struct GLVertexLayout {
+    static constexpr uint32_t MaxAttributes = 16;
+    static constexpr uint32_t MaxStreams = 16;
+
+    size_t hash = 0;  ///< Compared first so unequal layouts are rejected quickly
+    uint32_t attributeCount = 0;
+    uint32_t streamCount = 0;
+    std::array<GLVertexAttribute, MaxAttributes> attributes{};
+    std::array<GLVertexStream, MaxStreams> streams{};
+
+    bool operator==(const GLVertexLayout&) const = default;
+};
+
+/// Hash of the attributes and streams of a layout (excluding `hash` itself)
+size_t ComputeVertexLayoutHash(const GLVertexLayout& layout) noexcept;
+
+// ============================================================================
+// Vertex Array Cache
+// ============================================================================
+
+/// Everything a vertex array object captures
+struct GLVertexArrayKey {
+    struct Stream {
+        GLuint buffer = 0;
+        uint64_t offset = 0;
+
+        bool operator==(const Stream&) const = default;
+    };
+
+    const GLVertexLayout* layout = nullptr;
+    std::array<Stream, GLVertexLayout::MaxStreams> streams{};  ///< Parallel to layout->streams
+    GLuint indexBuffer = 0;
+
+    /// Layouts compare by value, so pipelines with identical vertex input share VAOs
+    bool operator==(const GLVertexArrayKey& other) const noexcept;
+};
+
+/// Lazily built vertex array objects, evicted least recently used first.
+///
+/// The replayer describes the vertex input it needs as a key at draw time;
+/// on a hit the only GL work is one glBindVertexArray (itself filtered by the
+/// state cache when the VAO is already bound). Entries hold GL buffer names
+/// and layout pointers, so buffers and pipelines must report their deletion.
+class OpenGL33VertexArrayCache {
+public:
+    static constexpr size_t DefaultCapacity = 256;
+
+    explicit OpenGL33VertexArrayCache(OpenGL33StateCache& stateCache, size_t capacity = DefaultCapacity);
+    ~OpenGL33VertexArrayCache() = default;
+
+    OpenGL33VertexArrayCache(const OpenGL33VertexArrayCache&) = delete;
+    OpenGL33VertexArrayCache& operator=(const OpenGL33VertexArrayCache&) = delete;
+
+    /// Bind the VAO matching `key`, building it on a miss
+    void Bind(const GLVertexArrayKey& key);
+
+    /// Drop every VAO that references the buffer
+    void OnBufferDeleted(GLuint buffer);
+
+    /// Drop every VAO built from the layout (its owning pipeline is going away)
+    void OnLayoutDeleted(const GLVertexLayout* layout);
+
+    /// Delete all VAOs; requires the context to still be current
+    void Clear();
+
+    size_t GetSize() const noexcept { return m_lookup.size(); }
+
+    /// VAOs built since the last ResetMissCount()
+    uint64_t GetMissCount() const noexcept { return m_misses; }
+    void ResetMissCount() noexcept { m_misses = 0; }
+
+private:
+    struct Entry {
+        GLVertexArrayKey key;
+        GLuint vao = 0;
+    };
+
+    struct KeyHash {
+        size_t operator()(const GLVertexArrayKey& key) const noexcept;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    GLuint Build(const GLVertexArrayKey& key);
+    void Evict(EntryList::iterator entry);
+
+    template<typename Predicate>
+    void EvictIf(Predicate predicate) {
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            auto next = std::next(it);
+            if (predicate(it->key)) {
+                Evict(it);
+            }
+            it = next;
+        }
+    }
+
+    OpenGL33StateCache& m_stateCache;
+    size_t m_capacity;
+    EntryList m_entries;  // Most recently used first
+    std::unordered_map<GLVertexArrayKey, EntryList::iterator, KeyHash> m_lookup;
+    uint64_t m_misses = 0;
+};
+
+} // namespace VRHI
@@ -0,0 +1,81 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "OpenGL46Backend.hpp"
+#include "OpenGL46Device.hpp"
+#include <VRHI/Logging.hpp>
+
+namespace VRHI {
+
+BackendType OpenGL46Backend::GetType() const noexcept {
+    return BackendType::OpenGL46;
+}
+
+std::string_view OpenGL46Backend::GetName() const noexcept {
+    return "OpenGL 4.6";
+}
+
+Version OpenGL46Backend::GetVersion() const noexcept {
+    return Version{4, 6, 0, "4.6"};
+}
+
+bool OpenGL46Backend::IsFeatureSupported(Feature feature) const noexcept {
+    if (!m_featuresDetected || m_fallback) {
+        return OpenGL33Backend::IsFeatureSupported(feature);
+    }
+    
+    switch (feature) {
+        case Feature::Compute: return m_features.core.computeShader;
+        case Feature::Tessellation: return m_features.core.tessellationShader;
+        case Feature::MultiDrawIndirect: return m_features.core.multiDrawIndirect;
+        default: return OpenGL33Backend::IsFeatureSupported(feature);
+    }
+}
+
+std::expected<std::unique_ptr<Device>, Error>
+OpenGL46Backend::CreateDevice(const DeviceConfig& config) {
+    auto device = std::make_unique<OpenGL46Device>(config, this);
+    
+    auto initResult = device->Initialize();
+    if (!initResult) {
+        if (initResult.error().code != Error::Code::UnsupportedFeature) {
+            return std::unexpected(initResult.error());
+        }
+        LogWarning("%s; falling back to the OpenGL 3.3 device", initResult.error().message.c_str());
+        m_fallback = true;
+        return OpenGL33Backend::CreateDevice(config);
+    }
+    
+    // Detect features now that we have a context
+    DetectFeatures();
+    device->UpdateFeatures();
+    
+    return device;
+}
+
+} // namespace VRHI
+
+// Register the backend with the factory
+namespace {
+    struct OpenGL46BackendRegistrar {
+        OpenGL46BackendRegistrar() {
+            VRHI::BackendFactory::RegisterBackend(
+                VRHI::BackendType::OpenGL46,
+                []() -> std::unique_ptr<VRHI::IBackend> {
+                    return std::make_unique<VRHI::OpenGL46Backend>();
+                }
+            );
+        }
+    };
+    static OpenGL46BackendRegistrar s_opengl46Registrar;
+}
+
+// Export registration function for explicit initialization
+namespace VRHI {
+namespace detail {
+    void RegisterOpenGL46Backend() {
+        // Force the static registrar to be instantiated
+        (void)&s_opengl46Registrar;
+    }
+}
+}
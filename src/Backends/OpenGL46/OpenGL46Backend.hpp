@@ -0,0 +1,32 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "Backends/OpenGL33/OpenGL33Backend.hpp"
+
+namespace VRHI {
+
+/// OpenGL 4.6 backend implementation
+///
+/// Reuses the OpenGL 3.3 resources and command replay with a device profile
+/// that enables compute, storage buffers and multi-draw indirect, and creates
+/// buffers with direct state access and immutable storage. Contexts older
+/// than 4.5 get an OpenGL 3.3 device instead.
+class OpenGL46Backend : public OpenGL33Backend {
+public:
+    // IBackend implementation
+    BackendType GetType() const noexcept override;
+    std::string_view GetName() const noexcept override;
+    Version GetVersion() const noexcept override;
+    
+    bool IsFeatureSupported(Feature feature) const noexcept override;
+    
+    std::expected<std::unique_ptr<Device>, Error>
+    CreateDevice(const DeviceConfig& config) override;
+    
+private:
+    bool m_fallback = false;  // The context was too old; devices are OpenGL 3.3
+};
+
+} // namespace VRHI
@@ -0,0 +1,203 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "OpenGL46Buffer.hpp"
+#include "Core/BufferMapping.hpp"
+#include "Core/BufferStreaming.hpp"
+#include <VRHI/Logging.hpp>
+
+namespace VRHI {
+
+namespace {
+    GLenum GetGLBufferTarget(BufferUsage usage) {
+        if (static_cast<uint32_t>(usage & BufferUsage::Index)) {
+            return GL_ELEMENT_ARRAY_BUFFER;
+        }
+        if (static_cast<uint32_t>(usage & BufferUsage::Uniform)) {
+            return GL_UNIFORM_BUFFER;
+        }
+        return GL_ARRAY_BUFFER;
+    }
+    
+    constexpr GLbitfield PersistentBits = GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    
+    /// Storage flags; the mapping flags of persistent buffers are the same
+    /// minus GL_DYNAMIC_STORAGE_BIT and GL_CLIENT_STORAGE_BIT
+    GLbitfield GetStorageFlags(MemoryAccess access) {
+        switch (access) {
+            case MemoryAccess::CpuToGpu:
+                return GL_MAP_WRITE_BIT | PersistentBits;
+            case MemoryAccess::GpuToCpu:
+            case MemoryAccess::CpuOnly:
+                return GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | PersistentBits | GL_CLIENT_STORAGE_BIT;
+            case MemoryAccess::GpuOnly:
+            default:
+                return GL_MAP_READ_BIT | GL_MAP_WRITE_BIT;
+        }
+    }
+    
+    /// Create a buffer with immutable storage, persistently mapped if the
+    /// flags ask for it
+    /// @return False if the storage could not be allocated or mapped
+    bool AllocateStorage(const BufferDesc& desc, GLbitfield flags, GLuint& buffer, void*& persistent) {
+        // Errors left by earlier calls must not be taken for this allocation's
+        while (glGetError() != GL_NO_ERROR) {
+        }
+        glCreateBuffers(1, &buffer);
+        if (buffer == 0) {
+            return false;
+        }
+        
+        // Every buffer accepts Update(), which is glNamedBufferSubData
+        glNamedBufferStorage(buffer, static_cast<GLsizeiptr>(desc.size), desc.initialData,
+                             flags | GL_DYNAMIC_STORAGE_BIT);
+        if (flags & GL_MAP_PERSISTENT_BIT) {
+            persistent = glMapNamedBufferRange(buffer, 0, static_cast<GLsizeiptr>(desc.size),
+                                               flags & ~GL_CLIENT_STORAGE_BIT);
+        }
+        return glGetError() == GL_NO_ERROR && (!(flags & GL_MAP_PERSISTENT_BIT) || persistent);
+    }
+}
+
+std::expected<std::unique_ptr<Buffer>, Error>
+OpenGL46Buffer::Create(OpenGL33Device& device, const BufferDesc& desc) {
+    if (desc.size == 0) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Buffer size must be greater than 0"
+        });
+    }
+    BufferStreaming streaming = ResolveStreaming(desc);
+    if (const char* error = ValidateStreaming(desc, streaming)) {
+        return std::unexpected(Error{Error::Code::InvalidConfig, error});
+    }
+    // Immutable storage cannot be re-specified
+    if (streaming == BufferStreaming::Orphan) {
+        streaming = BufferStreaming::None;
+    }
+    
+    const GLbitfield flags = GetStorageFlags(desc.memoryAccess);
+    GLuint buffer = 0;
+    void* persistent = nullptr;
+    if (!AllocateStorage(desc, flags, buffer, persistent)) {
+        if (buffer != 0) {
+            glDeleteBuffers(1, &buffer);
+        }
+        return std::unexpected(Error{
+            Error::Code::InitializationFailed,
+            "Failed to allocate buffer storage"
+        });
+    }
+    
+    auto bufferObj = std::unique_ptr<OpenGL46Buffer>(
+        new OpenGL46Buffer(device, desc, buffer, GetGLBufferTarget(desc.usage))
+    );
+    bufferObj->m_persistentPtr = persistent;
+    bufferObj->m_streaming = streaming;
+    
+    // Every copy starts with the initial data; the destructor owns them from here
+    if (StreamingRotates(streaming)) {
+        bufferObj->m_copies.resize(desc.streamingCopies);
+        bufferObj->m_copies[0] = {buffer, nullptr, persistent};
+        for (uint32_t i = 1; i < desc.streamingCopies; ++i) {
+            StreamCopy& copy = bufferObj->m_copies[i];
+            if (!AllocateStorage(desc, flags, copy.buffer, copy.persistent)) {
+                return std::unexpected(Error{
+                    Error::Code::OutOfMemory,
+                    "Failed to allocate streaming buffer copies"
+                });
+            }
+        }
+    }
+    
+    return bufferObj;
+}
+
+void* OpenGL46Buffer::Map(size_t offset, size_t size, MapAccess access) {
+    if (const char* error = ValidateMapRequest(m_desc.size, offset, size, access)) {
+        LogError("%s", error);
+        return nullptr;
+    }
+    
+    FlushUploads();
+    if (m_persistentPtr != nullptr) {
+        // The first write of a frame moves a streaming buffer to a copy the
+        // GPU is done with. A map that reads gets the whole buffer carried
+        // over, which it then has to wait for.
+        bool idle = HasMapAccess(access, MapAccess::Unsynchronized);
+        if (HasMapAccess(access, MapAccess::Write)) {
+            const bool reads = HasMapAccess(access, MapAccess::Read);
+            idle |= BeginStreamingWrite(reads ? 0 : offset, reads ? 0 : size) && !reads;
+        }
+        if (!idle) {
+            WaitForGpu();
+        }
+        return static_cast<std::byte*>(m_persistentPtr) + offset;
+    }
+    
+    if (m_mappedPtr != nullptr) {
+        LogWarning("Buffer already mapped");
+        return m_mappedPtr;
+    }
+    
+    m_mappedPtr = glMapNamedBufferRange(m_buffer, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size),
+                                        GetGLMapAccess(access));
+    if (m_mappedPtr == nullptr) {
+        LogError("Failed to map buffer");
+        return nullptr;
+    }
+    m_mapOffset = offset;
+    m_mapSize = size;
+    m_mapAccess = access;
+    return m_mappedPtr;
+}
+
+void OpenGL46Buffer::FlushRange(size_t offset, size_t size) {
+    // Coherent persistent mappings need no flush
+    if (m_persistentPtr != nullptr) {
+        return;
+    }
+    if (m_mappedPtr == nullptr) {
+        LogError("FlushRange on a buffer that is not mapped");
+        return;
+    }
+    if (const char* error = ValidateFlushRange(m_mapOffset, m_mapSize, m_mapAccess, offset, size)) {
+        LogError("%s", error);
+        return;
+    }
+    
+    glFlushMappedNamedBufferRange(m_buffer, static_cast<GLintptr>(offset - m_mapOffset), static_cast<GLsizeiptr>(size));
+}
+
+void OpenGL46Buffer::Unmap() {
+    // Persistent mappings stay open for the lifetime of the buffer
+    if (m_mappedPtr == nullptr) {
+        return;
+    }
+    
+    glUnmapNamedBuffer(m_buffer);
+    m_mappedPtr = nullptr;
+}
+
+void OpenGL46Buffer::WaitForGpu() {
+    // Persistent mappings bypass the driver's implicit synchronization, so
+    // wait for everything submitted so far, uploads to this buffer included
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    GLenum status = GL_TIMEOUT_EXPIRED;
+    while (status == GL_TIMEOUT_EXPIRED) {
+        status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    }
+    glDeleteSync(fence);
+}
+
+void OpenGL46Buffer::Read(void* data, size_t size, size_t offset) {
+    if (offset + size > m_desc.size) {
+        LogError("Buffer read out of bounds");
+        return;
+    }
+    
+    FlushUploads();
+    glGetNamedBufferSubData(m_buffer, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+}
+
+} // namespace VRHI
@@ -0,0 +1,46 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "Backends/OpenGL33/OpenGL33Buffer.hpp"
+
+namespace VRHI {
+
+/// OpenGL 4.6 buffer implementation
+///
+/// Immutable storage (glNamedBufferStorage), mapped and read through direct
+/// state access. Host-visible buffers (everything but MemoryAccess::GpuOnly)
+/// are mapped once, persistently and coherently, at creation; Map() returns
+/// a pointer into that mapping, and FlushRange() and Unmap() do nothing.
+/// The driver does not synchronize persistent mappings, so Map() waits for
+/// the GPU to finish the work submitted so far unless the access includes
+/// MapAccess::Unsynchronized. Streaming buffers (BufferDesc::streaming)
+/// keep streamingCopies persistently mapped copies instead, rotated as in
+/// OpenGL33Buffer and fenced when the buffer moves on: the first write of a
+/// frame, by Map() or Update(), gets a copy the GPU is done with and only
+/// waits when the GPU is streamingCopies frames behind. Update() stages
+/// through the device's upload queue like OpenGL33Buffer, which writes the
+/// buffer by name on this profile. Immutable storage
+/// cannot be orphaned, so BufferStreaming::Orphan updates in place.
+class OpenGL46Buffer : public OpenGL33Buffer {
+public:
+    static std::expected<std::unique_ptr<Buffer>, Error>
+    Create(OpenGL33Device& device, const BufferDesc& desc);
+    
+    // Buffer interface
+    using OpenGL33Buffer::Map;
+    void* Map(size_t offset, size_t size, MapAccess access) override;
+    void FlushRange(size_t offset, size_t size) override;
+    void Unmap() override;
+    
+    void Read(void* data, size_t size, size_t offset = 0) override;
+    
+private:
+    using OpenGL33Buffer::OpenGL33Buffer;
+    
+    /// Wait for the GPU before the CPU touches the persistent mapping
+    void WaitForGpu();
+};
+
+} // namespace VRHI
@@ -0,0 +1,47 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "OpenGL46Device.hpp"
+#include "OpenGL46Backend.hpp"
+#include "OpenGL46Buffer.hpp"
+#include <glad/glad.h>
+
+namespace VRHI {
+
+OpenGL46Device::OpenGL46Device(const DeviceConfig& config, OpenGL46Backend* backend)
+    : OpenGL33Device(config, backend, GLDeviceProfile{450, true, true})
+{
+}
+
+std::expected<void, Error> OpenGL46Device::Initialize() {
+    // The base class reports a missing context; only the version is checked here
+    if (gladLoadGL()) {
+        if (!GLAD_GL_VERSION_4_5) {
+            return std::unexpected(Error{
+                Error::Code::UnsupportedFeature,
+                "OpenGL 4.5 or higher is required"
+            });
+        }
+        m_profile.glslVersion = GLAD_GL_VERSION_4_6 ? 460 : 450;
+    }
+    return OpenGL33Device::Initialize();
+}
+
+BackendType OpenGL46Device::GetBackendType() const noexcept {
+    return BackendType::OpenGL46;
+}
+
+BackendInfo OpenGL46Device::GetBackendInfo() const {
+    BackendInfo info = OpenGL33Device::GetBackendInfo();
+    info.type = BackendType::OpenGL46;
+    info.name = "OpenGL 4.6";
+    info.version = "4.6";
+    return info;
+}
+
+std::expected<std::unique_ptr<Buffer>, Error>
+OpenGL46Device::CreateBuffer(const BufferDesc& desc) {
+    return OpenGL46Buffer::Create(*this, desc);
+}
+
+} // namespace VRHI
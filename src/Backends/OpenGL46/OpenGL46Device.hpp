@@ -0,0 +1,34 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "Backends/OpenGL33/OpenGL33Device.hpp"
+
+namespace VRHI {
+
+class OpenGL46Backend;
+
+/// OpenGL 4.6 device implementation
+///
+/// An OpenGL33Device with the GL 4.x profile (compute, storage buffers,
+/// indirect draws) whose buffers use direct state access. Requires a 4.5
+/// context, the first version with DSA in core; shaders target GLSL 4.50 or
+/// 4.60 to match it.
+class OpenGL46Device : public OpenGL33Device {
+public:
+    OpenGL46Device(const DeviceConfig& config, OpenGL46Backend* backend);
+    
+    /// Fails with Error::Code::UnsupportedFeature if the context is older than 4.5
+    std::expected<void, Error> Initialize();
+    
+    // Device Information
+    BackendType GetBackendType() const noexcept override;
+    BackendInfo GetBackendInfo() const override;
+    
+    // Resource Creation
+    std::expected<std::unique_ptr<Buffer>, Error>
+    CreateBuffer(const BufferDesc& desc) override;
+};
+
+} // namespace VRHI
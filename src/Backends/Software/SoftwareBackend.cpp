@@ -0,0 +1,98 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "SoftwareBackend.hpp"
+#include "SoftwareDevice.hpp"
+#include <VRHI/BackendScoring.hpp>
+#include <VRHI/Logging.hpp>
+
+namespace VRHI {
+
+namespace {
+    /// Score of the backend when it meets the requirements; GPU backends
+    /// score from 0 to 100
+    constexpr float SoftwareScore = 1.0f;
+}
+
+SoftwareBackend::SoftwareBackend()
+    : m_features(SoftwareDevice::GetSupportedFeatures())
+{
+}
+
+SoftwareBackend::~SoftwareBackend() = default;
+
+BackendType SoftwareBackend::GetType() const noexcept {
+    return BackendType::Software;
+}
+
+std::string_view SoftwareBackend::GetName() const noexcept {
+    return "Software";
+}
+
+Version SoftwareBackend::GetVersion() const noexcept {
+    return Version{1, 0, 0, "1.0"};
+}
+
+std::expected<FeatureSet, Error> SoftwareBackend::GetSupportedFeatures() const {
+    return m_features;
+}
+
+bool SoftwareBackend::IsFeatureSupported(Feature feature) const noexcept {
+    switch (feature) {
+        case Feature::DebugMarkers:
+        case Feature::GPUValidation:
+            return false;
+        default:
+            return VRHI::IsFeatureSupported(m_features, feature);
+    }
+}
+
+float SoftwareBackend::CalculateScore(const FeatureRequirements& requirements) const {
+    for (const auto& feature : requirements.required) {
+        if (!IsFeatureSupported(feature)) {
+            return -1.0f;
+        }
+    }
+    return SoftwareScore;
+}
+
+std::expected<std::unique_ptr<Device>, Error>
+SoftwareBackend::CreateDevice(const DeviceConfig& config) {
+    if (config.windowHandle) {
+        LogWarning("The software backend has no swap chain; the window is not presented to");
+    }
+
+    auto device = std::make_unique<SoftwareDevice>(config);
+    auto initResult = device->Initialize();
+    if (!initResult) {
+        return std::unexpected(initResult.error());
+    }
+    return device;
+}
+
+} // namespace VRHI
+
+// Register the backend with the factory
+namespace {
+    struct SoftwareBackendRegistrar {
+        SoftwareBackendRegistrar() {
+            VRHI::BackendFactory::RegisterBackend(
+                VRHI::BackendType::Software,
+                []() -> std::unique_ptr<VRHI::IBackend> {
+                    return std::make_unique<VRHI::SoftwareBackend>();
+                }
+            );
+        }
+    };
+    static SoftwareBackendRegistrar s_softwareRegistrar;
+}
+
+// Export registration function for explicit initialization
+namespace VRHI {
+namespace detail {
+    void RegisterSoftwareBackend() {
+        // Force the static registrar to be instantiated
+        (void)&s_softwareRegistrar;
+    }
+}
+}
@@ -0,0 +1,38 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/Backend.hpp>
+#include <memory>
+
+namespace VRHI {
+
+/// Software backend implementation
+///
+/// Renders on the CPU and is available everywhere, but scores far below
+/// every GPU backend, so Auto only picks it when no GPU backend can run.
+/// Request BackendType::Software for deterministic headless output.
+class SoftwareBackend : public IBackend {
+public:
+    SoftwareBackend();
+    ~SoftwareBackend() override;
+
+    // IBackend implementation
+    BackendType GetType() const noexcept override;
+    std::string_view GetName() const noexcept override;
+    Version GetVersion() const noexcept override;
+
+    std::expected<FeatureSet, Error> GetSupportedFeatures() const override;
+    bool IsFeatureSupported(Feature feature) const noexcept override;
+
+    float CalculateScore(const FeatureRequirements& requirements) const override;
+
+    std::expected<std::unique_ptr<Device>, Error>
+    CreateDevice(const DeviceConfig& config) override;
+
+private:
+    FeatureSet m_features;
+};
+
+} // namespace VRHI
@@ -0,0 +1,82 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "SoftwareBuffer.hpp"
+#include <VRHI/Logging.hpp>
+#include <cstring>
+#include <new>
+
+namespace VRHI {
+
+SoftwareBuffer::SoftwareBuffer(const BufferDesc& desc, std::unique_ptr<std::byte[]> data)
+    : m_data(std::move(data))
+    , m_size(desc.size)
+    , m_usage(desc.usage)
+{
+}
+
+std::expected<std::unique_ptr<Buffer>, Error>
+SoftwareBuffer::Create(const BufferDesc& desc) {
+    if (desc.size == 0) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Buffer size must be greater than 0"
+        });
+    }
+
+    // Zeroed, so unwritten memory reads the same on every run
+    std::unique_ptr<std::byte[]> data(new (std::nothrow) std::byte[desc.size]());
+    if (!data) {
+        return std::unexpected(Error{
+            Error::Code::OutOfMemory,
+            "Failed to allocate buffer memory"
+        });
+    }
+    if (desc.initialData) {
+        std::memcpy(data.get(), desc.initialData, desc.size);
+    }
+
+    return std::unique_ptr<Buffer>(new SoftwareBuffer(desc, std::move(data)));
+}
+
+void* SoftwareBuffer::Map() {
+    return Map(0, m_size);
+}
+
+void* SoftwareBuffer::Map(size_t offset, size_t size) {
+    if (offset > m_size || size > m_size - offset) {
+        LogError("SoftwareBuffer: Map range out of bounds");
+        return nullptr;
+    }
+    if (m_mapped) {
+        LogWarning("SoftwareBuffer: Buffer already mapped");
+    }
+    m_mapped = true;
+    return m_data.get() + offset;
+}
+
+void SoftwareBuffer::Unmap() {
+    if (!m_mapped) {
+        LogWarning("SoftwareBuffer: Buffer not mapped");
+        return;
+    }
+    m_mapped = false;
+}
+
+void SoftwareBuffer::Update(const void* data, size_t size, size_t offset) {
+    if (offset > m_size || size > m_size - offset) {
+        LogError("SoftwareBuffer: Update out of bounds");
+        return;
+    }
+    std::memcpy(m_data.get() + offset, data, size);
+}
+
+void SoftwareBuffer::Read(void* data, size_t size, size_t offset) {
+    if (offset > m_size || size > m_size - offset) {
+        LogError("SoftwareBuffer: Read out of bounds");
+        return;
+    }
+    std::memcpy(data, m_data.get() + offset, size);
+}
+
+} // namespace VRHI
@@ -0,0 +1,49 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/VRHI.hpp>
+#include <VRHI/Resources.hpp>
+#include <cstddef>
+#include <expected>
+#include <memory>
+
+namespace VRHI {
+
+/// Software buffer implementation
+///
+/// Contents live in host memory that shaders address directly. Submissions
+/// execute before Submit() returns, so Map(), Update() and Read() never
+/// wait and every memory access mode behaves like CpuOnly.
+class SoftwareBuffer : public Buffer {
+public:
+    ~SoftwareBuffer() override = default;
+
+    static std::expected<std::unique_ptr<Buffer>, Error>
+    Create(const BufferDesc& desc);
+
+    // Buffer interface
+    size_t GetSize() const noexcept override { return m_size; }
+    BufferUsage GetUsage() const noexcept override { return m_usage; }
+
+    void* Map() override;
+    void* Map(size_t offset, size_t size) override;
+    void Unmap() override;
+
+    void Update(const void* data, size_t size, size_t offset = 0) override;
+    void Read(void* data, size_t size, size_t offset = 0) override;
+
+    // Software-specific
+    std::byte* GetData() const noexcept { return m_data.get(); }
+
+private:
+    SoftwareBuffer(const BufferDesc& desc, std::unique_ptr<std::byte[]> data);
+
+    std::unique_ptr<std::byte[]> m_data;
+    size_t m_size;
+    BufferUsage m_usage;
+    bool m_mapped = false;
+};
+
+} // namespace VRHI
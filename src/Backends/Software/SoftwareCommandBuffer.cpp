@@ -0,0 +1,731 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "SoftwareCommandBuffer.hpp"
+#include "SoftwareDevice.hpp"
+#include "SoftwareBuffer.hpp"
+#include "SoftwareTexture.hpp"
+#include "SoftwareSampler.hpp"
+#include "SoftwarePipeline.hpp"
+#include "SoftwareRenderPass.hpp"
+#include "SoftwareFramebuffer.hpp"
+#include "SoftwareFormatUtils.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "Core/ThreadPool.hpp"
+#include <VRHI/Logging.hpp>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+namespace VRHI {
+
+namespace {
+    /// Executes a recorded command stream on the CPU.
+    /// Mirrors the state the GPU backends translate: resource bindings,
+    /// pipelines, vertex input and dynamic state are tracked as commands set
+    /// them and captured by each draw. Draws go to the rasterizer, which
+    /// defers them until the tiles are rendered; anything that reads or
+    /// writes attachments outside of draws flushes it first. Transfers and
+    /// dispatches happen on the spot.
+    class CommandExecutor {
+    public:
+        explicit CommandExecutor(SoftwareDevice& device)
+            : m_rasterizer(device.GetRasterizer())
+            , m_threads(device.GetThreadPool())
+        {
+        }
+
+        void Execute(const CommandStream& stream) {
+            for (const CommandHeader& header : stream) {
+                Dispatch(header);
+            }
+            if (m_inPass) {
+                LogWarning("Command buffer ends inside a render pass; ending it");
+                EndRenderPass();
+            }
+        }
+
+        uint64_t GetDrawCalls() const noexcept { return m_drawCalls; }
+
+    private:
+        /// Secondaries that Execute() inlines; others are skipped
+        static const RecordingCommandBuffer* GetReplayable(CommandBuffer* secondary) noexcept {
+            auto* recorded = static_cast<const RecordingCommandBuffer*>(secondary);
+            return recorded->GetState() == CommandBufferState::Recording ? nullptr : recorded;
+        }
+
+        void Dispatch(const CommandHeader& header) {
+            switch (header.type) {
+                case CommandType::BeginRenderPass:
+                    BeginRenderPass(header.As<CmdBeginRenderPass>());
+                    break;
+                case CommandType::EndRenderPass:
+                    if (m_inPass) {
+                        EndRenderPass();
+                    }
+                    break;
+                case CommandType::BindPipeline:
+                    BindPipeline(header.As<CmdBindPipeline>());
+                    break;
+                case CommandType::BindVertexBuffers:
+                    BindVertexBuffers(header.As<CmdBindVertexBuffers>());
+                    break;
+                case CommandType::BindIndexBuffer: {
+                    const auto& cmd = header.As<CmdBindIndexBuffer>();
+                    if (!cmd.buffer) {
+                        LogWarning("BindIndexBuffer called with null buffer");
+                        break;
+                    }
+                    m_indexBuffer = static_cast<SoftwareBuffer*>(cmd.buffer);
+                    m_indexOffset = cmd.offset;
+                    m_use16BitIndices = cmd.use16BitIndices;
+                    break;
+                }
+                case CommandType::BindUniformBuffer: {
+                    const auto& cmd = header.As<CmdBindUniformBuffer>();
+                    BindBuffer(cmd.binding, cmd.buffer, cmd.offset, cmd.size);
+                    break;
+                }
+                case CommandType::BindStorageBuffer: {
+                    const auto& cmd = header.As<CmdBindStorageBuffer>();
+                    BindBuffer(cmd.binding, cmd.buffer, cmd.offset, cmd.size);
+                    break;
+                }
+                case CommandType::BindTexture:
+                    BindTexture(header.As<CmdBindTexture>());
+                    break;
+                case CommandType::PushConstants: {
+                    const auto& cmd = header.As<CmdPushConstants>();
+                    std::ranges::copy(cmd.GetData(), m_state.bindings.pushConstants + cmd.offset);
+                    break;
+                }
+                case CommandType::SetViewports: {
+                    // One viewport, as on OpenGL
+                    auto viewports = header.As<CmdSetViewports>().GetViewports();
+                    if (!viewports.empty()) {
+                        m_viewportSet = true;
+                        m_state.viewport = viewports[0];
+                    }
+                    break;
+                }
+                case CommandType::SetScissors: {
+                    auto scissors = header.As<CmdSetScissors>().GetScissors();
+                    if (!scissors.empty()) {
+                        m_scissorSet = true;
+                        m_state.scissor = scissors[0];
+                    }
+                    break;
+                }
+                case CommandType::SetLineWidth:
+                    m_state.lineWidth = header.As<CmdSetLineWidth>().width;
+                    break;
+                case CommandType::SetBlendConstants:
+                    std::ranges::copy(header.As<CmdSetBlendConstants>().constants, m_state.blendConstants);
+                    break;
+                case CommandType::SetDepthBias: {
+                    const auto& cmd = header.As<CmdSetDepthBias>();
+                    m_state.depthBias[0] = cmd.constantFactor;
+                    m_state.depthBias[1] = cmd.clamp;
+                    m_state.depthBias[2] = cmd.slopeFactor;
+                    break;
+                }
+                case CommandType::SetDepthBounds: {
+                    const auto& cmd = header.As<CmdSetDepthBounds>();
+                    m_state.depthBounds[0] = cmd.minDepth;
+                    m_state.depthBounds[1] = cmd.maxDepth;
+                    break;
+                }
+                case CommandType::SetStencilCompareMask: {
+                    const auto& cmd = header.As<CmdSetStencilValue>();
+                    m_state.compareMask[cmd.frontFace ? 0 : 1] = cmd.value;
+                    break;
+                }
+                case CommandType::SetStencilWriteMask: {
+                    const auto& cmd = header.As<CmdSetStencilValue>();
+                    m_state.writeMask[cmd.frontFace ? 0 : 1] = cmd.value;
+                    break;
+                }
+                case CommandType::SetStencilReference: {
+                    const auto& cmd = header.As<CmdSetStencilValue>();
+                    m_state.reference[cmd.frontFace ? 0 : 1] = cmd.value;
+                    break;
+                }
+                case CommandType::Draw: {
+                    const DrawParams& params = header.As<CmdDraw>().params;
+                    if (FlushDraw()) {
+                        Draw(params, 0);
+                    }
+                    break;
+                }
+                case CommandType::DrawIndexed: {
+                    const DrawIndexedParams& params = header.As<CmdDrawIndexed>().params;
+                    if (FlushDraw()) {
+                        DrawIndexed(params, 0);
+                    }
+                    break;
+                }
+                case CommandType::DrawIndirect:
+                    DrawIndirect(header.As<CmdDrawIndirect>(), false);
+                    break;
+                case CommandType::DrawIndexedIndirect:
+                    DrawIndirect(header.As<CmdDrawIndexedIndirect>(), true);
+                    break;
+                case CommandType::Dispatch: {
+                    const DispatchParams& params = header.As<CmdDispatch>().params;
+                    if (FlushDispatch()) {
+                        RunDispatch(params);
+                    }
+                    break;
+                }
+                case CommandType::DispatchIndirect: {
+                    const auto& cmd = header.As<CmdDispatchIndirect>();
+                    if (!cmd.buffer) {
+                        LogWarning("DispatchIndirect called with null buffer");
+                        break;
+                    }
+                    if (!FlushDispatch()) {
+                        break;
+                    }
+                    DispatchParams params;
+                    if (!ReadParams(*cmd.buffer, cmd.offset, params)) {
+                        LogWarning("DispatchIndirect reads past the end of its buffer; skipped");
+                        break;
+                    }
+                    RunDispatch(params);
+                    break;
+                }
+                case CommandType::ClearColorAttachment: {
+                    const auto& cmd = header.As<CmdClearColorAttachment>();
+                    if (RequireInsidePass()) {
+                        m_rasterizer.ClearColor(cmd.attachment, cmd.color, cmd.rect);
+                    }
+                    break;
+                }
+                case CommandType::ClearDepthStencilAttachment: {
+                    const auto& cmd = header.As<CmdClearDepthStencilAttachment>();
+                    if (RequireInsidePass()) {
+                        m_rasterizer.ClearDepthStencil(true, true, cmd.value, cmd.rect);
+                    }
+                    break;
+                }
+                case CommandType::CopyBuffer:
+                    CopyBuffer(header.As<CmdCopyBuffer>());
+                    break;
+                case CommandType::CopyBufferToTexture:
+                    CopyBufferToTexture(header.As<CmdCopyBufferToTexture>());
+                    break;
+                case CommandType::CopyTextureToBuffer:
+                    CopyTextureToBuffer(header.As<CmdCopyTextureToBuffer>());
+                    break;
+                case CommandType::CopyTexture:
+                    CopyTexture(header.As<CmdCopyTexture>());
+                    break;
+                case CommandType::PipelineBarrier:
+                    // Every command has finished before the next one starts
+                    break;
+                case CommandType::BeginDebugMarker:
+                case CommandType::EndDebugMarker:
+                case CommandType::InsertDebugMarker:
+                    break;
+                case CommandType::ExecuteCommands:
+                    // Secondaries are inlined from their own streams, so a
+                    // bundle recorded once can be executed every frame
+                    for (CommandBuffer* secondary : header.As<CmdExecuteCommands>().GetCommandBuffers()) {
+                        const RecordingCommandBuffer* recorded = GetReplayable(secondary);
+                        if (!recorded) {
+                            LogWarning("Skipping a secondary command buffer that is still recording");
+                            continue;
+                        }
+                        for (const CommandHeader& inner : recorded->GetCommandStream()) {
+                            Dispatch(inner);
+                        }
+                    }
+                    break;
+            }
+        }
+
+        /// Work outside render passes; a warning inside one
+        bool RequireOutsidePass(const char* command) {
+            if (m_inPass) {
+                LogWarning("%s is not allowed inside a render pass; skipped", command);
+                return false;
+            }
+            return true;
+        }
+
+        bool RequireInsidePass() {
+            if (!m_inPass) {
+                LogWarning("Attachment clears are only allowed inside a render pass; skipped");
+                return false;
+            }
+            return true;
+        }
+
+        /// Indirect parameters at `offset`, if the buffer holds them
+        template<typename T>
+        static bool ReadParams(Buffer& buffer, uint64_t offset, T& params) {
+            if (offset > buffer.GetSize() || buffer.GetSize() - offset < sizeof(T)) {
+                return false;
+            }
+            std::memcpy(&params, static_cast<SoftwareBuffer&>(buffer).GetData() + offset, sizeof(T));
+            return true;
+        }
+
+        // ====================================================================
+        // Render Passes
+        // ====================================================================
+
+        void BeginRenderPass(const CmdBeginRenderPass& cmd) {
+            if (m_inPass) {
+                LogWarning("BeginRenderPass inside a render pass; ending the previous one");
+                EndRenderPass();
+            }
+            auto* framebuffer = static_cast<const SoftwareFramebuffer*>(cmd.framebuffer);
+            if (!framebuffer) {
+                LogWarning("The software backend has no swap chain; a render pass without a framebuffer is skipped");
+                return;
+            }
+
+            // Confine the render area to the framebuffer
+            const int32_t x = std::max(cmd.renderArea.x, 0);
+            const int32_t y = std::max(cmd.renderArea.y, 0);
+            const auto right = std::min<int64_t>(int64_t(cmd.renderArea.x) + cmd.renderArea.width, framebuffer->GetWidth());
+            const auto bottom = std::min<int64_t>(int64_t(cmd.renderArea.y) + cmd.renderArea.height, framebuffer->GetHeight());
+            m_renderArea = Rect2D{x, y, static_cast<uint32_t>(std::max<int64_t>(right - x, 0)),
+                                  static_cast<uint32_t>(std::max<int64_t>(bottom - y, 0))};
+            m_rasterizer.Begin(*framebuffer, m_renderArea);
+            m_inPass = true;
+
+            // Clear load ops, confined to the render area
+            if (auto* renderPass = static_cast<const SoftwareRenderPass*>(cmd.renderPass)) {
+                auto clearValues = cmd.GetClearValues();
+                const auto& descs = renderPass->GetAttachments();
+                const auto& attachments = framebuffer->GetAttachments();
+                uint32_t colorIndex = 0;
+                for (size_t i = 0; i < attachments.size(); ++i) {
+                    const AttachmentDesc desc = i < descs.size() ? descs[i] : AttachmentDesc{};
+                    const ClearValue value = i < clearValues.size() ? clearValues[i] : ClearValue{};
+                    const TextureFormat format = attachments[i]->GetFormat();
+                    if (!SoftwareFormatUtils::IsDepthFormat(format)) {
+                        if (desc.loadOp == AttachmentLoadOp::Clear) {
+                            m_rasterizer.ClearColor(colorIndex, value.color, m_renderArea);
+                        }
+                        ++colorIndex;
+                        continue;
+                    }
+                    const bool clearDepth = desc.loadOp == AttachmentLoadOp::Clear;
+                    const bool clearStencil = SoftwareFormatUtils::HasStencil(format) &&
+                                              desc.stencilLoadOp == AttachmentLoadOp::Clear;
+                    if (clearDepth || clearStencil) {
+                        m_rasterizer.ClearDepthStencil(clearDepth, clearStencil, value.depthStencil, m_renderArea);
+                    }
+                }
+            }
+
+            // Draw where the pass renders until told otherwise
+            if (!m_viewportSet) {
+                m_state.viewport = Viewport{float(m_renderArea.x), float(m_renderArea.y),
+                                            float(m_renderArea.width), float(m_renderArea.height), 0.0f, 1.0f};
+            }
+            if (!m_scissorSet) {
+                m_state.scissor = m_renderArea;
+            }
+        }
+
+        void EndRenderPass() {
+            m_rasterizer.End();
+            m_inPass = false;
+        }
+
+        // ====================================================================
+        // State
+        // ====================================================================
+
+        void BindPipeline(const CmdBindPipeline& cmd) {
+            auto* pipeline = static_cast<SoftwarePipeline*>(cmd.pipeline);
+            if (!pipeline) {
+                return;
+            }
+            if (pipeline->GetType() == PipelineType::Compute) {
+                m_computePipeline = pipeline;
+                return;
+            }
+            if (pipeline != m_graphicsPipeline) {
+                m_graphicsPipeline = pipeline;
+                m_pipelineStateDirty = true;
+            }
+        }
+
+        void BindVertexBuffers(const CmdBindVertexBuffers& cmd) {
+            auto buffers = cmd.GetBuffers();
+            auto offsets = cmd.GetOffsets();
+            for (size_t i = 0; i < buffers.size(); ++i) {
+                const uint32_t binding = cmd.firstBinding + static_cast<uint32_t>(i);
+                if (binding >= SoftwareDrawCall::MaxVertexBuffers) {
+                    LogWarning("BindVertexBuffers binding index exceeds the supported vertex bindings");
+                    break;
+                }
+                if (!buffers[i]) {
+                    continue;
+                }
+                auto* buffer = static_cast<SoftwareBuffer*>(buffers[i]);
+                const uint64_t offset = std::min<uint64_t>(offsets[i], buffer->GetSize());
+                m_vertexBuffers[binding] = {buffer->GetData() + offset, buffer->GetSize() - offset};
+            }
+        }
+
+        void BindBuffer(uint32_t binding, Buffer* buffer, uint64_t offset, uint64_t size) {
+            if (!buffer) {
+                LogWarning("Binding a null buffer");
+                return;
+            }
+            if (binding >= SoftwareBindings::MaxBindings) {
+                LogWarning("Binding %u exceeds the %u bindings of the software backend", binding,
+                           SoftwareBindings::MaxBindings);
+                return;
+            }
+            offset = std::min<uint64_t>(offset, buffer->GetSize());
+            const uint64_t range = size == 0 ? buffer->GetSize() - offset : std::min(size, buffer->GetSize() - offset);
+            m_state.bindings.buffers[binding] = {static_cast<SoftwareBuffer*>(buffer)->GetData() + offset, range};
+        }
+
+        void BindTexture(const CmdBindTexture& cmd) {
+            if (!cmd.texture) {
+                LogWarning("BindTexture called with null texture");
+                return;
+            }
+            if (cmd.binding >= SoftwareBindings::MaxBindings) {
+                LogWarning("Binding %u exceeds the %u bindings of the software backend", cmd.binding,
+                           SoftwareBindings::MaxBindings);
+                return;
+            }
+            const SoftwareSampler& sampler = cmd.sampler ? *static_cast<const SoftwareSampler*>(cmd.sampler)
+                                                         : SoftwareSampler::GetDefault();
+            m_state.bindings.images[cmd.binding] = {static_cast<SoftwareTexture*>(cmd.texture), &sampler.GetDesc()};
+        }
+
+        /// Set the state the bound graphics pipeline does not leave to commands
+        void ApplyPipelineState(const SoftwarePipeline& pipeline) {
+            const GraphicsPipelineDesc& desc = pipeline.GetGraphicsDesc();
+            if (!pipeline.IsDynamic(DynamicState::LineWidth)) {
+                m_state.lineWidth = desc.rasterization.lineWidth;
+            }
+            if (!pipeline.IsDynamic(DynamicState::DepthBias)) {
+                m_state.depthBias[0] = desc.rasterization.depthBiasConstantFactor;
+                m_state.depthBias[1] = desc.rasterization.depthBiasClamp;
+                m_state.depthBias[2] = desc.rasterization.depthBiasSlopeFactor;
+            }
+            if (!pipeline.IsDynamic(DynamicState::BlendConstants)) {
+                std::ranges::copy(desc.colorBlend.blendConstants, m_state.blendConstants);
+            }
+            if (!pipeline.IsDynamic(DynamicState::DepthBounds)) {
+                m_state.depthBounds[0] = desc.depthStencil.minDepthBounds;
+                m_state.depthBounds[1] = desc.depthStencil.maxDepthBounds;
+            }
+            const StencilOpState* faces[2] = {&desc.depthStencil.front, &desc.depthStencil.back};
+            for (int face = 0; face < 2; ++face) {
+                if (!pipeline.IsDynamic(DynamicState::StencilCompareMask)) {
+                    m_state.compareMask[face] = faces[face]->compareMask;
+                }
+                if (!pipeline.IsDynamic(DynamicState::StencilWriteMask)) {
+                    m_state.writeMask[face] = faces[face]->writeMask;
+                }
+                if (!pipeline.IsDynamic(DynamicState::StencilReference)) {
+                    m_state.reference[face] = faces[face]->reference;
+                }
+            }
+        }
+
+        /// Whether everything `pipeline` reads is bound
+        bool CheckBindings(const SoftwarePipeline& pipeline) const {
+            for (uint32_t binding = 0; binding < SoftwareBindings::MaxBindings; ++binding) {
+                const bool missingBuffer = ((pipeline.GetBufferBindings() >> binding) & 1u) &&
+                                           !m_state.bindings.buffers[binding].data;
+                const bool missingImage = ((pipeline.GetImageBindings() >> binding) & 1u) &&
+                                          !m_state.bindings.images[binding].texture;
+                if (missingBuffer || missingImage) {
+                    LogWarning("Nothing bound at binding %u, which the pipeline uses; skipped", binding);
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // ====================================================================
+        // Draws and Dispatches
+        // ====================================================================
+
+        /// Check what a draw needs
+        /// @return false if the draw must be skipped
+        bool FlushDraw() {
+            if (!m_inPass) {
+                LogWarning("Draws are only allowed inside a render pass; skipped");
+                return false;
+            }
+            if (!m_graphicsPipeline) {
+                LogWarning("Draw without a graphics pipeline; skipped");
+                return false;
+            }
+            if (m_pipelineStateDirty) {
+                ApplyPipelineState(*m_graphicsPipeline);
+                m_pipelineStateDirty = false;
+            }
+            m_state.pipeline = m_graphicsPipeline;
+            return CheckBindings(*m_graphicsPipeline);
+        }
+
+        bool FlushDispatch() {
+            if (!RequireOutsidePass("Dispatch")) {
+                return false;
+            }
+            if (!m_computePipeline) {
+                LogWarning("Dispatch without a compute pipeline; skipped");
+                return false;
+            }
+            return CheckBindings(*m_computePipeline);
+        }
+
+        SoftwareDrawCall GetDrawCall() const {
+            SoftwareDrawCall call;
+            std::ranges::copy(m_vertexBuffers, call.vertexBuffers);
+            return call;
+        }
+
+        void Draw(const DrawParams& params, uint32_t drawIndex) {
+            SoftwareDrawCall call = GetDrawCall();
+            call.count = params.vertexCount;
+            call.instanceCount = params.instanceCount;
+            call.first = params.firstVertex;
+            call.firstInstance = params.firstInstance;
+            call.drawIndex = drawIndex;
+            m_rasterizer.Draw(m_state, call);
+            ++m_drawCalls;
+        }
+
+        void DrawIndexed(const DrawIndexedParams& params, uint32_t drawIndex) {
+            if (!m_indexBuffer) {
+                LogWarning("DrawIndexed without an index buffer; skipped");
+                return;
+            }
+            const uint64_t indexSize = m_use16BitIndices ? 2 : 4;
+            const uint64_t offset = std::min<uint64_t>(m_indexOffset + uint64_t(params.firstIndex) * indexSize,
+                                                       m_indexBuffer->GetSize());
+            SoftwareDrawCall call = GetDrawCall();
+            call.count = params.indexCount;
+            call.instanceCount = params.instanceCount;
+            call.first = params.firstIndex;
+            call.firstInstance = params.firstInstance;
+            call.vertexOffset = params.vertexOffset;
+            call.drawIndex = drawIndex;
+            call.indices = m_indexBuffer->GetData() + offset;
+            call.indexBytes = m_indexBuffer->GetSize() - offset;
+            call.use16BitIndices = m_use16BitIndices;
+            m_rasterizer.Draw(m_state, call);
+            ++m_drawCalls;
+        }
+
+        /// Issue the draws of an indirect command in order; parameters past
+        /// the end of the buffer end it
+        void DrawIndirect(const CmdDrawIndirectBase& cmd, bool indexed) {
+            if (!cmd.buffer || cmd.drawCount == 0 || !FlushDraw()) {
+                return;
+            }
+            const uint32_t stride = cmd.stride != 0 ? cmd.stride
+                : static_cast<uint32_t>(indexed ? sizeof(DrawIndexedParams) : sizeof(DrawParams));
+            for (uint32_t i = 0; i < cmd.drawCount; ++i) {
+                const uint64_t offset = cmd.offset + uint64_t(i) * stride;
+                bool read;
+                if (indexed) {
+                    DrawIndexedParams params;
+                    if ((read = ReadParams(*cmd.buffer, offset, params))) {
+                        DrawIndexed(params, i);
+                    }
+                } else {
+                    DrawParams params;
+                    if ((read = ReadParams(*cmd.buffer, offset, params))) {
+                        Draw(params, i);
+                    }
+                }
+                if (!read) {
+                    LogWarning("Indirect draw %u reads past the end of its buffer; skipped", i);
+                    break;
+                }
+            }
+        }
+
+        /// Run the workgroups of a dispatch across the worker threads, each
+        /// with its own zeroed shared memory
+        void RunDispatch(const DispatchParams& params) {
+            SoftwarePipeline& pipeline = *m_computePipeline;
+            const SoftwareShaderProgram& program = *pipeline.GetComputeProgram();
+            const SoftwarePipeline::Builtins& builtins = pipeline.GetBuiltins();
+            const uint32_t* size = program.GetWorkgroupSize();
+            const uint32_t laneCount = size[0] * size[1] * size[2];
+            const uint64_t groupCount = uint64_t(params.groupCountX) * params.groupCountY * params.groupCountZ;
+            if (groupCount == 0 || groupCount > UINT32_MAX) {
+                return;
+            }
+
+            m_sharedMemory.resize(m_threads.GetThreadCount());
+            for (auto& shared : m_sharedMemory) {
+                shared.resize(program.GetSharedMemorySize());
+            }
+
+            const auto writeVector = [](std::byte* memory, int32_t offset, uint32_t x, uint32_t y, uint32_t z) {
+                if (offset >= 0) {
+                    const uint32_t words[3] = {x, y, z};
+                    std::memcpy(memory + offset, words, sizeof(words));
+                }
+            };
+
+            const SoftwareBindings& bindings = m_state.bindings;
+            m_threads.ParallelFor(static_cast<uint32_t>(groupCount), [&](uint32_t group, uint32_t thread) {
+                const uint32_t groupX = group % params.groupCountX;
+                const uint32_t groupY = group / params.groupCountX % params.groupCountY;
+                const uint32_t groupZ = group / params.groupCountX / params.groupCountY;
+
+                SoftwareShaderContext& context = pipeline.GetContext(2, thread);
+                context.ResetInvocationMemory(laneCount);
+                for (uint32_t lane = 0; lane < laneCount; ++lane) {
+                    const uint32_t localX = lane % size[0];
+                    const uint32_t localY = lane / size[0] % size[1];
+                    const uint32_t localZ = lane / size[0] / size[1];
+                    std::byte* memory = context.GetInvocationMemory(lane);
+                    writeVector(memory, builtins.localInvocationId, localX, localY, localZ);
+                    writeVector(memory, builtins.workgroupId, groupX, groupY, groupZ);
+                    writeVector(memory, builtins.numWorkgroups, params.groupCountX, params.groupCountY,
+                                params.groupCountZ);
+                    writeVector(memory, builtins.globalInvocationId, groupX * size[0] + localX,
+                                groupY * size[1] + localY, groupZ * size[2] + localZ);
+                    if (builtins.localInvocationIndex >= 0) {
+                        std::memcpy(memory + builtins.localInvocationIndex, &lane, sizeof(lane));
+                    }
+                }
+
+                std::vector<std::byte>& shared = m_sharedMemory[thread];
+                std::ranges::fill(shared, std::byte{0});
+                context.Run(bindings, laneCount, shared.data());
+            });
+        }
+
+        // ====================================================================
+        // Transfers
+        // ====================================================================
+
+        void CopyBuffer(const CmdCopyBuffer& cmd) {
+            if (!cmd.src || !cmd.dst || !RequireOutsidePass("CopyBuffer")) {
+                return;
+            }
+            if (cmd.srcOffset > cmd.src->GetSize() || cmd.src->GetSize() - cmd.srcOffset < cmd.size ||
+                cmd.dstOffset > cmd.dst->GetSize() || cmd.dst->GetSize() - cmd.dstOffset < cmd.size) {
+                LogWarning("CopyBuffer out of bounds; skipped");
+                return;
+            }
+            std::memmove(static_cast<SoftwareBuffer*>(cmd.dst)->GetData() + cmd.dstOffset,
+                         static_cast<SoftwareBuffer*>(cmd.src)->GetData() + cmd.srcOffset, cmd.size);
+        }
+
+        /// The whole layer of a mip level, tightly packed from the buffer start
+        void CopyBufferToTexture(const CmdCopyBufferToTexture& cmd) {
+            if (!cmd.src || !cmd.dst || !RequireOutsidePass("CopyBufferToTexture")) {
+                return;
+            }
+            const auto* texture = static_cast<const SoftwareTexture*>(cmd.dst);
+            if (cmd.mipLevel >= texture->GetMipLevels() || cmd.arrayLayer >= texture->GetLayerCount() ||
+                cmd.src->GetSize() < texture->GetSubresourceSize(cmd.mipLevel)) {
+                LogWarning("CopyBufferToTexture out of bounds; skipped");
+                return;
+            }
+            std::memcpy(texture->GetSubresource(cmd.mipLevel, cmd.arrayLayer),
+                        static_cast<SoftwareBuffer*>(cmd.src)->GetData(), texture->GetSubresourceSize(cmd.mipLevel));
+        }
+
+        void CopyTextureToBuffer(const CmdCopyTextureToBuffer& cmd) {
+            if (!cmd.src || !cmd.dst || !RequireOutsidePass("CopyTextureToBuffer")) {
+                return;
+            }
+            const auto* texture = static_cast<const SoftwareTexture*>(cmd.src);
+            if (cmd.mipLevel >= texture->GetMipLevels() || cmd.arrayLayer >= texture->GetLayerCount() ||
+                cmd.dst->GetSize() < texture->GetSubresourceSize(cmd.mipLevel)) {
+                LogWarning("CopyTextureToBuffer out of bounds; skipped");
+                return;
+            }
+            std::memcpy(static_cast<SoftwareBuffer*>(cmd.dst)->GetData(),
+                        texture->GetSubresource(cmd.mipLevel, cmd.arrayLayer), texture->GetSubresourceSize(cmd.mipLevel));
+        }
+
+        /// The extent both subresources have in common
+        void CopyTexture(const CmdCopyTexture& cmd) {
+            if (!cmd.src || !cmd.dst || !RequireOutsidePass("CopyTexture")) {
+                return;
+            }
+            const auto* src = static_cast<const SoftwareTexture*>(cmd.src);
+            const auto* dst = static_cast<const SoftwareTexture*>(cmd.dst);
+            if (src == dst || src->GetTexelSize() != dst->GetTexelSize() ||
+                cmd.srcMipLevel >= src->GetMipLevels() || cmd.srcArrayLayer >= src->GetLayerCount() ||
+                cmd.dstMipLevel >= dst->GetMipLevels() || cmd.dstArrayLayer >= dst->GetLayerCount()) {
+                LogWarning("CopyTexture between invalid subresources; skipped");
+                return;
+            }
+
+            const uint32_t width = std::min(src->GetMipWidth(cmd.srcMipLevel), dst->GetMipWidth(cmd.dstMipLevel));
+            const uint32_t height = std::min(src->GetMipHeight(cmd.srcMipLevel), dst->GetMipHeight(cmd.dstMipLevel));
+            const uint32_t depth = std::min(src->GetMipDepth(cmd.srcMipLevel), dst->GetMipDepth(cmd.dstMipLevel));
+            const size_t texelSize = src->GetTexelSize();
+            const size_t srcRow = src->GetMipWidth(cmd.srcMipLevel) * texelSize;
+            const size_t dstRow = dst->GetMipWidth(cmd.dstMipLevel) * texelSize;
+            const size_t srcSlice = srcRow * src->GetMipHeight(cmd.srcMipLevel);
+            const size_t dstSlice = dstRow * dst->GetMipHeight(cmd.dstMipLevel);
+            const std::byte* from = src->GetSubresource(cmd.srcMipLevel, cmd.srcArrayLayer);
+            std::byte* to = dst->GetSubresource(cmd.dstMipLevel, cmd.dstArrayLayer);
+            for (uint32_t z = 0; z < depth; ++z) {
+                for (uint32_t y = 0; y < height; ++y) {
+                    std::memcpy(to + z * dstSlice + y * dstRow, from + z * srcSlice + y * srcRow, width * texelSize);
+                }
+            }
+        }
+
+        SoftwareRasterizer& m_rasterizer;
+        ThreadPool& m_threads;
+
+        uint64_t m_drawCalls = 0;
+
+        // Current render pass
+        bool m_inPass = false;
+        Rect2D m_renderArea{};
+
+        // Pipelines as bound by commands
+        SoftwarePipeline* m_graphicsPipeline = nullptr;
+        SoftwarePipeline* m_computePipeline = nullptr;
+        bool m_pipelineStateDirty = false;
+
+        // Vertex input
+        SoftwareDrawCall::VertexBuffer m_vertexBuffers[SoftwareDrawCall::MaxVertexBuffers];
+        const SoftwareBuffer* m_indexBuffer = nullptr;
+        uint64_t m_indexOffset = 0;
+        bool m_use16BitIndices = false;
+
+        // Bindings and dynamic state, captured by each draw; viewport and
+        // scissor follow the render area until set
+        SoftwareDrawState m_state;
+        bool m_viewportSet = false;
+        bool m_scissorSet = false;
+
+        // Workgroup shared memory of each thread
+        std::vector<std::vector<std::byte>> m_sharedMemory;
+    };
+} // anonymous namespace
+
+void SoftwareCommandBuffer::Execute(SoftwareDevice& device) {
+    if (m_state == CommandBufferState::Recording) {
+        LogWarning("Submitting a command buffer that is still recording");
+    }
+
+    CommandExecutor executor(device);
+    executor.Execute(m_stream);
+    device.CountDrawCalls(executor.GetDrawCalls());
+    MarkSubmitted();
+}
+
+} // namespace VRHI
@@ -0,0 +1,26 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/RecordingCommandBuffer.hpp>
+
+namespace VRHI {
+
+class SoftwareDevice;
+
+/// Software command buffer.
+/// Commands are encoded into a CommandStream while recording and executed
+/// on the CPU by Execute(), which the device calls at submission time.
+/// Nothing is consumed by an execution, so a command buffer can be
+/// submitted again right away.
+class SoftwareCommandBuffer : public RecordingCommandBuffer {
+public:
+    explicit SoftwareCommandBuffer(CommandBufferLevel level) : RecordingCommandBuffer(level) {}
+    ~SoftwareCommandBuffer() override = default;
+
+    // Software-specific: run the commands; they have finished on return
+    void Execute(SoftwareDevice& device);
+};
+
+} // namespace VRHI
@@ -0,0 +1,276 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "SoftwareDevice.hpp"
+#include "SoftwareBuffer.hpp"
+#include "SoftwareTexture.hpp"
+#include "SoftwareSampler.hpp"
+#include "SoftwareShader.hpp"
+#include "SoftwarePipeline.hpp"
+#include "SoftwareRenderPass.hpp"
+#include "SoftwareFramebuffer.hpp"
+#include "SoftwareCommandBuffer.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "SoftwareSimd.hpp"
+#include "SoftwareSync.hpp"
+#include "Core/ThreadPool.hpp"
+#include <VRHI/Logging.hpp>
+#include <VRHI/BackendScoring.hpp>
+#include <VRHI/Pipeline.hpp>
+#include <VRHI/RenderPass.hpp>
+
+namespace VRHI {
+
+namespace {
+    /// Alignment of transient allocations; enough for any std430 member
+    constexpr uint32_t BufferAlignment = 16;
+}
+
+SoftwareDevice::SoftwareDevice(const DeviceConfig& config)
+    : m_config(config)
+{
+    SetMaxFramesInFlight(config.maxFramesInFlight);
+}
+
+SoftwareDevice::~SoftwareDevice() {
+    ReleaseFrameContexts();
+    if (m_transientAllocator) {
+        m_transientAllocator->Release();
+    }
+}
+
+FeatureSet SoftwareDevice::GetSupportedFeatures() {
+    // What the rasterizer and the SPIR-V interpreter implement
+    FeatureSet features;
+    features.core.vertexShader = true;
+    features.core.fragmentShader = true;
+    features.core.computeShader = true;
+    features.core.uniformBuffers = true;
+    features.core.storageBuffers = true;
+    features.core.vertexBuffers = true;
+    features.core.indexBuffers = true;
+    features.core.indirectBuffers = true;
+    features.core.instancing = true;
+    features.core.multiDrawIndirect = true;
+
+    features.texture.texture1D = true;
+    features.texture.texture2D = true;
+    features.texture.texture3D = true;
+    features.texture.textureCube = true;
+    features.texture.texture2DArray = true;
+    features.texture.floatTextures = true;
+    features.texture.depthTextures = true;
+    features.texture.maxTextureSize = SoftwareRasterizer::MaxFramebufferSize;
+    features.texture.max3DTextureSize = 2048;
+    features.texture.maxArrayLayers = 2048;
+
+    features.rendering.multipleRenderTargets = true;
+    features.rendering.maxColorAttachments = 8;
+    features.rendering.independentBlend = true;
+    features.rendering.depthClamp = true;
+    features.rendering.maxSamples = 1;
+
+    features.compute.computeShader = true;
+    features.compute.maxWorkGroupSizeX = 1024;
+    features.compute.maxWorkGroupSizeY = 1024;
+    features.compute.maxWorkGroupSizeZ = 64;
+    features.compute.maxWorkGroupInvocations = 1024;
+    features.compute.maxComputeSharedMemorySize = 32768;
+
+    features.memory.minUniformBufferAlignment = BufferAlignment;
+    features.memory.minStorageBufferAlignment = BufferAlignment;
+    features.memory.unifiedMemory = true;
+    return features;
+}
+
+std::expected<void, Error> SoftwareDevice::Initialize() {
+    m_threads = std::make_unique<ThreadPool>(m_config.workerThreads);
+    m_rasterizer = std::make_unique<SoftwareRasterizer>(*m_threads);
+    m_transientAllocator = std::make_unique<TransientRingAllocator>(*this, BufferAlignment);
+
+    m_features = GetSupportedFeatures();
+
+    const uint32_t threadCount = m_threads->GetThreadCount();
+    m_properties.deviceName = "VRHI Software Rasterizer (" + std::to_string(threadCount) + " threads, " +
+                              SimdName + ")";
+    m_properties.vendorName = "VRHI";
+    m_properties.driverVersion = "1.0.0";
+    m_properties.apiVersion = "Software 1.0";
+    m_properties.computeUnits = threadCount;
+    m_properties.maxThreadsPerGroup = m_features.compute.maxWorkGroupInvocations;
+
+    LogInfo("%s Device initialized", m_properties.apiVersion.c_str());
+    LogInfo(m_properties.deviceName);
+    return {};
+}
+
+// ============================================================================
+// Device Information
+// ============================================================================
+
+BackendType SoftwareDevice::GetBackendType() const noexcept {
+    return BackendType::Software;
+}
+
+BackendInfo SoftwareDevice::GetBackendInfo() const {
+    BackendInfo info{};
+    info.type = BackendType::Software;
+    info.name = "Software";
+    info.version = "1.0";
+    info.deviceName = m_properties.deviceName;
+    info.vendorName = m_properties.vendorName;
+    info.driverVersion = m_properties.driverVersion;
+    return info;
+}
+
+const FeatureSet& SoftwareDevice::GetFeatures() const noexcept {
+    return m_features;
+}
+
+bool SoftwareDevice::IsFeatureSupported(Feature feature) const noexcept {
+    switch (feature) {
+        case Feature::DebugMarkers:
+        case Feature::GPUValidation:
+            return false;
+        default:
+            return VRHI::IsFeatureSupported(m_features, feature);
+    }
+}
+
+const DeviceProperties& SoftwareDevice::GetProperties() const noexcept {
+    return m_properties;
+}
+
+// ============================================================================
+// Resource Creation
+// ============================================================================
+
+std::expected<std::unique_ptr<Buffer>, Error>
+SoftwareDevice::CreateBuffer(const BufferDesc& desc) {
+    return SoftwareBuffer::Create(desc);
+}
+
+std::expected<std::unique_ptr<Texture>, Error>
+SoftwareDevice::CreateTexture(const TextureDesc& desc) {
+    return SoftwareTexture::Create(desc);
+}
+
+std::expected<std::unique_ptr<Sampler>, Error>
+SoftwareDevice::CreateSampler(const SamplerDesc& desc) {
+    return SoftwareSampler::Create(desc);
+}
+
+std::expected<std::unique_ptr<Shader>, Error>
+SoftwareDevice::CreateShader(const ShaderDesc& desc) {
+    return SoftwareShader::Create(desc);
+}
+
+std::expected<std::unique_ptr<Pipeline>, Error>
+SoftwareDevice::CreatePipeline(const PipelineDesc& desc) {
+    return SoftwarePipeline::Create(desc, m_threads->GetThreadCount());
+}
+
+std::expected<std::unique_ptr<RenderPass>, Error>
+SoftwareDevice::CreateRenderPass(const RenderPassDesc& desc) {
+    return SoftwareRenderPass::Create(desc);
+}
+
+std::expected<std::unique_ptr<Framebuffer>, Error>
+SoftwareDevice::CreateFramebuffer(const FramebufferDesc& desc) {
+    if (desc.width > SoftwareRasterizer::MaxFramebufferSize || desc.height > SoftwareRasterizer::MaxFramebufferSize) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Software framebuffers are at most " + std::to_string(SoftwareRasterizer::MaxFramebufferSize) +
+            " pixels wide and high"
+        });
+    }
+    return SoftwareFramebuffer::Create(desc);
+}
+
+// ============================================================================
+// Command Execution
+// ============================================================================
+
+std::unique_ptr<CommandBuffer> SoftwareDevice::CreateCommandBuffer(CommandBufferLevel level) {
+    return std::make_unique<SoftwareCommandBuffer>(level);
+}
+
+TransientAllocator* SoftwareDevice::GetTransientAllocator() noexcept {
+    return m_transientAllocator.get();
+}
+
+void SoftwareDevice::Submit(std::unique_ptr<CommandBuffer> cmd, Fence* signalFence) {
+    Submit(cmd.get(), signalFence);
+}
+
+void SoftwareDevice::Submit(CommandBuffer* cmd, Fence* signalFence) {
+    m_transientAllocator->FlushWrites();
+    if (cmd) {
+        if (cmd->GetLevel() == CommandBufferLevel::Secondary) {
+            LogWarning("Secondary command buffers cannot be submitted; use ExecuteCommands");
+        } else {
+            static_cast<SoftwareCommandBuffer*>(cmd)->Execute(*this);
+        }
+    }
+    if (signalFence) {
+        static_cast<SoftwareFence*>(signalFence)->Signal();
+    }
+}
+
+void SoftwareDevice::Submit(std::span<std::unique_ptr<CommandBuffer>> cmds, Fence* signalFence) {
+    for (size_t i = 0; i < cmds.size(); ++i) {
+        Submit(cmds[i].get(), i + 1 == cmds.size() ? signalFence : nullptr);
+    }
+    if (cmds.empty() && signalFence) {
+        Submit(nullptr, signalFence);
+    }
+}
+
+void SoftwareDevice::WaitIdle() {
+    // Submissions have finished by the time Submit() returns
+}
+
+// ============================================================================
+// Synchronization
+// ============================================================================
+
+std::unique_ptr<Fence> SoftwareDevice::CreateFence(bool signaled) {
+    return std::make_unique<SoftwareFence>(signaled);
+}
+
+std::unique_ptr<Semaphore> SoftwareDevice::CreateSemaphore() {
+    return std::make_unique<SoftwareSemaphore>();
+}
+
+void SoftwareDevice::Flush() {
+    // Nothing is queued
+}
+
+// ============================================================================
+// Swap Chain
+// ============================================================================
+
+SwapChain* SoftwareDevice::GetSwapChain() noexcept {
+    return nullptr;
+}
+
+void SoftwareDevice::Present() {
+    // Recycle the frame's transient memory; without a swap chain nothing is shown
+    m_transientAllocator->EndFrame();
+
+    // Close the frame's statistics
+    m_lastFrameStats = FrameStats{};
+    m_lastFrameStats.drawCalls = m_drawCalls;
+    m_drawCalls = 0;
+}
+
+FrameStats SoftwareDevice::GetFrameStats() const noexcept {
+    return m_lastFrameStats;
+}
+
+void SoftwareDevice::Resize(uint32_t width, uint32_t height) {
+    m_config.width = width;
+    m_config.height = height;
+}
+
+} // namespace VRHI
@@ -0,0 +1,113 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/VRHI.hpp>
+#include <VRHI/Resources.hpp>
+#include "Core/TransientRingAllocator.hpp"
+#include <cstdint>
+#include <expected>
+#include <memory>
+
+namespace VRHI {
+
+class SoftwareRasterizer;
+class ThreadPool;
+
+/// Software device implementation
+///
+/// Renders on the CPU: command buffers are executed when they are
+/// submitted, with vertex shading, primitive setup and tile rendering spread
+/// across a pool of worker threads (DeviceConfig::workerThreads). Output
+/// only depends on the commands, not on the thread count or timing, which
+/// makes the device suited to headless rendering and to tests that compare
+/// images.
+///
+/// Resources live in plain memory, so uploads and reads are copies and
+/// nothing is ever waited for: Submit() returns once the work is done.
+class SoftwareDevice : public Device {
+public:
+    explicit SoftwareDevice(const DeviceConfig& config);
+    ~SoftwareDevice() override;
+
+    /// Start the worker threads
+    std::expected<void, Error> Initialize();
+
+    /// Features of every software device
+    static FeatureSet GetSupportedFeatures();
+
+    // Device Information
+    BackendType GetBackendType() const noexcept override;
+    BackendInfo GetBackendInfo() const override;
+    const FeatureSet& GetFeatures() const noexcept override;
+    bool IsFeatureSupported(Feature feature) const noexcept override;
+    const DeviceProperties& GetProperties() const noexcept override;
+
+    // Resource Creation
+    std::expected<std::unique_ptr<Buffer>, Error>
+    CreateBuffer(const BufferDesc& desc) override;
+
+    std::expected<std::unique_ptr<Texture>, Error>
+    CreateTexture(const TextureDesc& desc) override;
+
+    std::expected<std::unique_ptr<Sampler>, Error>
+    CreateSampler(const SamplerDesc& desc) override;
+
+    std::expected<std::unique_ptr<Shader>, Error>
+    CreateShader(const struct ShaderDesc& desc) override;
+
+    std::expected<std::unique_ptr<Pipeline>, Error>
+    CreatePipeline(const struct PipelineDesc& desc) override;
+
+    std::expected<std::unique_ptr<RenderPass>, Error>
+    CreateRenderPass(const struct RenderPassDesc& desc) override;
+
+    std::expected<std::unique_ptr<Framebuffer>, Error>
+    CreateFramebuffer(const struct FramebufferDesc& desc) override;
+
+    // Command Execution
+    std::unique_ptr<CommandBuffer> CreateCommandBuffer(CommandBufferLevel level = CommandBufferLevel::Primary) override;
+    TransientAllocator* GetTransientAllocator() noexcept override;
+    void Submit(std::unique_ptr<CommandBuffer> cmd, Fence* signalFence = nullptr) override;
+    void Submit(CommandBuffer* cmd, Fence* signalFence = nullptr) override;
+    void Submit(std::span<std::unique_ptr<CommandBuffer>> cmds, Fence* signalFence = nullptr) override;
+    void WaitIdle() override;
+
+    // Synchronization
+    std::unique_ptr<Fence> CreateFence(bool signaled = false) override;
+    std::unique_ptr<Semaphore> CreateSemaphore() override;
+    void Flush() override;
+
+    // Swap Chain
+    SwapChain* GetSwapChain() noexcept override;
+    void Present() override;
+    void Resize(uint32_t width, uint32_t height) override;
+
+    // Statistics
+    FrameStats GetFrameStats() const noexcept override;
+
+    // Software-specific: execution resources of command buffers
+    ThreadPool& GetThreadPool() noexcept { return *m_threads; }
+    SoftwareRasterizer& GetRasterizer() noexcept { return *m_rasterizer; }
+
+    /// Software-specific: counters of a command buffer execution, for the frame stats
+    void CountDrawCalls(uint64_t drawCalls) noexcept { m_drawCalls += drawCalls; }
+
+private:
+    DeviceConfig m_config;
+    FeatureSet m_features;
+    DeviceProperties m_properties;
+
+    std::unique_ptr<ThreadPool> m_threads;
+    std::unique_ptr<SoftwareRasterizer> m_rasterizer;
+
+    // Plain memory; every frame retires at Present()
+    std::unique_ptr<TransientRingAllocator> m_transientAllocator;
+
+    // Statistics of the current and the last finished frame
+    uint64_t m_drawCalls = 0;
+    FrameStats m_lastFrameStats{};
+};
+
+} // namespace VRHI
@@ -0,0 +1,349 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "SoftwareFormatUtils.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+namespace VRHI {
+
+namespace {
+    uint32_t FloatBits(float value) { return std::bit_cast<uint32_t>(value); }
+    float BitsFloat(uint32_t value) { return std::bit_cast<float>(value); }
+
+    /// Clamp to [0, 1], NaN to 0
+    float Saturate(float value) {
+        return value > 0.0f ? (value < 1.0f ? value : 1.0f) : 0.0f;
+    }
+
+    uint8_t EncodeUNorm8(float value) {
+        return static_cast<uint8_t>(Saturate(value) * 255.0f + 0.5f);
+    }
+
+    const std::array<float, 256>& GetSrgbTable() {
+        static const std::array<float, 256> table = [] {
+            std::array<float, 256> values{};
+            for (uint32_t i = 0; i < 256; ++i) {
+                values[i] = SoftwareFormatUtils::SrgbToLinear(float(i) / 255.0f);
+            }
+            return values;
+        }();
+        return table;
+    }
+
+    uint32_t GetComponentCount(TextureFormat format) {
+        switch (format) {
+            case TextureFormat::R8_UNorm:
+            case TextureFormat::R16_Float:
+            case TextureFormat::R32_Float:
+            case TextureFormat::R32_UInt: return 1;
+            case TextureFormat::RG8_UNorm:
+            case TextureFormat::RG16_Float:
+            case TextureFormat::RG32_Float:
+            case TextureFormat::RG32_UInt: return 2;
+            case TextureFormat::RGB32_Float:
+            case TextureFormat::RGB32_UInt: return 3;
+            default: return 4;
+        }
+    }
+}
+
+uint32_t SoftwareFormatUtils::GetTexelSize(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::R8_UNorm: return 1;
+        case TextureFormat::RG8_UNorm: return 2;
+        case TextureFormat::RGBA8_UNorm:
+        case TextureFormat::RGBA8_SRGB: return 4;
+        case TextureFormat::R16_Float: return 2;
+        case TextureFormat::RG16_Float: return 4;
+        case TextureFormat::RGBA16_Float: return 8;
+        case TextureFormat::R32_Float:
+        case TextureFormat::R32_UInt: return 4;
+        case TextureFormat::RG32_Float:
+        case TextureFormat::RG32_UInt: return 8;
+        case TextureFormat::RGB32_Float:
+        case TextureFormat::RGB32_UInt: return 12;
+        case TextureFormat::RGBA32_Float:
+        case TextureFormat::RGBA32_UInt: return 16;
+        case TextureFormat::Depth16: return 2;
+        case TextureFormat::Depth24Stencil8:
+        case TextureFormat::Depth32F: return 4;
+        case TextureFormat::Depth32FStencil8: return 8;
+        default: return 0;
+    }
+}
+
+bool SoftwareFormatUtils::IsDepthFormat(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::Depth16:
+        case TextureFormat::Depth24Stencil8:
+        case TextureFormat::Depth32F:
+        case TextureFormat::Depth32FStencil8:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool SoftwareFormatUtils::HasStencil(TextureFormat format) {
+    return format == TextureFormat::Depth24Stencil8 || format == TextureFormat::Depth32FStencil8;
+}
+
+bool SoftwareFormatUtils::IsIntegerFormat(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::R32_UInt:
+        case TextureFormat::RG32_UInt:
+        case TextureFormat::RGB32_UInt:
+        case TextureFormat::RGBA32_UInt:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool SoftwareFormatUtils::IsNormalizedFormat(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::R8_UNorm:
+        case TextureFormat::RG8_UNorm:
+        case TextureFormat::RGBA8_UNorm:
+        case TextureFormat::RGBA8_SRGB:
+            return true;
+        default:
+            return IsDepthFormat(format);
+    }
+}
+
+void SoftwareFormatUtils::Decode(TextureFormat format, const std::byte* texel, uint32_t (&words)[4]) {
+    words[0] = words[1] = words[2] = 0;
+    words[3] = IsIntegerFormat(format) ? 1u : FloatBits(1.0f);
+
+    const uint32_t components = GetComponentCount(format);
+    switch (format) {
+        case TextureFormat::R8_UNorm:
+        case TextureFormat::RG8_UNorm:
+        case TextureFormat::RGBA8_UNorm:
+            for (uint32_t i = 0; i < components; ++i) {
+                words[i] = FloatBits(float(std::to_integer<uint8_t>(texel[i])) / 255.0f);
+            }
+            break;
+        case TextureFormat::RGBA8_SRGB: {
+            const auto& table = GetSrgbTable();
+            for (uint32_t i = 0; i < 3; ++i) {
+                words[i] = FloatBits(table[std::to_integer<uint8_t>(texel[i])]);
+            }
+            words[3] = FloatBits(float(std::to_integer<uint8_t>(texel[3])) / 255.0f);
+            break;
+        }
+        case TextureFormat::R16_Float:
+        case TextureFormat::RG16_Float:
+        case TextureFormat::RGBA16_Float:
+            for (uint32_t i = 0; i < components; ++i) {
+                uint16_t half;
+                std::memcpy(&half, texel + i * 2, 2);
+                words[i] = FloatBits(HalfToFloat(half));
+            }
+            break;
+        case TextureFormat::R32_Float:
+        case TextureFormat::RG32_Float:
+        case TextureFormat::RGB32_Float:
+        case TextureFormat::RGBA32_Float:
+        case TextureFormat::R32_UInt:
+        case TextureFormat::RG32_UInt:
+        case TextureFormat::RGB32_UInt:
+        case TextureFormat::RGBA32_UInt:
+            std::memcpy(words, texel, components * 4);
+            break;
+        case TextureFormat::Depth16:
+        case TextureFormat::Depth24Stencil8:
+        case TextureFormat::Depth32F:
+        case TextureFormat::Depth32FStencil8:
+            words[0] = FloatBits(DecodeDepth(format, texel));
+            break;
+        default:
+            break;
+    }
+}
+
+void SoftwareFormatUtils::Encode(TextureFormat format, const uint32_t (&words)[4], std::byte* texel) {
+    const uint32_t components = GetComponentCount(format);
+    switch (format) {
+        case TextureFormat::R8_UNorm:
+        case TextureFormat::RG8_UNorm:
+        case TextureFormat::RGBA8_UNorm:
+            for (uint32_t i = 0; i < components; ++i) {
+                texel[i] = std::byte{EncodeUNorm8(BitsFloat(words[i]))};
+            }
+            break;
+        case TextureFormat::RGBA8_SRGB:
+            for (uint32_t i = 0; i < 3; ++i) {
+                texel[i] = std::byte{EncodeUNorm8(LinearToSrgb(Saturate(BitsFloat(words[i]))))};
+            }
+            texel[3] = std::byte{EncodeUNorm8(BitsFloat(words[3]))};
+            break;
+        case TextureFormat::R16_Float:
+        case TextureFormat::RG16_Float:
+        case TextureFormat::RGBA16_Float:
+            for (uint32_t i = 0; i < components; ++i) {
+                const uint16_t half = FloatToHalf(BitsFloat(words[i]));
+                std::memcpy(texel + i * 2, &half, 2);
+            }
+            break;
+        case TextureFormat::R32_Float:
+        case TextureFormat::RG32_Float:
+        case TextureFormat::RGB32_Float:
+        case TextureFormat::RGBA32_Float:
+        case TextureFormat::R32_UInt:
+        case TextureFormat::RG32_UInt:
+        case TextureFormat::RGB32_UInt:
+        case TextureFormat::RGBA32_UInt:
+            std::memcpy(texel, words, components * 4);
+            break;
+        case TextureFormat::Depth16:
+        case TextureFormat::Depth24Stencil8:
+        case TextureFormat::Depth32F:
+        case TextureFormat::Depth32FStencil8:
+            EncodeDepth(format, BitsFloat(words[0]), texel);
+            break;
+        default:
+            break;
+    }
+}
+
+float SoftwareFormatUtils::DecodeDepth(TextureFormat format, const std::byte* texel) {
+    switch (format) {
+        case TextureFormat::Depth16: {
+            uint16_t value;
+            std::memcpy(&value, texel, 2);
+            return float(value) / 65535.0f;
+        }
+        case TextureFormat::Depth24Stencil8: {
+            uint32_t value;
+            std::memcpy(&value, texel, 4);
+            return float(value >> 8) / 16777215.0f;
+        }
+        case TextureFormat::Depth32F:
+        case TextureFormat::Depth32FStencil8: {
+            float value;
+            std::memcpy(&value, texel, 4);
+            return value;
+        }
+        default:
+            return 0.0f;
+    }
+}
+
+void SoftwareFormatUtils::EncodeDepth(TextureFormat format, float depth, std::byte* texel) {
+    depth = Saturate(depth);
+    switch (format) {
+        case TextureFormat::Depth16: {
+            const auto value = static_cast<uint16_t>(depth * 65535.0f + 0.5f);
+            std::memcpy(texel, &value, 2);
+            break;
+        }
+        case TextureFormat::Depth24Stencil8: {
+            uint32_t value;
+            std::memcpy(&value, texel, 4);
+            value = (static_cast<uint32_t>(double(depth) * 16777215.0 + 0.5) << 8) | (value & 0xFF);
+            std::memcpy(texel, &value, 4);
+            break;
+        }
+        case TextureFormat::Depth32F:
+        case TextureFormat::Depth32FStencil8:
+            std::memcpy(texel, &depth, 4);
+            break;
+        default:
+            break;
+    }
+}
+
+float SoftwareFormatUtils::QuantizeDepth(TextureFormat format, float depth) {
+    switch (format) {
+        case TextureFormat::Depth16:
+            return std::floor(Saturate(depth) * 65535.0f + 0.5f) / 65535.0f;
+        case TextureFormat::Depth24Stencil8:
+            return float(std::floor(double(Saturate(depth)) * 16777215.0 + 0.5) / 16777215.0);
+        default:
+            return Saturate(depth);
+    }
+}
+
+uint8_t SoftwareFormatUtils::DecodeStencil(TextureFormat format, const std::byte* texel) {
+    switch (format) {
+        case TextureFormat::Depth24Stencil8: return std::to_integer<uint8_t>(texel[0]);
+        case TextureFormat::Depth32FStencil8: return std::to_integer<uint8_t>(texel[4]);
+        default: return 0;
+    }
+}
+
+void SoftwareFormatUtils::EncodeStencil(TextureFormat format, uint8_t stencil, std::byte* texel) {
+    // Little endian: the low byte of the packed word comes first
+    switch (format) {
+        case TextureFormat::Depth24Stencil8: texel[0] = std::byte{stencil}; break;
+        case TextureFormat::Depth32FStencil8: texel[4] = std::byte{stencil}; break;
+        default: break;
+    }
+}
+
+float SoftwareFormatUtils::HalfToFloat(uint16_t value) {
+    const uint32_t sign = uint32_t(value & 0x8000) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1F;
+    const uint32_t mantissa = value & 0x3FF;
+    if (exponent == 0) {
+        const float magnitude = std::ldexp(float(mantissa), -24);
+        return sign ? -magnitude : magnitude;
+    }
+    if (exponent == 31) {
+        return BitsFloat(sign | 0x7F800000 | (mantissa << 13));
+    }
+    return BitsFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+uint16_t SoftwareFormatUtils::FloatToHalf(float value) {
+    const uint32_t bits = FloatBits(value);
+    const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    const uint32_t rawExponent = (bits >> 23) & 0xFF;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (rawExponent == 0xFF) {
+        return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+    }
+    const int32_t exponent = int32_t(rawExponent) - 127 + 15;
+    if (exponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7C00);
+    }
+
+    // Round to nearest even; a carry out of the mantissa bumps the exponent
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return sign;
+        }
+        mantissa |= 0x800000;
+        const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1))) {
+            ++half;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+    uint32_t half = (uint32_t(exponent) << 10) | (mantissa >> 13);
+    const uint32_t remainder = mantissa & 0x1FFF;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+        ++half;
+    }
+    return static_cast<uint16_t>(sign | half);
+}
+
+float SoftwareFormatUtils::SrgbToLinear(float value) {
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+float SoftwareFormatUtils::LinearToSrgb(float value) {
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+} // namespace VRHI
@@ -0,0 +1,59 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/Resources.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace VRHI {
+
+/// Texel encoding of the software backend.
+///
+/// Textures are stored in the layout OpenGL transfers them in, so Update(),
+/// Read() and copies are plain memcpys: tightly packed texels, depth as
+/// GL_UNSIGNED_SHORT / GL_UNSIGNED_INT_24_8 / GL_FLOAT, and Depth32FStencil8
+/// as GL_FLOAT_32_UNSIGNED_INT_24_8_REV.
+///
+/// Shaders see a texel as four 32-bit words: float bits for normalized and
+/// float formats (missing components read as 0, 0, 0, 1), integers for the
+/// UInt formats, and (depth, 0, 0, 1) for depth formats.
+class SoftwareFormatUtils {
+public:
+    /// Bytes per texel; 0 for formats the backend cannot store (compressed)
+    static uint32_t GetTexelSize(TextureFormat format);
+
+    static bool IsDepthFormat(TextureFormat format);
+    static bool HasStencil(TextureFormat format);
+    static bool IsIntegerFormat(TextureFormat format);
+
+    /// Whether blending and shader writes clamp to [0, 1]
+    static bool IsNormalizedFormat(TextureFormat format);
+
+    /// Texel to shader words
+    static void Decode(TextureFormat format, const std::byte* texel, uint32_t (&words)[4]);
+
+    /// Shader words to texel; depth formats keep the texel's stencil
+    static void Encode(TextureFormat format, const uint32_t (&words)[4], std::byte* texel);
+
+    /// Depth in [0, 1] of a depth texel
+    static float DecodeDepth(TextureFormat format, const std::byte* texel);
+
+    /// Store `depth`, clamped to [0, 1], leaving the stencil alone
+    static void EncodeDepth(TextureFormat format, float depth, std::byte* texel);
+
+    /// Depth after a round trip through the format, so tests compare against
+    /// what would be stored
+    static float QuantizeDepth(TextureFormat format, float depth);
+
+    static uint8_t DecodeStencil(TextureFormat format, const std::byte* texel);
+    static void EncodeStencil(TextureFormat format, uint8_t stencil, std::byte* texel);
+
+    static float HalfToFloat(uint16_t value);
+    static uint16_t FloatToHalf(float value);
+    static float SrgbToLinear(float value);
+    static float LinearToSrgb(float value);
+};
+
+} // namespace VRHI
@@ -0,0 +1,43 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "SoftwareFramebuffer.hpp"
+#include "SoftwareTexture.hpp"
+#include <algorithm>
+
+namespace VRHI {
+
+std::expected<std::unique_ptr<Framebuffer>, Error>
+SoftwareFramebuffer::Create(const FramebufferDesc& desc) {
+    if (desc.attachments.empty() || desc.width == 0 || desc.height == 0) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Framebuffers need attachments and a non-zero size"
+        });
+    }
+
+    std::unique_ptr<SoftwareFramebuffer> framebuffer(new SoftwareFramebuffer());
+    framebuffer->m_width = desc.width;
+    framebuffer->m_height = desc.height;
+    framebuffer->m_layers = std::max(desc.layers, 1u);
+
+    for (Texture* texture : desc.attachments) {
+        if (!texture || texture->GetType() == TextureType::Texture3D) {
+            return std::unexpected(Error{
+                Error::Code::InvalidConfig,
+                "Framebuffer attachments must be non-null 1D, 2D, array or cube textures"
+            });
+        }
+        if (texture->GetWidth() < desc.width || texture->GetHeight() < desc.height) {
+            return std::unexpected(Error{
+                Error::Code::InvalidConfig,
+                "Framebuffer attachments must be at least as large as the framebuffer"
+            });
+        }
+        framebuffer->m_attachments.push_back(static_cast<SoftwareTexture*>(texture));
+    }
+
+    return std::unique_ptr<Framebuffer>(std::move(framebuffer));
+}
+
+} // namespace VRHI
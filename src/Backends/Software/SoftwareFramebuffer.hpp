@@ -0,0 +1,45 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/VRHI.hpp>
+#include <expected>
+#include <memory>
+#include <vector>
+#include <VRHI/RenderPass.hpp>
+
+namespace VRHI {
+
+class SoftwareTexture;
+
+/// Framebuffer implementation
+///
+/// Renders to mip 0, layer 0 of each attachment. Color attachments are
+/// addressed in the order they appear; the depth attachment is the one with
+/// a depth format.
+class SoftwareFramebuffer : public Framebuffer {
+public:
+    ~SoftwareFramebuffer() override = default;
+
+    static std::expected<std::unique_ptr<Framebuffer>, Error>
+    Create(const FramebufferDesc& desc);
+
+    uint32_t GetWidth() const noexcept override { return m_width; }
+    uint32_t GetHeight() const noexcept override { return m_height; }
+    uint32_t GetLayers() const noexcept override { return m_layers; }
+
+    // Software-specific
+    /// Attachments in FramebufferDesc order
+    const std::vector<SoftwareTexture*>& GetAttachments() const noexcept { return m_attachments; }
+
+private:
+    SoftwareFramebuffer() = default;
+
+    std::vector<SoftwareTexture*> m_attachments;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint32_t m_layers = 1;
+};
+
+} // namespace VRHI
@@ -0,0 +1,186 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "SoftwarePipeline.hpp"
+#include "SoftwareShader.hpp"
+#include "SoftwareShaderProgram.hpp"
+#include <VRHI/Logging.hpp>
+#include <algorithm>
+
+#include <spirv.hpp>
+
+namespace VRHI {
+
+namespace {
+    const SoftwareShader* GetShader(Shader* shader, ShaderStage stage) {
+        return shader && shader->GetStage() == stage ? static_cast<const SoftwareShader*>(shader) : nullptr;
+    }
+
+    uint32_t GetComponentCount(VertexFormat format) {
+        return static_cast<uint32_t>(format) % 4 + 1;
+    }
+
+    bool IsFloatFormat(VertexFormat format) {
+        return format <= VertexFormat::Float4;
+    }
+}
+
+SoftwarePipeline::~SoftwarePipeline() = default;
+
+std::expected<std::unique_ptr<Pipeline>, Error>
+SoftwarePipeline::Create(const PipelineDesc& desc, uint32_t threadCount) {
+    std::unique_ptr<SoftwarePipeline> pipeline(new SoftwarePipeline());
+    pipeline->m_type = desc.type;
+    for (auto& contexts : pipeline->m_contexts) {
+        contexts.resize(threadCount);
+    }
+
+    if (desc.type == PipelineType::Compute) {
+        const SoftwareShader* shader = GetShader(desc.compute.computeShader, ShaderStage::Compute);
+        if (!shader) {
+            return std::unexpected(Error{
+                Error::Code::InvalidConfig,
+                "Compute pipelines need a compute shader"
+            });
+        }
+        pipeline->m_compute = shader->GetProgram();
+        pipeline->m_bufferBindings = pipeline->m_compute->GetBufferBindings();
+        pipeline->m_imageBindings = pipeline->m_compute->GetImageBindings();
+
+        Builtins& builtins = pipeline->m_builtins;
+        const SoftwareShaderProgram& program = *pipeline->m_compute;
+        builtins.globalInvocationId = program.GetBuiltinOffset(spv::BuiltInGlobalInvocationId);
+        builtins.localInvocationId = program.GetBuiltinOffset(spv::BuiltInLocalInvocationId);
+        builtins.localInvocationIndex = program.GetBuiltinOffset(spv::BuiltInLocalInvocationIndex);
+        builtins.workgroupId = program.GetBuiltinOffset(spv::BuiltInWorkgroupId);
+        builtins.numWorkgroups = program.GetBuiltinOffset(spv::BuiltInNumWorkgroups);
+        return std::unique_ptr<Pipeline>(std::move(pipeline));
+    }
+
+    auto linked = pipeline->LinkGraphics(desc.graphics);
+    if (!linked) {
+        return std::unexpected(linked.error());
+    }
+    return std::unique_ptr<Pipeline>(std::move(pipeline));
+}
+
+std::expected<void, Error> SoftwarePipeline::LinkGraphics(const GraphicsPipelineDesc& graphics) {
+    const SoftwareShader* vertexShader = GetShader(graphics.vertexShader, ShaderStage::Vertex);
+    if (!vertexShader) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Graphics pipelines need a vertex shader"
+        });
+    }
+    if (graphics.geometryShader || graphics.tessControlShader || graphics.tessEvalShader) {
+        return std::unexpected(Error{
+            Error::Code::UnsupportedFeature,
+            "The software backend has no geometry or tessellation stages"
+        });
+    }
+    if (graphics.inputAssembly.topology > PrimitiveTopology::TriangleFan) {
+        return std::unexpected(Error{
+            Error::Code::UnsupportedFeature,
+            "The software backend has no adjacency or patch topologies"
+        });
+    }
+    m_vertex = vertexShader->GetProgram();
+    if (const SoftwareShader* fragmentShader = GetShader(graphics.fragmentShader, ShaderStage::Fragment)) {
+        m_fragment = fragmentShader->GetProgram();
+    }
+
+    // Keep the state; the arrays it points to may not outlive the desc
+    m_desc = graphics;
+    m_vertexAttributes.assign(graphics.vertexInput.attributes.begin(), graphics.vertexInput.attributes.end());
+    m_vertexBindings.assign(graphics.vertexInput.bindings.begin(), graphics.vertexInput.bindings.end());
+    m_blendAttachments.assign(graphics.colorBlend.attachments.begin(), graphics.colorBlend.attachments.end());
+    m_desc.vertexInput = {m_vertexAttributes, m_vertexBindings};
+    m_desc.colorBlend.attachments = m_blendAttachments;
+    m_desc.dynamicStates = {};
+    m_desc.multisample.sampleMask = nullptr;
+    m_desc.debugName = nullptr;
+    for (DynamicState state : graphics.dynamicStates) {
+        m_dynamicStates |= 1u << uint32_t(state);
+    }
+
+    // Vertex inputs, fed by the attribute at their location
+    for (const SoftwareShaderProgram::InterfaceVariable& input : m_vertex->GetInputs()) {
+        VertexInput vertexInput;
+        vertexInput.offset = input.offset;
+        vertexInput.words = input.words;
+        auto attribute = std::ranges::find(m_vertexAttributes, input.location, &VertexAttribute::location);
+        if (attribute == m_vertexAttributes.end()) {
+            LogWarning("No vertex attribute feeds vertex shader input %u; it reads (0, 0, 0, 1)", input.location);
+        } else {
+            auto binding = std::ranges::find(m_vertexBindings, attribute->binding, &VertexBinding::binding);
+            if (binding == m_vertexBindings.end()) {
+                return std::unexpected(Error{
+                    Error::Code::InvalidConfig,
+                    "Vertex attribute " + std::to_string(attribute->location) + " uses an undeclared binding"
+                });
+            }
+            vertexInput.binding = attribute->binding;
+            vertexInput.attributeOffset = attribute->offset;
+            vertexInput.stride = binding->stride;
+            vertexInput.components = GetComponentCount(attribute->format);
+            vertexInput.isFloat = IsFloatFormat(attribute->format);
+            vertexInput.perInstance = binding->inputRate == VertexInputRate::Instance;
+        }
+        m_vertexInputs.push_back(vertexInput);
+    }
+
+    // Fragment inputs, each given a slot in shaded vertices
+    if (m_fragment) {
+        for (const SoftwareShaderProgram::InterfaceVariable& input : m_fragment->GetInputs()) {
+            Varying varying{m_vertexWords, input.offset, input.words, input.flat, input.noPerspective};
+            m_vertexWords += input.words;
+            m_varyings.push_back(varying);
+
+            const auto& outputs = m_vertex->GetOutputs();
+            auto output = std::ranges::find(outputs, input.location, &SoftwareShaderProgram::InterfaceVariable::location);
+            if (output == outputs.end()) {
+                LogWarning("The vertex shader does not write fragment shader input %u; it reads zero", input.location);
+                continue;
+            }
+            m_varyingSources.push_back({output->offset, varying.slot, std::min(output->words, input.words)});
+        }
+        for (const SoftwareShaderProgram::InterfaceVariable& output : m_fragment->GetOutputs()) {
+            m_colorOutputs.push_back({output.location, output.offset, output.words});
+        }
+    }
+
+    m_bufferBindings = m_vertex->GetBufferBindings() | (m_fragment ? m_fragment->GetBufferBindings() : 0);
+    m_imageBindings = m_vertex->GetImageBindings() | (m_fragment ? m_fragment->GetImageBindings() : 0);
+
+    m_builtins.position = m_vertex->GetBuiltinOffset(spv::BuiltInPosition);
+    m_builtins.pointSize = m_vertex->GetBuiltinOffset(spv::BuiltInPointSize);
+    m_builtins.vertexIndex = m_vertex->GetBuiltinOffset(spv::BuiltInVertexIndex);
+    m_builtins.instanceIndex = m_vertex->GetBuiltinOffset(spv::BuiltInInstanceIndex);
+    m_builtins.baseVertex = m_vertex->GetBuiltinOffset(spv::BuiltInBaseVertex);
+    m_builtins.baseInstance = m_vertex->GetBuiltinOffset(spv::BuiltInBaseInstance);
+    m_builtins.drawIndex = m_vertex->GetBuiltinOffset(spv::BuiltInDrawIndex);
+    if (m_fragment) {
+        m_builtins.fragCoord = m_fragment->GetBuiltinOffset(spv::BuiltInFragCoord);
+        m_builtins.frontFacing = m_fragment->GetBuiltinOffset(spv::BuiltInFrontFacing);
+        m_builtins.pointCoord = m_fragment->GetBuiltinOffset(spv::BuiltInPointCoord);
+        m_builtins.helperInvocation = m_fragment->GetBuiltinOffset(spv::BuiltInHelperInvocation);
+        m_builtins.fragDepth = m_fragment->GetBuiltinOffset(spv::BuiltInFragDepth);
+    }
+    return {};
+}
+
+SoftwareShaderContext& SoftwarePipeline::GetContext(uint32_t stage, uint32_t thread) {
+    std::unique_ptr<SoftwareShaderContext>& context = m_contexts[stage][thread];
+    if (!context) {
+        const SoftwareShaderProgram& program = stage == 0 ? *m_vertex : stage == 1 ? *m_fragment : *m_compute;
+        uint32_t laneCount = BatchSize;
+        if (stage == 2) {
+            const uint32_t* size = program.GetWorkgroupSize();
+            laneCount = size[0] * size[1] * size[2];
+        }
+        context = program.CreateContext(laneCount);
+    }
+    return *context;
+}
+
+} // namespace VRHI
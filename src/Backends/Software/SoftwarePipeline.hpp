@@ -0,0 +1,158 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/VRHI.hpp>
+#include <VRHI/Pipeline.hpp>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <vector>
+
+namespace VRHI {
+
+class SoftwareShaderProgram;
+class SoftwareShaderContext;
+
+/// Software pipeline implementation
+///
+/// Links the stages once at creation: which vertex attribute feeds each
+/// vertex shader input, where each fragment shader input is found in a
+/// shaded vertex, and which color attachment each fragment shader output
+/// goes to. Shaded vertices are stored as 32-bit words: the clip space
+/// position, the point size and the point coordinate (VertexHeaderWords),
+/// followed by the varyings the fragment shader reads.
+///
+/// Shader contexts are kept per worker thread and created on first use, so
+/// a pipeline must only be used by one submission at a time, which the
+/// synchronous device guarantees.
+class SoftwarePipeline : public Pipeline {
+public:
+    ~SoftwarePipeline() override;
+
+    static std::expected<std::unique_ptr<Pipeline>, Error>
+    Create(const PipelineDesc& desc, uint32_t threadCount);
+
+    PipelineType GetType() const noexcept override { return m_type; }
+
+    static constexpr uint32_t VertexHeaderWords = 7;
+    static constexpr uint32_t VertexPosition = 0;
+    static constexpr uint32_t VertexPointSize = 4;
+    static constexpr uint32_t VertexPointCoord = 5;
+
+    /// Invocations per vertex and fragment shader batch
+    static constexpr uint32_t BatchSize = 64;
+
+    /// A vertex shader input and the attribute that feeds it
+    struct VertexInput {
+        uint32_t offset = 0;            // In invocation memory
+        uint32_t words = 0;             // Of the shader input
+        uint32_t binding = 0;
+        uint32_t attributeOffset = 0;
+        uint32_t stride = 0;
+        uint32_t components = 0;        // Of the attribute; 0 if none feeds the input
+        bool isFloat = true;
+        bool perInstance = false;
+    };
+
+    /// A fragment shader input and where shaded vertices keep its value
+    struct Varying {
+        uint32_t slot = 0;              // Word of the shaded vertex
+        uint32_t target = 0;            // Offset in fragment invocation memory
+        uint32_t words = 0;
+        bool flat = false;
+        bool noPerspective = false;
+    };
+
+    /// A vertex shader output copied into shaded vertices
+    struct VaryingSource {
+        uint32_t offset = 0;            // In vertex invocation memory
+        uint32_t slot = 0;
+        uint32_t words = 0;
+    };
+
+    /// A fragment shader output and the color attachment it is written to
+    struct ColorOutput {
+        uint32_t attachment = 0;        // Index among the color attachments
+        uint32_t offset = 0;
+        uint32_t words = 0;
+    };
+
+    /// Byte offsets of the built-ins the stages use, or -1
+    struct Builtins {
+        int32_t position = -1;
+        int32_t pointSize = -1;
+        int32_t vertexIndex = -1;
+        int32_t instanceIndex = -1;
+        int32_t baseVertex = -1;
+        int32_t baseInstance = -1;
+        int32_t drawIndex = -1;
+
+        int32_t fragCoord = -1;
+        int32_t frontFacing = -1;
+        int32_t pointCoord = -1;
+        int32_t helperInvocation = -1;
+        int32_t fragDepth = -1;
+
+        int32_t globalInvocationId = -1;
+        int32_t localInvocationId = -1;
+        int32_t localInvocationIndex = -1;
+        int32_t workgroupId = -1;
+        int32_t numWorkgroups = -1;
+    };
+
+    const SoftwareShaderProgram* GetVertexProgram() const noexcept { return m_vertex.get(); }
+    const SoftwareShaderProgram* GetFragmentProgram() const noexcept { return m_fragment.get(); }
+    const SoftwareShaderProgram* GetComputeProgram() const noexcept { return m_compute.get(); }
+
+    /// Fixed-function state; the spans point into the pipeline
+    const GraphicsPipelineDesc& GetGraphicsDesc() const noexcept { return m_desc; }
+    bool IsDynamic(DynamicState state) const noexcept { return (m_dynamicStates >> uint32_t(state)) & 1u; }
+
+    const std::vector<VertexInput>& GetVertexInputs() const noexcept { return m_vertexInputs; }
+    const std::vector<VaryingSource>& GetVaryingSources() const noexcept { return m_varyingSources; }
+    const std::vector<Varying>& GetVaryings() const noexcept { return m_varyings; }
+    const std::vector<ColorOutput>& GetColorOutputs() const noexcept { return m_colorOutputs; }
+    const Builtins& GetBuiltins() const noexcept { return m_builtins; }
+
+    /// Words of a shaded vertex
+    uint32_t GetVertexWords() const noexcept { return m_vertexWords; }
+
+    /// Bindings of SoftwareBindings the stages read, one bit per binding
+    uint64_t GetBufferBindings() const noexcept { return m_bufferBindings; }
+    uint64_t GetImageBindings() const noexcept { return m_imageBindings; }
+
+    /// Context of `thread` for the vertex [0], fragment [1] or compute [2]
+    /// stage; only `thread` may use it
+    SoftwareShaderContext& GetContext(uint32_t stage, uint32_t thread);
+
+private:
+    SoftwarePipeline() = default;
+
+    std::expected<void, Error> LinkGraphics(const GraphicsPipelineDesc& desc);
+
+    PipelineType m_type = PipelineType::Graphics;
+    std::shared_ptr<const SoftwareShaderProgram> m_vertex;
+    std::shared_ptr<const SoftwareShaderProgram> m_fragment;
+    std::shared_ptr<const SoftwareShaderProgram> m_compute;
+
+    GraphicsPipelineDesc m_desc{};
+    std::vector<VertexAttribute> m_vertexAttributes;
+    std::vector<VertexBinding> m_vertexBindings;
+    std::vector<ColorBlendAttachment> m_blendAttachments;
+    uint32_t m_dynamicStates = 0;
+
+    std::vector<VertexInput> m_vertexInputs;
+    std::vector<VaryingSource> m_varyingSources;
+    std::vector<Varying> m_varyings;
+    std::vector<ColorOutput> m_colorOutputs;
+    Builtins m_builtins;
+    uint32_t m_vertexWords = VertexHeaderWords;
+    uint64_t m_bufferBindings = 0;
+    uint64_t m_imageBindings = 0;
+
+    std::vector<std::unique_ptr<SoftwareShaderContext>> m_contexts[3];
+};
+
+} // namespace VRHI
@@ -0,0 +1,1507 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "SoftwareRasterizer.hpp"
+#include "SoftwareFormatUtils.hpp"
+#include "SoftwareFramebuffer.hpp"
+#include "SoftwarePipeline.hpp"
+#include "SoftwareSimd.hpp"
+#include "SoftwareTexture.hpp"
+#include "Core/ThreadPool.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace VRHI {
+
+namespace {
+    /// Primitives set up by one parallel work item
+    constexpr uint32_t ChunkPrimitives = 256;
+
+    /// Binned work that makes a flush worthwhile before the next draw
+    constexpr size_t MaxBinnedTriangles = size_t(1) << 18;
+    constexpr size_t MaxArenaWords = size_t(1) << 26;
+
+    constexpr size_t ArenaBlockWords = size_t(1) << 18;
+
+    /// Smallest w primitives are clipped to, so that they can be projected
+    constexpr float MinW = 1e-6f;
+
+    constexpr uint32_t RestartSlot = UINT32_MAX;
+
+    constexpr uint32_t QuadsPerStep = SimdWidth / 4;
+    constexpr int32_t StepWidth = int32_t(SimdWidth / 2);
+
+    float AsFloat(uint32_t word) noexcept { return std::bit_cast<float>(word); }
+    uint32_t AsWord(float value) noexcept { return std::bit_cast<uint32_t>(value); }
+
+    /// Pixel of each lane of a SIMD step: quads side by side, each quad's
+    /// pixels in the order SoftwareShaderContext expects
+    struct LaneLayout {
+        int32_t x[SimdWidth];
+        int32_t y[SimdWidth];
+
+        constexpr LaneLayout() : x(), y() {
+            for (uint32_t lane = 0; lane < SimdWidth; ++lane) {
+                x[lane] = int32_t(2 * (lane / 4) + (lane & 1));
+                y[lane] = int32_t((lane >> 1) & 1);
+            }
+        }
+    };
+    constexpr LaneLayout Lanes;
+
+    bool Compare(CompareOp op, float a, float b) noexcept {
+        switch (op) {
+            case CompareOp::Never: return false;
+            case CompareOp::Less: return a < b;
+            case CompareOp::Equal: return a == b;
+            case CompareOp::LessOrEqual: return a <= b;
+            case CompareOp::Greater: return a > b;
+            case CompareOp::NotEqual: return a != b;
+            case CompareOp::GreaterOrEqual: return a >= b;
+            case CompareOp::Always: return true;
+        }
+        return true;
+    }
+
+    uint8_t ApplyStencilOp(StencilOp op, uint8_t value, uint8_t reference) noexcept {
+        switch (op) {
+            case StencilOp::Keep: return value;
+            case StencilOp::Zero: return 0;
+            case StencilOp::Replace: return reference;
+            case StencilOp::IncrementAndClamp: return value == 0xFF ? value : uint8_t(value + 1);
+            case StencilOp::DecrementAndClamp: return value == 0 ? value : uint8_t(value - 1);
+            case StencilOp::Invert: return uint8_t(~value);
+            case StencilOp::IncrementAndWrap: return uint8_t(value + 1);
+            case StencilOp::DecrementAndWrap: return uint8_t(value - 1);
+        }
+        return value;
+    }
+
+    float GetBlendFactor(BlendFactor factor, uint32_t c, const float (&src)[4], const float (&dst)[4],
+                         const float (&constants)[4]) noexcept {
+        switch (factor) {
+            case BlendFactor::Zero: return 0.0f;
+            case BlendFactor::One: return 1.0f;
+            case BlendFactor::SrcColor: return src[c];
+            case BlendFactor::OneMinusSrcColor: return 1.0f - src[c];
+            case BlendFactor::DstColor: return dst[c];
+            case BlendFactor::OneMinusDstColor: return 1.0f - dst[c];
+            case BlendFactor::SrcAlpha: return src[3];
+            case BlendFactor::OneMinusSrcAlpha: return 1.0f - src[3];
+            case BlendFactor::DstAlpha: return dst[3];
+            case BlendFactor::OneMinusDstAlpha: return 1.0f - dst[3];
+            case BlendFactor::ConstantColor: return constants[c];
+            case BlendFactor::OneMinusConstantColor: return 1.0f - constants[c];
+            case BlendFactor::ConstantAlpha: return constants[3];
+            case BlendFactor::OneMinusConstantAlpha: return 1.0f - constants[3];
+            case BlendFactor::SrcAlphaSaturate: return c == 3 ? 1.0f : std::min(src[3], 1.0f - dst[3]);
+        }
+        return 1.0f;
+    }
+
+    float Blend(BlendOp op, float src, float srcFactor, float dst, float dstFactor) noexcept {
+        switch (op) {
+            case BlendOp::Add: return src * srcFactor + dst * dstFactor;
+            case BlendOp::Subtract: return src * srcFactor - dst * dstFactor;
+            case BlendOp::ReverseSubtract: return dst * dstFactor - src * srcFactor;
+            case BlendOp::Min: return std::min(src, dst);
+            case BlendOp::Max: return std::max(src, dst);
+        }
+        return src;
+    }
+
+    /// Smallest depth difference a depth format resolves near `depth`
+    float GetDepthUnit(TextureFormat format, float depth) noexcept {
+        switch (format) {
+            case TextureFormat::Depth16: return 1.0f / 65535.0f;
+            case TextureFormat::Depth24Stencil8: return 1.0f / 16777215.0f;
+            default: {
+                int exponent = 0;
+                std::frexp(std::max(depth, std::numeric_limits<float>::min()), &exponent);
+                return std::ldexp(1.0f, exponent - 24);
+            }
+        }
+    }
+
+    Rect2D Intersect(const Rect2D& a, const Rect2D& b) noexcept {
+        const int64_t x0 = std::max<int64_t>(a.x, b.x);
+        const int64_t y0 = std::max<int64_t>(a.y, b.y);
+        const int64_t x1 = std::min<int64_t>(int64_t(a.x) + a.width, int64_t(b.x) + b.width);
+        const int64_t y1 = std::min<int64_t>(int64_t(a.y) + a.height, int64_t(b.y) + b.height);
+        if (x1 <= x0 || y1 <= y0) {
+            return Rect2D{int32_t(x0), int32_t(y0), 0, 0};
+        }
+        return Rect2D{int32_t(x0), int32_t(y0), uint32_t(x1 - x0), uint32_t(y1 - y0)};
+    }
+}
+
+// ============================================================================
+// Internal State
+// ============================================================================
+
+/// Memory for shaded and clipped vertices that lives until the next flush
+struct SoftwareRasterizer::Arena {
+    struct Block {
+        std::unique_ptr<uint32_t[]> words;
+        size_t size = 0;
+    };
+
+    std::vector<Block> blocks;
+    size_t current = 0;
+    size_t used = 0;        // In the current block
+    size_t allocated = 0;   // Since the last reset
+
+    uint32_t* Allocate(size_t count) {
+        allocated += count;
+        while (current < blocks.size()) {
+            if (used + count <= blocks[current].size) {
+                uint32_t* words = blocks[current].words.get() + used;
+                used += count;
+                return words;
+            }
+            ++current;
+            used = 0;
+        }
+        const size_t size = std::max(count, ArenaBlockWords);
+        blocks.push_back({std::make_unique<uint32_t[]>(size), size});
+        current = blocks.size() - 1;
+        used = count;
+        return blocks.back().words.get();
+    }
+
+    void Reset() noexcept {
+        current = 0;
+        used = 0;
+        allocated = 0;
+    }
+};
+
+/// A triangle ready to be rasterized, wound counter-clockwise
+struct SoftwareRasterizer::Triangle {
+    const uint32_t* vertices[3];
+    const uint32_t* provoking;      // Flat varyings
+    uint32_t draw;
+    bool frontFacing;
+
+    // Covered pixels, inclusive and within the draw's clip rectangle
+    int32_t minX, minY, maxX, maxY;
+
+    // Edge functions a * x + b * y + c of the edges opposite each vertex,
+    // over fixed-point sample positions; a sample is covered when all are
+    // non-negative
+    int32_t a[3];
+    int32_t b[3];
+    int64_t c[3];
+    double invArea;
+
+    float z[3];                     // Window depth
+    float invW[3];
+    float depthOffset;
+};
+
+/// A color or depth attachment of the current framebuffer
+struct SoftwareRasterizer::Attachment {
+    SoftwareTexture* texture = nullptr;
+    TextureFormat format = TextureFormat::RGBA8_UNorm;
+    std::byte* data = nullptr;
+    size_t rowPitch = 0;
+    uint32_t texelSize = 0;
+    bool isInteger = false;
+    bool isNormalized = false;
+    bool hasStencil = false;
+};
+
+/// A draw as its primitives are rendered
+struct SoftwareRasterizer::BinnedDraw {
+    SoftwareDrawState state;
+    SoftwarePipeline* pipeline = nullptr;
+    const SoftwareShaderProgram* fragment = nullptr;
+    uint32_t vertexWords = 0;
+
+    // Viewport transform: window = offset + ndc * scale
+    float scaleX = 0.0f;
+    float scaleY = 0.0f;
+    float offsetX = 0.0f;
+    float offsetY = 0.0f;
+    float depthScale = 0.0f;
+    float depthOffset = 0.0f;
+    float minDepth = 0.0f;
+    float maxDepth = 1.0f;
+
+    // Normalized device coordinates of the guard band, which primitives
+    // are clipped to, and of the clip rectangle, outside of which they are
+    // discarded whole
+    float guard[4] = {};            // Min x, max x, min y, max y
+    float reject[4] = {};
+
+    // Scissor, render area and attachments, inclusive
+    int32_t clipMinX = 0;
+    int32_t clipMinY = 0;
+    int32_t clipMaxX = -1;
+    int32_t clipMaxY = -1;
+
+    // Depth and stencil tests run before shading (and write), are checked
+    // before shading to skip fragments that cannot pass, or run after it
+    bool earlyTests = true;
+    bool preCull = false;
+    bool depthClamp = false;
+};
+
+/// Fragments waiting to be shaded by one thread
+struct SoftwareRasterizer::TileScratch {
+    static constexpr uint32_t Lanes = SoftwarePipeline::BatchSize;
+
+    uint32_t thread = 0;
+    const BinnedDraw* draw = nullptr;
+    uint32_t count = 0;             // Lanes, four per quad
+    const Triangle* triangles[Lanes / 4];
+    int32_t x[Lanes];
+    int32_t y[Lanes];
+    bool live[Lanes];               // Covered and not rejected by early tests
+    float z[Lanes];
+    float invW[Lanes];
+    float b[Lanes][2];              // Barycentrics of vertices 1 and 2
+    float pb[Lanes][2];             // Perspective-correct barycentrics
+};
+
+SoftwareRasterizer::SoftwareRasterizer(ThreadPool& threads)
+    : m_threads(threads)
+    , m_arenas(threads.GetThreadCount())
+    , m_tileScratch(threads.GetThreadCount())
+{
+    for (uint32_t thread = 0; thread < m_tileScratch.size(); ++thread) {
+        m_tileScratch[thread].thread = thread;
+    }
+}
+
+SoftwareRasterizer::~SoftwareRasterizer() = default;
+
+// ============================================================================
+// Render Targets
+// ============================================================================
+
+void SoftwareRasterizer::Begin(const SoftwareFramebuffer& framebuffer, const Rect2D& renderArea) {
+    m_colors.clear();
+    m_depth.reset();
+    for (SoftwareTexture* texture : framebuffer.GetAttachments()) {
+        Attachment attachment;
+        attachment.texture = texture;
+        attachment.format = texture->GetFormat();
+        attachment.data = texture->GetSubresource(0, 0);
+        attachment.texelSize = texture->GetTexelSize();
+        attachment.rowPitch = size_t(texture->GetWidth()) * attachment.texelSize;
+        attachment.isInteger = SoftwareFormatUtils::IsIntegerFormat(attachment.format);
+        attachment.isNormalized = SoftwareFormatUtils::IsNormalizedFormat(attachment.format);
+        attachment.hasStencil = SoftwareFormatUtils::HasStencil(attachment.format);
+        if (SoftwareFormatUtils::IsDepthFormat(attachment.format)) {
+            m_depth = std::make_unique<Attachment>(attachment);
+        } else {
+            m_colors.push_back(attachment);
+        }
+    }
+
+    const uint32_t width = std::min(framebuffer.GetWidth(), MaxFramebufferSize);
+    const uint32_t height = std::min(framebuffer.GetHeight(), MaxFramebufferSize);
+    m_renderArea = Intersect(renderArea, Rect2D{0, 0, width, height});
+    m_tilesX = (width + TileSize - 1) / TileSize;
+    m_tilesY = (height + TileSize - 1) / TileSize;
+    m_bins.resize(size_t(m_tilesX) * m_tilesY);
+}
+
+void SoftwareRasterizer::End() {
+    Flush();
+    m_colors.clear();
+    m_depth.reset();
+}
+
+std::byte* SoftwareRasterizer::GetTexel(const Attachment& attachment, int32_t x, int32_t y) const noexcept {
+    return attachment.data + size_t(y) * attachment.rowPitch + size_t(x) * attachment.texelSize;
+}
+
+void SoftwareRasterizer::ClearColor(uint32_t index, const ClearColorValue& value, const Rect2D& rect) {
+    if (index >= m_colors.size()) {
+        return;
+    }
+    Flush();
+
+    const Attachment& attachment = m_colors[index];
+    const Rect2D area = Intersect(rect, m_renderArea);
+    uint32_t words[4];
+    std::memcpy(words, attachment.isInteger ? static_cast<const void*>(value.uint32) : value.float32, sizeof(words));
+    std::byte texel[16];
+    SoftwareFormatUtils::Encode(attachment.format, words, texel);
+
+    m_threads.ParallelFor(area.height, [&](uint32_t row, uint32_t) {
+        std::byte* target = GetTexel(attachment, area.x, area.y + int32_t(row));
+        for (uint32_t x = 0; x < area.width; ++x) {
+            std::memcpy(target + size_t(x) * attachment.texelSize, texel, attachment.texelSize);
+        }
+    });
+}
+
+void SoftwareRasterizer::ClearDepthStencil(bool depth, bool stencil, const ClearDepthStencilValue& value,
+                                           const Rect2D& rect) {
+    if (!m_depth) {
+        return;
+    }
+    Flush();
+
+    const Attachment& attachment = *m_depth;
+    stencil = stencil && attachment.hasStencil;
+    const Rect2D area = Intersect(rect, m_renderArea);
+    m_threads.ParallelFor(area.height, [&](uint32_t row, uint32_t) {
+        std::byte* target = GetTexel(attachment, area.x, area.y + int32_t(row));
+        for (uint32_t x = 0; x < area.width; ++x, target += attachment.texelSize) {
+            if (depth) {
+                SoftwareFormatUtils::EncodeDepth(attachment.format, value.depth, target);
+            }
+            if (stencil) {
+                SoftwareFormatUtils::EncodeStencil(attachment.format, uint8_t(value.stencil), target);
+            }
+        }
+    });
+}
+
+// ============================================================================
+// Draws
+// ============================================================================
+
+bool SoftwareRasterizer::ShouldFlush() const noexcept {
+    size_t words = 0;
+    for (const Arena& arena : m_arenas) {
+        words += arena.allocated;
+    }
+    return m_triangles.size() >= MaxBinnedTriangles || words >= MaxArenaWords;
+}
+
+void SoftwareRasterizer::Draw(const SoftwareDrawState& state, const SoftwareDrawCall& call) {
+    SoftwarePipeline& pipeline = *state.pipeline;
+    const GraphicsPipelineDesc& desc = pipeline.GetGraphicsDesc();
+    if (desc.rasterization.rasterizerDiscardEnable || call.count == 0 || call.instanceCount == 0) {
+        return;
+    }
+
+    BinnedDraw draw;
+    draw.state = state;
+    draw.pipeline = &pipeline;
+    draw.fragment = pipeline.GetFragmentProgram();
+    draw.vertexWords = pipeline.GetVertexWords();
+
+    // Where primitives may produce fragments
+    const Rect2D clip = Intersect(state.scissor, m_renderArea);
+    const Viewport& viewport = state.viewport;
+    if (clip.width == 0 || clip.height == 0 || viewport.width == 0.0f || viewport.height == 0.0f) {
+        return;
+    }
+    draw.clipMinX = clip.x;
+    draw.clipMinY = clip.y;
+    draw.clipMaxX = clip.x + int32_t(clip.width) - 1;
+    draw.clipMaxY = clip.y + int32_t(clip.height) - 1;
+
+    draw.scaleX = viewport.width * 0.5f;
+    draw.scaleY = viewport.height * 0.5f;
+    draw.offsetX = viewport.x + draw.scaleX;
+    draw.offsetY = viewport.y + draw.scaleY;
+    draw.depthScale = (viewport.maxDepth - viewport.minDepth) * 0.5f;
+    draw.depthOffset = (viewport.maxDepth + viewport.minDepth) * 0.5f;
+    draw.minDepth = std::min(viewport.minDepth, viewport.maxDepth);
+    draw.maxDepth = std::max(viewport.minDepth, viewport.maxDepth);
+    draw.depthClamp = desc.rasterization.depthClampEnable;
+
+    const auto toNdc = [](float window, float offset, float scale, float& min, float& max) {
+        min = (-window - offset) / scale;
+        max = (window - offset) / scale;
+        if (min > max) {
+            std::swap(min, max);
+        }
+    };
+    toNdc(GuardBand, draw.offsetX, draw.scaleX, draw.guard[0], draw.guard[1]);
+    toNdc(GuardBand, draw.offsetY, draw.scaleY, draw.guard[2], draw.guard[3]);
+    const float rejectX[2] = {(float(draw.clipMinX) - draw.offsetX) / draw.scaleX,
+                              (float(draw.clipMaxX + 1) - draw.offsetX) / draw.scaleX};
+    const float rejectY[2] = {(float(draw.clipMinY) - draw.offsetY) / draw.scaleY,
+                              (float(draw.clipMaxY + 1) - draw.offsetY) / draw.scaleY};
+    draw.reject[0] = std::min(rejectX[0], rejectX[1]);
+    draw.reject[1] = std::max(rejectX[0], rejectX[1]);
+    draw.reject[2] = std::min(rejectY[0], rejectY[1]);
+    draw.reject[3] = std::max(rejectY[0], rejectY[1]);
+
+    // Tests before shading where nothing can tell the difference. Otherwise
+    // fragments are still checked against the depth buffer before shading
+    // when a later write can only make the test stricter.
+    const DepthStencilState& depthStencil = desc.depthStencil;
+    const SoftwareShaderProgram* fragment = draw.fragment;
+    draw.earlyTests = !fragment || fragment->HasEarlyFragmentTests() ||
+                      (!fragment->WritesDepth() && !fragment->CanDiscard() && !fragment->HasSideEffects());
+    const bool stencil = m_depth && m_depth->hasStencil && depthStencil.stencilTestEnable;
+    const CompareOp depthOp = depthStencil.depthCompareOp;
+    const bool monotonic = depthOp == CompareOp::Less || depthOp == CompareOp::LessOrEqual ||
+                           depthOp == CompareOp::Greater || depthOp == CompareOp::GreaterOrEqual;
+    draw.preCull = !draw.earlyTests && !fragment->WritesDepth() && !fragment->HasSideEffects() && !stencil &&
+                   depthStencil.depthTestEnable && monotonic && !depthStencil.depthBoundsTestEnable;
+
+    // Unique vertices, and the one each element of the draw uses
+    m_vertexIds.clear();
+    m_indexSlots.clear();
+    uint32_t count = call.count;
+    if (call.indices) {
+        const size_t indexSize = call.use16BitIndices ? 2 : 4;
+        count = static_cast<uint32_t>(std::min<size_t>(count, call.indexBytes / indexSize));
+        const uint32_t restart = call.use16BitIndices ? 0xFFFFu : 0xFFFFFFFFu;
+        const bool restartEnabled = desc.inputAssembly.primitiveRestartEnable;
+
+        const auto readIndex = [&](uint32_t i) {
+            if (call.use16BitIndices) {
+                uint16_t value;
+                std::memcpy(&value, call.indices + size_t(i) * 2, 2);
+                return uint32_t(value);
+            }
+            uint32_t value;
+            std::memcpy(&value, call.indices + size_t(i) * 4, 4);
+            return value;
+        };
+        uint32_t minIndex = UINT32_MAX;
+        uint32_t maxIndex = 0;
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint32_t index = readIndex(i);
+            if (!(restartEnabled && index == restart)) {
+                minIndex = std::min(minIndex, index);
+                maxIndex = std::max(maxIndex, index);
+            }
+        }
+
+        // Slots of compact index ranges are looked up in a table
+        const bool useTable = minIndex <= maxIndex && uint64_t(maxIndex - minIndex) <= uint64_t(count) * 4 + 1024;
+        std::unordered_map<uint32_t, uint32_t> slotMap;
+        if (useTable) {
+            m_slotTable.assign(size_t(maxIndex - minIndex) + 1, RestartSlot);
+        }
+        m_indexSlots.resize(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint32_t index = readIndex(i);
+            if (restartEnabled && index == restart) {
+                m_indexSlots[i] = RestartSlot;
+                continue;
+            }
+            uint32_t* slot;
+            if (useTable) {
+                slot = &m_slotTable[index - minIndex];
+            } else {
+                slot = &slotMap.try_emplace(index, RestartSlot).first->second;
+            }
+            if (*slot == RestartSlot) {
+                *slot = static_cast<uint32_t>(m_vertexIds.size());
+                m_vertexIds.push_back(uint32_t(int64_t(index) + call.vertexOffset));
+            }
+            m_indexSlots[i] = *slot;
+        }
+    } else {
+        m_vertexIds.resize(count);
+        m_indexSlots.resize(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            m_vertexIds[i] = call.first + i;
+            m_indexSlots[i] = i;
+        }
+    }
+
+    // Primitives, as runs of unique vertices
+    m_primitiveSlots.clear();
+    const PrimitiveTopology topology = desc.inputAssembly.topology;
+    uint32_t primitiveSize = 3;
+    if (topology == PrimitiveTopology::PointList) {
+        primitiveSize = 1;
+    } else if (topology == PrimitiveTopology::LineList || topology == PrimitiveTopology::LineStrip) {
+        primitiveSize = 2;
+    }
+    for (size_t runStart = 0; runStart < m_indexSlots.size();) {
+        size_t runEnd = runStart;
+        while (runEnd < m_indexSlots.size() && m_indexSlots[runEnd] != RestartSlot) {
+            ++runEnd;
+        }
+        const uint32_t* run = m_indexSlots.data() + runStart;
+        const size_t length = runEnd - runStart;
+        switch (topology) {
+            case PrimitiveTopology::PointList:
+            case PrimitiveTopology::LineList:
+            case PrimitiveTopology::TriangleList:
+                for (size_t i = 0; i + primitiveSize <= length; i += primitiveSize) {
+                    m_primitiveSlots.insert(m_primitiveSlots.end(), run + i, run + i + primitiveSize);
+                }
+                break;
+            case PrimitiveTopology::LineStrip:
+                for (size_t i = 0; i + 1 < length; ++i) {
+                    m_primitiveSlots.insert(m_primitiveSlots.end(), {run[i], run[i + 1]});
+                }
+                break;
+            case PrimitiveTopology::TriangleStrip:
+                // Odd triangles swap their first two vertices to keep the winding
+                for (size_t i = 0; i + 2 < length; ++i) {
+                    if (i % 2 == 0) {
+                        m_primitiveSlots.insert(m_primitiveSlots.end(), {run[i], run[i + 1], run[i + 2]});
+                    } else {
+                        m_primitiveSlots.insert(m_primitiveSlots.end(), {run[i + 1], run[i], run[i + 2]});
+                    }
+                }
+                break;
+            case PrimitiveTopology::TriangleFan:
+                for (size_t i = 1; i + 1 < length; ++i) {
+                    m_primitiveSlots.insert(m_primitiveSlots.end(), {run[0], run[i], run[i + 1]});
+                }
+                break;
+            default:
+                break;
+        }
+        runStart = runEnd + 1;
+    }
+    const auto primitiveCount = static_cast<uint32_t>(m_primitiveSlots.size() / primitiveSize);
+    if (primitiveCount == 0) {
+        return;
+    }
+
+    for (uint32_t instance = 0; instance < call.instanceCount; ++instance) {
+        if (ShouldFlush()) {
+            Flush();
+        }
+        const auto drawIndex = static_cast<uint32_t>(m_draws.size());
+        m_draws.push_back(draw);
+
+        uint32_t* vertices = m_arenas[0].Allocate(m_vertexIds.size() * draw.vertexWords);
+        ShadeVertices(m_draws.back(), call, instance, vertices);
+
+        const uint32_t chunkCount = (primitiveCount + ChunkPrimitives - 1) / ChunkPrimitives;
+        if (m_chunks.size() < chunkCount) {
+            m_chunks.resize(chunkCount);
+        }
+        m_threads.ParallelFor(chunkCount, [&](uint32_t chunk, uint32_t thread) {
+            std::vector<Triangle>& output = m_chunks[chunk];
+            output.clear();
+            const uint32_t first = chunk * ChunkPrimitives;
+            const uint32_t last = std::min(first + ChunkPrimitives, primitiveCount);
+            for (uint32_t primitive = first; primitive < last; ++primitive) {
+                const uint32_t* primitiveVertices[3];
+                for (uint32_t i = 0; i < primitiveSize; ++i) {
+                    const uint32_t slot = m_primitiveSlots[size_t(primitive) * primitiveSize + i];
+                    primitiveVertices[i] = vertices + size_t(slot) * draw.vertexWords;
+                }
+                SetupPrimitive(m_draws[drawIndex], drawIndex, primitiveVertices, primitiveSize,
+                               m_arenas[thread], output);
+            }
+        });
+
+        // Bin in submission order
+        for (uint32_t chunk = 0; chunk < chunkCount; ++chunk) {
+            for (const Triangle& triangle : m_chunks[chunk]) {
+                m_triangles.push_back(triangle);
+                Bin(static_cast<uint32_t>(m_triangles.size() - 1));
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::ShadeVertices(BinnedDraw& draw, const SoftwareDrawCall& call, uint32_t instance,
+                                       uint32_t* output) {
+    SoftwarePipeline& pipeline = *draw.pipeline;
+    const auto& inputs = pipeline.GetVertexInputs();
+    const auto& sources = pipeline.GetVaryingSources();
+    const SoftwarePipeline::Builtins& builtins = pipeline.GetBuiltins();
+    const uint32_t vertexWords = draw.vertexWords;
+    const auto vertexCount = static_cast<uint32_t>(m_vertexIds.size());
+    const uint32_t batchCount = (vertexCount + SoftwarePipeline::BatchSize - 1) / SoftwarePipeline::BatchSize;
+
+    const auto writeWord = [](std::byte* memory, int32_t offset, uint32_t value) {
+        if (offset >= 0) {
+            std::memcpy(memory + offset, &value, sizeof(value));
+        }
+    };
+
+    m_threads.ParallelFor(batchCount, [&](uint32_t batch, uint32_t thread) {
+        SoftwareShaderContext& context = pipeline.GetContext(0, thread);
+        const uint32_t first = batch * SoftwarePipeline::BatchSize;
+        const uint32_t laneCount = std::min(SoftwarePipeline::BatchSize, vertexCount - first);
+        context.ResetInvocationMemory(laneCount);
+
+        for (uint32_t lane = 0; lane < laneCount; ++lane) {
+            std::byte* memory = context.GetInvocationMemory(lane);
+            const uint32_t vertexId = m_vertexIds[first + lane];
+            for (const SoftwarePipeline::VertexInput& input : inputs) {
+                uint32_t words[4] = {0, 0, 0, input.isFloat ? AsWord(1.0f) : 1u};
+                if (input.components > 0 && input.binding < SoftwareDrawCall::MaxVertexBuffers) {
+                    const SoftwareDrawCall::VertexBuffer& buffer = call.vertexBuffers[input.binding];
+                    const uint64_t element = input.perInstance ? uint64_t(call.firstInstance) + instance : vertexId;
+                    const uint64_t offset = element * input.stride + input.attributeOffset;
+                    if (buffer.data && offset + input.components * 4 <= buffer.size) {
+                        std::memcpy(words, buffer.data + offset, input.components * 4);
+                    }
+                }
+                std::memcpy(memory + input.offset, words, std::min(input.words, 4u) * 4);
+            }
+            writeWord(memory, builtins.vertexIndex, vertexId);
+            writeWord(memory, builtins.instanceIndex, call.firstInstance + instance);
+            writeWord(memory, builtins.baseVertex, call.indices ? uint32_t(call.vertexOffset) : call.first);
+            writeWord(memory, builtins.baseInstance, call.firstInstance);
+            writeWord(memory, builtins.drawIndex, call.drawIndex);
+        }
+
+        context.Run(draw.state.bindings, laneCount);
+
+        for (uint32_t lane = 0; lane < laneCount; ++lane) {
+            const std::byte* memory = context.GetInvocationMemory(lane);
+            uint32_t* vertex = output + size_t(first + lane) * vertexWords;
+            std::memset(vertex, 0, size_t(vertexWords) * 4);
+            if (builtins.position >= 0) {
+                std::memcpy(vertex + SoftwarePipeline::VertexPosition, memory + builtins.position, 16);
+            }
+            vertex[SoftwarePipeline::VertexPointSize] = AsWord(1.0f);
+            if (builtins.pointSize >= 0) {
+                std::memcpy(vertex + SoftwarePipeline::VertexPointSize, memory + builtins.pointSize, 4);
+            }
+            for (const SoftwarePipeline::VaryingSource& source : sources) {
+                std::memcpy(vertex + source.slot, memory + source.offset, size_t(source.words) * 4);
+            }
+        }
+    });
+}
+
+// ============================================================================
+// Primitive Setup
+// ============================================================================
+
+namespace {
+    /// Planes primitives are tested against in clip space; the first ones
+    /// are clipped to, the reject planes only discard primitives whole
+    enum ClipPlane : uint32_t {
+        PlaneW,
+        PlaneNear,
+        PlaneFar,
+        PlaneGuardMinX,
+        PlaneGuardMaxX,
+        PlaneGuardMinY,
+        PlaneGuardMaxY,
+        ClipPlaneCount,
+        PlaneRejectMinX = ClipPlaneCount,
+        PlaneRejectMaxX,
+        PlaneRejectMinY,
+        PlaneRejectMaxY,
+        PlaneCount,
+    };
+
+    constexpr uint32_t ClipPlaneMask = (1u << ClipPlaneCount) - 1;
+
+    /// Signed distance of a clip space position to a plane; inside is >= 0
+    template<typename DrawT>
+    float GetPlaneDistance(const DrawT& draw, uint32_t plane, const float (&p)[4]) noexcept {
+        switch (plane) {
+            case PlaneW: return p[3] - MinW;
+            case PlaneNear: return p[2] + p[3];
+            case PlaneFar: return p[3] - p[2];
+            case PlaneGuardMinX: return p[0] - draw.guard[0] * p[3];
+            case PlaneGuardMaxX: return draw.guard[1] * p[3] - p[0];
+            case PlaneGuardMinY: return p[1] - draw.guard[2] * p[3];
+            case PlaneGuardMaxY: return draw.guard[3] * p[3] - p[1];
+            case PlaneRejectMinX: return p[0] - draw.reject[0] * p[3];
+            case PlaneRejectMaxX: return draw.reject[1] * p[3] - p[0];
+            case PlaneRejectMinY: return p[1] - draw.reject[2] * p[3];
+            case PlaneRejectMaxY: return draw.reject[3] * p[3] - p[1];
+            default: return 0.0f;
+        }
+    }
+
+    void GetPosition(const uint32_t* vertex, float (&p)[4]) noexcept {
+        for (uint32_t i = 0; i < 4; ++i) {
+            p[i] = AsFloat(vertex[SoftwarePipeline::VertexPosition + i]);
+        }
+    }
+
+    /// Planes a vertex is outside of
+    template<typename DrawT>
+    uint32_t GetOutcode(const DrawT& draw, const uint32_t* vertex) noexcept {
+        float p[4];
+        GetPosition(vertex, p);
+        uint32_t code = 0;
+        for (uint32_t plane = 0; plane < PlaneCount; ++plane) {
+            if ((plane == PlaneNear || plane == PlaneFar) && draw.depthClamp) {
+                continue;
+            }
+            if (!(GetPlaneDistance(draw, plane, p) >= 0.0f)) {
+                code |= 1u << plane;
+            }
+        }
+        return code;
+    }
+
+    void Interpolate(const uint32_t* a, const uint32_t* b, float t, uint32_t words, uint32_t* result) noexcept {
+        for (uint32_t i = 0; i < words; ++i) {
+            const float x = AsFloat(a[i]);
+            result[i] = AsWord(x + (AsFloat(b[i]) - x) * t);
+        }
+    }
+}
+
+void SoftwareRasterizer::SetupPrimitive(const BinnedDraw& draw, uint32_t drawIndex, const uint32_t* const* vertices,
+                                        uint32_t vertexCount, Arena& arena, std::vector<Triangle>& output) const {
+    if (vertexCount == 1) {
+        SetupPoint(draw, drawIndex, vertices[0], vertices[0], true, arena, output);
+        return;
+    }
+    if (vertexCount == 2) {
+        SetupLine(draw, drawIndex, vertices[0], vertices[1], vertices[1], true, arena, output);
+        return;
+    }
+
+    const uint32_t* const triangle[3] = {vertices[0], vertices[1], vertices[2]};
+    const RasterizationState& rasterization = draw.pipeline->GetGraphicsDesc().rasterization;
+    if (rasterization.polygonMode == PolygonMode::Fill) {
+        SetupTriangle(draw, drawIndex, triangle, vertices[2], Facing::Compute, arena, output);
+        return;
+    }
+
+    // Edges or vertices of the polygon, which is culled as a whole; facing
+    // is only known when the whole polygon is in front of the eye
+    bool frontFacing = true;
+    float p[3][4];
+    for (uint32_t i = 0; i < 3; ++i) {
+        GetPosition(triangle[i], p[i]);
+    }
+    if (p[0][3] > 0.0f && p[1][3] > 0.0f && p[2][3] > 0.0f) {
+        float x[3];
+        float y[3];
+        for (uint32_t i = 0; i < 3; ++i) {
+            x[i] = draw.offsetX + p[i][0] / p[i][3] * draw.scaleX;
+            y[i] = draw.offsetY + p[i][1] / p[i][3] * draw.scaleY;
+        }
+        const float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        if (area == 0.0f) {
+            return;
+        }
+        frontFacing = (area > 0.0f) == (rasterization.frontFace == FrontFace::CounterClockwise);
+    }
+    if (rasterization.cullMode == CullMode::FrontAndBack ||
+        (rasterization.cullMode == CullMode::Front && frontFacing) ||
+        (rasterization.cullMode == CullMode::Back && !frontFacing)) {
+        return;
+    }
+    for (uint32_t i = 0; i < 3; ++i) {
+        if (rasterization.polygonMode == PolygonMode::Line) {
+            SetupLine(draw, drawIndex, triangle[i], triangle[(i + 1) % 3], triangle[2], frontFacing, arena, output);
+        } else {
+            SetupPoint(draw, drawIndex, triangle[i], triangle[2], frontFacing, arena, output);
+        }
+    }
+}
+
+void SoftwareRasterizer::SetupTriangle(const BinnedDraw& draw, uint32_t drawIndex, const uint32_t* const (&vertices)[3],
+                                       const uint32_t* provoking, Facing facing, Arena& arena,
+                                       std::vector<Triangle>& output) const {
+    const uint32_t codes[3] = {GetOutcode(draw, vertices[0]), GetOutcode(draw, vertices[1]),
+                               GetOutcode(draw, vertices[2])};
+    if (codes[0] & codes[1] & codes[2]) {
+        return;
+    }
+    const uint32_t clipPlanes = (codes[0] | codes[1] | codes[2]) & ClipPlaneMask;
+    if (clipPlanes == 0) {
+        SetupClipped(draw, drawIndex, vertices, provoking, facing, output);
+        return;
+    }
+
+    // Sutherland-Hodgman in clip space, one plane after another
+    constexpr uint32_t MaxVertices = 3 + ClipPlaneCount;
+    const uint32_t* polygon[MaxVertices] = {vertices[0], vertices[1], vertices[2]};
+    const uint32_t* clipped[MaxVertices];
+    uint32_t count = 3;
+    for (uint32_t plane = 0; plane < ClipPlaneCount && count >= 3; ++plane) {
+        if (!(clipPlanes & (1u << plane))) {
+            continue;
+        }
+        uint32_t clippedCount = 0;
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint32_t* a = polygon[i];
+            const uint32_t* b = polygon[(i + 1) % count];
+            float pa[4];
+            float pb[4];
+            GetPosition(a, pa);
+            GetPosition(b, pb);
+            const float da = GetPlaneDistance(draw, plane, pa);
+            const float db = GetPlaneDistance(draw, plane, pb);
+            if (da >= 0.0f) {
+                clipped[clippedCount++] = a;
+            }
+            if ((da >= 0.0f) != (db >= 0.0f)) {
+                uint32_t* vertex = arena.Allocate(draw.vertexWords);
+                // Always interpolate from the inside vertex for watertight edges
+                if (da >= 0.0f) {
+                    Interpolate(a, b, da / (da - db), draw.vertexWords, vertex);
+                } else {
+                    Interpolate(b, a, db / (db - da), draw.vertexWords, vertex);
+                }
+                clipped[clippedCount++] = vertex;
+            }
+        }
+        std::copy_n(clipped, clippedCount, polygon);
+        count = clippedCount;
+    }
+
+    for (uint32_t i = 1; i + 1 < count; ++i) {
+        const uint32_t* const triangle[3] = {polygon[0], polygon[i], polygon[i + 1]};
+        SetupClipped(draw, drawIndex, triangle, provoking, facing, output);
+    }
+}
+
+void SoftwareRasterizer::SetupClipped(const BinnedDraw& draw, uint32_t drawIndex, const uint32_t* const (&vertices)[3],
+                                      const uint32_t* provoking, Facing facing,
+                                      std::vector<Triangle>& output) const {
+    constexpr float SubpixelScale = float(1 << SubpixelBits);
+
+    Triangle triangle;
+    int32_t x[3];
+    int32_t y[3];
+    for (uint32_t i = 0; i < 3; ++i) {
+        float p[4];
+        GetPosition(vertices[i], p);
+        const float invW = 1.0f / p[3];
+        x[i] = int32_t(std::lrint((draw.offsetX + p[0] * invW * draw.scaleX) * SubpixelScale));
+        y[i] = int32_t(std::lrint((draw.offsetY + p[1] * invW * draw.scaleY) * SubpixelScale));
+        triangle.vertices[i] = vertices[i];
+        triangle.invW[i] = invW;
+        triangle.z[i] = draw.depthOffset + p[2] * invW * draw.depthScale;
+    }
+
+    int64_t area = int64_t(x[1] - x[0]) * (y[2] - y[0]) - int64_t(x[2] - x[0]) * (y[1] - y[0]);
+    if (area == 0) {
+        return;
+    }
+
+    const RasterizationState& rasterization = draw.pipeline->GetGraphicsDesc().rasterization;
+    if (facing == Facing::Compute) {
+        triangle.frontFacing = (area > 0) == (rasterization.frontFace == FrontFace::CounterClockwise);
+        if (rasterization.cullMode == CullMode::FrontAndBack ||
+            (rasterization.cullMode == CullMode::Front && triangle.frontFacing) ||
+            (rasterization.cullMode == CullMode::Back && !triangle.frontFacing)) {
+            return;
+        }
+    } else {
+        triangle.frontFacing = facing == Facing::Front;
+    }
+
+    if (area < 0) {
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+        std::swap(triangle.vertices[1], triangle.vertices[2]);
+        std::swap(triangle.invW[1], triangle.invW[2]);
+        std::swap(triangle.z[1], triangle.z[2]);
+        area = -area;
+    }
+
+    // Pixels whose centers the bounding box contains
+    constexpr int32_t Half = 1 << (SubpixelBits - 1);
+    constexpr int32_t Round = (1 << SubpixelBits) - 1;
+    triangle.minX = std::max((std::min({x[0], x[1], x[2]}) - Half + Round) >> SubpixelBits, draw.clipMinX);
+    triangle.minY = std::max((std::min({y[0], y[1], y[2]}) - Half + Round) >> SubpixelBits, draw.clipMinY);
+    triangle.maxX = std::min((std::max({x[0], x[1], x[2]}) - Half) >> SubpixelBits, draw.clipMaxX);
+    triangle.maxY = std::min((std::max({y[0], y[1], y[2]}) - Half) >> SubpixelBits, draw.clipMaxY);
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+        return;
+    }
+
+    // Edge functions; samples exactly on an edge belong to the triangle
+    // if the edge is a top or left one
+    for (uint32_t i = 0; i < 3; ++i) {
+        const uint32_t from = (i + 1) % 3;
+        const uint32_t to = (i + 2) % 3;
+        triangle.a[i] = y[from] - y[to];
+        triangle.b[i] = x[to] - x[from];
+        triangle.c[i] = -int64_t(triangle.a[i]) * x[from] - int64_t(triangle.b[i]) * y[from];
+        const bool topLeft = triangle.a[i] > 0 || (triangle.a[i] == 0 && triangle.b[i] < 0);
+        if (!topLeft) {
+            triangle.c[i] -= 1;
+        }
+    }
+    triangle.invArea = 1.0 / double(area);
+
+    triangle.depthOffset = 0.0f;
+    if (rasterization.depthBiasEnable && m_depth) {
+        // Depth slope per pixel from the plane through the vertices
+        double dzdx = 0.0;
+        double dzdy = 0.0;
+        for (uint32_t i = 0; i < 3; ++i) {
+            dzdx += double(triangle.z[i]) * triangle.a[i];
+            dzdy += double(triangle.z[i]) * triangle.b[i];
+        }
+        const float slope = float(std::max(std::abs(dzdx), std::abs(dzdy)) * SubpixelScale * triangle.invArea);
+        const float maxZ = std::max({std::abs(triangle.z[0]), std::abs(triangle.z[1]), std::abs(triangle.z[2])});
+        const float* bias = draw.state.depthBias;
+        float offset = slope * bias[2] + GetDepthUnit(m_depth->format, maxZ) * bias[0];
+        if (bias[1] > 0.0f) {
+            offset = std::min(offset, bias[1]);
+        } else if (bias[1] < 0.0f) {
+            offset = std::max(offset, bias[1]);
+        }
+        triangle.depthOffset = offset;
+    }
+
+    triangle.provoking = provoking;
+    triangle.draw = drawIndex;
+    output.push_back(triangle);
+}
+
+void SoftwareRasterizer::SetupLine(const BinnedDraw& draw, uint32_t drawIndex, const uint32_t* a, const uint32_t* b,
+                                   const uint32_t* provoking, bool frontFacing, Arena& arena,
+                                   std::vector<Triangle>& output) const {
+    // Clip to the planes the projection needs; the guard band is left to
+    // the triangles the line becomes
+    float pa[4];
+    float pb[4];
+    GetPosition(a, pa);
+    GetPosition(b, pb);
+    float t0 = 0.0f;
+    float t1 = 1.0f;
+    for (uint32_t plane = PlaneW; plane <= PlaneFar; ++plane) {
+        if (plane != PlaneW && draw.depthClamp) {
+            continue;
+        }
+        const float da = GetPlaneDistance(draw, plane, pa);
+        const float db = GetPlaneDistance(draw, plane, pb);
+        if (da < 0.0f && db < 0.0f) {
+            return;
+        }
+        if (da < 0.0f) {
+            t0 = std::max(t0, da / (da - db));
+        } else if (db < 0.0f) {
+            t1 = std::min(t1, da / (da - db));
+        }
+    }
+    if (t0 >= t1) {
+        return;
+    }
+    const uint32_t* ends[2] = {a, b};
+    if (t0 > 0.0f) {
+        uint32_t* vertex = arena.Allocate(draw.vertexWords);
+        Interpolate(a, b, t0, draw.vertexWords, vertex);
+        ends[0] = vertex;
+    }
+    if (t1 < 1.0f) {
+        uint32_t* vertex = arena.Allocate(draw.vertexWords);
+        Interpolate(a, b, t1, draw.vertexWords, vertex);
+        ends[1] = vertex;
+    }
+
+    // A rectangle lineWidth pixels wide along the line
+    float p[2][4];
+    float window[2][2];
+    for (uint32_t i = 0; i < 2; ++i) {
+        GetPosition(ends[i], p[i]);
+        window[i][0] = draw.offsetX + p[i][0] / p[i][3] * draw.scaleX;
+        window[i][1] = draw.offsetY + p[i][1] / p[i][3] * draw.scaleY;
+    }
+    const float dx = window[1][0] - window[0][0];
+    const float dy = window[1][1] - window[0][1];
+    const float length = std::sqrt(dx * dx + dy * dy);
+    const float halfWidth = std::max(draw.state.lineWidth, 0.0f) * 0.5f;
+    if (length == 0.0f || halfWidth == 0.0f) {
+        return;
+    }
+    const float nx = -dy / length * halfWidth;
+    const float ny = dx / length * halfWidth;
+
+    uint32_t* corners[4];
+    for (uint32_t i = 0; i < 4; ++i) {
+        const uint32_t end = i / 2;
+        const float side = (i % 2 == 0) ? -1.0f : 1.0f;
+        uint32_t* corner = arena.Allocate(draw.vertexWords);
+        std::memcpy(corner, ends[end], size_t(draw.vertexWords) * 4);
+        corner[0] = AsWord(p[end][0] + side * nx / draw.scaleX * p[end][3]);
+        corner[1] = AsWord(p[end][1] + side * ny / draw.scaleY * p[end][3]);
+        corners[i] = corner;
+    }
+    const Facing facing = frontFacing ? Facing::Front : Facing::Back;
+    const uint32_t* const first[3] = {corners[0], corners[2], corners[1]};
+    const uint32_t* const second[3] = {corners[1], corners[2], corners[3]};
+    SetupTriangle(draw, drawIndex, first, provoking, facing, arena, output);
+    SetupTriangle(draw, drawIndex, second, provoking, facing, arena, output);
+}
+
+void SoftwareRasterizer::SetupPoint(const BinnedDraw& draw, uint32_t drawIndex, const uint32_t* vertex,
+                                    const uint32_t* provoking, bool frontFacing, Arena& arena,
+                                    std::vector<Triangle>& output) const {
+    // Points whose center is clipped are discarded whole
+    float p[4];
+    GetPosition(vertex, p);
+    if (GetPlaneDistance(draw, PlaneW, p) < 0.0f ||
+        (!draw.depthClamp && (GetPlaneDistance(draw, PlaneNear, p) < 0.0f || GetPlaneDistance(draw, PlaneFar, p) < 0.0f))) {
+        return;
+    }
+
+    // A square pointSize pixels wide; the point coordinate's origin is its
+    // upper left corner
+    const float halfSize = std::max(AsFloat(vertex[SoftwarePipeline::VertexPointSize]), 0.0f) * 0.5f;
+    if (!(halfSize > 0.0f)) {
+        return;
+    }
+    uint32_t* corners[4];
+    for (uint32_t i = 0; i < 4; ++i) {
+        const float sx = (i & 1) ? 1.0f : -1.0f;
+        const float sy = (i & 2) ? 1.0f : -1.0f;
+        uint32_t* corner = arena.Allocate(draw.vertexWords);
+        std::memcpy(corner, vertex, size_t(draw.vertexWords) * 4);
+        corner[0] = AsWord(p[0] + sx * halfSize / draw.scaleX * p[3]);
+        corner[1] = AsWord(p[1] + sy * halfSize / draw.scaleY * p[3]);
+        corner[SoftwarePipeline::VertexPointCoord] = AsWord((sx + 1.0f) * 0.5f);
+        corner[SoftwarePipeline::VertexPointCoord + 1] = AsWord((1.0f - sy) * 0.5f);
+        corners[i] = corner;
+    }
+    const Facing facing = frontFacing ? Facing::Front : Facing::Back;
+    const uint32_t* const first[3] = {corners[0], corners[1], corners[2]};
+    const uint32_t* const second[3] = {corners[2], corners[1], corners[3]};
+    SetupTriangle(draw, drawIndex, first, provoking, facing, arena, output);
+    SetupTriangle(draw, drawIndex, second, provoking, facing, arena, output);
+}
+
+void SoftwareRasterizer::Bin(uint32_t index) {
+    const Triangle& triangle = m_triangles[index];
+    const uint32_t tileMinX = uint32_t(triangle.minX) / TileSize;
+    const uint32_t tileMinY = uint32_t(triangle.minY) / TileSize;
+    const uint32_t tileMaxX = std::min(uint32_t(triangle.maxX) / TileSize, m_tilesX - 1);
+    const uint32_t tileMaxY = std::min(uint32_t(triangle.maxY) / TileSize, m_tilesY - 1);
+    for (uint32_t tileY = tileMinY; tileY <= tileMaxY; ++tileY) {
+        for (uint32_t tileX = tileMinX; tileX <= tileMaxX; ++tileX) {
+            const uint32_t tile = tileY * m_tilesX + tileX;
+            if (m_bins[tile].empty()) {
+                m_activeTiles.push_back(tile);
+            }
+            m_bins[tile].push_back(index);
+        }
+    }
+}
+
+// ============================================================================
+// Tiles
+// ============================================================================
+
+void SoftwareRasterizer::Flush() {
+    if (!m_activeTiles.empty()) {
+        m_threads.ParallelFor(static_cast<uint32_t>(m_activeTiles.size()), [this](uint32_t index, uint32_t thread) {
+            RenderTile(m_activeTiles[index], thread);
+        });
+        for (uint32_t tile : m_activeTiles) {
+            m_bins[tile].clear();
+        }
+        m_activeTiles.clear();
+    }
+    m_triangles.clear();
+    m_draws.clear();
+    for (Arena& arena : m_arenas) {
+        arena.Reset();
+    }
+}
+
+void SoftwareRasterizer::RenderTile(uint32_t tile, uint32_t thread) {
+    TileScratch& scratch = m_tileScratch[thread];
+    const auto tileX = int32_t((tile % m_tilesX) * TileSize);
+    const auto tileY = int32_t((tile / m_tilesX) * TileSize);
+    for (uint32_t index : m_bins[tile]) {
+        RasterizeTriangle(m_triangles[index], tileX, tileY, scratch);
+    }
+    if (scratch.count > 0) {
+        ShadeBatch(scratch);
+    }
+    scratch.draw = nullptr;
+}
+
+void SoftwareRasterizer::RasterizeTriangle(const Triangle& triangle, int32_t tileX, int32_t tileY,
+                                           TileScratch& scratch) {
+    const int32_t minX = std::max(triangle.minX, tileX);
+    const int32_t minY = std::max(triangle.minY, tileY);
+    const int32_t maxX = std::min(triangle.maxX, tileX + int32_t(TileSize) - 1);
+    const int32_t maxY = std::min(triangle.maxY, tileY + int32_t(TileSize) - 1);
+    if (minX > maxX || minY > maxY) {
+        return;
+    }
+
+    // Edge functions relative to the tile's first sample. An edge that
+    // every sample of the tile is inside of is left out of the test; the
+    // others stay within 32 bits over the tile.
+    constexpr int32_t SampleOffset = 1 << (SubpixelBits - 1);
+    constexpr int64_t Span = int64_t(TileSize) + StepWidth;
+    const int64_t sampleX = (int64_t(tileX) << SubpixelBits) + SampleOffset;
+    const int64_t sampleY = (int64_t(tileY) << SubpixelBits) + SampleOffset;
+    int32_t edgeBase[3];
+    int32_t edgeStepX[3];
+    int32_t edgeStepY[3];
+    double tileEdge[3];
+    for (uint32_t i = 0; i < 3; ++i) {
+        const int64_t value = int64_t(triangle.a[i]) * sampleX + int64_t(triangle.b[i]) * sampleY + triangle.c[i];
+        const int64_t stepX = int64_t(triangle.a[i]) << SubpixelBits;
+        const int64_t stepY = int64_t(triangle.b[i]) << SubpixelBits;
+        const int64_t minDelta = std::min<int64_t>(0, stepX * Span) + std::min<int64_t>(0, stepY * Span);
+        const int64_t maxDelta = std::max<int64_t>(0, stepX * Span) + std::max<int64_t>(0, stepY * Span);
+        tileEdge[i] = double(value);
+        if (value + maxDelta < 0) {
+            return;
+        }
+        if (value + minDelta >= 0) {
+            edgeBase[i] = edgeStepX[i] = edgeStepY[i] = 0;
+        } else {
+            edgeBase[i] = int32_t(value);
+            edgeStepX[i] = int32_t(stepX);
+            edgeStepY[i] = int32_t(stepY);
+        }
+    }
+
+    SimdInt edgeLanes[3];
+    for (uint32_t i = 0; i < 3; ++i) {
+        int32_t offsets[SimdWidth];
+        for (uint32_t lane = 0; lane < SimdWidth; ++lane) {
+            offsets[lane] = Lanes.x[lane] * edgeStepX[i] + Lanes.y[lane] * edgeStepY[i];
+        }
+        edgeLanes[i] = SimdInt::Load(offsets);
+    }
+
+    // Barycentrics of vertices 1 and 2: per-pixel steps and SIMD offsets
+    const float stepB1X = float(double(triangle.a[1] << SubpixelBits) * triangle.invArea);
+    const float stepB1Y = float(double(triangle.b[1] << SubpixelBits) * triangle.invArea);
+    const float stepB2X = float(double(triangle.a[2] << SubpixelBits) * triangle.invArea);
+    const float stepB2Y = float(double(triangle.b[2] << SubpixelBits) * triangle.invArea);
+    SimdFloat b1Lanes;
+    SimdFloat b2Lanes;
+    SimdInt xLanes;
+    SimdInt yLanes;
+    {
+        float b1[SimdWidth];
+        float b2[SimdWidth];
+        for (uint32_t lane = 0; lane < SimdWidth; ++lane) {
+            b1[lane] = float(Lanes.x[lane]) * stepB1X + float(Lanes.y[lane]) * stepB1Y;
+            b2[lane] = float(Lanes.x[lane]) * stepB2X + float(Lanes.y[lane]) * stepB2Y;
+        }
+        b1Lanes = SimdFloat::Load(b1);
+        b2Lanes = SimdFloat::Load(b2);
+        xLanes = SimdInt::Load(Lanes.x);
+        yLanes = SimdInt::Load(Lanes.y);
+    }
+    const double tileB1 = tileEdge[1] * triangle.invArea;
+    const double tileB2 = tileEdge[2] * triangle.invArea;
+
+    const SimdFloat one = SimdFloat::Broadcast(1.0f);
+    const SimdFloat z0 = SimdFloat::Broadcast(triangle.z[0] + triangle.depthOffset);
+    const SimdFloat dz1 = SimdFloat::Broadcast(triangle.z[1] - triangle.z[0]);
+    const SimdFloat dz2 = SimdFloat::Broadcast(triangle.z[2] - triangle.z[0]);
+    const SimdFloat invW0 = SimdFloat::Broadcast(triangle.invW[0]);
+    const SimdFloat invW1 = SimdFloat::Broadcast(triangle.invW[1]);
+    const SimdFloat invW2 = SimdFloat::Broadcast(triangle.invW[2]);
+    const SimdInt minusOne = SimdInt::Broadcast(-1);
+    const SimdInt rectMinX = SimdInt::Broadcast(minX - 1);
+    const SimdInt rectMaxX = SimdInt::Broadcast(maxX + 1);
+
+    const BinnedDraw& draw = m_draws[triangle.draw];
+    if (scratch.draw != &draw && scratch.count > 0) {
+        ShadeBatch(scratch);
+    }
+    scratch.draw = &draw;
+    const bool shade = draw.fragment != nullptr;
+
+    float laneZ[SimdWidth];
+    float laneInvW[SimdWidth];
+    float laneB1[SimdWidth];
+    float laneB2[SimdWidth];
+    float lanePB1[SimdWidth];
+    float lanePB2[SimdWidth];
+
+    for (int32_t y = minY & ~1; y <= maxY; y += 2) {
+        const int32_t row = y - tileY;
+        const SimdInt laneY = SimdInt::Broadcast(y) + yLanes;
+        const SimdInt inRows = (laneY > SimdInt::Broadcast(minY - 1)) & (SimdInt::Broadcast(maxY + 1) > laneY);
+        for (int32_t x = minX & ~1; x <= maxX; x += StepWidth) {
+            const int32_t column = x - tileX;
+            SimdInt inside = inRows;
+            for (uint32_t i = 0; i < 3; ++i) {
+                const SimdInt edge = SimdInt::Broadcast(edgeBase[i] + column * edgeStepX[i] + row * edgeStepY[i]) +
+                                     edgeLanes[i];
+                inside = inside & (edge > minusOne);
+            }
+            const SimdInt laneX = SimdInt::Broadcast(x) + xLanes;
+            inside = inside & (laneX > rectMinX) & (rectMaxX > laneX);
+            const uint32_t mask = inside.MoveMask();
+            if (mask == 0) {
+                continue;
+            }
+
+            // Interpolants of the step's pixels
+            const SimdFloat b1 = SimdFloat::Broadcast(float(tileB1 + column * double(stepB1X) + row * double(stepB1Y))) +
+                                 b1Lanes;
+            const SimdFloat b2 = SimdFloat::Broadcast(float(tileB2 + column * double(stepB2X) + row * double(stepB2Y))) +
+                                 b2Lanes;
+            const SimdFloat b0 = one - b1 - b2;
+            (z0 + b1 * dz1 + b2 * dz2).Store(laneZ);
+            const SimdFloat q0 = b0 * invW0;
+            const SimdFloat q1 = b1 * invW1;
+            const SimdFloat q2 = b2 * invW2;
+            const SimdFloat invW = q0 + q1 + q2;
+            invW.Store(laneInvW);
+            b1.Store(laneB1);
+            b2.Store(laneB2);
+            (q1 / invW).Store(lanePB1);
+            (q2 / invW).Store(lanePB2);
+
+            for (uint32_t quad = 0; quad < QuadsPerStep; ++quad) {
+                const uint32_t quadMask = (mask >> (4 * quad)) & 0xF;
+                if (quadMask == 0) {
+                    continue;
+                }
+
+                bool live[4];
+                bool anyLive = false;
+                for (uint32_t i = 0; i < 4; ++i) {
+                    const uint32_t lane = 4 * quad + i;
+                    live[i] = (quadMask >> i) & 1;
+                    if (!live[i]) {
+                        continue;
+                    }
+                    float depth = laneZ[lane];
+                    if (draw.depthClamp) {
+                        depth = std::clamp(depth, draw.minDepth, draw.maxDepth);
+                    }
+                    const int32_t px = x + Lanes.x[lane];
+                    const int32_t py = y + Lanes.y[lane];
+                    if (!shade) {
+                        TestFragment(draw, triangle.frontFacing, px, py, depth, true);
+                        live[i] = false;
+                    } else if (draw.earlyTests || draw.preCull) {
+                        live[i] = TestFragment(draw, triangle.frontFacing, px, py, depth, draw.earlyTests);
+                    }
+                    anyLive = anyLive || live[i];
+                }
+                if (!anyLive) {
+                    continue;
+                }
+
+                const uint32_t first = scratch.count;
+                scratch.triangles[first / 4] = &triangle;
+                for (uint32_t i = 0; i < 4; ++i) {
+                    const uint32_t lane = 4 * quad + i;
+                    const uint32_t target = first + i;
+                    scratch.x[target] = x + Lanes.x[lane];
+                    scratch.y[target] = y + Lanes.y[lane];
+                    scratch.live[target] = live[i];
+                    scratch.z[target] = laneZ[lane];
+                    scratch.invW[target] = laneInvW[lane];
+                    scratch.b[target][0] = laneB1[lane];
+                    scratch.b[target][1] = laneB2[lane];
+                    scratch.pb[target][0] = lanePB1[lane];
+                    scratch.pb[target][1] = lanePB2[lane];
+                }
+                scratch.count += 4;
+                if (scratch.count == TileScratch::Lanes) {
+                    ShadeBatch(scratch);
+                }
+            }
+        }
+    }
+}
+
+// ============================================================================
+// Fragments
+// ============================================================================
+
+void SoftwareRasterizer::ShadeBatch(TileScratch& scratch) {
+    const BinnedDraw& draw = *scratch.draw;
+    SoftwarePipeline& pipeline = *draw.pipeline;
+    const SoftwareShaderProgram& program = *draw.fragment;
+    const SoftwarePipeline::Builtins& builtins = pipeline.GetBuiltins();
+    const auto& varyings = pipeline.GetVaryings();
+    SoftwareShaderContext& context = pipeline.GetContext(1, scratch.thread);
+    const uint32_t laneCount = scratch.count;
+    scratch.count = 0;
+
+    const auto writeWords = [](std::byte* memory, int32_t offset, std::initializer_list<uint32_t> words) {
+        if (offset >= 0) {
+            std::memcpy(memory + offset, words.begin(), words.size() * 4);
+        }
+    };
+
+    context.ResetInvocationMemory(laneCount);
+    for (uint32_t lane = 0; lane < laneCount; ++lane) {
+        const Triangle& triangle = *scratch.triangles[lane / 4];
+        std::byte* memory = context.GetInvocationMemory(lane);
+        context.SetHelper(lane, !scratch.live[lane]);
+
+        const float b[3] = {1.0f - scratch.b[lane][0] - scratch.b[lane][1], scratch.b[lane][0], scratch.b[lane][1]};
+        const float pb[3] = {1.0f - scratch.pb[lane][0] - scratch.pb[lane][1], scratch.pb[lane][0], scratch.pb[lane][1]};
+        const auto interpolate = [&](uint32_t slot, const float (&weights)[3]) {
+            return AsFloat(triangle.vertices[0][slot]) * weights[0] + AsFloat(triangle.vertices[1][slot]) * weights[1] +
+                   AsFloat(triangle.vertices[2][slot]) * weights[2];
+        };
+
+        writeWords(memory, builtins.fragCoord, {AsWord(float(scratch.x[lane]) + 0.5f), AsWord(float(scratch.y[lane]) + 0.5f),
+                                                AsWord(scratch.z[lane]), AsWord(scratch.invW[lane])});
+        writeWords(memory, builtins.frontFacing, {triangle.frontFacing ? 1u : 0u});
+        writeWords(memory, builtins.helperInvocation, {scratch.live[lane] ? 0u : 1u});
+        if (builtins.pointCoord >= 0) {
+            writeWords(memory, builtins.pointCoord, {AsWord(interpolate(SoftwarePipeline::VertexPointCoord, pb)),
+                                                     AsWord(interpolate(SoftwarePipeline::VertexPointCoord + 1, pb))});
+        }
+        for (const SoftwarePipeline::Varying& varying : varyings) {
+            uint32_t* target = reinterpret_cast<uint32_t*>(memory + varying.target);
+            if (varying.flat) {
+                std::memcpy(target, triangle.provoking + varying.slot, size_t(varying.words) * 4);
+                continue;
+            }
+            const float (&weights)[3] = varying.noPerspective ? b : pb;
+            for (uint32_t word = 0; word < varying.words; ++word) {
+                const uint32_t value = AsWord(interpolate(varying.slot + word, weights));
+                std::memcpy(target + word, &value, 4);
+            }
+        }
+    }
+
+    context.Run(draw.state.bindings, laneCount);
+
+    for (uint32_t lane = 0; lane < laneCount; ++lane) {
+        if (!scratch.live[lane] || context.IsDiscarded(lane)) {
+            continue;
+        }
+        const std::byte* memory = context.GetInvocationMemory(lane);
+        float depth = scratch.z[lane];
+        if (program.WritesDepth() && builtins.fragDepth >= 0) {
+            std::memcpy(&depth, memory + builtins.fragDepth, 4);
+        }
+        if (draw.depthClamp) {
+            depth = std::clamp(depth, draw.minDepth, draw.maxDepth);
+        }
+        MergeFragment(draw, *scratch.triangles[lane / 4], scratch.x[lane], scratch.y[lane], depth, memory);
+    }
+}
+
+bool SoftwareRasterizer::TestFragment(const BinnedDraw& draw, bool frontFacing, int32_t x, int32_t y, float depth,
+                                      bool write) {
+    if (!m_depth) {
+        return true;
+    }
+    const Attachment& attachment = *m_depth;
+    const DepthStencilState& state = draw.pipeline->GetGraphicsDesc().depthStencil;
+    std::byte* texel = GetTexel(attachment, x, y);
+
+    if (state.depthBoundsTestEnable) {
+        const float stored = SoftwareFormatUtils::DecodeDepth(attachment.format, texel);
+        if (stored < draw.state.depthBounds[0] || stored > draw.state.depthBounds[1]) {
+            return false;
+        }
+    }
+
+    const bool stencil = state.stencilTestEnable && attachment.hasStencil;
+    const uint32_t face = frontFacing ? 0 : 1;
+    const StencilOpState& ops = frontFacing ? state.front : state.back;
+    const auto reference = uint8_t(draw.state.reference[face]);
+    const auto updateStencil = [&](StencilOp op, uint8_t value) {
+        if (write && op != StencilOp::Keep) {
+            const auto mask = uint8_t(draw.state.writeMask[face]);
+            const uint8_t result = ApplyStencilOp(op, value, reference);
+            SoftwareFormatUtils::EncodeStencil(attachment.format, uint8_t((value & ~mask) | (result & mask)), texel);
+        }
+    };
+
+    uint8_t stencilValue = 0;
+    if (stencil) {
+        stencilValue = SoftwareFormatUtils::DecodeStencil(attachment.format, texel);
+        const auto mask = uint8_t(draw.state.compareMask[face]);
+        if (!Compare(ops.compareOp, float(reference & mask), float(stencilValue & mask))) {
+            updateStencil(ops.failOp, stencilValue);
+            return false;
+        }
+    }
+
+    if (state.depthTestEnable) {
+        const float stored = SoftwareFormatUtils::DecodeDepth(attachment.format, texel);
+        const float quantized = SoftwareFormatUtils::QuantizeDepth(attachment.format, depth);
+        if (!Compare(state.depthCompareOp, quantized, stored)) {
+            if (stencil) {
+                updateStencil(ops.depthFailOp, stencilValue);
+            }
+            return false;
+        }
+    }
+
+    if (stencil) {
+        updateStencil(ops.passOp, stencilValue);
+    }
+    if (write && state.depthTestEnable && state.depthWriteEnable) {
+        SoftwareFormatUtils::EncodeDepth(attachment.format, depth, texel);
+    }
+    return true;
+}
+
+void SoftwareRasterizer::MergeFragment(const BinnedDraw& draw, const Triangle& triangle, int32_t x, int32_t y,
+                                       float depth, const std::byte* outputs) {
+    if (!draw.earlyTests && !TestFragment(draw, triangle.frontFacing, x, y, depth, true)) {
+        return;
+    }
+
+    const ColorBlendState& blend = draw.pipeline->GetGraphicsDesc().colorBlend;
+    for (const SoftwarePipeline::ColorOutput& output : draw.pipeline->GetColorOutputs()) {
+        if (output.attachment >= m_colors.size()) {
+            continue;
+        }
+        const Attachment& attachment = m_colors[output.attachment];
+        const ColorBlendAttachment state = output.attachment < blend.attachments.size()
+            ? blend.attachments[output.attachment] : ColorBlendAttachment{};
+        const auto writeMask = static_cast<uint32_t>(state.colorWriteMask);
+        if ((writeMask & 0xF) == 0) {
+            continue;
+        }
+
+        uint32_t source[4] = {0, 0, 0, attachment.isInteger ? 1u : AsWord(1.0f)};
+        std::memcpy(source, outputs + output.offset, std::min(output.words, 4u) * 4);
+        std::byte* texel = GetTexel(attachment, x, y);
+
+        uint32_t result[4];
+        if (attachment.isInteger || (!state.blendEnable && (writeMask & 0xF) == 0xF)) {
+            std::memcpy(result, source, sizeof(result));
+        } else {
+            uint32_t stored[4];
+            SoftwareFormatUtils::Decode(attachment.format, texel, stored);
+            std::memcpy(result, stored, sizeof(result));
+            if (state.blendEnable) {
+                // Fixed-point targets clamp the inputs of the blend
+                float src[4];
+                float dst[4];
+                float constants[4];
+                for (uint32_t c = 0; c < 4; ++c) {
+                    src[c] = AsFloat(source[c]);
+                    dst[c] = AsFloat(stored[c]);
+                    constants[c] = draw.state.blendConstants[c];
+                    if (attachment.isNormalized) {
+                        src[c] = std::clamp(src[c], 0.0f, 1.0f);
+                        constants[c] = std::clamp(constants[c], 0.0f, 1.0f);
+                    }
+                }
+                for (uint32_t c = 0; c < 4; ++c) {
+                    const bool alpha = c == 3;
+                    const BlendFactor srcFactor = alpha ? state.srcAlphaBlendFactor : state.srcColorBlendFactor;
+                    const BlendFactor dstFactor = alpha ? state.dstAlphaBlendFactor : state.dstColorBlendFactor;
+                    const float value = Blend(alpha ? state.alphaBlendOp : state.colorBlendOp,
+                                              src[c], GetBlendFactor(srcFactor, c, src, dst, constants),
+                                              dst[c], GetBlendFactor(dstFactor, c, src, dst, constants));
+                    source[c] = AsWord(value);
+                }
+            }
+            for (uint32_t c = 0; c < 4; ++c) {
+                if (writeMask & (1u << c)) {
+                    result[c] = source[c];
+                }
+            }
+        }
+        if (attachment.isInteger && (writeMask & 0xF) != 0xF) {
+            uint32_t stored[4];
+            SoftwareFormatUtils::Decode(attachment.format, texel, stored);
+            for (uint32_t c = 0; c < 4; ++c) {
+                if (!(writeMask & (1u << c))) {
+                    result[c] = stored[c];
+                }
+            }
+        }
+        SoftwareFormatUtils::Encode(attachment.format, result, texel);
+    }
+}
+
+} // namespace VRHI
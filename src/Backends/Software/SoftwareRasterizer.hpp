@@ -0,0 +1,188 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/VRHI.hpp>
+#include <VRHI/CommandBuffer.hpp>
+#include "SoftwareShaderProgram.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace VRHI {
+
+class SoftwareFramebuffer;
+class SoftwarePipeline;
+class ThreadPool;
+
+/// State a draw is rendered with, captured when it is issued. Pipeline
+/// state that is not dynamic has already been copied in.
+struct SoftwareDrawState {
+    SoftwarePipeline* pipeline = nullptr;
+    SoftwareBindings bindings;
+    Viewport viewport{};
+    Rect2D scissor{};
+    float lineWidth = 1.0f;
+    float blendConstants[4] = {};
+    float depthBias[3] = {};            // Constant factor, clamp, slope factor
+    float depthBounds[2] = {0.0f, 1.0f};
+    uint32_t compareMask[2] = {0xFF, 0xFF};  // Front, back
+    uint32_t writeMask[2] = {0xFF, 0xFF};
+    uint32_t reference[2] = {};
+};
+
+/// Vertices and indices of one draw
+struct SoftwareDrawCall {
+    static constexpr uint32_t MaxVertexBuffers = 16;
+
+    struct VertexBuffer {
+        const std::byte* data = nullptr;
+        size_t size = 0;
+    };
+
+    uint32_t count = 0;                 // Vertices, or indices when `indices` is set
+    uint32_t instanceCount = 1;
+    uint32_t first = 0;                 // First vertex, or first index
+    uint32_t firstInstance = 0;
+    int32_t vertexOffset = 0;           // Added to indices
+    uint32_t drawIndex = 0;             // Of a multi-draw
+
+    const std::byte* indices = nullptr; // From the first index on
+    size_t indexBytes = 0;
+    bool use16BitIndices = false;
+
+    VertexBuffer vertexBuffers[MaxVertexBuffers];
+};
+
+/// Tile-binned rasterizer of the software backend.
+///
+/// Draw() runs the vertex shader over the draw's vertices in batches spread
+/// across the worker threads, clips and sets up the primitives in parallel
+/// chunks, and bins them in submission order into 64x64 pixel tiles. Flush()
+/// then renders the tiles in parallel: each tile is owned by one thread,
+/// which walks its primitives in order, so depth, stencil and blending
+/// behave as if the primitives were drawn one after another.
+///
+/// Within a tile, coverage is computed from fixed-point edge functions
+/// (4 subpixel bits, top-left fill rule) and barycentrics and depth are
+/// interpolated SimdWidth pixels at a time; pixels are grouped in 2x2 quads
+/// so fragment shaders can take derivatives. Fragments of a draw are shaded
+/// in batches of up to 64 invocations.
+///
+/// Coordinates follow OpenGL: clip space depth is [-1, 1], window
+/// coordinates have their origin at row 0 of the attachments, polygons
+/// wound counter-clockwise in window coordinates face the front, and the
+/// last vertex of a primitive provides its flat varyings.
+class SoftwareRasterizer {
+public:
+    explicit SoftwareRasterizer(ThreadPool& threads);
+    ~SoftwareRasterizer();
+
+    SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+    SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+    /// Render to `framebuffer` within `renderArea`, which is confined to it
+    void Begin(const SoftwareFramebuffer& framebuffer, const Rect2D& renderArea);
+
+    /// Render what is binned and stop rendering to the framebuffer
+    void End();
+
+    /// Render what is binned
+    void Flush();
+
+    void Draw(const SoftwareDrawState& state, const SoftwareDrawCall& call);
+
+    /// Clear part of color attachment `attachment` (counting color
+    /// attachments only), confined to the render area
+    void ClearColor(uint32_t attachment, const ClearColorValue& value, const Rect2D& rect);
+
+    /// Clear part of the depth and / or stencil of the depth attachment
+    void ClearDepthStencil(bool depth, bool stencil, const ClearDepthStencilValue& value, const Rect2D& rect);
+
+    static constexpr uint32_t TileSize = 64;
+    static constexpr int32_t SubpixelBits = 4;
+
+    /// Window coordinates primitives are clipped to before their
+    /// fixed-point setup, which keeps edge functions within 32 bits inside
+    /// a tile; it is the maximum framebuffer size plus half of it on either
+    /// side
+    static constexpr float GuardBand = 12288.0f;
+    static constexpr uint32_t MaxFramebufferSize = 8192;
+
+private:
+    struct Triangle;
+    struct Arena;
+    struct TileScratch;
+    struct BinnedDraw;
+    struct Attachment;
+
+    /// Facing of a primitive made of triangles: computed from their winding
+    /// (and culled), or that of the polygon or line they were made from
+    enum class Facing : uint8_t { Compute, Front, Back };
+
+    /// Vertex shader over the unique vertices of one instance
+    void ShadeVertices(BinnedDraw& draw, const SoftwareDrawCall& call, uint32_t instance, uint32_t* output);
+
+    /// Clip, cull and set up one primitive
+    void SetupPrimitive(const BinnedDraw& draw, uint32_t drawIndex, const uint32_t* const* vertices,
+                        uint32_t vertexCount, Arena& arena, std::vector<Triangle>& output) const;
+    void SetupTriangle(const BinnedDraw& draw, uint32_t drawIndex, const uint32_t* const (&vertices)[3],
+                       const uint32_t* provoking, Facing facing, Arena& arena,
+                       std::vector<Triangle>& output) const;
+    void SetupLine(const BinnedDraw& draw, uint32_t drawIndex, const uint32_t* a, const uint32_t* b,
+                   const uint32_t* provoking, bool frontFacing, Arena& arena,
+                   std::vector<Triangle>& output) const;
+    void SetupPoint(const BinnedDraw& draw, uint32_t drawIndex, const uint32_t* vertex,
+                    const uint32_t* provoking, bool frontFacing, Arena& arena,
+                    std::vector<Triangle>& output) const;
+
+    /// Triangle whose vertices are inside the guard band and in front of the eye
+    void SetupClipped(const BinnedDraw& draw, uint32_t drawIndex, const uint32_t* const (&vertices)[3],
+                      const uint32_t* provoking, Facing facing, std::vector<Triangle>& output) const;
+
+    void Bin(uint32_t triangle);
+
+    void RenderTile(uint32_t tile, uint32_t thread);
+    void RasterizeTriangle(const Triangle& triangle, int32_t tileX, int32_t tileY, TileScratch& scratch);
+    void ShadeBatch(TileScratch& scratch);
+    void MergeFragment(const BinnedDraw& draw, const Triangle& triangle, int32_t x, int32_t y,
+                       float depth, const std::byte* outputs);
+
+    /// Depth bounds, stencil and depth tests of a fragment, with their writes
+    bool TestFragment(const BinnedDraw& draw, bool frontFacing, int32_t x, int32_t y, float depth, bool write);
+
+    std::byte* GetTexel(const Attachment& attachment, int32_t x, int32_t y) const noexcept;
+
+    /// Triangles or fragments that could be rendered without the rest of the draw
+    bool ShouldFlush() const noexcept;
+
+    ThreadPool& m_threads;
+
+    // Current render target
+    std::vector<Attachment> m_colors;
+    std::unique_ptr<Attachment> m_depth;
+    Rect2D m_renderArea{};
+    uint32_t m_tilesX = 0;
+    uint32_t m_tilesY = 0;
+
+    // Work binned since the last flush
+    std::vector<BinnedDraw> m_draws;
+    std::vector<Triangle> m_triangles;
+    std::vector<std::vector<uint32_t>> m_bins;
+    std::vector<uint32_t> m_activeTiles;
+
+    // Per thread
+    std::vector<Arena> m_arenas;
+    std::vector<TileScratch> m_tileScratch;
+
+    // Per draw
+    std::vector<uint32_t> m_vertexIds;          // Index + vertex offset of each unique vertex
+    std::vector<uint32_t> m_primitiveSlots;     // Unique vertex of each primitive vertex
+    std::vector<uint32_t> m_indexSlots;
+    std::vector<uint32_t> m_slotTable;          // Unique vertex of each index in range
+    std::vector<std::vector<Triangle>> m_chunks;
+};
+
+} // namespace VRHI
@@ -0,0 +1,15 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "SoftwareRenderPass.hpp"
+
+namespace VRHI {
+
+std::expected<std::unique_ptr<RenderPass>, Error>
+SoftwareRenderPass::Create(const RenderPassDesc& desc) {
+    std::unique_ptr<SoftwareRenderPass> renderPass(new SoftwareRenderPass());
+    renderPass->m_attachments.assign(desc.attachments.begin(), desc.attachments.end());
+    return std::unique_ptr<RenderPass>(std::move(renderPass));
+}
+
+} // namespace VRHI
@@ -0,0 +1,35 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/VRHI.hpp>
+#include <expected>
+#include <memory>
+#include <vector>
+#include <VRHI/RenderPass.hpp>
+
+namespace VRHI {
+
+/// Render pass implementation
+///
+/// Like the other backends, a pass has a single subpass: color attachments
+/// in the order they appear, plus the depth attachment; subpass
+/// descriptions are ignored.
+class SoftwareRenderPass : public RenderPass {
+public:
+    ~SoftwareRenderPass() override = default;
+
+    static std::expected<std::unique_ptr<RenderPass>, Error>
+    Create(const RenderPassDesc& desc);
+
+    /// Attachments in RenderPassDesc order
+    const std::vector<AttachmentDesc>& GetAttachments() const noexcept { return m_attachments; }
+
+private:
+    SoftwareRenderPass() = default;
+
+    std::vector<AttachmentDesc> m_attachments;
+};
+
+} // namespace VRHI
@@ -0,0 +1,31 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "SoftwareSampler.hpp"
+
+namespace VRHI {
+
+SoftwareSampler::SoftwareSampler(const SamplerDesc& desc)
+    : m_desc(desc)
+{
+    m_desc.debugName = nullptr;
+}
+
+std::expected<std::unique_ptr<Sampler>, Error>
+SoftwareSampler::Create(const SamplerDesc& desc) {
+    if (desc.minLod > desc.maxLod) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Sampler minLod cannot be greater than maxLod"
+        });
+    }
+
+    return std::unique_ptr<Sampler>(new SoftwareSampler(desc));
+}
+
+const SoftwareSampler& SoftwareSampler::GetDefault() {
+    static const SoftwareSampler sampler{SamplerDesc{}};
+    return sampler;
+}
+
+} // namespace VRHI
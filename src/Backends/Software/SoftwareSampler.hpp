@@ -0,0 +1,35 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/VRHI.hpp>
+#include <VRHI/Resources.hpp>
+#include <expected>
+#include <memory>
+
+namespace VRHI {
+
+/// Software sampler: the state SoftwareTexture::Sample() filters with.
+/// Anisotropic filtering is not implemented and falls back to trilinear.
+class SoftwareSampler : public Sampler {
+public:
+    ~SoftwareSampler() override = default;
+
+    static std::expected<std::unique_ptr<Sampler>, Error>
+    Create(const SamplerDesc& desc);
+
+    // Software-specific
+    const SamplerDesc& GetDesc() const noexcept { return m_desc; }
+
+    /// Sampler used for textures bound without one: linear filtering,
+    /// repeat addressing, like a new OpenGL texture
+    static const SoftwareSampler& GetDefault();
+
+private:
+    explicit SoftwareSampler(const SamplerDesc& desc);
+
+    SamplerDesc m_desc;
+};
+
+} // namespace VRHI
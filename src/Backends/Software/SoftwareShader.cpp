@@ -0,0 +1,56 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "SoftwareShader.hpp"
+#include "SoftwareShaderProgram.hpp"
+#include <VRHI/ShaderCompiler.hpp>
+#include <vector>
+
+namespace VRHI {
+
+SoftwareShader::SoftwareShader(const ShaderDesc& desc, std::shared_ptr<const SoftwareShaderProgram> program)
+    : m_stage(desc.stage)
+    , m_language(desc.language)
+    , m_entryPoint(desc.entryPoint ? desc.entryPoint : "main")
+    , m_program(std::move(program))
+{
+}
+
+SoftwareShader::~SoftwareShader() = default;
+
+std::expected<std::unique_ptr<Shader>, Error>
+SoftwareShader::Create(const ShaderDesc& desc) {
+    if (desc.code == nullptr || desc.codeSize == 0) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Shader code is required"
+        });
+    }
+
+    std::vector<uint32_t> spirv;
+    if (desc.language == ShaderLanguage::SPIRV) {
+        const auto* words = static_cast<const uint32_t*>(desc.code);
+        spirv.assign(words, words + desc.codeSize / sizeof(uint32_t));
+    } else if (desc.language == ShaderLanguage::GLSL) {
+        std::string source(static_cast<const char*>(desc.code), desc.codeSize);
+        auto compiled = ShaderCompiler::CompileGLSLToSPIRV(source, desc.stage, desc.entryPoint);
+        if (!compiled) {
+            return std::unexpected(compiled.error());
+        }
+        spirv = std::move(*compiled);
+    } else {
+        return std::unexpected(Error{
+            Error::Code::UnsupportedFeature,
+            "Software shaders must be GLSL or SPIR-V"
+        });
+    }
+
+    auto program = SoftwareShaderProgram::Create(spirv, desc.stage, desc.entryPoint ? desc.entryPoint : "main");
+    if (!program) {
+        return std::unexpected(program.error());
+    }
+
+    return std::unique_ptr<Shader>(new SoftwareShader(desc, std::shared_ptr<const SoftwareShaderProgram>(std::move(*program))));
+}
+
+} // namespace VRHI
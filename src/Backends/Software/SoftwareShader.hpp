@@ -0,0 +1,44 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/VRHI.hpp>
+#include <VRHI/Shader.hpp>
+#include <expected>
+#include <memory>
+#include <string>
+
+namespace VRHI {
+
+class SoftwareShaderProgram;
+
+/// Software shader
+///
+/// GLSL is compiled to SPIR-V first, like on Vulkan, and the entry point is
+/// decoded into a SoftwareShaderProgram right away, so shaders the
+/// interpreter cannot run fail here rather than at draw time. Pipelines
+/// share the program, which outlives the shader.
+class SoftwareShader : public Shader {
+public:
+    ~SoftwareShader() override;
+
+    static std::expected<std::unique_ptr<Shader>, Error>
+    Create(const ShaderDesc& desc);
+
+    ShaderStage GetStage() const noexcept override { return m_stage; }
+    ShaderLanguage GetLanguage() const noexcept override { return m_language; }
+    std::string_view GetEntryPoint() const noexcept override { return m_entryPoint; }
+
+    const std::shared_ptr<const SoftwareShaderProgram>& GetProgram() const noexcept { return m_program; }
+
+private:
+    SoftwareShader(const ShaderDesc& desc, std::shared_ptr<const SoftwareShaderProgram> program);
+
+    ShaderStage m_stage;
+    ShaderLanguage m_language;
+    std::string m_entryPoint;
+    std::shared_ptr<const SoftwareShaderProgram> m_program;
+};
+
+} // namespace VRHI
@@ -0,0 +1,1347 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "SoftwareShaderProgram.hpp"
+#include "SoftwareFormatUtils.hpp"
+#include "SoftwareSampler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+#include <spirv.hpp>
+#include <GLSL.std.450.h>
+
+namespace VRHI {
+
+namespace {
+    constexpr uint32_t Finished = UINT32_MAX;
+
+    float F(uint32_t value) { return std::bit_cast<float>(value); }
+    uint32_t U(float value) { return std::bit_cast<uint32_t>(value); }
+    int32_t S(uint32_t value) { return int32_t(value); }
+
+    /// Column-major register access shared by the operation templates
+    struct Registers {
+        uint32_t* data;
+        uint32_t lanes;
+
+        uint32_t* operator()(uint32_t reg) const { return data + size_t(reg) * lanes; }
+    };
+
+    template <typename Inst, typename Fn>
+    void Unary(const Registers& regs, const Inst& inst, std::span<const uint16_t> lanes, Fn fn) {
+        const uint32_t stepA = inst.flags & 1u ? 0 : 1;
+        for (uint32_t c = 0; c < inst.count; ++c) {
+            uint32_t* r = regs(inst.result + c);
+            const uint32_t* a = regs(inst.a + c * stepA);
+            for (uint16_t lane : lanes) {
+                r[lane] = fn(a[lane]);
+            }
+        }
+    }
+
+    template <typename Inst, typename Fn>
+    void Binary(const Registers& regs, const Inst& inst, std::span<const uint16_t> lanes, Fn fn) {
+        const uint32_t stepA = inst.flags & 1u ? 0 : 1;
+        const uint32_t stepB = inst.flags & 2u ? 0 : 1;
+        for (uint32_t c = 0; c < inst.count; ++c) {
+            uint32_t* r = regs(inst.result + c);
+            const uint32_t* a = regs(inst.a + c * stepA);
+            const uint32_t* b = regs(inst.b + c * stepB);
+            for (uint16_t lane : lanes) {
+                r[lane] = fn(a[lane], b[lane]);
+            }
+        }
+    }
+
+    template <typename Inst, typename Fn>
+    void Ternary(const Registers& regs, const Inst& inst, std::span<const uint16_t> lanes, Fn fn) {
+        const uint32_t stepA = inst.flags & 1u ? 0 : 1;
+        const uint32_t stepB = inst.flags & 2u ? 0 : 1;
+        const uint32_t stepC = inst.flags & 4u ? 0 : 1;
+        for (uint32_t c = 0; c < inst.count; ++c) {
+            uint32_t* r = regs(inst.result + c);
+            const uint32_t* a = regs(inst.a + c * stepA);
+            const uint32_t* b = regs(inst.b + c * stepB);
+            const uint32_t* x = regs(inst.c + c * stepC);
+            for (uint16_t lane : lanes) {
+                r[lane] = fn(a[lane], b[lane], x[lane]);
+            }
+        }
+    }
+
+    template <typename Inst, typename Fn>
+    void FloatUnary(const Registers& regs, const Inst& inst, std::span<const uint16_t> lanes, Fn fn) {
+        Unary(regs, inst, lanes, [&](uint32_t a) { return U(fn(F(a))); });
+    }
+
+    template <typename Inst, typename Fn>
+    void FloatBinary(const Registers& regs, const Inst& inst, std::span<const uint16_t> lanes, Fn fn) {
+        Binary(regs, inst, lanes, [&](uint32_t a, uint32_t b) { return U(fn(F(a), F(b))); });
+    }
+
+    template <typename Inst, typename Fn>
+    void FloatTernary(const Registers& regs, const Inst& inst, std::span<const uint16_t> lanes, Fn fn) {
+        Ternary(regs, inst, lanes, [&](uint32_t a, uint32_t b, uint32_t c) { return U(fn(F(a), F(b), F(c))); });
+    }
+
+    template <typename Inst, typename Fn>
+    void Compare(const Registers& regs, const Inst& inst, std::span<const uint16_t> lanes, Fn fn) {
+        Binary(regs, inst, lanes, [&](uint32_t a, uint32_t b) { return fn(F(a), F(b)) ? 1u : 0u; });
+    }
+
+    /// Float to integer conversions saturate instead of being undefined
+    template <typename T>
+    T SaturatingCast(float value) {
+        if (!(value == value)) {
+            return 0;
+        }
+        if (value <= float(std::numeric_limits<T>::min())) {
+            return std::numeric_limits<T>::min();
+        }
+        if (value >= float(std::numeric_limits<T>::max())) {
+            return std::numeric_limits<T>::max();
+        }
+        return T(value);
+    }
+
+    uint32_t BitReverse(uint32_t value) {
+        uint32_t result = 0;
+        for (uint32_t i = 0; i < 32; ++i) {
+            result |= ((value >> i) & 1u) << (31 - i);
+        }
+        return result;
+    }
+
+    uint32_t BitMask(uint32_t count) {
+        return count >= 32 ? UINT32_MAX : (1u << count) - 1;
+    }
+
+    /// Determinant of the n x n column-major matrix `m` (n <= 4)
+    float Determinant(const float* m, uint32_t n) {
+        if (n == 1) {
+            return m[0];
+        }
+        if (n == 2) {
+            return m[0] * m[3] - m[2] * m[1];
+        }
+        float result = 0.0f;
+        float minor[9];
+        for (uint32_t column = 0; column < n; ++column) {
+            uint32_t k = 0;
+            for (uint32_t c = 0; c < n; ++c) {
+                if (c == column) {
+                    continue;
+                }
+                for (uint32_t r = 1; r < n; ++r) {
+                    minor[k++] = m[c * n + r];
+                }
+            }
+            const float cofactor = Determinant(minor, n - 1) * m[column * n];
+            result += (column & 1) ? -cofactor : cofactor;
+        }
+        return result;
+    }
+
+    void Inverse(const float* m, uint32_t n, float* result) {
+        const float det = Determinant(m, n);
+        const float scale = det != 0.0f ? 1.0f / det : 0.0f;
+        float minor[9];
+        for (uint32_t column = 0; column < n; ++column) {
+            for (uint32_t row = 0; row < n; ++row) {
+                uint32_t k = 0;
+                for (uint32_t c = 0; c < n; ++c) {
+                    for (uint32_t r = 0; r < n; ++r) {
+                        if (c != column && r != row) {
+                            minor[k++] = m[c * n + r];
+                        }
+                    }
+                }
+                const float cofactor = ((row + column) & 1 ? -1.0f : 1.0f) * Determinant(minor, n - 1);
+                // Adjugate: the transpose of the cofactor matrix
+                result[row * n + column] = cofactor * scale;
+            }
+        }
+    }
+
+    uint32_t PackNorm(float value, bool isSigned, uint32_t bits) {
+        const float max = float((1u << (isSigned ? bits - 1 : bits)) - 1);
+        const float clamped = std::clamp(value, isSigned ? -1.0f : 0.0f, 1.0f);
+        const int32_t packed = int32_t(std::round(clamped * max));
+        return uint32_t(packed) & BitMask(bits);
+    }
+
+    float UnpackNorm(uint32_t value, bool isSigned, uint32_t bits) {
+        if (!isSigned) {
+            return float(value & BitMask(bits)) / float(BitMask(bits));
+        }
+        const int32_t shifted = int32_t(value << (32 - bits)) >> (32 - bits);
+        return std::max(float(shifted) / float((1u << (bits - 1)) - 1), -1.0f);
+    }
+}
+
+// ============================================================================
+// Setup
+// ============================================================================
+
+SoftwareShaderContext::SoftwareShaderContext(const SoftwareShaderProgram& program, uint32_t laneCount)
+    : m_program(program)
+    , m_laneCount(laneCount)
+    , m_memoryStride((program.m_localSize + 15) & ~15u)
+{
+    m_registers.assign(size_t(program.m_registerCount) * laneCount, 0);
+    for (const auto& constant : program.m_constants) {
+        std::fill_n(Reg(constant.reg), laneCount, constant.value);
+    }
+    m_memory.assign(size_t(m_memoryStride) * laneCount, std::byte{0});
+    m_helper.assign(laneCount, 0);
+    m_alive.assign(laneCount, 0);
+    m_discarded.assign(laneCount, 0);
+    m_lanes.resize(laneCount);
+    for (uint32_t lane = 0; lane < laneCount; ++lane) {
+        m_lanes[lane] = uint16_t(lane);
+    }
+
+    uint32_t scratchWords = 0;
+    for (const auto& group : program.m_phiGroups) {
+        scratchWords = std::max(scratchWords, group.scratchWords);
+    }
+    m_scratch.resize(size_t(scratchWords) * laneCount);
+
+    m_functions.resize(program.m_functions.size());
+    for (FunctionState& state : m_functions) {
+        state.block.resize(laneCount);
+        state.previous.resize(laneCount);
+        state.pending.reserve(laneCount);
+        state.active.reserve(laneCount);
+    }
+}
+
+SoftwareShaderContext::~SoftwareShaderContext() = default;
+
+void SoftwareShaderContext::ResetInvocationMemory(uint32_t laneCount) {
+    std::memset(m_memory.data(), 0, size_t(m_memoryStride) * std::min(laneCount, m_laneCount));
+}
+
+std::byte* SoftwareShaderContext::Resolve(const Program::MemoryAccess& access, size_t& laneStride,
+                                          size_t& size) const noexcept {
+    laneStride = 0;
+    switch (access.space) {
+        case Program::Space::Invocation:
+            laneStride = m_memoryStride;
+            size = m_program.m_localSize;
+            return const_cast<std::byte*>(m_memory.data());
+        case Program::Space::Workgroup:
+            size = m_shared ? m_program.m_sharedSize : 0;
+            return m_shared;
+        case Program::Space::Buffer: {
+            const auto& binding = m_bindings->buffers[access.binding];
+            size = binding.data ? binding.size : 0;
+            return binding.data;
+        }
+        case Program::Space::PushConstant:
+            size = SoftwareBindings::PushConstantSize;
+            return const_cast<std::byte*>(m_bindings->pushConstants);
+    }
+    size = 0;
+    return nullptr;
+}
+
+// ============================================================================
+// Control Flow
+// ============================================================================
+
+void SoftwareShaderContext::Run(const SoftwareBindings& bindings, uint32_t laneCount, std::byte* shared) {
+    laneCount = std::min(laneCount, m_laneCount);
+    m_bindings = &bindings;
+    m_shared = shared;
+    std::fill_n(m_alive.begin(), laneCount, uint8_t{1});
+    std::fill_n(m_discarded.begin(), laneCount, uint8_t{0});
+
+    const std::span<const uint16_t> lanes(m_lanes.data(), laneCount);
+    for (const auto& initializer : m_program.m_initializers) {
+        for (uint32_t word = 0; word < initializer.words; ++word) {
+            const uint32_t* value = Reg(initializer.source + word);
+            for (uint16_t lane : lanes) {
+                std::memcpy(GetInvocationMemory(lane) + initializer.target + word * 4, &value[lane], 4);
+            }
+        }
+    }
+
+    RunFunction(m_program.m_entryFunction, lanes);
+    std::fill_n(m_helper.begin(), laneCount, uint8_t{0});
+}
+
+void SoftwareShaderContext::RunFunction(uint32_t function, std::span<const uint16_t> lanes) {
+    FunctionState& state = m_functions[function];
+    const uint32_t entry = m_program.m_functions[function].entryBlock;
+    state.pending.assign(lanes.begin(), lanes.end());
+    for (uint16_t lane : lanes) {
+        state.block[lane] = entry;
+        state.previous[lane] = Finished;
+    }
+
+    // Structured control flow lists blocks so that running the lowest one
+    // any invocation waits at brings diverged invocations back together at
+    // merge blocks
+    while (!state.pending.empty()) {
+        uint32_t block = Finished;
+        for (uint16_t lane : state.pending) {
+            block = std::min(block, state.block[lane]);
+        }
+        state.active.clear();
+        for (uint16_t lane : state.pending) {
+            if (state.block[lane] == block) {
+                state.active.push_back(lane);
+            }
+        }
+
+        RunBlock(block, state, state.active);
+
+        std::erase_if(state.pending, [&](uint16_t lane) {
+            return state.block[lane] == Finished || !m_alive[lane];
+        });
+    }
+}
+
+void SoftwareShaderContext::RunBlock(uint32_t blockIndex, FunctionState& state, std::vector<uint16_t>& lanes) {
+    const Program::Block& block = m_program.m_blocks[blockIndex];
+    const Instruction* inst = m_program.m_instructions.data() + block.first;
+    const Instruction* terminator = inst + block.count - 1;
+
+    for (; inst != terminator && !lanes.empty(); ++inst) {
+        switch (inst->op) {
+            case Program::OpPhiGroup: {
+                // Read every incoming value before writing any phi
+                const Program::PhiGroup& group = m_program.m_phiGroups[inst->extra];
+                uint32_t scratch = 0;
+                for (uint32_t i = 0; i < group.count; ++i) {
+                    const Program::Phi& phi = m_program.m_phis[group.first + i];
+                    for (uint16_t lane : lanes) {
+                        uint32_t source = Program::NoRegister;
+                        for (uint32_t k = 0; k < phi.incomingCount; ++k) {
+                            const Program::Incoming& incoming = m_program.m_incoming[phi.firstIncoming + k];
+                            if (incoming.block == state.previous[lane]) {
+                                source = incoming.value;
+                                break;
+                            }
+                        }
+                        for (uint32_t word = 0; word < phi.words; ++word) {
+                            m_scratch[size_t(scratch + word) * m_laneCount + lane] =
+                                source == Program::NoRegister ? 0 : Reg(source + word)[lane];
+                        }
+                    }
+                    scratch += phi.words;
+                }
+                scratch = 0;
+                for (uint32_t i = 0; i < group.count; ++i) {
+                    const Program::Phi& phi = m_program.m_phis[group.first + i];
+                    for (uint32_t word = 0; word < phi.words; ++word) {
+                        uint32_t* target = Reg(phi.result + word);
+                        for (uint16_t lane : lanes) {
+                            target[lane] = m_scratch[size_t(scratch + word) * m_laneCount + lane];
+                        }
+                    }
+                    scratch += phi.words;
+                }
+                break;
+            }
+            case Program::OpCallFunction: {
+                const Program::CallInfo& call = m_program.m_calls[inst->extra];
+                for (uint32_t i = 0; i < call.argumentCount; ++i) {
+                    const Program::Move& move = m_program.m_moves[call.firstArgument + i];
+                    for (uint32_t word = 0; word < move.words; ++word) {
+                        const uint32_t* source = Reg(move.source + word);
+                        uint32_t* target = Reg(move.target + word);
+                        for (uint16_t lane : lanes) {
+                            target[lane] = source[lane];
+                        }
+                    }
+                }
+                RunFunction(call.function, lanes);
+                std::erase_if(lanes, [&](uint16_t lane) { return !m_alive[lane]; });
+                const Program::Function& callee = m_program.m_functions[call.function];
+                for (uint32_t word = 0; word < inst->count; ++word) {
+                    const uint32_t* source = Reg(callee.resultRegister + word);
+                    uint32_t* target = Reg(inst->result + word);
+                    for (uint16_t lane : lanes) {
+                        target[lane] = source[lane];
+                    }
+                }
+                break;
+            }
+            default:
+                Execute(*inst, lanes);
+                break;
+        }
+    }
+
+    switch (terminator->op) {
+        case spv::OpBranch:
+            for (uint16_t lane : lanes) {
+                state.previous[lane] = blockIndex;
+                state.block[lane] = terminator->a;
+            }
+            break;
+        case spv::OpBranchConditional: {
+            const uint32_t* condition = Reg(terminator->a);
+            for (uint16_t lane : lanes) {
+                state.previous[lane] = blockIndex;
+                state.block[lane] = condition[lane] ? terminator->b : terminator->c;
+            }
+            break;
+        }
+        case spv::OpSwitch: {
+            const Program::SwitchTable& table = m_program.m_switches[terminator->extra];
+            const uint32_t* selector = Reg(terminator->a);
+            for (uint16_t lane : lanes) {
+                uint32_t target = table.defaultBlock;
+                for (uint32_t i = 0; i < table.count; ++i) {
+                    if (m_program.m_cases[table.first + i].value == selector[lane]) {
+                        target = m_program.m_cases[table.first + i].block;
+                        break;
+                    }
+                }
+                state.previous[lane] = blockIndex;
+                state.block[lane] = target;
+            }
+            break;
+        }
+        case spv::OpReturnValue:
+            for (uint32_t word = 0; word < terminator->count; ++word) {
+                const uint32_t* source = Reg(terminator->a + word);
+                uint32_t* target = Reg(terminator->result + word);
+                for (uint16_t lane : lanes) {
+                    target[lane] = source[lane];
+                }
+            }
+            for (uint16_t lane : lanes) {
+                state.block[lane] = Finished;
+            }
+            break;
+        case spv::OpKill:
+            for (uint16_t lane : lanes) {
+                m_alive[lane] = 0;
+                m_discarded[lane] = 1;
+                state.block[lane] = Finished;
+            }
+            break;
+        default:
+            for (uint16_t lane : lanes) {
+                state.block[lane] = Finished;
+            }
+            break;
+    }
+}
+
+// ============================================================================
+// Instructions
+// ============================================================================
+
+void SoftwareShaderContext::Execute(const Instruction& inst, std::span<const uint16_t> lanes) {
+    const Registers regs{m_registers.data(), m_laneCount};
+
+    switch (inst.op) {
+        case Program::OpMove:
+            for (uint32_t c = 0; c < inst.count; ++c) {
+                const uint32_t* source = Reg(inst.a + c);
+                uint32_t* target = Reg(inst.result + c);
+                for (uint16_t lane : lanes) {
+                    target[lane] = source[lane];
+                }
+            }
+            break;
+        case Program::OpGather:
+            for (uint32_t c = 0; c < inst.count; ++c) {
+                const uint32_t* source = Reg(m_program.m_gathers[inst.extra + c]);
+                uint32_t* target = Reg(inst.result + c);
+                for (uint16_t lane : lanes) {
+                    target[lane] = source[lane];
+                }
+            }
+            break;
+
+        // Memory
+        case spv::OpLoad:
+        case spv::OpStore: {
+            const Program::MemoryAccess& access = m_program.m_memory[inst.extra];
+            const uint32_t* offsets = m_program.m_offsets.data() + access.firstOffset;
+            size_t laneStride = 0;
+            size_t size = 0;
+            std::byte* base = Resolve(access, laneStride, size);
+            const uint32_t* pointer = Reg(inst.a);
+            const bool load = inst.op == spv::OpLoad;
+            const bool sideEffect = access.space == Program::Space::Buffer;
+            for (uint32_t word = 0; word < access.words; ++word) {
+                uint32_t* value = Reg((load ? inst.result : inst.b) + word);
+                for (uint16_t lane : lanes) {
+                    const size_t offset = size_t(pointer[lane]) + offsets[word];
+                    const bool inBounds = size >= 4 && offset <= size - 4;
+                    std::byte* address = base + lane * laneStride + offset;
+                    if (load) {
+                        value[lane] = 0;
+                        if (inBounds) {
+                            std::memcpy(&value[lane], address, 4);
+                        }
+                    } else if (inBounds && !(sideEffect && m_helper[lane])) {
+                        std::memcpy(address, &value[lane], 4);
+                    }
+                }
+            }
+            break;
+        }
+        case spv::OpAccessChain: {
+            const Program::AccessChain& chain = m_program.m_chains[inst.extra];
+            const uint32_t* base = Reg(inst.a);
+            uint32_t* result = Reg(inst.result);
+            for (uint16_t lane : lanes) {
+                result[lane] = base[lane] + chain.constantOffset;
+            }
+            for (uint32_t i = 0; i < chain.indexCount; ++i) {
+                const Program::DynamicIndex& index = m_program.m_indices[chain.firstIndex + i];
+                const uint32_t* value = Reg(index.reg);
+                for (uint16_t lane : lanes) {
+                    result[lane] += uint32_t(S(value[lane]) * int32_t(index.stride));
+                }
+            }
+            break;
+        }
+        case spv::OpArrayLength: {
+            size_t laneStride = 0;
+            size_t size = 0;
+            Resolve(m_program.m_memory[inst.extra], laneStride, size);
+            const uint32_t length = size > inst.b ? uint32_t((size - inst.b) / inst.c) : 0;
+            std::fill_n(Reg(inst.result), m_laneCount, length);
+            break;
+        }
+        case spv::OpVectorExtractDynamic: {
+            const uint32_t* index = Reg(inst.b);
+            uint32_t* result = Reg(inst.result);
+            for (uint16_t lane : lanes) {
+                result[lane] = index[lane] < inst.sub ? Reg(inst.a + index[lane])[lane] : 0;
+            }
+            break;
+        }
+        case spv::OpVectorInsertDynamic: {
+            const uint32_t* component = Reg(inst.b);
+            const uint32_t* index = Reg(inst.c);
+            for (uint32_t c = 0; c < inst.count; ++c) {
+                const uint32_t* source = Reg(inst.a + c);
+                uint32_t* target = Reg(inst.result + c);
+                for (uint16_t lane : lanes) {
+                    target[lane] = index[lane] == c ? component[lane] : source[lane];
+                }
+            }
+            break;
+        }
+
+        // Arithmetic
+        case spv::OpSNegate: Unary(regs, inst, lanes, [](uint32_t a) { return 0u - a; }); break;
+        case spv::OpFNegate: FloatUnary(regs, inst, lanes, [](float a) { return -a; }); break;
+        case spv::OpIAdd: Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return a + b; }); break;
+        case spv::OpISub: Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return a - b; }); break;
+        case spv::OpIMul: Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return a * b; }); break;
+        case spv::OpFAdd: FloatBinary(regs, inst, lanes, [](float a, float b) { return a + b; }); break;
+        case spv::OpFSub: FloatBinary(regs, inst, lanes, [](float a, float b) { return a - b; }); break;
+        case spv::OpFMul: FloatBinary(regs, inst, lanes, [](float a, float b) { return a * b; }); break;
+        case spv::OpFDiv: FloatBinary(regs, inst, lanes, [](float a, float b) { return a / b; }); break;
+        case spv::OpUDiv:
+            Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return b ? a / b : 0u; });
+            break;
+        case spv::OpSDiv:
+            Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) {
+                if (b == 0 || (S(a) == INT32_MIN && S(b) == -1)) {
+                    return b == 0 ? 0u : a;
+                }
+                return uint32_t(S(a) / S(b));
+            });
+            break;
+        case spv::OpUMod:
+            Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return b ? a % b : 0u; });
+            break;
+        case spv::OpSRem:
+        case spv::OpSMod:
+            Binary(regs, inst, lanes, [mod = inst.op == spv::OpSMod](uint32_t a, uint32_t b) {
+                if (b == 0 || S(b) == -1) {
+                    return 0u;
+                }
+                int32_t r = S(a) % S(b);
+                if (mod && r != 0 && ((r < 0) != (S(b) < 0))) {
+                    r += S(b);
+                }
+                return uint32_t(r);
+            });
+            break;
+        case spv::OpFRem: FloatBinary(regs, inst, lanes, [](float a, float b) { return std::fmod(a, b); }); break;
+        case spv::OpFMod:
+            FloatBinary(regs, inst, lanes, [](float a, float b) { return a - b * std::floor(a / b); });
+            break;
+        case spv::OpDot: {
+            uint32_t* result = Reg(inst.result);
+            for (uint16_t lane : lanes) {
+                float sum = 0.0f;
+                for (uint32_t c = 0; c < inst.sub; ++c) {
+                    sum += F(Reg(inst.a + c)[lane]) * F(Reg(inst.b + c)[lane]);
+                }
+                result[lane] = U(sum);
+            }
+            break;
+        }
+        case spv::OpMatrixTimesVector:
+        case spv::OpVectorTimesMatrix:
+        case spv::OpMatrixTimesMatrix:
+        case spv::OpOuterProduct:
+        case spv::OpTranspose:
+            ExecuteMatrix(inst, lanes);
+            break;
+
+        // Conversions
+        case spv::OpConvertFToU:
+            Unary(regs, inst, lanes, [](uint32_t a) { return SaturatingCast<uint32_t>(F(a)); });
+            break;
+        case spv::OpConvertFToS:
+            Unary(regs, inst, lanes, [](uint32_t a) { return uint32_t(SaturatingCast<int32_t>(F(a))); });
+            break;
+        case spv::OpConvertSToF: Unary(regs, inst, lanes, [](uint32_t a) { return U(float(S(a))); }); break;
+        case spv::OpConvertUToF: Unary(regs, inst, lanes, [](uint32_t a) { return U(float(a)); }); break;
+        case spv::OpQuantizeToF16:
+            FloatUnary(regs, inst, lanes, [](float a) {
+                return SoftwareFormatUtils::HalfToFloat(SoftwareFormatUtils::FloatToHalf(a));
+            });
+            break;
+
+        // Bits
+        case spv::OpShiftRightLogical:
+            Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return a >> (b & 31); });
+            break;
+        case spv::OpShiftRightArithmetic:
+            Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return uint32_t(S(a) >> (b & 31)); });
+            break;
+        case spv::OpShiftLeftLogical:
+            Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return a << (b & 31); });
+            break;
+        case spv::OpBitwiseOr: Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return a | b; }); break;
+        case spv::OpBitwiseXor: Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return a ^ b; }); break;
+        case spv::OpBitwiseAnd: Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return a & b; }); break;
+        case spv::OpNot: Unary(regs, inst, lanes, [](uint32_t a) { return ~a; }); break;
+        case spv::OpBitReverse: Unary(regs, inst, lanes, [](uint32_t a) { return BitReverse(a); }); break;
+        case spv::OpBitCount: Unary(regs, inst, lanes, [](uint32_t a) { return uint32_t(std::popcount(a)); }); break;
+        case spv::OpBitFieldInsert: {
+            const uint32_t* offsets = Reg(inst.c);
+            const uint32_t* counts = Reg(inst.extra);
+            for (uint32_t c = 0; c < inst.count; ++c) {
+                const uint32_t* base = Reg(inst.a + c);
+                const uint32_t* insert = Reg(inst.b + c);
+                uint32_t* result = Reg(inst.result + c);
+                for (uint16_t lane : lanes) {
+                    const uint32_t offset = offsets[lane] & 31;
+                    const uint32_t mask = BitMask(counts[lane]) << offset;
+                    result[lane] = (base[lane] & ~mask) | ((insert[lane] << offset) & mask);
+                }
+            }
+            break;
+        }
+        case spv::OpBitFieldSExtract:
+        case spv::OpBitFieldUExtract: {
+            const bool isSigned = inst.op == spv::OpBitFieldSExtract;
+            const uint32_t* offsets = Reg(inst.b);
+            const uint32_t* counts = Reg(inst.c);
+            for (uint32_t c = 0; c < inst.count; ++c) {
+                const uint32_t* base = Reg(inst.a + c);
+                uint32_t* result = Reg(inst.result + c);
+                for (uint16_t lane : lanes) {
+                    const uint32_t count = std::min(counts[lane], 32u);
+                    if (count == 0) {
+                        result[lane] = 0;
+                        continue;
+                    }
+                    const uint32_t value = (base[lane] >> (offsets[lane] & 31)) & BitMask(count);
+                    const uint32_t shift = 32 - count;
+                    result[lane] = isSigned ? uint32_t(S(value << shift) >> shift) : value;
+                }
+            }
+            break;
+        }
+
+        // Logic
+        case spv::OpLogicalNot: Unary(regs, inst, lanes, [](uint32_t a) { return a ? 0u : 1u; }); break;
+        case spv::OpLogicalEqual:
+            Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return (a != 0) == (b != 0) ? 1u : 0u; });
+            break;
+        case spv::OpLogicalNotEqual:
+            Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return (a != 0) != (b != 0) ? 1u : 0u; });
+            break;
+        case spv::OpLogicalOr:
+            Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return a || b ? 1u : 0u; });
+            break;
+        case spv::OpLogicalAnd:
+            Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return a && b ? 1u : 0u; });
+            break;
+        case spv::OpSelect:
+            Ternary(regs, inst, lanes, [](uint32_t c, uint32_t a, uint32_t b) { return c ? a : b; });
+            break;
+        case spv::OpAny:
+        case spv::OpAll: {
+            const bool any = inst.op == spv::OpAny;
+            uint32_t* result = Reg(inst.result);
+            for (uint16_t lane : lanes) {
+                bool value = !any;
+                for (uint32_t c = 0; c < inst.sub; ++c) {
+                    const bool component = Reg(inst.a + c)[lane] != 0;
+                    value = any ? (value || component) : (value && component);
+                }
+                result[lane] = value ? 1u : 0u;
+            }
+            break;
+        }
+        case spv::OpIsNan: Unary(regs, inst, lanes, [](uint32_t a) { return std::isnan(F(a)) ? 1u : 0u; }); break;
+        case spv::OpIsInf: Unary(regs, inst, lanes, [](uint32_t a) { return std::isinf(F(a)) ? 1u : 0u; }); break;
+        case spv::OpIEqual: Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return a == b ? 1u : 0u; }); break;
+        case spv::OpINotEqual: Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return a != b ? 1u : 0u; }); break;
+        case spv::OpUGreaterThan: Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return a > b ? 1u : 0u; }); break;
+        case spv::OpUGreaterThanEqual: Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return a >= b ? 1u : 0u; }); break;
+        case spv::OpULessThan: Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return a < b ? 1u : 0u; }); break;
+        case spv::OpULessThanEqual: Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return a <= b ? 1u : 0u; }); break;
+        case spv::OpSGreaterThan: Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return S(a) > S(b) ? 1u : 0u; }); break;
+        case spv::OpSGreaterThanEqual: Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return S(a) >= S(b) ? 1u : 0u; }); break;
+        case spv::OpSLessThan: Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return S(a) < S(b) ? 1u : 0u; }); break;
+        case spv::OpSLessThanEqual: Binary(regs, inst, lanes, [](uint32_t a, uint32_t b) { return S(a) <= S(b) ? 1u : 0u; }); break;
+        case spv::OpFOrdEqual: Compare(regs, inst, lanes, [](float a, float b) { return a == b; }); break;
+        case spv::OpFOrdNotEqual: Compare(regs, inst, lanes, [](float a, float b) { return a < b || a > b; }); break;
+        case spv::OpFOrdLessThan: Compare(regs, inst, lanes, [](float a, float b) { return a < b; }); break;
+        case spv::OpFOrdGreaterThan: Compare(regs, inst, lanes, [](float a, float b) { return a > b; }); break;
+        case spv::OpFOrdLessThanEqual: Compare(regs, inst, lanes, [](float a, float b) { return a <= b; }); break;
+        case spv::OpFOrdGreaterThanEqual: Compare(regs, inst, lanes, [](float a, float b) { return a >= b; }); break;
+        case spv::OpFUnordEqual: Compare(regs, inst, lanes, [](float a, float b) { return !(a < b || a > b); }); break;
+        case spv::OpFUnordNotEqual: Compare(regs, inst, lanes, [](float a, float b) { return !(a == b); }); break;
+        case spv::OpFUnordLessThan: Compare(regs, inst, lanes, [](float a, float b) { return !(a >= b); }); break;
+        case spv::OpFUnordGreaterThan: Compare(regs, inst, lanes, [](float a, float b) { return !(a <= b); }); break;
+        case spv::OpFUnordLessThanEqual: Compare(regs, inst, lanes, [](float a, float b) { return !(a > b); }); break;
+        case spv::OpFUnordGreaterThanEqual: Compare(regs, inst, lanes, [](float a, float b) { return !(a < b); }); break;
+
+        // Derivatives, differenced across each 2x2 quad
+        case spv::OpDPdx:
+        case spv::OpDPdy:
+        case spv::OpFwidth:
+        case spv::OpDPdxFine:
+        case spv::OpDPdyFine:
+        case spv::OpFwidthFine:
+        case spv::OpDPdxCoarse:
+        case spv::OpDPdyCoarse:
+        case spv::OpFwidthCoarse: {
+            const bool coarse = inst.op == spv::OpDPdxCoarse || inst.op == spv::OpDPdyCoarse ||
+                                inst.op == spv::OpFwidthCoarse;
+            const bool wantX = inst.op != spv::OpDPdy && inst.op != spv::OpDPdyFine && inst.op != spv::OpDPdyCoarse;
+            const bool wantY = inst.op != spv::OpDPdx && inst.op != spv::OpDPdxFine && inst.op != spv::OpDPdxCoarse;
+            const bool quads = m_program.m_stage == ShaderStage::Fragment;
+            for (uint32_t c = 0; c < inst.count; ++c) {
+                const uint32_t* value = Reg(inst.a + c);
+                uint32_t* result = Reg(inst.result + c);
+                for (uint16_t lane : lanes) {
+                    if (!quads) {
+                        result[lane] = 0;
+                        continue;
+                    }
+                    const uint32_t quad = lane & ~3u;
+                    const uint32_t row = coarse ? quad : quad + (lane & 2u);
+                    const uint32_t column = coarse ? quad : quad + (lane & 1u);
+                    const float dx = F(value[row + 1]) - F(value[row]);
+                    const float dy = F(value[column + 2]) - F(value[column]);
+                    result[lane] = U(wantX && wantY ? std::abs(dx) + std::abs(dy) : (wantX ? dx : dy));
+                }
+            }
+            break;
+        }
+
+        case spv::OpIsHelperInvocationEXT: {
+            uint32_t* result = Reg(inst.result);
+            for (uint16_t lane : lanes) {
+                result[lane] = m_helper[lane];
+            }
+            break;
+        }
+        case spv::OpDemoteToHelperInvocation:
+            for (uint16_t lane : lanes) {
+                m_helper[lane] = 1;
+                m_discarded[lane] = 1;
+            }
+            break;
+
+        case spv::OpExtInst:
+            ExecuteExtended(inst, lanes);
+            break;
+
+        case spv::OpImageSampleImplicitLod:
+        case spv::OpImageSampleExplicitLod:
+        case spv::OpImageSampleDrefImplicitLod:
+        case spv::OpImageSampleDrefExplicitLod:
+        case spv::OpImageSampleProjImplicitLod:
+        case spv::OpImageSampleProjExplicitLod:
+        case spv::OpImageSampleProjDrefImplicitLod:
+        case spv::OpImageSampleProjDrefExplicitLod:
+        case spv::OpImageFetch:
+        case spv::OpImageRead:
+        case spv::OpImageWrite:
+        case spv::OpImageQuerySizeLod:
+        case spv::OpImageQuerySize:
+        case spv::OpImageQueryLevels:
+        case spv::OpImageQueryLod:
+            ExecuteImage(inst, lanes);
+            break;
+
+        default:
+            ExecuteAtomic(inst, lanes);
+            break;
+    }
+}
+
+void SoftwareShaderContext::ExecuteMatrix(const Instruction& inst, std::span<const uint16_t> lanes) {
+    const uint32_t rows = inst.sub;
+    const uint32_t inner = inst.extra;
+    const uint32_t columns = inst.count / std::max(rows, 1u);
+
+    for (uint32_t column = 0; column < columns; ++column) {
+        for (uint32_t row = 0; row < rows; ++row) {
+            uint32_t* result = Reg(inst.result + column * rows + row);
+            switch (inst.op) {
+                case spv::OpMatrixTimesVector:
+                    // M (inner columns of `rows`) * v (inner)
+                    for (uint16_t lane : lanes) {
+                        float sum = 0.0f;
+                        for (uint32_t k = 0; k < inner; ++k) {
+                            sum += F(Reg(inst.a + k * rows + row)[lane]) * F(Reg(inst.b + k)[lane]);
+                        }
+                        result[lane] = U(sum);
+                    }
+                    break;
+                case spv::OpVectorTimesMatrix:
+                    // v (inner) * M (result-length columns of inner)
+                    for (uint16_t lane : lanes) {
+                        float sum = 0.0f;
+                        for (uint32_t k = 0; k < inner; ++k) {
+                            sum += F(Reg(inst.a + k)[lane]) * F(Reg(inst.b + column * inner + k)[lane]);
+                        }
+                        result[lane] = U(sum);
+                    }
+                    break;
+                case spv::OpMatrixTimesMatrix:
+                    for (uint16_t lane : lanes) {
+                        float sum = 0.0f;
+                        for (uint32_t k = 0; k < inner; ++k) {
+                            sum += F(Reg(inst.a + k * rows + row)[lane]) * F(Reg(inst.b + column * inner + k)[lane]);
+                        }
+                        result[lane] = U(sum);
+                    }
+                    break;
+                case spv::OpOuterProduct:
+                    for (uint16_t lane : lanes) {
+                        result[lane] = U(F(Reg(inst.a + row)[lane]) * F(Reg(inst.b + column)[lane]));
+                    }
+                    break;
+                default: {
+                    // Transpose: the input has `rows` columns of `columns` rows
+                    const uint32_t* source = Reg(inst.a + row * columns + column);
+                    for (uint16_t lane : lanes) {
+                        result[lane] = source[lane];
+                    }
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void SoftwareShaderContext::ExecuteExtended(const Instruction& inst, std::span<const uint16_t> lanes) {
+    const Registers regs{m_registers.data(), m_laneCount};
+    const auto vectorLoop = [&](auto fn) {
+        float a[16];
+        float b[16];
+        float c[16];
+        float r[16];
+        const uint32_t n = std::min(inst.extra, 16u);
+        for (uint16_t lane : lanes) {
+            for (uint32_t i = 0; i < n; ++i) {
+                a[i] = F(Reg(inst.a + i)[lane]);
+                b[i] = F(Reg(inst.b + i)[lane]);
+                c[i] = F(Reg(inst.c + i)[lane]);
+            }
+            fn(a, b, c, r, n);
+            for (uint32_t i = 0; i < inst.count; ++i) {
+                Reg(inst.result + i)[lane] = U(r[i]);
+            }
+        }
+    };
+    const auto dot = [](const float* x, const float* y, uint32_t n) {
+        float sum = 0.0f;
+        for (uint32_t i = 0; i < n; ++i) {
+            sum += x[i] * y[i];
+        }
+        return sum;
+    };
+
+    switch (inst.sub) {
+        case GLSLstd450Round: FloatUnary(regs, inst, lanes, [](float x) { return std::round(x); }); break;
+        case GLSLstd450RoundEven: FloatUnary(regs, inst, lanes, [](float x) { return std::nearbyint(x); }); break;
+        case GLSLstd450Trunc: FloatUnary(regs, inst, lanes, [](float x) { return std::trunc(x); }); break;
+        case GLSLstd450FAbs: FloatUnary(regs, inst, lanes, [](float x) { return std::abs(x); }); break;
+        case GLSLstd450SAbs: Unary(regs, inst, lanes, [](uint32_t x) { return S(x) < 0 ? 0u - x : x; }); break;
+        case GLSLstd450FSign:
+            FloatUnary(regs, inst, lanes, [](float x) { return x > 0.0f ? 1.0f : (x < 0.0f ? -1.0f : 0.0f); });
+            break;
+        case GLSLstd450SSign:
+            Unary(regs, inst, lanes, [](uint32_t x) { return uint32_t(S(x) > 0 ? 1 : (S(x) < 0 ? -1 : 0)); });
+            break;
+        case GLSLstd450Floor: FloatUnary(regs, inst, lanes, [](float x) { return std::floor(x); }); break;
+        case GLSLstd450Ceil: FloatUnary(regs, inst, lanes, [](float x) { return std::ceil(x); }); break;
+        case GLSLstd450Fract: FloatUnary(regs, inst, lanes, [](float x) { return x - std::floor(x); }); break;
+        case GLSLstd450Radians: FloatUnary(regs, inst, lanes, [](float x) { return x * 0.017453292519943295f; }); break;
+        case GLSLstd450Degrees: FloatUnary(regs, inst, lanes, [](float x) { return x * 57.29577951308232f; }); break;
+        case GLSLstd450Sin: FloatUnary(regs, inst, lanes, [](float x) { return std::sin(x); }); break;
+        case GLSLstd450Cos: FloatUnary(regs, inst, lanes, [](float x) { return std::cos(x); }); break;
+        case GLSLstd450Tan: FloatUnary(regs, inst, lanes, [](float x) { return std::tan(x); }); break;
+        case GLSLstd450Asin: FloatUnary(regs, inst, lanes, [](float x) { return std::asin(x); }); break;
+        case GLSLstd450Acos: FloatUnary(regs, inst, lanes, [](float x) { return std::acos(x); }); break;
+        case GLSLstd450Atan: FloatUnary(regs, inst, lanes, [](float x) { return std::atan(x); }); break;
+        case GLSLstd450Sinh: FloatUnary(regs, inst, lanes, [](float x) { return std::sinh(x); }); break;
+        case GLSLstd450Cosh: FloatUnary(regs, inst, lanes, [](float x) { return std::cosh(x); }); break;
+        case GLSLstd450Tanh: FloatUnary(regs, inst, lanes, [](float x) { return std::tanh(x); }); break;
+        case GLSLstd450Asinh: FloatUnary(regs, inst, lanes, [](float x) { return std::asinh(x); }); break;
+        case GLSLstd450Acosh: FloatUnary(regs, inst, lanes, [](float x) { return std::acosh(x); }); break;
+        case GLSLstd450Atanh: FloatUnary(regs, inst, lanes, [](float x) { return std::atanh(x); }); break;
+        case GLSLstd450Atan2: FloatBinary(regs, inst, lanes, [](float y, float x) { return std::atan2(y, x); }); break;
+        case GLSLstd450Pow: FloatBinary(regs, inst, lanes, [](float x, float y) { return std::pow(x, y); }); break;
+        case GLSLstd450Exp: FloatUnary(regs, inst, lanes, [](float x) { return std::exp(x); }); break;
+        case GLSLstd450Log: FloatUnary(regs, inst, lanes, [](float x) { return std::log(x); }); break;
+        case GLSLstd450Exp2: FloatUnary(regs, inst, lanes, [](float x) { return std::exp2(x); }); break;
+        case GLSLstd450Log2: FloatUnary(regs, inst, lanes, [](float x) { return std::log2(x); }); break;
+        case GLSLstd450Sqrt: FloatUnary(regs, inst, lanes, [](float x) { return std::sqrt(x); }); break;
+        case GLSLstd450InverseSqrt: FloatUnary(regs, inst, lanes, [](float x) { return 1.0f / std::sqrt(x); }); break;
+        case GLSLstd450FMin:
+        case GLSLstd450NMin:
+            FloatBinary(regs, inst, lanes, [](float x, float y) { return std::fmin(x, y); });
+            break;
+        case GLSLstd450FMax:
+        case GLSLstd450NMax:
+            FloatBinary(regs, inst, lanes, [](float x, float y) { return std::fmax(x, y); });
+            break;
+        case GLSLstd450UMin: Binary(regs, inst, lanes, [](uint32_t x, uint32_t y) { return std::min(x, y); }); break;
+        case GLSLstd450UMax: Binary(regs, inst, lanes, [](uint32_t x, uint32_t y) { return std::max(x, y); }); break;
+        case GLSLstd450SMin:
+            Binary(regs, inst, lanes, [](uint32_t x, uint32_t y) { return uint32_t(std::min(S(x), S(y))); });
+            break;
+        case GLSLstd450SMax:
+            Binary(regs, inst, lanes, [](uint32_t x, uint32_t y) { return uint32_t(std::max(S(x), S(y))); });
+            break;
+        case GLSLstd450FClamp:
+        case GLSLstd450NClamp:
+            FloatTernary(regs, inst, lanes, [](float x, float lo, float hi) { return std::fmin(std::fmax(x, lo), hi); });
+            break;
+        case GLSLstd450UClamp:
+            Ternary(regs, inst, lanes, [](uint32_t x, uint32_t lo, uint32_t hi) { return std::min(std::max(x, lo), hi); });
+            break;
+        case GLSLstd450SClamp:
+            Ternary(regs, inst, lanes, [](uint32_t x, uint32_t lo, uint32_t hi) {
+                return uint32_t(std::min(std::max(S(x), S(lo)), S(hi)));
+            });
+            break;
+        case GLSLstd450FMix:
+            FloatTernary(regs, inst, lanes, [](float x, float y, float a) { return x + (y - x) * a; });
+            break;
+        case GLSLstd450Step:
+            FloatBinary(regs, inst, lanes, [](float edge, float x) { return x < edge ? 0.0f : 1.0f; });
+            break;
+        case GLSLstd450SmoothStep:
+            FloatTernary(regs, inst, lanes, [](float e0, float e1, float x) {
+                const float t = std::clamp((x - e0) / (e1 - e0), 0.0f, 1.0f);
+                return t * t * (3.0f - 2.0f * t);
+            });
+            break;
+        case GLSLstd450Fma:
+            FloatTernary(regs, inst, lanes, [](float a, float b, float c) { return a * b + c; });
+            break;
+        case GLSLstd450Ldexp:
+            Binary(regs, inst, lanes, [](uint32_t x, uint32_t e) { return U(std::ldexp(F(x), S(e))); });
+            break;
+        case GLSLstd450FindILsb:
+            Unary(regs, inst, lanes, [](uint32_t x) { return x ? uint32_t(std::countr_zero(x)) : UINT32_MAX; });
+            break;
+        case GLSLstd450FindUMsb:
+            Unary(regs, inst, lanes, [](uint32_t x) { return x ? uint32_t(31 - std::countl_zero(x)) : UINT32_MAX; });
+            break;
+        case GLSLstd450FindSMsb:
+            Unary(regs, inst, lanes, [](uint32_t x) {
+                const uint32_t v = S(x) < 0 ? ~x : x;
+                return v ? uint32_t(31 - std::countl_zero(v)) : UINT32_MAX;
+            });
+            break;
+
+        // Whole vectors
+        case GLSLstd450Length:
+            vectorLoop([&](const float* a, const float*, const float*, float* r, uint32_t n) {
+                r[0] = std::sqrt(dot(a, a, n));
+            });
+            break;
+        case GLSLstd450Distance:
+            vectorLoop([&](const float* a, const float* b, const float*, float* r, uint32_t n) {
+                float d[16];
+                for (uint32_t i = 0; i < n; ++i) {
+                    d[i] = a[i] - b[i];
+                }
+                r[0] = std::sqrt(dot(d, d, n));
+            });
+            break;
+        case GLSLstd450Normalize:
+            vectorLoop([&](const float* a, const float*, const float*, float* r, uint32_t n) {
+                const float scale = 1.0f / std::sqrt(dot(a, a, n));
+                for (uint32_t i = 0; i < n; ++i) {
+                    r[i] = a[i] * scale;
+                }
+            });
+            break;
+        case GLSLstd450Cross:
+            vectorLoop([](const float* a, const float* b, const float*, float* r, uint32_t) {
+                r[0] = a[1] * b[2] - a[2] * b[1];
+                r[1] = a[2] * b[0] - a[0] * b[2];
+                r[2] = a[0] * b[1] - a[1] * b[0];
+            });
+            break;
+        case GLSLstd450FaceForward:
+            vectorLoop([&](const float* n, const float* i, const float* ref, float* r, uint32_t count) {
+                const float sign = dot(ref, i, count) < 0.0f ? 1.0f : -1.0f;
+                for (uint32_t k = 0; k < count; ++k) {
+                    r[k] = n[k] * sign;
+                }
+            });
+            break;
+        case GLSLstd450Reflect:
+            vectorLoop([&](const float* i, const float* n, const float*, float* r, uint32_t count) {
+                const float d = 2.0f * dot(n, i, count);
+                for (uint32_t k = 0; k < count; ++k) {
+                    r[k] = i[k] - d * n[k];
+                }
+            });
+            break;
+        case GLSLstd450Refract: {
+            const uint32_t* etas = Reg(inst.c);
+            for (uint16_t lane : lanes) {
+                float i[4];
+                float n[4];
+                const uint32_t count = std::min(inst.extra, 4u);
+                for (uint32_t k = 0; k < count; ++k) {
+                    i[k] = F(Reg(inst.a + k)[lane]);
+                    n[k] = F(Reg(inst.b + k)[lane]);
+                }
+                const float eta = F(etas[lane]);
+                const float d = dot(n, i, count);
+                const float k2 = 1.0f - eta * eta * (1.0f - d * d);
+                for (uint32_t k = 0; k < count; ++k) {
+                    const float value = k2 < 0.0f ? 0.0f : eta * i[k] - (eta * d + std::sqrt(k2)) * n[k];
+                    Reg(inst.result + k)[lane] = U(value);
+                }
+            }
+            break;
+        }
+        case GLSLstd450Determinant:
+        case GLSLstd450MatrixInverse: {
+            const uint32_t n = uint32_t(std::lround(std::sqrt(float(inst.extra))));
+            for (uint16_t lane : lanes) {
+                float m[16];
+                float r[16];
+                for (uint32_t k = 0; k < n * n; ++k) {
+                    m[k] = F(Reg(inst.a + k)[lane]);
+                }
+                if (inst.sub == GLSLstd450Determinant) {
+                    Reg(inst.result)[lane] = U(Determinant(m, n));
+                    continue;
+                }
+                Inverse(m, n, r);
+                for (uint32_t k = 0; k < n * n; ++k) {
+                    Reg(inst.result + k)[lane] = U(r[k]);
+                }
+            }
+            break;
+        }
+        case GLSLstd450PackSnorm4x8:
+        case GLSLstd450PackUnorm4x8:
+        case GLSLstd450PackSnorm2x16:
+        case GLSLstd450PackUnorm2x16:
+        case GLSLstd450PackHalf2x16: {
+            const bool isSigned = inst.sub == GLSLstd450PackSnorm4x8 || inst.sub == GLSLstd450PackSnorm2x16;
+            const uint32_t bits = inst.extra == 4 ? 8 : 16;
+            for (uint16_t lane : lanes) {
+                uint32_t packed = 0;
+                for (uint32_t k = 0; k < inst.extra; ++k) {
+                    const float value = F(Reg(inst.a + k)[lane]);
+                    const uint32_t part = inst.sub == GLSLstd450PackHalf2x16
+                        ? SoftwareFormatUtils::FloatToHalf(value)
+                        : PackNorm(value, isSigned, bits);
+                    packed |= part << (k * bits);
+                }
+                Reg(inst.result)[lane] = packed;
+            }
+            break;
+        }
+        case GLSLstd450UnpackSnorm4x8:
+        case GLSLstd450UnpackUnorm4x8:
+        case GLSLstd450UnpackSnorm2x16:
+        case GLSLstd450UnpackUnorm2x16:
+        case GLSLstd450UnpackHalf2x16: {
+            const bool isSigned = inst.sub == GLSLstd450UnpackSnorm4x8 || inst.sub == GLSLstd450UnpackSnorm2x16;
+            const uint32_t bits = inst.count == 4 ? 8 : 16;
+            const uint32_t* packed = Reg(inst.a);
+            for (uint16_t lane : lanes) {
+                for (uint32_t k = 0; k < inst.count; ++k) {
+                    const uint32_t part = (packed[lane] >> (k * bits)) & BitMask(bits);
+                    const float value = inst.sub == GLSLstd450UnpackHalf2x16
+                        ? SoftwareFormatUtils::HalfToFloat(uint16_t(part))
+                        : UnpackNorm(part, isSigned, bits);
+                    Reg(inst.result + k)[lane] = U(value);
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void SoftwareShaderContext::ExecuteImage(const Instruction& inst, std::span<const uint16_t> lanes) {
+    const Program::ImageAccess& access = m_program.m_images[inst.extra];
+    SoftwareTexture* texture = m_bindings->images[access.image].texture;
+    if (!texture) {
+        for (uint32_t c = 0; c < inst.count && inst.op != spv::OpImageWrite; ++c) {
+            uint32_t* result = Reg(inst.result + c);
+            for (uint16_t lane : lanes) {
+                result[lane] = 0;
+            }
+        }
+        return;
+    }
+
+    const auto readInt = [&](uint32_t reg, uint16_t lane) {
+        return reg == Program::NoRegister ? 0 : S(Reg(reg)[lane]);
+    };
+    const auto writeResult = [&](uint16_t lane, const uint32_t (&words)[4]) {
+        for (uint32_t c = 0; c < inst.count && c < 4; ++c) {
+            Reg(inst.result + c)[lane] = words[c];
+        }
+    };
+    const auto readCoordinates = [&](uint16_t lane, int32_t (&coord)[4]) {
+        for (uint32_t k = 0; k < 4; ++k) {
+            coord[k] = k < access.coordinateWords ? S(Reg(access.coordinate + k)[lane]) : 0;
+        }
+        if (access.offset != Program::NoRegister) {
+            const uint32_t dims = access.dim == SoftwareImageDim::Dim1D ? 1 : (access.dim == SoftwareImageDim::Dim3D ? 3 : 2);
+            for (uint32_t k = 0; k < dims; ++k) {
+                coord[k] += S(Reg(access.offset + k)[lane]);
+            }
+        }
+    };
+
+    switch (inst.op) {
+        case spv::OpImageFetch:
+        case spv::OpImageRead:
+            for (uint16_t lane : lanes) {
+                int32_t coord[4];
+                uint32_t texel[4];
+                readCoordinates(lane, coord);
+                texture->Fetch(access.dim, access.arrayed, coord, readInt(access.lod, lane), texel);
+                writeResult(lane, texel);
+            }
+            return;
+        case spv::OpImageWrite:
+            for (uint16_t lane : lanes) {
+                if (m_helper[lane]) {
+                    continue;
+                }
+                int32_t coord[4];
+                uint32_t texel[4] = {0, 0, 0, 0};
+                readCoordinates(lane, coord);
+                for (uint32_t c = 0; c < inst.count && c < 4; ++c) {
+                    texel[c] = Reg(access.texel + c)[lane];
+                }
+                texture->Store(access.dim, access.arrayed, coord, texel);
+            }
+            return;
+        case spv::OpImageQuerySize:
+        case spv::OpImageQuerySizeLod:
+            for (uint16_t lane : lanes) {
+                uint32_t size[4];
+                texture->QuerySize(access.dim, access.arrayed, readInt(access.lod, lane), size);
+                writeResult(lane, size);
+            }
+            return;
+        case spv::OpImageQueryLevels: {
+            uint32_t* result = Reg(inst.result);
+            for (uint16_t lane : lanes) {
+                result[lane] = texture->GetMipLevels();
+            }
+            return;
+        }
+        default:
+            break;
+    }
+
+    // Filtered lookups
+    const SamplerDesc* boundSampler = access.sampler != Program::NoRegister
+        ? m_bindings->images[access.sampler].sampler
+        : m_bindings->images[access.image].sampler;
+    SamplerDesc sampler = boundSampler ? *boundSampler : SoftwareSampler::GetDefault().GetDesc();
+    if (!sampler.compareEnable) {
+        sampler.compareOp = CompareOp::LessOrEqual;
+    }
+
+    const bool quads = m_program.m_stage == ShaderStage::Fragment;
+    const bool implicitLod = access.lod == Program::NoRegister && access.gradX == Program::NoRegister;
+    const uint32_t dims = access.dim == SoftwareImageDim::Dim1D ? 1 : (access.dim == SoftwareImageDim::Dim3D ? 3 : (access.dim == SoftwareImageDim::Cube ? 3 : 2));
+    const uint32_t projection = access.project ? access.coordinateWords - 1 : 0;
+
+    // Coordinate k of an invocation, divided by q for projective lookups
+    const auto coordinate = [&](uint32_t lane, uint32_t k) {
+        const float value = k < access.coordinateWords ? F(Reg(access.coordinate + k)[lane]) : 0.0f;
+        return access.project && k < dims ? value / F(Reg(access.coordinate + projection)[lane]) : value;
+    };
+
+    for (uint16_t lane : lanes) {
+        SoftwareSampleRequest request;
+        request.dim = access.dim;
+        request.arrayed = access.arrayed;
+        for (uint32_t k = 0; k < 4; ++k) {
+            request.coord[k] = coordinate(lane, k);
+        }
+        if (access.offset != Program::NoRegister) {
+            for (uint32_t k = 0; k < dims && k < 3; ++k) {
+                request.offset[k] = S(Reg(access.offset + k)[lane]);
+            }
+        }
+        if (access.reference != Program::NoRegister) {
+            request.compare = true;
+            request.reference = F(Reg(access.reference)[lane]);
+            if (access.project) {
+                request.reference /= F(Reg(access.coordinate + projection)[lane]);
+            }
+        }
+
+        float lod = 0.0f;
+        if (access.lod != Program::NoRegister) {
+            lod = F(Reg(access.lod)[lane]);
+        } else {
+            float ddx[3] = {0.0f, 0.0f, 0.0f};
+            float ddy[3] = {0.0f, 0.0f, 0.0f};
+            bool haveDerivatives = false;
+            if (access.gradX != Program::NoRegister) {
+                for (uint32_t k = 0; k < dims; ++k) {
+                    ddx[k] = F(Reg(access.gradX + k)[lane]);
+                    ddy[k] = F(Reg(access.gradY + k)[lane]);
+                }
+                haveDerivatives = true;
+            } else if (implicitLod && quads) {
+                const uint32_t quad = lane & ~3u;
+                const uint32_t row = quad + (lane & 2u);
+                const uint32_t column = quad + (lane & 1u);
+                for (uint32_t k = 0; k < dims; ++k) {
+                    ddx[k] = coordinate(row + 1, k) - coordinate(row, k);
+                    ddy[k] = coordinate(column + 2, k) - coordinate(column, k);
+                }
+                haveDerivatives = true;
+            }
+            if (haveDerivatives) {
+                lod = texture->ComputeLod(request, ddx, ddy);
+            }
+        }
+        if (access.bias != Program::NoRegister) {
+            lod += F(Reg(access.bias)[lane]);
+        }
+
+        if (inst.op == spv::OpImageQueryLod) {
+            const float clamped = std::clamp(lod + sampler.mipLodBias, sampler.minLod, sampler.maxLod);
+            Reg(inst.result)[lane] = U(std::min(clamped, float(texture->GetMipLevels() - 1)));
+            Reg(inst.result + 1)[lane] = U(lod);
+            continue;
+        }
+
+        request.lod = lod;
+        uint32_t texel[4];
+        texture->Sample(sampler, request, texel);
+        writeResult(lane, texel);
+    }
+}
+
+void SoftwareShaderContext::ExecuteAtomic(const Instruction& inst, std::span<const uint16_t> lanes) {
+    switch (inst.op) {
+        case spv::OpAtomicLoad:
+        case spv::OpAtomicStore:
+        case spv::OpAtomicExchange:
+        case spv::OpAtomicCompareExchange:
+        case spv::OpAtomicIIncrement:
+        case spv::OpAtomicIDecrement:
+        case spv::OpAtomicIAdd:
+        case spv::OpAtomicISub:
+        case spv::OpAtomicSMin:
+        case spv::OpAtomicUMin:
+        case spv::OpAtomicSMax:
+        case spv::OpAtomicUMax:
+        case spv::OpAtomicAnd:
+        case spv::OpAtomicOr:
+        case spv::OpAtomicXor:
+            break;
+        default:
+            return;
+    }
+
+    const Program::MemoryAccess& access = m_program.m_memory[inst.extra];
+    size_t laneStride = 0;
+    size_t size = 0;
+    std::byte* base = Resolve(access, laneStride, size);
+    const uint32_t* pointer = Reg(inst.a);
+    const bool readOnly = inst.op == spv::OpAtomicLoad;
+
+    for (uint16_t lane : lanes) {
+        const size_t offset = pointer[lane] + size_t(m_program.m_offsets[access.firstOffset]);
+        uint32_t original = 0;
+        if (size >= 4 && offset <= size - 4 && (offset & 3) == 0 && (readOnly || !m_helper[lane])) {
+            std::atomic_ref<uint32_t> target(*reinterpret_cast<uint32_t*>(base + offset));
+            const uint32_t value = inst.op == spv::OpAtomicIIncrement || inst.op == spv::OpAtomicIDecrement
+                ? 1u : (inst.op == spv::OpAtomicLoad ? 0u : Reg(inst.b)[lane]);
+            switch (inst.op) {
+                case spv::OpAtomicLoad: original = target.load(); break;
+                case spv::OpAtomicStore: target.store(value); break;
+                case spv::OpAtomicExchange: original = target.exchange(value); break;
+                case spv::OpAtomicCompareExchange: {
+                    uint32_t expected = Reg(inst.c)[lane];
+                    target.compare_exchange_strong(expected, value);
+                    original = expected;
+                    break;
+                }
+                case spv::OpAtomicIIncrement:
+                case spv::OpAtomicIAdd: original = target.fetch_add(value); break;
+                case spv::OpAtomicIDecrement:
+                case spv::OpAtomicISub: original = target.fetch_sub(value); break;
+                case spv::OpAtomicAnd: original = target.fetch_and(value); break;
+                case spv::OpAtomicOr: original = target.fetch_or(value); break;
+                case spv::OpAtomicXor: original = target.fetch_xor(value); break;
+                default: {
+                    original = target.load();
+                    const bool isSigned = inst.op == spv::OpAtomicSMin || inst.op == spv::OpAtomicSMax;
+                    const bool isMin = inst.op == spv::OpAtomicSMin || inst.op == spv::OpAtomicUMin;
+                    for (;;) {
+                        const bool less = isSigned ? S(value) < S(original) : value < original;
+                        const uint32_t desired = (less == isMin) ? value : original;
+                        if (desired == original || target.compare_exchange_weak(original, desired)) {
+                            break;
+                        }
+                    }
+                    break;
+                }
+            }
+        }
+        if (inst.count > 0) {
+            Reg(inst.result)[lane] = original;
+        }
+    }
+}
+
+} // namespace VRHI
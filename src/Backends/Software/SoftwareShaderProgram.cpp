@@ -0,0 +1,1668 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "SoftwareShaderProgram.hpp"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+#define SPV_ENABLE_UTILITY_CODE
+#include <spirv.hpp>
+#include <GLSL.std.450.h>
+
+namespace VRHI {
+
+namespace {
+    spv::ExecutionModel GetExecutionModel(ShaderStage stage) {
+        switch (stage) {
+            case ShaderStage::Fragment: return spv::ExecutionModelFragment;
+            case ShaderStage::Compute: return spv::ExecutionModelGLCompute;
+            default: return spv::ExecutionModelVertex;
+        }
+    }
+
+    std::string ReadString(const uint32_t* words, uint32_t count) {
+        std::string result;
+        for (uint32_t i = 0; i < count; ++i) {
+            for (uint32_t byte = 0; byte < 4; ++byte) {
+                const char c = char((words[i] >> (8 * byte)) & 0xFF);
+                if (c == '\0') {
+                    return result;
+                }
+                result.push_back(c);
+            }
+        }
+        return result;
+    }
+}
+
+/// Turns a SPIR-V module into a SoftwareShaderProgram in two passes: the
+/// first sizes every type and gives every value its registers, the second
+/// decodes function bodies, whose operands may refer forward.
+class SoftwareShaderDecoder {
+public:
+    using Program = SoftwareShaderProgram;
+
+    SoftwareShaderDecoder(Program& program, std::span<const uint32_t> spirv)
+        : m_program(program), m_spirv(spirv) {}
+
+    bool Decode(ShaderStage stage, std::string_view entryPoint);
+    const std::string& GetError() const noexcept { return m_error; }
+
+private:
+    enum class Kind : uint8_t {
+        None, Void, Bool, Int, Float, Vector, Matrix, Array, RuntimeArray, Struct,
+        Pointer, Function, Image, Sampler, SampledImage,
+    };
+
+    struct Type {
+        Kind kind = Kind::None;
+        bool isSigned = false;
+        uint32_t element = 0;       // Component, column, element, pointee or image type
+        uint32_t length = 0;        // Components, columns or array length
+        uint32_t words = 0;         // Registers a value takes
+        uint32_t storage = 0;       // Storage class of pointers
+        SoftwareImageDim dim = SoftwareImageDim::Dim2D;
+        bool arrayed = false;
+        std::vector<uint32_t> members;
+    };
+
+    struct MemberDecorations {
+        uint32_t offset = 0;
+        uint32_t matrixStride = 0;
+        bool rowMajor = false;
+        int32_t builtIn = -1;
+    };
+
+    struct Decorations {
+        int32_t location = -1;
+        int32_t binding = -1;
+        int32_t builtIn = -1;
+        uint32_t arrayStride = 0;
+        bool flat = false;
+        bool noPerspective = false;
+        bool bufferBlock = false;
+        std::vector<MemberDecorations> members;
+    };
+
+    /// How the memory a pointer points at is laid out
+    struct Layout {
+        bool explicitLayout = false;
+        bool rowMajor = false;
+        uint32_t matrixStride = 0;
+        uint32_t componentStride = 4;
+    };
+
+    struct Pointer {
+        bool valid = false;
+        Program::Space space = Program::Space::Invocation;
+        uint32_t binding = 0;
+        uint32_t pointee = 0;
+        Layout layout;
+        int32_t memory = -1;        // Index into m_memory once loaded or stored
+    };
+
+    /// A texture, sampler or both, resolved to bindings
+    struct Handle {
+        bool valid = false;
+        uint32_t image = Program::NoRegister;
+        uint32_t sampler = Program::NoRegister;
+        uint32_t imageType = 0;
+    };
+
+    struct Variable {
+        uint32_t storage = 0;
+        uint32_t offset = 0;
+    };
+
+    bool Fail(std::string message) {
+        if (m_error.empty()) {
+            m_error = std::move(message);
+        }
+        return false;
+    }
+
+    bool FirstPass(ShaderStage stage, std::string_view entryPoint);
+    bool SecondPass();
+    bool DeclareType(spv::Op op, const uint32_t* w, uint32_t count);
+    bool DeclareConstant(spv::Op op, const uint32_t* w, uint32_t count);
+    bool DeclareVariable(const uint32_t* w, uint32_t count, bool inFunction);
+    bool DecodeInstruction(spv::Op op, const uint32_t* w, uint32_t count);
+    bool DecodeImage(spv::Op op, const uint32_t* w, uint32_t count);
+    bool DecodeExtended(const uint32_t* w, uint32_t count);
+    bool CollectInterface();
+
+    uint32_t AllocateRegisters(uint32_t words) {
+        const uint32_t first = m_program.m_registerCount;
+        m_program.m_registerCount += words;
+        return first;
+    }
+
+    uint32_t Words(uint32_t type) const { return type < m_types.size() ? m_types[type].words : 0; }
+    const Type& TypeOf(uint32_t type) const { return m_types[type]; }
+    uint32_t Reg(uint32_t id) const { return id < m_registers.size() ? m_registers[id] : Program::NoRegister; }
+    uint32_t ValueWords(uint32_t id) const { return id < m_valueTypes.size() ? Words(m_valueTypes[id]) : 0; }
+    uint32_t ConstantValue(uint32_t id) const {
+        return id < m_constantWords.size() && !m_constantWords[id].empty() ? m_constantWords[id][0] : 0;
+    }
+    bool IsConstant(uint32_t id) const { return id < m_constantWords.size() && !m_constantWords[id].empty(); }
+    uint32_t ZeroRegister();
+
+    uint32_t PackedMemberOffset(uint32_t structType, uint32_t member) const;
+    uint32_t MemberOffset(uint32_t structType, uint32_t member, const Layout& layout) const;
+    MemberDecorations GetMember(uint32_t structType, uint32_t member) const;
+    uint32_t ArrayStride(uint32_t arrayType, const Layout& layout) const;
+    void Flatten(uint32_t type, const Layout& layout, uint32_t base, std::vector<uint32_t>& offsets) const;
+    int32_t GetMemoryAccess(uint32_t pointerId);
+    bool Emit(Program::Instruction inst);
+    bool EmitComponentWise(uint16_t op, uint32_t resultType, uint32_t result,
+                           const uint32_t* operands, uint32_t operandCount, uint16_t sub = 0);
+
+    void AddInterface(std::vector<Program::InterfaceVariable>& list, uint32_t type,
+                      uint32_t& location, uint32_t offset, bool flat, bool noPerspective) const;
+
+    Program& m_program;
+    std::span<const uint32_t> m_spirv;
+    std::string m_error;
+
+    uint32_t m_bound = 0;
+    uint32_t m_glslExtension = UINT32_MAX;
+    std::vector<bool> m_ignoredExtensions;
+    uint32_t m_entryFunctionId = 0;
+    uint32_t m_zeroRegister = Program::NoRegister;
+
+    std::vector<Type> m_types;
+    std::vector<Decorations> m_decorations;
+    std::vector<uint32_t> m_registers;
+    std::vector<uint32_t> m_valueTypes;
+    std::vector<std::vector<uint32_t>> m_constantWords;
+    std::vector<Pointer> m_pointers;
+    std::vector<Handle> m_handles;
+    std::vector<Variable> m_variables;
+    std::vector<uint32_t> m_globalVariables;
+    std::unordered_map<uint32_t, uint32_t> m_blockIndices;
+    std::unordered_map<uint32_t, uint32_t> m_functionIndices;
+    std::vector<std::vector<uint32_t>> m_functionParameters;
+
+    // Second pass state
+    uint32_t m_currentFunction = 0;
+    int32_t m_currentBlock = -1;
+};
+
+// ============================================================================
+// Layout
+// ============================================================================
+
+SoftwareShaderDecoder::MemberDecorations
+SoftwareShaderDecoder::GetMember(uint32_t structType, uint32_t member) const {
+    const auto& members = m_decorations[structType].members;
+    return member < members.size() ? members[member] : MemberDecorations{};
+}
+
+uint32_t SoftwareShaderDecoder::PackedMemberOffset(uint32_t structType, uint32_t member) const {
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < member; ++i) {
+        offset += Words(m_types[structType].members[i]) * 4;
+    }
+    return offset;
+}
+
+uint32_t SoftwareShaderDecoder::MemberOffset(uint32_t structType, uint32_t member, const Layout& layout) const {
+    return layout.explicitLayout ? GetMember(structType, member).offset : PackedMemberOffset(structType, member);
+}
+
+uint32_t SoftwareShaderDecoder::ArrayStride(uint32_t arrayType, const Layout& layout) const {
+    return layout.explicitLayout ? m_decorations[arrayType].arrayStride : Words(m_types[arrayType].element) * 4;
+}
+
+void SoftwareShaderDecoder::Flatten(uint32_t type, const Layout& layout, uint32_t base,
+                                    std::vector<uint32_t>& offsets) const {
+    const Type& t = m_types[type];
+    switch (t.kind) {
+        case Kind::Vector:
+            for (uint32_t i = 0; i < t.length; ++i) {
+                offsets.push_back(base + i * layout.componentStride);
+            }
+            break;
+        case Kind::Matrix: {
+            const uint32_t rows = m_types[t.element].length;
+            Layout column = layout;
+            uint32_t columnStride = rows * 4;
+            column.componentStride = 4;
+            if (layout.explicitLayout) {
+                columnStride = layout.rowMajor ? 4 : layout.matrixStride;
+                column.componentStride = layout.rowMajor ? layout.matrixStride : 4;
+            }
+            for (uint32_t i = 0; i < t.length; ++i) {
+                Flatten(t.element, column, base + i * columnStride, offsets);
+            }
+            break;
+        }
+        case Kind::Array: {
+            const uint32_t stride = ArrayStride(type, layout);
+            for (uint32_t i = 0; i < t.length; ++i) {
+                Flatten(t.element, layout, base + i * stride, offsets);
+            }
+            break;
+        }
+        case Kind::Struct:
+            for (uint32_t i = 0; i < t.members.size(); ++i) {
+                const MemberDecorations member = GetMember(type, i);
+                Layout inner = layout;
+                inner.rowMajor = member.rowMajor;
+                inner.matrixStride = member.matrixStride;
+                inner.componentStride = 4;
+                Flatten(t.members[i], inner, base + MemberOffset(type, i, layout), offsets);
+            }
+            break;
+        default:
+            offsets.push_back(base);
+            break;
+    }
+}
+
+int32_t SoftwareShaderDecoder::GetMemoryAccess(uint32_t pointerId) {
+    if (pointerId >= m_pointers.size() || !m_pointers[pointerId].valid) {
+        Fail("Memory access through a pointer the software backend cannot resolve");
+        return -1;
+    }
+    Pointer& pointer = m_pointers[pointerId];
+    if (pointer.memory < 0) {
+        Program::MemoryAccess access;
+        access.space = pointer.space;
+        access.binding = pointer.binding;
+        access.firstOffset = uint32_t(m_program.m_offsets.size());
+        Flatten(pointer.pointee, pointer.layout, 0, m_program.m_offsets);
+        access.words = uint32_t(m_program.m_offsets.size()) - access.firstOffset;
+        pointer.memory = int32_t(m_program.m_memory.size());
+        m_program.m_memory.push_back(access);
+    }
+    return pointer.memory;
+}
+
+uint32_t SoftwareShaderDecoder::ZeroRegister() {
+    if (m_zeroRegister == Program::NoRegister) {
+        m_zeroRegister = AllocateRegisters(1);
+        m_program.m_constants.push_back({m_zeroRegister, 0});
+    }
+    return m_zeroRegister;
+}
+
+// ============================================================================
+// First Pass
+// ============================================================================
+
+bool SoftwareShaderDecoder::Decode(ShaderStage stage, std::string_view entryPoint) {
+    if (m_spirv.size() < 5 || m_spirv[0] != spv::MagicNumber) {
+        return Fail("Not a SPIR-V module");
+    }
+    m_bound = m_spirv[3];
+    m_types.resize(m_bound);
+    m_decorations.resize(m_bound);
+    m_registers.assign(m_bound, Program::NoRegister);
+    m_valueTypes.assign(m_bound, 0);
+    m_constantWords.resize(m_bound);
+    m_pointers.resize(m_bound);
+    m_handles.resize(m_bound);
+    m_variables.resize(m_bound);
+    m_ignoredExtensions.assign(m_bound, false);
+
+    return FirstPass(stage, entryPoint) && CollectInterface() && SecondPass();
+}
+
+bool SoftwareShaderDecoder::FirstPass(ShaderStage stage, std::string_view entryPoint) {
+    const spv::ExecutionModel model = GetExecutionModel(stage);
+    bool foundEntry = false;
+    bool inFunction = false;
+    bool expectEntryBlock = false;
+
+    for (size_t i = 5; i < m_spirv.size();) {
+        const uint32_t* w = m_spirv.data() + i;
+        const uint32_t count = w[0] >> 16;
+        const auto op = spv::Op(w[0] & 0xFFFF);
+        if (count == 0 || i + count > m_spirv.size()) {
+            return Fail("Malformed SPIR-V instruction stream");
+        }
+        i += count;
+
+        switch (op) {
+            case spv::OpExtInstImport: {
+                const std::string name = ReadString(w + 2, count - 2);
+                if (name == "GLSL.std.450") {
+                    m_glslExtension = w[1];
+                } else if (name.starts_with("NonSemantic.")) {
+                    m_ignoredExtensions[w[1]] = true;
+                } else {
+                    return Fail("Unsupported SPIR-V extended instruction set " + name);
+                }
+                continue;
+            }
+            case spv::OpEntryPoint: {
+                const std::string name = ReadString(w + 3, count - 3);
+                if (spv::ExecutionModel(w[1]) == model && name == entryPoint && !foundEntry) {
+                    m_entryFunctionId = w[2];
+                    foundEntry = true;
+                }
+                continue;
+            }
+            case spv::OpExecutionMode:
+                if (w[1] != m_entryFunctionId) {
+                    continue;
+                }
+                switch (spv::ExecutionMode(w[2])) {
+                    case spv::ExecutionModeLocalSize:
+                        m_program.m_workgroupSize[0] = w[3];
+                        m_program.m_workgroupSize[1] = w[4];
+                        m_program.m_workgroupSize[2] = w[5];
+                        break;
+                    case spv::ExecutionModeEarlyFragmentTests:
+                        m_program.m_earlyFragmentTests = true;
+                        break;
+                    case spv::ExecutionModeOriginLowerLeft:
+                        return Fail("Fragment shaders with a lower-left origin are not supported");
+                    default:
+                        break;
+                }
+                continue;
+            case spv::OpDecorate: {
+                Decorations& d = m_decorations[w[1]];
+                switch (spv::Decoration(w[2])) {
+                    case spv::DecorationLocation: d.location = int32_t(w[3]); break;
+                    case spv::DecorationBinding: d.binding = int32_t(w[3]); break;
+                    case spv::DecorationBuiltIn: d.builtIn = int32_t(w[3]); break;
+                    case spv::DecorationArrayStride: d.arrayStride = w[3]; break;
+                    case spv::DecorationFlat: d.flat = true; break;
+                    case spv::DecorationNoPerspective: d.noPerspective = true; break;
+                    case spv::DecorationBufferBlock: d.bufferBlock = true; break;
+                    default: break;
+                }
+                continue;
+            }
+            case spv::OpMemberDecorate: {
+                Decorations& d = m_decorations[w[1]];
+                if (d.members.size() <= w[2]) {
+                    d.members.resize(w[2] + 1);
+                }
+                MemberDecorations& member = d.members[w[2]];
+                switch (spv::Decoration(w[3])) {
+                    case spv::DecorationOffset: member.offset = w[4]; break;
+                    case spv::DecorationMatrixStride: member.matrixStride = w[4]; break;
+                    case spv::DecorationRowMajor: member.rowMajor = true; break;
+                    case spv::DecorationColMajor: member.rowMajor = false; break;
+                    case spv::DecorationBuiltIn: member.builtIn = int32_t(w[4]); break;
+                    default: break;
+                }
+                continue;
+            }
+            case spv::OpDecorationGroup:
+            case spv::OpGroupDecorate:
+            case spv::OpGroupMemberDecorate:
+                return Fail("SPIR-V decoration groups are not supported");
+            case spv::OpFunction:
+                inFunction = true;
+                m_functionIndices[w[2]] = uint32_t(m_program.m_functions.size());
+                m_program.m_functions.push_back({});
+                m_program.m_functions.back().resultWords = Words(w[1]);
+                m_program.m_functions.back().resultRegister = AllocateRegisters(Words(w[1]));
+                m_functionParameters.emplace_back();
+                expectEntryBlock = true;
+                continue;
+            case spv::OpFunctionEnd:
+                inFunction = false;
+                continue;
+            case spv::OpFunctionParameter:
+                m_functionParameters.back().push_back(w[2]);
+                break;
+            case spv::OpLabel:
+                // The first block of a function is its entry
+                if (expectEntryBlock) {
+                    m_program.m_functions.back().entryBlock = uint32_t(m_program.m_blocks.size());
+                    expectEntryBlock = false;
+                }
+                m_blockIndices[w[1]] = uint32_t(m_program.m_blocks.size());
+                m_program.m_blocks.push_back({});
+                continue;
+            case spv::OpVariable:
+                if (!DeclareVariable(w, count, inFunction)) {
+                    return false;
+                }
+                continue;
+            case spv::OpExtInst:
+                if (m_ignoredExtensions[w[3]]) {
+                    continue;
+                }
+                break;
+            default:
+                break;
+        }
+
+        if (op >= spv::OpTypeVoid && op <= spv::OpTypeForwardPointer) {
+            if (!DeclareType(op, w, count)) {
+                return false;
+            }
+            continue;
+        }
+        if ((op >= spv::OpConstantTrue && op <= spv::OpSpecConstantOp) || op == spv::OpUndef) {
+            if (!DeclareConstant(op, w, count)) {
+                return false;
+            }
+            continue;
+        }
+
+        bool hasResult = false;
+        bool hasResultType = false;
+        spv::HasResultAndType(op, &hasResult, &hasResultType);
+        if (hasResult && hasResultType && w[2] < m_bound) {
+            m_valueTypes[w[2]] = w[1];
+            if (Words(w[1]) > 0) {
+                m_registers[w[2]] = AllocateRegisters(Words(w[1]));
+            }
+        }
+    }
+
+    if (!foundEntry) {
+        return Fail("SPIR-V module has no entry point '" + std::string(entryPoint) + "' for this stage");
+    }
+    m_program.m_entryFunction = m_functionIndices[m_entryFunctionId];
+    return true;
+}
+
+bool SoftwareShaderDecoder::DeclareType(spv::Op op, const uint32_t* w, uint32_t count) {
+    Type& t = m_types[w[1]];
+    switch (op) {
+        case spv::OpTypeVoid:
+            t.kind = Kind::Void;
+            break;
+        case spv::OpTypeBool:
+            t.kind = Kind::Bool;
+            t.words = 1;
+            break;
+        case spv::OpTypeInt:
+            if (w[2] != 32) {
+                return Fail("Only 32-bit integers are supported by the software backend");
+            }
+            t.kind = Kind::Int;
+            t.isSigned = w[3] != 0;
+            t.words = 1;
+            break;
+        case spv::OpTypeFloat:
+            if (w[2] != 32) {
+                return Fail("Only 32-bit floats are supported by the software backend");
+            }
+            t.kind = Kind::Float;
+            t.words = 1;
+            break;
+        case spv::OpTypeVector:
+        case spv::OpTypeMatrix:
+            t.kind = op == spv::OpTypeVector ? Kind::Vector : Kind::Matrix;
+            t.element = w[2];
+            t.length = w[3];
+            t.words = Words(w[2]) * w[3];
+            break;
+        case spv::OpTypeArray:
+            t.kind = Kind::Array;
+            t.element = w[2];
+            t.length = ConstantValue(w[3]);
+            t.words = Words(w[2]) * t.length;
+            break;
+        case spv::OpTypeRuntimeArray:
+            t.kind = Kind::RuntimeArray;
+            t.element = w[2];
+            break;
+        case spv::OpTypeStruct:
+            t.kind = Kind::Struct;
+            t.members.assign(w + 2, w + count);
+            for (uint32_t member : t.members) {
+                t.words += Words(member);
+            }
+            break;
+        case spv::OpTypePointer:
+            t.kind = Kind::Pointer;
+            t.storage = w[2];
+            t.element = w[3];
+            t.words = 1;
+            break;
+        case spv::OpTypeFunction:
+            t.kind = Kind::Function;
+            break;
+        case spv::OpTypeImage:
+            t.kind = Kind::Image;
+            t.arrayed = w[5] != 0;
+            switch (spv::Dim(w[3])) {
+                case spv::Dim1D: t.dim = SoftwareImageDim::Dim1D; break;
+                case spv::Dim2D: t.dim = SoftwareImageDim::Dim2D; break;
+                case spv::Dim3D: t.dim = SoftwareImageDim::Dim3D; break;
+                case spv::DimCube: t.dim = SoftwareImageDim::Cube; break;
+                default:
+                    return Fail("Only 1D, 2D, 3D and cube images are supported by the software backend");
+            }
+            if (w[6] != 0) {
+                return Fail("Multisampled images are not supported by the software backend");
+            }
+            break;
+        case spv::OpTypeSampler:
+            t.kind = Kind::Sampler;
+            break;
+        case spv::OpTypeSampledImage:
+            t.kind = Kind::SampledImage;
+            t.element = w[2];
+            break;
+        default:
+            return Fail("Unsupported SPIR-V type instruction " + std::to_string(op));
+    }
+    return true;
+}
+
+bool SoftwareShaderDecoder::DeclareConstant(spv::Op op, const uint32_t* w, uint32_t count) {
+    const uint32_t type = w[1];
+    const uint32_t id = w[2];
+    std::vector<uint32_t>& value = m_constantWords[id];
+    switch (op) {
+        case spv::OpConstantTrue:
+        case spv::OpSpecConstantTrue:
+            value = {1};
+            break;
+        case spv::OpConstantFalse:
+        case spv::OpSpecConstantFalse:
+            value = {0};
+            break;
+        case spv::OpConstant:
+        case spv::OpSpecConstant:
+            value.assign(w + 3, w + count);
+            break;
+        case spv::OpConstantComposite:
+        case spv::OpSpecConstantComposite:
+            for (uint32_t i = 3; i < count; ++i) {
+                const auto& part = m_constantWords[w[i]];
+                value.insert(value.end(), part.begin(), part.end());
+            }
+            break;
+        case spv::OpConstantNull:
+        case spv::OpUndef:
+            value.assign(Words(type), 0);
+            break;
+        default:
+            return Fail("Unsupported SPIR-V constant instruction " + std::to_string(op));
+    }
+    if (value.size() != Words(type)) {
+        return Fail("SPIR-V constant does not match its type");
+    }
+
+    m_valueTypes[id] = type;
+    if (!value.empty()) {
+        m_registers[id] = AllocateRegisters(uint32_t(value.size()));
+        for (uint32_t i = 0; i < value.size(); ++i) {
+            m_program.m_constants.push_back({m_registers[id] + i, value[i]});
+        }
+    }
+    return true;
+}
+
+bool SoftwareShaderDecoder::DeclareVariable(const uint32_t* w, uint32_t count, bool inFunction) {
+    const uint32_t pointerType = w[1];
+    const uint32_t id = w[2];
+    const auto storage = spv::StorageClass(w[3]);
+    const uint32_t pointee = m_types[pointerType].element;
+    m_valueTypes[id] = pointerType;
+    m_variables[id].storage = storage;
+    if (!inFunction) {
+        m_globalVariables.push_back(id);
+    }
+
+    Pointer& pointer = m_pointers[id];
+    pointer.pointee = pointee;
+    uint32_t address = 0;
+    switch (storage) {
+        case spv::StorageClassFunction:
+        case spv::StorageClassPrivate:
+        case spv::StorageClassInput:
+        case spv::StorageClassOutput:
+            pointer.space = Program::Space::Invocation;
+            address = m_program.m_localSize;
+            m_program.m_localSize += Words(pointee) * 4;
+            break;
+        case spv::StorageClassWorkgroup:
+            pointer.space = Program::Space::Workgroup;
+            address = m_program.m_sharedSize;
+            m_program.m_sharedSize += Words(pointee) * 4;
+            break;
+        case spv::StorageClassUniform:
+        case spv::StorageClassStorageBuffer: {
+            const int32_t binding = m_decorations[id].binding;
+            if (binding < 0 || uint32_t(binding) >= SoftwareBindings::MaxBindings) {
+                return Fail("Buffer bindings must be below " + std::to_string(SoftwareBindings::MaxBindings));
+            }
+            pointer.space = Program::Space::Buffer;
+            pointer.binding = uint32_t(binding);
+            pointer.layout.explicitLayout = true;
+            m_program.m_bufferBindings |= uint64_t(1) << binding;
+            break;
+        }
+        case spv::StorageClassPushConstant:
+            pointer.space = Program::Space::PushConstant;
+            pointer.layout.explicitLayout = true;
+            break;
+        case spv::StorageClassUniformConstant: {
+            const int32_t binding = m_decorations[id].binding;
+            if (m_types[pointee].kind == Kind::Array || m_types[pointee].kind == Kind::RuntimeArray) {
+                return Fail("Arrays of textures are not supported by the software backend");
+            }
+            if (binding < 0 || uint32_t(binding) >= SoftwareBindings::MaxBindings) {
+                return Fail("Texture bindings must be below " + std::to_string(SoftwareBindings::MaxBindings));
+            }
+            m_program.m_imageBindings |= uint64_t(1) << binding;
+            Handle& handle = m_handles[id];
+            handle.valid = true;
+            const Kind kind = m_types[pointee].kind;
+            handle.image = kind == Kind::Sampler ? Program::NoRegister : uint32_t(binding);
+            handle.sampler = kind == Kind::Image ? Program::NoRegister : uint32_t(binding);
+            handle.imageType = kind == Kind::SampledImage ? m_types[pointee].element : pointee;
+            return true;
+        }
+        default:
+            return Fail("Unsupported SPIR-V storage class " + std::to_string(storage));
+    }
+
+    pointer.valid = true;
+    m_variables[id].offset = address;
+    m_registers[id] = AllocateRegisters(1);
+    m_program.m_constants.push_back({m_registers[id], address});
+
+    // Module-scope initializers are applied when the entry point starts;
+    // function-scope ones where the variable is declared
+    if (count > 4 && !inFunction) {
+        if (pointer.space != Program::Space::Invocation) {
+            return Fail("Only invocation variables may have initializers");
+        }
+        m_program.m_initializers.push_back({address, Reg(w[4]), Words(pointee)});
+    }
+    return true;
+}
+
+void SoftwareShaderDecoder::AddInterface(std::vector<Program::InterfaceVariable>& list, uint32_t type,
+                                         uint32_t& location, uint32_t offset, bool flat,
+                                         bool noPerspective) const {
+    const Type& t = m_types[type];
+    switch (t.kind) {
+        case Kind::Matrix:
+        case Kind::Array: {
+            const uint32_t stride = Words(t.element) * 4;
+            for (uint32_t i = 0; i < t.length; ++i) {
+                AddInterface(list, t.element, location, offset + i * stride, flat, noPerspective);
+            }
+            break;
+        }
+        case Kind::Struct:
+            for (uint32_t i = 0; i < t.members.size(); ++i) {
+                AddInterface(list, t.members[i], location, offset + PackedMemberOffset(type, i),
+                             flat, noPerspective);
+            }
+            break;
+        default: {
+            // Integers are never interpolated
+            uint32_t scalar = type;
+            while (m_types[scalar].kind == Kind::Vector) {
+                scalar = m_types[scalar].element;
+            }
+            const bool integer = m_types[scalar].kind != Kind::Float;
+            list.push_back({location++, offset, t.words, flat || integer, noPerspective});
+            break;
+        }
+    }
+}
+
+bool SoftwareShaderDecoder::CollectInterface() {
+    for (uint32_t id : m_globalVariables) {
+        const uint32_t storage = m_variables[id].storage;
+        if (storage != spv::StorageClassInput && storage != spv::StorageClassOutput) {
+            continue;
+        }
+        const bool isInput = storage == spv::StorageClassInput;
+        const Decorations& d = m_decorations[id];
+        const uint32_t type = m_pointers[id].pointee;
+        const uint32_t offset = m_variables[id].offset;
+
+        if (d.builtIn >= 0) {
+            m_program.m_builtins.push_back({uint32_t(d.builtIn), offset});
+            if (!isInput && d.builtIn == spv::BuiltInFragDepth) {
+                m_program.m_writesDepth = true;
+            }
+            continue;
+        }
+
+        // Blocks of built-ins such as gl_PerVertex
+        const Type& t = m_types[type];
+        if (t.kind == Kind::Struct && !m_decorations[type].members.empty() &&
+            m_decorations[type].members[0].builtIn >= 0) {
+            for (uint32_t i = 0; i < t.members.size(); ++i) {
+                const MemberDecorations member = GetMember(type, i);
+                if (member.builtIn >= 0) {
+                    m_program.m_builtins.push_back({uint32_t(member.builtIn), offset + PackedMemberOffset(type, i)});
+                }
+            }
+            continue;
+        }
+
+        if (d.location < 0) {
+            return Fail("Shader inputs and outputs need a location");
+        }
+        uint32_t location = uint32_t(d.location);
+        AddInterface(isInput ? m_program.m_inputs : m_program.m_outputs, type, location, offset,
+                     d.flat, d.noPerspective);
+    }
+
+    const auto byLocation = [](const Program::InterfaceVariable& a, const Program::InterfaceVariable& b) {
+        return a.location < b.location;
+    };
+    std::sort(m_program.m_inputs.begin(), m_program.m_inputs.end(), byLocation);
+    std::sort(m_program.m_outputs.begin(), m_program.m_outputs.end(), byLocation);
+    return true;
+}
+
+// ============================================================================
+// Second Pass
+// ============================================================================
+
+bool SoftwareShaderDecoder::Emit(Program::Instruction inst) {
+    if (m_currentBlock < 0) {
+        return Fail("SPIR-V instruction outside of a block");
+    }
+    m_program.m_instructions.push_back(inst);
+    m_program.m_blocks[m_currentBlock].count++;
+    return true;
+}
+
+bool SoftwareShaderDecoder::EmitComponentWise(uint16_t op, uint32_t resultType, uint32_t result,
+                                              const uint32_t* operands, uint32_t operandCount,
+                                              uint16_t sub) {
+    Program::Instruction inst;
+    inst.op = op;
+    inst.sub = sub;
+    inst.count = Words(resultType);
+    inst.result = Reg(result);
+    uint32_t* targets[3] = {&inst.a, &inst.b, &inst.c};
+    for (uint32_t i = 0; i < operandCount && i < 3; ++i) {
+        *targets[i] = Reg(operands[i]);
+        if (*targets[i] == Program::NoRegister) {
+            return Fail("SPIR-V operand has no value");
+        }
+        if (ValueWords(operands[i]) < inst.count) {
+            inst.flags |= Program::ScalarA << i;
+        }
+    }
+    return Emit(inst);
+}
+
+bool SoftwareShaderDecoder::SecondPass() {
+    bool inFunction = false;
+    for (size_t i = 5; i < m_spirv.size();) {
+        const uint32_t* w = m_spirv.data() + i;
+        const uint32_t count = w[0] >> 16;
+        const auto op = spv::Op(w[0] & 0xFFFF);
+        i += count;
+
+        switch (op) {
+            case spv::OpFunction:
+                inFunction = true;
+                m_currentFunction = m_functionIndices[w[2]];
+                m_currentBlock = -1;
+                continue;
+            case spv::OpFunctionEnd:
+                inFunction = false;
+                continue;
+            case spv::OpFunctionParameter: {
+                const Type& t = m_types[w[1]];
+                if (t.kind == Kind::Pointer) {
+                    if (t.storage != spv::StorageClassFunction && t.storage != spv::StorageClassPrivate) {
+                        return Fail("Only function and private pointers can be passed to functions");
+                    }
+                    Pointer& pointer = m_pointers[w[2]];
+                    pointer.valid = true;
+                    pointer.space = Program::Space::Invocation;
+                    pointer.pointee = t.element;
+                } else if (t.words == 0) {
+                    return Fail("Textures cannot be passed to functions in the software backend");
+                }
+                continue;
+            }
+            case spv::OpLabel: {
+                m_currentBlock = int32_t(m_blockIndices[w[1]]);
+                Program::Block& block = m_program.m_blocks[m_currentBlock];
+                block.first = uint32_t(m_program.m_instructions.size());
+                block.count = 0;
+                continue;
+            }
+            default:
+                break;
+        }
+        if (!inFunction) {
+            continue;
+        }
+        if (!DecodeInstruction(op, w, count)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SoftwareShaderDecoder::DecodeInstruction(spv::Op op, const uint32_t* w, uint32_t count) {
+    using Inst = Program::Instruction;
+
+    switch (op) {
+        // Ignored
+        case spv::OpNop:
+        case spv::OpLine:
+        case spv::OpNoLine:
+        case spv::OpSelectionMerge:
+        case spv::OpLoopMerge:
+        case spv::OpMemoryBarrier:
+        // Every invocation of a workgroup runs in one batch, each instruction
+        // over all of them before the next, so barriers hold by construction
+        case spv::OpControlBarrier:
+            return true;
+
+        case spv::OpVariable: {
+            if (count > 4) {
+                Inst inst;
+                inst.op = spv::OpStore;
+                inst.a = Reg(w[2]);
+                inst.b = Reg(w[4]);
+                inst.count = ValueWords(w[4]);
+                const int32_t memory = GetMemoryAccess(w[2]);
+                if (memory < 0) {
+                    return false;
+                }
+                inst.extra = uint32_t(memory);
+                return Emit(inst);
+            }
+            return true;
+        }
+
+        // Memory
+        case spv::OpLoad: {
+            const uint32_t pointer = w[3];
+            if (m_handles[pointer].valid) {
+                m_handles[w[2]] = m_handles[pointer];
+                return true;
+            }
+            const int32_t memory = GetMemoryAccess(pointer);
+            if (memory < 0) {
+                return false;
+            }
+            Inst inst;
+            inst.op = spv::OpLoad;
+            inst.result = Reg(w[2]);
+            inst.a = Reg(pointer);
+            inst.count = Words(w[1]);
+            inst.extra = uint32_t(memory);
+            return Emit(inst);
+        }
+        case spv::OpStore: {
+            const int32_t memory = GetMemoryAccess(w[1]);
+            if (memory < 0) {
+                return false;
+            }
+            const Program::Space space = m_pointers[w[1]].space;
+            if (space == Program::Space::Buffer) {
+                m_program.m_hasSideEffects = true;
+            }
+            if (space == Program::Space::PushConstant) {
+                return Fail("Push constants are read-only");
+            }
+            Inst inst;
+            inst.op = spv::OpStore;
+            inst.a = Reg(w[1]);
+            inst.b = Reg(w[2]);
+            inst.count = ValueWords(w[2]);
+            inst.extra = uint32_t(memory);
+            return Emit(inst);
+        }
+        case spv::OpCopyMemory: {
+            const int32_t target = GetMemoryAccess(w[1]);
+            const int32_t source = GetMemoryAccess(w[2]);
+            if (target < 0 || source < 0) {
+                return false;
+            }
+            const uint32_t words = m_program.m_memory[uint32_t(source)].words;
+            const uint32_t temporary = AllocateRegisters(words);
+            Inst load;
+            load.op = spv::OpLoad;
+            load.result = temporary;
+            load.a = Reg(w[2]);
+            load.count = words;
+            load.extra = uint32_t(source);
+            Inst store;
+            store.op = spv::OpStore;
+            store.a = Reg(w[1]);
+            store.b = temporary;
+            store.count = words;
+            store.extra = uint32_t(target);
+            if (m_pointers[w[1]].space == Program::Space::Buffer) {
+                m_program.m_hasSideEffects = true;
+            }
+            return Emit(load) && Emit(store);
+        }
+        case spv::OpAccessChain:
+        case spv::OpInBoundsAccessChain: {
+            const uint32_t base = w[3];
+            if (m_handles[base].valid) {
+                return Fail("Arrays of textures are not supported by the software backend");
+            }
+            if (!m_pointers[base].valid) {
+                return Fail("Access chain on a pointer the software backend cannot resolve");
+            }
+            Pointer pointer = m_pointers[base];
+            pointer.memory = -1;
+            Program::AccessChain chain;
+            chain.firstIndex = uint32_t(m_program.m_indices.size());
+
+            uint32_t type = pointer.pointee;
+            for (uint32_t k = 4; k < count; ++k) {
+                const uint32_t index = w[k];
+                const Type& t = m_types[type];
+                uint32_t stride = 0;
+                switch (t.kind) {
+                    case Kind::Struct: {
+                        const uint32_t member = ConstantValue(index);
+                        chain.constantOffset += MemberOffset(type, member, pointer.layout);
+                        const MemberDecorations decorations = GetMember(type, member);
+                        pointer.layout.rowMajor = decorations.rowMajor;
+                        pointer.layout.matrixStride = decorations.matrixStride;
+                        pointer.layout.componentStride = 4;
+                        type = t.members[member];
+                        continue;
+                    }
+                    case Kind::Array:
+                    case Kind::RuntimeArray:
+                        stride = ArrayStride(type, pointer.layout);
+                        break;
+                    case Kind::Matrix:
+                        stride = pointer.layout.explicitLayout
+                            ? (pointer.layout.rowMajor ? 4 : pointer.layout.matrixStride)
+                            : Words(t.element) * 4;
+                        pointer.layout.componentStride =
+                            pointer.layout.explicitLayout && pointer.layout.rowMajor ? pointer.layout.matrixStride : 4;
+                        break;
+                    case Kind::Vector:
+                        stride = pointer.layout.componentStride;
+                        break;
+                    default:
+                        return Fail("Access chain indexes into a scalar");
+                }
+                if (IsConstant(index)) {
+                    chain.constantOffset += ConstantValue(index) * stride;
+                } else {
+                    m_program.m_indices.push_back({Reg(index), stride});
+                }
+                type = t.element;
+            }
+            chain.indexCount = uint32_t(m_program.m_indices.size()) - chain.firstIndex;
+            pointer.pointee = type;
+            m_pointers[w[2]] = pointer;
+
+            Inst inst;
+            inst.op = spv::OpAccessChain;
+            inst.result = Reg(w[2]);
+            inst.a = Reg(base);
+            inst.count = 1;
+            inst.extra = uint32_t(m_program.m_chains.size());
+            m_program.m_chains.push_back(chain);
+            return Emit(inst);
+        }
+        case spv::OpArrayLength: {
+            const uint32_t structType = m_pointers[w[3]].pointee;
+            const int32_t memory = GetMemoryAccess(w[3]);
+            if (memory < 0 || m_pointers[w[3]].space != Program::Space::Buffer) {
+                return Fail("OpArrayLength needs a buffer");
+            }
+            const uint32_t member = w[4];
+            const uint32_t arrayType = m_types[structType].members[member];
+            Inst inst;
+            inst.op = spv::OpArrayLength;
+            inst.result = Reg(w[2]);
+            inst.count = 1;
+            inst.b = GetMember(structType, member).offset;
+            inst.c = std::max(m_decorations[arrayType].arrayStride, 1u);
+            inst.extra = uint32_t(memory);
+            return Emit(inst);
+        }
+
+        // Composites
+        case spv::OpCopyObject:
+        case spv::OpCopyLogical:
+        case spv::OpBitcast:
+        case spv::OpUConvert:
+        case spv::OpSConvert:
+        case spv::OpFConvert: {
+            if (m_handles[w[3]].valid) {
+                m_handles[w[2]] = m_handles[w[3]];
+                return true;
+            }
+            if (m_pointers[w[3]].valid) {
+                m_pointers[w[2]] = m_pointers[w[3]];
+                m_pointers[w[2]].memory = -1;
+            }
+            if (ValueWords(w[3]) != Words(w[1])) {
+                return Fail("Conversions between types of different sizes are not supported");
+            }
+            Inst inst;
+            inst.op = Program::OpMove;
+            inst.result = Reg(w[2]);
+            inst.a = Reg(w[3]);
+            inst.count = Words(w[1]);
+            return Emit(inst);
+        }
+        case spv::OpCompositeConstruct:
+        case spv::OpVectorShuffle: {
+            Inst inst;
+            inst.op = Program::OpGather;
+            inst.result = Reg(w[2]);
+            inst.count = Words(w[1]);
+            inst.extra = uint32_t(m_program.m_gathers.size());
+            if (op == spv::OpCompositeConstruct) {
+                for (uint32_t k = 3; k < count; ++k) {
+                    for (uint32_t word = 0; word < ValueWords(w[k]); ++word) {
+                        m_program.m_gathers.push_back(Reg(w[k]) + word);
+                    }
+                }
+            } else {
+                const uint32_t firstWords = ValueWords(w[3]);
+                for (uint32_t k = 5; k < count; ++k) {
+                    const uint32_t component = w[k];
+                    if (component == 0xFFFFFFFF) {
+                        m_program.m_gathers.push_back(ZeroRegister());
+                    } else if (component < firstWords) {
+                        m_program.m_gathers.push_back(Reg(w[3]) + component);
+                    } else {
+                        m_program.m_gathers.push_back(Reg(w[4]) + component - firstWords);
+                    }
+                }
+            }
+            if (m_program.m_gathers.size() - inst.extra != inst.count) {
+                return Fail("Composite construction does not match its type");
+            }
+            return Emit(inst);
+        }
+        case spv::OpCompositeExtract:
+        case spv::OpCompositeInsert: {
+            const bool insert = op == spv::OpCompositeInsert;
+            const uint32_t composite = insert ? w[4] : w[3];
+            uint32_t type = m_valueTypes[composite];
+            uint32_t offset = 0;
+            for (uint32_t k = insert ? 5 : 4; k < count; ++k) {
+                const Type& t = m_types[type];
+                const uint32_t index = w[k];
+                if (t.kind == Kind::Struct) {
+                    offset += PackedMemberOffset(type, index) / 4;
+                    type = t.members[index];
+                } else {
+                    offset += index * Words(t.element);
+                    type = t.element;
+                }
+            }
+            Inst inst;
+            inst.op = Program::OpMove;
+            inst.result = Reg(w[2]);
+            if (!insert) {
+                inst.a = Reg(composite) + offset;
+                inst.count = Words(w[1]);
+                return Emit(inst);
+            }
+            inst.a = Reg(composite);
+            inst.count = Words(w[1]);
+            Inst part;
+            part.op = Program::OpMove;
+            part.result = Reg(w[2]) + offset;
+            part.a = Reg(w[3]);
+            part.count = ValueWords(w[3]);
+            return Emit(inst) && Emit(part);
+        }
+        case spv::OpVectorExtractDynamic: {
+            Inst inst;
+            inst.op = op;
+            inst.result = Reg(w[2]);
+            inst.a = Reg(w[3]);
+            inst.b = Reg(w[4]);
+            inst.count = 1;
+            inst.sub = uint16_t(ValueWords(w[3]));
+            return Emit(inst);
+        }
+        case spv::OpVectorInsertDynamic: {
+            Inst inst;
+            inst.op = op;
+            inst.result = Reg(w[2]);
+            inst.a = Reg(w[3]);
+            inst.b = Reg(w[4]);
+            inst.c = Reg(w[5]);
+            inst.count = Words(w[1]);
+            return Emit(inst);
+        }
+
+        // Component-wise arithmetic, logic and conversions
+        case spv::OpSNegate:
+        case spv::OpFNegate:
+        case spv::OpNot:
+        case spv::OpLogicalNot:
+        case spv::OpConvertFToU:
+        case spv::OpConvertFToS:
+        case spv::OpConvertSToF:
+        case spv::OpConvertUToF:
+        case spv::OpQuantizeToF16:
+        case spv::OpIsNan:
+        case spv::OpIsInf:
+        case spv::OpBitReverse:
+        case spv::OpBitCount:
+            return EmitComponentWise(op, w[1], w[2], w + 3, 1);
+        case spv::OpDPdx:
+        case spv::OpDPdy:
+        case spv::OpFwidth:
+        case spv::OpDPdxFine:
+        case spv::OpDPdyFine:
+        case spv::OpFwidthFine:
+        case spv::OpDPdxCoarse:
+        case spv::OpDPdyCoarse:
+        case spv::OpFwidthCoarse:
+            return EmitComponentWise(op, w[1], w[2], w + 3, 1);
+        case spv::OpIAdd:
+        case spv::OpFAdd:
+        case spv::OpISub:
+        case spv::OpFSub:
+        case spv::OpIMul:
+        case spv::OpFMul:
+        case spv::OpUDiv:
+        case spv::OpSDiv:
+        case spv::OpFDiv:
+        case spv::OpUMod:
+        case spv::OpSRem:
+        case spv::OpSMod:
+        case spv::OpFRem:
+        case spv::OpFMod:
+        case spv::OpVectorTimesScalar:
+        case spv::OpMatrixTimesScalar:
+        case spv::OpShiftRightLogical:
+        case spv::OpShiftRightArithmetic:
+        case spv::OpShiftLeftLogical:
+        case spv::OpBitwiseOr:
+        case spv::OpBitwiseXor:
+        case spv::OpBitwiseAnd:
+        case spv::OpLogicalEqual:
+        case spv::OpLogicalNotEqual:
+        case spv::OpLogicalOr:
+        case spv::OpLogicalAnd:
+        case spv::OpIEqual:
+        case spv::OpINotEqual:
+        case spv::OpUGreaterThan:
+        case spv::OpSGreaterThan:
+        case spv::OpUGreaterThanEqual:
+        case spv::OpSGreaterThanEqual:
+        case spv::OpULessThan:
+        case spv::OpSLessThan:
+        case spv::OpULessThanEqual:
+        case spv::OpSLessThanEqual:
+        case spv::OpFOrdEqual:
+        case spv::OpFUnordEqual:
+        case spv::OpFOrdNotEqual:
+        case spv::OpFUnordNotEqual:
+        case spv::OpFOrdLessThan:
+        case spv::OpFUnordLessThan:
+        case spv::OpFOrdGreaterThan:
+        case spv::OpFUnordGreaterThan:
+        case spv::OpFOrdLessThanEqual:
+        case spv::OpFUnordLessThanEqual:
+        case spv::OpFOrdGreaterThanEqual:
+        case spv::OpFUnordGreaterThanEqual: {
+            // Matrices multiply by scalars as one long vector
+            const uint16_t shared = op == spv::OpVectorTimesScalar || op == spv::OpMatrixTimesScalar
+                ? uint16_t(spv::OpFMul) : uint16_t(op);
+            return EmitComponentWise(shared, w[1], w[2], w + 3, 2);
+        }
+        case spv::OpSelect:
+        case spv::OpBitFieldInsert:
+        case spv::OpBitFieldSExtract:
+        case spv::OpBitFieldUExtract: {
+            if (op == spv::OpSelect && m_handles[w[4]].valid) {
+                return Fail("Selecting between textures is not supported by the software backend");
+            }
+            if (op == spv::OpBitFieldInsert) {
+                // Base, insert, offset, count: offset and count are scalars
+                Inst inst;
+                inst.op = op;
+                inst.count = Words(w[1]);
+                inst.result = Reg(w[2]);
+                inst.a = Reg(w[3]);
+                inst.b = Reg(w[4]);
+                inst.c = Reg(w[5]);
+                inst.extra = Reg(w[6]);
+                return Emit(inst);
+            }
+            if (op != spv::OpSelect) {
+                Inst inst;
+                inst.op = op;
+                inst.count = Words(w[1]);
+                inst.result = Reg(w[2]);
+                inst.a = Reg(w[3]);
+                inst.b = Reg(w[4]);
+                inst.c = Reg(w[5]);
+                return Emit(inst);
+            }
+            return EmitComponentWise(op, w[1], w[2], w + 3, 3);
+        }
+        case spv::OpAny:
+        case spv::OpAll:
+        case spv::OpDot: {
+            Inst inst;
+            inst.op = op;
+            inst.count = 1;
+            inst.result = Reg(w[2]);
+            inst.a = Reg(w[3]);
+            inst.b = op == spv::OpDot ? Reg(w[4]) : 0;
+            inst.sub = uint16_t(ValueWords(w[3]));
+            return Emit(inst);
+        }
+        case spv::OpMatrixTimesVector:
+        case spv::OpVectorTimesMatrix:
+        case spv::OpMatrixTimesMatrix:
+        case spv::OpOuterProduct:
+        case spv::OpTranspose: {
+            // sub: rows of the result; extra: length of the sums
+            Inst inst;
+            inst.op = op;
+            inst.count = Words(w[1]);
+            inst.result = Reg(w[2]);
+            inst.a = Reg(w[3]);
+            inst.b = op == spv::OpTranspose ? 0 : Reg(w[4]);
+            const Type& left = m_types[m_valueTypes[w[3]]];
+            switch (op) {
+                case spv::OpMatrixTimesVector:
+                    inst.sub = uint16_t(Words(w[1]));
+                    inst.extra = left.length;
+                    break;
+                case spv::OpVectorTimesMatrix:
+                    inst.sub = 1;
+                    inst.extra = left.words;
+                    break;
+                case spv::OpMatrixTimesMatrix:
+                    inst.sub = uint16_t(Words(left.element));
+                    inst.extra = left.length;
+                    break;
+                case spv::OpOuterProduct:
+                    inst.sub = uint16_t(left.words);
+                    inst.extra = 1;
+                    break;
+                default:
+                    inst.sub = uint16_t(Words(m_types[w[1]].element));
+                    inst.extra = left.length;
+                    break;
+            }
+            return Emit(inst);
+        }
+        case spv::OpPhi: {
+            const auto& block = m_program.m_blocks[m_currentBlock];
+            const bool extend = block.count > 0 && m_program.m_instructions.back().op == Program::OpPhiGroup;
+            if (!extend) {
+                Inst inst;
+                inst.op = Program::OpPhiGroup;
+                inst.extra = uint32_t(m_program.m_phiGroups.size());
+                m_program.m_phiGroups.push_back({uint32_t(m_program.m_phis.size()), 0, 0});
+                if (!Emit(inst)) {
+                    return false;
+                }
+            }
+            if (m_pointers[w[3]].valid || m_handles[w[3]].valid) {
+                return Fail("Phis of pointers or textures are not supported by the software backend");
+            }
+            Program::PhiGroup& group = m_program.m_phiGroups.back();
+            Program::Phi phi;
+            phi.result = Reg(w[2]);
+            phi.words = Words(w[1]);
+            phi.firstIncoming = uint32_t(m_program.m_incoming.size());
+            for (uint32_t k = 3; k + 1 < count; k += 2) {
+                m_program.m_incoming.push_back({m_blockIndices[w[k + 1]], Reg(w[k])});
+            }
+            phi.incomingCount = uint32_t(m_program.m_incoming.size()) - phi.firstIncoming;
+            m_program.m_phis.push_back(phi);
+            group.count++;
+            group.scratchWords += phi.words;
+            return true;
+        }
+        case spv::OpFunctionCall: {
+            const uint32_t function = m_functionIndices[w[3]];
+            const auto& parameters = m_functionParameters[function];
+            if (parameters.size() != count - 4) {
+                return Fail("Function call does not match the function's parameters");
+            }
+            Program::CallInfo call;
+            call.function = function;
+            call.firstArgument = uint32_t(m_program.m_moves.size());
+            for (uint32_t k = 4; k < count; ++k) {
+                const uint32_t parameter = parameters[k - 4];
+                m_program.m_moves.push_back({Reg(parameter), Reg(w[k]), ValueWords(w[k])});
+            }
+            call.argumentCount = count - 4;
+            Inst inst;
+            inst.op = Program::OpCallFunction;
+            inst.result = Reg(w[2]);
+            inst.count = Words(w[1]);
+            inst.extra = uint32_t(m_program.m_calls.size());
+            m_program.m_calls.push_back(call);
+            return Emit(inst);
+        }
+        case spv::OpExtInst:
+            if (m_ignoredExtensions[w[3]]) {
+                return true;
+            }
+            return DecodeExtended(w, count);
+
+        // Control flow
+        case spv::OpBranch: {
+            Inst inst;
+            inst.op = op;
+            inst.a = m_blockIndices[w[1]];
+            return Emit(inst);
+        }
+        case spv::OpBranchConditional: {
+            Inst inst;
+            inst.op = op;
+            inst.a = Reg(w[1]);
+            inst.b = m_blockIndices[w[2]];
+            inst.c = m_blockIndices[w[3]];
+            return Emit(inst);
+        }
+        case spv::OpSwitch: {
+            Program::SwitchTable table;
+            table.defaultBlock = m_blockIndices[w[2]];
+            table.first = uint32_t(m_program.m_cases.size());
+            for (uint32_t k = 3; k + 1 < count; k += 2) {
+                m_program.m_cases.push_back({w[k], m_blockIndices[w[k + 1]]});
+            }
+            table.count = uint32_t(m_program.m_cases.size()) - table.first;
+            Inst inst;
+            inst.op = op;
+            inst.a = Reg(w[1]);
+            inst.extra = uint32_t(m_program.m_switches.size());
+            m_program.m_switches.push_back(table);
+            return Emit(inst);
+        }
+        case spv::OpReturn:
+        case spv::OpUnreachable: {
+            Inst inst;
+            inst.op = spv::OpReturn;
+            return Emit(inst);
+        }
+        case spv::OpReturnValue: {
+            Inst inst;
+            inst.op = op;
+            inst.a = Reg(w[1]);
+            inst.result = m_program.m_functions[m_currentFunction].resultRegister;
+            inst.count = m_program.m_functions[m_currentFunction].resultWords;
+            return Emit(inst);
+        }
+        case spv::OpKill:
+        case spv::OpTerminateInvocation:
+        case spv::OpDemoteToHelperInvocation: {
+            m_program.m_canDiscard = true;
+            Inst inst;
+            inst.op = op == spv::OpDemoteToHelperInvocation ? uint16_t(op) : uint16_t(spv::OpKill);
+            return Emit(inst);
+        }
+        case spv::OpIsHelperInvocationEXT: {
+            Inst inst;
+            inst.op = op;
+            inst.result = Reg(w[2]);
+            inst.count = 1;
+            return Emit(inst);
+        }
+
+        // Atomics
+        case spv::OpAtomicLoad:
+        case spv::OpAtomicStore:
+        case spv::OpAtomicExchange:
+        case spv::OpAtomicCompareExchange:
+        case spv::OpAtomicIIncrement:
+        case spv::OpAtomicIDecrement:
+        case spv::OpAtomicIAdd:
+        case spv::OpAtomicISub:
+        case spv::OpAtomicSMin:
+        case spv::OpAtomicUMin:
+        case spv::OpAtomicSMax:
+        case spv::OpAtomicUMax:
+        case spv::OpAtomicAnd:
+        case spv::OpAtomicOr:
+        case spv::OpAtomicXor: {
+            const bool store = op == spv::OpAtomicStore;
+            const uint32_t pointer = store ? w[1] : w[3];
+            const int32_t memory = GetMemoryAccess(pointer);
+            if (memory < 0) {
+                return false;
+            }
+            const Program::Space space = m_pointers[pointer].space;
+            if (space != Program::Space::Buffer && space != Program::Space::Workgroup) {
+                return Fail("Atomics are only supported on buffers and shared memory");
+            }
+            if (space == Program::Space::Buffer && op != spv::OpAtomicLoad) {
+                m_program.m_hasSideEffects = true;
+            }
+            Inst inst;
+            inst.op = op;
+            inst.a = Reg(pointer);
+            inst.extra = uint32_t(memory);
+            inst.count = store ? 0 : 1;
+            inst.result = store ? 0 : Reg(w[2]);
+            if (store) {
+                inst.b = Reg(w[4]);
+            } else if (op == spv::OpAtomicCompareExchange) {
+                inst.b = Reg(w[7]);
+                inst.c = Reg(w[8]);
+            } else if (op != spv::OpAtomicLoad && op != spv::OpAtomicIIncrement &&
+                       op != spv::OpAtomicIDecrement) {
+                inst.b = Reg(w[6]);
+            }
+            return Emit(inst);
+        }
+
+        // Images
+        case spv::OpSampledImage:
+            m_handles[w[2]].valid = true;
+            m_handles[w[2]].image = m_handles[w[3]].image;
+            m_handles[w[2]].imageType = m_handles[w[3]].imageType;
+            m_handles[w[2]].sampler = m_handles[w[4]].sampler;
+            return true;
+        case spv::OpImage:
+            m_handles[w[2]] = m_handles[w[3]];
+            m_handles[w[2]].sampler = Program::NoRegister;
+            return true;
+        case spv::OpImageSampleImplicitLod:
+        case spv::OpImageSampleExplicitLod:
+        case spv::OpImageSampleDrefImplicitLod:
+        case spv::OpImageSampleDrefExplicitLod:
+        case spv::OpImageSampleProjImplicitLod:
+        case spv::OpImageSampleProjExplicitLod:
+        case spv::OpImageSampleProjDrefImplicitLod:
+        case spv::OpImageSampleProjDrefExplicitLod:
+        case spv::OpImageFetch:
+        case spv::OpImageRead:
+        case spv::OpImageWrite:
+        case spv::OpImageQuerySizeLod:
+        case spv::OpImageQuerySize:
+        case spv::OpImageQueryLevels:
+        case spv::OpImageQueryLod:
+            return DecodeImage(op, w, count);
+
+        default:
+            return Fail("Unsupported SPIR-V instruction " + std::to_string(op));
+    }
+}
+
+bool SoftwareShaderDecoder::DecodeImage(spv::Op op, const uint32_t* w, uint32_t count) {
+    const bool write = op == spv::OpImageWrite;
+    const uint32_t handleId = write ? w[1] : w[3];
+    const Handle& handle = m_handles[handleId];
+    if (!handle.valid || handle.image == Program::NoRegister) {
+        return Fail("Image instruction on a texture the software backend cannot resolve");
+    }
+    const Type& imageType = m_types[handle.imageType];
+
+    Program::ImageAccess access;
+    access.image = handle.image;
+    access.sampler = handle.sampler;
+    access.dim = imageType.dim;
+    access.arrayed = imageType.arrayed;
+
+    Program::Instruction inst;
+    inst.op = op;
+    inst.result = write ? 0 : Reg(w[2]);
+    inst.count = write ? 0 : Words(w[1]);
+
+    uint32_t next = 0;
+    switch (op) {
+        case spv::OpImageQuerySize:
+        case spv::OpImageQueryLevels:
+            next = count;
+            break;
+        case spv::OpImageQuerySizeLod:
+            access.lod = Reg(w[4]);
+            next = count;
+            break;
+        case spv::OpImageWrite:
+            access.coordinate = Reg(w[2]);
+            access.coordinateWords = ValueWords(w[2]);
+            access.texel = Reg(w[3]);
+            inst.count = ValueWords(w[3]);
+            m_program.m_hasSideEffects = true;
+            next = 4;
+            break;
+        case spv::OpImageSampleDrefImplicitLod:
+        case spv::OpImageSampleDrefExplicitLod:
+        case spv::OpImageSampleProjDrefImplicitLod:
+        case spv::OpImageSampleProjDrefExplicitLod:
+            access.reference = Reg(w[5]);
+            [[fallthrough]];
+        default:
+            access.coordinate = Reg(w[4]);
+            access.coordinateWords = ValueWords(w[4]);
+            next = access.reference != Program::NoRegister ? 6 : 5;
+            break;
+    }
+    access.project = op == spv::OpImageSampleProjImplicitLod || op == spv::OpImageSampleProjExplicitLod ||
+                     op == spv::OpImageSampleProjDrefImplicitLod || op == spv::OpImageSampleProjDrefExplicitLod;
+
+    if (next < count) {
+        const uint32_t mask = w[next++];
+        const auto take = [&]() { return next < count ? Reg(w[next++]) : Program::NoRegister; };
+        if (mask & spv::ImageOperandsBiasMask) access.bias = take();
+        if (mask & spv::ImageOperandsLodMask) access.lod = take();
+        if (mask & spv::ImageOperandsGradMask) {
+            access.gradX = take();
+            access.gradY = take();
+        }
+        if (mask & spv::ImageOperandsConstOffsetMask) access.offset = take();
+        if (mask & spv::ImageOperandsOffsetMask) access.offset = take();
+        if (mask & spv::ImageOperandsConstOffsetsMask) {
+            return Fail("Texture gathers are not supported by the software backend");
+        }
+    }
+
+    inst.extra = uint32_t(m_program.m_images.size());
+    m_program.m_images.push_back(access);
+    return Emit(inst);
+}
+
+bool SoftwareShaderDecoder::DecodeExtended(const uint32_t* w, uint32_t count) {
+    if (w[3] != m_glslExtension) {
+        return Fail("Unsupported SPIR-V extended instruction set");
+    }
+    const uint32_t instruction = w[4];
+    const uint32_t* operands = w + 5;
+    const uint32_t operandCount = count - 5;
+
+    switch (instruction) {
+        case GLSLstd450Modf:
+        case GLSLstd450Frexp:
+        case GLSLstd450ModfStruct:
+        case GLSLstd450FrexpStruct:
+        case GLSLstd450InterpolateAtCentroid:
+        case GLSLstd450InterpolateAtSample:
+        case GLSLstd450InterpolateAtOffset:
+            return Fail("Unsupported GLSL.std.450 instruction " + std::to_string(instruction));
+        case GLSLstd450Length:
+        case GLSLstd450Distance:
+        case GLSLstd450Normalize:
+        case GLSLstd450Cross:
+        case GLSLstd450FaceForward:
+        case GLSLstd450Reflect:
+        case GLSLstd450Refract:
+        case GLSLstd450Determinant:
+        case GLSLstd450MatrixInverse:
+        case GLSLstd450PackSnorm4x8:
+        case GLSLstd450PackUnorm4x8:
+        case GLSLstd450PackSnorm2x16:
+        case GLSLstd450PackUnorm2x16:
+        case GLSLstd450PackHalf2x16:
+        case GLSLstd450UnpackSnorm2x16:
+        case GLSLstd450UnpackUnorm2x16:
+        case GLSLstd450UnpackHalf2x16:
+        case GLSLstd450UnpackSnorm4x8:
+        case GLSLstd450UnpackUnorm4x8: {
+            // Whole-vector instructions; extra holds the length of the first operand
+            Program::Instruction inst;
+            inst.op = spv::OpExtInst;
+            inst.sub = uint16_t(instruction);
+            inst.count = Words(w[1]);
+            inst.result = Reg(w[2]);
+            inst.a = Reg(operands[0]);
+            inst.b = operandCount > 1 ? Reg(operands[1]) : 0;
+            inst.c = operandCount > 2 ? Reg(operands[2]) : 0;
+            inst.extra = ValueWords(operands[0]);
+            return Emit(inst);
+        }
+        default:
+            if (instruction > GLSLstd450FindUMsb && instruction != GLSLstd450NMin &&
+                instruction != GLSLstd450NMax && instruction != GLSLstd450NClamp) {
+                return Fail("Unsupported GLSL.std.450 instruction " + std::to_string(instruction));
+            }
+            return EmitComponentWise(spv::OpExtInst, w[1], w[2], operands, operandCount, uint16_t(instruction));
+    }
+}
+
+// ============================================================================
+// SoftwareShaderProgram
+// ============================================================================
+
+SoftwareShaderProgram::~SoftwareShaderProgram() = default;
+
+std::expected<std::unique_ptr<SoftwareShaderProgram>, Error>
+SoftwareShaderProgram::Create(std::span<const uint32_t> spirv, ShaderStage stage, std::string_view entryPoint) {
+    if (stage != ShaderStage::Vertex && stage != ShaderStage::Fragment && stage != ShaderStage::Compute) {
+        return std::unexpected(Error{
+            Error::Code::UnsupportedFeature,
+            "The software backend only runs vertex, fragment and compute shaders"
+        });
+    }
+
+    std::unique_ptr<SoftwareShaderProgram> program(new SoftwareShaderProgram());
+    program->m_stage = stage;
+    SoftwareShaderDecoder decoder(*program, spirv);
+    if (!decoder.Decode(stage, entryPoint)) {
+        return std::unexpected(Error{
+            Error::Code::UnsupportedFeature,
+            "Software backend cannot run shader: " + decoder.GetError()
+        });
+    }
+    return program;
+}
+
+int32_t SoftwareShaderProgram::GetBuiltinOffset(uint32_t builtIn) const noexcept {
+    for (const Builtin& builtin : m_builtins) {
+        if (builtin.builtIn == builtIn) {
+            return int32_t(builtin.offset);
+        }
+    }
+    return -1;
+}
+
+std::unique_ptr<SoftwareShaderContext> SoftwareShaderProgram::CreateContext(uint32_t laneCount) const {
+    return std::make_unique<SoftwareShaderContext>(*this, laneCount);
+}
+
+} // namespace VRHI
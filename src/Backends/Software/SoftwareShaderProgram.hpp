@@ -0,0 +1,367 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/VRHI.hpp>
+#include <VRHI/Shader.hpp>
+#include "SoftwareTexture.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace VRHI {
+
+class SoftwareShaderContext;
+
+/// Resources shader invocations see during a draw or dispatch. Uniform and
+/// storage buffers share one table, like bindings of a Vulkan descriptor
+/// set; textures and samplers live in their own, like OpenGL texture units.
+struct SoftwareBindings {
+    static constexpr uint32_t MaxBindings = 64;
+    static constexpr uint32_t PushConstantSize = 128;
+
+    struct BufferBinding {
+        std::byte* data = nullptr;
+        size_t size = 0;
+    };
+
+    struct ImageBinding {
+        SoftwareTexture* texture = nullptr;
+        const SamplerDesc* sampler = nullptr;
+    };
+
+    BufferBinding buffers[MaxBindings];
+    ImageBinding images[MaxBindings];
+    alignas(16) std::byte pushConstants[PushConstantSize] = {};
+};
+
+/// Entry point of a SPIR-V module, decoded for SoftwareShaderContext to
+/// interpret.
+///
+/// Every SSA value is kept as 32-bit words in a register file with one
+/// column per invocation, so each instruction runs over all invocations of
+/// a batch before the next one starts; invocations that branch apart are
+/// rejoined by always running the lowest block any of them waits at.
+/// Input, output, private and function variables live in per-invocation
+/// memory with a packed layout; buffers keep the layout their decorations
+/// give them. Resources are resolved from their bindings when the module is
+/// decoded, so resource handles never need a register.
+///
+/// Only the 32-bit subset produced by GLSL compilers for graphics and
+/// compute shaders is supported; anything else (64-bit or 16-bit types,
+/// variable pointers, descriptor arrays, geometry and tessellation stages)
+/// fails Create().
+class SoftwareShaderProgram {
+public:
+    ~SoftwareShaderProgram();
+
+    static std::expected<std::unique_ptr<SoftwareShaderProgram>, Error>
+    Create(std::span<const uint32_t> spirv, ShaderStage stage, std::string_view entryPoint);
+
+    /// A user-defined input or output of the entry point
+    struct InterfaceVariable {
+        uint32_t location = 0;
+        uint32_t offset = 0;        // Byte offset in invocation memory
+        uint32_t words = 0;         // 32-bit components, in location order
+        bool flat = false;          // Not interpolated
+        bool noPerspective = false; // Interpolated linearly in screen space
+    };
+
+    ShaderStage GetStage() const noexcept { return m_stage; }
+
+    const std::vector<InterfaceVariable>& GetInputs() const noexcept { return m_inputs; }
+    const std::vector<InterfaceVariable>& GetOutputs() const noexcept { return m_outputs; }
+
+    /// Byte offset in invocation memory of a built-in (a spv::BuiltIn), or
+    /// -1 if the entry point does not use it
+    int32_t GetBuiltinOffset(uint32_t builtIn) const noexcept;
+
+    /// Bytes of memory each invocation needs for its variables
+    uint32_t GetInvocationMemorySize() const noexcept { return m_localSize; }
+
+    /// Bytes of workgroup shared memory
+    uint32_t GetSharedMemorySize() const noexcept { return m_sharedSize; }
+
+    /// Workgroup size of compute shaders
+    const uint32_t* GetWorkgroupSize() const noexcept { return m_workgroupSize; }
+
+    /// Bindings of SoftwareBindings::buffers and images the module reads,
+    /// one bit per binding
+    uint64_t GetBufferBindings() const noexcept { return m_bufferBindings; }
+    uint64_t GetImageBindings() const noexcept { return m_imageBindings; }
+
+    /// Fragment shaders: whether the shader replaces the fragment's depth
+    bool WritesDepth() const noexcept { return m_writesDepth; }
+
+    /// Whether the shader writes buffers or images, so it must not be
+    /// skipped for fragments that fail the depth test
+    bool HasSideEffects() const noexcept { return m_hasSideEffects; }
+
+    /// Whether the shader can discard fragments
+    bool CanDiscard() const noexcept { return m_canDiscard; }
+
+    /// Whether the shader asks for depth and stencil tests before it runs
+    bool HasEarlyFragmentTests() const noexcept { return m_earlyFragmentTests; }
+
+    /// Execution state for batches of up to `laneCount` invocations; one
+    /// per thread, since contexts are not thread safe
+    std::unique_ptr<SoftwareShaderContext> CreateContext(uint32_t laneCount) const;
+
+private:
+    friend class SoftwareShaderContext;
+    friend class SoftwareShaderDecoder;
+
+    SoftwareShaderProgram() = default;
+
+    /// Memory an address points into
+    enum class Space : uint8_t {
+        Invocation,     // Per-invocation variables
+        Workgroup,      // Shared by the workgroup
+        Buffer,         // A SoftwareBindings::buffers entry
+        PushConstant,
+    };
+
+    /// A decoded instruction; register operands index the register file
+    struct Instruction {
+        uint16_t op = 0;        // spv::Op, or one of the internal ops
+        uint16_t sub = 0;       // Extended instruction, matrix rows, ...
+        uint32_t flags = 0;     // Scalar operands broadcast over the result
+        uint32_t count = 0;     // Words of the result
+        uint32_t result = 0;
+        uint32_t a = 0;
+        uint32_t b = 0;
+        uint32_t c = 0;
+        uint32_t extra = 0;     // Index into a side table
+    };
+
+    static constexpr uint32_t ScalarA = 1u << 0;
+    static constexpr uint32_t ScalarB = 1u << 1;
+    static constexpr uint32_t ScalarC = 1u << 2;
+
+    /// Internal ops, numbered past the SPIR-V opcodes the decoder accepts
+    enum InternalOp : uint16_t {
+        OpMove = 0x8000,        // Copy `count` words from a
+        OpGather,               // Copy words from the registers listed at `extra`
+        OpPhiGroup,             // All phis of a block, resolved together
+        OpCallFunction,
+    };
+
+    struct Block {
+        uint32_t first = 0;     // First instruction
+        uint32_t count = 0;     // Instructions, terminator included
+    };
+
+    struct Function {
+        uint32_t entryBlock = 0;
+        uint32_t resultRegister = 0;
+        uint32_t resultWords = 0;
+    };
+
+    struct CallInfo {
+        uint32_t function = 0;
+        uint32_t firstArgument = 0;   // Into m_moves
+        uint32_t argumentCount = 0;
+    };
+
+    /// Register-to-register copy of `words` words
+    struct Move {
+        uint32_t target = 0;
+        uint32_t source = 0;
+        uint32_t words = 0;
+    };
+
+    /// Where a pointer's memory is and how its pointee is laid out there
+    struct MemoryAccess {
+        Space space = Space::Invocation;
+        uint32_t binding = 0;
+        uint32_t firstOffset = 0;     // Into m_offsets: byte offset of each word
+        uint32_t words = 0;
+    };
+
+    struct AccessChain {
+        uint32_t constantOffset = 0;
+        uint32_t firstIndex = 0;      // Into m_indices
+        uint32_t indexCount = 0;
+    };
+
+    struct DynamicIndex {
+        uint32_t reg = 0;
+        uint32_t stride = 0;
+    };
+
+    struct Phi {
+        uint32_t result = 0;
+        uint32_t words = 0;
+        uint32_t firstIncoming = 0;   // Into m_incoming
+        uint32_t incomingCount = 0;
+    };
+
+    struct Incoming {
+        uint32_t block = 0;
+        uint32_t value = 0;
+    };
+
+    struct PhiGroup {
+        uint32_t first = 0;           // Into m_phis
+        uint32_t count = 0;
+        uint32_t scratchWords = 0;
+    };
+
+    struct SwitchCase {
+        uint32_t value = 0;
+        uint32_t block = 0;
+    };
+
+    struct SwitchTable {
+        uint32_t defaultBlock = 0;
+        uint32_t first = 0;           // Into m_cases
+        uint32_t count = 0;
+    };
+
+    static constexpr uint32_t NoRegister = UINT32_MAX;
+
+    /// Operands of an image instruction
+    struct ImageAccess {
+        uint32_t image = 0;           // Binding of the texture
+        uint32_t sampler = NoRegister; // Binding of a separate sampler
+        SoftwareImageDim dim = SoftwareImageDim::Dim2D;
+        bool arrayed = false;
+        bool project = false;
+        uint32_t coordinate = 0;
+        uint32_t coordinateWords = 0;
+        uint32_t reference = NoRegister;
+        uint32_t bias = NoRegister;
+        uint32_t lod = NoRegister;
+        uint32_t gradX = NoRegister;
+        uint32_t gradY = NoRegister;
+        uint32_t offset = NoRegister;
+        uint32_t texel = NoRegister;  // Written by OpImageWrite
+    };
+
+    struct ConstantWord {
+        uint32_t reg = 0;
+        uint32_t value = 0;
+    };
+
+    struct Builtin {
+        uint32_t builtIn = 0;
+        uint32_t offset = 0;
+    };
+
+    ShaderStage m_stage = ShaderStage::Vertex;
+    uint32_t m_registerCount = 0;
+    uint32_t m_localSize = 0;
+    uint32_t m_sharedSize = 0;
+    uint32_t m_entryFunction = 0;
+    uint32_t m_workgroupSize[3] = {1, 1, 1};
+    uint64_t m_bufferBindings = 0;
+    uint64_t m_imageBindings = 0;
+    bool m_writesDepth = false;
+    bool m_hasSideEffects = false;
+    bool m_canDiscard = false;
+    bool m_earlyFragmentTests = false;
+
+    std::vector<Instruction> m_instructions;
+    std::vector<Block> m_blocks;
+    std::vector<Function> m_functions;
+    std::vector<ConstantWord> m_constants;
+    std::vector<InterfaceVariable> m_inputs;
+    std::vector<InterfaceVariable> m_outputs;
+    std::vector<Builtin> m_builtins;
+    std::vector<Move> m_initializers;   // Targets are byte offsets in invocation memory
+
+    std::vector<CallInfo> m_calls;
+    std::vector<Move> m_moves;
+    std::vector<MemoryAccess> m_memory;
+    std::vector<uint32_t> m_offsets;
+    std::vector<AccessChain> m_chains;
+    std::vector<DynamicIndex> m_indices;
+    std::vector<uint32_t> m_gathers;
+    std::vector<PhiGroup> m_phiGroups;
+    std::vector<Phi> m_phis;
+    std::vector<Incoming> m_incoming;
+    std::vector<SwitchTable> m_switches;
+    std::vector<SwitchCase> m_cases;
+    std::vector<ImageAccess> m_images;
+};
+
+/// Registers, invocation memory and control flow state for running batches
+/// of invocations of one SoftwareShaderProgram.
+///
+/// Fragment batches are made of quads: invocations 4q .. 4q + 3 are the
+/// pixels (0, 0), (1, 0), (0, 1) and (1, 1) of a 2x2 quad, which is what
+/// derivatives and implicit level-of-detail sampling difference across.
+class SoftwareShaderContext {
+public:
+    SoftwareShaderContext(const SoftwareShaderProgram& program, uint32_t laneCount);
+    ~SoftwareShaderContext();
+
+    uint32_t GetLaneCount() const noexcept { return m_laneCount; }
+
+    /// Variables of one invocation; inputs are written here before Run()
+    /// and outputs read back after it
+    std::byte* GetInvocationMemory(uint32_t lane) noexcept {
+        return m_memory.data() + size_t(lane) * m_memoryStride;
+    }
+
+    /// Clear the variables of the first `laneCount` invocations
+    void ResetInvocationMemory(uint32_t laneCount);
+
+    /// Helper invocations compute derivatives for their quad but have no
+    /// side effects; Run() clears the flags
+    void SetHelper(uint32_t lane, bool helper) noexcept { m_helper[lane] = helper ? 1 : 0; }
+
+    /// Run the entry point for invocations [0, laneCount). Compute shaders
+    /// pass the workgroup's shared memory, which must be zeroed.
+    void Run(const SoftwareBindings& bindings, uint32_t laneCount, std::byte* shared = nullptr);
+
+    /// Whether the invocation was discarded by the last Run()
+    bool IsDiscarded(uint32_t lane) const noexcept { return m_discarded[lane] != 0; }
+
+private:
+    using Program = SoftwareShaderProgram;
+    using Instruction = SoftwareShaderProgram::Instruction;
+
+    struct FunctionState {
+        std::vector<uint32_t> block;     // Block each invocation waits at
+        std::vector<uint32_t> previous;  // Block it came from, for phis
+        std::vector<uint16_t> pending;
+        std::vector<uint16_t> active;
+    };
+
+    uint32_t* Reg(uint32_t reg) noexcept { return m_registers.data() + size_t(reg) * m_laneCount; }
+
+    void RunFunction(uint32_t function, std::span<const uint16_t> lanes);
+    void RunBlock(uint32_t block, FunctionState& state, std::vector<uint16_t>& lanes);
+    void Execute(const Instruction& inst, std::span<const uint16_t> lanes);
+    void ExecuteExtended(const Instruction& inst, std::span<const uint16_t> lanes);
+    void ExecuteMatrix(const Instruction& inst, std::span<const uint16_t> lanes);
+    void ExecuteImage(const Instruction& inst, std::span<const uint16_t> lanes);
+    void ExecuteAtomic(const Instruction& inst, std::span<const uint16_t> lanes);
+
+    /// Memory an access reaches for invocation 0; invocation i's is
+    /// `laneStride` * i bytes further
+    std::byte* Resolve(const Program::MemoryAccess& access, size_t& laneStride, size_t& size) const noexcept;
+
+    const SoftwareShaderProgram& m_program;
+    uint32_t m_laneCount;
+    uint32_t m_memoryStride;
+    const SoftwareBindings* m_bindings = nullptr;
+    std::byte* m_shared = nullptr;
+
+    std::vector<uint32_t> m_registers;
+    std::vector<std::byte> m_memory;
+    std::vector<uint32_t> m_scratch;
+    std::vector<uint8_t> m_helper;
+    std::vector<uint8_t> m_alive;       // Still executing
+    std::vector<uint8_t> m_discarded;   // Killed or demoted to a helper
+    std::vector<uint16_t> m_lanes;
+    std::vector<FunctionState> m_functions;
+};
+
+} // namespace VRHI
@@ -0,0 +1,207 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__AVX2__)
+    #define VRHI_SOFTWARE_AVX2 1
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define VRHI_SOFTWARE_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+namespace VRHI {
+
+// ============================================================================
+// SIMD Vectors
+// ============================================================================
+//
+// Fixed-width vectors of int32 and float lanes used by the rasterizer's
+// coverage, depth and interpolation loops. The instruction set is chosen at
+// compile time: AVX2 (8 lanes) when the compiler targets it
+// (VRHI_SOFTWARE_AVX2=ON), else SSE2 (4 lanes), else a scalar fallback with
+// the SSE2 layout. Comparisons return masks with all bits set in the lanes
+// where they hold; MoveMask() packs the lanes' sign bits into an integer.
+
+#if defined(VRHI_SOFTWARE_AVX2)
+
+inline constexpr uint32_t SimdWidth = 8;
+inline constexpr const char* SimdName = "AVX2";
+
+struct SimdInt {
+    __m256i v;
+
+    static SimdInt Broadcast(int32_t value) noexcept { return {_mm256_set1_epi32(value)}; }
+    static SimdInt Load(const int32_t* values) noexcept {
+        return {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values))};
+    }
+
+    friend SimdInt operator+(SimdInt a, SimdInt b) noexcept { return {_mm256_add_epi32(a.v, b.v)}; }
+    friend SimdInt operator&(SimdInt a, SimdInt b) noexcept { return {_mm256_and_si256(a.v, b.v)}; }
+    friend SimdInt operator>(SimdInt a, SimdInt b) noexcept { return {_mm256_cmpgt_epi32(a.v, b.v)}; }
+
+    uint32_t MoveMask() const noexcept {
+        return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(v)));
+    }
+};
+
+struct SimdFloat {
+    __m256 v;
+
+    static SimdFloat Broadcast(float value) noexcept { return {_mm256_set1_ps(value)}; }
+    static SimdFloat Load(const float* values) noexcept { return {_mm256_loadu_ps(values)}; }
+    static SimdFloat FromInt(SimdInt value) noexcept { return {_mm256_cvtepi32_ps(value.v)}; }
+    void Store(float* values) const noexcept { _mm256_storeu_ps(values, v); }
+
+    friend SimdFloat operator+(SimdFloat a, SimdFloat b) noexcept { return {_mm256_add_ps(a.v, b.v)}; }
+    friend SimdFloat operator-(SimdFloat a, SimdFloat b) noexcept { return {_mm256_sub_ps(a.v, b.v)}; }
+    friend SimdFloat operator*(SimdFloat a, SimdFloat b) noexcept { return {_mm256_mul_ps(a.v, b.v)}; }
+    friend SimdFloat operator/(SimdFloat a, SimdFloat b) noexcept { return {_mm256_div_ps(a.v, b.v)}; }
+    friend SimdFloat Min(SimdFloat a, SimdFloat b) noexcept { return {_mm256_min_ps(a.v, b.v)}; }
+    friend SimdFloat Max(SimdFloat a, SimdFloat b) noexcept { return {_mm256_max_ps(a.v, b.v)}; }
+
+    friend SimdFloat operator<(SimdFloat a, SimdFloat b) noexcept { return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)}; }
+    friend SimdFloat operator<=(SimdFloat a, SimdFloat b) noexcept { return {_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)}; }
+    friend SimdFloat operator>(SimdFloat a, SimdFloat b) noexcept { return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)}; }
+    friend SimdFloat operator>=(SimdFloat a, SimdFloat b) noexcept { return {_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)}; }
+    friend SimdFloat operator==(SimdFloat a, SimdFloat b) noexcept { return {_mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ)}; }
+    friend SimdFloat operator!=(SimdFloat a, SimdFloat b) noexcept { return {_mm256_cmp_ps(a.v, b.v, _CMP_NEQ_UQ)}; }
+
+    uint32_t MoveMask() const noexcept { return static_cast<uint32_t>(_mm256_movemask_ps(v)); }
+};
+
+#elif defined(VRHI_SOFTWARE_SSE2)
+
+inline constexpr uint32_t SimdWidth = 4;
+inline constexpr const char* SimdName = "SSE2";
+
+struct SimdInt {
+    __m128i v;
+
+    static SimdInt Broadcast(int32_t value) noexcept { return {_mm_set1_epi32(value)}; }
+    static SimdInt Load(const int32_t* values) noexcept {
+        return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(values))};
+    }
+
+    friend SimdInt operator+(SimdInt a, SimdInt b) noexcept { return {_mm_add_epi32(a.v, b.v)}; }
+    friend SimdInt operator&(SimdInt a, SimdInt b) noexcept { return {_mm_and_si128(a.v, b.v)}; }
+    friend SimdInt operator>(SimdInt a, SimdInt b) noexcept { return {_mm_cmpgt_epi32(a.v, b.v)}; }
+
+    uint32_t MoveMask() const noexcept {
+        return static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(v)));
+    }
+};
+
+struct SimdFloat {
+    __m128 v;
+
+    static SimdFloat Broadcast(float value) noexcept { return {_mm_set1_ps(value)}; }
+    static SimdFloat Load(const float* values) noexcept { return {_mm_loadu_ps(values)}; }
+    static SimdFloat FromInt(SimdInt value) noexcept { return {_mm_cvtepi32_ps(value.v)}; }
+    void Store(float* values) const noexcept { _mm_storeu_ps(values, v); }
+
+    friend SimdFloat operator+(SimdFloat a, SimdFloat b) noexcept { return {_mm_add_ps(a.v, b.v)}; }
+    friend SimdFloat operator-(SimdFloat a, SimdFloat b) noexcept { return {_mm_sub_ps(a.v, b.v)}; }
+    friend SimdFloat operator*(SimdFloat a, SimdFloat b) noexcept { return {_mm_mul_ps(a.v, b.v)}; }
+    friend SimdFloat operator/(SimdFloat a, SimdFloat b) noexcept { return {_mm_div_ps(a.v, b.v)}; }
+    friend SimdFloat Min(SimdFloat a, SimdFloat b) noexcept { return {_mm_min_ps(a.v, b.v)}; }
+    friend SimdFloat Max(SimdFloat a, SimdFloat b) noexcept { return {_mm_max_ps(a.v, b.v)}; }
+
+    friend SimdFloat operator<(SimdFloat a, SimdFloat b) noexcept { return {_mm_cmplt_ps(a.v, b.v)}; }
+    friend SimdFloat operator<=(SimdFloat a, SimdFloat b) noexcept { return {_mm_cmple_ps(a.v, b.v)}; }
+    friend SimdFloat operator>(SimdFloat a, SimdFloat b) noexcept { return {_mm_cmpgt_ps(a.v, b.v)}; }
+    friend SimdFloat operator>=(SimdFloat a, SimdFloat b) noexcept { return {_mm_cmpge_ps(a.v, b.v)}; }
+    friend SimdFloat operator==(SimdFloat a, SimdFloat b) noexcept { return {_mm_cmpeq_ps(a.v, b.v)}; }
+    friend SimdFloat operator!=(SimdFloat a, SimdFloat b) noexcept { return {_mm_cmpneq_ps(a.v, b.v)}; }
+
+    uint32_t MoveMask() const noexcept { return static_cast<uint32_t>(_mm_movemask_ps(v)); }
+};
+
+#else
+
+inline constexpr uint32_t SimdWidth = 4;
+inline constexpr const char* SimdName = "scalar";
+
+namespace detail {
+    template<typename T, typename Op>
+    T SimdMap(const T& a, const T& b, Op op) noexcept {
+        T result;
+        for (uint32_t i = 0; i < SimdWidth; ++i) {
+            result.v[i] = op(a.v[i], b.v[i]);
+        }
+        return result;
+    }
+
+    template<typename T>
+    uint32_t SimdMoveMask(const T& value) noexcept {
+        uint32_t mask = 0;
+        for (uint32_t i = 0; i < SimdWidth; ++i) {
+            mask |= (value.v[i] != 0 ? 1u : 0u) << i;
+        }
+        return mask;
+    }
+}
+
+struct SimdInt {
+    int32_t v[SimdWidth];
+
+    static SimdInt Broadcast(int32_t value) noexcept { return {{value, value, value, value}}; }
+    static SimdInt Load(const int32_t* values) noexcept { return {{values[0], values[1], values[2], values[3]}}; }
+
+    friend SimdInt operator+(SimdInt a, SimdInt b) noexcept {
+        return detail::SimdMap(a, b, [](int32_t x, int32_t y) {
+            return static_cast<int32_t>(static_cast<uint32_t>(x) + static_cast<uint32_t>(y));
+        });
+    }
+    friend SimdInt operator&(SimdInt a, SimdInt b) noexcept {
+        return detail::SimdMap(a, b, [](int32_t x, int32_t y) { return x & y; });
+    }
+    friend SimdInt operator>(SimdInt a, SimdInt b) noexcept {
+        return detail::SimdMap(a, b, [](int32_t x, int32_t y) { return x > y ? -1 : 0; });
+    }
+
+    uint32_t MoveMask() const noexcept { return detail::SimdMoveMask(*this); }
+};
+
+/// Comparisons store 1 or 0 per lane, which MoveMask() reads like the
+/// vector versions' all-ones lanes
+struct SimdFloat {
+    float v[SimdWidth];
+
+    static SimdFloat Broadcast(float value) noexcept { return {{value, value, value, value}}; }
+    static SimdFloat Load(const float* values) noexcept { return {{values[0], values[1], values[2], values[3]}}; }
+    static SimdFloat FromInt(SimdInt value) noexcept {
+        return {{float(value.v[0]), float(value.v[1]), float(value.v[2]), float(value.v[3])}};
+    }
+    void Store(float* values) const noexcept {
+        for (uint32_t i = 0; i < SimdWidth; ++i) {
+            values[i] = v[i];
+        }
+    }
+
+    friend SimdFloat operator+(SimdFloat a, SimdFloat b) noexcept { return detail::SimdMap(a, b, [](float x, float y) { return x + y; }); }
+    friend SimdFloat operator-(SimdFloat a, SimdFloat b) noexcept { return detail::SimdMap(a, b, [](float x, float y) { return x - y; }); }
+    friend SimdFloat operator*(SimdFloat a, SimdFloat b) noexcept { return detail::SimdMap(a, b, [](float x, float y) { return x * y; }); }
+    friend SimdFloat operator/(SimdFloat a, SimdFloat b) noexcept { return detail::SimdMap(a, b, [](float x, float y) { return x / y; }); }
+    friend SimdFloat Min(SimdFloat a, SimdFloat b) noexcept { return detail::SimdMap(a, b, [](float x, float y) { return y < x ? y : x; }); }
+    friend SimdFloat Max(SimdFloat a, SimdFloat b) noexcept { return detail::SimdMap(a, b, [](float x, float y) { return y > x ? y : x; }); }
+
+    friend SimdFloat operator<(SimdFloat a, SimdFloat b) noexcept { return detail::SimdMap(a, b, [](float x, float y) { return x < y ? 1.0f : 0.0f; }); }
+    friend SimdFloat operator<=(SimdFloat a, SimdFloat b) noexcept { return detail::SimdMap(a, b, [](float x, float y) { return x <= y ? 1.0f : 0.0f; }); }
+    friend SimdFloat operator>(SimdFloat a, SimdFloat b) noexcept { return detail::SimdMap(a, b, [](float x, float y) { return x > y ? 1.0f : 0.0f; }); }
+    friend SimdFloat operator>=(SimdFloat a, SimdFloat b) noexcept { return detail::SimdMap(a, b, [](float x, float y) { return x >= y ? 1.0f : 0.0f; }); }
+    friend SimdFloat operator==(SimdFloat a, SimdFloat b) noexcept { return detail::SimdMap(a, b, [](float x, float y) { return x == y ? 1.0f : 0.0f; }); }
+    friend SimdFloat operator!=(SimdFloat a, SimdFloat b) noexcept { return detail::SimdMap(a, b, [](float x, float y) { return x != y ? 1.0f : 0.0f; }); }
+
+    uint32_t MoveMask() const noexcept { return detail::SimdMoveMask(*this); }
+};
+
+#endif
+
+/// Mask with the low SimdWidth bits set
+inline constexpr uint32_t SimdAllLanes = (1u << SimdWidth) - 1;
+
+} // namespace VRHI
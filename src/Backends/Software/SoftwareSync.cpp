@@ -0,0 +1,24 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "SoftwareSync.hpp"
+
+namespace VRHI {
+
+bool SoftwareFence::Wait(uint64_t /*timeout*/) {
+    return m_signaled.load(std::memory_order_acquire);
+}
+
+void SoftwareFence::Reset() {
+    m_signaled.store(false, std::memory_order_release);
+}
+
+bool SoftwareFence::IsSignaled() const noexcept {
+    return m_signaled.load(std::memory_order_acquire);
+}
+
+void SoftwareFence::Signal() {
+    m_signaled.store(true, std::memory_order_release);
+}
+
+} // namespace VRHI
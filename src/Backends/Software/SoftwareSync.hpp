@@ -0,0 +1,36 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/Sync.hpp>
+#include <atomic>
+
+namespace VRHI {
+
+/// Submissions finish before Submit() returns, so a fence is signaled by
+/// the time anyone can wait on it and Wait() never blocks
+class SoftwareFence : public Fence {
+public:
+    explicit SoftwareFence(bool signaled) : m_signaled(signaled) {}
+    ~SoftwareFence() override = default;
+
+    bool Wait(uint64_t timeout = UINT64_MAX) override;
+    void Reset() override;
+    bool IsSignaled() const noexcept override;
+
+    // Called by the device once the commands of a submission have executed
+    void Signal();
+
+private:
+    std::atomic<bool> m_signaled;
+};
+
+/// Execution is already ordered, so semaphores carry nothing
+class SoftwareSemaphore : public Semaphore {
+public:
+    SoftwareSemaphore() = default;
+    ~SoftwareSemaphore() override = default;
+};
+
+} // namespace VRHI
@@ -0,0 +1,596 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "SoftwareTexture.hpp"
+#include "SoftwareFormatUtils.hpp"
+#include <VRHI/Logging.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <new>
+
+namespace VRHI {
+
+namespace {
+    uint32_t CountLayers(const TextureDesc& desc) {
+        const uint32_t layers = std::max(desc.arrayLayers, 1u);
+        switch (desc.type) {
+            case TextureType::Texture1D:
+            case TextureType::Texture2D:
+            case TextureType::Texture3D:
+                return 1;
+            case TextureType::TextureCube:
+                return 6;
+            case TextureType::TextureCubeArray:
+                return 6 * layers;
+            default:
+                return layers;
+        }
+    }
+
+    uint32_t MipExtent(uint32_t extent, uint32_t mipLevel) {
+        return std::max(extent >> mipLevel, 1u);
+    }
+
+    bool CompareDepth(CompareOp op, float reference, float depth) {
+        switch (op) {
+            case CompareOp::Never: return false;
+            case CompareOp::Less: return reference < depth;
+            case CompareOp::Equal: return reference == depth;
+            case CompareOp::LessOrEqual: return reference <= depth;
+            case CompareOp::Greater: return reference > depth;
+            case CompareOp::NotEqual: return reference != depth;
+            case CompareOp::GreaterOrEqual: return reference >= depth;
+            case CompareOp::Always: return true;
+        }
+        return false;
+    }
+
+    /// Texel index after addressing, or -1 for the border
+    int32_t WrapCoordinate(int32_t i, int32_t size, AddressMode mode) {
+        switch (mode) {
+            case AddressMode::Repeat:
+                return ((i % size) + size) % size;
+            case AddressMode::MirroredRepeat: {
+                const int32_t period = 2 * size;
+                const int32_t m = ((i % period) + period) % period;
+                return m < size ? m : period - 1 - m;
+            }
+            case AddressMode::ClampToEdge:
+                return std::clamp(i, 0, size - 1);
+            case AddressMode::ClampToBorder:
+                return i < 0 || i >= size ? -1 : i;
+        }
+        return 0;
+    }
+
+    uint32_t SelectLayer(float layer, uint32_t count) {
+        const float index = std::floor(layer + 0.5f);
+        return uint32_t(std::clamp(index, 0.0f, float(count - 1)));
+    }
+
+    /// Cube face of a direction, numbered +X, -X, +Y, -Y, +Z, -Z
+    uint32_t SelectCubeFace(float x, float y, float z) {
+        const float ax = std::abs(x);
+        const float ay = std::abs(y);
+        const float az = std::abs(z);
+        if (az >= ax && az >= ay) {
+            return z >= 0.0f ? 4 : 5;
+        }
+        if (ay >= ax) {
+            return y >= 0.0f ? 2 : 3;
+        }
+        return x >= 0.0f ? 0 : 1;
+    }
+
+    /// Face coordinates in [0, 1] of a direction projected onto `face`
+    void ProjectCubeFace(uint32_t face, float x, float y, float z, float& s, float& t) {
+        float sc = 0.0f;
+        float tc = 0.0f;
+        float ma = 1.0f;
+        switch (face) {
+            case 0: sc = -z; tc = -y; ma = x; break;
+            case 1: sc = z; tc = -y; ma = -x; break;
+            case 2: sc = x; tc = z; ma = y; break;
+            case 3: sc = x; tc = -z; ma = -y; break;
+            case 4: sc = x; tc = -y; ma = z; break;
+            default: sc = -x; tc = -y; ma = -z; break;
+        }
+        const float scale = ma > 0.0f ? 0.5f / ma : 0.0f;
+        s = sc * scale + 0.5f;
+        t = tc * scale + 0.5f;
+    }
+
+    uint32_t DimensionCount(SoftwareImageDim dim) {
+        switch (dim) {
+            case SoftwareImageDim::Dim1D: return 1;
+            case SoftwareImageDim::Dim3D: return 3;
+            default: return 2;
+        }
+    }
+}
+
+/// One layer of one mip level as a lookup sees it
+struct SoftwareTexture::Level {
+    const std::byte* data = nullptr;
+    int32_t size[3] = {1, 1, 1};
+    uint32_t dims = 2;
+    float coord[3] = {};
+    AddressMode modes[3] = {};
+};
+
+SoftwareTexture::SoftwareTexture(const TextureDesc& desc)
+    : m_type(desc.type)
+    , m_format(desc.format)
+    , m_width(desc.width)
+    , m_height(desc.type == TextureType::Texture1D || desc.type == TextureType::Texture1DArray ? 1 : desc.height)
+    , m_depth(desc.type == TextureType::Texture3D ? desc.depth : 1)
+    , m_mipLevels(desc.mipLevels)
+    , m_arrayLayers(desc.arrayLayers)
+{
+}
+
+std::expected<std::unique_ptr<Texture>, Error>
+SoftwareTexture::Create(const TextureDesc& desc) {
+    if (desc.width == 0 || desc.height == 0 || desc.depth == 0 || desc.mipLevels == 0) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Texture dimensions and mip level count must be greater than 0"
+        });
+    }
+
+    const uint32_t texelSize = SoftwareFormatUtils::GetTexelSize(desc.format);
+    if (texelSize == 0) {
+        return std::unexpected(Error{
+            Error::Code::UnsupportedFeature,
+            "Compressed texture formats are not supported by the software backend"
+        });
+    }
+
+    const bool isCube = desc.type == TextureType::TextureCube || desc.type == TextureType::TextureCubeArray;
+    if (isCube && desc.width != desc.height) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Cube map faces must be square"
+        });
+    }
+
+    if (desc.sampleCount > 1) {
+        LogWarning("SoftwareTexture: Multisampling is not supported, storing %u samples as one",
+                   desc.sampleCount);
+    }
+
+    auto texture = std::unique_ptr<SoftwareTexture>(new SoftwareTexture(desc));
+    const uint32_t maxExtent = std::max({texture->m_width, texture->m_height, texture->m_depth});
+    if (desc.mipLevels > uint32_t(std::bit_width(maxExtent))) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Texture mip level count exceeds the full mip chain"
+        });
+    }
+
+    texture->m_texelSize = texelSize;
+    texture->m_layerCount = CountLayers(desc);
+    texture->m_mipOffsets.resize(desc.mipLevels);
+    size_t offset = 0;
+    for (uint32_t mip = 0; mip < desc.mipLevels; ++mip) {
+        texture->m_mipOffsets[mip] = offset;
+        offset += texture->GetSubresourceSize(mip);
+    }
+    texture->m_layerStride = offset;
+
+    const size_t total = offset * texture->m_layerCount;
+    texture->m_data.reset(new (std::nothrow) std::byte[total]());
+    if (!texture->m_data) {
+        return std::unexpected(Error{
+            Error::Code::OutOfMemory,
+            "Failed to allocate texture memory"
+        });
+    }
+
+    // Initial data is mip 0 of every layer, one after another
+    if (desc.initialData) {
+        const auto* source = static_cast<const std::byte*>(desc.initialData);
+        const size_t layerSize = texture->GetSubresourceSize(0);
+        for (uint32_t layer = 0; layer < texture->m_layerCount; ++layer) {
+            std::memcpy(texture->GetSubresource(0, layer), source + layer * layerSize, layerSize);
+        }
+    }
+
+    return std::unique_ptr<Texture>(std::move(texture));
+}
+
+// ============================================================================
+// Subresources
+// ============================================================================
+
+uint32_t SoftwareTexture::GetMipWidth(uint32_t mipLevel) const noexcept {
+    return MipExtent(m_width, mipLevel);
+}
+
+uint32_t SoftwareTexture::GetMipHeight(uint32_t mipLevel) const noexcept {
+    return MipExtent(m_height, mipLevel);
+}
+
+uint32_t SoftwareTexture::GetMipDepth(uint32_t mipLevel) const noexcept {
+    return MipExtent(m_depth, mipLevel);
+}
+
+size_t SoftwareTexture::GetSubresourceSize(uint32_t mipLevel) const noexcept {
+    return size_t(GetMipWidth(mipLevel)) * GetMipHeight(mipLevel) * GetMipDepth(mipLevel) * m_texelSize;
+}
+
+std::byte* SoftwareTexture::GetSubresource(uint32_t mipLevel, uint32_t arrayLayer) const noexcept {
+    return m_data.get() + arrayLayer * m_layerStride + m_mipOffsets[mipLevel];
+}
+
+void SoftwareTexture::Update(const void* data, size_t size, uint32_t mipLevel, uint32_t arrayLayer) {
+    if (mipLevel >= m_mipLevels || arrayLayer >= m_layerCount) {
+        LogError("SoftwareTexture: Update subresource out of range");
+        return;
+    }
+    std::memcpy(GetSubresource(mipLevel, arrayLayer), data,
+                std::min(size, GetSubresourceSize(mipLevel)));
+}
+
+void SoftwareTexture::UpdateRegion(const void* data,
+                                   uint32_t x, uint32_t y, uint32_t z,
+                                   uint32_t width, uint32_t height, uint32_t depth,
+                                   uint32_t mipLevel, uint32_t arrayLayer) {
+    if (mipLevel >= m_mipLevels || arrayLayer >= m_layerCount) {
+        LogError("SoftwareTexture: UpdateRegion subresource out of range");
+        return;
+    }
+    const uint32_t mipWidth = GetMipWidth(mipLevel);
+    const uint32_t mipHeight = GetMipHeight(mipLevel);
+    if (x + width > mipWidth || y + height > mipHeight || z + depth > GetMipDepth(mipLevel)) {
+        LogError("SoftwareTexture: UpdateRegion out of bounds");
+        return;
+    }
+
+    const auto* source = static_cast<const std::byte*>(data);
+    std::byte* target = GetSubresource(mipLevel, arrayLayer);
+    const size_t rowSize = size_t(width) * m_texelSize;
+    for (uint32_t slice = 0; slice < depth; ++slice) {
+        for (uint32_t row = 0; row < height; ++row) {
+            const size_t texel = (size_t(z + slice) * mipHeight + y + row) * mipWidth + x;
+            std::memcpy(target + texel * m_texelSize, source, rowSize);
+            source += rowSize;
+        }
+    }
+}
+
+void SoftwareTexture::GenerateMipmaps(CommandBuffer* /*cmd*/) {
+    const bool integer = SoftwareFormatUtils::IsIntegerFormat(m_format);
+    for (uint32_t layer = 0; layer < m_layerCount; ++layer) {
+        for (uint32_t mip = 1; mip < m_mipLevels; ++mip) {
+            const std::byte* source = GetSubresource(mip - 1, layer);
+            std::byte* target = GetSubresource(mip, layer);
+            const uint32_t sw = GetMipWidth(mip - 1);
+            const uint32_t sh = GetMipHeight(mip - 1);
+            const uint32_t sd = GetMipDepth(mip - 1);
+            const uint32_t tw = GetMipWidth(mip);
+            const uint32_t th = GetMipHeight(mip);
+            const uint32_t td = GetMipDepth(mip);
+
+            for (uint32_t z = 0; z < td; ++z) {
+                for (uint32_t y = 0; y < th; ++y) {
+                    for (uint32_t x = 0; x < tw; ++x) {
+                        // 2x2x2 box, collapsing along axes the level above is 1 wide in
+                        const uint32_t xs[2] = {std::min(2 * x, sw - 1), std::min(2 * x + 1, sw - 1)};
+                        const uint32_t ys[2] = {std::min(2 * y, sh - 1), std::min(2 * y + 1, sh - 1)};
+                        const uint32_t zs[2] = {std::min(2 * z, sd - 1), std::min(2 * z + 1, sd - 1)};
+
+                        uint32_t words[4];
+                        std::byte* texel = target + ((size_t(z) * th + y) * tw + x) * m_texelSize;
+                        if (integer) {
+                            SoftwareFormatUtils::Decode(
+                                m_format, source + ((size_t(zs[0]) * sh + ys[0]) * sw + xs[0]) * m_texelSize, words);
+                            SoftwareFormatUtils::Encode(m_format, words, texel);
+                            continue;
+                        }
+
+                        float sum[4] = {};
+                        for (uint32_t k = 0; k < 8; ++k) {
+                            const size_t index = (size_t(zs[k >> 2]) * sh + ys[(k >> 1) & 1]) * sw + xs[k & 1];
+                            SoftwareFormatUtils::Decode(m_format, source + index * m_texelSize, words);
+                            for (uint32_t c = 0; c < 4; ++c) {
+                                sum[c] += std::bit_cast<float>(words[c]);
+                            }
+                        }
+                        for (uint32_t c = 0; c < 4; ++c) {
+                            words[c] = std::bit_cast<uint32_t>(sum[c] * 0.125f);
+                        }
+                        SoftwareFormatUtils::Encode(m_format, words, texel);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void SoftwareTexture::Read(void* data, size_t size, uint32_t mipLevel, uint32_t arrayLayer) {
+    if (mipLevel >= m_mipLevels || arrayLayer >= m_layerCount) {
+        LogError("SoftwareTexture: Read subresource out of range");
+        return;
+    }
+    std::memcpy(data, GetSubresource(mipLevel, arrayLayer),
+                std::min(size, GetSubresourceSize(mipLevel)));
+}
+
+// ============================================================================
+// Shader Access
+// ============================================================================
+
+void SoftwareTexture::Sample(const SamplerDesc& sampler, const SoftwareSampleRequest& request,
+                             uint32_t (&result)[4]) const {
+    Level level;
+    level.dims = DimensionCount(request.dim);
+    level.modes[0] = sampler.addressModeU;
+    level.modes[1] = sampler.addressModeV;
+    level.modes[2] = sampler.addressModeW;
+    std::copy_n(request.coord, 3, level.coord);
+
+    uint32_t layer = 0;
+    switch (request.dim) {
+        case SoftwareImageDim::Dim1D:
+            layer = request.arrayed ? SelectLayer(request.coord[1], m_layerCount) : 0;
+            break;
+        case SoftwareImageDim::Dim2D:
+            layer = request.arrayed ? SelectLayer(request.coord[2], m_layerCount) : 0;
+            break;
+        case SoftwareImageDim::Dim3D:
+            break;
+        case SoftwareImageDim::Cube: {
+            const float* c = request.coord;
+            const uint32_t face = SelectCubeFace(c[0], c[1], c[2]);
+            ProjectCubeFace(face, c[0], c[1], c[2], level.coord[0], level.coord[1]);
+            const uint32_t cubes = std::max(m_layerCount / 6, 1u);
+            layer = face + 6 * (request.arrayed ? SelectLayer(c[3], cubes) : 0);
+            level.modes[0] = level.modes[1] = AddressMode::ClampToEdge;
+            break;
+        }
+    }
+    layer = std::min(layer, m_layerCount - 1);
+
+    const float lod = std::clamp(request.lod + sampler.mipLodBias, sampler.minLod, sampler.maxLod);
+    const bool integer = SoftwareFormatUtils::IsIntegerFormat(m_format);
+    const bool magnify = lod <= 0.0f;
+    const bool linear = !integer &&
+        (magnify ? sampler.magFilter : sampler.minFilter) == FilterMode::Linear;
+
+    const auto setLevel = [&](uint32_t mip) {
+        level.data = GetSubresource(mip, layer);
+        level.size[0] = int32_t(GetMipWidth(mip));
+        level.size[1] = int32_t(GetMipHeight(mip));
+        level.size[2] = int32_t(GetMipDepth(mip));
+    };
+
+    const uint32_t maxLevel = m_mipLevels - 1;
+    float texel[4];
+    if (magnify || maxLevel == 0) {
+        setLevel(0);
+        SampleLevel(sampler, request, level, linear, texel);
+    } else if (integer || sampler.mipmapMode == FilterMode::Nearest) {
+        setLevel(std::min(uint32_t(std::ceil(lod + 0.5f)) - 1, maxLevel));
+        SampleLevel(sampler, request, level, linear, texel);
+    } else {
+        const float base = std::floor(lod);
+        const uint32_t mip = std::min(uint32_t(base), maxLevel);
+        setLevel(mip);
+        SampleLevel(sampler, request, level, linear, texel);
+        if (mip < maxLevel) {
+            float next[4];
+            setLevel(mip + 1);
+            SampleLevel(sampler, request, level, linear, next);
+            const float weight = lod - base;
+            for (uint32_t c = 0; c < 4; ++c) {
+                texel[c] += (next[c] - texel[c]) * weight;
+            }
+        }
+    }
+
+    for (uint32_t c = 0; c < 4; ++c) {
+        result[c] = std::bit_cast<uint32_t>(texel[c]);
+    }
+}
+
+void SoftwareTexture::SampleLevel(const SamplerDesc& sampler, const SoftwareSampleRequest& request,
+                                  const Level& level, bool linear, float (&result)[4]) const {
+    const bool integer = SoftwareFormatUtils::IsIntegerFormat(m_format);
+    const float reference = SoftwareFormatUtils::IsNormalizedFormat(m_format) ||
+                            m_format == TextureFormat::Depth16 || m_format == TextureFormat::Depth24Stencil8
+                                ? std::clamp(request.reference, 0.0f, 1.0f)
+                                : request.reference;
+
+    // Texel as floats; integer texels keep their bits so they pass through untouched
+    const auto load = [&](const int32_t (&index)[3], float (&out)[4]) {
+        if (index[0] < 0 || index[1] < 0 || index[2] < 0) {
+            for (uint32_t c = 0; c < 4; ++c) {
+                out[c] = integer ? std::bit_cast<float>(uint32_t(sampler.borderColor[c]))
+                                 : sampler.borderColor[c];
+            }
+        } else {
+            const size_t offset = (size_t(index[2]) * level.size[1] + index[1]) * level.size[0] + index[0];
+            uint32_t words[4];
+            SoftwareFormatUtils::Decode(m_format, level.data + offset * m_texelSize, words);
+            for (uint32_t c = 0; c < 4; ++c) {
+                out[c] = std::bit_cast<float>(words[c]);
+            }
+        }
+        if (request.compare) {
+            out[0] = CompareDepth(sampler.compareOp, reference, out[0]) ? 1.0f : 0.0f;
+            out[1] = out[2] = 0.0f;
+            out[3] = 1.0f;
+        }
+    };
+
+    if (!linear) {
+        int32_t index[3] = {0, 0, 0};
+        for (uint32_t axis = 0; axis < level.dims; ++axis) {
+            const float u = level.coord[axis] * float(level.size[axis]);
+            const int32_t i = int32_t(std::floor(u)) + request.offset[axis];
+            index[axis] = WrapCoordinate(i, level.size[axis], level.modes[axis]);
+            if (index[axis] < 0) {
+                index[0] = index[1] = index[2] = -1;
+                break;
+            }
+        }
+        load(index, result);
+        return;
+    }
+
+    int32_t taps[3][2] = {{0, 0}, {0, 0}, {0, 0}};
+    float weights[3] = {0.0f, 0.0f, 0.0f};
+    for (uint32_t axis = 0; axis < level.dims; ++axis) {
+        const float u = level.coord[axis] * float(level.size[axis]) - 0.5f;
+        const float base = std::floor(u);
+        const int32_t i = int32_t(base) + request.offset[axis];
+        weights[axis] = u - base;
+        taps[axis][0] = WrapCoordinate(i, level.size[axis], level.modes[axis]);
+        taps[axis][1] = WrapCoordinate(i + 1, level.size[axis], level.modes[axis]);
+    }
+
+    std::fill_n(result, 4, 0.0f);
+    const uint32_t tapCount = 1u << level.dims;
+    for (uint32_t k = 0; k < tapCount; ++k) {
+        float weight = 1.0f;
+        int32_t index[3] = {0, 0, 0};
+        for (uint32_t axis = 0; axis < level.dims; ++axis) {
+            const uint32_t bit = (k >> axis) & 1;
+            weight *= bit ? weights[axis] : 1.0f - weights[axis];
+            index[axis] = taps[axis][bit];
+        }
+        if (index[0] < 0 || index[1] < 0 || index[2] < 0) {
+            index[0] = index[1] = index[2] = -1;
+        }
+        float texel[4];
+        load(index, texel);
+        for (uint32_t c = 0; c < 4; ++c) {
+            result[c] += texel[c] * weight;
+        }
+    }
+}
+
+float SoftwareTexture::ComputeLod(const SoftwareSampleRequest& request,
+                                  const float (&ddx)[3], const float (&ddy)[3]) const {
+    float dx[3] = {};
+    float dy[3] = {};
+    float size[3] = {float(m_width), float(m_height), float(m_depth)};
+    uint32_t dims = DimensionCount(request.dim);
+
+    if (request.dim == SoftwareImageDim::Cube) {
+        // Differentiate the face coordinates of the centre's face
+        const float* c = request.coord;
+        const uint32_t face = SelectCubeFace(c[0], c[1], c[2]);
+        float s = 0.0f, t = 0.0f, sx = 0.0f, tx = 0.0f, sy = 0.0f, ty = 0.0f;
+        ProjectCubeFace(face, c[0], c[1], c[2], s, t);
+        ProjectCubeFace(face, c[0] + ddx[0], c[1] + ddx[1], c[2] + ddx[2], sx, tx);
+        ProjectCubeFace(face, c[0] + ddy[0], c[1] + ddy[1], c[2] + ddy[2], sy, ty);
+        dx[0] = sx - s;
+        dx[1] = tx - t;
+        dy[0] = sy - s;
+        dy[1] = ty - t;
+        dims = 2;
+    } else {
+        std::copy_n(ddx, 3, dx);
+        std::copy_n(ddy, 3, dy);
+    }
+
+    float rhoX = 0.0f;
+    float rhoY = 0.0f;
+    for (uint32_t axis = 0; axis < dims; ++axis) {
+        rhoX += (dx[axis] * size[axis]) * (dx[axis] * size[axis]);
+        rhoY += (dy[axis] * size[axis]) * (dy[axis] * size[axis]);
+    }
+    const float rho = std::max(rhoX, rhoY);
+    if (!(rho > 0.0f)) {
+        return -1000.0f;
+    }
+    return 0.5f * std::log2(rho);
+}
+
+std::byte* SoftwareTexture::Locate(SoftwareImageDim dim, bool arrayed, const int32_t (&coord)[4],
+                                   uint32_t mipLevel) const {
+    int32_t x = coord[0];
+    int32_t y = 0;
+    int32_t z = 0;
+    int32_t layer = 0;
+    switch (dim) {
+        case SoftwareImageDim::Dim1D:
+            layer = arrayed ? coord[1] : 0;
+            break;
+        case SoftwareImageDim::Dim2D:
+            y = coord[1];
+            layer = arrayed ? coord[2] : 0;
+            break;
+        case SoftwareImageDim::Dim3D:
+            y = coord[1];
+            z = coord[2];
+            break;
+        case SoftwareImageDim::Cube:
+            // Cube images address layer-faces directly
+            y = coord[1];
+            layer = coord[2];
+            break;
+    }
+
+    const int32_t width = int32_t(GetMipWidth(mipLevel));
+    const int32_t height = int32_t(GetMipHeight(mipLevel));
+    const int32_t depth = int32_t(GetMipDepth(mipLevel));
+    if (x < 0 || y < 0 || z < 0 || layer < 0 || x >= width || y >= height || z >= depth ||
+        layer >= int32_t(m_layerCount)) {
+        return nullptr;
+    }
+    const size_t texel = (size_t(z) * height + y) * width + x;
+    return GetSubresource(mipLevel, uint32_t(layer)) + texel * m_texelSize;
+}
+
+void SoftwareTexture::Fetch(SoftwareImageDim dim, bool arrayed, const int32_t (&coord)[4],
+                            int32_t mipLevel, uint32_t (&result)[4]) const {
+    const std::byte* texel = mipLevel >= 0 && uint32_t(mipLevel) < m_mipLevels
+                                 ? Locate(dim, arrayed, coord, uint32_t(mipLevel))
+                                 : nullptr;
+    if (!texel) {
+        std::fill_n(result, 4, 0u);
+        return;
+    }
+    SoftwareFormatUtils::Decode(m_format, texel, result);
+}
+
+void SoftwareTexture::Store(SoftwareImageDim dim, bool arrayed, const int32_t (&coord)[4],
+                            const uint32_t (&words)[4]) {
+    if (std::byte* texel = Locate(dim, arrayed, coord, 0)) {
+        SoftwareFormatUtils::Encode(m_format, words, texel);
+    }
+}
+
+void SoftwareTexture::QuerySize(SoftwareImageDim dim, bool arrayed, int32_t mipLevel,
+                                uint32_t (&size)[4]) const {
+    std::fill_n(size, 4, 0u);
+    if (mipLevel < 0 || uint32_t(mipLevel) >= m_mipLevels) {
+        return;
+    }
+    const uint32_t mip = uint32_t(mipLevel);
+    size[0] = GetMipWidth(mip);
+    switch (dim) {
+        case SoftwareImageDim::Dim1D:
+            size[1] = arrayed ? m_layerCount : 0;
+            break;
+        case SoftwareImageDim::Dim2D:
+            size[1] = GetMipHeight(mip);
+            size[2] = arrayed ? m_layerCount : 0;
+            break;
+        case SoftwareImageDim::Dim3D:
+            size[1] = GetMipHeight(mip);
+            size[2] = GetMipDepth(mip);
+            break;
+        case SoftwareImageDim::Cube:
+            size[1] = GetMipHeight(mip);
+            size[2] = arrayed ? m_layerCount / 6 : 0;
+            break;
+    }
+}
+
+} // namespace VRHI
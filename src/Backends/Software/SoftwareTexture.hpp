@@ -0,0 +1,136 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/VRHI.hpp>
+#include <VRHI/Resources.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <vector>
+
+namespace VRHI {
+
+/// How a shader addresses an image, from its SPIR-V image type
+enum class SoftwareImageDim : uint8_t {
+    Dim1D,
+    Dim2D,
+    Dim3D,
+    Cube,
+};
+
+/// One filtered lookup issued by a shader invocation
+struct SoftwareSampleRequest {
+    SoftwareImageDim dim = SoftwareImageDim::Dim2D;
+    bool arrayed = false;
+    float coord[4] = {};        // Normalized coordinates, then the array layer
+    float lod = 0.0f;           // Before the sampler's bias and clamp
+    int32_t offset[3] = {};     // Texel offset of the ConstOffset operand
+    bool compare = false;       // Depth comparison against `reference`
+    float reference = 0.0f;
+};
+
+/// Software texture implementation
+///
+/// Every subresource is stored tightly packed in the layout described by
+/// SoftwareFormatUtils, layer-major with each layer's mip chain contiguous.
+/// Cube maps have six layers per cube, addressed as faces by Update() and
+/// friends. Multisampled textures are stored with a single sample.
+class SoftwareTexture : public Texture {
+public:
+    ~SoftwareTexture() override = default;
+
+    static std::expected<std::unique_ptr<Texture>, Error>
+    Create(const TextureDesc& desc);
+
+    // Texture interface
+    TextureType GetType() const noexcept override { return m_type; }
+    TextureFormat GetFormat() const noexcept override { return m_format; }
+    uint32_t GetWidth() const noexcept override { return m_width; }
+    uint32_t GetHeight() const noexcept override { return m_height; }
+    uint32_t GetDepth() const noexcept override { return m_depth; }
+    uint32_t GetMipLevels() const noexcept override { return m_mipLevels; }
+    uint32_t GetArrayLayers() const noexcept override { return m_arrayLayers; }
+
+    void Update(const void* data, size_t size,
+                uint32_t mipLevel = 0, uint32_t arrayLayer = 0) override;
+    void UpdateRegion(const void* data,
+                      uint32_t x, uint32_t y, uint32_t z,
+                      uint32_t width, uint32_t height, uint32_t depth,
+                      uint32_t mipLevel = 0, uint32_t arrayLayer = 0) override;
+
+    /// Box-filters every level from the one above it before returning;
+    /// `cmd` is not needed because nothing is deferred
+    void GenerateMipmaps(CommandBuffer* cmd) override;
+
+    void Read(void* data, size_t size,
+              uint32_t mipLevel = 0, uint32_t arrayLayer = 0) override;
+
+    // Software-specific
+    uint32_t GetTexelSize() const noexcept { return m_texelSize; }
+
+    /// Stored layers (six per cube)
+    uint32_t GetLayerCount() const noexcept { return m_layerCount; }
+
+    uint32_t GetMipWidth(uint32_t mipLevel) const noexcept;
+    uint32_t GetMipHeight(uint32_t mipLevel) const noexcept;
+    uint32_t GetMipDepth(uint32_t mipLevel) const noexcept;
+
+    /// Bytes of one layer of a mip level
+    size_t GetSubresourceSize(uint32_t mipLevel) const noexcept;
+
+    /// First texel of one layer of a mip level
+    std::byte* GetSubresource(uint32_t mipLevel, uint32_t arrayLayer) const noexcept;
+
+    /// Filtered lookup, as OpImageSample* and OpImageSampleDref*
+    void Sample(const SamplerDesc& sampler, const SoftwareSampleRequest& request,
+                uint32_t (&result)[4]) const;
+
+    /// Level of detail of a lookup whose coordinates change by `ddx` and
+    /// `ddy` between neighbouring pixels
+    float ComputeLod(const SoftwareSampleRequest& request,
+                     const float (&ddx)[3], const float (&ddy)[3]) const;
+
+    /// Unfiltered texel read, as OpImageFetch and OpImageRead; texels
+    /// outside the image read as zero
+    void Fetch(SoftwareImageDim dim, bool arrayed, const int32_t (&coord)[4],
+               int32_t mipLevel, uint32_t (&result)[4]) const;
+
+    /// Texel write to mip level 0, as OpImageWrite; writes outside the
+    /// image are dropped
+    void Store(SoftwareImageDim dim, bool arrayed, const int32_t (&coord)[4],
+               const uint32_t (&words)[4]);
+
+    /// Size of a mip level as OpImageQuerySize* reports it
+    void QuerySize(SoftwareImageDim dim, bool arrayed, int32_t mipLevel,
+                   uint32_t (&size)[4]) const;
+
+private:
+    explicit SoftwareTexture(const TextureDesc& desc);
+
+    struct Level;
+
+    /// Texel address of `coord`, or null when it is outside the image
+    std::byte* Locate(SoftwareImageDim dim, bool arrayed, const int32_t (&coord)[4],
+                      uint32_t mipLevel) const;
+
+    void SampleLevel(const SamplerDesc& sampler, const SoftwareSampleRequest& request,
+                     const Level& level, bool linear, float (&result)[4]) const;
+
+    TextureType m_type;
+    TextureFormat m_format;
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_depth;
+    uint32_t m_mipLevels;
+    uint32_t m_arrayLayers;
+    uint32_t m_layerCount = 1;
+    uint32_t m_texelSize = 0;
+    size_t m_layerStride = 0;
+    std::vector<size_t> m_mipOffsets;
+    std::unique_ptr<std::byte[]> m_data;
+};
+
+} // namespace VRHI
@@ -0,0 +1,135 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "VulkanBackend.hpp"
+#include "VulkanDevice.hpp"
+#include "VulkanInstance.hpp"
+#include <VRHI/BackendScoring.hpp>
+#include <VRHI/Logging.hpp>
+
+namespace VRHI {
+
+VulkanBackend::VulkanBackend() = default;
+
+VulkanBackend::~VulkanBackend() = default;
+
+BackendType VulkanBackend::GetType() const noexcept {
+    return BackendType::Vulkan;
+}
+
+std::string_view VulkanBackend::GetName() const noexcept {
+    return "Vulkan";
+}
+
+Version VulkanBackend::GetVersion() const noexcept {
+    return Version{1, 2, 0, "1.2"};
+}
+
+bool VulkanBackend::DetectFeatures() const {
+    if (!m_probed) {
+        m_probed = true;
+        auto instance = VulkanInstance::Create(false);
+        if (!instance) {
+            LogInfo("Vulkan backend unavailable: %s", instance.error().message.c_str());
+            return false;
+        }
+        m_instance = std::move(*instance);
+        m_features = m_instance->DetectFeatures();
+    }
+    return m_instance != nullptr;
+}
+
+std::expected<FeatureSet, Error> VulkanBackend::GetSupportedFeatures() const {
+    if (!DetectFeatures()) {
+        return std::unexpected(Error{
+            Error::Code::UnsupportedFeature,
+            "No Vulkan driver with a suitable device is installed"
+        });
+    }
+    return m_features;
+}
+
+bool VulkanBackend::IsFeatureSupported(Feature feature) const noexcept {
+    if (!DetectFeatures()) {
+        return false;
+    }
+
+    switch (feature) {
+        case Feature::DebugMarkers: return m_instance->HasDebugUtils();
+        case Feature::GPUValidation: return false;  // Only known once a device asked for it
+        default: return VRHI::IsFeatureSupported(m_features, feature);
+    }
+}
+
+float VulkanBackend::CalculateScore(const FeatureRequirements& requirements) const {
+    if (!DetectFeatures()) {
+        return -1.0f;
+    }
+
+    for (const auto& feature : requirements.required) {
+        if (!IsFeatureSupported(feature)) {
+            return -1.0f;
+        }
+    }
+
+    return BackendScorer::CalculateScore(GetType(), m_features, requirements);
+}
+
+std::expected<std::unique_ptr<Device>, Error>
+VulkanBackend::CreateDevice(const DeviceConfig& config) {
+    // Validation layers must be enabled when the instance is created
+    std::shared_ptr<VulkanInstance> instance;
+    if (config.enableValidation) {
+        auto validated = VulkanInstance::Create(true);
+        if (!validated) {
+            return std::unexpected(validated.error());
+        }
+        instance = std::move(*validated);
+    } else {
+        if (!DetectFeatures()) {
+            return std::unexpected(Error{
+                Error::Code::UnsupportedFeature,
+                "No Vulkan driver with a suitable device is installed"
+            });
+        }
+        instance = m_instance;
+    }
+
+    if (config.windowHandle) {
+        LogWarning("The Vulkan backend has no swap chain yet; the window is not presented to");
+    }
+
+    auto device = std::make_unique<VulkanDevice>(config, std::move(instance));
+    auto initResult = device->Initialize();
+    if (!initResult) {
+        return std::unexpected(initResult.error());
+    }
+    return device;
+}
+
+} // namespace VRHI
+
+// Register the backend with the factory
+namespace {
+    struct VulkanBackendRegistrar {
+        VulkanBackendRegistrar() {
+            VRHI::BackendFactory::RegisterBackend(
+                VRHI::BackendType::Vulkan,
+                []() -> std::unique_ptr<VRHI::IBackend> {
+                    return std::make_unique<VRHI::VulkanBackend>();
+                }
+            );
+        }
+    };
+    static VulkanBackendRegistrar s_vulkanRegistrar;
+}
+
+// Export registration function for explicit initialization
+namespace VRHI {
+namespace detail {
+    void RegisterVulkanBackend() {
+        // Force the static registrar to be instantiated
+        (void)&s_vulkanRegistrar;
+    }
+}
+}
@@ -0,0 +1,46 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/Backend.hpp>
+#include <memory>
+
+namespace VRHI {
+
+class VulkanInstance;
+
+/// Vulkan backend implementation
+///
+/// Headless: devices render to textures and framebuffers but have no swap
+/// chain yet. The Vulkan library is loaded at runtime, and the backend
+/// scores -1 when it or a suitable device is missing, so Auto never picks
+/// it on machines without Vulkan.
+class VulkanBackend : public IBackend {
+public:
+    VulkanBackend();
+    ~VulkanBackend() override;
+
+    // IBackend implementation
+    BackendType GetType() const noexcept override;
+    std::string_view GetName() const noexcept override;
+    Version GetVersion() const noexcept override;
+
+    std::expected<FeatureSet, Error> GetSupportedFeatures() const override;
+    bool IsFeatureSupported(Feature feature) const noexcept override;
+
+    float CalculateScore(const FeatureRequirements& requirements) const override;
+
+    std::expected<std::unique_ptr<Device>, Error>
+    CreateDevice(const DeviceConfig& config) override;
+
+private:
+    /// Create the probe instance on first use
+    bool DetectFeatures() const;
+
+    mutable std::shared_ptr<VulkanInstance> m_instance;
+    mutable FeatureSet m_features;
+    mutable bool m_probed = false;
+};
+
+} // namespace VRHI
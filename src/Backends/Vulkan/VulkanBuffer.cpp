@@ -0,0 +1,212 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "VulkanBuffer.hpp"
+#include "VulkanDevice.hpp"
+#include <VRHI/Logging.hpp>
+#include <cstring>
+
+namespace VRHI {
+
+namespace {
+    VkBufferUsageFlags GetBufferUsage(BufferUsage usage) {
+        auto has = [usage](BufferUsage flag) {
+            return static_cast<uint32_t>(usage & flag) != 0;
+        };
+        // Transfers are always allowed: updates and reads may go through staging copies
+        VkBufferUsageFlags flags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        if (has(BufferUsage::Vertex)) flags |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+        if (has(BufferUsage::Index)) flags |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+        if (has(BufferUsage::Uniform)) flags |= VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+        if (has(BufferUsage::Storage)) flags |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        if (has(BufferUsage::Indirect)) flags |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+        return flags;
+    }
+
+    constexpr VkMemoryPropertyFlags HostMemory =
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+    /// vkCmdUpdateBuffer takes at most 64 KiB, in multiples of 4 bytes
+    bool FitsInlineUpdate(size_t size, size_t offset) {
+        return size <= 65536 && size % 4 == 0 && offset % 4 == 0;
+    }
+}
+
+VulkanBuffer::VulkanBuffer(VulkanDevice& device, const BufferDesc& desc, VkBuffer buffer, VkDeviceMemory memory, void* mapped)
+    : m_device(&device)
+    , m_desc(desc)
+    , m_buffer(buffer)
+    , m_memory(memory)
+    , m_mapped(static_cast<std::byte*>(mapped))
+{
+}
+
+VulkanBuffer::~VulkanBuffer() {
+    // The memory is unmapped implicitly when it is freed
+    m_device->Retire(VK_OBJECT_TYPE_BUFFER, ToObjectHandle(m_buffer), m_memory);
+}
+
+std::expected<std::unique_ptr<Buffer>, Error>
+VulkanBuffer::Create(VulkanDevice& device, const BufferDesc& desc) {
+    if (desc.size == 0) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Buffer size must be greater than 0"
+        });
+    }
+
+    VkBufferCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    createInfo.size = desc.size;
+    createInfo.usage = GetBufferUsage(desc.usage);
+    createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkDevice handle = device.GetHandle();
+    VkBuffer buffer = VK_NULL_HANDLE;
+    if (vkCreateBuffer(handle, &createInfo, nullptr, &buffer) != VK_SUCCESS) {
+        return std::unexpected(Error{
+            Error::Code::InitializationFailed,
+            "Failed to create Vulkan buffer"
+        });
+    }
+
+    VkMemoryRequirements requirements{};
+    vkGetBufferMemoryRequirements(handle, buffer, &requirements);
+
+    // GpuOnly data prefers device-local memory; everything the CPU touches must be mappable
+    VkMemoryPropertyFlags required = HostMemory;
+    VkMemoryPropertyFlags preferred = 0;
+    switch (desc.memoryAccess) {
+        case MemoryAccess::GpuOnly:
+            required = 0;
+            preferred = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+            break;
+        case MemoryAccess::GpuToCpu:
+            preferred = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+            break;
+        default:
+            break;
+    }
+
+    VkMemoryPropertyFlags properties = 0;
+    auto memory = device.AllocateMemory(requirements, required, preferred, properties);
+    if (!memory) {
+        vkDestroyBuffer(handle, buffer, nullptr);
+        return std::unexpected(memory.error());
+    }
+    vkBindBufferMemory(handle, buffer, *memory, 0);
+
+    // Unified memory makes even GpuOnly buffers mappable
+    void* mapped = nullptr;
+    if ((properties & HostMemory) == HostMemory) {
+        vkMapMemory(handle, *memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+    }
+    device.SetObjectName(VK_OBJECT_TYPE_BUFFER, ToObjectHandle(buffer), desc.debugName);
+
+    auto result = std::unique_ptr<VulkanBuffer>(new VulkanBuffer(device, desc, buffer, *memory, mapped));
+    if (desc.initialData) {
+        result->Update(desc.initialData, desc.size);
+    }
+    return result;
+}
+
+size_t VulkanBuffer::GetSize() const noexcept {
+    return m_desc.size;
+}
+
+BufferUsage VulkanBuffer::GetUsage() const noexcept {
+    return m_desc.usage;
+}
+
+void* VulkanBuffer::Map() {
+    return Map(0, m_desc.size);
+}
+
+void* VulkanBuffer::Map(size_t offset, size_t size) {
+    if (m_isMapped) {
+        LogWarning("Buffer already mapped");
+    }
+    if (offset + size > m_desc.size) {
+        LogError("Buffer map out of bounds");
+        return nullptr;
+    }
+
+    m_isMapped = true;
+    if (m_mapped) {
+        return m_mapped + offset;
+    }
+
+    m_mapCopy.resize(size);
+    m_mapOffset = offset;
+    Read(m_mapCopy.data(), size, offset);
+    return m_mapCopy.data();
+}
+
+void VulkanBuffer::Unmap() {
+    if (!m_isMapped) {
+        return;
+    }
+    m_isMapped = false;
+    if (!m_mapped) {
+        Update(m_mapCopy.data(), m_mapCopy.size(), m_mapOffset);
+        m_mapCopy.clear();
+    }
+}
+
+void VulkanBuffer::Update(const void* data, size_t size, size_t offset) {
+    if (offset + size > m_desc.size) {
+        LogError("Buffer update out of bounds");
+        return;
+    }
+    if (size == 0) {
+        return;
+    }
+
+    // Writing in place is only safe once the GPU has finished every earlier use
+    if (m_mapped && m_device->IsIdle()) {
+        std::memcpy(m_mapped + offset, data, size);
+        return;
+    }
+
+    VkCommandBuffer commands = m_device->GetUploadCommands();
+    if (FitsInlineUpdate(size, offset)) {
+        vkCmdUpdateBuffer(commands, m_buffer, offset, size, data);
+        return;
+    }
+
+    auto staging = m_device->CreateStagingBuffer(size, false);
+    if (!staging) {
+        LogError("Buffer update failed: %s", staging.error().message.c_str());
+        return;
+    }
+    std::memcpy(staging->data, data, size);
+    VkBufferCopy region{0, offset, size};
+    vkCmdCopyBuffer(commands, staging->buffer, m_buffer, 1, &region);
+    m_device->RetireStagingBuffer(*staging);
+}
+
+void VulkanBuffer::Read(void* data, size_t size, size_t offset) {
+    if (offset + size > m_desc.size) {
+        LogError("Buffer read out of bounds");
+        return;
+    }
+
+    if (m_mapped) {
+        m_device->WaitForSubmitted();
+        std::memcpy(data, m_mapped + offset, size);
+        return;
+    }
+
+    auto staging = m_device->CreateStagingBuffer(size, true);
+    if (!staging) {
+        LogError("Buffer read failed: %s", staging.error().message.c_str());
+        return;
+    }
+    VkBufferCopy region{offset, 0, size};
+    vkCmdCopyBuffer(m_device->GetUploadCommands(), m_buffer, staging->buffer, 1, &region);
+    m_device->WaitForSubmitted();
+    std::memcpy(data, staging->data, size);
+    m_device->RetireStagingBuffer(*staging);
+}
+
+} // namespace VRHI
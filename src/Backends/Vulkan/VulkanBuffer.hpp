@@ -0,0 +1,65 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/VRHI.hpp>
+#include <VRHI/Resources.hpp>
+#include "VulkanLoader.hpp"
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <vector>
+
+namespace VRHI {
+
+class VulkanDevice;
+
+/// Vulkan buffer implementation
+///
+/// Each buffer has its own allocation. Buffers the CPU accesses live in
+/// host-coherent memory that stays mapped; GpuOnly buffers prefer
+/// device-local memory and are written and read through staging copies.
+class VulkanBuffer : public Buffer {
+public:
+    ~VulkanBuffer() override;
+
+    static std::expected<std::unique_ptr<Buffer>, Error>
+    Create(VulkanDevice& device, const BufferDesc& desc);
+
+    // Buffer interface
+    size_t GetSize() const noexcept override;
+    BufferUsage GetUsage() const noexcept override;
+
+    /// Host-visible buffers return their persistent mapping without waiting
+    /// for the GPU; others return a copy of the range that Unmap() uploads
+    void* Map() override;
+    void* Map(size_t offset, size_t size) override;
+    void Unmap() override;
+
+    /// Ordered after all submitted work: written in place when the GPU is
+    /// idle, otherwise copied by the upload commands of the next submission
+    void Update(const void* data, size_t size, size_t offset = 0) override;
+
+    /// Waits for all submitted work
+    void Read(void* data, size_t size, size_t offset = 0) override;
+
+    // Vulkan-specific
+    VkBuffer GetHandle() const noexcept { return m_buffer; }
+
+private:
+    VulkanBuffer(VulkanDevice& device, const BufferDesc& desc, VkBuffer buffer, VkDeviceMemory memory, void* mapped);
+
+    VulkanDevice* m_device;
+    BufferDesc m_desc;
+    VkBuffer m_buffer;
+    VkDeviceMemory m_memory;
+    std::byte* m_mapped;  // Persistent mapping, null if not host-visible
+
+    // Map() of a buffer that is not host-visible
+    std::vector<std::byte> m_mapCopy;
+    size_t m_mapOffset = 0;
+    bool m_isMapped = false;
+};
+
+} // namespace VRHI
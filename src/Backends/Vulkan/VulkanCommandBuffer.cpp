@@ -0,0 +1,930 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "VulkanCommandBuffer.hpp"
+#include "VulkanDevice.hpp"
+#include "VulkanInstance.hpp"
+#include "VulkanBuffer.hpp"
+#include "VulkanPipeline.hpp"
+#include "VulkanTexture.hpp"
+#include "VulkanSampler.hpp"
+#include "VulkanRenderPass.hpp"
+#include "VulkanFramebuffer.hpp"
+#include "VulkanFormatUtils.hpp"
+#include <VRHI/Logging.hpp>
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstring>
+#include <optional>
+
+namespace VRHI {
+
+namespace {
+    constexpr VkShaderStageFlags PushConstantStages = VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT;
+
+    /// Translates a recorded command stream into a VkCommandBuffer.
+    /// Holds the state Vulkan needs at draw time but VRHI sets with separate
+    /// commands: pipelines are bound per render pass signature, descriptor
+    /// sets are built from the individual resource bindings, and push
+    /// constants are pushed in full. Redundant binds and dynamic state are
+    /// dropped, like the OpenGL state cache does.
+    ///
+    /// Hazards are handled like OpenGL handles them: a full barrier goes
+    /// before the next copy, dispatch or render pass once a copy, dispatch,
+    /// render pass or PipelineBarrier may have written memory.
+    class CommandTranslator {
+    public:
+        CommandTranslator(VulkanDevice& device, VkCommandBuffer commands, VulkanCommandBuffer::TranslateScratch& scratch)
+            : m_device(device)
+            , m_commands(commands)
+            , m_scratch(scratch)
+            , m_debugUtils(device.GetInstance().HasDebugUtils())
+            , m_multiDrawIndirect(device.GetEnabledFeatures().multiDrawIndirect)
+            , m_depthBounds(device.GetEnabledFeatures().depthBounds)
+        {
+            m_scratch.resources.clear();
+            for (int i = 0; i < 2; ++i) {
+                m_scratch.boundContents[i].clear();
+                m_scratch.boundOffsets[i].clear();
+            }
+        }
+
+        void Translate(const CommandStream& stream) {
+            for (const CommandHeader& header : stream) {
+                Dispatch(header);
+            }
+            if (m_inPass) {
+                LogWarning("Command buffer ends inside a render pass; ending it");
+                EndRenderPass();
+            }
+        }
+
+        uint64_t GetDrawCalls() const noexcept { return m_drawCalls; }
+        uint64_t GetStateChangesEmitted() const noexcept { return m_emitted; }
+        uint64_t GetStateChangesFiltered() const noexcept { return m_filtered; }
+
+    private:
+        /// Secondaries that Translate() inlines; others are skipped
+        static const RecordingCommandBuffer* GetReplayable(CommandBuffer* secondary) noexcept {
+            auto* recorded = static_cast<const RecordingCommandBuffer*>(secondary);
+            return recorded->GetState() == CommandBufferState::Recording ? nullptr : recorded;
+        }
+
+        /// Store `value` in `current` unless it is already there; state
+        /// starts out unknown, as it is in a new Vulkan command buffer
+        /// @return Whether the state call must be emitted
+        template<typename T>
+        bool Changed(std::optional<T>& current, const T& value) {
+            bool same;
+            if constexpr (std::equality_comparable<T>) {
+                same = current && *current == value;
+            } else {
+                same = current && std::memcmp(&*current, &value, sizeof(T)) == 0;
+            }
+            if (same) {
+                ++m_filtered;
+                return false;
+            }
+            current = value;
+            ++m_emitted;
+            return true;
+        }
+
+        void Dispatch(const CommandHeader& header) {
+            switch (header.type) {
+                case CommandType::BeginRenderPass:
+                    BeginRenderPass(header.As<CmdBeginRenderPass>());
+                    break;
+                case CommandType::EndRenderPass:
+                    if (m_inPass) {
+                        EndRenderPass();
+                    }
+                    break;
+                case CommandType::BindPipeline:
+                    BindPipeline(header.As<CmdBindPipeline>());
+                    break;
+                case CommandType::BindVertexBuffers:
+                    BindVertexBuffers(header.As<CmdBindVertexBuffers>());
+                    break;
+                case CommandType::BindIndexBuffer:
+                    BindIndexBuffer(header.As<CmdBindIndexBuffer>());
+                    break;
+                case CommandType::BindUniformBuffer: {
+                    const auto& cmd = header.As<CmdBindUniformBuffer>();
+                    BindBuffer(cmd.binding, cmd.buffer, cmd.offset, cmd.size);
+                    break;
+                }
+                case CommandType::BindStorageBuffer: {
+                    const auto& cmd = header.As<CmdBindStorageBuffer>();
+                    BindBuffer(cmd.binding, cmd.buffer, cmd.offset, cmd.size);
+                    break;
+                }
+                case CommandType::BindTexture:
+                    BindTexture(header.As<CmdBindTexture>());
+                    break;
+                case CommandType::PushConstants: {
+                    const auto& cmd = header.As<CmdPushConstants>();
+                    std::ranges::copy(cmd.GetData(), m_pushConstants.begin() + cmd.offset);
+                    m_pushConstantsDirty = true;
+                    break;
+                }
+                case CommandType::SetViewports: {
+                    // One viewport, as on OpenGL
+                    auto viewports = header.As<CmdSetViewports>().GetViewports();
+                    if (!viewports.empty()) {
+                        m_viewportSet = true;
+                        SetViewport(viewports[0]);
+                    }
+                    break;
+                }
+                case CommandType::SetScissors: {
+                    auto scissors = header.As<CmdSetScissors>().GetScissors();
+                    if (!scissors.empty()) {
+                        m_scissorSet = true;
+                        SetScissor(scissors[0]);
+                    }
+                    break;
+                }
+                case CommandType::SetLineWidth:
+                    SetLineWidth(header.As<CmdSetLineWidth>().width);
+                    break;
+                case CommandType::SetBlendConstants:
+                    SetBlendConstants(header.As<CmdSetBlendConstants>().constants);
+                    break;
+                case CommandType::SetDepthBias: {
+                    const auto& cmd = header.As<CmdSetDepthBias>();
+                    const float values[3] = {cmd.constantFactor, cmd.clamp, cmd.slopeFactor};
+                    SetDepthBias(values);
+                    break;
+                }
+                case CommandType::SetDepthBounds: {
+                    const auto& cmd = header.As<CmdSetDepthBounds>();
+                    const float values[2] = {cmd.minDepth, cmd.maxDepth};
+                    SetDepthBounds(values);
+                    break;
+                }
+                case CommandType::SetStencilCompareMask: {
+                    const auto& cmd = header.As<CmdSetStencilValue>();
+                    SetStencil(m_compareMask, cmd.frontFace ? 0 : 1, cmd.value, vkCmdSetStencilCompareMask);
+                    break;
+                }
+                case CommandType::SetStencilWriteMask: {
+                    const auto& cmd = header.As<CmdSetStencilValue>();
+                    SetStencil(m_writeMask, cmd.frontFace ? 0 : 1, cmd.value, vkCmdSetStencilWriteMask);
+                    break;
+                }
+                case CommandType::SetStencilReference: {
+                    const auto& cmd = header.As<CmdSetStencilValue>();
+                    SetStencil(m_reference, cmd.frontFace ? 0 : 1, cmd.value, vkCmdSetStencilReference);
+                    break;
+                }
+                case CommandType::Draw: {
+                    const DrawParams& params = header.As<CmdDraw>().params;
+                    if (FlushDraw()) {
+                        vkCmdDraw(m_commands, params.vertexCount, params.instanceCount,
+                                  params.firstVertex, params.firstInstance);
+                        ++m_drawCalls;
+                    }
+                    break;
+                }
+                case CommandType::DrawIndexed: {
+                    const DrawIndexedParams& params = header.As<CmdDrawIndexed>().params;
+                    if (FlushDraw()) {
+                        vkCmdDrawIndexed(m_commands, params.indexCount, params.instanceCount, params.firstIndex,
+                                         params.vertexOffset, params.firstInstance);
+                        ++m_drawCalls;
+                    }
+                    break;
+                }
+                case CommandType::DrawIndirect:
+                    DrawIndirect(header.As<CmdDrawIndirect>(), false);
+                    break;
+                case CommandType::DrawIndexedIndirect:
+                    DrawIndirect(header.As<CmdDrawIndexedIndirect>(), true);
+                    break;
+                case CommandType::Dispatch: {
+                    const DispatchParams& params = header.As<CmdDispatch>().params;
+                    if (FlushDispatch()) {
+                        vkCmdDispatch(m_commands, params.groupCountX, params.groupCountY, params.groupCountZ);
+                    }
+                    break;
+                }
+                case CommandType::DispatchIndirect: {
+                    const auto& cmd = header.As<CmdDispatchIndirect>();
+                    if (!cmd.buffer) {
+                        LogWarning("DispatchIndirect called with null buffer");
+                        break;
+                    }
+                    if (FlushDispatch()) {
+                        vkCmdDispatchIndirect(m_commands, static_cast<VulkanBuffer*>(cmd.buffer)->GetHandle(), cmd.offset);
+                    }
+                    break;
+                }
+                case CommandType::ClearColorAttachment: {
+                    const auto& cmd = header.As<CmdClearColorAttachment>();
+                    VkClearAttachment clear{VK_IMAGE_ASPECT_COLOR_BIT, cmd.attachment, {}};
+                    std::memcpy(clear.clearValue.color.float32, cmd.color.float32, sizeof(float) * 4);
+                    ClearAttachment(clear, cmd.rect);
+                    break;
+                }
+                case CommandType::ClearDepthStencilAttachment: {
+                    const auto& cmd = header.As<CmdClearDepthStencilAttachment>();
+                    VkClearAttachment clear{GetDepthAspects(), 0, {}};
+                    clear.clearValue.depthStencil = {cmd.value.depth, cmd.value.stencil};
+                    ClearAttachment(clear, cmd.rect);
+                    break;
+                }
+                case CommandType::CopyBuffer:
+                    CopyBuffer(header.As<CmdCopyBuffer>());
+                    break;
+                case CommandType::CopyBufferToTexture:
+                    CopyBufferToTexture(header.As<CmdCopyBufferToTexture>());
+                    break;
+                case CommandType::CopyTextureToBuffer:
+                    CopyTextureToBuffer(header.As<CmdCopyTextureToBuffer>());
+                    break;
+                case CommandType::CopyTexture:
+                    CopyTexture(header.As<CmdCopyTexture>());
+                    break;
+                case CommandType::PipelineBarrier:
+                    // Inside a pass there is nothing to order against
+                    if (!m_inPass) {
+                        m_pendingWrites = true;
+                    }
+                    break;
+                case CommandType::BeginDebugMarker:
+                    if (m_debugUtils) {
+                        VkDebugUtilsLabelEXT label = GetLabel(header.As<CmdBeginDebugMarker>());
+                        vkCmdBeginDebugUtilsLabelEXT(m_commands, &label);
+                    }
+                    break;
+                case CommandType::EndDebugMarker:
+                    if (m_debugUtils) {
+                        vkCmdEndDebugUtilsLabelEXT(m_commands);
+                    }
+                    break;
+                case CommandType::InsertDebugMarker:
+                    if (m_debugUtils) {
+                        VkDebugUtilsLabelEXT label = GetLabel(header.As<CmdInsertDebugMarker>());
+                        vkCmdInsertDebugUtilsLabelEXT(m_commands, &label);
+                    }
+                    break;
+                case CommandType::ExecuteCommands:
+                    // Secondaries are inlined from their own streams, so a
+                    // bundle recorded once can be executed every frame
+                    for (CommandBuffer* secondary : header.As<CmdExecuteCommands>().GetCommandBuffers()) {
+                        const RecordingCommandBuffer* recorded = GetReplayable(secondary);
+                        if (!recorded) {
+                            LogWarning("Skipping a secondary command buffer that is still recording");
+                            continue;
+                        }
+                        for (const CommandHeader& inner : recorded->GetCommandStream()) {
+                            Dispatch(inner);
+                        }
+                    }
+                    break;
+            }
+        }
+
+        static VkDebugUtilsLabelEXT GetLabel(const CmdDebugMarker& cmd) {
+            VkDebugUtilsLabelEXT label{};
+            label.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+            label.pLabelName = cmd.GetName();
+            if (cmd.hasColor) {
+                std::memcpy(label.color, cmd.color, sizeof(label.color));
+            }
+            return label;
+        }
+
+        // ====================================================================
+        // Barriers
+        // ====================================================================
+
+        /// Order the next transfer, dispatch or pass after earlier writes
+        void FlushWrites() {
+            if (m_pendingWrites) {
+                VulkanDevice::RecordFullBarrier(m_commands);
+                m_pendingWrites = false;
+            }
+        }
+
+        /// Work outside render passes; a warning inside one
+        bool RequireOutsidePass(const char* command) {
+            if (m_inPass) {
+                LogWarning("%s is not allowed inside a render pass; skipped", command);
+                return false;
+            }
+            FlushWrites();
+            m_pendingWrites = true;
+            return true;
+        }
+
+        // ====================================================================
+        // Render Passes
+        // ====================================================================
+
+        void BeginRenderPass(const CmdBeginRenderPass& cmd) {
+            if (m_inPass) {
+                LogWarning("BeginRenderPass inside a render pass; ending the previous one");
+                EndRenderPass();
+            }
+            auto* framebuffer = static_cast<VulkanFramebuffer*>(cmd.framebuffer);
+            if (!framebuffer) {
+                LogWarning("The Vulkan backend has no swap chain; a render pass without a framebuffer is skipped");
+                return;
+            }
+
+            auto* renderPass = static_cast<const VulkanRenderPass*>(cmd.renderPass);
+            VkRenderPass handle = framebuffer->GetRenderPass(renderPass);
+            if (handle == VK_NULL_HANDLE) {
+                LogError("Failed to create a Vulkan render pass; the pass is skipped");
+                return;
+            }
+            FlushWrites();
+
+            // Confine the render area to the framebuffer
+            const int32_t x = std::max(cmd.renderArea.x, 0);
+            const int32_t y = std::max(cmd.renderArea.y, 0);
+            const auto right = std::min<int64_t>(int64_t(cmd.renderArea.x) + cmd.renderArea.width, framebuffer->GetWidth());
+            const auto bottom = std::min<int64_t>(int64_t(cmd.renderArea.y) + cmd.renderArea.height, framebuffer->GetHeight());
+            m_renderArea = {{x, y}, {static_cast<uint32_t>(std::max<int64_t>(right - x, 0)),
+                                     static_cast<uint32_t>(std::max<int64_t>(bottom - y, 0))}};
+
+            auto clearValues = cmd.GetClearValues();
+            const auto& attachments = framebuffer->GetAttachments();
+            m_scratch.clearValues.clear();
+            for (size_t i = 0; i < attachments.size(); ++i) {
+                const ClearValue value = i < clearValues.size() ? clearValues[i] : ClearValue{};
+                VkClearValue clear{};
+                if (VulkanFormatUtils::IsDepthStencilFormat(attachments[i]->GetFormat())) {
+                    clear.depthStencil = {value.depthStencil.depth, value.depthStencil.stencil};
+                } else {
+                    std::memcpy(clear.color.float32, value.color.float32, sizeof(float) * 4);
+                }
+                m_scratch.clearValues.push_back(clear);
+            }
+
+            VkRenderPassBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            beginInfo.renderPass = handle;
+            beginInfo.framebuffer = framebuffer->GetHandle();
+            beginInfo.renderArea = m_renderArea;
+            beginInfo.clearValueCount = static_cast<uint32_t>(m_scratch.clearValues.size());
+            beginInfo.pClearValues = m_scratch.clearValues.data();
+            vkCmdBeginRenderPass(m_commands, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+            m_inPass = true;
+            m_framebuffer = framebuffer;
+            m_renderPass = handle;
+
+            // Draw where the pass renders until told otherwise
+            if (!m_viewportSet) {
+                SetViewport(Viewport{float(m_renderArea.offset.x), float(m_renderArea.offset.y),
+                                     float(m_renderArea.extent.width), float(m_renderArea.extent.height), 0.0f, 1.0f});
+            }
+            if (!m_scissorSet) {
+                SetScissor(Rect2D{m_renderArea.offset.x, m_renderArea.offset.y,
+                                  m_renderArea.extent.width, m_renderArea.extent.height});
+            }
+        }
+
+        void EndRenderPass() {
+            vkCmdEndRenderPass(m_commands);
+            m_inPass = false;
+            m_framebuffer = nullptr;
+            m_renderPass = VK_NULL_HANDLE;
+            m_pendingWrites = true;
+        }
+
+        VkImageAspectFlags GetDepthAspects() const {
+            if (m_framebuffer) {
+                for (const VulkanTexture* attachment : m_framebuffer->GetAttachments()) {
+                    if (VulkanFormatUtils::IsDepthStencilFormat(attachment->GetFormat())) {
+                        return VulkanFormatUtils::GetAspectMask(attachment->GetFormat());
+                    }
+                }
+            }
+            return VK_IMAGE_ASPECT_DEPTH_BIT;
+        }
+
+        void ClearAttachment(const VkClearAttachment& clear, const Rect2D& rect) {
+            if (!m_inPass) {
+                LogWarning("Attachment clears are only allowed inside a render pass; skipped");
+                return;
+            }
+            if (rect.width == 0 || rect.height == 0) {
+                return;
+            }
+            VkClearRect clearRect{};
+            clearRect.rect = {{rect.x, rect.y}, {rect.width, rect.height}};
+            clearRect.layerCount = 1;
+            vkCmdClearAttachments(m_commands, 1, &clear, 1, &clearRect);
+        }
+
+        // ====================================================================
+        // State
+        // ====================================================================
+
+        void BindPipeline(const CmdBindPipeline& cmd) {
+            auto* pipeline = static_cast<VulkanPipeline*>(cmd.pipeline);
+            if (!pipeline) {
+                return;
+            }
+            if (pipeline->GetType() == PipelineType::Compute) {
+                m_computePipeline = pipeline;
+                return;
+            }
+            if (pipeline != m_graphicsPipeline) {
+                m_graphicsPipeline = pipeline;
+                m_pipelineStateDirty = true;
+            }
+        }
+
+        void BindVertexBuffers(const CmdBindVertexBuffers& cmd) {
+            auto buffers = cmd.GetBuffers();
+            auto offsets = cmd.GetOffsets();
+            for (size_t i = 0; i < buffers.size(); ++i) {
+                const uint32_t binding = cmd.firstBinding + static_cast<uint32_t>(i);
+                if (binding >= m_vertexBuffers.size()) {
+                    LogWarning("BindVertexBuffers binding index exceeds the supported vertex bindings");
+                    break;
+                }
+                if (!buffers[i]) {
+                    continue;
+                }
+                const VertexBufferBinding value{static_cast<VulkanBuffer*>(buffers[i])->GetHandle(), offsets[i]};
+                if (Changed(m_vertexBuffers[binding], value)) {
+                    vkCmdBindVertexBuffers(m_commands, binding, 1, &value.buffer, &value.offset);
+                }
+            }
+        }
+
+        void BindIndexBuffer(const CmdBindIndexBuffer& cmd) {
+            if (!cmd.buffer) {
+                LogWarning("BindIndexBuffer called with null buffer");
+                return;
+            }
+            const IndexBufferBinding value{static_cast<VulkanBuffer*>(cmd.buffer)->GetHandle(), cmd.offset,
+                                           cmd.use16BitIndices ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32};
+            if (Changed(m_indexBuffer, value)) {
+                vkCmdBindIndexBuffer(m_commands, value.buffer, value.offset, value.type);
+            }
+        }
+
+        VulkanCommandBuffer::TranslateScratch::Resource& GetResource(uint32_t binding) {
+            if (binding >= m_scratch.resources.size()) {
+                m_scratch.resources.resize(binding + 1);
+            }
+            return m_scratch.resources[binding];
+        }
+
+        void BindBuffer(uint32_t binding, Buffer* buffer, uint64_t offset, uint64_t size) {
+            if (!buffer) {
+                LogWarning("Binding a null buffer");
+                return;
+            }
+            auto& resource = GetResource(binding);
+            resource = {};
+            resource.buffer = static_cast<VulkanBuffer*>(buffer)->GetHandle();
+            resource.offset = offset;
+            resource.range = size == 0 ? buffer->GetSize() - offset : size;
+        }
+
+        void BindTexture(const CmdBindTexture& cmd) {
+            if (!cmd.texture) {
+                LogWarning("BindTexture called with null texture");
+                return;
+            }
+            auto& resource = GetResource(cmd.binding);
+            resource = {};
+            resource.texture = static_cast<const VulkanTexture*>(cmd.texture);
+            resource.sampler = cmd.sampler ? static_cast<VulkanSampler*>(cmd.sampler)->GetHandle()
+                                           : m_device.GetDefaultSampler();
+        }
+
+        void SetViewport(const Viewport& viewport) {
+            const VkViewport value{viewport.x, viewport.y, viewport.width, viewport.height,
+                                   viewport.minDepth, viewport.maxDepth};
+            if (Changed(m_viewport, value)) {
+                vkCmdSetViewport(m_commands, 0, 1, &value);
+            }
+        }
+
+        void SetScissor(const Rect2D& scissor) {
+            const VkRect2D value{{std::max(scissor.x, 0), std::max(scissor.y, 0)}, {scissor.width, scissor.height}};
+            if (Changed(m_scissor, value)) {
+                vkCmdSetScissor(m_commands, 0, 1, &value);
+            }
+        }
+
+        void SetLineWidth(float width) {
+            if (Changed(m_lineWidth, width)) {
+                vkCmdSetLineWidth(m_commands, width);
+            }
+        }
+
+        void SetBlendConstants(const float (&constants)[4]) {
+            std::array<float, 4> value;
+            std::ranges::copy(constants, value.begin());
+            if (Changed(m_blendConstants, value)) {
+                vkCmdSetBlendConstants(m_commands, constants);
+            }
+        }
+
+        void SetDepthBias(const float (&values)[3]) {
+            std::array<float, 3> value;
+            std::ranges::copy(values, value.begin());
+            if (Changed(m_depthBias, value)) {
+                vkCmdSetDepthBias(m_commands, values[0], values[1], values[2]);
+            }
+        }
+
+        void SetDepthBounds(const float (&values)[2]) {
+            if (!m_depthBounds) {
+                return;
+            }
+            std::array<float, 2> value;
+            std::ranges::copy(values, value.begin());
+            if (Changed(m_depthBoundsValues, value)) {
+                vkCmdSetDepthBounds(m_commands, values[0], values[1]);
+            }
+        }
+
+        /// Set one face of a stencil state; `face` is 0 for front, 1 for back
+        void SetStencil(std::array<std::optional<uint32_t>, 2>& current, int face, uint32_t value,
+                        PFN_vkCmdSetStencilCompareMask set) {
+            if (Changed(current[face], value)) {
+                set(m_commands, face == 0 ? VK_STENCIL_FACE_FRONT_BIT : VK_STENCIL_FACE_BACK_BIT, value);
+            }
+        }
+
+        /// Set the state the bound graphics pipeline does not leave to commands
+        void ApplyPipelineState(const VulkanPipelineState& state) {
+            if (state.lineWidth) {
+                SetLineWidth(state.lineWidthValue);
+            }
+            if (state.depthBias) {
+                SetDepthBias(state.depthBiasValues);
+            }
+            if (state.blendConstants) {
+                SetBlendConstants(state.blendConstantValues);
+            }
+            if (state.stencil) {
+                for (int face = 0; face < 2; ++face) {
+                    SetStencil(m_compareMask, face, state.compareMask[face], vkCmdSetStencilCompareMask);
+                    SetStencil(m_writeMask, face, state.writeMask[face], vkCmdSetStencilWriteMask);
+                    SetStencil(m_reference, face, state.reference[face], vkCmdSetStencilReference);
+                }
+            }
+            if (state.depthBounds) {
+                SetDepthBounds(state.depthBoundsValues);
+            }
+        }
+
+        // ====================================================================
+        // Draws and Dispatches
+        // ====================================================================
+
+        /// Bind what a draw needs
+        /// @return false if the draw must be skipped
+        bool FlushDraw() {
+            if (!m_inPass) {
+                LogWarning("Draws are only allowed inside a render pass; skipped");
+                return false;
+            }
+            if (!m_graphicsPipeline) {
+                LogWarning("Draw without a graphics pipeline; skipped");
+                return false;
+            }
+
+            VkPipeline handle = m_graphicsPipeline->GetHandle(m_framebuffer->GetSignature(), m_renderPass);
+            if (handle == VK_NULL_HANDLE) {
+                return false;
+            }
+            if (Changed(m_boundGraphics, handle)) {
+                vkCmdBindPipeline(m_commands, VK_PIPELINE_BIND_POINT_GRAPHICS, handle);
+            }
+            if (m_pipelineStateDirty) {
+                ApplyPipelineState(m_graphicsPipeline->GetState());
+                m_pipelineStateDirty = false;
+            }
+            return FlushResources(*m_graphicsPipeline, 0);
+        }
+
+        bool FlushDispatch() {
+            if (!RequireOutsidePass("Dispatch")) {
+                return false;
+            }
+            if (!m_computePipeline) {
+                LogWarning("Dispatch without a compute pipeline; skipped");
+                return false;
+            }
+            if (Changed(m_boundCompute, m_computePipeline->GetHandle())) {
+                vkCmdBindPipeline(m_commands, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline->GetHandle());
+            }
+            return FlushResources(*m_computePipeline, 1);
+        }
+
+        /// Bind the descriptor set and push constants of `pipeline`.
+        /// A set is only written when the resources differ from the last
+        /// one; other buffer ranges are reached through dynamic offsets.
+        bool FlushResources(const VulkanPipeline& pipeline, int bindPoint) {
+            const auto& bindings = pipeline.GetBindings();
+            auto& contents = m_scratch.contents;
+            auto& offsets = m_scratch.offsets;
+            contents.clear();
+            offsets.clear();
+            for (const VulkanDescriptorBinding& binding : bindings) {
+                const auto* resource = binding.binding < m_scratch.resources.size()
+                    ? &m_scratch.resources[binding.binding] : nullptr;
+                const bool isBuffer = binding.type != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER &&
+                                      binding.type != VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                if (!resource || (isBuffer ? resource->buffer == VK_NULL_HANDLE : resource->texture == nullptr)) {
+                    LogWarning("Nothing bound at binding %u, which the pipeline uses; skipped", binding.binding);
+                    return false;
+                }
+
+                if (!isBuffer) {
+                    const bool storage = binding.type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                    contents.push_back(ToObjectHandle(storage ? resource->texture->GetStorageView()
+                                                              : resource->texture->GetView()));
+                    contents.push_back(storage ? 0 : ToObjectHandle(resource->sampler));
+                    contents.push_back(resource->texture->GetLayout());
+                } else if (binding.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
+                           binding.type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC) {
+                    contents.push_back(ToObjectHandle(resource->buffer));
+                    contents.push_back(0);
+                    contents.push_back(resource->range);
+                    offsets.push_back(static_cast<uint32_t>(resource->offset));
+                } else {
+                    contents.push_back(ToObjectHandle(resource->buffer));
+                    contents.push_back(resource->offset);
+                    contents.push_back(resource->range);
+                }
+            }
+
+            const VkPipelineBindPoint vkBindPoint = pipeline.GetBindPoint();
+            const bool sameLayout = m_boundLayout[bindPoint] == pipeline.GetLayout();
+            if (!bindings.empty()) {
+                // Sets are compatible between pipelines sharing a set layout
+                const bool sameSet = m_boundSetLayout[bindPoint] == pipeline.GetSetLayout() &&
+                                     m_scratch.boundContents[bindPoint] == contents;
+                if (!sameSet) {
+                    VkDescriptorSet set = WriteDescriptorSet(pipeline);
+                    if (set == VK_NULL_HANDLE) {
+                        return false;
+                    }
+                    m_boundSet[bindPoint] = set;
+                    m_boundSetLayout[bindPoint] = pipeline.GetSetLayout();
+                    m_scratch.boundContents[bindPoint] = contents;
+                }
+                if (!sameSet || !sameLayout || m_scratch.boundOffsets[bindPoint] != offsets) {
+                    vkCmdBindDescriptorSets(m_commands, vkBindPoint, pipeline.GetLayout(), 0, 1, &m_boundSet[bindPoint],
+                                            static_cast<uint32_t>(offsets.size()), offsets.data());
+                    m_scratch.boundOffsets[bindPoint] = offsets;
+                    ++m_emitted;
+                } else {
+                    ++m_filtered;
+                }
+            }
+            m_boundLayout[bindPoint] = pipeline.GetLayout();
+
+            // All layouts share one push constant range, so pushed values
+            // stay valid across pipeline changes
+            if (m_pushConstantsDirty) {
+                vkCmdPushConstants(m_commands, pipeline.GetLayout(), PushConstantStages, 0,
+                                   MaxPushConstantSize, m_pushConstants.data());
+                m_pushConstantsDirty = false;
+                ++m_emitted;
+            }
+            return true;
+        }
+
+        VkDescriptorSet WriteDescriptorSet(const VulkanPipeline& pipeline) {
+            VkDescriptorSet set = m_device.AllocateDescriptorSet(pipeline.GetSetLayout());
+            if (set == VK_NULL_HANDLE) {
+                LogError("Failed to allocate a Vulkan descriptor set");
+                return VK_NULL_HANDLE;
+            }
+
+            const auto& bindings = pipeline.GetBindings();
+            auto& writes = m_scratch.writes;
+            auto& bufferInfos = m_scratch.bufferInfos;
+            auto& imageInfos = m_scratch.imageInfos;
+            writes.clear();
+            bufferInfos.clear();
+            imageInfos.clear();
+            bufferInfos.reserve(bindings.size());
+            imageInfos.reserve(bindings.size());
+
+            for (size_t i = 0; i < bindings.size(); ++i) {
+                const uint64_t* content = m_scratch.contents.data() + 3 * i;
+                VkWriteDescriptorSet write{};
+                write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                write.dstSet = set;
+                write.dstBinding = bindings[i].binding;
+                write.descriptorCount = 1;
+                write.descriptorType = bindings[i].type;
+                if (bindings[i].type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||
+                    bindings[i].type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE) {
+                    imageInfos.push_back({FromObjectHandle<VkSampler>(content[1]),
+                                          FromObjectHandle<VkImageView>(content[0]),
+                                          static_cast<VkImageLayout>(content[2])});
+                    write.pImageInfo = &imageInfos.back();
+                } else {
+                    bufferInfos.push_back({FromObjectHandle<VkBuffer>(content[0]), content[1], content[2]});
+                    write.pBufferInfo = &bufferInfos.back();
+                }
+                writes.push_back(write);
+            }
+            vkUpdateDescriptorSets(m_device.GetHandle(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+            return set;
+        }
+
+        /// Issue all draws of an indirect command, one by one without multiDrawIndirect
+        void DrawIndirect(const CmdDrawIndirectBase& cmd, bool indexed) {
+            if (!cmd.buffer || cmd.drawCount == 0 || !FlushDraw()) {
+                return;
+            }
+
+            VkBuffer buffer = static_cast<VulkanBuffer*>(cmd.buffer)->GetHandle();
+            const uint32_t stride = cmd.stride != 0 ? cmd.stride
+                : static_cast<uint32_t>(indexed ? sizeof(VkDrawIndexedIndirectCommand) : sizeof(VkDrawIndirectCommand));
+            const auto issue = indexed ? vkCmdDrawIndexedIndirect : vkCmdDrawIndirect;
+            if (m_multiDrawIndirect) {
+                issue(m_commands, buffer, cmd.offset, cmd.drawCount, stride);
+                ++m_drawCalls;
+                return;
+            }
+            for (uint32_t i = 0; i < cmd.drawCount; ++i) {
+                issue(m_commands, buffer, cmd.offset + uint64_t(i) * stride, 1, stride);
+                ++m_drawCalls;
+            }
+        }
+
+        // ====================================================================
+        // Transfers
+        // ====================================================================
+
+        void CopyBuffer(const CmdCopyBuffer& cmd) {
+            if (!cmd.src || !cmd.dst || !RequireOutsidePass("CopyBuffer")) {
+                return;
+            }
+            const VkBufferCopy region{cmd.srcOffset, cmd.dstOffset, cmd.size};
+            vkCmdCopyBuffer(m_commands, static_cast<VulkanBuffer*>(cmd.src)->GetHandle(),
+                            static_cast<VulkanBuffer*>(cmd.dst)->GetHandle(), 1, &region);
+        }
+
+        /// The whole layer of a mip level, tightly packed from the buffer start
+        void CopyBufferToTexture(const CmdCopyBufferToTexture& cmd) {
+            if (!cmd.src || !cmd.dst || !RequireOutsidePass("CopyBufferToTexture")) {
+                return;
+            }
+            const auto* texture = static_cast<const VulkanTexture*>(cmd.dst);
+            if (cmd.mipLevel >= texture->GetMipLevels() || cmd.arrayLayer >= texture->GetLayerCount()) {
+                LogWarning("CopyBufferToTexture out of bounds; skipped");
+                return;
+            }
+            const VkBufferImageCopy region = texture->GetCopyRegion(cmd.mipLevel, cmd.arrayLayer);
+            texture->RecordTransition(m_commands, texture->GetLayout(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                      cmd.mipLevel, 1, cmd.arrayLayer, 1);
+            vkCmdCopyBufferToImage(m_commands, static_cast<VulkanBuffer*>(cmd.src)->GetHandle(), texture->GetHandle(),
+                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+            texture->RecordTransition(m_commands, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, texture->GetLayout(),
+                                      cmd.mipLevel, 1, cmd.arrayLayer, 1);
+        }
+
+        void CopyTextureToBuffer(const CmdCopyTextureToBuffer& cmd) {
+            if (!cmd.src || !cmd.dst || !RequireOutsidePass("CopyTextureToBuffer")) {
+                return;
+            }
+            const auto* texture = static_cast<const VulkanTexture*>(cmd.src);
+            if (cmd.mipLevel >= texture->GetMipLevels() || cmd.arrayLayer >= texture->GetLayerCount()) {
+                LogWarning("CopyTextureToBuffer out of bounds; skipped");
+                return;
+            }
+            const VkBufferImageCopy region = texture->GetCopyRegion(cmd.mipLevel, cmd.arrayLayer);
+            texture->RecordTransition(m_commands, texture->GetLayout(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                      cmd.mipLevel, 1, cmd.arrayLayer, 1);
+            vkCmdCopyImageToBuffer(m_commands, texture->GetHandle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                   static_cast<VulkanBuffer*>(cmd.dst)->GetHandle(), 1, &region);
+            texture->RecordTransition(m_commands, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, texture->GetLayout(),
+                                      cmd.mipLevel, 1, cmd.arrayLayer, 1);
+        }
+
+        /// The extent both subresources have in common
+        void CopyTexture(const CmdCopyTexture& cmd) {
+            if (!cmd.src || !cmd.dst || !RequireOutsidePass("CopyTexture")) {
+                return;
+            }
+            const auto* src = static_cast<const VulkanTexture*>(cmd.src);
+            const auto* dst = static_cast<const VulkanTexture*>(cmd.dst);
+            if (src == dst || cmd.srcMipLevel >= src->GetMipLevels() || cmd.srcArrayLayer >= src->GetLayerCount() ||
+                cmd.dstMipLevel >= dst->GetMipLevels() || cmd.dstArrayLayer >= dst->GetLayerCount()) {
+                LogWarning("CopyTexture between invalid subresources; skipped");
+                return;
+            }
+
+            const VkExtent3D srcExtent = src->GetMipExtent(cmd.srcMipLevel);
+            const VkExtent3D dstExtent = dst->GetMipExtent(cmd.dstMipLevel);
+            VkImageCopy region{};
+            region.srcSubresource = src->GetCopyRegion(cmd.srcMipLevel, cmd.srcArrayLayer).imageSubresource;
+            region.dstSubresource = dst->GetCopyRegion(cmd.dstMipLevel, cmd.dstArrayLayer).imageSubresource;
+            region.extent = {std::min(srcExtent.width, dstExtent.width), std::min(srcExtent.height, dstExtent.height),
+                             std::min(srcExtent.depth, dstExtent.depth)};
+
+            src->RecordTransition(m_commands, src->GetLayout(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                  cmd.srcMipLevel, 1, cmd.srcArrayLayer, 1);
+            dst->RecordTransition(m_commands, dst->GetLayout(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                  cmd.dstMipLevel, 1, cmd.dstArrayLayer, 1);
+            vkCmdCopyImage(m_commands, src->GetHandle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           dst->GetHandle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+            src->RecordTransition(m_commands, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, src->GetLayout(),
+                                  cmd.srcMipLevel, 1, cmd.srcArrayLayer, 1);
+            dst->RecordTransition(m_commands, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, dst->GetLayout(),
+                                  cmd.dstMipLevel, 1, cmd.dstArrayLayer, 1);
+        }
+
+        struct VertexBufferBinding {
+            VkBuffer buffer;
+            VkDeviceSize offset;
+
+            bool operator==(const VertexBufferBinding&) const = default;
+        };
+
+        struct IndexBufferBinding {
+            VkBuffer buffer;
+            VkDeviceSize offset;
+            VkIndexType type;
+
+            bool operator==(const IndexBufferBinding&) const = default;
+        };
+
+        VulkanDevice& m_device;
+        VkCommandBuffer m_commands;
+        VulkanCommandBuffer::TranslateScratch& m_scratch;
+        bool m_debugUtils;
+        bool m_multiDrawIndirect;
+        bool m_depthBounds;
+
+        uint64_t m_drawCalls = 0;
+        uint64_t m_emitted = 0;
+        uint64_t m_filtered = 0;
+
+        bool m_pendingWrites = false;  // The command buffer starts with a full barrier
+
+        // Current render pass
+        bool m_inPass = false;
+        VulkanFramebuffer* m_framebuffer = nullptr;
+        VkRenderPass m_renderPass = VK_NULL_HANDLE;
+        VkRect2D m_renderArea{};
+
+        // Pipelines as bound by commands, and the Vulkan pipelines made from them
+        VulkanPipeline* m_graphicsPipeline = nullptr;
+        VulkanPipeline* m_computePipeline = nullptr;
+        bool m_pipelineStateDirty = false;
+        std::optional<VkPipeline> m_boundGraphics;
+        std::optional<VkPipeline> m_boundCompute;
+
+        // Descriptor sets, graphics [0] and compute [1]
+        VkPipelineLayout m_boundLayout[2] = {};
+        VkDescriptorSetLayout m_boundSetLayout[2] = {};
+        VkDescriptorSet m_boundSet[2] = {};
+
+        // Vertex input
+        std::array<std::optional<VertexBufferBinding>, 16> m_vertexBuffers;
+        std::optional<IndexBufferBinding> m_indexBuffer;
+
+        // Dynamic state; viewport and scissor follow the render area until set
+        bool m_viewportSet = false;
+        bool m_scissorSet = false;
+        std::optional<VkViewport> m_viewport;
+        std::optional<VkRect2D> m_scissor;
+        std::optional<float> m_lineWidth;
+        std::optional<std::array<float, 4>> m_blendConstants;
+        std::optional<std::array<float, 3>> m_depthBias;
+        std::optional<std::array<float, 2>> m_depthBoundsValues;
+        std::array<std::optional<uint32_t>, 2> m_compareMask;
+        std::array<std::optional<uint32_t>, 2> m_writeMask;
+        std::array<std::optional<uint32_t>, 2> m_reference;
+
+        // Push constants: the block as the recorded commands leave it
+        std::array<std::byte, MaxPushConstantSize> m_pushConstants{};
+        bool m_pushConstantsDirty = false;
+    };
+} // anonymous namespace
+
+void VulkanCommandBuffer::Translate(VulkanDevice& device, VkCommandBuffer commands) {
+    if (m_state == CommandBufferState::Recording) {
+        LogWarning("Submitting a command buffer that is still recording");
+    }
+
+    CommandTranslator translator(device, commands, m_translateScratch);
+    translator.Translate(m_stream);
+    device.CountCommands(translator.GetDrawCalls(), translator.GetStateChangesEmitted(),
+                         translator.GetStateChangesFiltered());
+    MarkSubmitted();
+}
+
+} // namespace VRHI
@@ -0,0 +1,60 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/RecordingCommandBuffer.hpp>
+#include "VulkanLoader.hpp"
+#include <vector>
+
+namespace VRHI {
+
+class VulkanDevice;
+class VulkanTexture;
+
+/// Vulkan command buffer.
+/// Commands are encoded into a CommandStream while recording and translated
+/// into a VkCommandBuffer by Translate(), which the device calls at
+/// submission time. VkCommandBuffers are pooled by the device, so a VRHI
+/// command buffer can be submitted again right away.
+class VulkanCommandBuffer : public RecordingCommandBuffer {
+public:
+    explicit VulkanCommandBuffer(CommandBufferLevel level) : RecordingCommandBuffer(level) {}
+    ~VulkanCommandBuffer() override = default;
+
+    // Vulkan-specific: record the commands into `commands`
+    void Translate(VulkanDevice& device, VkCommandBuffer commands);
+
+    /// Arrays filled during a translation. Kept across submissions so that
+    /// warmed-up translations do not allocate.
+    struct TranslateScratch {
+        /// What is bound at a descriptor binding number; buffers and
+        /// textures share the numbers, as they do in a Vulkan set
+        struct Resource {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            uint64_t offset = 0;
+            uint64_t range = 0;
+            const VulkanTexture* texture = nullptr;
+            VkSampler sampler = VK_NULL_HANDLE;
+        };
+        std::vector<Resource> resources;
+
+        /// Contents (three words per binding) and dynamic offsets of the
+        /// descriptor set last bound for graphics [0] and compute [1], and
+        /// of the one a draw or dispatch needs
+        std::vector<uint64_t> boundContents[2];
+        std::vector<uint32_t> boundOffsets[2];
+        std::vector<uint64_t> contents;
+        std::vector<uint32_t> offsets;
+
+        std::vector<VkWriteDescriptorSet> writes;
+        std::vector<VkDescriptorBufferInfo> bufferInfos;
+        std::vector<VkDescriptorImageInfo> imageInfos;
+        std::vector<VkClearValue> clearValues;
+    };
+
+private:
+    TranslateScratch m_translateScratch;
+};
+
+} // namespace VRHI
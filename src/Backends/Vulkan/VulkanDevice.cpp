@@ -0,0 +1,773 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "VulkanDevice.hpp"
+#include "VulkanInstance.hpp"
+#include "VulkanBuffer.hpp"
+#include "VulkanTexture.hpp"
+#include "VulkanSampler.hpp"
+#include "VulkanShader.hpp"
+#include "VulkanPipeline.hpp"
+#include "VulkanRenderPass.hpp"
+#include "VulkanFramebuffer.hpp"
+#include "VulkanCommandBuffer.hpp"
+#include "VulkanSync.hpp"
+#include "VulkanTransientAllocator.hpp"
+#include "VulkanFormatUtils.hpp"
+#include <VRHI/Logging.hpp>
+#include <VRHI/BackendScoring.hpp>
+#include <algorithm>
+#include <cstring>
+
+namespace VRHI {
+
+namespace {
+    /// Sets per descriptor pool; pools are recycled whole once the GPU is done with them
+    constexpr uint32_t DescriptorPoolSets = 256;
+
+    constexpr VkShaderStageFlags PushConstantStages = VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT;
+
+    const char* GetVendorName(uint32_t vendorId) {
+        switch (vendorId) {
+            case 0x1002: return "AMD";
+            case 0x1010: return "ImgTec";
+            case 0x106B: return "Apple";
+            case 0x10DE: return "NVIDIA";
+            case 0x13B5: return "ARM";
+            case 0x5143: return "Qualcomm";
+            case 0x8086: return "Intel";
+            case VK_VENDOR_ID_MESA: return "Mesa";
+            default: return "Unknown";
+        }
+    }
+
+    bool HasExtension(const std::vector<VkExtensionProperties>& extensions, const char* name) {
+        return std::ranges::any_of(extensions, [name](const VkExtensionProperties& extension) {
+            return std::strcmp(extension.extensionName, name) == 0;
+        });
+    }
+}
+
+VulkanDevice::VulkanDevice(const DeviceConfig& config, std::shared_ptr<VulkanInstance> instance)
+    : m_config(config)
+    , m_instance(std::move(instance))
+{
+    SetMaxFramesInFlight(config.maxFramesInFlight);
+}
+
+VulkanDevice::~VulkanDevice() {
+    if (m_device == VK_NULL_HANDLE) {
+        return;
+    }
+    ReleaseFrameContexts();
+
+    if (m_uploadCommands != VK_NULL_HANDLE) {
+        SubmitBatch(VK_NULL_HANDLE);
+    }
+    vkDeviceWaitIdle(m_device);
+
+    m_transientAllocator.reset();
+    for (const RetiredObject& object : m_retired) {
+        DestroyObject(object);
+    }
+    m_retired.clear();
+
+    for (const DescriptorPool& pool : m_descriptorPools) {
+        vkDestroyDescriptorPool(m_device, pool.pool, nullptr);
+    }
+    for (const auto& [key, layout] : m_pipelineLayouts) {
+        vkDestroyPipelineLayout(m_device, layout.pipelineLayout, nullptr);
+        vkDestroyDescriptorSetLayout(m_device, layout.setLayout, nullptr);
+    }
+    vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+    vkDestroyPipelineCache(m_device, m_pipelineCache, nullptr);
+    vkDestroySampler(m_device, m_defaultSampler, nullptr);
+    vkDestroySemaphore(m_device, m_timeline, nullptr);
+    vkDestroyDevice(m_device, nullptr);
+}
+
+std::expected<void, Error> VulkanDevice::Initialize() {
+    VkPhysicalDevice physicalDevice = m_instance->GetPhysicalDevice();
+
+    // Every core feature the device has, except the costly bounds checking
+    m_enabledFeatures = m_instance->GetFeatures();
+    m_enabledFeatures.robustBufferAccess = VK_FALSE;
+
+    VkPhysicalDeviceVulkan12Features features12{};
+    features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    features12.timelineSemaphore = VK_TRUE;
+    VkPhysicalDeviceFeatures2 features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.features = m_enabledFeatures;
+    features.pNext = &features12;
+
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> available(extensionCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, available.data());
+
+    std::vector<const char*> extensions;
+    VkPhysicalDeviceDepthClipControlFeaturesEXT depthClipControl{};
+    depthClipControl.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_CLIP_CONTROL_FEATURES_EXT;
+    if (HasExtension(available, VK_EXT_DEPTH_CLIP_CONTROL_EXTENSION_NAME)) {
+        VkPhysicalDeviceFeatures2 query{};
+        query.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        query.pNext = &depthClipControl;
+        vkGetPhysicalDeviceFeatures2(physicalDevice, &query);
+        if (depthClipControl.depthClipControl) {
+            extensions.push_back(VK_EXT_DEPTH_CLIP_CONTROL_EXTENSION_NAME);
+            depthClipControl.pNext = nullptr;
+            features12.pNext = &depthClipControl;
+            m_depthClipControl = true;
+        }
+    }
+    if (!m_depthClipControl) {
+        LogInfo("VK_EXT_depth_clip_control unavailable; clip space depth is [0, 1] instead of OpenGL's [-1, 1]");
+    }
+
+    const float priority = 1.0f;
+    VkDeviceQueueCreateInfo queueInfo{};
+    queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueInfo.queueFamilyIndex = m_instance->GetQueueFamily();
+    queueInfo.queueCount = 1;
+    queueInfo.pQueuePriorities = &priority;
+
+    VkDeviceCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &features;
+    createInfo.queueCreateInfoCount = 1;
+    createInfo.pQueueCreateInfos = &queueInfo;
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
+
+    VkResult result = vkCreateDevice(physicalDevice, &createInfo, nullptr, &m_device);
+    if (result != VK_SUCCESS) {
+        m_device = VK_NULL_HANDLE;
+        return std::unexpected(Error{
+            Error::Code::InitializationFailed,
+            "vkCreateDevice failed (VkResult " + std::to_string(result) + ")"
+        });
+    }
+    vkGetDeviceQueue(m_device, m_instance->GetQueueFamily(), 0, &m_queue);
+
+    VkSemaphoreTypeCreateInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &timelineInfo;
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = m_instance->GetQueueFamily();
+
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+    if (vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &m_timeline) != VK_SUCCESS ||
+        vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_commandPool) != VK_SUCCESS ||
+        vkCreatePipelineCache(m_device, &cacheInfo, nullptr, &m_pipelineCache) != VK_SUCCESS ||
+        vkCreateSampler(m_device, &samplerInfo, nullptr, &m_defaultSampler) != VK_SUCCESS) {
+        return std::unexpected(Error{
+            Error::Code::InitializationFailed,
+            "Failed to create the Vulkan device's shared objects"
+        });
+    }
+
+    m_features = m_instance->DetectFeatures();
+
+    // The ring serves uniform and storage buffer bindings alike
+    const VkPhysicalDeviceLimits& limits = GetLimits();
+    m_transientAllocator = std::make_unique<VulkanTransientAllocator>(
+        *this, std::max(limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment));
+
+    const VkPhysicalDeviceProperties& properties = m_instance->GetProperties();
+    VkPhysicalDeviceVulkan12Properties properties12{};
+    properties12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+    VkPhysicalDeviceProperties2 properties2{};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties2.pNext = &properties12;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+
+    m_properties.deviceName = properties.deviceName;
+    m_properties.vendorName = GetVendorName(properties.vendorID);
+    m_properties.vendorId = properties.vendorID;
+    m_properties.deviceId = properties.deviceID;
+    m_properties.driverVersion = std::string(properties12.driverName) + " " + properties12.driverInfo;
+    m_properties.apiVersion = "Vulkan " + std::to_string(VK_API_VERSION_MAJOR(properties.apiVersion)) + "." +
+                              std::to_string(VK_API_VERSION_MINOR(properties.apiVersion)) + "." +
+                              std::to_string(VK_API_VERSION_PATCH(properties.apiVersion));
+    m_properties.totalMemory = m_features.memory.deviceLocalMemory;
+    m_properties.maxThreadsPerGroup = limits.maxComputeWorkGroupInvocations;
+
+    LogInfo("%s Device initialized", m_properties.apiVersion.c_str());
+    LogInfo(m_properties.deviceName);
+    return {};
+}
+
+// ============================================================================
+// Device Information
+// ============================================================================
+
+BackendType VulkanDevice::GetBackendType() const noexcept {
+    return BackendType::Vulkan;
+}
+
+BackendInfo VulkanDevice::GetBackendInfo() const {
+    BackendInfo info{};
+    info.type = BackendType::Vulkan;
+    info.name = "Vulkan";
+    info.version = "1.2";
+    info.deviceName = m_properties.deviceName;
+    info.vendorName = m_properties.vendorName;
+    info.driverVersion = m_properties.driverVersion;
+    return info;
+}
+
+const FeatureSet& VulkanDevice::GetFeatures() const noexcept {
+    return m_features;
+}
+
+bool VulkanDevice::IsFeatureSupported(Feature feature) const noexcept {
+    switch (feature) {
+        case Feature::DebugMarkers: return m_instance->HasDebugUtils();
+        case Feature::GPUValidation: return m_instance->HasValidation();
+        default: return VRHI::IsFeatureSupported(m_features, feature);
+    }
+}
+
+const DeviceProperties& VulkanDevice::GetProperties() const noexcept {
+    return m_properties;
+}
+
+const VkPhysicalDeviceLimits& VulkanDevice::GetLimits() const noexcept {
+    return m_instance->GetProperties().limits;
+}
+
+// ============================================================================
+// Resource Creation
+// ============================================================================
+
+std::expected<std::unique_ptr<Buffer>, Error>
+VulkanDevice::CreateBuffer(const BufferDesc& desc) {
+    return VulkanBuffer::Create(*this, desc);
+}
+
+std::expected<std::unique_ptr<Texture>, Error>
+VulkanDevice::CreateTexture(const TextureDesc& desc) {
+    return VulkanTexture::Create(*this, desc);
+}
+
+std::expected<std::unique_ptr<Sampler>, Error>
+VulkanDevice::CreateSampler(const SamplerDesc& desc) {
+    return VulkanSampler::Create(*this, desc);
+}
+
+std::expected<std::unique_ptr<Shader>, Error>
+VulkanDevice::CreateShader(const ShaderDesc& desc) {
+    return VulkanShader::Create(desc);
+}
+
+std::expected<std::unique_ptr<Pipeline>, Error>
+VulkanDevice::CreatePipeline(const PipelineDesc& desc) {
+    return VulkanPipeline::Create(*this, desc);
+}
+
+std::expected<std::unique_ptr<RenderPass>, Error>
+VulkanDevice::CreateRenderPass(const RenderPassDesc& desc) {
+    return VulkanRenderPass::Create(*this, desc);
+}
+
+std::expected<std::unique_ptr<Framebuffer>, Error>
+VulkanDevice::CreateFramebuffer(const FramebufferDesc& desc) {
+    return VulkanFramebuffer::Create(*this, desc);
+}
+
+VkFormat VulkanDevice::GetFormat(TextureFormat format) const {
+    const VkFormat vkFormat = VulkanFormatUtils::GetFormat(format);
+    if (!VulkanFormatUtils::IsDepthStencilFormat(format)) {
+        return vkFormat;
+    }
+
+    // Every device renders to D32_SFLOAT and to one of the two combined formats
+    constexpr VkFormatFeatureFlags Attachment = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    if (GetFormatFeatures(vkFormat) & Attachment) {
+        return vkFormat;
+    }
+    switch (vkFormat) {
+        case VK_FORMAT_D24_UNORM_S8_UINT: return VK_FORMAT_D32_SFLOAT_S8_UINT;
+        case VK_FORMAT_D32_SFLOAT_S8_UINT: return VK_FORMAT_D24_UNORM_S8_UINT;
+        default: return VK_FORMAT_D32_SFLOAT;
+    }
+}
+
+VkFormatFeatureFlags VulkanDevice::GetFormatFeatures(VkFormat format) const {
+    VkFormatProperties properties{};
+    vkGetPhysicalDeviceFormatProperties(m_instance->GetPhysicalDevice(), format, &properties);
+    return properties.optimalTilingFeatures;
+}
+
+std::expected<VkDeviceMemory, Error> VulkanDevice::AllocateMemory(const VkMemoryRequirements& requirements,
+                                                                  VkMemoryPropertyFlags required,
+                                                                  VkMemoryPropertyFlags preferred,
+                                                                  VkMemoryPropertyFlags& properties) {
+    const VkPhysicalDeviceMemoryProperties& memory = m_instance->GetMemoryProperties();
+    for (VkMemoryPropertyFlags wanted : {required | preferred, required}) {
+        for (uint32_t type = 0; type < memory.memoryTypeCount; ++type) {
+            const VkMemoryPropertyFlags flags = memory.memoryTypes[type].propertyFlags;
+            if (!(requirements.memoryTypeBits & (1u << type)) || (flags & wanted) != wanted) {
+                continue;
+            }
+
+            VkMemoryAllocateInfo allocateInfo{};
+            allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            allocateInfo.allocationSize = requirements.size;
+            allocateInfo.memoryTypeIndex = type;
+            VkDeviceMemory allocation = VK_NULL_HANDLE;
+            if (vkAllocateMemory(m_device, &allocateInfo, nullptr, &allocation) == VK_SUCCESS) {
+                properties = flags;
+                return allocation;
+            }
+        }
+    }
+    return std::unexpected(Error{
+        Error::Code::OutOfMemory,
+        "No Vulkan memory type could satisfy the allocation"
+    });
+}
+
+std::expected<VulkanStagingBuffer, Error> VulkanDevice::CreateStagingBuffer(VkDeviceSize size, bool readback) {
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = std::max<VkDeviceSize>(size, 4);
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VulkanStagingBuffer staging;
+    if (vkCreateBuffer(m_device, &bufferInfo, nullptr, &staging.buffer) != VK_SUCCESS) {
+        return std::unexpected(Error{
+            Error::Code::OutOfMemory,
+            "Failed to create Vulkan staging buffer"
+        });
+    }
+
+    VkMemoryRequirements requirements{};
+    vkGetBufferMemoryRequirements(m_device, staging.buffer, &requirements);
+    VkMemoryPropertyFlags properties = 0;
+    auto memory = AllocateMemory(requirements,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                 readback ? VK_MEMORY_PROPERTY_HOST_CACHED_BIT : 0, properties);
+    if (!memory) {
+        vkDestroyBuffer(m_device, staging.buffer, nullptr);
+        return std::unexpected(memory.error());
+    }
+    staging.memory = *memory;
+    vkBindBufferMemory(m_device, staging.buffer, staging.memory, 0);
+
+    void* data = nullptr;
+    vkMapMemory(m_device, staging.memory, 0, VK_WHOLE_SIZE, 0, &data);
+    staging.data = static_cast<std::byte*>(data);
+    return staging;
+}
+
+const VulkanPipelineLayout& VulkanDevice::GetPipelineLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings) {
+    std::vector<uint64_t> key;
+    key.reserve(bindings.size());
+    for (const VkDescriptorSetLayoutBinding& binding : bindings) {
+        key.push_back(uint64_t(binding.binding) << 32 | uint64_t(binding.descriptorType) << 16 | binding.stageFlags);
+    }
+    if (auto it = m_pipelineLayouts.find(key); it != m_pipelineLayouts.end()) {
+        return it->second;
+    }
+
+    static const VulkanPipelineLayout none;
+    VulkanPipelineLayout layout;
+    VkDescriptorSetLayoutCreateInfo setInfo{};
+    setInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    setInfo.pBindings = bindings.data();
+    if (vkCreateDescriptorSetLayout(m_device, &setInfo, nullptr, &layout.setLayout) != VK_SUCCESS) {
+        return none;
+    }
+
+    // One push constant range for all pipelines, so pushed values survive pipeline changes
+    const VkPushConstantRange pushConstants{PushConstantStages, 0, MaxPushConstantSize};
+    VkPipelineLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount = 1;
+    layoutInfo.pSetLayouts = &layout.setLayout;
+    layoutInfo.pushConstantRangeCount = 1;
+    layoutInfo.pPushConstantRanges = &pushConstants;
+    if (vkCreatePipelineLayout(m_device, &layoutInfo, nullptr, &layout.pipelineLayout) != VK_SUCCESS) {
+        vkDestroyDescriptorSetLayout(m_device, layout.setLayout, nullptr);
+        return none;
+    }
+    return m_pipelineLayouts.emplace(std::move(key), layout).first->second;
+}
+
+VkDescriptorPool VulkanDevice::CreateDescriptorPool() {
+    const VkDescriptorPoolSize sizes[] = {
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 2 * DescriptorPoolSets},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, DescriptorPoolSets},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, DescriptorPoolSets},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, DescriptorPoolSets},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2 * DescriptorPoolSets},
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, DescriptorPoolSets / 2},
+    };
+    VkDescriptorPoolCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    createInfo.maxSets = DescriptorPoolSets;
+    createInfo.poolSizeCount = static_cast<uint32_t>(std::size(sizes));
+    createInfo.pPoolSizes = sizes;
+
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    if (vkCreateDescriptorPool(m_device, &createInfo, nullptr, &pool) != VK_SUCCESS) {
+        return VK_NULL_HANDLE;
+    }
+    return pool;
+}
+
+VkDescriptorSet VulkanDevice::AllocateDescriptorSet(VkDescriptorSetLayout layout) {
+    VkDescriptorSetAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.descriptorSetCount = 1;
+    allocateInfo.pSetLayouts = &layout;
+
+    // Fill pools in turn; a full pool is reset once the GPU has finished with all its sets
+    const uint64_t completed = GetCompletedValue();
+    for (size_t attempt = 0; attempt <= m_descriptorPools.size(); ++attempt) {
+        if (attempt > 0 || m_descriptorPools.empty()) {
+            const size_t next = m_descriptorPools.empty() ? 0 : (m_currentDescriptorPool + 1) % m_descriptorPools.size();
+            if (!m_descriptorPools.empty() && m_descriptorPools[next].lastUse <= completed &&
+                next != m_currentDescriptorPool) {
+                vkResetDescriptorPool(m_device, m_descriptorPools[next].pool, 0);
+                m_currentDescriptorPool = next;
+            } else {
+                VkDescriptorPool pool = CreateDescriptorPool();
+                if (pool == VK_NULL_HANDLE) {
+                    return VK_NULL_HANDLE;
+                }
+                // Keep the pools in the order they are filled
+                const size_t position = m_descriptorPools.empty() ? 0 : m_currentDescriptorPool + 1;
+                m_descriptorPools.insert(m_descriptorPools.begin() + static_cast<ptrdiff_t>(position), {pool, 0});
+                m_currentDescriptorPool = position;
+            }
+        }
+
+        DescriptorPool& pool = m_descriptorPools[m_currentDescriptorPool];
+        allocateInfo.descriptorPool = pool.pool;
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        if (vkAllocateDescriptorSets(m_device, &allocateInfo, &set) == VK_SUCCESS) {
+            pool.lastUse = GetNextValue();
+            return set;
+        }
+    }
+    return VK_NULL_HANDLE;
+}
+
+// ============================================================================
+// Command Execution
+// ============================================================================
+
+std::unique_ptr<CommandBuffer> VulkanDevice::CreateCommandBuffer(CommandBufferLevel level) {
+    return std::make_unique<VulkanCommandBuffer>(level);
+}
+
+TransientAllocator* VulkanDevice::GetTransientAllocator() noexcept {
+    return m_transientAllocator.get();
+}
+
+void VulkanDevice::RecordFullBarrier(VkCommandBuffer commands) {
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    vkCmdPipelineBarrier(commands, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+VkCommandBuffer VulkanDevice::BeginCommands() {
+    VkCommandBuffer commands = VK_NULL_HANDLE;
+    if (!m_commandBuffers.empty() && m_commandBuffers.front().value <= GetCompletedValue()) {
+        commands = m_commandBuffers.front().commands;
+        m_commandBuffers.pop_front();
+        vkResetCommandBuffer(commands, 0);
+    } else {
+        VkCommandBufferAllocateInfo allocateInfo{};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocateInfo.commandPool = m_commandPool;
+        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocateInfo.commandBufferCount = 1;
+        vkAllocateCommandBuffers(m_device, &allocateInfo, &commands);
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commands, &beginInfo);
+    RecordFullBarrier(commands);
+    return commands;
+}
+
+void VulkanDevice::EndCommands(VkCommandBuffer commands) {
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(commands, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+    vkEndCommandBuffer(commands);
+}
+
+VkCommandBuffer VulkanDevice::GetUploadCommands() {
+    if (m_uploadCommands == VK_NULL_HANDLE) {
+        m_uploadCommands = BeginCommands();
+    }
+    return m_uploadCommands;
+}
+
+void VulkanDevice::SubmitBatch(VkCommandBuffer commands) {
+    VkCommandBuffer batch[2];
+    uint32_t count = 0;
+    if (m_uploadCommands != VK_NULL_HANDLE) {
+        EndCommands(m_uploadCommands);
+        batch[count++] = m_uploadCommands;
+        m_uploadCommands = VK_NULL_HANDLE;
+    }
+    if (commands != VK_NULL_HANDLE) {
+        batch[count++] = commands;
+    }
+
+    const uint64_t value = GetNextValue();
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &value;
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.commandBufferCount = count;
+    submitInfo.pCommandBuffers = batch;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &m_timeline;
+
+    VkResult result = vkQueueSubmit(m_queue, 1, &submitInfo, VK_NULL_HANDLE);
+    if (result != VK_SUCCESS) {
+        LogError("vkQueueSubmit failed (VkResult %d)", static_cast<int>(result));
+    }
+    m_submittedValue = value;
+    for (uint32_t i = 0; i < count; ++i) {
+        m_commandBuffers.push_back({batch[i], value});
+    }
+}
+
+void VulkanDevice::Submit(std::unique_ptr<CommandBuffer> cmd, Fence* signalFence) {
+    Submit(cmd.get(), signalFence);
+}
+
+void VulkanDevice::Submit(CommandBuffer* cmd, Fence* signalFence) {
+    // Slices written since the last submission must be visible to the commands
+    if (m_transientAllocator) {
+        m_transientAllocator->FlushWrites();
+    }
+
+    VkCommandBuffer commands = VK_NULL_HANDLE;
+    if (cmd) {
+        if (cmd->GetLevel() != CommandBufferLevel::Primary) {
+            LogWarning("Secondary command buffers cannot be submitted; use ExecuteCommands");
+            return;
+        }
+        commands = BeginCommands();
+        static_cast<VulkanCommandBuffer*>(cmd)->Translate(*this, commands);
+        EndCommands(commands);
+    }
+    SubmitBatch(commands);
+
+    if (signalFence) {
+        static_cast<VulkanFence*>(signalFence)->SetValue(m_submittedValue);
+    }
+    CollectGarbage();
+}
+
+void VulkanDevice::Submit(std::span<std::unique_ptr<CommandBuffer>> cmds, Fence* signalFence) {
+    for (size_t i = 0; i < cmds.size(); ++i) {
+        Submit(std::move(cmds[i]), i + 1 == cmds.size() ? signalFence : nullptr);
+    }
+    if (cmds.empty() && signalFence) {
+        Submit(nullptr, signalFence);
+    }
+}
+
+void VulkanDevice::WaitForSubmitted() {
+    if (m_uploadCommands != VK_NULL_HANDLE) {
+        SubmitBatch(VK_NULL_HANDLE);
+    }
+    WaitForValue(m_submittedValue);
+}
+
+void VulkanDevice::WaitIdle() {
+    WaitForSubmitted();
+    CollectGarbage();
+}
+
+uint64_t VulkanDevice::GetCompletedValue() const {
+    uint64_t value = 0;
+    vkGetSemaphoreCounterValue(m_device, m_timeline, &value);
+    return value;
+}
+
+bool VulkanDevice::WaitForValue(uint64_t value, uint64_t timeout) const {
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &m_timeline;
+    waitInfo.pValues = &value;
+    return vkWaitSemaphores(m_device, &waitInfo, timeout) == VK_SUCCESS;
+}
+
+// ============================================================================
+// Synchronization
+// ============================================================================
+
+std::unique_ptr<Fence> VulkanDevice::CreateFence(bool signaled) {
+    return std::make_unique<VulkanFence>(*this, signaled);
+}
+
+std::unique_ptr<Semaphore> VulkanDevice::CreateSemaphore() {
+    return std::make_unique<VulkanSemaphore>(*this);
+}
+
+void VulkanDevice::Flush() {
+    if (m_uploadCommands != VK_NULL_HANDLE) {
+        SubmitBatch(VK_NULL_HANDLE);
+    }
+}
+
+// ============================================================================
+// Deferred Destruction
+// ============================================================================
+
+void VulkanDevice::Retire(VkObjectType type, uint64_t handle, VkDeviceMemory memory) {
+    if (handle == 0 && memory == VK_NULL_HANDLE) {
+        return;
+    }
+
+    // Pending uploads may use the object too
+    const uint64_t value = m_uploadCommands != VK_NULL_HANDLE ? GetNextValue() : m_submittedValue;
+    const RetiredObject object{value, type, handle, memory};
+    if (m_retired.empty() && value <= GetCompletedValue()) {
+        DestroyObject(object);
+    } else {
+        m_retired.push_back(object);
+    }
+}
+
+void VulkanDevice::CollectGarbage() {
+    if (m_retired.empty()) {
+        return;
+    }
+    const uint64_t completed = GetCompletedValue();
+    while (!m_retired.empty() && m_retired.front().value <= completed) {
+        DestroyObject(m_retired.front());
+        m_retired.pop_front();
+    }
+}
+
+void VulkanDevice::DestroyObject(const RetiredObject& object) {
+    if (object.handle != 0) {
+        switch (object.type) {
+            case VK_OBJECT_TYPE_BUFFER:
+                vkDestroyBuffer(m_device, FromObjectHandle<VkBuffer>(object.handle), nullptr);
+                break;
+            case VK_OBJECT_TYPE_IMAGE:
+                vkDestroyImage(m_device, FromObjectHandle<VkImage>(object.handle), nullptr);
+                break;
+            case VK_OBJECT_TYPE_IMAGE_VIEW:
+                vkDestroyImageView(m_device, FromObjectHandle<VkImageView>(object.handle), nullptr);
+                break;
+            case VK_OBJECT_TYPE_SAMPLER:
+                vkDestroySampler(m_device, FromObjectHandle<VkSampler>(object.handle), nullptr);
+                break;
+            case VK_OBJECT_TYPE_SHADER_MODULE:
+                vkDestroyShaderModule(m_device, FromObjectHandle<VkShaderModule>(object.handle), nullptr);
+                break;
+            case VK_OBJECT_TYPE_PIPELINE:
+                vkDestroyPipeline(m_device, FromObjectHandle<VkPipeline>(object.handle), nullptr);
+                break;
+            case VK_OBJECT_TYPE_RENDER_PASS:
+                vkDestroyRenderPass(m_device, FromObjectHandle<VkRenderPass>(object.handle), nullptr);
+                break;
+            case VK_OBJECT_TYPE_FRAMEBUFFER:
+                vkDestroyFramebuffer(m_device, FromObjectHandle<VkFramebuffer>(object.handle), nullptr);
+                break;
+            case VK_OBJECT_TYPE_SEMAPHORE:
+                vkDestroySemaphore(m_device, FromObjectHandle<VkSemaphore>(object.handle), nullptr);
+                break;
+            default:
+                LogWarning("Cannot destroy retired Vulkan object of type %d", static_cast<int>(object.type));
+                break;
+        }
+    }
+    if (object.memory != VK_NULL_HANDLE) {
+        vkFreeMemory(m_device, object.memory, nullptr);
+    }
+}
+
+void VulkanDevice::SetObjectName(VkObjectType type, uint64_t handle, const char* name) const {
+    if (!name || handle == 0 || !m_instance->HasDebugUtils()) {
+        return;
+    }
+    VkDebugUtilsObjectNameInfoEXT nameInfo{};
+    nameInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+    nameInfo.objectType = type;
+    nameInfo.objectHandle = handle;
+    nameInfo.pObjectName = name;
+    vkSetDebugUtilsObjectNameEXT(m_device, &nameInfo);
+}
+
+// ============================================================================
+// Swap Chain
+// ============================================================================
+
+SwapChain* VulkanDevice::GetSwapChain() noexcept {
+    // Headless: there is no swap chain yet
+    return nullptr;
+}
+
+void VulkanDevice::Present() {
+    // Fence the frame's transient memory; without a swap chain nothing is shown
+    if (m_transientAllocator) {
+        m_transientAllocator->EndFrame();
+    }
+    Flush();
+    CollectGarbage();
+
+    // Close the frame's statistics
+    m_lastFrameStats = FrameStats{};
+    m_lastFrameStats.stateChangesEmitted = m_stateChangesEmitted;
+    m_lastFrameStats.stateChangesFiltered = m_stateChangesFiltered;
+    m_lastFrameStats.drawCalls = m_drawCalls;
+    m_drawCalls = 0;
+    m_stateChangesEmitted = 0;
+    m_stateChangesFiltered = 0;
+}
+
+FrameStats VulkanDevice::GetFrameStats() const noexcept {
+    return m_lastFrameStats;
+}
+
+void VulkanDevice::Resize(uint32_t width, uint32_t height) {
+    m_config.width = width;
+    m_config.height = height;
+}
+
+} // namespace VRHI
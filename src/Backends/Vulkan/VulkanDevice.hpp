@@ -0,0 +1,262 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/VRHI.hpp>
+#include <VRHI/Resources.hpp>
+#include "VulkanLoader.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace VRHI {
+
+class VulkanInstance;
+class VulkanTransientAllocator;
+
+/// Descriptor set layout and pipeline layout shared by all pipelines whose
+/// shaders declare the same bindings
+struct VulkanPipelineLayout {
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+};
+
+/// A host-visible buffer for one transfer
+struct VulkanStagingBuffer {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    std::byte* data = nullptr;
+};
+
+/// Vulkan device implementation
+///
+/// All work goes to one graphics + compute queue. Every submission signals
+/// the next value of a timeline semaphore; fences, command buffer and
+/// descriptor pool recycling, the transient allocator and deferred
+/// destruction all compare against that value instead of owning VkFences.
+///
+/// Uploads and layout transitions that happen outside a CommandBuffer
+/// (Buffer::Update, texture creation, ...) are recorded into an upload
+/// command buffer that is submitted ahead of the next submission, so they
+/// are ordered like OpenGL's immediate updates without stalling the CPU.
+/// Reads wait for the GPU.
+class VulkanDevice : public Device {
+public:
+    VulkanDevice(const DeviceConfig& config, std::shared_ptr<VulkanInstance> instance);
+    ~VulkanDevice() override;
+
+    /// Create the VkDevice and the objects shared by all resources
+    std::expected<void, Error> Initialize();
+
+    // Device Information
+    BackendType GetBackendType() const noexcept override;
+    BackendInfo GetBackendInfo() const override;
+    const FeatureSet& GetFeatures() const noexcept override;
+    bool IsFeatureSupported(Feature feature) const noexcept override;
+    const DeviceProperties& GetProperties() const noexcept override;
+
+    // Resource Creation
+    std::expected<std::unique_ptr<Buffer>, Error>
+    CreateBuffer(const BufferDesc& desc) override;
+
+    std::expected<std::unique_ptr<Texture>, Error>
+    CreateTexture(const TextureDesc& desc) override;
+
+    std::expected<std::unique_ptr<Sampler>, Error>
+    CreateSampler(const SamplerDesc& desc) override;
+
+    std::expected<std::unique_ptr<Shader>, Error>
+    CreateShader(const struct ShaderDesc& desc) override;
+
+    std::expected<std::unique_ptr<Pipeline>, Error>
+    CreatePipeline(const struct PipelineDesc& desc) override;
+
+    std::expected<std::unique_ptr<RenderPass>, Error>
+    CreateRenderPass(const struct RenderPassDesc& desc) override;
+
+    std::expected<std::unique_ptr<Framebuffer>, Error>
+    CreateFramebuffer(const struct FramebufferDesc& desc) override;
+
+    // Command Execution
+    std::unique_ptr<CommandBuffer> CreateCommandBuffer(CommandBufferLevel level = CommandBufferLevel::Primary) override;
+    TransientAllocator* GetTransientAllocator() noexcept override;
+    void Submit(std::unique_ptr<CommandBuffer> cmd, Fence* signalFence = nullptr) override;
+    void Submit(CommandBuffer* cmd, Fence* signalFence = nullptr) override;
+    void Submit(std::span<std::unique_ptr<CommandBuffer>> cmds, Fence* signalFence = nullptr) override;
+    void WaitIdle() override;
+
+    // Synchronization
+    std::unique_ptr<Fence> CreateFence(bool signaled = false) override;
+    std::unique_ptr<Semaphore> CreateSemaphore() override;
+    void Flush() override;
+
+    // Swap Chain
+    SwapChain* GetSwapChain() noexcept override;
+    void Present() override;
+    void Resize(uint32_t width, uint32_t height) override;
+
+    // Statistics
+    FrameStats GetFrameStats() const noexcept override;
+
+    // Vulkan-specific: handles shared by all resources
+    VkDevice GetHandle() const noexcept { return m_device; }
+    const VulkanInstance& GetInstance() const noexcept { return *m_instance; }
+    const VkPhysicalDeviceLimits& GetLimits() const noexcept;
+    const VkPhysicalDeviceFeatures& GetEnabledFeatures() const noexcept { return m_enabledFeatures; }
+    VkPipelineCache GetPipelineCache() const noexcept { return m_pipelineCache; }
+
+    // Vulkan-specific: sampler used for textures bound without one
+    VkSampler GetDefaultSampler() const noexcept { return m_defaultSampler; }
+
+    // Vulkan-specific: whether pipelines can keep OpenGL's [-1, 1] clip space
+    // depth (VK_EXT_depth_clip_control)
+    bool HasDepthClipControl() const noexcept { return m_depthClipControl; }
+
+    // Vulkan-specific: format used for a VRHI format; depth formats the
+    // device cannot render to fall back to one it can
+    VkFormat GetFormat(TextureFormat format) const;
+
+    // Vulkan-specific: optimal-tiling features of a format
+    VkFormatFeatureFlags GetFormatFeatures(VkFormat format) const;
+
+    /// Vulkan-specific: allocate memory for a resource
+    /// @param required Properties the memory type must have
+    /// @param preferred Properties tried first, on top of `required`
+    /// @param properties Receives the properties of the chosen memory type
+    std::expected<VkDeviceMemory, Error> AllocateMemory(const VkMemoryRequirements& requirements,
+                                                        VkMemoryPropertyFlags required,
+                                                        VkMemoryPropertyFlags preferred,
+                                                        VkMemoryPropertyFlags& properties);
+
+    /// Vulkan-specific: mapped buffer for one upload or readback; pass it to
+    /// RetireStagingBuffer() once the copy has been recorded
+    std::expected<VulkanStagingBuffer, Error> CreateStagingBuffer(VkDeviceSize size, bool readback);
+    void RetireStagingBuffer(const VulkanStagingBuffer& staging) {
+        Retire(VK_OBJECT_TYPE_BUFFER, ToObjectHandle(staging.buffer), staging.memory);
+    }
+
+    /// Vulkan-specific: layouts for a set of descriptor bindings, created on first use
+    const VulkanPipelineLayout& GetPipelineLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+
+    /// Vulkan-specific: a descriptor set from the pooled descriptor pools,
+    /// valid for the commands being recorded for the next submission
+    VkDescriptorSet AllocateDescriptorSet(VkDescriptorSetLayout layout);
+
+    /// Vulkan-specific: command buffer for work outside CommandBuffers,
+    /// submitted ahead of the next submission
+    VkCommandBuffer GetUploadCommands();
+
+    /// Vulkan-specific: submit pending uploads and wait until the GPU has
+    /// finished everything submitted so far
+    void WaitForSubmitted();
+
+    /// Vulkan-specific: whether the GPU has finished all work, pending uploads included
+    bool IsIdle() const { return m_uploadCommands == VK_NULL_HANDLE && GetCompletedValue() >= m_submittedValue; }
+
+    /// Vulkan-specific: last timeline value submitted / reached by the GPU
+    uint64_t GetSubmittedValue() const noexcept { return m_submittedValue; }
+    uint64_t GetCompletedValue() const;
+
+    /// Vulkan-specific: wait until the GPU reaches `value`
+    /// @return false on timeout
+    bool WaitForValue(uint64_t value, uint64_t timeout = UINT64_MAX) const;
+
+    /// Vulkan-specific: destroy an object (and free its memory) once the GPU
+    /// has finished all work that may use it
+    void Retire(VkObjectType type, uint64_t handle, VkDeviceMemory memory = VK_NULL_HANDLE);
+
+    /// Vulkan-specific: name an object for debuggers and validation messages
+    void SetObjectName(VkObjectType type, uint64_t handle, const char* name) const;
+
+    /// Vulkan-specific: counters of a command buffer translation, for the frame stats
+    void CountCommands(uint64_t drawCalls, uint64_t stateChangesEmitted, uint64_t stateChangesFiltered) noexcept {
+        m_drawCalls += drawCalls;
+        m_stateChangesEmitted += stateChangesEmitted;
+        m_stateChangesFiltered += stateChangesFiltered;
+    }
+
+    /// Vulkan-specific: make all earlier memory writes visible to all later
+    /// accesses. Command buffers start with one, so submissions are ordered
+    /// like OpenGL's.
+    static void RecordFullBarrier(VkCommandBuffer commands);
+
+private:
+    /// An object waiting for the GPU to pass `value`
+    struct RetiredObject {
+        uint64_t value;
+        VkObjectType type;
+        uint64_t handle;
+        VkDeviceMemory memory;
+    };
+
+    /// A command buffer and the submission that last used it
+    struct PooledCommandBuffer {
+        VkCommandBuffer commands;
+        uint64_t value;
+    };
+
+    struct DescriptorPool {
+        VkDescriptorPool pool;
+        uint64_t lastUse;  // Submission that uses its newest set
+    };
+
+    /// Value the commands recorded now will be submitted with
+    uint64_t GetNextValue() const noexcept { return m_submittedValue + 1; }
+
+    /// A recycled or new command buffer, begun and starting with a full barrier
+    VkCommandBuffer BeginCommands();
+
+    /// Make the commands' writes visible to the host and end the command buffer
+    static void EndCommands(VkCommandBuffer commands);
+
+    /// Submit the pending uploads followed by `commands` (may be null) as
+    /// one batch signaling the next timeline value
+    void SubmitBatch(VkCommandBuffer commands);
+
+    VkDescriptorPool CreateDescriptorPool();
+
+    /// Destroy the retired objects the GPU is done with
+    void CollectGarbage();
+
+    void DestroyObject(const RetiredObject& object);
+
+    DeviceConfig m_config;
+    std::shared_ptr<VulkanInstance> m_instance;
+    FeatureSet m_features;
+    DeviceProperties m_properties;
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    VkQueue m_queue = VK_NULL_HANDLE;
+    VkPhysicalDeviceFeatures m_enabledFeatures{};
+    bool m_depthClipControl = false;
+
+    VkSemaphore m_timeline = VK_NULL_HANDLE;
+    uint64_t m_submittedValue = 0;
+
+    VkCommandPool m_commandPool = VK_NULL_HANDLE;
+    std::deque<PooledCommandBuffer> m_commandBuffers;  // In submission order
+    VkCommandBuffer m_uploadCommands = VK_NULL_HANDLE;
+
+    std::vector<DescriptorPool> m_descriptorPools;
+    size_t m_currentDescriptorPool = 0;
+    std::map<std::vector<uint64_t>, VulkanPipelineLayout> m_pipelineLayouts;
+
+    VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
+    VkSampler m_defaultSampler = VK_NULL_HANDLE;
+
+    std::deque<RetiredObject> m_retired;  // In value order
+
+    std::unique_ptr<VulkanTransientAllocator> m_transientAllocator;
+
+    FrameStats m_lastFrameStats;
+    uint64_t m_drawCalls = 0;             // Current frame
+    uint64_t m_stateChangesEmitted = 0;   // Current frame
+    uint64_t m_stateChangesFiltered = 0;  // Current frame
+};
+
+} // namespace VRHI
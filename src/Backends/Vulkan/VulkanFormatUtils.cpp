@@ -0,0 +1,272 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "VulkanFormatUtils.hpp"
+
+namespace VRHI {
+
+VkFormat VulkanFormatUtils::GetFormat(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::R8_UNorm: return VK_FORMAT_R8_UNORM;
+        case TextureFormat::RG8_UNorm: return VK_FORMAT_R8G8_UNORM;
+        case TextureFormat::RGBA8_UNorm: return VK_FORMAT_R8G8B8A8_UNORM;
+        case TextureFormat::RGBA8_SRGB: return VK_FORMAT_R8G8B8A8_SRGB;
+        case TextureFormat::R16_Float: return VK_FORMAT_R16_SFLOAT;
+        case TextureFormat::RG16_Float: return VK_FORMAT_R16G16_SFLOAT;
+        case TextureFormat::RGBA16_Float: return VK_FORMAT_R16G16B16A16_SFLOAT;
+        case TextureFormat::R32_Float: return VK_FORMAT_R32_SFLOAT;
+        case TextureFormat::RG32_Float: return VK_FORMAT_R32G32_SFLOAT;
+        case TextureFormat::RGB32_Float: return VK_FORMAT_R32G32B32_SFLOAT;
+        case TextureFormat::RGBA32_Float: return VK_FORMAT_R32G32B32A32_SFLOAT;
+        case TextureFormat::R32_UInt: return VK_FORMAT_R32_UINT;
+        case TextureFormat::RG32_UInt: return VK_FORMAT_R32G32_UINT;
+        case TextureFormat::RGB32_UInt: return VK_FORMAT_R32G32B32_UINT;
+        case TextureFormat::RGBA32_UInt: return VK_FORMAT_R32G32B32A32_UINT;
+        case TextureFormat::Depth16: return VK_FORMAT_D16_UNORM;
+        case TextureFormat::Depth24Stencil8: return VK_FORMAT_D24_UNORM_S8_UINT;
+        case TextureFormat::Depth32F: return VK_FORMAT_D32_SFLOAT;
+        case TextureFormat::Depth32FStencil8: return VK_FORMAT_D32_SFLOAT_S8_UINT;
+        case TextureFormat::BC1_UNorm: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        case TextureFormat::BC3_UNorm: return VK_FORMAT_BC3_UNORM_BLOCK;
+        case TextureFormat::BC7_UNorm: return VK_FORMAT_BC7_UNORM_BLOCK;
+        case TextureFormat::ETC2_RGB8: return VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK;
+        case TextureFormat::ASTC_4x4: return VK_FORMAT_ASTC_4x4_UNORM_BLOCK;
+        default: return VK_FORMAT_UNDEFINED;
+    }
+}
+
+VkFormat VulkanFormatUtils::GetVertexFormat(VertexFormat format) {
+    switch (format) {
+        case VertexFormat::Float: return VK_FORMAT_R32_SFLOAT;
+        case VertexFormat::Float2: return VK_FORMAT_R32G32_SFLOAT;
+        case VertexFormat::Float3: return VK_FORMAT_R32G32B32_SFLOAT;
+        case VertexFormat::Float4: return VK_FORMAT_R32G32B32A32_SFLOAT;
+        case VertexFormat::Int: return VK_FORMAT_R32_SINT;
+        case VertexFormat::Int2: return VK_FORMAT_R32G32_SINT;
+        case VertexFormat::Int3: return VK_FORMAT_R32G32B32_SINT;
+        case VertexFormat::Int4: return VK_FORMAT_R32G32B32A32_SINT;
+        case VertexFormat::UInt: return VK_FORMAT_R32_UINT;
+        case VertexFormat::UInt2: return VK_FORMAT_R32G32_UINT;
+        case VertexFormat::UInt3: return VK_FORMAT_R32G32B32_UINT;
+        case VertexFormat::UInt4: return VK_FORMAT_R32G32B32A32_UINT;
+        default: return VK_FORMAT_R32G32B32_SFLOAT;
+    }
+}
+
+bool VulkanFormatUtils::IsDepthStencilFormat(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::Depth16:
+        case TextureFormat::Depth24Stencil8:
+        case TextureFormat::Depth32F:
+        case TextureFormat::Depth32FStencil8:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool VulkanFormatUtils::HasStencil(TextureFormat format) {
+    return format == TextureFormat::Depth24Stencil8 || format == TextureFormat::Depth32FStencil8;
+}
+
+bool VulkanFormatUtils::IsCompressedFormat(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::BC1_UNorm:
+        case TextureFormat::BC3_UNorm:
+        case TextureFormat::BC7_UNorm:
+        case TextureFormat::ETC2_RGB8:
+        case TextureFormat::ASTC_4x4:
+            return true;
+        default:
+            return false;
+    }
+}
+
+VkImageAspectFlags VulkanFormatUtils::GetAspectMask(TextureFormat format) {
+    if (!IsDepthStencilFormat(format)) {
+        return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+    return HasStencil(format) ? VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT
+                              : VK_IMAGE_ASPECT_DEPTH_BIT;
+}
+
+uint32_t VulkanFormatUtils::GetBlockSize(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::R8_UNorm: return 1;
+        case TextureFormat::RG8_UNorm: return 2;
+        case TextureFormat::RGBA8_UNorm:
+        case TextureFormat::RGBA8_SRGB: return 4;
+        case TextureFormat::R16_Float: return 2;
+        case TextureFormat::RG16_Float: return 4;
+        case TextureFormat::RGBA16_Float: return 8;
+        case TextureFormat::R32_Float:
+        case TextureFormat::R32_UInt: return 4;
+        case TextureFormat::RG32_Float:
+        case TextureFormat::RG32_UInt: return 8;
+        case TextureFormat::RGB32_Float:
+        case TextureFormat::RGB32_UInt: return 12;
+        case TextureFormat::RGBA32_Float:
+        case TextureFormat::RGBA32_UInt: return 16;
+        // Depth copies only transfer the depth aspect
+        case TextureFormat::Depth16: return 2;
+        case TextureFormat::Depth24Stencil8:
+        case TextureFormat::Depth32F:
+        case TextureFormat::Depth32FStencil8: return 4;
+        case TextureFormat::BC1_UNorm:
+        case TextureFormat::ETC2_RGB8: return 8;
+        case TextureFormat::BC3_UNorm:
+        case TextureFormat::BC7_UNorm:
+        case TextureFormat::ASTC_4x4: return 16;
+        default: return 4;
+    }
+}
+
+uint32_t VulkanFormatUtils::GetBlockExtent(TextureFormat format) {
+    return IsCompressedFormat(format) ? 4 : 1;
+}
+
+VkCompareOp VulkanFormatUtils::GetCompareOp(CompareOp op) {
+    switch (op) {
+        case CompareOp::Never: return VK_COMPARE_OP_NEVER;
+        case CompareOp::Less: return VK_COMPARE_OP_LESS;
+        case CompareOp::Equal: return VK_COMPARE_OP_EQUAL;
+        case CompareOp::LessOrEqual: return VK_COMPARE_OP_LESS_OR_EQUAL;
+        case CompareOp::Greater: return VK_COMPARE_OP_GREATER;
+        case CompareOp::NotEqual: return VK_COMPARE_OP_NOT_EQUAL;
+        case CompareOp::GreaterOrEqual: return VK_COMPARE_OP_GREATER_OR_EQUAL;
+        case CompareOp::Always: return VK_COMPARE_OP_ALWAYS;
+        default: return VK_COMPARE_OP_ALWAYS;
+    }
+}
+
+VkBlendFactor VulkanFormatUtils::GetBlendFactor(BlendFactor factor) {
+    switch (factor) {
+        case BlendFactor::Zero: return VK_BLEND_FACTOR_ZERO;
+        case BlendFactor::One: return VK_BLEND_FACTOR_ONE;
+        case BlendFactor::SrcColor: return VK_BLEND_FACTOR_SRC_COLOR;
+        case BlendFactor::OneMinusSrcColor: return VK_BLEND_FACTOR_ONE_MINUS_SRC_COLOR;
+        case BlendFactor::DstColor: return VK_BLEND_FACTOR_DST_COLOR;
+        case BlendFactor::OneMinusDstColor: return VK_BLEND_FACTOR_ONE_MINUS_DST_COLOR;
+        case BlendFactor::SrcAlpha: return VK_BLEND_FACTOR_SRC_ALPHA;
+        case BlendFactor::OneMinusSrcAlpha: return VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        case BlendFactor::DstAlpha: return VK_BLEND_FACTOR_DST_ALPHA;
+        case BlendFactor::OneMinusDstAlpha: return VK_BLEND_FACTOR_ONE_MINUS_DST_ALPHA;
+        case BlendFactor::ConstantColor: return VK_BLEND_FACTOR_CONSTANT_COLOR;
+        case BlendFactor::OneMinusConstantColor: return VK_BLEND_FACTOR_ONE_MINUS_CONSTANT_COLOR;
+        case BlendFactor::ConstantAlpha: return VK_BLEND_FACTOR_CONSTANT_ALPHA;
+        case BlendFactor::OneMinusConstantAlpha: return VK_BLEND_FACTOR_ONE_MINUS_CONSTANT_ALPHA;
+        case BlendFactor::SrcAlphaSaturate: return VK_BLEND_FACTOR_SRC_ALPHA_SATURATE;
+        default: return VK_BLEND_FACTOR_ONE;
+    }
+}
+
+VkBlendOp VulkanFormatUtils::GetBlendOp(BlendOp op) {
+    switch (op) {
+        case BlendOp::Add: return VK_BLEND_OP_ADD;
+        case BlendOp::Subtract: return VK_BLEND_OP_SUBTRACT;
+        case BlendOp::ReverseSubtract: return VK_BLEND_OP_REVERSE_SUBTRACT;
+        case BlendOp::Min: return VK_BLEND_OP_MIN;
+        case BlendOp::Max: return VK_BLEND_OP_MAX;
+        default: return VK_BLEND_OP_ADD;
+    }
+}
+
+VkStencilOp VulkanFormatUtils::GetStencilOp(StencilOp op) {
+    switch (op) {
+        case StencilOp::Keep: return VK_STENCIL_OP_KEEP;
+        case StencilOp::Zero: return VK_STENCIL_OP_ZERO;
+        case StencilOp::Replace: return VK_STENCIL_OP_REPLACE;
+        case StencilOp::IncrementAndClamp: return VK_STENCIL_OP_INCREMENT_AND_CLAMP;
+        case StencilOp::DecrementAndClamp: return VK_STENCIL_OP_DECREMENT_AND_CLAMP;
+        case StencilOp::Invert: return VK_STENCIL_OP_INVERT;
+        case StencilOp::IncrementAndWrap: return VK_STENCIL_OP_INCREMENT_AND_WRAP;
+        case StencilOp::DecrementAndWrap: return VK_STENCIL_OP_DECREMENT_AND_WRAP;
+        default: return VK_STENCIL_OP_KEEP;
+    }
+}
+
+VkPrimitiveTopology VulkanFormatUtils::GetTopology(PrimitiveTopology topology) {
+    switch (topology) {
+        case PrimitiveTopology::PointList: return VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+        case PrimitiveTopology::LineList: return VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+        case PrimitiveTopology::LineStrip: return VK_PRIMITIVE_TOPOLOGY_LINE_STRIP;
+        case PrimitiveTopology::TriangleList: return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        case PrimitiveTopology::TriangleStrip: return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+        case PrimitiveTopology::TriangleFan: return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN;
+        case PrimitiveTopology::LineListWithAdjacency: return VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY;
+        case PrimitiveTopology::LineStripWithAdjacency: return VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY;
+        case PrimitiveTopology::TriangleListWithAdjacency: return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST_WITH_ADJACENCY;
+        case PrimitiveTopology::TriangleStripWithAdjacency: return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP_WITH_ADJACENCY;
+        case PrimitiveTopology::PatchList: return VK_PRIMITIVE_TOPOLOGY_PATCH_LIST;
+        default: return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    }
+}
+
+VkPolygonMode VulkanFormatUtils::GetPolygonMode(PolygonMode mode) {
+    switch (mode) {
+        case PolygonMode::Fill: return VK_POLYGON_MODE_FILL;
+        case PolygonMode::Line: return VK_POLYGON_MODE_LINE;
+        case PolygonMode::Point: return VK_POLYGON_MODE_POINT;
+        default: return VK_POLYGON_MODE_FILL;
+    }
+}
+
+VkCullModeFlags VulkanFormatUtils::GetCullMode(CullMode mode) {
+    switch (mode) {
+        case CullMode::None: return VK_CULL_MODE_NONE;
+        case CullMode::Front: return VK_CULL_MODE_FRONT_BIT;
+        case CullMode::Back: return VK_CULL_MODE_BACK_BIT;
+        case CullMode::FrontAndBack: return VK_CULL_MODE_FRONT_AND_BACK;
+        default: return VK_CULL_MODE_NONE;
+    }
+}
+
+VkFrontFace VulkanFormatUtils::GetFrontFace(FrontFace face) {
+    return face == FrontFace::CounterClockwise ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE;
+}
+
+VkFilter VulkanFormatUtils::GetFilter(FilterMode mode) {
+    return mode == FilterMode::Nearest ? VK_FILTER_NEAREST : VK_FILTER_LINEAR;
+}
+
+VkSamplerMipmapMode VulkanFormatUtils::GetMipmapMode(FilterMode mode) {
+    return mode == FilterMode::Nearest ? VK_SAMPLER_MIPMAP_MODE_NEAREST : VK_SAMPLER_MIPMAP_MODE_LINEAR;
+}
+
+VkSamplerAddressMode VulkanFormatUtils::GetAddressMode(AddressMode mode) {
+    switch (mode) {
+        case AddressMode::Repeat: return VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        case AddressMode::MirroredRepeat: return VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+        case AddressMode::ClampToEdge: return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        case AddressMode::ClampToBorder: return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+        default: return VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    }
+}
+
+VkShaderStageFlags VulkanFormatUtils::GetShaderStages(ShaderStage stages) {
+    auto has = [stages](ShaderStage stage) {
+        return (stages & stage) == stage;
+    };
+    VkShaderStageFlags flags = 0;
+    if (has(ShaderStage::Vertex)) flags |= VK_SHADER_STAGE_VERTEX_BIT;
+    if (has(ShaderStage::Fragment)) flags |= VK_SHADER_STAGE_FRAGMENT_BIT;
+    if (has(ShaderStage::Geometry)) flags |= VK_SHADER_STAGE_GEOMETRY_BIT;
+    if (has(ShaderStage::TessControl)) flags |= VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+    if (has(ShaderStage::TessEval)) flags |= VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+    if (has(ShaderStage::Compute)) flags |= VK_SHADER_STAGE_COMPUTE_BIT;
+    return flags;
+}
+
+VkSampleCountFlagBits VulkanFormatUtils::GetSampleCount(uint32_t samples) {
+    switch (samples) {
+        case 2: return VK_SAMPLE_COUNT_2_BIT;
+        case 4: return VK_SAMPLE_COUNT_4_BIT;
+        case 8: return VK_SAMPLE_COUNT_8_BIT;
+        case 16: return VK_SAMPLE_COUNT_16_BIT;
+        case 32: return VK_SAMPLE_COUNT_32_BIT;
+        case 64: return VK_SAMPLE_COUNT_64_BIT;
+        default: return VK_SAMPLE_COUNT_1_BIT;
+    }
+}
+
+} // namespace VRHI
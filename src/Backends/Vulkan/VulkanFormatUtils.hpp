@@ -0,0 +1,64 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/Resources.hpp>
+#include <VRHI/Pipeline.hpp>
+#include <VRHI/Shader.hpp>
+#include "VulkanLoader.hpp"
+
+namespace VRHI {
+
+/// Conversions from VRHI enums to Vulkan
+class VulkanFormatUtils {
+public:
+    /// Convert VRHI TextureFormat to a VkFormat (VK_FORMAT_UNDEFINED if unknown)
+    static VkFormat GetFormat(TextureFormat format);
+    
+    /// Convert VRHI VertexFormat to a VkFormat
+    static VkFormat GetVertexFormat(VertexFormat format);
+    
+    /// Check if a texture format is a depth/stencil format
+    static bool IsDepthStencilFormat(TextureFormat format);
+    
+    /// Check if a depth/stencil format has a stencil component
+    static bool HasStencil(TextureFormat format);
+    
+    /// Check if a texture format is block compressed
+    static bool IsCompressedFormat(TextureFormat format);
+    
+    /// Aspects of an image of this format (color, or depth and stencil)
+    static VkImageAspectFlags GetAspectMask(TextureFormat format);
+    
+    /// Bytes per texel, or per 4x4 block of a compressed format
+    static uint32_t GetBlockSize(TextureFormat format);
+    
+    /// Width and height of a texel block (4 for compressed formats, else 1)
+    static uint32_t GetBlockExtent(TextureFormat format);
+    
+    static VkCompareOp GetCompareOp(CompareOp op);
+    static VkBlendFactor GetBlendFactor(BlendFactor factor);
+    static VkBlendOp GetBlendOp(BlendOp op);
+    static VkStencilOp GetStencilOp(StencilOp op);
+    static VkPrimitiveTopology GetTopology(PrimitiveTopology topology);
+    static VkPolygonMode GetPolygonMode(PolygonMode mode);
+    static VkCullModeFlags GetCullMode(CullMode mode);
+    
+    /// Winding of front faces. VRHI keeps OpenGL's convention, where NDC y
+    /// points up: Vulkan rasterizes the same vertices with y pointing down,
+    /// which mirrors the winding.
+    static VkFrontFace GetFrontFace(FrontFace face);
+    
+    static VkFilter GetFilter(FilterMode mode);
+    static VkSamplerMipmapMode GetMipmapMode(FilterMode mode);
+    static VkSamplerAddressMode GetAddressMode(AddressMode mode);
+    
+    /// Convert VRHI ShaderStage flags to VkShaderStageFlags
+    static VkShaderStageFlags GetShaderStages(ShaderStage stages);
+    
+    /// Convert a sample count to VkSampleCountFlagBits (1 if not a power of two)
+    static VkSampleCountFlagBits GetSampleCount(uint32_t samples);
+};
+
+} // namespace VRHI
@@ -0,0 +1,133 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "VulkanFramebuffer.hpp"
+#include "VulkanDevice.hpp"
+#include "VulkanFormatUtils.hpp"
+#include "VulkanTexture.hpp"
+#include <algorithm>
+
+namespace VRHI {
+
+VulkanFramebuffer::~VulkanFramebuffer() {
+    for (const auto& [key, renderPass] : m_renderPasses) {
+        m_device->Retire(VK_OBJECT_TYPE_RENDER_PASS, ToObjectHandle(renderPass));
+    }
+    m_device->Retire(VK_OBJECT_TYPE_FRAMEBUFFER, ToObjectHandle(m_framebuffer));
+    for (VkImageView view : m_views) {
+        m_device->Retire(VK_OBJECT_TYPE_IMAGE_VIEW, ToObjectHandle(view));
+    }
+}
+
+std::expected<std::unique_ptr<Framebuffer>, Error>
+VulkanFramebuffer::Create(VulkanDevice& device, const FramebufferDesc& desc) {
+    if (desc.attachments.empty() || desc.width == 0 || desc.height == 0) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Framebuffers need attachments and a non-zero size"
+        });
+    }
+
+    std::unique_ptr<VulkanFramebuffer> framebuffer(new VulkanFramebuffer(device));
+    framebuffer->m_width = desc.width;
+    framebuffer->m_height = desc.height;
+    framebuffer->m_layers = std::max(desc.layers, 1u);
+
+    for (Texture* texture : desc.attachments) {
+        if (!texture || texture->GetType() == TextureType::Texture3D) {
+            return std::unexpected(Error{
+                Error::Code::InvalidConfig,
+                "Framebuffer attachments must be non-null 1D, 2D, array or cube textures"
+            });
+        }
+        auto* vkTexture = static_cast<VulkanTexture*>(texture);
+
+        // Mip 0 of the first `layers` layers; layered rendering picks one in the geometry shader
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = vkTexture->GetHandle();
+        viewInfo.viewType = framebuffer->m_layers > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = vkTexture->GetVkFormat();
+        viewInfo.subresourceRange = {VulkanFormatUtils::GetAspectMask(texture->GetFormat()),
+                                     0, 1, 0, framebuffer->m_layers};
+        if (VulkanFormatUtils::IsDepthStencilFormat(texture->GetFormat())) {
+            framebuffer->m_signature.depthFormat = vkTexture->GetVkFormat();
+        } else {
+            framebuffer->m_signature.colorFormats.push_back(vkTexture->GetVkFormat());
+        }
+        framebuffer->m_signature.samples = vkTexture->GetSamples();
+
+        VkImageView view = VK_NULL_HANDLE;
+        if (vkCreateImageView(device.GetHandle(), &viewInfo, nullptr, &view) != VK_SUCCESS) {
+            return std::unexpected(Error{
+                Error::Code::InitializationFailed,
+                "Failed to create Vulkan framebuffer attachment view"
+            });
+        }
+        framebuffer->m_views.push_back(view);
+        framebuffer->m_attachments.push_back(vkTexture);
+    }
+
+    // Any compatible render pass will do; start with the one the desc names
+    VkRenderPass renderPass = framebuffer->GetRenderPass(static_cast<const VulkanRenderPass*>(desc.renderPass));
+    if (renderPass == VK_NULL_HANDLE) {
+        return std::unexpected(Error{
+            Error::Code::InitializationFailed,
+            "Failed to create Vulkan render pass for the framebuffer"
+        });
+    }
+
+    VkFramebufferCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    createInfo.renderPass = renderPass;
+    createInfo.attachmentCount = static_cast<uint32_t>(framebuffer->m_views.size());
+    createInfo.pAttachments = framebuffer->m_views.data();
+    createInfo.width = desc.width;
+    createInfo.height = desc.height;
+    createInfo.layers = framebuffer->m_layers;
+    if (vkCreateFramebuffer(device.GetHandle(), &createInfo, nullptr, &framebuffer->m_framebuffer) != VK_SUCCESS) {
+        return std::unexpected(Error{
+            Error::Code::InitializationFailed,
+            "Failed to create Vulkan framebuffer"
+        });
+    }
+    device.SetObjectName(VK_OBJECT_TYPE_FRAMEBUFFER, ToObjectHandle(framebuffer->m_framebuffer), desc.debugName);
+
+    return std::unique_ptr<Framebuffer>(std::move(framebuffer));
+}
+
+VkRenderPass VulkanFramebuffer::GetRenderPass(const VulkanRenderPass* renderPass) {
+    const uint64_t key = renderPass ? renderPass->GetOpsKey() : VulkanRenderPass::GetLoadStoreKey();
+    if (auto it = m_renderPasses.find(key); it != m_renderPasses.end()) {
+        return it->second;
+    }
+
+    std::vector<VkFormat> formats;
+    std::vector<VkSampleCountFlagBits> samples;
+    std::vector<VkImageLayout> layouts;
+    for (const VulkanTexture* texture : m_attachments) {
+        formats.push_back(texture->GetVkFormat());
+        samples.push_back(texture->GetSamples());
+        layouts.push_back(texture->GetLayout());
+    }
+
+    // Without a render pass every attachment is loaded and stored
+    std::vector<AttachmentDesc> ops(m_attachments.size());
+    for (AttachmentDesc& op : ops) {
+        op.loadOp = AttachmentLoadOp::Load;
+        op.stencilLoadOp = AttachmentLoadOp::Load;
+        op.stencilStoreOp = AttachmentStoreOp::Store;
+    }
+    if (renderPass) {
+        const auto& attachments = renderPass->GetAttachments();
+        std::copy_n(attachments.begin(), std::min(attachments.size(), ops.size()), ops.begin());
+    }
+
+    VkRenderPass handle = VulkanRenderPass::CreateHandle(m_device->GetHandle(), formats, samples, layouts, ops);
+    if (handle != VK_NULL_HANDLE) {
+        m_renderPasses.emplace(key, handle);
+    }
+    return handle;
+}
+
+} // namespace VRHI
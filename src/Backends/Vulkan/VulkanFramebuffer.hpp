@@ -0,0 +1,61 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <VRHI/VRHI.hpp>
+#include <expected>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <VRHI/RenderPass.hpp>
+#include "VulkanLoader.hpp"
+#include "VulkanRenderPass.hpp"
+
+namespace VRHI {
+
+class VulkanDevice;
+class VulkanTexture;
+
+/// Framebuffer implementation
+///
+/// Owns a view per attachment and a VkFramebuffer, plus one VkRenderPass
+/// per combination of load and store ops it has been begun with. Those
+/// passes take the attachments from their resting layouts and return them
+/// there.
+class VulkanFramebuffer : public Framebuffer {
+public:
+    ~VulkanFramebuffer() override;
+
+    static std::expected<std::unique_ptr<Framebuffer>, Error>
+    Create(VulkanDevice& device, const FramebufferDesc& desc);
+
+    uint32_t GetWidth() const noexcept override { return m_width; }
+    uint32_t GetHeight() const noexcept override { return m_height; }
+    uint32_t GetLayers() const noexcept override { return m_layers; }
+
+    VkFramebuffer GetHandle() const noexcept { return m_framebuffer; }
+    const VulkanPassSignature& GetSignature() const noexcept { return m_signature; }
+
+    /// Attachment textures in FramebufferDesc order
+    const std::vector<VulkanTexture*>& GetAttachments() const noexcept { return m_attachments; }
+
+    /// Render pass with the ops of `renderPass`, or loading and storing
+    /// every attachment if it is null
+    VkRenderPass GetRenderPass(const VulkanRenderPass* renderPass);
+
+private:
+    explicit VulkanFramebuffer(VulkanDevice& device) : m_device(&device) {}
+
+    VulkanDevice* m_device;
+    std::vector<VulkanTexture*> m_attachments;
+    std::vector<VkImageView> m_views;
+    VkFramebuffer m_framebuffer = VK_NULL_HANDLE;
+    VulkanPassSignature m_signature;
+    std::unordered_map<uint64_t, VkRenderPass> m_renderPasses;  // By VulkanRenderPass::GetOpsKey()
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint32_t m_layers = 1;
+};
+
+} // namespace VRHI
@@ -0,0 +1,251 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "VulkanInstance.hpp"
+#include <VRHI/Logging.hpp>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+namespace VRHI {
+
+namespace {
+    constexpr const char* ValidationLayer = "VK_LAYER_KHRONOS_validation";
+
+    bool HasInstanceExtension(const std::vector<VkExtensionProperties>& extensions, const char* name) {
+        return std::ranges::any_of(extensions, [name](const VkExtensionProperties& extension) {
+            return std::strcmp(extension.extensionName, name) == 0;
+        });
+    }
+
+    bool HasLayer(const char* name) {
+        uint32_t count = 0;
+        vkEnumerateInstanceLayerProperties(&count, nullptr);
+        std::vector<VkLayerProperties> layers(count);
+        vkEnumerateInstanceLayerProperties(&count, layers.data());
+        return std::ranges::any_of(layers, [name](const VkLayerProperties& layer) {
+            return std::strcmp(layer.layerName, name) == 0;
+        });
+    }
+
+    /// Preference among suitable devices; CPU implementations come last
+    int RankDeviceType(VkPhysicalDeviceType type) {
+        switch (type) {
+            case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: return 4;
+            case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return 3;
+            case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: return 2;
+            case VK_PHYSICAL_DEVICE_TYPE_CPU: return 1;
+            default: return 0;
+        }
+    }
+
+    uint32_t HighestSampleCount(VkSampleCountFlags counts) {
+        return counts == 0 ? 1u : 1u << (31 - std::countl_zero(static_cast<uint32_t>(counts)));
+    }
+}
+
+VulkanInstance::~VulkanInstance() {
+    if (m_instance != VK_NULL_HANDLE) {
+        vkDestroyInstance(m_instance, nullptr);
+    }
+}
+
+std::expected<std::shared_ptr<VulkanInstance>, Error> VulkanInstance::Create(bool enableValidation) {
+    if (!LoadVulkanLibrary()) {
+        return std::unexpected(Error{Error::Code::UnsupportedFeature, "Vulkan loader library not found"});
+    }
+
+    uint32_t apiVersion = VK_API_VERSION_1_0;
+    if (vkEnumerateInstanceVersion) {
+        vkEnumerateInstanceVersion(&apiVersion);
+    }
+    if (apiVersion < VK_API_VERSION_1_2) {
+        return std::unexpected(Error{Error::Code::UnsupportedFeature, "Vulkan 1.2 loader required"});
+    }
+
+    auto instance = std::shared_ptr<VulkanInstance>(new VulkanInstance());
+
+    uint32_t extensionCount = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> available(extensionCount);
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, available.data());
+
+    std::vector<const char*> extensions;
+    if (HasInstanceExtension(available, VK_EXT_DEBUG_UTILS_EXTENSION_NAME)) {
+        extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+        instance->m_debugUtils = true;
+    }
+    // Portability drivers (MoltenVK) are only listed when asked for
+    VkInstanceCreateFlags flags = 0;
+    if (HasInstanceExtension(available, VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME)) {
+        extensions.push_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
+        flags |= VK_INSTANCE_CREATE_ENUMERATE_PORTABILITY_BIT_KHR;
+    }
+
+    std::vector<const char*> layers;
+    if (enableValidation) {
+        if (HasLayer(ValidationLayer)) {
+            layers.push_back(ValidationLayer);
+            instance->m_validation = true;
+        } else {
+            LogWarning("%s is not installed; running without validation", ValidationLayer);
+        }
+    }
+
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pApplicationName = "VRHI";
+    appInfo.pEngineName = "VRHI";
+    appInfo.apiVersion = std::min(apiVersion, static_cast<uint32_t>(VK_API_VERSION_1_3));
+
+    VkInstanceCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    createInfo.flags = flags;
+    createInfo.pApplicationInfo = &appInfo;
+    createInfo.enabledLayerCount = static_cast<uint32_t>(layers.size());
+    createInfo.ppEnabledLayerNames = layers.data();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
+
+    VkResult result = vkCreateInstance(&createInfo, nullptr, &instance->m_instance);
+    if (result != VK_SUCCESS) {
+        return std::unexpected(Error{
+            Error::Code::UnsupportedFeature,
+            "vkCreateInstance failed (VkResult " + std::to_string(result) + ")"
+        });
+    }
+    LoadVulkanInstanceFunctions(instance->m_instance);
+
+    if (!instance->SelectPhysicalDevice()) {
+        return std::unexpected(Error{
+            Error::Code::UnsupportedFeature,
+            "No Vulkan 1.2 device with timeline semaphores and a graphics + compute queue"
+        });
+    }
+    return instance;
+}
+
+bool VulkanInstance::SelectPhysicalDevice() {
+    uint32_t count = 0;
+    vkEnumeratePhysicalDevices(m_instance, &count, nullptr);
+    std::vector<VkPhysicalDevice> devices(count);
+    vkEnumeratePhysicalDevices(m_instance, &count, devices.data());
+
+    int bestRank = -1;
+    for (VkPhysicalDevice device : devices) {
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(device, &properties);
+        if (properties.apiVersion < VK_API_VERSION_1_2) {
+            continue;
+        }
+
+        VkPhysicalDeviceVulkan12Features features12{};
+        features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        VkPhysicalDeviceFeatures2 features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &features12;
+        vkGetPhysicalDeviceFeatures2(device, &features);
+        if (!features12.timelineSemaphore) {
+            continue;
+        }
+
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &familyCount, families.data());
+
+        constexpr VkQueueFlags Required = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
+        for (uint32_t family = 0; family < familyCount; ++family) {
+            if ((families[family].queueFlags & Required) != Required) {
+                continue;
+            }
+            const int rank = RankDeviceType(properties.deviceType);
+            if (rank > bestRank) {
+                bestRank = rank;
+                m_physicalDevice = device;
+                m_properties = properties;
+                m_features = features.features;
+                m_queueFamily = family;
+            }
+            break;
+        }
+    }
+
+    if (m_physicalDevice == VK_NULL_HANDLE) {
+        return false;
+    }
+    vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_memoryProperties);
+    return true;
+}
+
+FeatureSet VulkanInstance::DetectFeatures() const {
+    const VkPhysicalDeviceLimits& limits = m_properties.limits;
+    FeatureSet features{};
+
+    features.core.vertexShader = true;
+    features.core.fragmentShader = true;
+    features.core.geometryShader = m_features.geometryShader;
+    features.core.tessellationShader = m_features.tessellationShader;
+    features.core.computeShader = true;
+    features.core.uniformBuffers = true;
+    features.core.storageBuffers = true;
+    features.core.vertexBuffers = true;
+    features.core.indexBuffers = true;
+    features.core.indirectBuffers = true;
+    features.core.instancing = true;
+    features.core.multiDrawIndirect = m_features.multiDrawIndirect;
+
+    features.texture.texture1D = true;
+    features.texture.texture2D = true;
+    features.texture.texture3D = true;
+    features.texture.textureCube = true;
+    features.texture.texture2DArray = true;
+    features.texture.floatTextures = true;
+    features.texture.depthTextures = true;
+    features.texture.dxt = m_features.textureCompressionBC;
+    features.texture.etc2 = m_features.textureCompressionETC2;
+    features.texture.astc = m_features.textureCompressionASTC_LDR;
+    features.texture.compressedTextures = features.texture.dxt || features.texture.etc2 || features.texture.astc;
+    features.texture.anisotropicFiltering = m_features.samplerAnisotropy;
+    features.texture.maxTextureSize = limits.maxImageDimension2D;
+    features.texture.max3DTextureSize = limits.maxImageDimension3D;
+    features.texture.maxArrayLayers = limits.maxImageArrayLayers;
+    features.texture.maxAnisotropy = m_features.samplerAnisotropy ? limits.maxSamplerAnisotropy : 1.0f;
+
+    features.rendering.multipleRenderTargets = limits.maxColorAttachments > 1;
+    features.rendering.maxColorAttachments = limits.maxColorAttachments;
+    features.rendering.independentBlend = m_features.independentBlend;
+    features.rendering.depthClamp = m_features.depthClamp;
+    features.rendering.maxSamples = HighestSampleCount(limits.framebufferColorSampleCounts &
+                                                       limits.framebufferDepthSampleCounts);
+    features.rendering.multisample = features.rendering.maxSamples > 1;
+
+    features.compute.computeShader = true;
+    features.compute.maxWorkGroupSizeX = limits.maxComputeWorkGroupSize[0];
+    features.compute.maxWorkGroupSizeY = limits.maxComputeWorkGroupSize[1];
+    features.compute.maxWorkGroupSizeZ = limits.maxComputeWorkGroupSize[2];
+    features.compute.maxWorkGroupInvocations = limits.maxComputeWorkGroupInvocations;
+    features.compute.maxComputeSharedMemorySize = limits.maxComputeSharedMemorySize;
+
+    for (uint32_t i = 0; i < m_memoryProperties.memoryHeapCount; ++i) {
+        const VkMemoryHeap& heap = m_memoryProperties.memoryHeaps[i];
+        if (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+            features.memory.deviceLocalMemory += heap.size;
+        }
+    }
+    for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; ++i) {
+        const VkMemoryType& type = m_memoryProperties.memoryTypes[i];
+        if (type.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+            features.memory.hostVisibleMemory = std::max(features.memory.hostVisibleMemory,
+                                                         m_memoryProperties.memoryHeaps[type.heapIndex].size);
+        }
+    }
+    features.memory.minUniformBufferAlignment = static_cast<uint32_t>(limits.minUniformBufferOffsetAlignment);
+    features.memory.minStorageBufferAlignment = static_cast<uint32_t>(limits.minStorageBufferOffsetAlignment);
+    features.memory.unifiedMemory = m_properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU ||
+                                    m_properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU;
+    return features;
+}
+
+} // namespace VRHI
@@ -0,0 +1,61 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/VRHI.hpp>
+#include "VulkanLoader.hpp"
+#include <expected>
+#include <memory>
+
+namespace VRHI {
+
+/// A VkInstance and the physical device VRHI runs on.
+///
+/// The backend creates one to probe for Vulkan support and hands it to the
+/// devices it creates, which keep it alive through a shared_ptr (backends
+/// are destroyed as soon as their device exists).
+class VulkanInstance {
+public:
+    ~VulkanInstance();
+
+    VulkanInstance(const VulkanInstance&) = delete;
+    VulkanInstance& operator=(const VulkanInstance&) = delete;
+
+    /// Create an instance and pick the best physical device that supports
+    /// Vulkan 1.2 with timeline semaphores and a graphics + compute queue.
+    /// @param enableValidation Enable VK_LAYER_KHRONOS_validation if installed
+    /// @return UnsupportedFeature if there is no loader or no suitable device
+    static std::expected<std::shared_ptr<VulkanInstance>, Error> Create(bool enableValidation);
+
+    VkInstance GetHandle() const noexcept { return m_instance; }
+    VkPhysicalDevice GetPhysicalDevice() const noexcept { return m_physicalDevice; }
+    const VkPhysicalDeviceProperties& GetProperties() const noexcept { return m_properties; }
+    const VkPhysicalDeviceFeatures& GetFeatures() const noexcept { return m_features; }
+    const VkPhysicalDeviceMemoryProperties& GetMemoryProperties() const noexcept { return m_memoryProperties; }
+
+    /// Family of the queue all work is submitted to
+    uint32_t GetQueueFamily() const noexcept { return m_queueFamily; }
+
+    bool HasDebugUtils() const noexcept { return m_debugUtils; }
+    bool HasValidation() const noexcept { return m_validation; }
+
+    /// Features of the physical device in VRHI terms
+    FeatureSet DetectFeatures() const;
+
+private:
+    VulkanInstance() = default;
+
+    bool SelectPhysicalDevice();
+
+    VkInstance m_instance = VK_NULL_HANDLE;
+    VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
+    VkPhysicalDeviceProperties m_properties{};
+    VkPhysicalDeviceFeatures m_features{};
+    VkPhysicalDeviceMemoryProperties m_memoryProperties{};
+    uint32_t m_queueFamily = 0;
+    bool m_debugUtils = false;
+    bool m_validation = false;
+};
+
+} // namespace VRHI
@@ -0,0 +1,93 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "VulkanLoader.hpp"
+#include <VRHI/Logging.hpp>
+#include <mutex>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace VRHI {
+
+#define VRHI_VK_DEFINE_FUNCTION(name) PFN_##name name = nullptr;
+PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr = nullptr;
+VRHI_VK_GLOBAL_FUNCTIONS(VRHI_VK_DEFINE_FUNCTION)
+VRHI_VK_INSTANCE_FUNCTIONS(VRHI_VK_DEFINE_FUNCTION)
+VRHI_VK_DEVICE_FUNCTIONS(VRHI_VK_DEFINE_FUNCTION)
+VRHI_VK_DEBUG_UTILS_FUNCTIONS(VRHI_VK_DEFINE_FUNCTION)
+#undef VRHI_VK_DEFINE_FUNCTION
+
+namespace {
+    std::once_flag g_libraryOnce;
+    bool g_libraryLoaded = false;
+
+    void* OpenLibrary() {
+#if defined(_WIN32)
+        return reinterpret_cast<void*>(LoadLibraryA("vulkan-1.dll"));
+#elif defined(__APPLE__)
+        for (const char* name : {"libvulkan.1.dylib", "libvulkan.dylib", "libMoltenVK.dylib"}) {
+            if (void* library = dlopen(name, RTLD_NOW | RTLD_LOCAL)) {
+                return library;
+            }
+        }
+        return nullptr;
+#else
+        for (const char* name : {"libvulkan.so.1", "libvulkan.so"}) {
+            if (void* library = dlopen(name, RTLD_NOW | RTLD_LOCAL)) {
+                return library;
+            }
+        }
+        return nullptr;
+#endif
+    }
+
+    PFN_vkGetInstanceProcAddr GetEntryPoint(void* library) {
+#ifdef _WIN32
+        return reinterpret_cast<PFN_vkGetInstanceProcAddr>(
+            GetProcAddress(static_cast<HMODULE>(library), "vkGetInstanceProcAddr"));
+#else
+        return reinterpret_cast<PFN_vkGetInstanceProcAddr>(dlsym(library, "vkGetInstanceProcAddr"));
+#endif
+    }
+}
+
+bool LoadVulkanLibrary() {
+    std::call_once(g_libraryOnce, []() {
+        // The library stays loaded for the lifetime of the process
+        void* library = OpenLibrary();
+        if (!library) {
+            LogInfo("Vulkan loader library not found");
+            return;
+        }
+
+        vkGetInstanceProcAddr = GetEntryPoint(library);
+        if (!vkGetInstanceProcAddr) {
+            LogWarning("Vulkan loader library does not export vkGetInstanceProcAddr");
+            return;
+        }
+
+#define VRHI_VK_LOAD_GLOBAL(name) name = reinterpret_cast<PFN_##name>(vkGetInstanceProcAddr(VK_NULL_HANDLE, #name));
+        VRHI_VK_GLOBAL_FUNCTIONS(VRHI_VK_LOAD_GLOBAL)
+#undef VRHI_VK_LOAD_GLOBAL
+
+        g_libraryLoaded = vkCreateInstance != nullptr;
+    });
+    return g_libraryLoaded;
+}
+
+void LoadVulkanInstanceFunctions(VkInstance instance) {
+#define VRHI_VK_LOAD_INSTANCE(name) name = reinterpret_cast<PFN_##name>(vkGetInstanceProcAddr(instance, #name));
+    VRHI_VK_INSTANCE_FUNCTIONS(VRHI_VK_LOAD_INSTANCE)
+    VRHI_VK_DEVICE_FUNCTIONS(VRHI_VK_LOAD_INSTANCE)
+    VRHI_VK_DEBUG_UTILS_FUNCTIONS(VRHI_VK_LOAD_INSTANCE)
+#undef VRHI_VK_LOAD_INSTANCE
+}
+
+} // namespace VRHI
@@ -0,0 +1,172 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+// The Vulkan library is loaded at runtime, so VRHI links and runs on machines
+// without a Vulkan driver and the backend simply reports itself unavailable
+#ifndef VK_NO_PROTOTYPES
+#define VK_NO_PROTOTYPES
+#endif
+#include <vulkan/vulkan_core.h>
+
+// ============================================================================
+// Function Lists
+// ============================================================================
+
+/// Functions available before an instance exists
+#define VRHI_VK_GLOBAL_FUNCTIONS(X) \
+    X(vkCreateInstance) \
+    X(vkEnumerateInstanceVersion) \
+    X(vkEnumerateInstanceExtensionProperties) \
+    X(vkEnumerateInstanceLayerProperties)
+
+#define VRHI_VK_INSTANCE_FUNCTIONS(X) \
+    X(vkDestroyInstance) \
+    X(vkEnumeratePhysicalDevices) \
+    X(vkGetPhysicalDeviceProperties) \
+    X(vkGetPhysicalDeviceFeatures) \
+    X(vkGetPhysicalDeviceFeatures2) \
+    X(vkGetPhysicalDeviceProperties2) \
+    X(vkGetPhysicalDeviceQueueFamilyProperties) \
+    X(vkGetPhysicalDeviceMemoryProperties) \
+    X(vkGetPhysicalDeviceFormatProperties) \
+    X(vkEnumerateDeviceExtensionProperties) \
+    X(vkCreateDevice)
+
+#define VRHI_VK_DEVICE_FUNCTIONS(X) \
+    X(vkDestroyDevice) \
+    X(vkGetDeviceQueue) \
+    X(vkQueueSubmit) \
+    X(vkDeviceWaitIdle) \
+    X(vkAllocateMemory) \
+    X(vkFreeMemory) \
+    X(vkMapMemory) \
+    X(vkUnmapMemory) \
+    X(vkFlushMappedMemoryRanges) \
+    X(vkInvalidateMappedMemoryRanges) \
+    X(vkCreateBuffer) \
+    X(vkDestroyBuffer) \
+    X(vkGetBufferMemoryRequirements) \
+    X(vkBindBufferMemory) \
+    X(vkCreateImage) \
+    X(vkDestroyImage) \
+    X(vkGetImageMemoryRequirements) \
+    X(vkBindImageMemory) \
+    X(vkCreateImageView) \
+    X(vkDestroyImageView) \
+    X(vkCreateSampler) \
+    X(vkDestroySampler) \
+    X(vkCreateShaderModule) \
+    X(vkDestroyShaderModule) \
+    X(vkCreatePipelineCache) \
+    X(vkDestroyPipelineCache) \
+    X(vkCreateGraphicsPipelines) \
+    X(vkCreateComputePipelines) \
+    X(vkDestroyPipeline) \
+    X(vkCreatePipelineLayout) \
+    X(vkDestroyPipelineLayout) \
+    X(vkCreateDescriptorSetLayout) \
+    X(vkDestroyDescriptorSetLayout) \
+    X(vkCreateDescriptorPool) \
+    X(vkDestroyDescriptorPool) \
+    X(vkResetDescriptorPool) \
+    X(vkAllocateDescriptorSets) \
+    X(vkUpdateDescriptorSets) \
+    X(vkCreateRenderPass) \
+    X(vkDestroyRenderPass) \
+    X(vkCreateFramebuffer) \
+    X(vkDestroyFramebuffer) \
+    X(vkCreateCommandPool) \
+    X(vkDestroyCommandPool) \
+    X(vkAllocateCommandBuffers) \
+    X(vkFreeCommandBuffers) \
+    X(vkResetCommandBuffer) \
+    X(vkBeginCommandBuffer) \
+    X(vkEndCommandBuffer) \
+    X(vkCreateSemaphore) \
+    X(vkDestroySemaphore) \
+    X(vkWaitSemaphores) \
+    X(vkGetSemaphoreCounterValue) \
+    X(vkCmdBeginRenderPass) \
+    X(vkCmdEndRenderPass) \
+    X(vkCmdBindPipeline) \
+    X(vkCmdBindVertexBuffers) \
+    X(vkCmdBindIndexBuffer) \
+    X(vkCmdBindDescriptorSets) \
+    X(vkCmdPushConstants) \
+    X(vkCmdSetViewport) \
+    X(vkCmdSetScissor) \
+    X(vkCmdSetLineWidth) \
+    X(vkCmdSetBlendConstants) \
+    X(vkCmdSetDepthBias) \
+    X(vkCmdSetDepthBounds) \
+    X(vkCmdSetStencilCompareMask) \
+    X(vkCmdSetStencilWriteMask) \
+    X(vkCmdSetStencilReference) \
+    X(vkCmdDraw) \
+    X(vkCmdDrawIndexed) \
+    X(vkCmdDrawIndirect) \
+    X(vkCmdDrawIndexedIndirect) \
+    X(vkCmdDispatch) \
+    X(vkCmdDispatchIndirect) \
+    X(vkCmdClearAttachments) \
+    X(vkCmdCopyBuffer) \
+    X(vkCmdUpdateBuffer) \
+    X(vkCmdCopyBufferToImage) \
+    X(vkCmdCopyImageToBuffer) \
+    X(vkCmdCopyImage) \
+    X(vkCmdBlitImage) \
+    X(vkCmdPipelineBarrier)
+
+/// VK_EXT_debug_utils; null when the instance does not expose it
+#define VRHI_VK_DEBUG_UTILS_FUNCTIONS(X) \
+    X(vkCmdBeginDebugUtilsLabelEXT) \
+    X(vkCmdEndDebugUtilsLabelEXT) \
+    X(vkCmdInsertDebugUtilsLabelEXT) \
+    X(vkSetDebugUtilsObjectNameEXT)
+
+namespace VRHI {
+
+// ============================================================================
+// Function Pointers
+// ============================================================================
+
+#define VRHI_VK_DECLARE_FUNCTION(name) extern PFN_##name name;
+extern PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr;
+VRHI_VK_GLOBAL_FUNCTIONS(VRHI_VK_DECLARE_FUNCTION)
+VRHI_VK_INSTANCE_FUNCTIONS(VRHI_VK_DECLARE_FUNCTION)
+VRHI_VK_DEVICE_FUNCTIONS(VRHI_VK_DECLARE_FUNCTION)
+VRHI_VK_DEBUG_UTILS_FUNCTIONS(VRHI_VK_DECLARE_FUNCTION)
+#undef VRHI_VK_DECLARE_FUNCTION
+
+/// A non-dispatchable handle as the uint64_t that generic Vulkan APIs take
+/// (handles are pointers on 64-bit platforms and integers on 32-bit ones)
+template<typename T>
+inline uint64_t ToObjectHandle(T handle) noexcept {
+    return (uint64_t)(handle);
+}
+
+/// The handle of type T that ToObjectHandle() returned `handle` for
+template<typename T>
+inline T FromObjectHandle(uint64_t handle) noexcept {
+    return (T)(handle);
+}
+
+// ============================================================================
+// Loading
+// ============================================================================
+
+/// Open the Vulkan loader library and resolve the global functions.
+/// Safe to call repeatedly; only the first call does any work.
+/// @return false if no Vulkan library is installed
+bool LoadVulkanLibrary();
+
+/// Resolve the instance and device functions through `instance`.
+///
+/// Device functions are also resolved with vkGetInstanceProcAddr: the loader
+/// then hands out dispatching entry points, which stay valid for every
+/// device, so several VRHI devices can share the one set of pointers.
+void LoadVulkanInstanceFunctions(VkInstance instance);
+
+} // namespace VRHI
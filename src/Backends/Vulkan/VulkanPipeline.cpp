@@ -0,0 +1,422 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "VulkanPipeline.hpp"
+#include "VulkanDevice.hpp"
+#include "VulkanFormatUtils.hpp"
+#include "VulkanShader.hpp"
+#include <VRHI/Logging.hpp>
+#include <algorithm>
+
+namespace VRHI {
+
+namespace {
+    /// Bindings are visible to every stage, so pipelines whose shaders
+    /// declare the same bindings share one layout
+    constexpr VkShaderStageFlags AllStages = VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT;
+
+    bool HasDynamicState(std::span<const DynamicState> states, DynamicState state) {
+        return std::ranges::find(states, state) != states.end();
+    }
+
+    VkShaderStageFlagBits GetStage(ShaderStage stage) {
+        return static_cast<VkShaderStageFlagBits>(VulkanFormatUtils::GetShaderStages(stage));
+    }
+}
+
+VulkanPipeline::~VulkanPipeline() {
+    for (const auto& [signature, pipeline] : m_variants) {
+        m_device->Retire(VK_OBJECT_TYPE_PIPELINE, ToObjectHandle(pipeline));
+    }
+    m_device->Retire(VK_OBJECT_TYPE_PIPELINE, ToObjectHandle(m_compute));
+    for (const Stage& stage : m_stages) {
+        m_device->Retire(VK_OBJECT_TYPE_SHADER_MODULE, ToObjectHandle(stage.module));
+    }
+}
+
+std::expected<std::unique_ptr<Pipeline>, Error>
+VulkanPipeline::Create(VulkanDevice& device, const PipelineDesc& desc) {
+    std::unique_ptr<VulkanPipeline> pipeline(new VulkanPipeline(device));
+    pipeline->m_type = desc.type;
+
+    std::vector<Shader*> shaders;
+    if (desc.type == PipelineType::Compute) {
+        shaders.push_back(desc.compute.computeShader);
+        pipeline->m_debugName = desc.compute.debugName ? desc.compute.debugName : "";
+    } else {
+        const GraphicsPipelineDesc& graphics = desc.graphics;
+        for (Shader* shader : {graphics.vertexShader, graphics.tessControlShader, graphics.tessEvalShader,
+                               graphics.geometryShader, graphics.fragmentShader}) {
+            if (shader) {
+                shaders.push_back(shader);
+            }
+        }
+        if (!graphics.vertexShader) {
+            shaders.clear();
+        }
+        pipeline->m_debugName = graphics.debugName ? graphics.debugName : "";
+    }
+    if (shaders.empty() || !shaders[0]) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            desc.type == PipelineType::Compute ? "Compute pipelines need a compute shader"
+                                               : "Graphics pipelines need a vertex shader"
+        });
+    }
+
+    for (Shader* shader : shaders) {
+        auto* vkShader = static_cast<VulkanShader*>(shader);
+        VkShaderModuleCreateInfo moduleInfo{};
+        moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        moduleInfo.codeSize = vkShader->GetSPIRV().size() * sizeof(uint32_t);
+        moduleInfo.pCode = vkShader->GetSPIRV().data();
+
+        VkShaderModule module = VK_NULL_HANDLE;
+        if (vkCreateShaderModule(device.GetHandle(), &moduleInfo, nullptr, &module) != VK_SUCCESS) {
+            return std::unexpected(Error{
+                Error::Code::ShaderCompilationFailed,
+                "Failed to create Vulkan shader module"
+            });
+        }
+        pipeline->m_stages.push_back({GetStage(shader->GetStage()), module, std::string(shader->GetEntryPoint())});
+    }
+
+    auto layout = pipeline->CreateLayout(shaders);
+    if (!layout) {
+        return std::unexpected(layout.error());
+    }
+
+    if (desc.type == PipelineType::Compute) {
+        const Stage& stage = pipeline->m_stages[0];
+        VkComputePipelineCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        createInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        createInfo.stage.stage = stage.stage;
+        createInfo.stage.module = stage.module;
+        createInfo.stage.pName = stage.entryPoint.c_str();
+        createInfo.layout = pipeline->m_layout.pipelineLayout;
+        if (vkCreateComputePipelines(device.GetHandle(), device.GetPipelineCache(), 1, &createInfo, nullptr,
+                                     &pipeline->m_compute) != VK_SUCCESS) {
+            return std::unexpected(Error{
+                Error::Code::InitializationFailed,
+                "Failed to create Vulkan compute pipeline"
+            });
+        }
+        device.SetObjectName(VK_OBJECT_TYPE_PIPELINE, ToObjectHandle(pipeline->m_compute), desc.compute.debugName);
+        return std::unique_ptr<Pipeline>(std::move(pipeline));
+    }
+
+    // Keep the graphics state; the arrays it points to may not outlive the desc
+    const GraphicsPipelineDesc& graphics = desc.graphics;
+    pipeline->m_desc = graphics;
+    pipeline->m_vertexAttributes.assign(graphics.vertexInput.attributes.begin(), graphics.vertexInput.attributes.end());
+    pipeline->m_vertexBindings.assign(graphics.vertexInput.bindings.begin(), graphics.vertexInput.bindings.end());
+    pipeline->m_blendAttachments.assign(graphics.colorBlend.attachments.begin(), graphics.colorBlend.attachments.end());
+    pipeline->m_dynamicStates.assign(graphics.dynamicStates.begin(), graphics.dynamicStates.end());
+    if (graphics.multisample.sampleMask) {
+        pipeline->m_sampleMask = *graphics.multisample.sampleMask;
+    }
+    pipeline->m_desc.vertexInput = {pipeline->m_vertexAttributes, pipeline->m_vertexBindings};
+    pipeline->m_desc.colorBlend.attachments = pipeline->m_blendAttachments;
+    pipeline->m_desc.dynamicStates = pipeline->m_dynamicStates;
+    pipeline->m_desc.multisample.sampleMask = nullptr;
+    pipeline->m_desc.debugName = nullptr;
+
+    // State that is dynamic in every Vulkan pipeline but static in VRHI's
+    VulkanPipelineState& state = pipeline->m_state;
+    const auto dynamicStates = pipeline->m_desc.dynamicStates;
+    state.lineWidth = !HasDynamicState(dynamicStates, DynamicState::LineWidth);
+    state.lineWidthValue = graphics.rasterization.lineWidth;
+    state.depthBias = !HasDynamicState(dynamicStates, DynamicState::DepthBias);
+    if (graphics.rasterization.depthBiasEnable) {
+        state.depthBiasValues[0] = graphics.rasterization.depthBiasConstantFactor;
+        state.depthBiasValues[1] = graphics.rasterization.depthBiasClamp;
+        state.depthBiasValues[2] = graphics.rasterization.depthBiasSlopeFactor;
+    }
+    state.blendConstants = !HasDynamicState(dynamicStates, DynamicState::BlendConstants);
+    std::ranges::copy(graphics.colorBlend.blendConstants, state.blendConstantValues);
+    state.stencil = !HasDynamicState(dynamicStates, DynamicState::StencilCompareMask) &&
+                    !HasDynamicState(dynamicStates, DynamicState::StencilWriteMask) &&
+                    !HasDynamicState(dynamicStates, DynamicState::StencilReference);
+    const DepthStencilState& depthStencil = graphics.depthStencil;
+    state.compareMask[0] = depthStencil.front.compareMask;
+    state.compareMask[1] = depthStencil.back.compareMask;
+    state.writeMask[0] = depthStencil.front.writeMask;
+    state.writeMask[1] = depthStencil.back.writeMask;
+    state.reference[0] = depthStencil.front.reference;
+    state.reference[1] = depthStencil.back.reference;
+    state.depthBounds = device.GetEnabledFeatures().depthBounds &&
+                        !HasDynamicState(dynamicStates, DynamicState::DepthBounds);
+    state.depthBoundsValues[0] = depthStencil.minDepthBounds;
+    state.depthBoundsValues[1] = depthStencil.maxDepthBounds;
+
+    if (auto* renderPass = static_cast<const VulkanRenderPass*>(graphics.renderPass)) {
+        if (pipeline->GetHandle(renderPass->GetSignature(), renderPass->GetHandle()) == VK_NULL_HANDLE) {
+            return std::unexpected(Error{
+                Error::Code::InitializationFailed,
+                "Failed to create Vulkan graphics pipeline"
+            });
+        }
+    }
+    return std::unique_ptr<Pipeline>(std::move(pipeline));
+}
+
+std::expected<void, Error> VulkanPipeline::CreateLayout(std::span<Shader* const> shaders) {
+    std::vector<ShaderResourceBinding> resources;
+    for (Shader* shader : shaders) {
+        for (const ShaderResourceBinding& resource : static_cast<VulkanShader*>(shader)->GetReflection().bindings) {
+            if (resource.set != 0) {
+                return std::unexpected(Error{
+                    Error::Code::ValidationError,
+                    "Shader resource '" + resource.name + "' is not in descriptor set 0, the only one VRHI binds"
+                });
+            }
+            if (resource.count != 1) {
+                return std::unexpected(Error{
+                    Error::Code::UnsupportedFeature,
+                    "Shader resource '" + resource.name + "' is an array, which the Vulkan backend cannot bind"
+                });
+            }
+            if (resource.type == ShaderResourceType::SeparateTexture ||
+                resource.type == ShaderResourceType::SeparateSampler) {
+                return std::unexpected(Error{
+                    Error::Code::UnsupportedFeature,
+                    "Shader resource '" + resource.name + "' is a separate texture or sampler; use combined samplers"
+                });
+            }
+
+            auto existing = std::ranges::find(resources, resource.binding, &ShaderResourceBinding::binding);
+            if (existing == resources.end()) {
+                resources.push_back(resource);
+            } else if (existing->type != resource.type) {
+                return std::unexpected(Error{
+                    Error::Code::ValidationError,
+                    "Shader stages declare different resources at binding " + std::to_string(resource.binding)
+                });
+            }
+        }
+    }
+    std::ranges::sort(resources, {}, &ShaderResourceBinding::binding);
+
+    // Dynamic buffer descriptors as far as the limits allow
+    const VkPhysicalDeviceLimits& limits = m_device->GetLimits();
+    auto countOf = [&resources](ShaderResourceType type) {
+        return static_cast<uint32_t>(std::ranges::count(resources, type, &ShaderResourceBinding::type));
+    };
+    const bool dynamicUniforms = countOf(ShaderResourceType::UniformBuffer) <= limits.maxDescriptorSetUniformBuffersDynamic;
+    const bool dynamicStorage = countOf(ShaderResourceType::StorageBuffer) <= limits.maxDescriptorSetStorageBuffersDynamic;
+
+    std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
+    for (const ShaderResourceBinding& resource : resources) {
+        VkDescriptorType type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        switch (resource.type) {
+            case ShaderResourceType::UniformBuffer:
+                type = dynamicUniforms ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                break;
+            case ShaderResourceType::StorageBuffer:
+                type = dynamicStorage ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                break;
+            case ShaderResourceType::StorageTexture:
+                type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                break;
+            default:
+                break;
+        }
+        layoutBindings.push_back({resource.binding, type, 1, AllStages, nullptr});
+        m_bindings.push_back({resource.binding, type});
+    }
+
+    m_layout = m_device->GetPipelineLayout(layoutBindings);
+    if (m_layout.pipelineLayout == VK_NULL_HANDLE) {
+        return std::unexpected(Error{
+            Error::Code::InitializationFailed,
+            "Failed to create Vulkan pipeline layout"
+        });
+    }
+    return {};
+}
+
+VkPipeline VulkanPipeline::GetHandle(const VulkanPassSignature& signature, VkRenderPass renderPass) {
+    if (m_type == PipelineType::Compute) {
+        return m_compute;
+    }
+    if (auto it = m_variants.find(signature); it != m_variants.end()) {
+        return it->second;
+    }
+
+    // Failures are remembered too, so they are reported once
+    VkPipeline pipeline = CreateGraphics(signature, renderPass);
+    m_variants.emplace(signature, pipeline);
+    if (pipeline == VK_NULL_HANDLE) {
+        LogError("Failed to create Vulkan graphics pipeline '%s' for a render pass", m_debugName.c_str());
+    }
+    return pipeline;
+}
+
+VkPipeline VulkanPipeline::CreateGraphics(const VulkanPassSignature& signature, VkRenderPass renderPass) const {
+    const VkPhysicalDeviceFeatures& features = m_device->GetEnabledFeatures();
+
+    std::vector<VkPipelineShaderStageCreateInfo> stages;
+    bool hasTessellation = false;
+    for (const Stage& stage : m_stages) {
+        VkPipelineShaderStageCreateInfo stageInfo{};
+        stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stageInfo.stage = stage.stage;
+        stageInfo.module = stage.module;
+        stageInfo.pName = stage.entryPoint.c_str();
+        stages.push_back(stageInfo);
+        hasTessellation |= stage.stage == VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+    }
+
+    std::vector<VkVertexInputBindingDescription> bindings;
+    for (const VertexBinding& binding : m_vertexBindings) {
+        bindings.push_back({binding.binding, binding.stride,
+                            binding.inputRate == VertexInputRate::Instance ? VK_VERTEX_INPUT_RATE_INSTANCE
+                                                                           : VK_VERTEX_INPUT_RATE_VERTEX});
+    }
+    std::vector<VkVertexInputAttributeDescription> attributes;
+    for (const VertexAttribute& attribute : m_vertexAttributes) {
+        attributes.push_back({attribute.location, attribute.binding,
+                              VulkanFormatUtils::GetVertexFormat(attribute.format), attribute.offset});
+    }
+    VkPipelineVertexInputStateCreateInfo vertexInput{};
+    vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInput.vertexBindingDescriptionCount = static_cast<uint32_t>(bindings.size());
+    vertexInput.pVertexBindingDescriptions = bindings.data();
+    vertexInput.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributes.size());
+    vertexInput.pVertexAttributeDescriptions = attributes.data();
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VulkanFormatUtils::GetTopology(m_desc.inputAssembly.topology);
+    inputAssembly.primitiveRestartEnable = m_desc.inputAssembly.primitiveRestartEnable;
+
+    // VRHI has no patch size; triangles are the common case
+    VkPipelineTessellationStateCreateInfo tessellation{};
+    tessellation.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
+    tessellation.patchControlPoints = 3;
+
+    // OpenGL's [-1, 1] clip space depth where the device allows it
+    VkPipelineViewportDepthClipControlCreateInfoEXT depthClipControl{};
+    depthClipControl.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_DEPTH_CLIP_CONTROL_CREATE_INFO_EXT;
+    depthClipControl.negativeOneToOne = VK_TRUE;
+    VkPipelineViewportStateCreateInfo viewport{};
+    viewport.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewport.pNext = m_device->HasDepthClipControl() ? &depthClipControl : nullptr;
+    viewport.viewportCount = 1;
+    viewport.scissorCount = 1;
+
+    const RasterizationState& rasterizationDesc = m_desc.rasterization;
+    VkPipelineRasterizationStateCreateInfo rasterization{};
+    rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterization.depthClampEnable = rasterizationDesc.depthClampEnable && features.depthClamp;
+    rasterization.rasterizerDiscardEnable = rasterizationDesc.rasterizerDiscardEnable;
+    rasterization.polygonMode = features.fillModeNonSolid ? VulkanFormatUtils::GetPolygonMode(rasterizationDesc.polygonMode)
+                                                          : VK_POLYGON_MODE_FILL;
+    rasterization.cullMode = VulkanFormatUtils::GetCullMode(rasterizationDesc.cullMode);
+    rasterization.frontFace = VulkanFormatUtils::GetFrontFace(rasterizationDesc.frontFace);
+    rasterization.depthBiasEnable = rasterizationDesc.depthBiasEnable ||
+                                    HasDynamicState(m_desc.dynamicStates, DynamicState::DepthBias);
+    rasterization.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo multisample{};
+    multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisample.rasterizationSamples = signature.samples;
+    multisample.sampleShadingEnable = m_desc.multisample.sampleShadingEnable && features.sampleRateShading;
+    multisample.minSampleShading = m_desc.multisample.minSampleShading;
+    multisample.pSampleMask = &m_sampleMask;
+    multisample.alphaToCoverageEnable = m_desc.multisample.alphaToCoverageEnable;
+    multisample.alphaToOneEnable = m_desc.multisample.alphaToOneEnable && features.alphaToOne;
+
+    auto getStencilOp = [](const StencilOpState& op) {
+        VkStencilOpState state{};
+        state.failOp = VulkanFormatUtils::GetStencilOp(op.failOp);
+        state.passOp = VulkanFormatUtils::GetStencilOp(op.passOp);
+        state.depthFailOp = VulkanFormatUtils::GetStencilOp(op.depthFailOp);
+        state.compareOp = VulkanFormatUtils::GetCompareOp(op.compareOp);
+        return state;
+    };
+    const DepthStencilState& depthStencilDesc = m_desc.depthStencil;
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = depthStencilDesc.depthTestEnable;
+    depthStencil.depthWriteEnable = depthStencilDesc.depthWriteEnable;
+    depthStencil.depthCompareOp = VulkanFormatUtils::GetCompareOp(depthStencilDesc.depthCompareOp);
+    depthStencil.depthBoundsTestEnable = depthStencilDesc.depthBoundsTestEnable && features.depthBounds;
+    depthStencil.stencilTestEnable = depthStencilDesc.stencilTestEnable;
+    depthStencil.front = getStencilOp(depthStencilDesc.front);
+    depthStencil.back = getStencilOp(depthStencilDesc.back);
+    depthStencil.minDepthBounds = depthStencilDesc.minDepthBounds;
+    depthStencil.maxDepthBounds = depthStencilDesc.maxDepthBounds;
+
+    // One blend state per color attachment of the pass; without
+    // independent blending they must all match the first
+    std::vector<VkPipelineColorBlendAttachmentState> blendAttachments;
+    for (size_t i = 0; i < signature.colorFormats.size(); ++i) {
+        ColorBlendAttachment blend{};
+        if (!m_blendAttachments.empty()) {
+            blend = m_blendAttachments[features.independentBlend ? std::min(i, m_blendAttachments.size() - 1) : 0];
+        }
+        VkPipelineColorBlendAttachmentState state{};
+        state.blendEnable = blend.blendEnable;
+        state.srcColorBlendFactor = VulkanFormatUtils::GetBlendFactor(blend.srcColorBlendFactor);
+        state.dstColorBlendFactor = VulkanFormatUtils::GetBlendFactor(blend.dstColorBlendFactor);
+        state.colorBlendOp = VulkanFormatUtils::GetBlendOp(blend.colorBlendOp);
+        state.srcAlphaBlendFactor = VulkanFormatUtils::GetBlendFactor(blend.srcAlphaBlendFactor);
+        state.dstAlphaBlendFactor = VulkanFormatUtils::GetBlendFactor(blend.dstAlphaBlendFactor);
+        state.alphaBlendOp = VulkanFormatUtils::GetBlendOp(blend.alphaBlendOp);
+        state.colorWriteMask = static_cast<VkColorComponentFlags>(blend.colorWriteMask);
+        blendAttachments.push_back(state);
+    }
+    VkPipelineColorBlendStateCreateInfo colorBlend{};
+    colorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlend.attachmentCount = static_cast<uint32_t>(blendAttachments.size());
+    colorBlend.pAttachments = blendAttachments.data();
+
+    // Everything a VRHI command can set is dynamic
+    std::vector<VkDynamicState> dynamicStates = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR,
+        VK_DYNAMIC_STATE_LINE_WIDTH,
+        VK_DYNAMIC_STATE_DEPTH_BIAS,
+        VK_DYNAMIC_STATE_BLEND_CONSTANTS,
+        VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK,
+        VK_DYNAMIC_STATE_STENCIL_WRITE_MASK,
+        VK_DYNAMIC_STATE_STENCIL_REFERENCE,
+    };
+    if (features.depthBounds) {
+        dynamicStates.push_back(VK_DYNAMIC_STATE_DEPTH_BOUNDS);
+    }
+    VkPipelineDynamicStateCreateInfo dynamic{};
+    dynamic.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamic.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+    dynamic.pDynamicStates = dynamicStates.data();
+
+    VkGraphicsPipelineCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    createInfo.stageCount = static_cast<uint32_t>(stages.size());
+    createInfo.pStages = stages.data();
+    createInfo.pVertexInputState = &vertexInput;
+    createInfo.pInputAssemblyState = &inputAssembly;
+    createInfo.pTessellationState = hasTessellation ? &tessellation : nullptr;
+    createInfo.pViewportState = &viewport;
+    createInfo.pRasterizationState = &rasterization;
+    createInfo.pMultisampleState = &multisample;
+    createInfo.pDepthStencilState = signature.depthFormat != VK_FORMAT_UNDEFINED ? &depthStencil : nullptr;
+    createInfo.pColorBlendState = &colorBlend;
+    createInfo.pDynamicState = &dynamic;
+    createInfo.layout = m_layout.pipelineLayout;
+    createInfo.renderPass = renderPass;
+    createInfo.subpass = 0;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateGraphicsPipelines(m_device->GetHandle(), m_device->GetPipelineCache(), 1, &createInfo, nullptr,
+                                  &pipeline) != VK_SUCCESS) {
+        return VK_NULL_HANDLE;
+    }
+    m_device->SetObjectName(VK_OBJECT_TYPE_PIPELINE, ToObjectHandle(pipeline),
+                            m_debugName.empty() ? nullptr : m_debugName.c_str());
+    return pipeline;
+}
+
+} // namespace VRHI
@@ -0,0 +1,112 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/VRHI.hpp>
+#include <VRHI/Pipeline.hpp>
+#include "VulkanDevice.hpp"
+#include "VulkanRenderPass.hpp"
+#include <expected>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace VRHI {
+
+/// A descriptor of set 0, which is all VRHI binds
+struct VulkanDescriptorBinding {
+    uint32_t binding;
+    VkDescriptorType type;
+};
+
+/// Dynamic state a pipeline sets when it is bound, like OpenGL pipelines
+/// set it through the state cache. States the pipeline lists as dynamic
+/// are left to the Set* commands.
+struct VulkanPipelineState {
+    bool lineWidth = false;
+    bool depthBias = false;
+    bool blendConstants = false;
+    bool stencil = false;
+    bool depthBounds = false;
+
+    float lineWidthValue = 1.0f;
+    float depthBiasValues[3] = {};  // Constant factor, clamp, slope factor
+    float blendConstantValues[4] = {};
+    uint32_t compareMask[2] = {};   // Front, back
+    uint32_t writeMask[2] = {};
+    uint32_t reference[2] = {};
+    float depthBoundsValues[2] = {0.0f, 1.0f};
+};
+
+/// Pipeline implementation
+///
+/// Descriptor bindings come from shader reflection. Uniform and storage
+/// buffers use dynamic descriptors so that rebinding another range of the
+/// same buffer only changes an offset. Graphics pipelines are created per
+/// render pass signature on first use (eagerly for the pass named in the
+/// desc), through the device's pipeline cache.
+class VulkanPipeline : public Pipeline {
+public:
+    ~VulkanPipeline() override;
+
+    static std::expected<std::unique_ptr<Pipeline>, Error>
+    Create(VulkanDevice& device, const PipelineDesc& desc);
+
+    PipelineType GetType() const noexcept override { return m_type; }
+
+    VkPipelineBindPoint GetBindPoint() const noexcept {
+        return m_type == PipelineType::Compute ? VK_PIPELINE_BIND_POINT_COMPUTE : VK_PIPELINE_BIND_POINT_GRAPHICS;
+    }
+
+    VkPipelineLayout GetLayout() const noexcept { return m_layout.pipelineLayout; }
+    VkDescriptorSetLayout GetSetLayout() const noexcept { return m_layout.setLayout; }
+
+    /// Descriptors of set 0, sorted by binding
+    const std::vector<VulkanDescriptorBinding>& GetBindings() const noexcept { return m_bindings; }
+
+    const VulkanPipelineState& GetState() const noexcept { return m_state; }
+
+    /// The compute pipeline, or the graphics pipeline for a render pass
+    /// with `signature`, created with `renderPass` if it does not exist yet
+    /// @return VK_NULL_HANDLE if creation failed
+    VkPipeline GetHandle(const VulkanPassSignature& signature, VkRenderPass renderPass);
+    VkPipeline GetHandle() const noexcept { return m_compute; }
+
+private:
+    explicit VulkanPipeline(VulkanDevice& device) : m_device(&device) {}
+
+    std::expected<void, Error> CreateLayout(std::span<Shader* const> shaders);
+    VkPipeline CreateGraphics(const VulkanPassSignature& signature, VkRenderPass renderPass) const;
+
+    /// Shader stage with a module made from the shader's SPIR-V
+    struct Stage {
+        VkShaderStageFlagBits stage;
+        VkShaderModule module;
+        std::string entryPoint;
+    };
+
+    VulkanDevice* m_device;
+    PipelineType m_type = PipelineType::Graphics;
+    std::vector<Stage> m_stages;
+    VulkanPipelineLayout m_layout;
+    std::vector<VulkanDescriptorBinding> m_bindings;
+    VulkanPipelineState m_state;
+    std::string m_debugName;
+
+    // Compute pipeline
+    VkPipeline m_compute = VK_NULL_HANDLE;
+
+    // Graphics pipeline: its state, with the arrays it points to copied,
+    // and the pipelines made from it
+    GraphicsPipelineDesc m_desc{};
+    std::vector<VertexAttribute> m_vertexAttributes;
+    std::vector<VertexBinding> m_vertexBindings;
+    std::vector<ColorBlendAttachment> m_blendAttachments;
+    std::vector<DynamicState> m_dynamicStates;
+    uint32_t m_sampleMask = ~0u;
+    std::map<VulkanPassSignature, VkPipeline> m_variants;
+};
+
+} // namespace VRHI
@@ -0,0 +1,180 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "VulkanRenderPass.hpp"
+#include "VulkanDevice.hpp"
+#include "VulkanFormatUtils.hpp"
+
+namespace VRHI {
+
+namespace {
+    /// Attachments whose ops fit in a 64-bit key
+    constexpr size_t MaxAttachments = 64 / 6;
+
+    VkAttachmentLoadOp GetLoadOp(AttachmentLoadOp op) {
+        switch (op) {
+            case AttachmentLoadOp::Load: return VK_ATTACHMENT_LOAD_OP_LOAD;
+            case AttachmentLoadOp::Clear: return VK_ATTACHMENT_LOAD_OP_CLEAR;
+            case AttachmentLoadOp::DontCare: return VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            default: return VK_ATTACHMENT_LOAD_OP_LOAD;
+        }
+    }
+
+    VkAttachmentStoreOp GetStoreOp(AttachmentStoreOp op) {
+        switch (op) {
+            case AttachmentStoreOp::Store: return VK_ATTACHMENT_STORE_OP_STORE;
+            case AttachmentStoreOp::DontCare: return VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            default: return VK_ATTACHMENT_STORE_OP_STORE;
+        }
+    }
+
+    bool IsDepthStencilFormat(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_D16_UNORM:
+            case VK_FORMAT_X8_D24_UNORM_PACK32:
+            case VK_FORMAT_D32_SFLOAT:
+            case VK_FORMAT_S8_UINT:
+            case VK_FORMAT_D16_UNORM_S8_UINT:
+            case VK_FORMAT_D24_UNORM_S8_UINT:
+            case VK_FORMAT_D32_SFLOAT_S8_UINT:
+                return true;
+            default:
+                return false;
+        }
+    }
+}
+
+VulkanRenderPass::~VulkanRenderPass() {
+    m_device->Retire(VK_OBJECT_TYPE_RENDER_PASS, ToObjectHandle(m_renderPass));
+}
+
+std::expected<std::unique_ptr<RenderPass>, Error>
+VulkanRenderPass::Create(VulkanDevice& device, const RenderPassDesc& desc) {
+    if (desc.attachments.size() > MaxAttachments) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Vulkan render passes support at most 10 attachments"
+        });
+    }
+
+    std::unique_ptr<VulkanRenderPass> renderPass(new VulkanRenderPass(device));
+    renderPass->m_attachments.assign(desc.attachments.begin(), desc.attachments.end());
+
+    std::vector<VkFormat> formats;
+    std::vector<VkSampleCountFlagBits> samples;
+    std::vector<VkImageLayout> layouts;
+    VulkanPassSignature& signature = renderPass->m_signature;
+    for (uint32_t i = 0; i < desc.attachments.size(); ++i) {
+        const AttachmentDesc& attachment = desc.attachments[i];
+        const VkFormat format = device.GetFormat(attachment.format);
+        if (format == VK_FORMAT_UNDEFINED) {
+            return std::unexpected(Error{
+                Error::Code::UnsupportedFeature,
+                "Render pass attachment format is not supported by the Vulkan device"
+            });
+        }
+
+        const bool isDepth = VulkanFormatUtils::IsDepthStencilFormat(attachment.format);
+        if (isDepth) {
+            signature.depthFormat = format;
+        } else {
+            signature.colorFormats.push_back(format);
+        }
+        signature.samples = VulkanFormatUtils::GetSampleCount(attachment.samples);
+        renderPass->m_opsKey |= PackOps(attachment, i);
+
+        formats.push_back(format);
+        samples.push_back(signature.samples);
+        layouts.push_back(isDepth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+                                  : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    }
+
+    renderPass->m_renderPass = CreateHandle(device.GetHandle(), formats, samples, layouts, renderPass->m_attachments);
+    if (renderPass->m_renderPass == VK_NULL_HANDLE) {
+        return std::unexpected(Error{
+            Error::Code::InitializationFailed,
+            "Failed to create Vulkan render pass"
+        });
+    }
+    device.SetObjectName(VK_OBJECT_TYPE_RENDER_PASS, ToObjectHandle(renderPass->m_renderPass), desc.debugName);
+
+    return std::unique_ptr<RenderPass>(std::move(renderPass));
+}
+
+uint64_t VulkanRenderPass::PackOps(const AttachmentDesc& attachment, uint32_t index) noexcept {
+    // Load and Store are 0, so attachments loaded and stored in full add nothing
+    const uint64_t ops = static_cast<uint64_t>(attachment.loadOp) |
+                         static_cast<uint64_t>(attachment.storeOp) << 2 |
+                         static_cast<uint64_t>(attachment.stencilLoadOp) << 3 |
+                         static_cast<uint64_t>(attachment.stencilStoreOp) << 5;
+    return index < MaxAttachments ? ops << (6 * index) : 0;
+}
+
+VkRenderPass VulkanRenderPass::CreateHandle(VkDevice device, const std::vector<VkFormat>& formats,
+                                            const std::vector<VkSampleCountFlagBits>& samples,
+                                            const std::vector<VkImageLayout>& layouts,
+                                            const std::vector<AttachmentDesc>& ops) {
+    std::vector<VkAttachmentDescription> attachments;
+    std::vector<VkAttachmentReference> colorReferences;
+    VkAttachmentReference depthReference{VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED};
+
+    for (uint32_t i = 0; i < formats.size(); ++i) {
+        const AttachmentDesc& op = i < ops.size() ? ops[i] : AttachmentDesc{};
+        const bool isDepth = IsDepthStencilFormat(formats[i]);
+
+        VkAttachmentDescription attachment{};
+        attachment.format = formats[i];
+        attachment.samples = samples[i];
+        attachment.loadOp = GetLoadOp(op.loadOp);
+        attachment.storeOp = GetStoreOp(op.storeOp);
+        attachment.stencilLoadOp = GetLoadOp(op.stencilLoadOp);
+        attachment.stencilStoreOp = GetStoreOp(op.stencilStoreOp);
+        const bool loads = op.loadOp == AttachmentLoadOp::Load ||
+                           (isDepth && op.stencilLoadOp == AttachmentLoadOp::Load);
+        attachment.initialLayout = loads ? layouts[i] : VK_IMAGE_LAYOUT_UNDEFINED;
+        attachment.finalLayout = layouts[i];
+        attachments.push_back(attachment);
+
+        if (isDepth) {
+            depthReference = {i, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+        } else {
+            colorReferences.push_back({i, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+        }
+    }
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = static_cast<uint32_t>(colorReferences.size());
+    subpass.pColorAttachments = colorReferences.data();
+    subpass.pDepthStencilAttachment = depthReference.attachment != VK_ATTACHMENT_UNUSED ? &depthReference : nullptr;
+
+    // Order the pass against everything around it, like OpenGL does
+    VkSubpassDependency dependencies[2]{};
+    dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[0].dstSubpass = 0;
+    dependencies[1].srcSubpass = 0;
+    dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+    for (VkSubpassDependency& dependency : dependencies) {
+        dependency.srcStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        dependency.dstStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        dependency.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+        dependency.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    }
+
+    VkRenderPassCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    createInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+    createInfo.pAttachments = attachments.data();
+    createInfo.subpassCount = 1;
+    createInfo.pSubpasses = &subpass;
+    createInfo.dependencyCount = 2;
+    createInfo.pDependencies = dependencies;
+
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    if (vkCreateRenderPass(device, &createInfo, nullptr, &renderPass) != VK_SUCCESS) {
+        return VK_NULL_HANDLE;
+    }
+    return renderPass;
+}
+
+} // namespace VRHI
@@ -0,0 +1,78 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <VRHI/VRHI.hpp>
+#include <expected>
+#include <memory>
+#include <vector>
+
+#include <VRHI/RenderPass.hpp>
+#include "VulkanLoader.hpp"
+
+namespace VRHI {
+
+class VulkanDevice;
+
+/// Formats and sample counts of a pass's attachments: what a pipeline must
+/// match to be used in it
+struct VulkanPassSignature {
+    std::vector<VkFormat> colorFormats;
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+
+    bool operator==(const VulkanPassSignature&) const = default;
+    auto operator<=>(const VulkanPassSignature&) const = default;
+};
+
+/// Render pass implementation
+///
+/// Like the OpenGL backends, a pass has a single subpass: color attachments
+/// in the order they appear, plus the depth attachment; subpass
+/// descriptions are ignored. The VkRenderPass made here only serves to
+/// create pipelines. Framebuffers make their own, compatible ones whose
+/// layouts match the images' resting layouts.
+class VulkanRenderPass : public RenderPass {
+public:
+    ~VulkanRenderPass() override;
+
+    static std::expected<std::unique_ptr<RenderPass>, Error>
+    Create(VulkanDevice& device, const RenderPassDesc& desc);
+
+    /// Attachments in RenderPassDesc order
+    const std::vector<AttachmentDesc>& GetAttachments() const noexcept { return m_attachments; }
+
+    /// Load and store ops of all attachments packed together, to look up
+    /// framebuffer render passes
+    uint64_t GetOpsKey() const noexcept { return m_opsKey; }
+
+    const VulkanPassSignature& GetSignature() const noexcept { return m_signature; }
+
+    VkRenderPass GetHandle() const noexcept { return m_renderPass; }
+
+    /// Load and store ops of attachments loaded and stored in full, as
+    /// BeginRenderPass without a render pass uses them
+    static uint64_t GetLoadStoreKey() noexcept { return 0; }
+
+    /// Pack the ops of one attachment into bits [6 * index, 6 * index + 6) of a key
+    static uint64_t PackOps(const AttachmentDesc& attachment, uint32_t index) noexcept;
+
+    /// A single-subpass VkRenderPass for attachments in their resting
+    /// `layouts`. Load ops of Load need the contents in the resting layout;
+    /// all others start from UNDEFINED.
+    static VkRenderPass CreateHandle(VkDevice device, const std::vector<VkFormat>& formats,
+                                     const std::vector<VkSampleCountFlagBits>& samples,
+                                     const std::vector<VkImageLayout>& layouts,
+                                     const std::vector<AttachmentDesc>& ops);
+
+private:
+    explicit VulkanRenderPass(VulkanDevice& device) : m_device(&device) {}
+
+    VulkanDevice* m_device;
+    std::vector<AttachmentDesc> m_attachments;
+    VulkanPassSignature m_signature;
+    uint64_t m_opsKey = 0;
+    VkRenderPass m_renderPass = VK_NULL_HANDLE;
+};
+
+} // namespace VRHI
@@ -0,0 +1,70 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "VulkanSampler.hpp"
+#include "VulkanDevice.hpp"
+#include "VulkanFormatUtils.hpp"
+#include <algorithm>
+
+namespace VRHI {
+
+namespace {
+    /// Vulkan only has predefined border colors; pick the nearest one
+    VkBorderColor GetBorderColor(const float color[4]) {
+        if (color[3] < 0.5f) {
+            return VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+        }
+        const float luminance = (color[0] + color[1] + color[2]) / 3.0f;
+        return luminance < 0.5f ? VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK : VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+    }
+}
+
+VulkanSampler::VulkanSampler(VulkanDevice& device, VkSampler sampler)
+    : m_device(&device)
+    , m_sampler(sampler)
+{
+}
+
+VulkanSampler::~VulkanSampler() {
+    m_device->Retire(VK_OBJECT_TYPE_SAMPLER, ToObjectHandle(m_sampler));
+}
+
+std::expected<std::unique_ptr<Sampler>, Error>
+VulkanSampler::Create(VulkanDevice& device, const SamplerDesc& desc) {
+    VkSamplerCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    createInfo.magFilter = VulkanFormatUtils::GetFilter(desc.magFilter);
+    createInfo.minFilter = VulkanFormatUtils::GetFilter(desc.minFilter);
+    createInfo.mipmapMode = VulkanFormatUtils::GetMipmapMode(desc.mipmapMode);
+    createInfo.addressModeU = VulkanFormatUtils::GetAddressMode(desc.addressModeU);
+    createInfo.addressModeV = VulkanFormatUtils::GetAddressMode(desc.addressModeV);
+    createInfo.addressModeW = VulkanFormatUtils::GetAddressMode(desc.addressModeW);
+    createInfo.mipLodBias = desc.mipLodBias;
+    createInfo.minLod = desc.minLod;
+    createInfo.maxLod = desc.maxLod;
+
+    // Like OpenGL without the extension, anisotropy is ignored when unsupported
+    if (desc.anisotropyEnable && device.GetEnabledFeatures().samplerAnisotropy) {
+        createInfo.anisotropyEnable = VK_TRUE;
+        createInfo.maxAnisotropy = std::clamp(desc.maxAnisotropy, 1.0f, device.GetLimits().maxSamplerAnisotropy);
+    }
+
+    if (desc.compareEnable) {
+        createInfo.compareEnable = VK_TRUE;
+        createInfo.compareOp = VulkanFormatUtils::GetCompareOp(desc.compareOp);
+    }
+    createInfo.borderColor = GetBorderColor(desc.borderColor);
+
+    VkSampler sampler = VK_NULL_HANDLE;
+    if (vkCreateSampler(device.GetHandle(), &createInfo, nullptr, &sampler) != VK_SUCCESS) {
+        return std::unexpected(Error{
+            Error::Code::InitializationFailed,
+            "Failed to create Vulkan sampler"
+        });
+    }
+    device.SetObjectName(VK_OBJECT_TYPE_SAMPLER, ToObjectHandle(sampler), desc.debugName);
+
+    return std::unique_ptr<Sampler>(new VulkanSampler(device, sampler));
+}
+
+} // namespace VRHI
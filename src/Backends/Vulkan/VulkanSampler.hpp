@@ -0,0 +1,32 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <expected>
+#include <memory>
+
+#include <VRHI/VRHI.hpp>
+#include <VRHI/Resources.hpp>
+#include "VulkanLoader.hpp"
+
+namespace VRHI {
+
+class VulkanDevice;
+
+class VulkanSampler : public Sampler {
+public:
+    ~VulkanSampler() override;
+
+    static std::expected<std::unique_ptr<Sampler>, Error>
+    Create(VulkanDevice& device, const SamplerDesc& desc);
+
+    VkSampler GetHandle() const noexcept { return m_sampler; }
+
+private:
+    VulkanSampler(VulkanDevice& device, VkSampler sampler);
+
+    VulkanDevice* m_device = nullptr;
+    VkSampler m_sampler = VK_NULL_HANDLE;
+};
+
+} // namespace VRHI
@@ -0,0 +1,54 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "VulkanShader.hpp"
+
+namespace VRHI {
+
+VulkanShader::VulkanShader(const ShaderDesc& desc, std::vector<uint32_t> spirv,
+                           ShaderCompilationResult::ReflectionData reflection)
+    : m_spirv(std::move(spirv))
+    , m_stage(desc.stage)
+    , m_language(desc.language)
+    , m_entryPoint(desc.entryPoint ? desc.entryPoint : "main")
+    , m_reflection(std::move(reflection))
+{
+}
+
+std::expected<std::unique_ptr<Shader>, Error>
+VulkanShader::Create(const ShaderDesc& desc) {
+    if (desc.code == nullptr || desc.codeSize == 0) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Shader code is required"
+        });
+    }
+
+    std::vector<uint32_t> spirv;
+    if (desc.language == ShaderLanguage::SPIRV) {
+        const auto* words = static_cast<const uint32_t*>(desc.code);
+        spirv.assign(words, words + desc.codeSize / sizeof(uint32_t));
+    } else if (desc.language == ShaderLanguage::GLSL) {
+        std::string source(static_cast<const char*>(desc.code), desc.codeSize);
+        auto compiled = ShaderCompiler::CompileGLSLToSPIRV(source, desc.stage, desc.entryPoint);
+        if (!compiled) {
+            return std::unexpected(compiled.error());
+        }
+        spirv = std::move(*compiled);
+    } else {
+        return std::unexpected(Error{
+            Error::Code::UnsupportedFeature,
+            "Vulkan shaders must be GLSL or SPIR-V"
+        });
+    }
+
+    // Also rejects malformed SPIR-V before a pipeline is made from it
+    auto reflection = ShaderCompiler::ReflectSPIRV(spirv);
+    if (!reflection) {
+        return std::unexpected(reflection.error());
+    }
+
+    return std::unique_ptr<Shader>(new VulkanShader(desc, std::move(spirv), std::move(*reflection)));
+}
+
+} // namespace VRHI
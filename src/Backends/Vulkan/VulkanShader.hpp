@@ -0,0 +1,47 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <expected>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <VRHI/VRHI.hpp>
+#include <VRHI/Shader.hpp>
+#include <VRHI/ShaderCompiler.hpp>
+
+namespace VRHI {
+
+/// Vulkan shader
+///
+/// SPIR-V is kept as is; GLSL is compiled to SPIR-V first. Pipelines make
+/// their own shader modules from it, since graphics pipelines are created
+/// on first use in a render pass, possibly after the shader is destroyed.
+/// The reflection gives pipelines their descriptor bindings.
+class VulkanShader : public Shader {
+public:
+    ~VulkanShader() override = default;
+
+    static std::expected<std::unique_ptr<Shader>, Error>
+    Create(const ShaderDesc& desc);
+
+    ShaderStage GetStage() const noexcept override { return m_stage; }
+    ShaderLanguage GetLanguage() const noexcept override { return m_language; }
+    std::string_view GetEntryPoint() const noexcept override { return m_entryPoint; }
+
+    const std::vector<uint32_t>& GetSPIRV() const noexcept { return m_spirv; }
+    const ShaderCompilationResult::ReflectionData& GetReflection() const noexcept { return m_reflection; }
+
+private:
+    VulkanShader(const ShaderDesc& desc, std::vector<uint32_t> spirv,
+                 ShaderCompilationResult::ReflectionData reflection);
+
+    std::vector<uint32_t> m_spirv;
+    ShaderStage m_stage;
+    ShaderLanguage m_language;
+    std::string m_entryPoint;
+    ShaderCompilationResult::ReflectionData m_reflection;
+};
+
+} // namespace VRHI
@@ -0,0 +1,44 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "VulkanSync.hpp"
+#include "VulkanDevice.hpp"
+
+namespace VRHI {
+
+VulkanFence::VulkanFence(VulkanDevice& device, bool signaled)
+    : m_device(&device)
+    , m_value(signaled ? 0 : NotSubmitted)
+{
+}
+
+bool VulkanFence::Wait(uint64_t timeout) {
+    if (m_value == NotSubmitted) {
+        return false;  // Nothing would ever signal it
+    }
+    return m_device->WaitForValue(m_value, timeout);
+}
+
+void VulkanFence::Reset() {
+    m_value = NotSubmitted;
+}
+
+bool VulkanFence::IsSignaled() const noexcept {
+    return m_value != NotSubmitted && m_device->GetCompletedValue() >= m_value;
+}
+
+VulkanSemaphore::VulkanSemaphore(VulkanDevice& device)
+    : m_device(&device)
+{
+    VkSemaphoreCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    vkCreateSemaphore(device.GetHandle(), &createInfo, nullptr, &m_semaphore);
+}
+
+VulkanSemaphore::~VulkanSemaphore() {
+    if (m_semaphore != VK_NULL_HANDLE) {
+        m_device->Retire(VK_OBJECT_TYPE_SEMAPHORE, ToObjectHandle(m_semaphore));
+    }
+}
+
+} // namespace VRHI
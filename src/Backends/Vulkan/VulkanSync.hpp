@@ -0,0 +1,44 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/Sync.hpp>
+#include "VulkanLoader.hpp"
+
+namespace VRHI {
+
+class VulkanDevice;
+
+/// Fence backed by the device's timeline semaphore: it is signaled once the
+/// timeline reaches the value of the submission it was passed to
+class VulkanFence : public Fence {
+public:
+    VulkanFence(VulkanDevice& device, bool signaled);
+    ~VulkanFence() override = default;
+
+    bool Wait(uint64_t timeout = UINT64_MAX) override;
+    void Reset() override;
+    bool IsSignaled() const noexcept override;
+
+    // Called by the device with the timeline value of the submission
+    void SetValue(uint64_t value) noexcept { m_value = value; }
+
+private:
+    static constexpr uint64_t NotSubmitted = UINT64_MAX;
+
+    VulkanDevice* m_device;
+    uint64_t m_value;
+};
+
+class VulkanSemaphore : public Semaphore {
+public:
+    explicit VulkanSemaphore(VulkanDevice& device);
+    ~VulkanSemaphore() override;
+
+private:
+    VulkanDevice* m_device;
+    VkSemaphore m_semaphore = VK_NULL_HANDLE;
+};
+
+} // namespace VRHI
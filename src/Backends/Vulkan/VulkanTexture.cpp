@@ -0,0 +1,417 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "VulkanTexture.hpp"
+#include "VulkanDevice.hpp"
+#include "VulkanFormatUtils.hpp"
+#include <VRHI/Logging.hpp>
+#include <algorithm>
+#include <cstring>
+
+namespace VRHI {
+
+namespace {
+    bool HasUsage(TextureUsage usage, TextureUsage flag) {
+        return static_cast<uint32_t>(usage & flag) != 0;
+    }
+
+    VkImageType GetImageType(TextureType type) {
+        switch (type) {
+            case TextureType::Texture1D:
+            case TextureType::Texture1DArray:
+                return VK_IMAGE_TYPE_1D;
+            case TextureType::Texture3D:
+                return VK_IMAGE_TYPE_3D;
+            default:
+                return VK_IMAGE_TYPE_2D;
+        }
+    }
+
+    VkImageViewType GetViewType(TextureType type) {
+        switch (type) {
+            case TextureType::Texture1D: return VK_IMAGE_VIEW_TYPE_1D;
+            case TextureType::Texture2D: return VK_IMAGE_VIEW_TYPE_2D;
+            case TextureType::Texture3D: return VK_IMAGE_VIEW_TYPE_3D;
+            case TextureType::TextureCube: return VK_IMAGE_VIEW_TYPE_CUBE;
+            case TextureType::Texture1DArray: return VK_IMAGE_VIEW_TYPE_1D_ARRAY;
+            case TextureType::Texture2DArray: return VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+            case TextureType::TextureCubeArray: return VK_IMAGE_VIEW_TYPE_CUBE_ARRAY;
+            default: return VK_IMAGE_VIEW_TYPE_2D;
+        }
+    }
+
+    uint32_t CountLayers(const TextureDesc& desc) {
+        const uint32_t layers = std::max(desc.arrayLayers, 1u);
+        switch (desc.type) {
+            case TextureType::Texture1D:
+            case TextureType::Texture2D:
+            case TextureType::Texture3D:
+                return 1;
+            case TextureType::TextureCube:
+                return 6;
+            case TextureType::TextureCubeArray:
+                return 6 * layers;
+            default:
+                return layers;
+        }
+    }
+
+    /// The usage with RenderTarget and DepthStencil matched to the format:
+    /// OpenGL attaches any renderable texture, whichever of the two it names
+    TextureUsage GetAttachmentUsage(const TextureDesc& desc) {
+        constexpr TextureUsage Attachment = TextureUsage::RenderTarget | TextureUsage::DepthStencil;
+        if (!HasUsage(desc.usage, Attachment)) {
+            return desc.usage;
+        }
+        const TextureUsage other = static_cast<TextureUsage>(
+            static_cast<uint32_t>(desc.usage) & ~static_cast<uint32_t>(Attachment));
+        return other | (VulkanFormatUtils::IsDepthStencilFormat(desc.format) ? TextureUsage::DepthStencil
+                                                                           : TextureUsage::RenderTarget);
+    }
+
+    /// The one layout an image with this usage rests in between commands
+    VkImageLayout GetRestingLayout(TextureUsage usage) {
+        if (HasUsage(usage, TextureUsage::Storage)) {
+            return VK_IMAGE_LAYOUT_GENERAL;
+        }
+        if (HasUsage(usage, TextureUsage::DepthStencil)) {
+            return HasUsage(usage, TextureUsage::Sampled) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+                                                          : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        }
+        if (HasUsage(usage, TextureUsage::Sampled)) {
+            return VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        }
+        if (HasUsage(usage, TextureUsage::RenderTarget)) {
+            return VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        }
+        return VK_IMAGE_LAYOUT_GENERAL;
+    }
+
+    /// Format features the usage needs
+    VkFormatFeatureFlags GetRequiredFeatures(TextureUsage usage) {
+        VkFormatFeatureFlags features = 0;
+        if (HasUsage(usage, TextureUsage::Sampled)) features |= VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+        if (HasUsage(usage, TextureUsage::Storage)) features |= VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT;
+        if (HasUsage(usage, TextureUsage::RenderTarget)) features |= VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT;
+        if (HasUsage(usage, TextureUsage::DepthStencil)) features |= VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        return features;
+    }
+
+    VkImageUsageFlags GetImageUsage(TextureUsage usage) {
+        // Transfers are always allowed: updates, reads and mip generation are copies
+        VkImageUsageFlags flags = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        if (HasUsage(usage, TextureUsage::Sampled)) flags |= VK_IMAGE_USAGE_SAMPLED_BIT;
+        if (HasUsage(usage, TextureUsage::Storage)) flags |= VK_IMAGE_USAGE_STORAGE_BIT;
+        if (HasUsage(usage, TextureUsage::RenderTarget)) flags |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        if (HasUsage(usage, TextureUsage::DepthStencil)) flags |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        return flags;
+    }
+}
+
+VulkanTexture::VulkanTexture(VulkanDevice& device, const TextureDesc& desc)
+    : m_device(&device)
+    , m_desc(desc)
+{
+    m_desc.initialData = nullptr;
+}
+
+VulkanTexture::~VulkanTexture() {
+    if (m_storageView != m_view) {
+        m_device->Retire(VK_OBJECT_TYPE_IMAGE_VIEW, ToObjectHandle(m_storageView));
+    }
+    m_device->Retire(VK_OBJECT_TYPE_IMAGE_VIEW, ToObjectHandle(m_view));
+    m_device->Retire(VK_OBJECT_TYPE_IMAGE, ToObjectHandle(m_image), m_memory);
+}
+
+std::expected<std::unique_ptr<Texture>, Error>
+VulkanTexture::Create(VulkanDevice& device, const TextureDesc& desc) {
+    if (desc.width == 0 || desc.height == 0 || desc.depth == 0 || desc.mipLevels == 0) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Texture dimensions and mip level count must be greater than 0"
+        });
+    }
+
+    auto texture = std::unique_ptr<VulkanTexture>(new VulkanTexture(device, desc));
+    texture->m_format = device.GetFormat(desc.format);
+    texture->m_aspect = VulkanFormatUtils::GetAspectMask(desc.format);
+    const TextureUsage usage = GetAttachmentUsage(desc);
+    texture->m_layout = GetRestingLayout(usage);
+    texture->m_samples = VulkanFormatUtils::GetSampleCount(desc.sampleCount);
+    texture->m_layerCount = CountLayers(desc);
+
+    const VkFormatFeatureFlags required = GetRequiredFeatures(usage);
+    if (texture->m_format == VK_FORMAT_UNDEFINED ||
+        (device.GetFormatFeatures(texture->m_format) & required) != required) {
+        return std::unexpected(Error{
+            Error::Code::UnsupportedFeature,
+            "Texture format is not supported for this usage by the Vulkan device"
+        });
+    }
+
+    const bool isCube = desc.type == TextureType::TextureCube || desc.type == TextureType::TextureCubeArray;
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.flags = isCube ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0;
+    imageInfo.imageType = GetImageType(desc.type);
+    imageInfo.format = texture->m_format;
+    imageInfo.extent = {desc.width, imageInfo.imageType == VK_IMAGE_TYPE_1D ? 1 : desc.height,
+                        imageInfo.imageType == VK_IMAGE_TYPE_3D ? desc.depth : 1};
+    imageInfo.mipLevels = desc.mipLevels;
+    imageInfo.arrayLayers = texture->m_layerCount;
+    imageInfo.samples = texture->m_samples;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = GetImageUsage(usage);
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VkDevice handle = device.GetHandle();
+    if (vkCreateImage(handle, &imageInfo, nullptr, &texture->m_image) != VK_SUCCESS) {
+        return std::unexpected(Error{
+            Error::Code::InitializationFailed,
+            "Failed to create Vulkan image"
+        });
+    }
+
+    VkMemoryRequirements requirements{};
+    vkGetImageMemoryRequirements(handle, texture->m_image, &requirements);
+    VkMemoryPropertyFlags properties = 0;
+    auto memory = device.AllocateMemory(requirements, 0, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, properties);
+    if (!memory) {
+        return std::unexpected(memory.error());
+    }
+    texture->m_memory = *memory;
+    vkBindImageMemory(handle, texture->m_image, texture->m_memory, 0);
+
+    // Sampling reads depth only; views may not mix aspects
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = texture->m_image;
+    viewInfo.viewType = GetViewType(desc.type);
+    viewInfo.format = texture->m_format;
+    viewInfo.subresourceRange = {texture->m_aspect & ~VkImageAspectFlags(VK_IMAGE_ASPECT_STENCIL_BIT),
+                                 0, desc.mipLevels, 0, texture->m_layerCount};
+    if (vkCreateImageView(handle, &viewInfo, nullptr, &texture->m_view) != VK_SUCCESS) {
+        return std::unexpected(Error{
+            Error::Code::InitializationFailed,
+            "Failed to create Vulkan image view"
+        });
+    }
+
+    // Storage descriptors address a single mip level
+    texture->m_storageView = texture->m_view;
+    if (HasUsage(desc.usage, TextureUsage::Storage) && desc.mipLevels > 1) {
+        viewInfo.subresourceRange.levelCount = 1;
+        if (vkCreateImageView(handle, &viewInfo, nullptr, &texture->m_storageView) != VK_SUCCESS) {
+            texture->m_storageView = texture->m_view;
+            return std::unexpected(Error{
+                Error::Code::InitializationFailed,
+                "Failed to create Vulkan storage image view"
+            });
+        }
+    }
+    device.SetObjectName(VK_OBJECT_TYPE_IMAGE, ToObjectHandle(texture->m_image), desc.debugName);
+
+    // Move the image into its resting layout; initial data fills mip 0 of every layer
+    VkCommandBuffer commands = device.GetUploadCommands();
+    texture->RecordTransition(commands, VK_IMAGE_LAYOUT_UNDEFINED, texture->m_layout,
+                              0, desc.mipLevels, 0, texture->m_layerCount);
+    if (desc.initialData) {
+        const auto* data = static_cast<const std::byte*>(desc.initialData);
+        const VkDeviceSize layerSize = texture->GetLayerSize(0);
+        for (uint32_t layer = 0; layer < texture->m_layerCount; ++layer) {
+            texture->Upload(data + layer * layerSize, layerSize, texture->GetCopyRegion(0, layer));
+        }
+    }
+
+    return texture;
+}
+
+TextureType VulkanTexture::GetType() const noexcept {
+    return m_desc.type;
+}
+
+TextureFormat VulkanTexture::GetFormat() const noexcept {
+    return m_desc.format;
+}
+
+uint32_t VulkanTexture::GetWidth() const noexcept {
+    return m_desc.width;
+}
+
+uint32_t VulkanTexture::GetHeight() const noexcept {
+    return m_desc.height;
+}
+
+uint32_t VulkanTexture::GetDepth() const noexcept {
+    return m_desc.depth;
+}
+
+uint32_t VulkanTexture::GetMipLevels() const noexcept {
+    return m_desc.mipLevels;
+}
+
+uint32_t VulkanTexture::GetArrayLayers() const noexcept {
+    return m_desc.arrayLayers;
+}
+
+VkExtent3D VulkanTexture::GetMipExtent(uint32_t mipLevel) const noexcept {
+    const VkImageType type = GetImageType(m_desc.type);
+    return VkExtent3D{
+        std::max(m_desc.width >> mipLevel, 1u),
+        type == VK_IMAGE_TYPE_1D ? 1 : std::max(m_desc.height >> mipLevel, 1u),
+        type == VK_IMAGE_TYPE_3D ? std::max(m_desc.depth >> mipLevel, 1u) : 1,
+    };
+}
+
+VkDeviceSize VulkanTexture::GetLayerSize(uint32_t mipLevel) const noexcept {
+    const VkExtent3D extent = GetMipExtent(mipLevel);
+    const uint32_t block = VulkanFormatUtils::GetBlockExtent(m_desc.format);
+    const VkDeviceSize blocksX = (extent.width + block - 1) / block;
+    const VkDeviceSize blocksY = (extent.height + block - 1) / block;
+    return blocksX * blocksY * extent.depth * VulkanFormatUtils::GetBlockSize(m_desc.format);
+}
+
+VkBufferImageCopy VulkanTexture::GetCopyRegion(uint32_t mipLevel, uint32_t arrayLayer) const noexcept {
+    VkBufferImageCopy region{};
+    const bool isDepth = (m_aspect & VK_IMAGE_ASPECT_DEPTH_BIT) != 0;
+    region.imageSubresource = {isDepth ? VkImageAspectFlags(VK_IMAGE_ASPECT_DEPTH_BIT) : m_aspect,
+                               mipLevel, arrayLayer, 1};
+    region.imageExtent = GetMipExtent(mipLevel);
+    return region;
+}
+
+void VulkanTexture::RecordTransition(VkCommandBuffer commands, VkImageLayout oldLayout, VkImageLayout newLayout,
+                                     uint32_t baseMip, uint32_t mipCount, uint32_t baseLayer, uint32_t layerCount) const {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = m_image;
+    barrier.subresourceRange = {m_aspect, baseMip, mipCount, baseLayer, layerCount};
+    vkCmdPipelineBarrier(commands, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void VulkanTexture::Upload(const void* data, VkDeviceSize size, const VkBufferImageCopy& region) {
+    auto staging = m_device->CreateStagingBuffer(size, false);
+    if (!staging) {
+        LogError("Texture update failed: %s", staging.error().message.c_str());
+        return;
+    }
+    std::memcpy(staging->data, data, size);
+
+    const uint32_t mip = region.imageSubresource.mipLevel;
+    const uint32_t layer = region.imageSubresource.baseArrayLayer;
+    VkCommandBuffer commands = m_device->GetUploadCommands();
+    RecordTransition(commands, m_layout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mip, 1, layer, 1);
+    vkCmdCopyBufferToImage(commands, staging->buffer, m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    RecordTransition(commands, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_layout, mip, 1, layer, 1);
+    m_device->RetireStagingBuffer(*staging);
+}
+
+void VulkanTexture::Update(const void* data, size_t size, uint32_t mipLevel, uint32_t arrayLayer) {
+    if (mipLevel >= m_desc.mipLevels || arrayLayer >= m_layerCount) {
+        LogError("Texture update out of bounds");
+        return;
+    }
+    const VkDeviceSize layerSize = GetLayerSize(mipLevel);
+    if (size < layerSize) {
+        LogError("Texture update needs %llu bytes, got %zu", static_cast<unsigned long long>(layerSize), size);
+        return;
+    }
+    Upload(data, layerSize, GetCopyRegion(mipLevel, arrayLayer));
+}
+
+void VulkanTexture::UpdateRegion(const void* data, uint32_t x, uint32_t y, uint32_t z,
+                                 uint32_t width, uint32_t height, uint32_t depth,
+                                 uint32_t mipLevel, uint32_t arrayLayer) {
+    const VkExtent3D extent = GetMipExtent(mipLevel);
+    if (mipLevel >= m_desc.mipLevels || arrayLayer >= m_layerCount ||
+        x + width > extent.width || y + height > extent.height || z + depth > extent.depth) {
+        LogError("Texture update out of bounds");
+        return;
+    }
+
+    const uint32_t block = VulkanFormatUtils::GetBlockExtent(m_desc.format);
+    const VkDeviceSize size = VkDeviceSize((width + block - 1) / block) * ((height + block - 1) / block) *
+                              depth * VulkanFormatUtils::GetBlockSize(m_desc.format);
+    VkBufferImageCopy region = GetCopyRegion(mipLevel, arrayLayer);
+    region.imageOffset = {static_cast<int32_t>(x), static_cast<int32_t>(y), static_cast<int32_t>(z)};
+    region.imageExtent = {width, height, depth};
+    Upload(data, size, region);
+}
+
+void VulkanTexture::GenerateMipmaps(CommandBuffer* cmd) {
+    // Like OpenGL, mips are generated in submission order rather than in `cmd`
+    (void)cmd;
+    if (m_desc.mipLevels < 2) {
+        return;
+    }
+
+    const VkFormatFeatureFlags features = m_device->GetFormatFeatures(m_format);
+    constexpr VkFormatFeatureFlags Blit = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+    if ((features & Blit) != Blit) {
+        LogWarning("Cannot generate mipmaps: the texture format does not support blits");
+        return;
+    }
+    const VkFilter filter = (features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) ? VK_FILTER_LINEAR
+                                                                                            : VK_FILTER_NEAREST;
+
+    // Each level is blitted from the one above it, which is then done
+    VkCommandBuffer commands = m_device->GetUploadCommands();
+    const uint32_t levels = m_desc.mipLevels;
+    RecordTransition(commands, m_layout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, levels, 0, m_layerCount);
+    for (uint32_t level = 1; level < levels; ++level) {
+        RecordTransition(commands, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                         level - 1, 1, 0, m_layerCount);
+
+        const VkExtent3D src = GetMipExtent(level - 1);
+        const VkExtent3D dst = GetMipExtent(level);
+        VkImageBlit blit{};
+        blit.srcSubresource = {m_aspect, level - 1, 0, m_layerCount};
+        blit.srcOffsets[1] = {static_cast<int32_t>(src.width), static_cast<int32_t>(src.height),
+                              static_cast<int32_t>(src.depth)};
+        blit.dstSubresource = {m_aspect, level, 0, m_layerCount};
+        blit.dstOffsets[1] = {static_cast<int32_t>(dst.width), static_cast<int32_t>(dst.height),
+                              static_cast<int32_t>(dst.depth)};
+        vkCmdBlitImage(commands, m_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, filter);
+    }
+    RecordTransition(commands, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_layout, 0, levels - 1, 0, m_layerCount);
+    RecordTransition(commands, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_layout, levels - 1, 1, 0, m_layerCount);
+}
+
+void VulkanTexture::Read(void* data, size_t size, uint32_t mipLevel, uint32_t arrayLayer) {
+    if (mipLevel >= m_desc.mipLevels || arrayLayer >= m_layerCount) {
+        LogError("Texture read out of bounds");
+        return;
+    }
+    if (m_samples != VK_SAMPLE_COUNT_1_BIT) {
+        LogError("Multisampled textures cannot be read back");
+        return;
+    }
+
+    const VkDeviceSize layerSize = GetLayerSize(mipLevel);
+    auto staging = m_device->CreateStagingBuffer(layerSize, true);
+    if (!staging) {
+        LogError("Texture read failed: %s", staging.error().message.c_str());
+        return;
+    }
+
+    const VkBufferImageCopy region = GetCopyRegion(mipLevel, arrayLayer);
+    VkCommandBuffer commands = m_device->GetUploadCommands();
+    RecordTransition(commands, m_layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, mipLevel, 1, arrayLayer, 1);
+    vkCmdCopyImageToBuffer(commands, m_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, staging->buffer, 1, &region);
+    RecordTransition(commands, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_layout, mipLevel, 1, arrayLayer, 1);
+    m_device->WaitForSubmitted();
+
+    std::memcpy(data, staging->data, std::min<VkDeviceSize>(size, layerSize));
+    m_device->RetireStagingBuffer(*staging);
+}
+
+} // namespace VRHI
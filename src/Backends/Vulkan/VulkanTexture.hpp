@@ -0,0 +1,102 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/VRHI.hpp>
+#include <VRHI/Resources.hpp>
+#include "VulkanLoader.hpp"
+#include <expected>
+#include <memory>
+
+namespace VRHI {
+
+class VulkanDevice;
+
+/// Vulkan texture implementation
+///
+/// Between commands an image always rests in one layout chosen from its
+/// usage (GENERAL for storage images, shader-read for sampled ones, the
+/// attachment layout for render targets). Render passes start and end in
+/// it and copies transition to a transfer layout and back, so no command
+/// has to track layouts across command buffers. Cube maps have six array
+/// layers per cube, addressed as faces by Update() and friends.
+class VulkanTexture : public Texture {
+public:
+    ~VulkanTexture() override;
+
+    static std::expected<std::unique_ptr<Texture>, Error>
+    Create(VulkanDevice& device, const TextureDesc& desc);
+
+    // Texture interface
+    TextureType GetType() const noexcept override;
+    TextureFormat GetFormat() const noexcept override;
+    uint32_t GetWidth() const noexcept override;
+    uint32_t GetHeight() const noexcept override;
+    uint32_t GetDepth() const noexcept override;
+    uint32_t GetMipLevels() const noexcept override;
+    uint32_t GetArrayLayers() const noexcept override;
+
+    /// Uploads are recorded into the device's upload commands
+    void Update(const void* data, size_t size,
+                uint32_t mipLevel = 0, uint32_t arrayLayer = 0) override;
+    void UpdateRegion(const void* data,
+                      uint32_t x, uint32_t y, uint32_t z,
+                      uint32_t width, uint32_t height, uint32_t depth,
+                      uint32_t mipLevel = 0, uint32_t arrayLayer = 0) override;
+    void GenerateMipmaps(CommandBuffer* cmd) override;
+
+    /// Waits for all submitted work
+    void Read(void* data, size_t size,
+              uint32_t mipLevel = 0, uint32_t arrayLayer = 0) override;
+
+    // Vulkan-specific
+    VkImage GetHandle() const noexcept { return m_image; }
+    VkFormat GetVkFormat() const noexcept { return m_format; }
+    VkSampleCountFlagBits GetSamples() const noexcept { return m_samples; }
+
+    /// Layout the image is in between commands
+    VkImageLayout GetLayout() const noexcept { return m_layout; }
+
+    /// View of all mip levels and layers, for sampling
+    VkImageView GetView() const noexcept { return m_view; }
+
+    /// View of mip level 0, for storage image access
+    VkImageView GetStorageView() const noexcept { return m_storageView; }
+
+    /// Vulkan array layers (six per cube)
+    uint32_t GetLayerCount() const noexcept { return m_layerCount; }
+
+    VkExtent3D GetMipExtent(uint32_t mipLevel) const noexcept;
+
+    /// Bytes of one layer of a mip level, tightly packed
+    VkDeviceSize GetLayerSize(uint32_t mipLevel) const noexcept;
+
+    /// Copy region of one layer of a mip level; the aspect is depth for
+    /// depth/stencil formats, whose stencil is not transferred
+    VkBufferImageCopy GetCopyRegion(uint32_t mipLevel, uint32_t arrayLayer) const noexcept;
+
+    /// Barrier moving mip levels and layers between two layouts
+    void RecordTransition(VkCommandBuffer commands, VkImageLayout oldLayout, VkImageLayout newLayout,
+                          uint32_t baseMip, uint32_t mipCount, uint32_t baseLayer, uint32_t layerCount) const;
+
+private:
+    VulkanTexture(VulkanDevice& device, const TextureDesc& desc);
+
+    /// Copy `region` from a staging copy of `data` into the image
+    void Upload(const void* data, VkDeviceSize size, const VkBufferImageCopy& region);
+
+    VulkanDevice* m_device;
+    TextureDesc m_desc;
+    VkImage m_image = VK_NULL_HANDLE;
+    VkDeviceMemory m_memory = VK_NULL_HANDLE;
+    VkImageView m_view = VK_NULL_HANDLE;
+    VkImageView m_storageView = VK_NULL_HANDLE;
+    VkFormat m_format = VK_FORMAT_UNDEFINED;
+    VkImageAspectFlags m_aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+    VkImageLayout m_layout = VK_IMAGE_LAYOUT_GENERAL;
+    VkSampleCountFlagBits m_samples = VK_SAMPLE_COUNT_1_BIT;
+    uint32_t m_layerCount = 1;
+};
+
+} // namespace VRHI
@@ -0,0 +1,27 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "VulkanTransientAllocator.hpp"
+#include "VulkanDevice.hpp"
+
+namespace VRHI {
+
+VulkanTransientAllocator::VulkanTransientAllocator(VulkanDevice& device, uint64_t alignment)
+    : TransientRingAllocator(device, alignment)
+    , m_device(&device)
+{
+}
+
+VulkanTransientAllocator::~VulkanTransientAllocator() {
+    Release();
+}
+
+void* VulkanTransientAllocator::InsertFence() {
+    return reinterpret_cast<void*>(static_cast<uintptr_t>(m_device->GetSubmittedValue()));
+}
+
+bool VulkanTransientAllocator::IsFenceSignaled(void* fence) {
+    return m_device->GetCompletedValue() >= static_cast<uint64_t>(reinterpret_cast<uintptr_t>(fence));
+}
+
+} // namespace VRHI
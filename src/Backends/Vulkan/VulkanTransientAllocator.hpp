@@ -0,0 +1,30 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "Core/TransientRingAllocator.hpp"
+
+namespace VRHI {
+
+class VulkanDevice;
+
+/// Transient allocator whose frames are fenced with timeline values.
+///
+/// The ring lives in persistently mapped, host-coherent memory, so the
+/// default mapping hooks (Buffer::Map) apply and nothing needs flushing. A
+/// frame's fence is the last timeline value submitted before it closed.
+class VulkanTransientAllocator final : public TransientRingAllocator {
+public:
+    VulkanTransientAllocator(VulkanDevice& device, uint64_t alignment);
+    ~VulkanTransientAllocator() override;
+
+protected:
+    void* InsertFence() override;
+    bool IsFenceSignaled(void* fence) override;
+
+private:
+    VulkanDevice* m_device;
+};
+
+} // namespace VRHI
@@ -6,9 +6,22 @@
 namespace VRHI {
 
 // Forward declare backend registration functions
+#ifdef VRHI_BACKEND_VULKAN
+namespace detail {
+    extern void RegisterVulkanBackend();
+}
+#endif
+
 #ifdef VRHI_BACKEND_OPENGL
 namespace detail {
     extern void RegisterOpenGL33Backend();
+    extern void RegisterOpenGL46Backend();
+}
+#endif
+
+#ifdef VRHI_BACKEND_SOFTWARE
+namespace detail {
+    extern void RegisterSoftwareBackend();
 }
 #endif
 
@@ -16,8 +29,17 @@ void InitializeBackends() {
     // Call backend registration functions
     // This ensures the backend objects are linked and their static initializers run
     
+#ifdef VRHI_BACKEND_VULKAN
+    detail::RegisterVulkanBackend();
+#endif
+
 #ifdef VRHI_BACKEND_OPENGL
     detail::RegisterOpenGL33Backend();
+    detail::RegisterOpenGL46Backend();
+#endif
+
+#ifdef VRHI_BACKEND_SOFTWARE
+    detail::RegisterSoftwareBackend();
 #endif
 }
 
@@ -0,0 +1,178 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include <VRHI/BufferAllocator.hpp>
+#include <VRHI/Logging.hpp>
+#include "TlsfAllocator.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace VRHI {
+
+namespace {
+
+/// Granularity of every block; enough for any vertex attribute or index type
+constexpr uint64_t MinAlignment = 16;
+
+} // anonymous namespace
+
+/// A buffer owned by the allocator. Shared blocks track their free ranges;
+/// dedicated ones hold a single allocation and have no range allocator.
+struct BufferAllocator::Block {
+    std::unique_ptr<Buffer> buffer;
+    BufferUsage usage;
+    MemoryAccess memoryAccess;
+    std::unique_ptr<TlsfAllocator> ranges;
+
+    bool IsShared(BufferUsage classUsage, MemoryAccess classAccess) const noexcept {
+        return ranges && usage == classUsage && memoryAccess == classAccess;
+    }
+};
+
+BufferAllocator::BufferAllocator(Device& device, uint64_t blockSize)
+    : m_device(&device)
+    , m_blockSize(std::max(blockSize, MinAlignment))
+{
+}
+
+BufferAllocator::~BufferAllocator() {
+    if (m_allocatedBytes > 0) {
+        LogWarning("BufferAllocator destroyed with %llu bytes still allocated",
+                   static_cast<unsigned long long>(m_allocatedBytes));
+    }
+}
+
+std::expected<BufferView, Error> BufferAllocator::Allocate(const BufferDesc& desc, uint64_t alignment) {
+    if (desc.size == 0) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Buffer size must be greater than 0"
+        });
+    }
+    if (alignment != 0 && !std::has_single_bit(alignment)) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Buffer alignment must be a power of two"
+        });
+    }
+    alignment = std::max(alignment, GetAlignment(desc.usage));
+
+    // Large ranges would waste most of a block; give them their own buffer
+    if (desc.size + alignment > m_blockSize / 2) {
+        auto block = CreateBlock(desc, desc.size, true);
+        if (!block) {
+            return std::unexpected(block.error());
+        }
+        m_allocatedBytes += desc.size;
+        return BufferView{(*block)->buffer.get(), 0, desc.size};
+    }
+
+    Block* target = nullptr;
+    uint64_t offset = TlsfAllocator::InvalidOffset;
+    for (const auto& block : m_blocks) {
+        if (block->IsShared(desc.usage, desc.memoryAccess)) {
+            offset = block->ranges->Allocate(desc.size, alignment);
+            if (offset != TlsfAllocator::InvalidOffset) {
+                target = block.get();
+                break;
+            }
+        }
+    }
+    if (!target) {
+        auto block = CreateBlock(desc, m_blockSize, false);
+        if (!block) {
+            return std::unexpected(block.error());
+        }
+        target = *block;
+        offset = target->ranges->Allocate(desc.size, alignment);
+    }
+
+    m_allocatedBytes += target->ranges->GetAllocationSize(offset);
+    if (desc.initialData) {
+        target->buffer->Update(desc.initialData, desc.size, offset);
+    }
+    return BufferView{target->buffer.get(), offset, desc.size};
+}
+
+void BufferAllocator::Free(const BufferView& view) {
+    if (!view) {
+        return;
+    }
+    auto it = std::find_if(m_blocks.begin(), m_blocks.end(),
+                           [&](const auto& block) { return block->buffer.get() == view.buffer; });
+    if (it == m_blocks.end()) {
+        LogWarning("BufferAllocator::Free: buffer was not allocated by this allocator");
+        return;
+    }
+
+    Block& block = **it;
+    if (!block.ranges) {
+        m_allocatedBytes -= view.size;
+        m_blocks.erase(it);
+        return;
+    }
+
+    m_allocatedBytes -= block.ranges->GetAllocationSize(view.offset);
+    block.ranges->Free(view.offset);
+
+    // Keep one empty block per class so that a free/allocate cycle does
+    // not create and destroy buffers
+    if (block.ranges->IsEmpty()) {
+        const bool hasSibling = std::any_of(m_blocks.begin(), m_blocks.end(), [&](const auto& other) {
+            return other.get() != &block && other->IsShared(block.usage, block.memoryAccess);
+        });
+        if (hasSibling) {
+            m_blocks.erase(it);
+        }
+    }
+}
+
+uint64_t BufferAllocator::GetReservedBytes() const noexcept {
+    uint64_t bytes = 0;
+    for (const auto& block : m_blocks) {
+        bytes += block->buffer->GetSize();
+    }
+    return bytes;
+}
+
+uint64_t BufferAllocator::GetAlignment(BufferUsage usage) const noexcept {
+    const auto& memory = m_device->GetFeatures().memory;
+    uint64_t alignment = MinAlignment;
+    if ((usage & BufferUsage::Uniform) == BufferUsage::Uniform) {
+        alignment = std::max<uint64_t>(alignment, memory.minUniformBufferAlignment);
+    }
+    if ((usage & BufferUsage::Storage) == BufferUsage::Storage) {
+        alignment = std::max<uint64_t>(alignment, memory.minStorageBufferAlignment);
+    }
+    return std::bit_ceil(alignment);
+}
+
+std::expected<BufferAllocator::Block*, Error>
+BufferAllocator::CreateBlock(const BufferDesc& desc, uint64_t size, bool dedicated) {
+    BufferDesc blockDesc;
+    blockDesc.size = static_cast<size_t>(size);
+    blockDesc.usage = desc.usage;
+    blockDesc.memoryAccess = desc.memoryAccess;
+    // Sub-allocations are written piecemeal; rotating a whole block for each would copy the rest
+    blockDesc.streaming = dedicated ? desc.streaming : BufferStreaming::None;
+    blockDesc.streamingCopies = desc.streamingCopies;
+    blockDesc.initialData = dedicated ? desc.initialData : nullptr;
+    blockDesc.debugName = dedicated ? desc.debugName : "BufferAllocator block";
+
+    auto buffer = m_device->CreateBuffer(blockDesc);
+    if (!buffer) {
+        return std::unexpected(buffer.error());
+    }
+
+    auto block = std::make_unique<Block>();
+    block->buffer = std::move(*buffer);
+    block->usage = desc.usage;
+    block->memoryAccess = desc.memoryAccess;
+    if (!dedicated) {
+        block->ranges = std::make_unique<TlsfAllocator>(size, MinAlignment);
+    }
+    m_blocks.push_back(std::move(block));
+    return m_blocks.back().get();
+}
+
+} // namespace VRHI
@@ -0,0 +1,49 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/Resources.hpp>
+
+namespace VRHI {
+
+inline bool HasMapAccess(MapAccess access, MapAccess flag) noexcept {
+    return (access & flag) == flag;
+}
+
+/// Check a Buffer::Map() request against the buffer's size and the rules of
+/// glMapBufferRange, which every backend follows
+/// @return Why the request is invalid, or nullptr if it is valid
+inline const char* ValidateMapRequest(size_t bufferSize, size_t offset, size_t size, MapAccess access) noexcept {
+    if (size == 0 || offset > bufferSize || size > bufferSize - offset) {
+        return "Map range out of bounds";
+    }
+    const bool read = HasMapAccess(access, MapAccess::Read);
+    const bool write = HasMapAccess(access, MapAccess::Write);
+    if (!read && !write) {
+        return "Map access needs Read or Write";
+    }
+    if (read && static_cast<uint32_t>(access & (MapAccess::InvalidateRange | MapAccess::InvalidateBuffer |
+                                                MapAccess::Unsynchronized))) {
+        return "Invalidating or unsynchronized maps cannot read";
+    }
+    if (!write && HasMapAccess(access, MapAccess::FlushExplicit)) {
+        return "FlushExplicit maps need Write";
+    }
+    return nullptr;
+}
+
+/// Check a Buffer::FlushRange() request against the mapping it flushes
+/// @return Why the request is invalid, or nullptr if it is valid
+inline const char* ValidateFlushRange(size_t mapOffset, size_t mapSize, MapAccess access,
+                                      size_t offset, size_t size) noexcept {
+    if (!HasMapAccess(access, MapAccess::FlushExplicit)) {
+        return "FlushRange needs a FlushExplicit mapping";
+    }
+    if (offset < mapOffset || offset - mapOffset > mapSize || size > mapSize - (offset - mapOffset)) {
+        return "FlushRange outside the mapped range";
+    }
+    return nullptr;
+}
+
+} // namespace VRHI
@@ -0,0 +1,33 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/Resources.hpp>
+
+namespace VRHI {
+
+/// The policy a buffer streams with once BufferStreaming::Auto is resolved,
+/// the same on every backend
+inline BufferStreaming ResolveStreaming(const BufferDesc& desc) noexcept {
+    if (desc.streaming == BufferStreaming::Auto) {
+        return desc.memoryAccess == MemoryAccess::CpuToGpu ? BufferStreaming::RoundRobin : BufferStreaming::None;
+    }
+    return desc.streaming;
+}
+
+/// Whether a resolved policy keeps several copies of the buffer
+inline bool StreamingRotates(BufferStreaming streaming) noexcept {
+    return streaming == BufferStreaming::RoundRobin || streaming == BufferStreaming::Unsynchronized;
+}
+
+/// Check a buffer's resolved streaming policy against its descriptor
+/// @return Why the descriptor is invalid, or nullptr if it is valid
+inline const char* ValidateStreaming(const BufferDesc& desc, BufferStreaming streaming) noexcept {
+    if (StreamingRotates(streaming) && desc.streamingCopies < 2) {
+        return "Streaming buffers need at least 2 copies";
+    }
+    return nullptr;
+}
+
+} // namespace VRHI
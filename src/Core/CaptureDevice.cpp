@@ -0,0 +1,539 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "CaptureDevice.hpp"
+#include "CommandDecoder.hpp"
+#include <VRHI/Capture.hpp>
+#include <algorithm>
+#include <type_traits>
+
+namespace VRHI {
+
+namespace {
+    /// Bytes of a width x height x depth region of a texture format
+    size_t GetTextureRegionSize(TextureFormat format, uint32_t width, uint32_t height, uint32_t depth) {
+        size_t blockBytes = 0;
+        uint32_t blockSize = 1;
+        switch (format) {
+            case TextureFormat::R8_UNorm:         blockBytes = 1; break;
+            case TextureFormat::RG8_UNorm:
+            case TextureFormat::R16_Float:
+            case TextureFormat::Depth16:          blockBytes = 2; break;
+            case TextureFormat::RGBA8_UNorm:
+            case TextureFormat::RGBA8_SRGB:
+            case TextureFormat::RG16_Float:
+            case TextureFormat::R32_Float:
+            case TextureFormat::R32_UInt:
+            case TextureFormat::Depth24Stencil8:
+            case TextureFormat::Depth32F:         blockBytes = 4; break;
+            case TextureFormat::RGBA16_Float:
+            case TextureFormat::RG32_Float:
+            case TextureFormat::RG32_UInt:
+            case TextureFormat::Depth32FStencil8: blockBytes = 8; break;
+            case TextureFormat::RGB32_Float:
+            case TextureFormat::RGB32_UInt:       blockBytes = 12; break;
+            case TextureFormat::RGBA32_Float:
+            case TextureFormat::RGBA32_UInt:      blockBytes = 16; break;
+            case TextureFormat::BC1_UNorm:
+            case TextureFormat::ETC2_RGB8:        blockBytes = 8; blockSize = 4; break;
+            case TextureFormat::BC3_UNorm:
+            case TextureFormat::BC7_UNorm:
+            case TextureFormat::ASTC_4x4:         blockBytes = 16; blockSize = 4; break;
+        }
+        const size_t blocksX = (width + blockSize - 1) / blockSize;
+        const size_t blocksY = (height + blockSize - 1) / blockSize;
+        return blocksX * blocksY * depth * blockBytes;
+    }
+
+    template<typename T>
+    std::span<const std::byte> AsTraceBytes(std::span<const T> values) noexcept {
+        return std::as_bytes(values);
+    }
+
+    std::span<const std::byte> AsTraceBytes(const void* data, size_t size) noexcept {
+        return {static_cast<const std::byte*>(data), data ? size : 0};
+    }
+} // anonymous namespace
+
+// ============================================================================
+// Capture Resources
+// ============================================================================
+
+CaptureBuffer::CaptureBuffer(CaptureDevice& device, uint32_t id, std::unique_ptr<Buffer> inner)
+    : m_device(&device), m_id(id), m_inner(std::move(inner))
+{
+}
+
+CaptureBuffer::~CaptureBuffer() {
+    m_device->WriteDestroy(m_id);
+}
+
+void* CaptureBuffer::Map() {
+    return Map(0, m_inner->GetSize());
+}
+
+void* CaptureBuffer::Map(size_t offset, size_t size) {
+    void* mapped = offset == 0 && size == m_inner->GetSize() ? m_inner->Map() : m_inner->Map(offset, size);
+    m_mapped = static_cast<std::byte*>(mapped);
+    m_mapOffset = offset;
+    m_mapSize = size;
+    return mapped;
+}
+
+void* CaptureBuffer::Map(size_t offset, size_t size, MapAccess access) {
+    void* mapped = m_inner->Map(offset, size, access);
+    m_mapped = static_cast<std::byte*>(mapped);
+    m_mapOffset = offset;
+    m_mapSize = size;
+    return mapped;
+}
+
+void CaptureBuffer::Unmap() {
+    // Whatever was written through the mapping becomes an update in the trace
+    if (m_mapped) {
+        const TraceUpdateBuffer record{m_id, 0, m_mapOffset, m_mapSize};
+        m_device->GetTraceWriter().Write(TraceRecordType::UpdateBuffer,
+                                         {AsTraceBytes(record), AsTraceBytes(m_mapped, m_mapSize)});
+        m_mapped = nullptr;
+    }
+    m_inner->Unmap();
+}
+
+void CaptureBuffer::Update(const void* data, size_t size, size_t offset) {
+    const TraceUpdateBuffer record{m_id, 0, offset, size};
+    m_device->GetTraceWriter().Write(TraceRecordType::UpdateBuffer,
+                                     {AsTraceBytes(record), AsTraceBytes(data, size)});
+    m_inner->Update(data, size, offset);
+}
+
+CaptureTexture::CaptureTexture(CaptureDevice& device, uint32_t id, std::unique_ptr<Texture> inner)
+    : m_device(&device), m_id(id), m_inner(std::move(inner))
+{
+}
+
+CaptureTexture::~CaptureTexture() {
+    m_device->WriteDestroy(m_id);
+}
+
+void CaptureTexture::Update(const void* data, size_t size, uint32_t mipLevel, uint32_t arrayLayer) {
+    const TraceUpdateTexture record{m_id, mipLevel, arrayLayer, 0, size};
+    m_device->GetTraceWriter().Write(TraceRecordType::UpdateTexture,
+                                     {AsTraceBytes(record), AsTraceBytes(data, size)});
+    m_inner->Update(data, size, mipLevel, arrayLayer);
+}
+
+void CaptureTexture::UpdateRegion(const void* data,
+                                  uint32_t x, uint32_t y, uint32_t z,
+                                  uint32_t width, uint32_t height, uint32_t depth,
+                                  uint32_t mipLevel, uint32_t arrayLayer) {
+    const size_t size = GetTextureRegionSize(m_inner->GetFormat(), width, height, depth);
+    const TraceUpdateTextureRegion record{m_id, x, y, z, width, height, depth, mipLevel, arrayLayer, 0, size};
+    m_device->GetTraceWriter().Write(TraceRecordType::UpdateTextureRegion,
+                                     {AsTraceBytes(record), AsTraceBytes(data, size)});
+    m_inner->UpdateRegion(data, x, y, z, width, height, depth, mipLevel, arrayLayer);
+}
+
+void CaptureTexture::GenerateMipmaps(CommandBuffer* cmd) {
+    const TraceGenerateMipmaps record{m_id, 0};
+    m_device->GetTraceWriter().Write(TraceRecordType::GenerateMipmaps, {AsTraceBytes(record)});
+    m_inner->GenerateMipmaps(UnwrapCaptured(cmd));
+}
+
+CaptureSampler::CaptureSampler(CaptureDevice& device, uint32_t id, std::unique_ptr<Sampler> inner)
+    : m_device(&device), m_id(id), m_inner(std::move(inner))
+{
+}
+
+CaptureSampler::~CaptureSampler() {
+    m_device->WriteDestroy(m_id);
+}
+
+CaptureShader::CaptureShader(CaptureDevice& device, uint32_t id, std::unique_ptr<Shader> inner)
+    : m_device(&device), m_id(id), m_inner(std::move(inner))
+{
+}
+
+CaptureShader::~CaptureShader() {
+    m_device->WriteDestroy(m_id);
+}
+
+CapturePipeline::CapturePipeline(CaptureDevice& device, uint32_t id, std::unique_ptr<Pipeline> inner)
+    : m_device(&device), m_id(id), m_inner(std::move(inner))
+{
+}
+
+CapturePipeline::~CapturePipeline() {
+    m_device->WriteDestroy(m_id);
+}
+
+CaptureRenderPass::CaptureRenderPass(CaptureDevice& device, uint32_t id, std::unique_ptr<RenderPass> inner)
+    : m_device(&device), m_id(id), m_inner(std::move(inner))
+{
+}
+
+CaptureRenderPass::~CaptureRenderPass() {
+    m_device->WriteDestroy(m_id);
+}
+
+CaptureFramebuffer::CaptureFramebuffer(CaptureDevice& device, uint32_t id, std::unique_ptr<Framebuffer> inner)
+    : m_device(&device), m_id(id), m_inner(std::move(inner))
+{
+}
+
+CaptureFramebuffer::~CaptureFramebuffer() {
+    m_device->WriteDestroy(m_id);
+}
+
+// ============================================================================
+// Capture Command Buffer
+// ============================================================================
+
+CaptureCommandBuffer::CaptureCommandBuffer(CaptureDevice& device, uint32_t id,
+                                           std::unique_ptr<CommandBuffer> inner, CommandBufferLevel level)
+    : RecordingCommandBuffer(level)
+    , m_device(&device)
+    , m_id(id)
+    , m_inner(std::move(inner))
+{
+}
+
+void CaptureCommandBuffer::End() {
+    RecordingCommandBuffer::End();
+    if (m_state != CommandBufferState::Executable) {
+        return;
+    }
+
+    const auto commands = m_stream.GetData();
+
+    // Trace copy: resources referenced by ID
+    m_scratch.assign(commands.begin(), commands.end());
+    RemapCommandResources(m_scratch, [](auto*& object) {
+        using T = std::remove_reference_t<decltype(*object)>;
+        object = TraceIdToPointer<T>(GetCapturedId(object));
+    });
+    const TraceRecordCommandBuffer record{m_id, static_cast<uint32_t>(m_level), m_scratch.size()};
+    m_device->GetTraceWriter().Write(TraceRecordType::RecordCommandBuffer,
+                                     {AsTraceBytes(record), std::span<const std::byte>(m_scratch)});
+
+    // Forwarded copy: resources of the inner device
+    m_scratch.assign(commands.begin(), commands.end());
+    RemapCommandResources(m_scratch, [](auto*& object) { object = UnwrapCaptured(object); });
+    m_inner->Begin();
+    DecodeCommands(m_scratch, *m_inner);
+    m_inner->End();
+}
+
+void CaptureCommandBuffer::Reset() {
+    RecordingCommandBuffer::Reset();
+    m_inner->Reset();
+}
+
+// ============================================================================
+// Capture Device
+// ============================================================================
+
+CaptureDevice::CaptureDevice(std::unique_ptr<Device> inner, std::unique_ptr<TraceWriter> writer)
+    : m_inner(std::move(inner))
+    , m_writer(std::move(writer))
+{
+}
+
+CaptureDevice::~CaptureDevice() {
+    ReleaseFrameContexts();
+}
+
+void CaptureDevice::WriteDestroy(uint32_t id) {
+    const TraceDestroy record{id, 0};
+    m_writer->Write(TraceRecordType::Destroy, {AsTraceBytes(record)});
+}
+
+std::expected<std::unique_ptr<Buffer>, Error>
+CaptureDevice::CreateBuffer(const BufferDesc& desc) {
+    auto inner = m_inner->CreateBuffer(desc);
+    if (!inner) {
+        return std::unexpected(inner.error());
+    }
+
+    const uint32_t id = AllocateId();
+    const TraceCreateBuffer record{
+        id,
+        static_cast<uint32_t>(desc.usage),
+        static_cast<uint32_t>(desc.memoryAccess),
+        desc.initialData != nullptr,
+        desc.size
+    };
+    m_writer->Write(TraceRecordType::CreateBuffer, {AsTraceBytes(record), AsTraceBytes(desc.initialData, desc.size)});
+    return std::make_unique<CaptureBuffer>(*this, id, std::move(*inner));
+}
+
+std::expected<std::unique_ptr<Texture>, Error>
+CaptureDevice::CreateTexture(const TextureDesc& desc) {
+    auto inner = m_inner->CreateTexture(desc);
+    if (!inner) {
+        return std::unexpected(inner.error());
+    }
+
+    // Backends upload mip 0 of the first layer from initialData
+    const size_t dataSize = desc.initialData
+        ? GetTextureRegionSize(desc.format, desc.width, desc.height, desc.depth)
+        : 0;
+
+    const uint32_t id = AllocateId();
+    const TraceCreateTexture record{
+        id,
+        static_cast<uint32_t>(desc.type),
+        static_cast<uint32_t>(desc.format),
+        static_cast<uint32_t>(desc.usage),
+        desc.width, desc.height, desc.depth,
+        desc.mipLevels, desc.arrayLayers, desc.sampleCount,
+        dataSize
+    };
+    m_writer->Write(TraceRecordType::CreateTexture, {AsTraceBytes(record), AsTraceBytes(desc.initialData, dataSize)});
+    return std::make_unique<CaptureTexture>(*this, id, std::move(*inner));
+}
+
+std::expected<std::unique_ptr<Sampler>, Error>
+CaptureDevice::CreateSampler(const SamplerDesc& desc) {
+    auto inner = m_inner->CreateSampler(desc);
+    if (!inner) {
+        return std::unexpected(inner.error());
+    }
+
+    const uint32_t id = AllocateId();
+    const TraceCreateSampler record{id, 0};
+    SamplerDesc traced = desc;
+    traced.debugName = nullptr;
+    m_writer->Write(TraceRecordType::CreateSampler, {AsTraceBytes(record), AsTraceBytes(traced)});
+    return std::make_unique<CaptureSampler>(*this, id, std::move(*inner));
+}
+
+std::expected<std::unique_ptr<Shader>, Error>
+CaptureDevice::CreateShader(const ShaderDesc& desc) {
+    auto inner = m_inner->CreateShader(desc);
+    if (!inner) {
+        return std::unexpected(inner.error());
+    }
+
+    const std::string_view entryPoint = desc.entryPoint ? desc.entryPoint : "main";
+    const uint32_t id = AllocateId();
+    const TraceCreateShader record{
+        id,
+        static_cast<uint32_t>(desc.stage),
+        static_cast<uint32_t>(desc.language),
+        static_cast<uint32_t>(entryPoint.size()),
+        desc.codeSize
+    };
+    m_writer->Write(TraceRecordType::CreateShader, {
+        AsTraceBytes(record),
+        AsTraceBytes(desc.code, desc.codeSize),
+        AsTraceBytes(entryPoint.data(), entryPoint.size())
+    });
+    return std::make_unique<CaptureShader>(*this, id, std::move(*inner));
+}
+
+std::expected<std::unique_ptr<Pipeline>, Error>
+CaptureDevice::CreatePipeline(const PipelineDesc& desc) {
+    PipelineDesc innerDesc = desc;
+    TraceCreatePipeline record{};
+    record.type = static_cast<uint32_t>(desc.type);
+    std::span<const uint32_t> sampleMask;
+
+    if (desc.type == PipelineType::Compute) {
+        innerDesc.compute.computeShader = UnwrapCaptured(desc.compute.computeShader);
+        record.shaders[0] = GetCapturedId(desc.compute.computeShader);
+    } else {
+        const GraphicsPipelineDesc& graphics = desc.graphics;
+        Shader* const shaders[] = {
+            graphics.vertexShader, graphics.fragmentShader, graphics.geometryShader,
+            graphics.tessControlShader, graphics.tessEvalShader
+        };
+        for (size_t i = 0; i < std::size(shaders); ++i) {
+            record.shaders[i] = GetCapturedId(shaders[i]);
+        }
+        innerDesc.graphics.vertexShader = UnwrapCaptured(graphics.vertexShader);
+        innerDesc.graphics.fragmentShader = UnwrapCaptured(graphics.fragmentShader);
+        innerDesc.graphics.geometryShader = UnwrapCaptured(graphics.geometryShader);
+        innerDesc.graphics.tessControlShader = UnwrapCaptured(graphics.tessControlShader);
+        innerDesc.graphics.tessEvalShader = UnwrapCaptured(graphics.tessEvalShader);
+        innerDesc.graphics.renderPass = UnwrapCaptured(graphics.renderPass);
+
+        const MultisampleState& multisample = graphics.multisample;
+        if (multisample.sampleMask) {
+            sampleMask = {multisample.sampleMask, (std::max(multisample.rasterizationSamples, 1u) + 31) / 32};
+        }
+
+        record.renderPass = GetCapturedId(graphics.renderPass);
+        record.subpass = graphics.subpass;
+        record.attributeCount = static_cast<uint32_t>(graphics.vertexInput.attributes.size());
+        record.bindingCount = static_cast<uint32_t>(graphics.vertexInput.bindings.size());
+        record.blendAttachmentCount = static_cast<uint32_t>(graphics.colorBlend.attachments.size());
+        record.dynamicStateCount = static_cast<uint32_t>(graphics.dynamicStates.size());
+        record.sampleMaskCount = static_cast<uint32_t>(sampleMask.size());
+        record.rasterizationSamples = multisample.rasterizationSamples;
+        record.sampleShadingEnable = multisample.sampleShadingEnable;
+        record.minSampleShading = multisample.minSampleShading;
+        record.alphaToCoverageEnable = multisample.alphaToCoverageEnable;
+        record.alphaToOneEnable = multisample.alphaToOneEnable;
+        record.logicOpEnable = graphics.colorBlend.logicOpEnable;
+        std::copy_n(graphics.colorBlend.blendConstants, 4, record.blendConstants);
+    }
+
+    auto inner = m_inner->CreatePipeline(innerDesc);
+    if (!inner) {
+        return std::unexpected(inner.error());
+    }
+
+    record.id = AllocateId();
+    if (desc.type == PipelineType::Compute) {
+        m_writer->Write(TraceRecordType::CreatePipeline, {AsTraceBytes(record)});
+    } else {
+        const GraphicsPipelineDesc& graphics = desc.graphics;
+        m_writer->Write(TraceRecordType::CreatePipeline, {
+            AsTraceBytes(record),
+            AsTraceBytes(graphics.inputAssembly),
+            AsTraceBytes(graphics.rasterization),
+            AsTraceBytes(graphics.depthStencil),
+            AsTraceBytes(graphics.vertexInput.attributes),
+            AsTraceBytes(graphics.vertexInput.bindings),
+            AsTraceBytes(graphics.colorBlend.attachments),
+            AsTraceBytes(graphics.dynamicStates),
+            AsTraceBytes(sampleMask)
+        });
+    }
+    return std::make_unique<CapturePipeline>(*this, record.id, std::move(*inner));
+}
+
+std::expected<std::unique_ptr<RenderPass>, Error>
+CaptureDevice::CreateRenderPass(const RenderPassDesc& desc) {
+    auto inner = m_inner->CreateRenderPass(desc);
+    if (!inner) {
+        return std::unexpected(inner.error());
+    }
+
+    const uint32_t id = AllocateId();
+    const TraceCreateRenderPass record{
+        id,
+        static_cast<uint32_t>(desc.attachments.size()),
+        static_cast<uint32_t>(desc.subpasses.size()),
+        static_cast<uint32_t>(desc.dependencies.size())
+    };
+
+    std::vector<TraceSubpass> subpasses;
+    subpasses.reserve(desc.subpasses.size());
+    std::vector<std::span<const std::byte>> parts{AsTraceBytes(record), AsTraceBytes(desc.attachments)};
+    for (const SubpassDesc& subpass : desc.subpasses) {
+        const auto& traced = subpasses.emplace_back(TraceSubpass{
+            static_cast<uint32_t>(subpass.colorAttachments.size()),
+            subpass.depthStencilAttachment != nullptr,
+            static_cast<uint32_t>(subpass.inputAttachments.size()),
+            static_cast<uint32_t>(subpass.preserveAttachments.size())
+        });
+        parts.push_back(AsTraceBytes(traced));
+        parts.push_back(AsTraceBytes(subpass.colorAttachments));
+        if (subpass.depthStencilAttachment) {
+            parts.push_back(AsTraceBytes(*subpass.depthStencilAttachment));
+        }
+        parts.push_back(AsTraceBytes(subpass.inputAttachments));
+        parts.push_back(AsTraceBytes(subpass.preserveAttachments));
+    }
+    parts.push_back(AsTraceBytes(desc.dependencies));
+
+    m_writer->Write(TraceRecordType::CreateRenderPass, parts);
+    return std::make_unique<CaptureRenderPass>(*this, id, std::move(*inner));
+}
+
+std::expected<std::unique_ptr<Framebuffer>, Error>
+CaptureDevice::CreateFramebuffer(const FramebufferDesc& desc) {
+    std::vector<Texture*> attachments;
+    std::vector<uint32_t> attachmentIds;
+    attachments.reserve(desc.attachments.size());
+    attachmentIds.reserve(desc.attachments.size());
+    for (Texture* texture : desc.attachments) {
+        attachments.push_back(UnwrapCaptured(texture));
+        attachmentIds.push_back(GetCapturedId(texture));
+    }
+
+    FramebufferDesc innerDesc = desc;
+    innerDesc.renderPass = UnwrapCaptured(desc.renderPass);
+    innerDesc.attachments = attachments;
+    auto inner = m_inner->CreateFramebuffer(innerDesc);
+    if (!inner) {
+        return std::unexpected(inner.error());
+    }
+
+    const uint32_t id = AllocateId();
+    const TraceCreateFramebuffer record{
+        id,
+        GetCapturedId(desc.renderPass),
+        desc.width, desc.height, desc.layers,
+        static_cast<uint32_t>(attachmentIds.size())
+    };
+    m_writer->Write(TraceRecordType::CreateFramebuffer,
+                    {AsTraceBytes(record), AsTraceBytes(std::span<const uint32_t>(attachmentIds))});
+    return std::make_unique<CaptureFramebuffer>(*this, id, std::move(*inner));
+}
+
+std::unique_ptr<CommandBuffer> CaptureDevice::CreateCommandBuffer(CommandBufferLevel level) {
+    auto inner = m_inner->CreateCommandBuffer(level);
+    if (!inner) {
+        return nullptr;
+    }
+    return std::make_unique<CaptureCommandBuffer>(*this, AllocateId(), std::move(inner), level);
+}
+
+void CaptureDevice::Submit(std::unique_ptr<CommandBuffer> cmd, Fence* signalFence) {
+    Submit(cmd.get(), signalFence);
+}
+
+void CaptureDevice::Submit(CommandBuffer* cmd, Fence* signalFence) {
+    if (cmd) {
+        const TraceSubmit record{GetCapturedId(cmd), 0};
+        m_writer->Write(TraceRecordType::Submit, {AsTraceBytes(record)});
+    }
+    m_inner->Submit(UnwrapCaptured(cmd), signalFence);
+    if (cmd) {
+        static_cast<CaptureCommandBuffer*>(cmd)->MarkSubmitted();
+    }
+}
+
+void CaptureDevice::Submit(std::span<std::unique_ptr<CommandBuffer>> cmds, Fence* signalFence) {
+    for (size_t i = 0; i < cmds.size(); ++i) {
+        Submit(cmds[i].get(), i + 1 == cmds.size() ? signalFence : nullptr);
+    }
+    if (cmds.empty() && signalFence) {
+        Submit(nullptr, signalFence);
+    }
+}
+
+void CaptureDevice::Present() {
+    m_writer->Write(TraceRecordType::Present);
+    m_inner->Present();
+}
+
+void CaptureDevice::Resize(uint32_t width, uint32_t height) {
+    const TraceResize record{width, height};
+    m_writer->Write(TraceRecordType::Resize, {AsTraceBytes(record)});
+    m_inner->Resize(width, height);
+}
+
+// ============================================================================
+// Public Entry Point
+// ============================================================================
+
+std::expected<std::unique_ptr<Device>, Error>
+CreateCaptureDevice(std::unique_ptr<Device> device, const std::filesystem::path& tracePath) {
+    if (!device) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "CreateCaptureDevice requires a device"
+        });
+    }
+
+    auto writer = TraceWriter::Open(tracePath);
+    if (!writer) {
+        return std::unexpected(writer.error());
+    }
+    return std::make_unique<CaptureDevice>(std::move(device), std::move(*writer));
+}
+
+} // namespace VRHI
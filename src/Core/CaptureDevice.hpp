@@ -0,0 +1,304 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/RecordingCommandBuffer.hpp>
+#include "TraceFile.hpp"
+#include <VRHI/Pipeline.hpp>
+#include <VRHI/RenderPass.hpp>
+#include <VRHI/Resources.hpp>
+#include <VRHI/Shader.hpp>
+#include <VRHI/Sync.hpp>
+#include <VRHI/VRHI.hpp>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace VRHI {
+
+class CaptureDevice;
+
+// ============================================================================
+// Capture Resources
+// ============================================================================
+//
+// Every object handed out by a CaptureDevice wraps the object of the inner
+// device and carries the trace ID that recorded commands refer to it by.
+
+class CaptureBuffer final : public Buffer {
+public:
+    CaptureBuffer(CaptureDevice& device, uint32_t id, std::unique_ptr<Buffer> inner);
+    ~CaptureBuffer() override;
+
+    size_t GetSize() const noexcept override { return m_inner->GetSize(); }
+    BufferUsage GetUsage() const noexcept override { return m_inner->GetUsage(); }
+
+    void* Map() override;
+    void* Map(size_t offset, size_t size) override;
+    void* Map(size_t offset, size_t size, MapAccess access) override;
+    void FlushRange(size_t offset, size_t size) override { m_inner->FlushRange(offset, size); }
+    void Unmap() override;
+    void Update(const void* data, size_t size, size_t offset = 0) override;
+    void Read(void* data, size_t size, size_t offset = 0) override { m_inner->Read(data, size, offset); }
+
+    Buffer* GetInner() const noexcept { return m_inner.get(); }
+    uint32_t GetTraceId() const noexcept { return m_id; }
+
+private:
+    CaptureDevice* m_device;
+    uint32_t m_id;
+    std::unique_ptr<Buffer> m_inner;
+
+    // Range of the current mapping, recorded as an update on Unmap()
+    std::byte* m_mapped = nullptr;
+    size_t m_mapOffset = 0;
+    size_t m_mapSize = 0;
+};
+
+class CaptureTexture final : public Texture {
+public:
+    CaptureTexture(CaptureDevice& device, uint32_t id, std::unique_ptr<Texture> inner);
+    ~CaptureTexture() override;
+
+    TextureType GetType() const noexcept override { return m_inner->GetType(); }
+    TextureFormat GetFormat() const noexcept override { return m_inner->GetFormat(); }
+    uint32_t GetWidth() const noexcept override { return m_inner->GetWidth(); }
+    uint32_t GetHeight() const noexcept override { return m_inner->GetHeight(); }
+    uint32_t GetDepth() const noexcept override { return m_inner->GetDepth(); }
+    uint32_t GetMipLevels() const noexcept override { return m_inner->GetMipLevels(); }
+    uint32_t GetArrayLayers() const noexcept override { return m_inner->GetArrayLayers(); }
+
+    void Update(const void* data, size_t size,
+               uint32_t mipLevel = 0, uint32_t arrayLayer = 0) override;
+    void UpdateRegion(const void* data,
+                     uint32_t x, uint32_t y, uint32_t z,
+                     uint32_t width, uint32_t height, uint32_t depth,
+                     uint32_t mipLevel = 0, uint32_t arrayLayer = 0) override;
+    void GenerateMipmaps(CommandBuffer* cmd) override;
+    void Read(void* data, size_t size,
+             uint32_t mipLevel = 0, uint32_t arrayLayer = 0) override {
+        m_inner->Read(data, size, mipLevel, arrayLayer);
+    }
+
+    Texture* GetInner() const noexcept { return m_inner.get(); }
+    uint32_t GetTraceId() const noexcept { return m_id; }
+
+private:
+    CaptureDevice* m_device;
+    uint32_t m_id;
+    std::unique_ptr<Texture> m_inner;
+};
+
+class CaptureSampler final : public Sampler {
+public:
+    CaptureSampler(CaptureDevice& device, uint32_t id, std::unique_ptr<Sampler> inner);
+    ~CaptureSampler() override;
+
+    Sampler* GetInner() const noexcept { return m_inner.get(); }
+    uint32_t GetTraceId() const noexcept { return m_id; }
+
+private:
+    CaptureDevice* m_device;
+    uint32_t m_id;
+    std::unique_ptr<Sampler> m_inner;
+};
+
+class CaptureShader final : public Shader {
+public:
+    CaptureShader(CaptureDevice& device, uint32_t id, std::unique_ptr<Shader> inner);
+    ~CaptureShader() override;
+
+    ShaderStage GetStage() const noexcept override { return m_inner->GetStage(); }
+    ShaderLanguage GetLanguage() const noexcept override { return m_inner->GetLanguage(); }
+    std::string_view GetEntryPoint() const noexcept override { return m_inner->GetEntryPoint(); }
+    void* GetNativeHandle() const noexcept override { return m_inner->GetNativeHandle(); }
+
+    Shader* GetInner() const noexcept { return m_inner.get(); }
+    uint32_t GetTraceId() const noexcept { return m_id; }
+
+private:
+    CaptureDevice* m_device;
+    uint32_t m_id;
+    std::unique_ptr<Shader> m_inner;
+};
+
+class CapturePipeline final : public Pipeline {
+public:
+    CapturePipeline(CaptureDevice& device, uint32_t id, std::unique_ptr<Pipeline> inner);
+    ~CapturePipeline() override;
+
+    PipelineType GetType() const noexcept override { return m_inner->GetType(); }
+    void* GetNativeHandle() const noexcept override { return m_inner->GetNativeHandle(); }
+
+    Pipeline* GetInner() const noexcept { return m_inner.get(); }
+    uint32_t GetTraceId() const noexcept { return m_id; }
+
+private:
+    CaptureDevice* m_device;
+    uint32_t m_id;
+    std::unique_ptr<Pipeline> m_inner;
+};
+
+class CaptureRenderPass final : public RenderPass {
+public:
+    CaptureRenderPass(CaptureDevice& device, uint32_t id, std::unique_ptr<RenderPass> inner);
+    ~CaptureRenderPass() override;
+
+    void* GetNativeHandle() const noexcept override { return m_inner->GetNativeHandle(); }
+
+    RenderPass* GetInner() const noexcept { return m_inner.get(); }
+    uint32_t GetTraceId() const noexcept { return m_id; }
+
+private:
+    CaptureDevice* m_device;
+    uint32_t m_id;
+    std::unique_ptr<RenderPass> m_inner;
+};
+
+class CaptureFramebuffer final : public Framebuffer {
+public:
+    CaptureFramebuffer(CaptureDevice& device, uint32_t id, std::unique_ptr<Framebuffer> inner);
+    ~CaptureFramebuffer() override;
+
+    uint32_t GetWidth() const noexcept override { return m_inner->GetWidth(); }
+    uint32_t GetHeight() const noexcept override { return m_inner->GetHeight(); }
+    uint32_t GetLayers() const noexcept override { return m_inner->GetLayers(); }
+    void* GetNativeHandle() const noexcept override { return m_inner->GetNativeHandle(); }
+
+    Framebuffer* GetInner() const noexcept { return m_inner.get(); }
+    uint32_t GetTraceId() const noexcept { return m_id; }
+
+private:
+    CaptureDevice* m_device;
+    uint32_t m_id;
+    std::unique_ptr<Framebuffer> m_inner;
+};
+
+// ============================================================================
+// Capture Command Buffer
+// ============================================================================
+
+/// Records like any other command buffer. End() writes the recording to the
+/// trace and re-records it, with every resource unwrapped, into a command
+/// buffer of the inner device, which is what gets submitted.
+class CaptureCommandBuffer final : public RecordingCommandBuffer {
+public:
+    CaptureCommandBuffer(CaptureDevice& device, uint32_t id, std::unique_ptr<CommandBuffer> inner, CommandBufferLevel level);
+    ~CaptureCommandBuffer() override = default;
+
+    void End() override;
+    void Reset() override;
+
+    CommandBuffer* GetInner() const noexcept { return m_inner.get(); }
+    uint32_t GetTraceId() const noexcept { return m_id; }
+
+    using RecordingCommandBuffer::MarkSubmitted;
+
+private:
+    CaptureDevice* m_device;
+    uint32_t m_id;
+    std::unique_ptr<CommandBuffer> m_inner;
+    std::vector<std::byte> m_scratch;  // Remapped copy of the stream, kept across recordings
+};
+
+// ============================================================================
+// Capture Device
+// ============================================================================
+
+/// Device decorator that writes a trace of everything done through it.
+/// See CreateCaptureDevice().
+class CaptureDevice final : public Device {
+public:
+    CaptureDevice(std::unique_ptr<Device> inner, std::unique_ptr<TraceWriter> writer);
+    ~CaptureDevice() override;
+
+    // Device Information
+    BackendType GetBackendType() const noexcept override { return m_inner->GetBackendType(); }
+    BackendInfo GetBackendInfo() const override { return m_inner->GetBackendInfo(); }
+    const FeatureSet& GetFeatures() const noexcept override { return m_inner->GetFeatures(); }
+    bool IsFeatureSupported(Feature feature) const noexcept override { return m_inner->IsFeatureSupported(feature); }
+    const DeviceProperties& GetProperties() const noexcept override { return m_inner->GetProperties(); }
+
+    // Resource Creation
+    std::expected<std::unique_ptr<Buffer>, Error>
+    CreateBuffer(const struct BufferDesc& desc) override;
+
+    std::expected<std::unique_ptr<Texture>, Error>
+    CreateTexture(const struct TextureDesc& desc) override;
+
+    std::expected<std::unique_ptr<Sampler>, Error>
+    CreateSampler(const struct SamplerDesc& desc) override;
+
+    std::expected<std::unique_ptr<Shader>, Error>
+    CreateShader(const struct ShaderDesc& desc) override;
+
+    std::expected<std::unique_ptr<Pipeline>, Error>
+    CreatePipeline(const struct PipelineDesc& desc) override;
+
+    std::expected<std::unique_ptr<RenderPass>, Error>
+    CreateRenderPass(const struct RenderPassDesc& desc) override;
+
+    std::expected<std::unique_ptr<Framebuffer>, Error>
+    CreateFramebuffer(const struct FramebufferDesc& desc) override;
+
+    // Command Execution
+    std::unique_ptr<CommandBuffer> CreateCommandBuffer(CommandBufferLevel level = CommandBufferLevel::Primary) override;
+    void Submit(std::unique_ptr<CommandBuffer> cmd, Fence* signalFence = nullptr) override;
+    void Submit(CommandBuffer* cmd, Fence* signalFence = nullptr) override;
+    void Submit(std::span<std::unique_ptr<CommandBuffer>> cmds, Fence* signalFence = nullptr) override;
+    void WaitIdle() override { m_inner->WaitIdle(); }
+
+    // Synchronization (not captured)
+    std::unique_ptr<Fence> CreateFence(bool signaled = false) override { return m_inner->CreateFence(signaled); }
+    std::unique_ptr<Semaphore> CreateSemaphore() override { return m_inner->CreateSemaphore(); }
+    void Flush() override { m_inner->Flush(); }
+
+    // Swap Chain
+    SwapChain* GetSwapChain() noexcept override { return m_inner->GetSwapChain(); }
+    void Present() override;
+    void Resize(uint32_t width, uint32_t height) override;
+
+    // Statistics
+    FrameStats GetFrameStats() const noexcept override { return m_inner->GetFrameStats(); }
+
+    TraceWriter& GetTraceWriter() noexcept { return *m_writer; }
+
+    /// Record the destruction of a captured object
+    void WriteDestroy(uint32_t id);
+
+private:
+    uint32_t AllocateId() noexcept { return m_nextId.fetch_add(1, std::memory_order_relaxed); }
+
+    std::unique_ptr<Device> m_inner;
+    std::unique_ptr<TraceWriter> m_writer;
+    std::atomic<uint32_t> m_nextId{1};  // 0 is reserved for null references
+};
+
+// ============================================================================
+// Wrapper Lookup
+// ============================================================================
+
+template<typename T> struct CaptureWrapper;
+template<> struct CaptureWrapper<Buffer> { using Type = CaptureBuffer; };
+template<> struct CaptureWrapper<Texture> { using Type = CaptureTexture; };
+template<> struct CaptureWrapper<Sampler> { using Type = CaptureSampler; };
+template<> struct CaptureWrapper<Shader> { using Type = CaptureShader; };
+template<> struct CaptureWrapper<Pipeline> { using Type = CapturePipeline; };
+template<> struct CaptureWrapper<RenderPass> { using Type = CaptureRenderPass; };
+template<> struct CaptureWrapper<Framebuffer> { using Type = CaptureFramebuffer; };
+template<> struct CaptureWrapper<CommandBuffer> { using Type = CaptureCommandBuffer; };
+
+/// Inner-device object of a capture object (null stays null)
+template<typename T>
+T* UnwrapCaptured(T* object) noexcept {
+    return object ? static_cast<typename CaptureWrapper<T>::Type*>(object)->GetInner() : nullptr;
+}
+
+/// Trace ID of a capture object (0 for null)
+template<typename T>
+uint32_t GetCapturedId(const T* object) noexcept {
+    return object ? static_cast<const typename CaptureWrapper<T>::Type*>(object)->GetTraceId() : 0;
+}
+
+} // namespace VRHI
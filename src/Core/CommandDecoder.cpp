@@ -0,0 +1,175 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "CommandDecoder.hpp"
+
+namespace VRHI {
+
+namespace {
+    const float* GetMarkerColor(const CmdDebugMarker& cmd) noexcept {
+        return cmd.hasColor ? cmd.color : nullptr;
+    }
+} // anonymous namespace
+
+void DecodeCommands(std::span<const std::byte> commands, CommandBuffer& target) {
+    const CommandStream::Iterator end(commands.data() + commands.size());
+    for (CommandStream::Iterator it(commands.data()); it != end; ++it) {
+        const CommandHeader& header = *it;
+        switch (header.type) {
+            case CommandType::BeginRenderPass: {
+                const auto& cmd = header.As<CmdBeginRenderPass>();
+                target.BeginRenderPass(cmd.renderPass, cmd.framebuffer, cmd.renderArea, cmd.GetClearValues());
+                break;
+            }
+            case CommandType::EndRenderPass:
+                target.EndRenderPass();
+                break;
+            case CommandType::BindPipeline:
+                target.BindPipeline(header.As<CmdBindPipeline>().pipeline);
+                break;
+            case CommandType::BindVertexBuffers: {
+                const auto& cmd = header.As<CmdBindVertexBuffers>();
+                target.BindVertexBuffers(cmd.firstBinding, cmd.GetBuffers(), cmd.GetOffsets());
+                break;
+            }
+            case CommandType::BindIndexBuffer: {
+                const auto& cmd = header.As<CmdBindIndexBuffer>();
+                target.BindIndexBuffer(cmd.buffer, cmd.offset, cmd.use16BitIndices);
+                break;
+            }
+            case CommandType::BindUniformBuffer: {
+                const auto& cmd = header.As<CmdBindUniformBuffer>();
+                target.BindUniformBuffer(cmd.binding, cmd.buffer, cmd.offset, cmd.size);
+                break;
+            }
+            case CommandType::BindStorageBuffer: {
+                const auto& cmd = header.As<CmdBindStorageBuffer>();
+                target.BindStorageBuffer(cmd.binding, cmd.buffer, cmd.offset, cmd.size);
+                break;
+            }
+            case CommandType::BindTexture: {
+                const auto& cmd = header.As<CmdBindTexture>();
+                target.BindTexture(cmd.binding, cmd.texture, cmd.sampler);
+                break;
+            }
+            case CommandType::PushConstants: {
+                const auto& cmd = header.As<CmdPushConstants>();
+                target.PushConstants(cmd.stages, cmd.offset, cmd.GetData());
+                break;
+            }
+            case CommandType::SetViewports:
+                target.SetViewports(header.As<CmdSetViewports>().GetViewports());
+                break;
+            case CommandType::SetScissors:
+                target.SetScissors(header.As<CmdSetScissors>().GetScissors());
+                break;
+            case CommandType::SetLineWidth:
+                target.SetLineWidth(header.As<CmdSetLineWidth>().width);
+                break;
+            case CommandType::SetBlendConstants:
+                target.SetBlendConstants(header.As<CmdSetBlendConstants>().constants);
+                break;
+            case CommandType::SetDepthBias: {
+                const auto& cmd = header.As<CmdSetDepthBias>();
+                target.SetDepthBias(cmd.constantFactor, cmd.clamp, cmd.slopeFactor);
+                break;
+            }
+            case CommandType::SetDepthBounds: {
+                const auto& cmd = header.As<CmdSetDepthBounds>();
+                target.SetDepthBounds(cmd.minDepth, cmd.maxDepth);
+                break;
+            }
+            case CommandType::SetStencilCompareMask: {
+                const auto& cmd = header.As<CmdSetStencilCompareMask>();
+                target.SetStencilCompareMask(cmd.frontFace, cmd.value);
+                break;
+            }
+            case CommandType::SetStencilWriteMask: {
+                const auto& cmd = header.As<CmdSetStencilWriteMask>();
+                target.SetStencilWriteMask(cmd.frontFace, cmd.value);
+                break;
+            }
+            case CommandType::SetStencilReference: {
+                const auto& cmd = header.As<CmdSetStencilReference>();
+                target.SetStencilReference(cmd.frontFace, cmd.value);
+                break;
+            }
+            case CommandType::Draw:
+                target.Draw(header.As<CmdDraw>().params);
+                break;
+            case CommandType::DrawIndexed:
+                target.DrawIndexed(header.As<CmdDrawIndexed>().params);
+                break;
+            case CommandType::DrawIndirect: {
+                const auto& cmd = header.As<CmdDrawIndirect>();
+                target.DrawIndirect(cmd.buffer, cmd.offset, cmd.drawCount, cmd.stride);
+                break;
+            }
+            case CommandType::DrawIndexedIndirect: {
+                const auto& cmd = header.As<CmdDrawIndexedIndirect>();
+                target.DrawIndexedIndirect(cmd.buffer, cmd.offset, cmd.drawCount, cmd.stride);
+                break;
+            }
+            case CommandType::Dispatch:
+                target.Dispatch(header.As<CmdDispatch>().params);
+                break;
+            case CommandType::DispatchIndirect: {
+                const auto& cmd = header.As<CmdDispatchIndirect>();
+                target.DispatchIndirect(cmd.buffer, cmd.offset);
+                break;
+            }
+            case CommandType::ClearColorAttachment: {
+                const auto& cmd = header.As<CmdClearColorAttachment>();
+                target.ClearColorAttachment(cmd.attachment, cmd.color, cmd.rect);
+                break;
+            }
+            case CommandType::ClearDepthStencilAttachment: {
+                const auto& cmd = header.As<CmdClearDepthStencilAttachment>();
+                target.ClearDepthStencilAttachment(cmd.value, cmd.rect);
+                break;
+            }
+            case CommandType::CopyBuffer: {
+                const auto& cmd = header.As<CmdCopyBuffer>();
+                target.CopyBuffer(cmd.src, cmd.dst, cmd.srcOffset, cmd.dstOffset, cmd.size);
+                break;
+            }
+            case CommandType::CopyBufferToTexture: {
+                const auto& cmd = header.As<CmdCopyBufferToTexture>();
+                target.CopyBufferToTexture(cmd.src, cmd.dst, cmd.mipLevel, cmd.arrayLayer);
+                break;
+            }
+            case CommandType::CopyTextureToBuffer: {
+                const auto& cmd = header.As<CmdCopyTextureToBuffer>();
+                target.CopyTextureToBuffer(cmd.src, cmd.dst, cmd.mipLevel, cmd.arrayLayer);
+                break;
+            }
+            case CommandType::CopyTexture: {
+                const auto& cmd = header.As<CmdCopyTexture>();
+                target.CopyTexture(cmd.src, cmd.dst, cmd.srcMipLevel, cmd.srcArrayLayer,
+                                   cmd.dstMipLevel, cmd.dstArrayLayer);
+                break;
+            }
+            case CommandType::PipelineBarrier:
+                target.PipelineBarrier();
+                break;
+            case CommandType::BeginDebugMarker: {
+                const auto& cmd = header.As<CmdBeginDebugMarker>();
+                target.BeginDebugMarker(cmd.GetName(), GetMarkerColor(cmd));
+                break;
+            }
+            case CommandType::EndDebugMarker:
+                target.EndDebugMarker();
+                break;
+            case CommandType::InsertDebugMarker: {
+                const auto& cmd = header.As<CmdInsertDebugMarker>();
+                target.InsertDebugMarker(cmd.GetName(), GetMarkerColor(cmd));
+                break;
+            }
+            case CommandType::ExecuteCommands:
+                target.ExecuteCommands(header.As<CmdExecuteCommands>().GetCommandBuffers());
+                break;
+        }
+    }
+}
+
+} // namespace VRHI
@@ -0,0 +1,113 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/CommandStream.hpp>
+#include <cstddef>
+#include <span>
+
+namespace VRHI {
+
+/// Re-issue encoded commands through the public CommandBuffer interface.
+///
+/// `commands` holds back-to-back commands as produced by CommandStream (see
+/// CommandStream::GetData()) and must be 8-byte aligned. This is how a stream
+/// is moved to a command buffer of another device, e.g. by the capture layer
+/// and the trace player.
+void DecodeCommands(std::span<const std::byte> commands, CommandBuffer& target);
+
+/// Rewrite every resource pointer stored in encoded commands.
+///
+/// `remap` is invoked with a reference to each pointer slot, typed as one of
+/// Pipeline*, RenderPass*, Framebuffer*, Buffer*, Texture*, Sampler* or
+/// CommandBuffer*, so a generic lambda taking `auto*&` covers all of them.
+template<typename Remap>
+void RemapCommandResources(std::span<std::byte> commands, Remap&& remap) {
+    std::byte* ptr = commands.data();
+    std::byte* const end = ptr + commands.size();
+    while (ptr < end) {
+        auto& header = *reinterpret_cast<CommandHeader*>(ptr);
+        switch (header.type) {
+            case CommandType::BeginRenderPass: {
+                auto& cmd = header.As<CmdBeginRenderPass>();
+                remap(cmd.renderPass);
+                remap(cmd.framebuffer);
+                break;
+            }
+            case CommandType::BindPipeline:
+                remap(header.As<CmdBindPipeline>().pipeline);
+                break;
+            case CommandType::BindVertexBuffers: {
+                auto& cmd = header.As<CmdBindVertexBuffers>();
+                Buffer** buffers = CommandStream::GetTrailingData<Buffer*>(cmd);
+                for (uint32_t i = 0; i < cmd.bufferCount; ++i) {
+                    remap(buffers[i]);
+                }
+                break;
+            }
+            case CommandType::BindIndexBuffer:
+                remap(header.As<CmdBindIndexBuffer>().buffer);
+                break;
+            case CommandType::BindUniformBuffer:
+                remap(header.As<CmdBindUniformBuffer>().buffer);
+                break;
+            case CommandType::BindStorageBuffer:
+                remap(header.As<CmdBindStorageBuffer>().buffer);
+                break;
+            case CommandType::BindTexture: {
+                auto& cmd = header.As<CmdBindTexture>();
+                remap(cmd.texture);
+                remap(cmd.sampler);
+                break;
+            }
+            case CommandType::DrawIndirect:
+                remap(header.As<CmdDrawIndirect>().buffer);
+                break;
+            case CommandType::DrawIndexedIndirect:
+                remap(header.As<CmdDrawIndexedIndirect>().buffer);
+                break;
+            case CommandType::DispatchIndirect:
+                remap(header.As<CmdDispatchIndirect>().buffer);
+                break;
+            case CommandType::CopyBuffer: {
+                auto& cmd = header.As<CmdCopyBuffer>();
+                remap(cmd.src);
+                remap(cmd.dst);
+                break;
+            }
+            case CommandType::CopyBufferToTexture: {
+                auto& cmd = header.As<CmdCopyBufferToTexture>();
+                remap(cmd.src);
+                remap(cmd.dst);
+                break;
+            }
+            case CommandType::CopyTextureToBuffer: {
+                auto& cmd = header.As<CmdCopyTextureToBuffer>();
+                remap(cmd.src);
+                remap(cmd.dst);
+                break;
+            }
+            case CommandType::CopyTexture: {
+                auto& cmd = header.As<CmdCopyTexture>();
+                remap(cmd.src);
+                remap(cmd.dst);
+                break;
+            }
+            case CommandType::ExecuteCommands: {
+                auto& cmd = header.As<CmdExecuteCommands>();
+                CommandBuffer** secondaries = CommandStream::GetTrailingData<CommandBuffer*>(cmd);
+                for (uint32_t i = 0; i < cmd.count; ++i) {
+                    remap(secondaries[i]);
+                }
+                break;
+            }
+            default:
+                // No resource references
+                break;
+        }
+        ptr += header.size;
+    }
+}
+
+} // namespace VRHI
@@ -0,0 +1,36 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include <VRHI/CommandStream.hpp>
+#include <algorithm>
+#include <cstring>
+
+namespace VRHI {
+
+namespace {
+    // Enough for a typical pass worth of commands without reallocating
+    constexpr size_t InitialCapacity = 4096;
+} // anonymous namespace
+
+void CommandStream::Reserve(size_t bytes) {
+    if (bytes > m_capacity) {
+        Grow(bytes);
+    }
+}
+
+void CommandStream::Grow(size_t required) {
+    size_t newCapacity = std::max(m_capacity * 2, InitialCapacity);
+    while (newCapacity < required) {
+        newCapacity *= 2;
+    }
+
+    auto newData = std::make_unique_for_overwrite<std::byte[]>(newCapacity);
+    if (m_size > 0) {
+        std::memcpy(newData.get(), m_data.get(), m_size);
+    }
+
+    m_data = std::move(newData);
+    m_capacity = newCapacity;
+}
+
+} // namespace VRHI
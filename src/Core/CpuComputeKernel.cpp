@@ -0,0 +1,737 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "CpuComputeKernel.hpp"
+#include "ThreadPool.hpp"
+#include <VRHI/CommandBuffer.hpp>
+#include <VRHI/Logging.hpp>
+#include <spirv_cross/external_interface.h>
+#include <spirv_cpp.hpp>
+#include <spirv_parser.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#ifndef _WIN32
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace VRHI {
+
+namespace {
+    /// SPIRV-Cross's C++ backend has no working push constant blocks, so they
+    /// become a uniform buffer in this otherwise unused slot
+    constexpr uint32_t PushConstantSet = 3;
+    constexpr uint32_t PushConstantBinding = CpuComputeKernel::MaxBindings;
+
+    constexpr uint32_t MaxInvocations = 1024;
+
+    /// Bump when the generated source changes, to invalidate cached libraries
+    constexpr uint32_t KernelFormat = 1;
+
+    /// Runs the invocations of a workgroup one after another. Prepended to the
+    /// generated source, ahead of the macros it defines for shader resources.
+    constexpr const char* SerialDriverSource = R"(#include "spirv_cross/internal_interface.hpp"
+
+template <typename T, typename Res, unsigned X, unsigned Y, unsigned Z>
+struct VRHISerialComputeShader : spirv_cross::BaseShader<VRHISerialComputeShader<T, Res, X, Y, Z>>
+{
+    VRHISerialComputeShader()
+    {
+        resources.init(*this);
+        unsigned index = 0;
+        for (unsigned z = 0; z < Z; z++)
+            for (unsigned y = 0; y < Y; y++)
+                for (unsigned x = 0; x < X; x++)
+                {
+                    impl[index].__priv_res.gl_LocalInvocationID__ = glm::uvec3(x, y, z);
+                    impl[index].__priv_res.gl_LocalInvocationIndex__ = index;
+                    impl[index].__res = &resources;
+                    index++;
+                }
+    }
+
+    void main()
+    {
+        const glm::uvec3 base = glm::uvec3(X, Y, Z) * resources.gl_WorkGroupID__.get();
+        for (unsigned i = 0; i < X * Y * Z; i++)
+        {
+            impl[i].__priv_res.gl_GlobalInvocationID__ = base + impl[i].__priv_res.gl_LocalInvocationID__;
+            impl[i].main();
+        }
+    }
+
+    T impl[X * Y * Z];
+    Res resources;
+};
+
+)";
+
+    /// Entry point of the serial driver, appended to the generated source
+    std::string SerialInterfaceSource(const std::array<uint32_t, 3>& size) {
+        const std::string type = "VRHISerialComputeShader<Impl::Shader, Impl::Shader::Resources, " +
+                                 std::to_string(size[0]) + ", " + std::to_string(size[1]) + ", " +
+                                 std::to_string(size[2]) + ">";
+        return "\nstatic spirv_cross_shader_t *vrhi_serial_construct(void)\n{\n    return new " + type + "();\n}\n"
+               "\nstatic void vrhi_serial_destruct(spirv_cross_shader_t *shader)\n{\n"
+               "    delete static_cast<" + type + " *>(shader);\n}\n"
+               "\nstatic void vrhi_serial_invoke(spirv_cross_shader_t *shader)\n{\n"
+               "    static_cast<" + type + " *>(shader)->invoke();\n}\n"
+               "\nstatic const struct spirv_cross_interface vrhi_serial_vtable =\n{\n"
+               "    vrhi_serial_construct,\n    vrhi_serial_destruct,\n    vrhi_serial_invoke,\n};\n"
+               "\nextern \"C\" const struct spirv_cross_interface *vrhi_serial_get_interface(void)\n{\n"
+               "    return &vrhi_serial_vtable;\n}\n";
+    }
+
+    std::string GetEnvironment(const char* name) {
+        const char* value = std::getenv(name);
+        return value ? value : "";
+    }
+
+    uint64_t Fnv1a(uint64_t hash, const void* data, size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    struct CppLayout {
+        uint64_t size = 0;
+        uint64_t alignment = 1;
+    };
+
+    /// Layout of a type in the generated C++, where members follow each other
+    /// at their natural alignment and arrays are tightly packed
+    std::expected<CppLayout, std::string>
+    GetCppLayout(const spirv_cross::Compiler& compiler, const spirv_cross::SPIRType& type) {
+        using spirv_cross::SPIRType;
+
+        if (type.basetype == SPIRType::Struct) {
+            CppLayout layout;
+            for (uint32_t i = 0; i < type.member_types.size(); ++i) {
+                const std::string name = compiler.get_member_name(type.self, i);
+                const SPIRType& memberType = compiler.get_type(type.member_types[i]);
+
+                if (compiler.has_member_decoration(type.self, i, spv::DecorationRowMajor)) {
+                    return std::unexpected("member '" + name + "' is row_major");
+                }
+                if (memberType.array.size() > 1) {
+                    return std::unexpected("member '" + name + "' is an array of arrays");
+                }
+                if (!memberType.array.empty() && !memberType.array_size_literal[0]) {
+                    return std::unexpected("member '" + name + "' is sized by a specialization constant");
+                }
+
+                const SPIRType& elementType =
+                    memberType.array.empty() ? memberType : compiler.get_type(memberType.parent_type);
+                auto element = GetCppLayout(compiler, elementType);
+                if (!element) {
+                    return std::unexpected(element.error());
+                }
+
+                const uint64_t offset = AlignUp(layout.size, element->alignment);
+                const uint64_t declaredOffset = compiler.type_struct_member_offset(type, i);
+                if (declaredOffset != offset) {
+                    return std::unexpected("member '" + name + "' is at offset " + std::to_string(declaredOffset) +
+                                           " in the shader but " + std::to_string(offset) + " in C++");
+                }
+
+                if (elementType.columns > 1 && elementType.basetype != SPIRType::Struct) {
+                    const uint64_t columnSize = element->size / elementType.columns;
+                    const uint64_t matrixStride = compiler.type_struct_member_matrix_stride(type, i);
+                    if (matrixStride != columnSize) {
+                        return std::unexpected("member '" + name + "' has a matrix stride of " +
+                                               std::to_string(matrixStride) + " in the shader but " +
+                                               std::to_string(columnSize) + " in C++");
+                    }
+                }
+
+                uint64_t size = element->size;
+                if (!memberType.array.empty()) {
+                    const uint64_t arrayStride = compiler.type_struct_member_array_stride(type, i);
+                    if (arrayStride != element->size) {
+                        return std::unexpected("member '" + name + "' has an array stride of " +
+                                               std::to_string(arrayStride) + " in the shader but " +
+                                               std::to_string(element->size) + " in C++");
+                    }
+                    // Runtime arrays are declared with one element
+                    size *= std::max<uint64_t>(memberType.array[0], 1);
+                }
+
+                layout.size = offset + size;
+                layout.alignment = std::max(layout.alignment, element->alignment);
+            }
+            layout.size = AlignUp(layout.size, layout.alignment);
+            return layout;
+        }
+
+        switch (type.basetype) {
+            case SPIRType::Int:
+            case SPIRType::UInt:
+            case SPIRType::Float:
+            case SPIRType::Int64:
+            case SPIRType::UInt64:
+            case SPIRType::Double:
+                break;
+            default:
+                return std::unexpected(std::string("only 32- and 64-bit numbers, vectors and matrices are supported"));
+        }
+        const uint64_t scalarSize = type.width / 8;
+        return CppLayout{scalarSize * type.vecsize * type.columns, scalarSize};
+    }
+
+    /// Check that a block has the same layout in the shader and the generated C++
+    std::expected<void, Error>
+    CheckBlockLayout(const spirv_cross::Compiler& compiler, const spirv_cross::SPIRType& type,
+                     const std::string& blockName) {
+        auto layout = GetCppLayout(compiler, type);
+        if (!layout) {
+            return std::unexpected(Error{
+                Error::Code::UnsupportedFeature,
+                "Block '" + blockName + "' cannot run on the CPU: " + layout.error()
+            });
+        }
+        return {};
+    }
+
+    bool UsesBarrier(std::span<const uint32_t> spirv) {
+        // Instructions start after the five word header
+        for (size_t i = 5; i < spirv.size();) {
+            const uint32_t opcode = spirv[i] & 0xffff;
+            const uint32_t wordCount = spirv[i] >> 16;
+            if (opcode == spv::OpControlBarrier) {
+                return true;
+            }
+            i += std::max(wordCount, 1u);
+        }
+        return false;
+    }
+} // anonymous namespace
+
+// ============================================================================
+// Loaded Libraries
+// ============================================================================
+
+struct CpuComputeKernel::Library {
+    void* handle = nullptr;
+    const spirv_cross_interface* shader = nullptr;
+    decltype(&spirv_cross_set_resource) setResource = nullptr;
+    decltype(&spirv_cross_set_builtin) setBuiltin = nullptr;
+    bool serial = false;  // Built with the serial driver; SPIRV-Cross's threaded one otherwise
+
+    ~Library() {
+#ifndef _WIN32
+        if (handle) {
+            dlclose(handle);
+        }
+#endif
+    }
+};
+
+struct CpuComputeKernel::Instance {
+    const Library* library = nullptr;
+    spirv_cross_shader_t* shader = nullptr;
+    std::array<uint32_t, 3> workGroupId{};
+    std::array<uint32_t, 3> workGroupCount{};
+
+    ~Instance() {
+        if (shader) {
+            library->shader->destruct(shader);
+        }
+    }
+};
+
+// ============================================================================
+// Creation
+// ============================================================================
+
+CpuComputeKernel::~CpuComputeKernel() {
+    // Instances must go before the library holding their code
+    m_instances.clear();
+}
+
+std::expected<std::unique_ptr<CpuComputeKernel>, Error>
+CpuComputeKernel::Create(std::span<const uint32_t> spirv) {
+#ifdef _WIN32
+    return std::unexpected(Error{
+        Error::Code::UnsupportedFeature,
+        "CPU compute kernels are only built on POSIX hosts"
+    });
+#else
+    if (spirv.size() < 5) {
+        return std::unexpected(Error{Error::Code::InvalidConfig, "Compute shader has no SPIR-V"});
+    }
+
+    auto kernel = std::unique_ptr<CpuComputeKernel>(new CpuComputeKernel());
+    std::string source;
+
+    try {
+        spirv_cross::Parser parser(spirv.data(), spirv.size());
+        parser.parse();
+        spirv_cross::ParsedIR& ir = parser.get_parsed_ir();
+
+        // Move the push constant block to a uniform buffer slot
+        uint32_t pushConstantId = 0;
+        ir.for_each_typed_id<spirv_cross::SPIRVariable>([&](uint32_t id, spirv_cross::SPIRVariable& variable) {
+            if (variable.storage == spv::StorageClassPushConstant) {
+                variable.storage = spv::StorageClassUniform;
+                ir.set_decoration(id, spv::DecorationDescriptorSet, PushConstantSet);
+                ir.set_decoration(id, spv::DecorationBinding, PushConstantBinding);
+                pushConstantId = id;
+            }
+        });
+        ir.for_each_typed_id<spirv_cross::SPIRType>([](uint32_t, spirv_cross::SPIRType& type) {
+            if (type.storage == spv::StorageClassPushConstant) {
+                type.storage = spv::StorageClassUniform;
+            }
+        });
+
+        spirv_cross::CompilerCPP compiler(std::move(ir));
+        if (compiler.get_execution_model() != spv::ExecutionModelGLCompute) {
+            return std::unexpected(Error{Error::Code::InvalidConfig, "Shader is not a compute shader"});
+        }
+
+        uint32_t invocations = 1;
+        for (uint32_t i = 0; i < 3; ++i) {
+            kernel->m_workGroupSize[i] = compiler.get_execution_mode_argument(spv::ExecutionModeLocalSize, i);
+            invocations *= kernel->m_workGroupSize[i];
+        }
+        if (invocations == 0 || invocations > MaxInvocations) {
+            return std::unexpected(Error{
+                Error::Code::UnsupportedFeature,
+                "CPU compute kernels need between 1 and " + std::to_string(MaxInvocations) +
+                " invocations per workgroup"
+            });
+        }
+
+        const spirv_cross::ShaderResources resources = compiler.get_shader_resources();
+        if (!resources.sampled_images.empty() || !resources.separate_images.empty() ||
+            !resources.separate_samplers.empty() || !resources.storage_images.empty() ||
+            !resources.atomic_counters.empty() || !resources.acceleration_structures.empty()) {
+            return std::unexpected(Error{
+                Error::Code::UnsupportedFeature,
+                "CPU compute kernels can only access buffers, not images or samplers"
+            });
+        }
+
+        auto addBuffers = [&](const auto& buffers, bool storage) -> std::expected<void, Error> {
+            for (const spirv_cross::Resource& buffer : buffers) {
+                const spirv_cross::SPIRType& blockType = compiler.get_type(buffer.base_type_id);
+                auto checked = CheckBlockLayout(compiler, blockType, buffer.name);
+                if (!checked) {
+                    return checked;
+                }
+
+                if (buffer.id == pushConstantId) {
+                    kernel->m_pushConstantSize = static_cast<uint32_t>(compiler.get_declared_struct_size(blockType));
+                    if (kernel->m_pushConstantSize > MaxPushConstantSize) {
+                        return std::unexpected(Error{
+                            Error::Code::ValidationError,
+                            "Push constant block '" + buffer.name + "' is larger than " +
+                            std::to_string(MaxPushConstantSize) + " bytes"
+                        });
+                    }
+                    continue;
+                }
+
+                const uint32_t set = compiler.get_decoration(buffer.id, spv::DecorationDescriptorSet);
+                const uint32_t binding = compiler.get_decoration(buffer.id, spv::DecorationBinding);
+                if (set != 0 || binding >= MaxBindings) {
+                    return std::unexpected(Error{
+                        Error::Code::UnsupportedFeature,
+                        "Buffer '" + buffer.name + "' must be in set 0 at a binding below " +
+                        std::to_string(MaxBindings) + " to run on the CPU"
+                    });
+                }
+                if (!compiler.get_type(buffer.type_id).array.empty()) {
+                    return std::unexpected(Error{
+                        Error::Code::UnsupportedFeature,
+                        "Buffer '" + buffer.name + "' is an array of buffers, which CPU compute kernels do not support"
+                    });
+                }
+
+                Binding entry;
+                entry.binding = binding;
+                entry.storage = storage;
+                entry.writable = storage && !compiler.get_buffer_block_flags(buffer.id).get(spv::DecorationNonWritable);
+                entry.minSize = compiler.get_declared_struct_size(blockType);
+                kernel->m_bindings.push_back(entry);
+            }
+            return {};
+        };
+        if (auto added = addBuffers(resources.uniform_buffers, false); !added) {
+            return std::unexpected(added.error());
+        }
+        if (auto added = addBuffers(resources.storage_buffers, true); !added) {
+            return std::unexpected(added.error());
+        }
+        std::sort(kernel->m_bindings.begin(), kernel->m_bindings.end(),
+                  [](const Binding& a, const Binding& b) { return a.binding < b.binding; });
+
+        auto options = compiler.get_common_options();
+        options.vulkan_semantics = true;
+        compiler.set_common_options(options);
+        source = compiler.compile();
+    } catch (const spirv_cross::CompilerError& e) {
+        return std::unexpected(Error{
+            Error::Code::ShaderCompilationFailed,
+            std::string("SPIR-V to C++ conversion failed: ") + e.what()
+        });
+    }
+
+    // Barriers need every invocation of a workgroup running at once, which
+    // SPIRV-Cross's own driver does with a thread per invocation
+    const bool serial = !UsesBarrier(spirv);
+    if (serial) {
+        source = SerialDriverSource + source + SerialInterfaceSource(kernel->m_workGroupSize);
+    }
+
+    auto library = BuildLibrary(source, spirv, serial);
+    if (!library) {
+        return std::unexpected(library.error());
+    }
+    kernel->m_library = std::move(*library);
+    return kernel;
+#endif
+}
+
+// ============================================================================
+// Library Build and Cache
+// ============================================================================
+
+#ifndef _WIN32
+namespace {
+    /// The per-user cache: VRHI_CPU_COMPUTE_CACHE_DIR, $XDG_CACHE_HOME/vrhi or
+    /// ~/.cache/vrhi. Empty when the user has no home directory.
+    std::filesystem::path GetCacheDirectory() {
+        const std::string directory = GetEnvironment("VRHI_CPU_COMPUTE_CACHE_DIR");
+        if (!directory.empty()) {
+            return directory;
+        }
+        // Relative values are invalid per the XDG base directory spec
+        const std::string cacheHome = GetEnvironment("XDG_CACHE_HOME");
+        if (!cacheHome.empty() && cacheHome.front() == '/') {
+            return std::filesystem::path(cacheHome) / "vrhi";
+        }
+        const std::string home = GetEnvironment("HOME");
+        if (!home.empty()) {
+            return std::filesystem::path(home) / ".cache" / "vrhi";
+        }
+        return {};
+    }
+
+    /// Whether a cache entry can be trusted: not a symlink, owned by this
+    /// user and writable by nobody else, so no one else can plant a library
+    /// @return Why it cannot, or nullptr if it can
+    const char* CheckCacheEntry(const std::filesystem::path& path, bool directory) {
+        struct stat status{};
+        if (lstat(path.c_str(), &status) != 0) {
+            return "cannot be inspected";
+        }
+        if (directory ? !S_ISDIR(status.st_mode) : !S_ISREG(status.st_mode)) {
+            return directory ? "is not a directory" : "is not a regular file";
+        }
+        if (status.st_uid != geteuid()) {
+            return "is owned by another user";
+        }
+        if (status.st_mode & (S_IWGRP | S_IWOTH)) {
+            return "is writable by other users";
+        }
+        return nullptr;
+    }
+
+    /// Create the cache directory with mode 0700 if it is missing, and check
+    /// that it is private
+    std::expected<void, Error> PrepareCacheDirectory(const std::filesystem::path& directory) {
+        if (directory.empty()) {
+            return std::unexpected(Error{
+                Error::Code::InitializationFailed,
+                "No CPU compute kernel cache directory; set HOME or VRHI_CPU_COMPUTE_CACHE_DIR"
+            });
+        }
+        std::error_code error;
+        std::filesystem::create_directories(directory.parent_path(), error);
+        if (mkdir(directory.c_str(), S_IRWXU) != 0 && errno != EEXIST) {
+            return std::unexpected(Error{
+                Error::Code::InitializationFailed,
+                "Cannot create CPU compute kernel cache " + directory.string()
+            });
+        }
+        if (const char* reason = CheckCacheEntry(directory, true)) {
+            return std::unexpected(Error{
+                Error::Code::InitializationFailed,
+                "CPU compute kernel cache " + directory.string() + " " + reason
+            });
+        }
+        return {};
+    }
+
+    /// Split VRHI_CPU_COMPUTE_FLAGS at whitespace. No shell is involved, so
+    /// quotes and other shell syntax are passed to the compiler as they are.
+    std::vector<std::string> SplitFlags(const std::string& flags) {
+        std::vector<std::string> words;
+        std::istringstream stream(flags);
+        std::string word;
+        while (stream >> word) {
+            words.push_back(word);
+        }
+        return words;
+    }
+
+    /// Run the compiler without a shell, with stdout and stderr going to the log
+    /// @return Whether it ran and exited with status 0
+    bool RunCompiler(const std::vector<std::string>& arguments, const std::filesystem::path& logPath) {
+        // Everything the child needs is prepared before fork(), which leaves it
+        // only async-signal-safe calls to make
+        std::vector<char*> argv;
+        for (const std::string& argument : arguments) {
+            argv.push_back(const_cast<char*>(argument.c_str()));
+        }
+        argv.push_back(nullptr);
+        const int log = open(logPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+        if (log < 0) {
+            return false;
+        }
+
+        const pid_t child = fork();
+        if (child == 0) {
+            if (dup2(log, STDOUT_FILENO) < 0 || dup2(log, STDERR_FILENO) < 0) {
+                _exit(127);
+            }
+            execvp(argv[0], argv.data());
+            constexpr char message[] = "Cannot execute the compiler\n";
+            [[maybe_unused]] const ssize_t written = write(STDERR_FILENO, message, sizeof(message) - 1);
+            _exit(127);
+        }
+        close(log);
+        if (child < 0) {
+            return false;
+        }
+
+        int status = 0;
+        while (waitpid(child, &status, 0) < 0) {
+            if (errno != EINTR) {
+                return false;
+            }
+        }
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    std::string ReadLogTail(const std::filesystem::path& path) {
+        std::ifstream file(path);
+        std::stringstream stream;
+        stream << file.rdbuf();
+        std::string log = stream.str();
+        constexpr size_t MaxLogSize = 2048;
+        if (log.size() > MaxLogSize) {
+            log = "..." + log.substr(log.size() - MaxLogSize);
+        }
+        return log;
+    }
+} // anonymous namespace
+
+std::expected<std::shared_ptr<const CpuComputeKernel::Library>, Error>
+CpuComputeKernel::BuildLibrary(const std::string& source, std::span<const uint32_t> spirv, bool serial) {
+    // The compiler and include paths VRHI was built with, overridable at runtime
+    std::string compiler = GetEnvironment("VRHI_CPU_COMPUTE_CXX");
+    if (compiler.empty()) {
+        compiler = VRHI_CPU_COMPUTE_DEFAULT_CXX;
+    }
+    std::vector<std::string> arguments = {
+        compiler, "-std=c++17", "-O2", "-fPIC", "-shared", "-pthread", "-DNDEBUG", "-w",
+        std::string("-I") + VRHI_CPU_COMPUTE_SPIRV_CROSS_INCLUDE_DIR,
+    };
+#ifdef VRHI_CPU_COMPUTE_GLM_INCLUDE_DIR
+    arguments.push_back(std::string("-I") + VRHI_CPU_COMPUTE_GLM_INCLUDE_DIR);
+#endif
+    for (std::string& flag : SplitFlags(GetEnvironment("VRHI_CPU_COMPUTE_FLAGS"))) {
+        arguments.push_back(std::move(flag));
+    }
+
+    uint64_t hash = 0xcbf29ce484222325ull;
+    hash = Fnv1a(hash, &KernelFormat, sizeof(KernelFormat));
+    hash = Fnv1a(hash, spirv.data(), spirv.size_bytes());
+    for (const std::string& argument : arguments) {
+        // Hash the terminators too, so that differently split flags differ
+        hash = Fnv1a(hash, argument.c_str(), argument.size() + 1);
+    }
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+
+    const std::filesystem::path directory = GetCacheDirectory();
+    const std::filesystem::path libraryPath = directory / (std::string(name) + ".so");
+
+    // Libraries already loaded by this process are shared between kernels
+    static std::mutex cacheMutex;
+    static std::map<std::string, std::weak_ptr<const Library>> loaded;
+    std::lock_guard lock(cacheMutex);
+    if (auto library = loaded[name].lock()) {
+        return library;
+    }
+
+    if (auto prepared = PrepareCacheDirectory(directory); !prepared) {
+        return std::unexpected(prepared.error());
+    }
+
+    std::error_code error;
+    if (!std::filesystem::exists(libraryPath, error)) {
+        // Build in a fresh private directory and rename, so that other
+        // processes never load a half-written library
+        std::string buildTemplate = (directory / "build.XXXXXX").string();
+        if (!mkdtemp(buildTemplate.data())) {
+            return std::unexpected(Error{
+                Error::Code::InitializationFailed,
+                "Cannot create a build directory in " + directory.string()
+            });
+        }
+        const std::filesystem::path buildDirectory = buildTemplate;
+        const std::filesystem::path sourcePath = buildDirectory / "kernel.cpp";
+        const std::filesystem::path buildPath = buildDirectory / "kernel.so";
+        const std::filesystem::path logPath = buildDirectory / "kernel.log";
+        {
+            std::ofstream file(sourcePath, std::ios::binary);
+            file << source;
+            if (!file) {
+                std::filesystem::remove_all(buildDirectory, error);
+                return std::unexpected(Error{
+                    Error::Code::InitializationFailed,
+                    "Cannot write CPU compute kernel source to " + sourcePath.string()
+                });
+            }
+        }
+
+        LogInfo("Building CPU compute kernel %s", name);
+        arguments.insert(arguments.end(), {"-o", buildPath.string(), sourcePath.string()});
+        if (!RunCompiler(arguments, logPath)) {
+            const std::string log = ReadLogTail(logPath);
+            std::filesystem::remove_all(buildDirectory, error);
+            return std::unexpected(Error{
+                Error::Code::CompilationError,
+                "Building CPU compute kernel " + std::string(name) + " failed:\n" + log
+            });
+        }
+        // The linker honours the umask, which may leave the library group writable
+        chmod(buildPath.c_str(), S_IRWXU);
+        std::filesystem::rename(buildPath, libraryPath, error);
+        std::filesystem::remove_all(buildDirectory, error);
+    }
+
+    if (const char* reason = CheckCacheEntry(libraryPath, false)) {
+        return std::unexpected(Error{
+            Error::Code::InitializationFailed,
+            "Refusing to load CPU compute kernel " + libraryPath.string() + ": it " + reason
+        });
+    }
+
+    auto library = std::make_shared<Library>();
+    library->handle = dlopen(libraryPath.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!library->handle) {
+        const char* message = dlerror();
+        return std::unexpected(Error{
+            Error::Code::InitializationFailed,
+            "Cannot load CPU compute kernel: " + std::string(message ? message : libraryPath.string())
+        });
+    }
+
+    using GetInterface = const spirv_cross_interface* (*)();
+    auto getInterface = reinterpret_cast<GetInterface>(
+        dlsym(library->handle, serial ? "vrhi_serial_get_interface" : "spirv_cross_get_interface"));
+    library->setResource = reinterpret_cast<decltype(&spirv_cross_set_resource)>(
+        dlsym(library->handle, "spirv_cross_set_resource"));
+    library->setBuiltin = reinterpret_cast<decltype(&spirv_cross_set_builtin)>(
+        dlsym(library->handle, "spirv_cross_set_builtin"));
+    if (!getInterface || !library->setResource || !library->setBuiltin) {
+        return std::unexpected(Error{
+            Error::Code::InitializationFailed,
+            "CPU compute kernel " + libraryPath.string() + " lacks the shader interface"
+        });
+    }
+    library->shader = getInterface();
+    library->serial = serial;
+
+    loaded[name] = library;
+    return library;
+}
+#endif
+
+// ============================================================================
+// Dispatch
+// ============================================================================
+
+void CpuComputeKernel::Dispatch(ThreadPool& threads, std::span<void* const> buffers, const void* pushConstants,
+                                uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
+    const uint64_t groupCount = uint64_t(groupCountX) * groupCountY * groupCountZ;
+    if (groupCount == 0) {
+        return;
+    }
+
+    std::lock_guard lock(m_dispatchMutex);
+
+    // Shaders with barriers already run a thread per invocation, so their
+    // workgroups go one at a time through a single instance
+    const size_t instanceCount = m_library->serial ? threads.GetThreadCount() : 1;
+    while (m_instances.size() < instanceCount) {
+        auto instance = std::make_unique<Instance>();
+        instance->library = m_library.get();
+        instance->shader = m_library->shader->construct();
+        m_library->setBuiltin(instance->shader, SPIRV_CROSS_BUILTIN_WORK_GROUP_ID,
+                              instance->workGroupId.data(), sizeof(instance->workGroupId));
+        m_library->setBuiltin(instance->shader, SPIRV_CROSS_BUILTIN_NUM_WORK_GROUPS,
+                              instance->workGroupCount.data(), sizeof(instance->workGroupCount));
+        m_instances.push_back(std::move(instance));
+    }
+
+    for (size_t i = 0; i < instanceCount; ++i) {
+        Instance& instance = *m_instances[i];
+        instance.workGroupCount = {groupCountX, groupCountY, groupCountZ};
+        for (size_t b = 0; b < m_bindings.size(); ++b) {
+            void* data = buffers[b];
+            m_library->setResource(instance.shader, 0, m_bindings[b].binding, &data, sizeof(data));
+        }
+        if (m_pushConstantSize > 0) {
+            void* data = const_cast<void*>(pushConstants);
+            m_library->setResource(instance.shader, PushConstantSet, PushConstantBinding, &data, sizeof(data));
+        }
+    }
+
+    auto runGroup = [&](Instance& instance, uint64_t group) {
+        instance.workGroupId = {
+            static_cast<uint32_t>(group % groupCountX),
+            static_cast<uint32_t>(group / groupCountX % groupCountY),
+            static_cast<uint32_t>(group / (uint64_t(groupCountX) * groupCountY))
+        };
+        m_library->shader->invoke(instance.shader);
+    };
+
+    if (!m_library->serial) {
+        for (uint64_t group = 0; group < groupCount; ++group) {
+            runGroup(*m_instances[0], group);
+        }
+        return;
+    }
+
+    // ParallelFor counts in 32 bits
+    constexpr uint64_t MaxBatch = UINT32_MAX;
+    for (uint64_t first = 0; first < groupCount; first += MaxBatch) {
+        const auto count = static_cast<uint32_t>(std::min(MaxBatch, groupCount - first));
+        threads.ParallelFor(count, [&](uint32_t index, uint32_t thread) {
+            runGroup(*m_instances[thread], first + index);
+        });
+    }
+}
+
+} // namespace VRHI
@@ -0,0 +1,96 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/VRHI.hpp>
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace VRHI {
+
+class ThreadPool;
+
+/// A compute shader compiled to native code for the host CPU, for devices
+/// whose API has no compute shaders.
+///
+/// Create() cross-compiles the SPIR-V to C++ with SPIRV-Cross, builds that
+/// into a shared library with the host C++ compiler and loads it. Libraries
+/// are cached on disk by a hash of the SPIR-V and the compiler command, so a
+/// shader is built once per machine. The environment can override the build:
+///   - VRHI_CPU_COMPUTE_CXX: compiler (default: the one VRHI was built with)
+///   - VRHI_CPU_COMPUTE_FLAGS: extra flags, e.g. -march=native or -I<glm>
+///   - VRHI_CPU_COMPUTE_CACHE_DIR: cache (default: $XDG_CACHE_HOME/vrhi or
+///     ~/.cache/vrhi)
+/// The cache directory is created with mode 0700. Directories and libraries
+/// that are not owned by the user, or that others can write, are refused.
+/// The generated code includes GLM, which must be on the include path.
+///
+/// Shaders may use uniform and storage buffers of descriptor set 0 and a
+/// push constant block. Block layouts must equal the natural C++ layout of
+/// their members: std430 blocks without vec3 padding, std140 blocks made of
+/// 16-byte members. Other layouts, images and samplers are rejected.
+///
+/// Dispatch() spreads workgroups across a ThreadPool. Invocations of a
+/// workgroup run in a loop, except in shaders calling barrier(), where
+/// SPIRV-Cross gives every invocation its own thread.
+class CpuComputeKernel {
+public:
+    /// A buffer the shader accesses
+    struct Binding {
+        uint32_t binding = 0;
+        bool storage = false;   // Storage buffer; uniform buffer otherwise
+        bool writable = false;  // Storage buffer not declared readonly
+        uint64_t minSize = 0;   // Size of the block without its runtime array
+    };
+
+    /// Bindings available to shaders; the last SPIRV-Cross slot holds the push constants
+    static constexpr uint32_t MaxBindings = 15;
+
+    ~CpuComputeKernel();
+
+    CpuComputeKernel(const CpuComputeKernel&) = delete;
+    CpuComputeKernel& operator=(const CpuComputeKernel&) = delete;
+
+    /// Compile a compute shader, or load it from the cache
+    static std::expected<std::unique_ptr<CpuComputeKernel>, Error>
+    Create(std::span<const uint32_t> spirv);
+
+    std::span<const Binding> GetBindings() const noexcept { return m_bindings; }
+    uint32_t GetPushConstantSize() const noexcept { return m_pushConstantSize; }
+    const std::array<uint32_t, 3>& GetWorkGroupSize() const noexcept { return m_workGroupSize; }
+
+    /// Run a grid of workgroups; they have all finished on return
+    /// @param buffers Memory of every binding, in GetBindings() order
+    /// @param pushConstants At least GetPushConstantSize() bytes
+    void Dispatch(ThreadPool& threads, std::span<void* const> buffers, const void* pushConstants,
+                  uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ);
+
+private:
+    struct Library;
+    struct Instance;
+
+    CpuComputeKernel() = default;
+
+    /// Build the generated source into a library, or find it in the cache, and load it
+    static std::expected<std::shared_ptr<const Library>, Error>
+    BuildLibrary(const std::string& source, std::span<const uint32_t> spirv, bool serial);
+
+    std::shared_ptr<const Library> m_library;
+    std::vector<Binding> m_bindings;
+    uint32_t m_pushConstantSize = 0;
+    std::array<uint32_t, 3> m_workGroupSize{};
+
+    // One shader object per pool thread, created on first use. Instances
+    // hold the workgroup's shared memory and the bound resources.
+    std::vector<std::unique_ptr<Instance>> m_instances;
+    std::mutex m_dispatchMutex;
+};
+
+} // namespace VRHI
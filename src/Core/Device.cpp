@@ -5,6 +5,7 @@
 #include <VRHI/Backend.hpp>
 #include <VRHI/Logging.hpp>
 #include "BackendInit.hpp"
+#include "RecyclingCommandPool.hpp"
 #include <algorithm>
 
 namespace VRHI {
@@ -184,4 +185,12 @@ std::vector<BackendInfo> EnumerateBackends() {
     return backends;
 }
 
+// ============================================================================
+// Device Defaults
+// ============================================================================
+
+std::unique_ptr<CommandPool> Device::CreateCommandPool() {
+    return std::make_unique<RecyclingCommandPool>(*this);
+}
+
 } // namespace VRHI
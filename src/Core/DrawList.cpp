@@ -0,0 +1,276 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include <VRHI/DrawList.hpp>
+#include <VRHI/RecordingCommandBuffer.hpp>
+#include <algorithm>
+#include <barrier>
+#include <thread>
+
+namespace VRHI {
+
+namespace {
+
+using Histogram = std::array<uint32_t, 256>;
+
+constexpr uint32_t RadixPasses = 8;  // One per key byte
+
+/// Below this many draws per worker, threading costs more than it saves
+constexpr size_t MinDrawsPerThread = 16 * 1024;
+
+uint32_t Digit(uint64_t key, uint32_t pass) noexcept {
+    return static_cast<uint32_t>(key >> (pass * 8)) & 0xFF;
+}
+
+/// A pass is a no-op when every key has the same digit, which is common for
+/// the layer and pipeline bytes
+bool IsTrivialPass(const Histogram& histogram, size_t count) noexcept {
+    return std::ranges::any_of(histogram, [count](uint32_t n) { return n == count; });
+}
+
+template<typename Entry>
+void RadixSortSerial(std::vector<Entry>& entries, std::vector<Entry>& scratch) {
+    // The digit counts of all passes can be gathered in a single read
+    std::array<Histogram, RadixPasses> histograms{};
+    for (const Entry& entry : entries) {
+        for (uint32_t pass = 0; pass < RadixPasses; ++pass) {
+            ++histograms[pass][Digit(entry.key, pass)];
+        }
+    }
+
+    Entry* src = entries.data();
+    Entry* dst = scratch.data();
+    for (uint32_t pass = 0; pass < RadixPasses; ++pass) {
+        const Histogram& histogram = histograms[pass];
+        if (IsTrivialPass(histogram, entries.size())) {
+            continue;
+        }
+
+        Histogram offsets;
+        uint32_t sum = 0;
+        for (uint32_t digit = 0; digit < 256; ++digit) {
+            offsets[digit] = sum;
+            sum += histogram[digit];
+        }
+        for (size_t i = 0; i < entries.size(); ++i) {
+            dst[offsets[Digit(src[i].key, pass)]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+
+    if (src != entries.data()) {
+        entries.swap(scratch);
+    }
+}
+
+/// Every worker histograms and scatters its own slice of the entries; the
+/// digit offsets of each worker follow those of the workers before it, which
+/// keeps the sort stable.
+template<typename Entry>
+void RadixSortParallel(std::vector<Entry>& entries, std::vector<Entry>& scratch, uint32_t threadCount) {
+    const size_t count = entries.size();
+    std::vector<Histogram> histograms(threadCount);
+    std::vector<Histogram> offsets(threadCount);
+    Entry* src = entries.data();
+    Entry* dst = scratch.data();
+    bool skipPass = false;
+    bool scattered = false;
+
+    // Completion steps alternate: after the histograms compute the offsets,
+    // after the scatter swap the buffers
+    auto completion = [&]() noexcept {
+        if (!scattered) {
+            Histogram total{};
+            for (const Histogram& histogram : histograms) {
+                for (uint32_t digit = 0; digit < 256; ++digit) {
+                    total[digit] += histogram[digit];
+                }
+            }
+            skipPass = IsTrivialPass(total, count);
+
+            uint32_t sum = 0;
+            for (uint32_t digit = 0; digit < 256; ++digit) {
+                for (uint32_t thread = 0; thread < threadCount; ++thread) {
+                    offsets[thread][digit] = sum;
+                    sum += histograms[thread][digit];
+                }
+            }
+        } else if (!skipPass) {
+            std::swap(src, dst);
+        }
+        scattered = !scattered;
+    };
+    std::barrier sync(static_cast<std::ptrdiff_t>(threadCount), completion);
+
+    auto work = [&](uint32_t thread) {
+        const size_t begin = count * thread / threadCount;
+        const size_t end = count * (thread + 1) / threadCount;
+        for (uint32_t pass = 0; pass < RadixPasses; ++pass) {
+            Histogram& histogram = histograms[thread];
+            histogram.fill(0);
+            for (size_t i = begin; i < end; ++i) {
+                ++histogram[Digit(src[i].key, pass)];
+            }
+            sync.arrive_and_wait();
+
+            if (!skipPass) {
+                Histogram& offset = offsets[thread];
+                for (size_t i = begin; i < end; ++i) {
+                    dst[offset[Digit(src[i].key, pass)]++] = src[i];
+                }
+            }
+            sync.arrive_and_wait();
+        }
+    };
+
+    std::vector<std::jthread> workers;
+    workers.reserve(threadCount - 1);
+    for (uint32_t thread = 1; thread < threadCount; ++thread) {
+        workers.emplace_back(work, thread);
+    }
+    work(0);
+    workers.clear();
+
+    if (src != entries.data()) {
+        entries.swap(scratch);
+    }
+}
+
+/// Emit() for either recorder type; RecordingCommandBuffer's final calls inline
+template<typename Recorder, typename Entry>
+DrawListStats EmitDraws(Recorder& rec, const std::vector<DrawItem>& items, const std::vector<Entry>& order) {
+    DrawListStats stats;
+
+    // Bound state; null entries are unknown and never match a draw
+    Pipeline* pipeline = nullptr;
+    std::array<Buffer*, MaxDrawVertexBuffers> vertexBuffers{};
+    std::array<uint64_t, MaxDrawVertexBuffers> vertexOffsets{};
+    Buffer* indexBuffer = nullptr;
+    uint64_t indexOffset = 0;
+    bool use16BitIndices = false;
+    std::vector<DrawUniformBinding> uniformBuffers;  // Indexed by binding
+    std::vector<DrawTextureBinding> textures;        // Indexed by binding
+
+    for (const Entry& entry : order) {
+        const DrawItem& item = items[entry.index];
+
+        if (item.pipeline != pipeline) {
+            rec.BindPipeline(item.pipeline);
+            pipeline = item.pipeline;
+            ++stats.pipelineBinds;
+        }
+
+        // Rebind the range of vertex buffer slots that changed in one call
+        uint32_t firstChanged = item.vertexBufferCount;
+        uint32_t lastChanged = 0;
+        for (uint32_t slot = 0; slot < item.vertexBufferCount; ++slot) {
+            if (item.vertexBuffers[slot] != vertexBuffers[slot] ||
+                item.vertexOffsets[slot] != vertexOffsets[slot]) {
+                firstChanged = std::min(firstChanged, slot);
+                lastChanged = slot;
+            }
+        }
+        if (firstChanged < item.vertexBufferCount) {
+            const uint32_t changedCount = lastChanged - firstChanged + 1;
+            rec.BindVertexBuffers(firstChanged,
+                                  std::span(item.vertexBuffers).subspan(firstChanged, changedCount),
+                                  std::span(item.vertexOffsets).subspan(firstChanged, changedCount));
+            std::copy_n(item.vertexBuffers.begin() + firstChanged, changedCount, vertexBuffers.begin() + firstChanged);
+            std::copy_n(item.vertexOffsets.begin() + firstChanged, changedCount, vertexOffsets.begin() + firstChanged);
+            ++stats.vertexBufferBinds;
+        }
+
+        if (item.indexBuffer &&
+            (item.indexBuffer != indexBuffer || item.indexOffset != indexOffset ||
+             item.use16BitIndices != use16BitIndices)) {
+            rec.BindIndexBuffer(item.indexBuffer, item.indexOffset, item.use16BitIndices);
+            indexBuffer = item.indexBuffer;
+            indexOffset = item.indexOffset;
+            use16BitIndices = item.use16BitIndices;
+            ++stats.indexBufferBinds;
+        }
+
+        for (uint32_t i = 0; i < item.uniformBufferCount; ++i) {
+            const DrawUniformBinding& binding = item.uniformBuffers[i];
+            if (binding.binding >= uniformBuffers.size()) {
+                uniformBuffers.resize(binding.binding + 1);
+            }
+            DrawUniformBinding& bound = uniformBuffers[binding.binding];
+            if (binding.buffer != bound.buffer || binding.offset != bound.offset || binding.size != bound.size) {
+                rec.BindUniformBuffer(binding.binding, binding.buffer, binding.offset, binding.size);
+                bound = binding;
+                ++stats.uniformBufferBinds;
+            }
+        }
+
+        for (uint32_t i = 0; i < item.textureCount; ++i) {
+            const DrawTextureBinding& binding = item.textures[i];
+            if (binding.binding >= textures.size()) {
+                textures.resize(binding.binding + 1);
+            }
+            DrawTextureBinding& bound = textures[binding.binding];
+            if (binding.texture != bound.texture || binding.sampler != bound.sampler) {
+                rec.BindTexture(binding.binding, binding.texture, binding.sampler);
+                bound = binding;
+                ++stats.textureBinds;
+            }
+        }
+
+        if (item.indexBuffer) {
+            rec.DrawIndexed(item.indexed);
+        } else {
+            rec.Draw(item.vertices);
+        }
+        ++stats.drawCount;
+    }
+
+    return stats;
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// DrawList
+// ============================================================================
+
+void DrawList::Reserve(size_t count) {
+    m_items.reserve(count);
+    m_order.reserve(count);
+    m_scratch.reserve(count);
+}
+
+void DrawList::Clear() noexcept {
+    m_items.clear();
+    m_order.clear();
+}
+
+void DrawList::Add(uint64_t sortKey, const DrawItem& item) {
+    m_order.push_back({sortKey, m_items.size()});
+    m_items.push_back(item);
+}
+
+void DrawList::Sort(uint32_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const size_t maxThreads = std::max<size_t>(1, m_order.size() / MinDrawsPerThread);
+    threadCount = static_cast<uint32_t>(std::min<size_t>(threadCount, maxThreads));
+
+    m_scratch.resize(m_order.size());
+    if (threadCount == 1) {
+        RadixSortSerial(m_order, m_scratch);
+    } else {
+        RadixSortParallel(m_order, m_scratch, threadCount);
+    }
+}
+
+DrawListStats DrawList::Emit(CommandBuffer& cmd) const {
+    // Command buffers of VRHI devices are recorded without virtual calls;
+    // other implementations, such as test doubles, go through the interface
+    if (auto* recording = dynamic_cast<RecordingCommandBuffer*>(&cmd)) {
+        return EmitDraws(*recording, m_items, m_order);
+    }
+    return EmitDraws(cmd, m_items, m_order);
+}
+
+} // namespace VRHI
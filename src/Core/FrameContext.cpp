@@ -0,0 +1,107 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include <VRHI/FrameContext.hpp>
+#include <VRHI/Logging.hpp>
+#include <algorithm>
+
+namespace VRHI {
+
+// ============================================================================
+// FrameContext
+// ============================================================================
+
+FrameContext::FrameContext(Device& device, uint32_t index)
+    : m_device(&device)
+    , m_index(index)
+    , m_commandPool(device.CreateCommandPool())
+    // Created signaled so that the first use does not wait
+    , m_fence(device.CreateFence(true))
+{
+}
+
+FrameContext::~FrameContext() = default;
+
+TransientAllocator* FrameContext::GetTransientAllocator() noexcept {
+    return m_device->GetTransientAllocator();
+}
+
+void FrameContext::WaitForGpu() {
+    if (m_fence && !m_fence->Wait()) {
+        LogWarning("Waiting for frame %llu failed", static_cast<unsigned long long>(m_frameNumber));
+    }
+}
+
+void FrameContext::Recycle() {
+    // Callbacks may defer more work; it belongs to the next use of the context
+    auto deferred = std::move(m_deferred);
+    m_deferred.clear();
+    for (auto& callback : deferred) {
+        callback();
+    }
+    deferred.clear();
+    m_commandPool->Reset();
+}
+
+// ============================================================================
+// Device Frame Driving
+// ============================================================================
+
+Device::Device() = default;
+
+Device::~Device() = default;
+
+void Device::SetMaxFramesInFlight(uint32_t count) noexcept {
+    m_maxFramesInFlight = std::max(count, 1u);
+}
+
+FrameContext& Device::BeginFrame() {
+    if (m_currentFrame) {
+        LogWarning("BeginFrame called twice without EndFrame");
+        return *m_currentFrame;
+    }
+    if (m_frameContexts.empty()) {
+        for (uint32_t i = 0; i < m_maxFramesInFlight; ++i) {
+            m_frameContexts.push_back(std::unique_ptr<FrameContext>(new FrameContext(*this, i)));
+        }
+    }
+
+    // The context was last used m_maxFramesInFlight frames ago; this is the
+    // only place the CPU waits for the GPU
+    FrameContext& frame = *m_frameContexts[m_framesBegun % m_frameContexts.size()];
+    frame.WaitForGpu();
+    if (frame.m_fence) {
+        frame.m_fence->Reset();
+    }
+    frame.Recycle();
+
+    frame.m_frameNumber = m_framesBegun++;
+    m_currentFrame = &frame;
+    return frame;
+}
+
+void Device::EndFrame() {
+    if (!m_currentFrame) {
+        LogWarning("EndFrame called without BeginFrame");
+        return;
+    }
+    // An empty submission orders the fence after everything submitted this frame
+    Submit(static_cast<CommandBuffer*>(nullptr), m_currentFrame->m_fence.get());
+    m_currentFrame = nullptr;
+    Present();
+}
+
+void Device::ReleaseFrameContexts() {
+    // A frame that was begun but not ended still has to fence its submissions
+    if (m_currentFrame && m_currentFrame->m_fence) {
+        Submit(static_cast<CommandBuffer*>(nullptr), m_currentFrame->m_fence.get());
+    }
+    for (auto& frame : m_frameContexts) {
+        frame->WaitForGpu();
+        frame->Recycle();
+    }
+    m_frameContexts.clear();
+    m_currentFrame = nullptr;
+}
+
+} // namespace VRHI
@@ -29,6 +29,10 @@ NullDevice::NullDevice() {
     m_properties.maxThreadsPerGroup = 0;
 }
 
+NullDevice::~NullDevice() {
+    ReleaseFrameContexts();
+}
+
 BackendType NullDevice::GetBackendType() const noexcept {
     return BackendType::Auto;
 }
@@ -75,46 +79,46 @@ NullDevice::CreateSampler(const struct SamplerDesc& desc) {
 
 std::expected<std::unique_ptr<Shader>, Error>
 NullDevice::CreateShader(const struct ShaderDesc& desc) {
-    Error error{};
-    error.code = Error::Code::UnsupportedFeature;
-    error.message = "NullDevice: Shader creation not supported";
-    return std::unexpected(error);
+    return NullShader::Create(desc);
 }
 
 std::expected<std::unique_ptr<Pipeline>, Error>
 NullDevice::CreatePipeline(const struct PipelineDesc& desc) {
-    Error error{};
-    error.code = Error::Code::UnsupportedFeature;
-    error.message = "NullDevice: Pipeline creation not supported";
-    return std::unexpected(error);
+    return NullPipeline::Create(desc);
 }
 
 std::expected<std::unique_ptr<RenderPass>, Error>
 NullDevice::CreateRenderPass(const struct RenderPassDesc& desc) {
-    Error error{};
-    error.code = Error::Code::UnsupportedFeature;
-    error.message = "NullDevice: RenderPass creation not supported";
-    return std::unexpected(error);
+    return std::make_unique<NullRenderPass>();
 }
 
 std::expected<std::unique_ptr<Framebuffer>, Error>
 NullDevice::CreateFramebuffer(const struct FramebufferDesc& desc) {
-    Error error{};
-    error.code = Error::Code::UnsupportedFeature;
-    error.message = "NullDevice: Framebuffer creation not supported";
-    return std::unexpected(error);
+    return std::make_unique<NullFramebuffer>(desc);
 }
 
 // Command execution stubs
-std::unique_ptr<CommandBuffer> NullDevice::CreateCommandBuffer() {
-    return nullptr;
+std::unique_ptr<CommandBuffer> NullDevice::CreateCommandBuffer(CommandBufferLevel level) {
+    return std::make_unique<NullCommandBuffer>(level);
 }
 
-void NullDevice::Submit(std::unique_ptr<CommandBuffer> cmd) {
-    // Do nothing
+TransientAllocator* NullDevice::GetTransientAllocator() noexcept {
+    return &m_transientAllocator;
 }
 
-void NullDevice::Submit(std::span<std::unique_ptr<CommandBuffer>> cmds) {
+void NullDevice::Submit(std::unique_ptr<CommandBuffer> cmd, Fence* signalFence) {
+    Submit(cmd.get(), signalFence);
+}
+
+void NullDevice::Submit(CommandBuffer* cmd, Fence* signalFence) {
+    // Nothing to execute; only complete the state transition
+    m_transientAllocator.FlushWrites();
+    if (cmd) {
+        static_cast<NullCommandBuffer*>(cmd)->MarkSubmitted();
+    }
+}
+
+void NullDevice::Submit(std::span<std::unique_ptr<CommandBuffer>> cmds, Fence* signalFence) {
     // Do nothing
 }
 
@@ -141,7 +145,7 @@ SwapChain* NullDevice::GetSwapChain() noexcept {
 }
 
 void NullDevice::Present() {
-    // Do nothing
+    m_transientAllocator.EndFrame();
 }
 
 void NullDevice::Resize(uint32_t width, uint32_t height) {
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <VRHI/VRHI.hpp>
+#include "TransientRingAllocator.hpp"
 
 namespace VRHI {
 
@@ -12,7 +13,7 @@ namespace VRHI {
 class NullDevice : public Device {
 public:
     NullDevice();
-    ~NullDevice() override = default;
+    ~NullDevice() override;
     
     // Device Information
     BackendType GetBackendType() const noexcept override;
@@ -21,7 +22,7 @@ public:
     bool IsFeatureSupported(Feature feature) const noexcept override;
     const DeviceProperties& GetProperties() const noexcept override;
     
-    // Resource Creation (stubs)
+    // Resource Creation
     std::expected<std::unique_ptr<Buffer>, Error>
     CreateBuffer(const struct BufferDesc& desc) override;
     
@@ -44,9 +45,11 @@ public:
     CreateFramebuffer(const struct FramebufferDesc& desc) override;
     
     // Command Execution (stubs)
-    std::unique_ptr<CommandBuffer> CreateCommandBuffer() override;
-    void Submit(std::unique_ptr<CommandBuffer> cmd) override;
-    void Submit(std::span<std::unique_ptr<CommandBuffer>> cmds) override;
+    std::unique_ptr<CommandBuffer> CreateCommandBuffer(CommandBufferLevel level = CommandBufferLevel::Primary) override;
+    TransientAllocator* GetTransientAllocator() noexcept override;
+    void Submit(std::unique_ptr<CommandBuffer> cmd, Fence* signalFence = nullptr) override;
+    void Submit(CommandBuffer* cmd, Fence* signalFence = nullptr) override;
+    void Submit(std::span<std::unique_ptr<CommandBuffer>> cmds, Fence* signalFence = nullptr) override;
     void WaitIdle() override;
     
     // Synchronization (stubs)
@@ -62,6 +65,9 @@ public:
 private:
     FeatureSet m_features;
     DeviceProperties m_properties;
+    
+    // Plain memory; every frame retires at Present()
+    TransientRingAllocator m_transientAllocator{*this, m_features.memory.minUniformBufferAlignment};
 };
 
 } // namespace VRHI
@@ -2,6 +2,8 @@
 // SPDX-License-Identifier: MIT
 
 #include "NullResources.hpp"
+#include "BufferMapping.hpp"
+#include "BufferStreaming.hpp"
 #include <VRHI/Logging.hpp>
 #include <algorithm>
 
@@ -30,6 +32,10 @@ NullBuffer::Create(const BufferDesc& desc) {
             "Buffer size must be greater than 0"
         });
     }
+    // Memory is never shared with a GPU, so the policy is only validated
+    if (const char* error = ValidateStreaming(desc, ResolveStreaming(desc))) {
+        return std::unexpected(Error{Error::Code::InvalidConfig, error});
+    }
     
     try {
         auto buffer = std::unique_ptr<Buffer>(new NullBuffer(desc));
@@ -55,20 +61,38 @@ void* NullBuffer::Map() {
 }
 
 void* NullBuffer::Map(size_t offset, size_t size) {
+    return Map(offset, size, MapAccess::Read | MapAccess::Write);
+}
+
+void* NullBuffer::Map(size_t offset, size_t size, MapAccess access) {
     if (m_mappedPtr != nullptr) {
         LogWarning("NullBuffer: Buffer already mapped");
         return m_mappedPtr;
     }
     
-    if (offset + size > m_desc.size) {
-        LogError("NullBuffer: Map range out of bounds");
+    if (const char* error = ValidateMapRequest(m_desc.size, offset, size, access)) {
+        LogError("NullBuffer: %s", error);
         return nullptr;
     }
     
+    // CPU memory is always coherent, so the flags only need to be valid
     m_mappedPtr = m_data.data() + offset;
+    m_mapOffset = offset;
+    m_mapSize = size;
+    m_mapAccess = access;
     return m_mappedPtr;
 }
 
+void NullBuffer::FlushRange(size_t offset, size_t size) {
+    if (m_mappedPtr == nullptr) {
+        LogError("NullBuffer: FlushRange on a buffer that is not mapped");
+        return;
+    }
+    if (const char* error = ValidateFlushRange(m_mapOffset, m_mapSize, m_mapAccess, offset, size)) {
+        LogError("NullBuffer: %s", error);
+    }
+}
+
 void NullBuffer::Unmap() {
     if (m_mappedPtr == nullptr) {
         LogWarning("NullBuffer: Buffer not mapped");
@@ -302,4 +326,42 @@ NullSampler::Create(const SamplerDesc& desc) {
     }
 }
 
+// ============================================================================
+// NullShader / NullPipeline Implementation
+// ============================================================================
+
+NullShader::NullShader(const ShaderDesc& desc)
+    : m_stage(desc.stage)
+    , m_language(desc.language)
+    , m_entryPoint(desc.entryPoint ? desc.entryPoint : "main")
+{
+}
+
+std::expected<std::unique_ptr<Shader>, Error>
+NullShader::Create(const ShaderDesc& desc) {
+    if (desc.code == nullptr || desc.codeSize == 0) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Shader code cannot be empty"
+        });
+    }
+    
+    return std::unique_ptr<Shader>(new NullShader(desc));
+}
+
+std::expected<std::unique_ptr<Pipeline>, Error>
+NullPipeline::Create(const PipelineDesc& desc) {
+    const bool hasShader = desc.type == PipelineType::Compute
+        ? desc.compute.computeShader != nullptr
+        : desc.graphics.vertexShader != nullptr;
+    if (!hasShader) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Pipeline is missing its required shader stage"
+        });
+    }
+    
+    return std::unique_ptr<Pipeline>(new NullPipeline(desc.type));
+}
+
 } // namespace VRHI
@@ -3,10 +3,15 @@
 
 #pragma once
 
+#include <VRHI/RecordingCommandBuffer.hpp>
+#include <VRHI/Pipeline.hpp>
+#include <VRHI/RenderPass.hpp>
 #include <VRHI/Resources.hpp>
+#include <VRHI/Shader.hpp>
 #include <VRHI/VRHI.hpp>
 #include <cstring>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace VRHI {
@@ -30,6 +35,8 @@ public:
     
     void* Map() override;
     void* Map(size_t offset, size_t size) override;
+    void* Map(size_t offset, size_t size, MapAccess access) override;
+    void FlushRange(size_t offset, size_t size) override;
     void Unmap() override;
     
     void Update(const void* data, size_t size, size_t offset = 0) override;
@@ -41,6 +48,9 @@ private:
     BufferDesc m_desc;
     std::vector<uint8_t> m_data;  // CPU-side storage
     void* m_mappedPtr = nullptr;
+    size_t m_mapOffset = 0;
+    size_t m_mapSize = 0;
+    MapAccess m_mapAccess = MapAccess::Read;
 };
 
 // ============================================================================
@@ -104,4 +114,81 @@ private:
     SamplerDesc m_desc;
 };
 
+// ============================================================================
+// NullShader, NullPipeline, NullRenderPass, NullFramebuffer
+// ============================================================================
+
+/// Null shader - keeps the descriptor metadata, compiles nothing
+class NullShader : public Shader {
+public:
+    ~NullShader() override = default;
+    
+    static std::expected<std::unique_ptr<Shader>, Error>
+    Create(const ShaderDesc& desc);
+    
+    ShaderStage GetStage() const noexcept override { return m_stage; }
+    ShaderLanguage GetLanguage() const noexcept override { return m_language; }
+    std::string_view GetEntryPoint() const noexcept override { return m_entryPoint; }
+    
+private:
+    NullShader(const ShaderDesc& desc);
+    
+    ShaderStage m_stage;
+    ShaderLanguage m_language;
+    std::string m_entryPoint;
+};
+
+/// Null pipeline
+class NullPipeline : public Pipeline {
+public:
+    ~NullPipeline() override = default;
+    
+    static std::expected<std::unique_ptr<Pipeline>, Error>
+    Create(const PipelineDesc& desc);
+    
+    PipelineType GetType() const noexcept override { return m_type; }
+    
+private:
+    explicit NullPipeline(PipelineType type) : m_type(type) {}
+    
+    PipelineType m_type;
+};
+
+/// Null render pass
+class NullRenderPass : public RenderPass {
+public:
+    NullRenderPass() = default;
+    ~NullRenderPass() override = default;
+};
+
+/// Null framebuffer
+class NullFramebuffer : public Framebuffer {
+public:
+    explicit NullFramebuffer(const FramebufferDesc& desc)
+        : m_width(desc.width), m_height(desc.height), m_layers(desc.layers) {}
+    ~NullFramebuffer() override = default;
+    
+    uint32_t GetWidth() const noexcept override { return m_width; }
+    uint32_t GetHeight() const noexcept override { return m_height; }
+    uint32_t GetLayers() const noexcept override { return m_layers; }
+    
+private:
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_layers;
+};
+
+// ============================================================================
+// NullCommandBuffer
+// ============================================================================
+
+/// Null command buffer - records commands and discards them on submit
+class NullCommandBuffer : public RecordingCommandBuffer {
+public:
+    explicit NullCommandBuffer(CommandBufferLevel level) : RecordingCommandBuffer(level) {}
+    ~NullCommandBuffer() override = default;
+    
+    using RecordingCommandBuffer::MarkSubmitted;
+};
+
 } // namespace VRHI
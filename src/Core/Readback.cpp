@@ -0,0 +1,240 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include <VRHI/Readback.hpp>
+#include <VRHI/CommandBuffer.hpp>
+#include <VRHI/Logging.hpp>
+#include <algorithm>
+
+namespace VRHI {
+
+namespace {
+
+/// Free staging buffers kept for reuse; more are released
+constexpr size_t MaxFreeBuffers = 8;
+
+/// Bytes of a block of texels: one texel, or a 4x4 block of compressed ones
+uint32_t GetBlockSize(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::R8_UNorm: return 1;
+        case TextureFormat::RG8_UNorm:
+        case TextureFormat::R16_Float:
+        case TextureFormat::Depth16: return 2;
+        case TextureFormat::RGBA8_UNorm:
+        case TextureFormat::RGBA8_SRGB:
+        case TextureFormat::RG16_Float:
+        case TextureFormat::R32_Float:
+        case TextureFormat::R32_UInt:
+        case TextureFormat::Depth24Stencil8:
+        case TextureFormat::Depth32F: return 4;
+        case TextureFormat::RGBA16_Float:
+        case TextureFormat::RG32_Float:
+        case TextureFormat::RG32_UInt:
+        case TextureFormat::Depth32FStencil8:
+        case TextureFormat::BC1_UNorm:
+        case TextureFormat::ETC2_RGB8: return 8;
+        case TextureFormat::RGB32_Float:
+        case TextureFormat::RGB32_UInt: return 12;
+        case TextureFormat::RGBA32_Float:
+        case TextureFormat::RGBA32_UInt:
+        case TextureFormat::BC3_UNorm:
+        case TextureFormat::BC7_UNorm:
+        case TextureFormat::ASTC_4x4: return 16;
+        default: return 0;
+    }
+}
+
+bool IsBlockCompressed(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::BC1_UNorm:
+        case TextureFormat::BC3_UNorm:
+        case TextureFormat::BC7_UNorm:
+        case TextureFormat::ETC2_RGB8:
+        case TextureFormat::ASTC_4x4:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/// Tightly packed size of one layer of a mip level
+uint64_t GetLevelSize(const Texture& texture, uint32_t mipLevel) {
+    uint64_t width = std::max(texture.GetWidth() >> mipLevel, 1u);
+    uint64_t height = texture.GetType() == TextureType::Texture1D || texture.GetType() == TextureType::Texture1DArray
+        ? 1 : std::max(texture.GetHeight() >> mipLevel, 1u);
+    const uint64_t depth = texture.GetType() == TextureType::Texture3D ? std::max(texture.GetDepth() >> mipLevel, 1u) : 1;
+    if (IsBlockCompressed(texture.GetFormat())) {
+        width = (width + 3) / 4;
+        height = (height + 3) / 4;
+    }
+    return width * height * depth * GetBlockSize(texture.GetFormat());
+}
+
+} // anonymous namespace
+
+/// Readbacks submitted together and the fence that completes them. Devices
+/// without fences execute submissions before Submit() returns.
+struct ReadbackBatch {
+    std::unique_ptr<Fence> fence;
+    bool submitted = false;
+
+    bool IsComplete() const {
+        return submitted && (!fence || fence->IsSignaled());
+    }
+};
+
+struct ReadbackRequest {
+    std::unique_ptr<Buffer> staging;
+    uint64_t size = 0;
+    std::shared_ptr<ReadbackBatch> batch;
+};
+
+// ============================================================================
+// ReadbackTicket
+// ============================================================================
+
+uint64_t ReadbackTicket::GetSize() const noexcept {
+    return m_request ? m_request->size : 0;
+}
+
+bool ReadbackTicket::IsReady() const {
+    return m_request && m_request->batch->IsComplete();
+}
+
+bool ReadbackTicket::Wait(uint64_t timeout) const {
+    if (!m_request || !m_request->batch->submitted) {
+        return false;
+    }
+    const auto& fence = m_request->batch->fence;
+    return !fence || fence->Wait(timeout);
+}
+
+bool ReadbackTicket::Read(void* data, size_t size) const {
+    if (!Wait()) {
+        return false;
+    }
+    m_request->staging->Read(data, static_cast<size_t>(std::min<uint64_t>(size, m_request->size)));
+    return true;
+}
+
+// ============================================================================
+// ReadbackQueue
+// ============================================================================
+
+ReadbackQueue::ReadbackQueue(Device& device)
+    : m_device(&device)
+{
+}
+
+ReadbackQueue::~ReadbackQueue() = default;
+
+std::expected<ReadbackTicket, Error>
+ReadbackQueue::ReadTexture(CommandBuffer& cmd, Texture& texture, uint32_t mipLevel, uint32_t arrayLayer) {
+    const uint32_t layers = texture.GetArrayLayers() *
+        (texture.GetType() == TextureType::TextureCube || texture.GetType() == TextureType::TextureCubeArray ? 6 : 1);
+    if (mipLevel >= texture.GetMipLevels() || arrayLayer >= layers) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Readback mip level or array layer out of range"
+        });
+    }
+    const uint64_t size = GetLevelSize(texture, mipLevel);
+    if (size == 0) {
+        return std::unexpected(Error{
+            Error::Code::UnsupportedFeature,
+            "Texture format cannot be read back"
+        });
+    }
+
+    auto ticket = CreateRequest(size);
+    if (ticket) {
+        cmd.CopyTextureToBuffer(&texture, ticket->m_request->staging.get(), mipLevel, arrayLayer);
+    }
+    return ticket;
+}
+
+std::expected<ReadbackTicket, Error>
+ReadbackQueue::ReadBuffer(CommandBuffer& cmd, Buffer& buffer, uint64_t offset, uint64_t size) {
+    if (size == 0 || offset > buffer.GetSize() || size > buffer.GetSize() - offset) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Readback range out of bounds"
+        });
+    }
+
+    auto ticket = CreateRequest(size);
+    if (ticket) {
+        cmd.CopyBuffer(&buffer, ticket->m_request->staging.get(), offset, 0, size);
+    }
+    return ticket;
+}
+
+void ReadbackQueue::Submit(CommandBuffer& cmd) {
+    Fence* fence = nullptr;
+    if (m_pending) {
+        m_pending->fence = m_device->CreateFence(false);
+        fence = m_pending->fence.get();
+    }
+    m_device->Submit(&cmd, fence);
+    if (m_pending) {
+        m_pending->submitted = true;
+        m_pending.reset();
+    }
+}
+
+size_t ReadbackQueue::GetStagingBufferCount() const noexcept {
+    return m_requests.size() + m_freeBuffers.size();
+}
+
+std::expected<ReadbackTicket, Error> ReadbackQueue::CreateRequest(uint64_t size) {
+    Recycle();
+
+    auto request = std::make_shared<ReadbackRequest>();
+    request->size = size;
+
+    // The smallest free buffer that fits
+    auto best = m_freeBuffers.end();
+    for (auto it = m_freeBuffers.begin(); it != m_freeBuffers.end(); ++it) {
+        if ((*it)->GetSize() >= size && (best == m_freeBuffers.end() || (*it)->GetSize() < (*best)->GetSize())) {
+            best = it;
+        }
+    }
+    if (best != m_freeBuffers.end()) {
+        request->staging = std::move(*best);
+        m_freeBuffers.erase(best);
+    } else {
+        BufferDesc desc{};
+        desc.size = static_cast<size_t>(size);
+        desc.usage = BufferUsage::TransferDst;
+        desc.memoryAccess = MemoryAccess::GpuToCpu;
+        desc.debugName = "VRHI readback";
+        auto buffer = m_device->CreateBuffer(desc);
+        if (!buffer) {
+            return std::unexpected(buffer.error());
+        }
+        request->staging = std::move(*buffer);
+    }
+
+    if (!m_pending) {
+        m_pending = std::make_shared<ReadbackBatch>();
+    }
+    request->batch = m_pending;
+    m_requests.push_back(request);
+    return ReadbackTicket(std::move(request));
+}
+
+void ReadbackQueue::Recycle() {
+    // A request whose only owner is the queue has no ticket left; its buffer
+    // is free once the GPU has written it
+    std::erase_if(m_requests, [this](std::shared_ptr<ReadbackRequest>& request) {
+        if (request.use_count() > 1 || !request->batch->IsComplete()) {
+            return false;
+        }
+        if (m_freeBuffers.size() < MaxFreeBuffers) {
+            m_freeBuffers.push_back(std::move(request->staging));
+        }
+        return true;
+    });
+}
+
+} // namespace VRHI
@@ -0,0 +1,106 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include <VRHI/RecordingCommandBuffer.hpp>
+#include <VRHI/Logging.hpp>
+#include <cstring>
+
+namespace VRHI {
+
+namespace {
+    template<typename T>
+    void CopyTrailing(T& cmd, const void* data, size_t size) {
+        if (size > 0) {
+            std::memcpy(CommandStream::GetTrailingData<std::byte>(cmd), data, size);
+        }
+    }
+
+    void FillDebugMarker(CmdDebugMarker& cmd, const char* name, size_t nameLength, const float color[4]) {
+        cmd.hasColor = color != nullptr;
+        for (int i = 0; i < 4; ++i) {
+            cmd.color[i] = color ? color[i] : 1.0f;
+        }
+        char* dst = CommandStream::GetTrailingData<char>(cmd);
+        if (nameLength > 0) {
+            std::memcpy(dst, name, nameLength);
+        }
+        dst[nameLength] = '\0';
+    }
+} // anonymous namespace
+
+// ============================================================================
+// Lifecycle
+// ============================================================================
+
+void RecordingCommandBuffer::Begin() {
+    // Beginning an executable or submitted buffer implicitly resets it
+    m_stream.Reset();
+    m_state = CommandBufferState::Recording;
+}
+
+void RecordingCommandBuffer::End() {
+    if (m_state != CommandBufferState::Recording) {
+        LogWarning("CommandBuffer::End called while not recording");
+        return;
+    }
+    m_state = CommandBufferState::Executable;
+}
+
+void RecordingCommandBuffer::Reset() {
+    m_stream.Reset();
+    m_state = CommandBufferState::Initial;
+}
+
+CommandBufferState RecordingCommandBuffer::GetState() const noexcept {
+    return m_state;
+}
+
+void RecordingCommandBuffer::WarnNotRecording() const {
+    LogWarning("Command recorded into a command buffer that is not in the recording state");
+}
+
+void RecordingCommandBuffer::WarnPushConstantRange(uint32_t offset, size_t size) const {
+    LogWarning("PushConstants range [%u, %zu) exceeds the %u byte push constant block; command dropped",
+               offset, offset + size, MaxPushConstantSize);
+}
+
+// ============================================================================
+// Secondary Command Buffers
+// ============================================================================
+
+void RecordingCommandBuffer::ExecuteCommands(std::span<CommandBuffer* const> secondaries) {
+    if (m_level != CommandBufferLevel::Primary) {
+        LogWarning("ExecuteCommands can only be recorded into a primary command buffer");
+        return;
+    }
+    for (CommandBuffer* secondary : secondaries) {
+        if (!secondary || secondary->GetLevel() != CommandBufferLevel::Secondary) {
+            LogWarning("ExecuteCommands requires secondary command buffers");
+            return;
+        }
+        if (secondary->GetState() == CommandBufferState::Recording) {
+            LogWarning("ExecuteCommands called with a secondary command buffer that is still recording");
+        }
+    }
+
+    const size_t count = secondaries.size();
+    auto& cmd = Record<CmdExecuteCommands>(count * sizeof(CommandBuffer*));
+    cmd.count = static_cast<uint32_t>(count);
+    CopyTrailing(cmd, secondaries.data(), count * sizeof(CommandBuffer*));
+}
+
+// ============================================================================
+// Debug Markers
+// ============================================================================
+
+void RecordingCommandBuffer::BeginDebugMarker(const char* name, const float color[4]) {
+    const size_t length = name ? std::strlen(name) : 0;
+    FillDebugMarker(Record<CmdBeginDebugMarker>(length + 1), name, length, color);
+}
+
+void RecordingCommandBuffer::InsertDebugMarker(const char* name, const float color[4]) {
+    const size_t length = name ? std::strlen(name) : 0;
+    FillDebugMarker(Record<CmdInsertDebugMarker>(length + 1), name, length, color);
+}
+
+} // namespace VRHI
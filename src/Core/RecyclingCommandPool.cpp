@@ -0,0 +1,50 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "RecyclingCommandPool.hpp"
+
+namespace VRHI {
+
+RecyclingCommandPool::RecyclingCommandPool(Device& device)
+    : m_device(&device)
+{
+}
+
+CommandBuffer* RecyclingCommandPool::Allocate(CommandBufferLevel level) {
+    Bucket& bucket = m_buckets[static_cast<size_t>(level)];
+    if (bucket.allocated == bucket.buffers.size()) {
+        auto cmd = m_device->CreateCommandBuffer(level);
+        if (!cmd) {
+            return nullptr;
+        }
+        bucket.buffers.push_back(std::move(cmd));
+    }
+    return bucket.buffers[bucket.allocated++].get();
+}
+
+void RecyclingCommandPool::Reset() {
+    for (Bucket& bucket : m_buckets) {
+        for (size_t i = 0; i < bucket.allocated; ++i) {
+            bucket.buffers[i]->Reset();
+        }
+        bucket.allocated = 0;
+    }
+}
+
+uint32_t RecyclingCommandPool::GetAllocatedCount() const noexcept {
+    size_t count = 0;
+    for (const Bucket& bucket : m_buckets) {
+        count += bucket.allocated;
+    }
+    return static_cast<uint32_t>(count);
+}
+
+uint32_t RecyclingCommandPool::GetCapacity() const noexcept {
+    size_t count = 0;
+    for (const Bucket& bucket : m_buckets) {
+        count += bucket.buffers.size();
+    }
+    return static_cast<uint32_t>(count);
+}
+
+} // namespace VRHI
@@ -0,0 +1,41 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/CommandPool.hpp>
+#include <VRHI/CommandBuffer.hpp>
+#include <VRHI/VRHI.hpp>
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace VRHI {
+
+/// Command pool built on Device::CreateCommandBuffer().
+///
+/// New buffers are only created when every pooled buffer is in use; Reset()
+/// calls CommandBuffer::Reset() on the used ones, which keeps their recording
+/// memory. Used by every device that has no native pool.
+class RecyclingCommandPool final : public CommandPool {
+public:
+    explicit RecyclingCommandPool(Device& device);
+    ~RecyclingCommandPool() override = default;
+
+    CommandBuffer* Allocate(CommandBufferLevel level = CommandBufferLevel::Primary) override;
+    void Reset() override;
+    uint32_t GetAllocatedCount() const noexcept override;
+    uint32_t GetCapacity() const noexcept override;
+
+private:
+    /// Buffers of one level; the first `allocated` are handed out
+    struct Bucket {
+        std::vector<std::unique_ptr<CommandBuffer>> buffers;
+        size_t allocated = 0;
+    };
+
+    Device* m_device;
+    std::array<Bucket, 2> m_buckets;  // Indexed by CommandBufferLevel
+};
+
+} // namespace VRHI
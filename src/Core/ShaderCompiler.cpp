@@ -203,9 +203,16 @@ ShaderCompiler::ConvertSPIRVToGLSL(
         options.version = targetVersion;
         options.es = false; // Desktop GLSL
         options.enable_420pack_extension = (targetVersion >= 420);
+        options.emit_push_constant_as_uniform_buffer = true;
         
         compiler.set_common_options(options);
         
+        // Give the push constant block a name the backend can look up
+        for (const auto& block : compiler.get_shader_resources().push_constant_buffers) {
+            compiler.set_name(block.base_type_id, PushConstantBlockName);
+            compiler.set_decoration(block.id, spv::DecorationBinding, PushConstantBinding);
+        }
+        
         // Compile SPIR-V to GLSL
         std::string glslSource = compiler.compile();
         
@@ -252,6 +259,35 @@ ShaderCompiler::ReflectSPIRV(std::span<const uint32_t> spirv) {
             reflection.samplers.push_back(sampler.name);
         }
         
+        // Reflect descriptor bindings
+        auto addBindings = [&](const spirv_cross::SmallVector<spirv_cross::Resource>& list, ShaderResourceType type) {
+            for (const auto& resource : list) {
+                const auto& resourceType = compiler.get_type(resource.type_id);
+                ShaderResourceBinding binding{};
+                binding.name = resource.name;
+                binding.type = type;
+                binding.set = compiler.get_decoration(resource.id, spv::DecorationDescriptorSet);
+                binding.binding = compiler.get_decoration(resource.id, spv::DecorationBinding);
+                binding.count = 1;
+                for (uint32_t size : resourceType.array) {
+                    binding.count *= size;
+                }
+                reflection.bindings.push_back(std::move(binding));
+            }
+        };
+        addBindings(resources.uniform_buffers, ShaderResourceType::UniformBuffer);
+        addBindings(resources.storage_buffers, ShaderResourceType::StorageBuffer);
+        addBindings(resources.sampled_images, ShaderResourceType::SampledTexture);
+        addBindings(resources.storage_images, ShaderResourceType::StorageTexture);
+        addBindings(resources.separate_images, ShaderResourceType::SeparateTexture);
+        addBindings(resources.separate_samplers, ShaderResourceType::SeparateSampler);
+        
+        // Reflect push constants
+        for (const auto& block : resources.push_constant_buffers) {
+            const auto& type = compiler.get_type(block.base_type_id);
+            reflection.pushConstantSize = static_cast<uint32_t>(compiler.get_declared_struct_size(type));
+        }
+        
         LogInfo("Reflected shader: %zu inputs, %zu outputs, %zu UBOs, %zu samplers",
                 reflection.inputs.size(), reflection.outputs.size(),
                 reflection.uniformBuffers.size(), reflection.samplers.size());
@@ -0,0 +1,91 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+namespace VRHI {
+
+ThreadPool::ThreadPool(uint32_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    m_workers.reserve(threadCount - 1);
+    for (uint32_t thread = 1; thread < threadCount; ++thread) {
+        m_workers.emplace_back(&ThreadPool::WorkerMain, this, thread);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::ParallelFor(uint32_t count,
+                                     const std::function<void(uint32_t index, uint32_t thread)>& function) {
+    if (count == 0) {
+        return;
+    }
+    if (count == 1 || m_workers.empty()) {
+        for (uint32_t index = 0; index < count; ++index) {
+            function(index, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_function = &function;
+        m_count = count;
+        m_next.store(0, std::memory_order_relaxed);
+        m_busyWorkers = static_cast<uint32_t>(m_workers.size());
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    Work(0);
+
+    // Workers may still be finishing their last index
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_busyWorkers == 0; });
+    m_function = nullptr;
+}
+
+void ThreadPool::WorkerMain(uint32_t thread) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+            if (m_stop) {
+                return;
+            }
+            seen = m_generation;
+        }
+
+        Work(thread);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_busyWorkers == 0) {
+            m_done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::Work(uint32_t thread) {
+    for (;;) {
+        const uint32_t index = m_next.fetch_add(1, std::memory_order_relaxed);
+        if (index >= m_count) {
+            return;
+        }
+        (*m_function)(index, thread);
+    }
+}
+
+} // namespace VRHI
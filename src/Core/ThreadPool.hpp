@@ -0,0 +1,58 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace VRHI {
+
+/// Worker threads for work the library does on the CPU: rendering on the
+/// software device and compute kernels compiled for the host.
+///
+/// ParallelFor() hands out indices from an atomic counter to the workers and
+/// the calling thread, which takes part as thread 0, and returns once every
+/// index has been processed. Callers index per-thread scratch memory with the
+/// thread number, so work items never share it.
+class ThreadPool {
+public:
+    /// @param threadCount Threads taking part in ParallelFor(), the caller
+    ///                    included; 0 uses one per hardware thread
+    explicit ThreadPool(uint32_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    uint32_t GetThreadCount() const noexcept { return static_cast<uint32_t>(m_workers.size()) + 1; }
+
+    /// Call `function(index, thread)` for every index in [0, count)
+    void ParallelFor(uint32_t count, const std::function<void(uint32_t index, uint32_t thread)>& function);
+
+private:
+    void WorkerMain(uint32_t thread);
+
+    /// Process indices of the current job until none are left
+    void Work(uint32_t thread);
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    uint64_t m_generation = 0;  // Incremented for every job
+    uint32_t m_busyWorkers = 0;
+    bool m_stop = false;
+
+    const std::function<void(uint32_t, uint32_t)>* m_function = nullptr;
+    uint32_t m_count = 0;
+    std::atomic<uint32_t> m_next{0};
+};
+
+} // namespace VRHI
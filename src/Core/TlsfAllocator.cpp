@@ -0,0 +1,215 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "TlsfAllocator.hpp"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace VRHI {
+
+TlsfAllocator::TlsfAllocator(uint64_t size, uint64_t granularity)
+    : m_size(size)
+    , m_granularity(std::max<uint64_t>(granularity, 1))
+{
+    assert(std::has_single_bit(m_granularity) && "Granularity must be a power of two");
+    for (auto& lists : m_freeLists) {
+        lists.fill(NoNode);
+    }
+
+    const uint64_t granules = m_size / m_granularity;
+    if (granules > 0) {
+        const uint32_t node = NewNode();
+        m_nodes[node].size = granules;
+        m_nodes[node].free = true;
+        InsertFree(node);
+    }
+}
+
+uint64_t TlsfAllocator::Allocate(uint64_t size, uint64_t alignment) {
+    if (size == 0) {
+        return InvalidOffset;
+    }
+    assert((alignment == 0 || std::has_single_bit(alignment)) && "Alignment must be a power of two");
+
+    const uint64_t granules = (size + m_granularity - 1) / m_granularity;
+    const uint64_t align = std::max<uint64_t>(alignment, m_granularity) / m_granularity;
+
+    // Any free range this large holds an aligned range of `granules`
+    uint32_t node = FindFree(granules + align - 1);
+    if (node == NoNode) {
+        return InvalidOffset;
+    }
+    RemoveFree(node);
+
+    // Give the padding in front of the aligned offset back as a free range
+    const uint64_t padding = (align - m_nodes[node].offset % align) % align;
+    if (padding > 0) {
+        SplitTail(node, padding);
+        const uint32_t aligned = m_nodes[node].nextPhysical;
+        RemoveFree(aligned);
+        InsertFree(node);
+        node = aligned;
+    }
+    if (m_nodes[node].size > granules) {
+        SplitTail(node, granules);
+    }
+
+    Node& allocated = m_nodes[node];
+    allocated.free = false;
+    m_allocated.emplace(allocated.offset, node);
+    m_usedBytes += allocated.size * m_granularity;
+    return allocated.offset * m_granularity;
+}
+
+void TlsfAllocator::Free(uint64_t offset) {
+    auto it = m_allocated.find(offset / m_granularity);
+    if (it == m_allocated.end()) {
+        assert(false && "Offset was not returned by Allocate()");
+        return;
+    }
+    uint32_t node = it->second;
+    m_allocated.erase(it);
+    m_usedBytes -= m_nodes[node].size * m_granularity;
+    m_nodes[node].free = true;
+
+    const uint32_t next = m_nodes[node].nextPhysical;
+    if (next != NoNode && m_nodes[next].free) {
+        RemoveFree(next);
+        MergeNext(node);
+    }
+    const uint32_t prev = m_nodes[node].prevPhysical;
+    if (prev != NoNode && m_nodes[prev].free) {
+        RemoveFree(prev);
+        MergeNext(prev);
+        node = prev;
+    }
+    InsertFree(node);
+}
+
+uint64_t TlsfAllocator::GetAllocationSize(uint64_t offset) const noexcept {
+    auto it = m_allocated.find(offset / m_granularity);
+    return it != m_allocated.end() ? m_nodes[it->second].size * m_granularity : 0;
+}
+
+void TlsfAllocator::MapSize(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel) noexcept {
+    if (size < SecondLevelCount) {
+        // Small sizes get one list each
+        firstLevel = 0;
+        secondLevel = static_cast<uint32_t>(size);
+        return;
+    }
+    const uint32_t msb = static_cast<uint32_t>(std::bit_width(size)) - 1;
+    firstLevel = msb - SecondLevelBits + 1;
+    secondLevel = static_cast<uint32_t>(size >> (msb - SecondLevelBits)) - SecondLevelCount;
+}
+
+uint32_t TlsfAllocator::FindFree(uint64_t size) const noexcept {
+    // Round up to the next class boundary so that every range in the first
+    // list searched is large enough
+    if (size >= SecondLevelCount) {
+        const uint32_t msb = static_cast<uint32_t>(std::bit_width(size)) - 1;
+        size += (1ull << (msb - SecondLevelBits)) - 1;
+    }
+    uint32_t firstLevel = 0;
+    uint32_t secondLevel = 0;
+    MapSize(size, firstLevel, secondLevel);
+    if (firstLevel >= FirstLevelCount) {
+        return NoNode;
+    }
+
+    uint32_t secondLevelMap = m_secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+    if (secondLevelMap == 0) {
+        if (firstLevel + 1 >= FirstLevelCount) {
+            return NoNode;
+        }
+        const uint64_t firstLevelMap = m_firstLevelBitmap & (~0ull << (firstLevel + 1));
+        if (firstLevelMap == 0) {
+            return NoNode;
+        }
+        firstLevel = static_cast<uint32_t>(std::countr_zero(firstLevelMap));
+        secondLevelMap = m_secondLevelBitmaps[firstLevel];
+    }
+    return m_freeLists[firstLevel][std::countr_zero(secondLevelMap)];
+}
+
+void TlsfAllocator::InsertFree(uint32_t node) {
+    uint32_t firstLevel = 0;
+    uint32_t secondLevel = 0;
+    MapSize(m_nodes[node].size, firstLevel, secondLevel);
+
+    uint32_t& head = m_freeLists[firstLevel][secondLevel];
+    m_nodes[node].prevFree = NoNode;
+    m_nodes[node].nextFree = head;
+    if (head != NoNode) {
+        m_nodes[head].prevFree = node;
+    }
+    head = node;
+
+    m_firstLevelBitmap |= 1ull << firstLevel;
+    m_secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+}
+
+void TlsfAllocator::RemoveFree(uint32_t node) {
+    Node& n = m_nodes[node];
+    if (n.prevFree != NoNode) {
+        m_nodes[n.prevFree].nextFree = n.nextFree;
+    } else {
+        uint32_t firstLevel = 0;
+        uint32_t secondLevel = 0;
+        MapSize(n.size, firstLevel, secondLevel);
+        m_freeLists[firstLevel][secondLevel] = n.nextFree;
+        if (n.nextFree == NoNode) {
+            m_secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+            if (m_secondLevelBitmaps[firstLevel] == 0) {
+                m_firstLevelBitmap &= ~(1ull << firstLevel);
+            }
+        }
+    }
+    if (n.nextFree != NoNode) {
+        m_nodes[n.nextFree].prevFree = n.prevFree;
+    }
+    n.prevFree = NoNode;
+    n.nextFree = NoNode;
+}
+
+void TlsfAllocator::SplitTail(uint32_t node, uint64_t size) {
+    const uint32_t tail = NewNode();
+    Node& n = m_nodes[node];
+    Node& t = m_nodes[tail];
+    t.offset = n.offset + size;
+    t.size = n.size - size;
+    t.free = true;
+    t.prevPhysical = node;
+    t.nextPhysical = n.nextPhysical;
+    if (n.nextPhysical != NoNode) {
+        m_nodes[n.nextPhysical].prevPhysical = tail;
+    }
+    n.nextPhysical = tail;
+    n.size = size;
+    InsertFree(tail);
+}
+
+void TlsfAllocator::MergeNext(uint32_t node) {
+    Node& n = m_nodes[node];
+    const uint32_t next = n.nextPhysical;
+    n.size += m_nodes[next].size;
+    n.nextPhysical = m_nodes[next].nextPhysical;
+    if (n.nextPhysical != NoNode) {
+        m_nodes[n.nextPhysical].prevPhysical = node;
+    }
+    m_nodes[next] = Node{};
+    m_unusedNodes.push_back(next);
+}
+
+uint32_t TlsfAllocator::NewNode() {
+    if (!m_unusedNodes.empty()) {
+        const uint32_t node = m_unusedNodes.back();
+        m_unusedNodes.pop_back();
+        return node;
+    }
+    m_nodes.emplace_back();
+    return static_cast<uint32_t>(m_nodes.size() - 1);
+}
+
+} // namespace VRHI
@@ -0,0 +1,94 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace VRHI {
+
+/// Two-level segregated fit allocator of offsets in a range of `size` bytes.
+///
+/// Free ranges are kept in lists indexed by a power of two (first level)
+/// split linearly into 2^SecondLevelBits classes (second level). Two bitmaps
+/// record which lists are non-empty, so Allocate() and Free() run in
+/// constant time regardless of fragmentation. Freed ranges are merged with
+/// their free neighbours.
+///
+/// The allocator only does bookkeeping; it never touches the memory. Every
+/// offset and size is rounded to `granularity`, which must be a power of two.
+class TlsfAllocator {
+public:
+    static constexpr uint64_t InvalidOffset = ~0ull;
+
+    TlsfAllocator(uint64_t size, uint64_t granularity);
+
+    TlsfAllocator(const TlsfAllocator&) = delete;
+    TlsfAllocator& operator=(const TlsfAllocator&) = delete;
+
+    /// Reserve `size` bytes at an offset that is a multiple of `alignment`
+    /// @return The offset, or InvalidOffset if no free range is large enough
+    uint64_t Allocate(uint64_t size, uint64_t alignment = 0);
+
+    /// Release a range returned by Allocate()
+    void Free(uint64_t offset);
+
+    /// Size of the range at `offset` after rounding, 0 if it is not allocated
+    uint64_t GetAllocationSize(uint64_t offset) const noexcept;
+
+    uint64_t GetSize() const noexcept { return m_size; }
+    uint64_t GetUsedBytes() const noexcept { return m_usedBytes; }
+    bool IsEmpty() const noexcept { return m_allocated.empty(); }
+
+private:
+    static constexpr uint32_t SecondLevelBits = 4;
+    static constexpr uint32_t SecondLevelCount = 1u << SecondLevelBits;
+    static constexpr uint32_t FirstLevelCount = 64 - SecondLevelBits + 1;
+    static constexpr uint32_t NoNode = ~0u;
+
+    /// A free or allocated range; nodes are linked in offset order
+    struct Node {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint32_t prevPhysical = NoNode;
+        uint32_t nextPhysical = NoNode;
+        uint32_t prevFree = NoNode;
+        uint32_t nextFree = NoNode;
+        bool free = false;
+    };
+
+    /// Free list holding ranges of `size` granules
+    static void MapSize(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel) noexcept;
+
+    /// Find a free node of at least `size` granules, or NoNode
+    uint32_t FindFree(uint64_t size) const noexcept;
+
+    void InsertFree(uint32_t node);
+    void RemoveFree(uint32_t node);
+
+    /// Split the tail of `node` beyond `size` granules into a new free node
+    void SplitTail(uint32_t node, uint64_t size);
+
+    /// Absorb the physical successor of `node` into it
+    void MergeNext(uint32_t node);
+
+    uint32_t NewNode();
+
+    uint64_t m_size;
+    uint64_t m_granularity;
+    uint64_t m_usedBytes = 0;
+
+    // Sizes and offsets below are in granules
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_unusedNodes;
+    uint64_t m_firstLevelBitmap = 0;
+    std::array<uint32_t, FirstLevelCount> m_secondLevelBitmaps{};
+    std::array<std::array<uint32_t, SecondLevelCount>, FirstLevelCount> m_freeLists;
+
+    std::unordered_map<uint64_t, uint32_t> m_allocated;  // Offset -> node
+};
+
+} // namespace VRHI
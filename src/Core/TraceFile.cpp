@@ -0,0 +1,52 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "TraceFile.hpp"
+#include <VRHI/Logging.hpp>
+#include <array>
+
+namespace VRHI {
+
+std::expected<std::unique_ptr<TraceWriter>, Error>
+TraceWriter::Open(const std::filesystem::path& path) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Failed to open trace file for writing: " + path.string()
+        });
+    }
+
+    TraceFileHeader header{};
+    std::memcpy(header.magic, TraceMagic, sizeof(header.magic));
+    header.version = TraceVersion;
+    header.pointerSize = sizeof(void*);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    return std::unique_ptr<TraceWriter>(new TraceWriter(std::move(file)));
+}
+
+void TraceWriter::Write(TraceRecordType type, std::span<const std::span<const std::byte>> parts) {
+    static constexpr std::array<char, TraceAlignment> Padding{};
+
+    size_t size = 0;
+    for (const auto& part : parts) {
+        size += part.size();
+    }
+    const size_t paddedSize = (size + TraceAlignment - 1) & ~size_t(TraceAlignment - 1);
+    const TraceRecordHeader header{type, static_cast<uint32_t>(paddedSize)};
+
+    std::lock_guard lock(m_mutex);
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& part : parts) {
+        m_file.write(reinterpret_cast<const char*>(part.data()), static_cast<std::streamsize>(part.size()));
+    }
+    m_file.write(Padding.data(), static_cast<std::streamsize>(paddedSize - size));
+
+    if (!m_file && !m_failed) [[unlikely]] {
+        LogError("Failed to write trace record; the trace will be incomplete");
+        m_failed = true;
+    }
+}
+
+} // namespace VRHI
@@ -0,0 +1,107 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "TraceFormat.hpp"
+#include <VRHI/VRHI.hpp>
+#include <cstddef>
+#include <cstring>
+#include <expected>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <type_traits>
+
+namespace VRHI {
+
+/// View a trivially copyable value as the bytes of a record part
+template<typename T>
+std::span<const std::byte> AsTraceBytes(const T& value) noexcept {
+    static_assert(std::is_trivially_copyable_v<T>, "Trace data must be trivially copyable");
+    return std::as_bytes(std::span<const T, 1>(&value, 1));
+}
+
+// ============================================================================
+// Trace Writer
+// ============================================================================
+
+/// Appends records to a trace file. Thread safe; records from different
+/// threads are serialized in the order they are written.
+class TraceWriter {
+public:
+    static std::expected<std::unique_ptr<TraceWriter>, Error>
+    Open(const std::filesystem::path& path);
+
+    ~TraceWriter() = default;
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    /// Write one record whose payload is the concatenation of `parts`
+    void Write(TraceRecordType type, std::initializer_list<std::span<const std::byte>> parts = {}) {
+        Write(type, std::span<const std::span<const std::byte>>(parts.begin(), parts.size()));
+    }
+    void Write(TraceRecordType type, std::span<const std::span<const std::byte>> parts);
+
+private:
+    explicit TraceWriter(std::ofstream file) : m_file(std::move(file)) {}
+
+    std::mutex m_mutex;
+    std::ofstream m_file;
+    bool m_failed = false;
+};
+
+// ============================================================================
+// Trace Reader
+// ============================================================================
+
+/// Bounds-checked cursor over a record payload.
+/// Reads past the end return zeroed values and mark the reader as failed.
+class TraceReader {
+public:
+    explicit TraceReader(std::span<const std::byte> data) noexcept : m_data(data) {}
+
+    template<typename T>
+    T Read() noexcept {
+        static_assert(std::is_trivially_copyable_v<T>, "Trace data must be trivially copyable");
+        T value{};
+        auto bytes = ReadBytes(sizeof(T));
+        if (!bytes.empty()) {
+            std::memcpy(&value, bytes.data(), sizeof(T));
+        }
+        return value;
+    }
+
+    /// Next `size` bytes, or an empty span if the payload is too short
+    std::span<const std::byte> ReadBytes(size_t size) noexcept {
+        if (size > m_data.size() - m_offset) {
+            m_failed = true;
+            return {};
+        }
+        auto bytes = m_data.subspan(m_offset, size);
+        m_offset += size;
+        return bytes;
+    }
+
+    /// Next `count` elements copied into `out`
+    template<typename T>
+    void ReadArray(std::span<T> out) noexcept {
+        auto bytes = ReadBytes(out.size_bytes());
+        if (!bytes.empty()) {
+            std::memcpy(out.data(), bytes.data(), bytes.size());
+        }
+    }
+
+    [[nodiscard]] bool HasFailed() const noexcept { return m_failed; }
+
+private:
+    std::span<const std::byte> m_data;
+    size_t m_offset = 0;
+    bool m_failed = false;
+};
+
+} // namespace VRHI
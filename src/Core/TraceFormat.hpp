@@ -0,0 +1,225 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+
+namespace VRHI {
+
+// ============================================================================
+// Trace File Layout
+// ============================================================================
+//
+// A trace is a TraceFileHeader followed by records. Each record is a
+// TraceRecordHeader and `size` bytes of payload, padded to 8 bytes so that
+// command streams embedded in a payload can be decoded in place.
+//
+// Payloads start with the fixed-size Trace* struct of their record type,
+// followed by the variable-length data documented on that struct. Resources
+// and command buffers are referenced by IDs assigned at capture time, never
+// reused within a trace. Recorded commands keep their in-memory layout with
+// the IDs stored in the pointer slots, so a trace can only be replayed on a
+// platform with the same pointer size and byte order.
+
+inline constexpr char TraceMagic[8] = {'V', 'R', 'H', 'I', 'T', 'R', 'C', '\0'};
+inline constexpr uint32_t TraceVersion = 3;
+inline constexpr uint32_t TraceAlignment = 8;
+
+struct TraceFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t pointerSize;
+};
+
+enum class TraceRecordType : uint32_t {
+    CreateBuffer,
+    CreateTexture,
+    CreateSampler,
+    CreateShader,
+    CreatePipeline,
+    CreateRenderPass,
+    CreateFramebuffer,
+    Destroy,
+    UpdateBuffer,
+    UpdateTexture,
+    UpdateTextureRegion,
+    GenerateMipmaps,
+    RecordCommandBuffer,
+    Submit,
+    Present,
+    Resize,
+};
+
+struct TraceRecordHeader {
+    TraceRecordType type;
+    uint32_t size;  ///< Payload bytes following this header, a multiple of TraceAlignment
+};
+
+// ============================================================================
+// Record Payloads
+// ============================================================================
+
+/// Followed by `size` bytes of initial data when `hasInitialData` is set
+struct TraceCreateBuffer {
+    uint32_t id;
+    uint32_t usage;
+    uint32_t memoryAccess;
+    uint32_t hasInitialData;
+    uint64_t size;
+};
+
+/// Followed by `initialDataSize` bytes of mip 0
+struct TraceCreateTexture {
+    uint32_t id;
+    uint32_t type;
+    uint32_t format;
+    uint32_t usage;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t mipLevels;
+    uint32_t arrayLayers;
+    uint32_t sampleCount;
+    uint64_t initialDataSize;
+};
+
+/// Followed by a SamplerDesc with a null debug name
+struct TraceCreateSampler {
+    uint32_t id;
+    uint32_t reserved;
+};
+
+/// Followed by `codeSize` bytes of code (kept 8-byte aligned for SPIR-V),
+/// then `entryPointLength` characters
+struct TraceCreateShader {
+    uint32_t id;
+    uint32_t stage;
+    uint32_t language;
+    uint32_t entryPointLength;
+    uint64_t codeSize;
+};
+
+/// Graphics pipelines are followed by, in order: InputAssemblyState,
+/// RasterizationState, DepthStencilState, VertexAttribute[attributeCount],
+/// VertexBinding[bindingCount], ColorBlendAttachment[blendAttachmentCount],
+/// DynamicState[dynamicStateCount] and uint32_t[sampleMaskCount].
+/// Compute pipelines carry no extra data.
+struct TraceCreatePipeline {
+    uint32_t id;
+    uint32_t type;
+    uint32_t shaders[5];  ///< Vertex, fragment, geometry, tess control, tess eval; compute in [0]
+    uint32_t renderPass;
+    uint32_t subpass;
+    uint32_t attributeCount;
+    uint32_t bindingCount;
+    uint32_t blendAttachmentCount;
+    uint32_t dynamicStateCount;
+    uint32_t sampleMaskCount;
+    uint32_t rasterizationSamples;
+    uint32_t sampleShadingEnable;
+    float minSampleShading;
+    uint32_t alphaToCoverageEnable;
+    uint32_t alphaToOneEnable;
+    uint32_t logicOpEnable;
+    float blendConstants[4];
+};
+
+/// Followed by AttachmentDesc[attachmentCount], then per subpass a
+/// TraceSubpass and its references, then SubpassDependency[dependencyCount]
+struct TraceCreateRenderPass {
+    uint32_t id;
+    uint32_t attachmentCount;
+    uint32_t subpassCount;
+    uint32_t dependencyCount;
+};
+
+/// Followed by AttachmentReference[colorCount], the depth/stencil reference
+/// if present, AttachmentReference[inputCount] and uint32_t[preserveCount]
+struct TraceSubpass {
+    uint32_t colorCount;
+    uint32_t hasDepthStencil;
+    uint32_t inputCount;
+    uint32_t preserveCount;
+};
+
+/// Followed by uint32_t attachment IDs[attachmentCount]
+struct TraceCreateFramebuffer {
+    uint32_t id;
+    uint32_t renderPass;
+    uint32_t width;
+    uint32_t height;
+    uint32_t layers;
+    uint32_t attachmentCount;
+};
+
+struct TraceDestroy {
+    uint32_t id;
+    uint32_t reserved;
+};
+
+/// Followed by `size` bytes
+struct TraceUpdateBuffer {
+    uint32_t id;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+};
+
+/// Followed by `size` bytes
+struct TraceUpdateTexture {
+    uint32_t id;
+    uint32_t mipLevel;
+    uint32_t arrayLayer;
+    uint32_t reserved;
+    uint64_t size;
+};
+
+/// Followed by `size` bytes
+struct TraceUpdateTextureRegion {
+    uint32_t id;
+    uint32_t x, y, z;
+    uint32_t width, height, depth;
+    uint32_t mipLevel;
+    uint32_t arrayLayer;
+    uint32_t reserved;
+    uint64_t size;
+};
+
+struct TraceGenerateMipmaps {
+    uint32_t id;
+    uint32_t reserved;
+};
+
+/// Followed by `size` bytes of encoded commands (see CommandStream)
+struct TraceRecordCommandBuffer {
+    uint32_t id;
+    uint32_t level;
+    uint64_t size;
+};
+
+struct TraceSubmit {
+    uint32_t id;
+    uint32_t reserved;
+};
+
+struct TraceResize {
+    uint32_t width;
+    uint32_t height;
+};
+
+// ============================================================================
+// IDs in Pointer Slots
+// ============================================================================
+
+template<typename T>
+T* TraceIdToPointer(uint32_t id) noexcept {
+    return reinterpret_cast<T*>(static_cast<uintptr_t>(id));
+}
+
+template<typename T>
+uint32_t PointerToTraceId(T* pointer) noexcept {
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pointer));
+}
+
+} // namespace VRHI
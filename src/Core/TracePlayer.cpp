@@ -0,0 +1,528 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "CommandDecoder.hpp"
+#include "TraceFile.hpp"
+#include <VRHI/Capture.hpp>
+#include <VRHI/CommandBuffer.hpp>
+#include <VRHI/Logging.hpp>
+#include <VRHI/Pipeline.hpp>
+#include <VRHI/RenderPass.hpp>
+#include <VRHI/Resources.hpp>
+#include <VRHI/Shader.hpp>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace VRHI {
+
+namespace {
+    Error CorruptTrace(const std::string& detail) {
+        return Error{Error::Code::ValidationError, "Corrupt trace: " + detail};
+    }
+
+    template<typename T>
+    using ResourceMap = std::unordered_map<uint32_t, std::unique_ptr<T>>;
+
+    template<typename T>
+    std::vector<T> ReadVector(TraceReader& reader, uint32_t count) {
+        std::vector<T> values(count);
+        reader.ReadArray(std::span<T>(values));
+        return values;
+    }
+
+    /// Check that `commands` is a well-formed sequence of encoded commands
+    bool ValidateCommands(std::span<const std::byte> commands, uint64_t& commandCount) {
+        size_t offset = 0;
+        while (offset < commands.size()) {
+            if (commands.size() - offset < sizeof(CommandHeader)) {
+                return false;
+            }
+            const auto& header = *reinterpret_cast<const CommandHeader*>(commands.data() + offset);
+            if (header.size < sizeof(CommandHeader) || header.size % CommandStream::Alignment != 0 ||
+                header.size > commands.size() - offset ||
+                header.type > CommandType::BindStorageBuffer) {
+                return false;
+            }
+            offset += header.size;
+            ++commandCount;
+        }
+        return true;
+    }
+} // anonymous namespace
+
+// ============================================================================
+// In-Memory Trace Player
+// ============================================================================
+
+/// Keeps the whole trace in memory; recorded command streams are decoded in
+/// place, with their IDs patched to the replay device's objects by Prepare().
+class MemoryTracePlayer final : public TracePlayer {
+public:
+    explicit MemoryTracePlayer(std::vector<std::byte> data) : m_data(std::move(data)) {}
+    ~MemoryTracePlayer() override;
+
+    std::expected<void, Error> Parse();
+
+    const TraceStats& GetStats() const noexcept override { return m_stats; }
+    std::expected<void, Error> Prepare(Device& device) override;
+    void ReplayFrame(uint32_t frame) override;
+
+private:
+    struct Record {
+        TraceRecordType type;
+        std::span<std::byte> payload;
+    };
+
+    struct Frame {
+        size_t firstRecord = 0;
+        size_t recordCount = 0;
+    };
+
+    std::expected<void, Error> CreateResource(const Record& record);
+    std::expected<void, Error> CreatePipeline(TraceReader& reader);
+    std::expected<void, Error> CreateRenderPass(TraceReader& reader);
+    void ReplayRecord(const Record& record);
+
+    template<typename T>
+    ResourceMap<T>& GetMap() noexcept { return std::get<ResourceMap<T>>(m_resources); }
+
+    /// Replay-device object of a trace ID, or nullptr
+    template<typename T>
+    T* Find(uint32_t id) noexcept {
+        auto& map = GetMap<T>();
+        auto it = map.find(id);
+        return it != map.end() ? it->second.get() : nullptr;
+    }
+
+    template<typename T>
+    std::expected<void, Error> Store(uint32_t id, std::expected<std::unique_ptr<T>, Error> result) {
+        if (!result) {
+            Error error = result.error();
+            error.message = "Trace object " + std::to_string(id) + ": " + error.message;
+            return std::unexpected(std::move(error));
+        }
+        GetMap<T>()[id] = std::move(*result);
+        return {};
+    }
+
+    std::vector<std::byte> m_data;
+    std::vector<Record> m_setupRecords;   // Resource creations, in trace order
+    std::vector<Record> m_frameRecords;   // Everything replayed per frame
+    std::vector<Frame> m_frames;
+    std::map<uint32_t, CommandBufferLevel> m_commandBufferLevels;  // Ordered so creation order is stable
+    TraceStats m_stats;
+
+    Device* m_device = nullptr;
+    std::tuple<ResourceMap<Buffer>, ResourceMap<Texture>, ResourceMap<Sampler>, ResourceMap<Shader>,
+               ResourceMap<RenderPass>, ResourceMap<Pipeline>, ResourceMap<Framebuffer>,
+               ResourceMap<CommandBuffer>> m_resources;
+};
+
+MemoryTracePlayer::~MemoryTracePlayer() {
+    // Release in reverse dependency order
+    GetMap<CommandBuffer>().clear();
+    GetMap<Framebuffer>().clear();
+    GetMap<Pipeline>().clear();
+    GetMap<RenderPass>().clear();
+    GetMap<Shader>().clear();
+    GetMap<Sampler>().clear();
+    GetMap<Texture>().clear();
+    GetMap<Buffer>().clear();
+}
+
+std::expected<void, Error> MemoryTracePlayer::Parse() {
+    if (m_data.size() < sizeof(TraceFileHeader)) {
+        return std::unexpected(CorruptTrace("file is too small"));
+    }
+    TraceFileHeader fileHeader;
+    std::memcpy(&fileHeader, m_data.data(), sizeof(fileHeader));
+    if (std::memcmp(fileHeader.magic, TraceMagic, sizeof(TraceMagic)) != 0) {
+        return std::unexpected(CorruptTrace("not a VRHI trace"));
+    }
+    if (fileHeader.version != TraceVersion) {
+        return std::unexpected(CorruptTrace("unsupported version " + std::to_string(fileHeader.version)));
+    }
+    if (fileHeader.pointerSize != sizeof(void*)) {
+        return std::unexpected(CorruptTrace("captured with a different pointer size"));
+    }
+
+    size_t offset = sizeof(TraceFileHeader);
+    Frame frame;
+    while (offset < m_data.size()) {
+        if (m_data.size() - offset < sizeof(TraceRecordHeader)) {
+            return std::unexpected(CorruptTrace("truncated record header"));
+        }
+        TraceRecordHeader header;
+        std::memcpy(&header, m_data.data() + offset, sizeof(header));
+        offset += sizeof(header);
+        if (header.size > m_data.size() - offset || header.size % TraceAlignment != 0) {
+            return std::unexpected(CorruptTrace("truncated record"));
+        }
+        const Record record{header.type, std::span<std::byte>(m_data.data() + offset, header.size)};
+        offset += header.size;
+
+        TraceReader reader(record.payload);
+        switch (record.type) {
+            case TraceRecordType::CreateBuffer:
+            case TraceRecordType::CreateTexture:
+            case TraceRecordType::CreateSampler:
+            case TraceRecordType::CreateShader:
+            case TraceRecordType::CreatePipeline:
+            case TraceRecordType::CreateRenderPass:
+            case TraceRecordType::CreateFramebuffer:
+                m_setupRecords.push_back(record);
+                ++m_stats.resourceCount;
+                continue;
+            case TraceRecordType::Destroy:
+                // Replayed resources live as long as the player
+                continue;
+            case TraceRecordType::UpdateBuffer:
+                m_stats.uploadBytes += reader.Read<TraceUpdateBuffer>().size;
+                break;
+            case TraceRecordType::UpdateTexture:
+                m_stats.uploadBytes += reader.Read<TraceUpdateTexture>().size;
+                break;
+            case TraceRecordType::UpdateTextureRegion:
+                m_stats.uploadBytes += reader.Read<TraceUpdateTextureRegion>().size;
+                break;
+            case TraceRecordType::RecordCommandBuffer: {
+                const auto info = reader.Read<TraceRecordCommandBuffer>();
+                const auto commands = reader.ReadBytes(info.size);
+                if (reader.HasFailed() || !ValidateCommands(commands, m_stats.commandCount)) {
+                    return std::unexpected(CorruptTrace("malformed command buffer recording"));
+                }
+                m_commandBufferLevels[info.id] = static_cast<CommandBufferLevel>(info.level);
+                break;
+            }
+            case TraceRecordType::GenerateMipmaps:
+            case TraceRecordType::Submit:
+            case TraceRecordType::Present:
+            case TraceRecordType::Resize:
+                break;
+            default:
+                return std::unexpected(CorruptTrace("unknown record type " +
+                                                    std::to_string(static_cast<uint32_t>(record.type))));
+        }
+
+        m_frameRecords.push_back(record);
+        ++frame.recordCount;
+        if (record.type == TraceRecordType::Present) {
+            m_frames.push_back(frame);
+            frame = Frame{m_frameRecords.size(), 0};
+        }
+    }
+
+    // Work after the last present (or in a trace that never presents) is a frame of its own
+    if (frame.recordCount > 0) {
+        m_frames.push_back(frame);
+    }
+
+    m_stats.frameCount = static_cast<uint32_t>(m_frames.size());
+    m_stats.commandBufferCount = static_cast<uint32_t>(m_commandBufferLevels.size());
+    return {};
+}
+
+// ============================================================================
+// Resource Creation
+// ============================================================================
+
+std::expected<void, Error> MemoryTracePlayer::Prepare(Device& device) {
+    if (m_device) {
+        return std::unexpected(Error{Error::Code::InvalidConfig, "Trace player is already prepared"});
+    }
+    m_device = &device;
+
+    for (const Record& record : m_setupRecords) {
+        if (auto result = CreateResource(record); !result) {
+            return result;
+        }
+    }
+
+    for (const auto& [id, level] : m_commandBufferLevels) {
+        auto cmd = device.CreateCommandBuffer(level);
+        if (!cmd) {
+            return std::unexpected(Error{Error::Code::InitializationFailed, "Failed to create a command buffer"});
+        }
+        GetMap<CommandBuffer>()[id] = std::move(cmd);
+    }
+
+    // Point recorded commands at the objects just created
+    for (const Record& record : m_frameRecords) {
+        if (record.type != TraceRecordType::RecordCommandBuffer) {
+            continue;
+        }
+        const auto info = TraceReader(record.payload).Read<TraceRecordCommandBuffer>();
+        RemapCommandResources(record.payload.subspan(sizeof(info), info.size), [this](auto*& object) {
+            using T = std::remove_reference_t<decltype(*object)>;
+            object = Find<T>(PointerToTraceId(object));
+        });
+    }
+    return {};
+}
+
+std::expected<void, Error> MemoryTracePlayer::CreateResource(const Record& record) {
+    TraceReader reader(record.payload);
+    switch (record.type) {
+        case TraceRecordType::CreateBuffer: {
+            const auto info = reader.Read<TraceCreateBuffer>();
+            BufferDesc desc;
+            desc.size = info.size;
+            desc.usage = static_cast<BufferUsage>(info.usage);
+            desc.memoryAccess = static_cast<MemoryAccess>(info.memoryAccess);
+            desc.initialData = info.hasInitialData ? reader.ReadBytes(info.size).data() : nullptr;
+            return Store(info.id, m_device->CreateBuffer(desc));
+        }
+        case TraceRecordType::CreateTexture: {
+            const auto info = reader.Read<TraceCreateTexture>();
+            TextureDesc desc;
+            desc.type = static_cast<TextureType>(info.type);
+            desc.format = static_cast<TextureFormat>(info.format);
+            desc.usage = static_cast<TextureUsage>(info.usage);
+            desc.width = info.width;
+            desc.height = info.height;
+            desc.depth = info.depth;
+            desc.mipLevels = info.mipLevels;
+            desc.arrayLayers = info.arrayLayers;
+            desc.sampleCount = info.sampleCount;
+            desc.initialData = info.initialDataSize > 0 ? reader.ReadBytes(info.initialDataSize).data() : nullptr;
+            return Store(info.id, m_device->CreateTexture(desc));
+        }
+        case TraceRecordType::CreateSampler: {
+            const auto info = reader.Read<TraceCreateSampler>();
+            return Store(info.id, m_device->CreateSampler(reader.Read<SamplerDesc>()));
+        }
+        case TraceRecordType::CreateShader: {
+            const auto info = reader.Read<TraceCreateShader>();
+            const auto code = reader.ReadBytes(info.codeSize);
+            const auto entryPointBytes = reader.ReadBytes(info.entryPointLength);
+            const std::string entryPoint(reinterpret_cast<const char*>(entryPointBytes.data()), entryPointBytes.size());
+            ShaderDesc desc;
+            desc.stage = static_cast<ShaderStage>(info.stage);
+            desc.language = static_cast<ShaderLanguage>(info.language);
+            desc.code = code.data();
+            desc.codeSize = code.size();
+            desc.entryPoint = entryPoint.c_str();
+            return Store(info.id, m_device->CreateShader(desc));
+        }
+        case TraceRecordType::CreatePipeline:
+            return CreatePipeline(reader);
+        case TraceRecordType::CreateRenderPass:
+            return CreateRenderPass(reader);
+        case TraceRecordType::CreateFramebuffer: {
+            const auto info = reader.Read<TraceCreateFramebuffer>();
+            std::vector<Texture*> attachments;
+            for (uint32_t id : ReadVector<uint32_t>(reader, info.attachmentCount)) {
+                attachments.push_back(Find<Texture>(id));
+            }
+            FramebufferDesc desc;
+            desc.renderPass = Find<RenderPass>(info.renderPass);
+            desc.attachments = attachments;
+            desc.width = info.width;
+            desc.height = info.height;
+            desc.layers = info.layers;
+            return Store(info.id, m_device->CreateFramebuffer(desc));
+        }
+        default:
+            return {};
+    }
+}
+
+std::expected<void, Error> MemoryTracePlayer::CreatePipeline(TraceReader& reader) {
+    const auto info = reader.Read<TraceCreatePipeline>();
+    PipelineDesc desc;
+    desc.type = static_cast<PipelineType>(info.type);
+
+    if (desc.type == PipelineType::Compute) {
+        desc.compute = ComputePipelineDesc{};
+        desc.compute.computeShader = Find<Shader>(info.shaders[0]);
+        return Store(info.id, m_device->CreatePipeline(desc));
+    }
+
+    GraphicsPipelineDesc& graphics = desc.graphics;
+    graphics.vertexShader = Find<Shader>(info.shaders[0]);
+    graphics.fragmentShader = Find<Shader>(info.shaders[1]);
+    graphics.geometryShader = Find<Shader>(info.shaders[2]);
+    graphics.tessControlShader = Find<Shader>(info.shaders[3]);
+    graphics.tessEvalShader = Find<Shader>(info.shaders[4]);
+    graphics.renderPass = Find<RenderPass>(info.renderPass);
+    graphics.subpass = info.subpass;
+
+    graphics.inputAssembly = reader.Read<InputAssemblyState>();
+    graphics.rasterization = reader.Read<RasterizationState>();
+    graphics.depthStencil = reader.Read<DepthStencilState>();
+    const auto attributes = ReadVector<VertexAttribute>(reader, info.attributeCount);
+    const auto bindings = ReadVector<VertexBinding>(reader, info.bindingCount);
+    const auto blendAttachments = ReadVector<ColorBlendAttachment>(reader, info.blendAttachmentCount);
+    const auto dynamicStates = ReadVector<DynamicState>(reader, info.dynamicStateCount);
+    const auto sampleMask = ReadVector<uint32_t>(reader, info.sampleMaskCount);
+    if (reader.HasFailed()) {
+        return std::unexpected(CorruptTrace("truncated pipeline " + std::to_string(info.id)));
+    }
+
+    graphics.vertexInput.attributes = attributes;
+    graphics.vertexInput.bindings = bindings;
+    graphics.colorBlend.attachments = blendAttachments;
+    graphics.colorBlend.logicOpEnable = info.logicOpEnable != 0;
+    std::copy_n(info.blendConstants, 4, graphics.colorBlend.blendConstants);
+    graphics.dynamicStates = dynamicStates;
+    graphics.multisample.rasterizationSamples = info.rasterizationSamples;
+    graphics.multisample.sampleShadingEnable = info.sampleShadingEnable != 0;
+    graphics.multisample.minSampleShading = info.minSampleShading;
+    graphics.multisample.sampleMask = sampleMask.empty() ? nullptr : sampleMask.data();
+    graphics.multisample.alphaToCoverageEnable = info.alphaToCoverageEnable != 0;
+    graphics.multisample.alphaToOneEnable = info.alphaToOneEnable != 0;
+    return Store(info.id, m_device->CreatePipeline(desc));
+}
+
+std::expected<void, Error> MemoryTracePlayer::CreateRenderPass(TraceReader& reader) {
+    const auto info = reader.Read<TraceCreateRenderPass>();
+    const auto attachments = ReadVector<AttachmentDesc>(reader, info.attachmentCount);
+
+    // Reference arrays must stay put while the subpass descriptors point at them
+    std::vector<std::vector<AttachmentReference>> colorReferences(info.subpassCount);
+    std::vector<std::vector<AttachmentReference>> inputReferences(info.subpassCount);
+    std::vector<std::vector<uint32_t>> preserveAttachments(info.subpassCount);
+    std::vector<AttachmentReference> depthStencilReferences(info.subpassCount);
+    std::vector<SubpassDesc> subpasses(info.subpassCount);
+    for (uint32_t i = 0; i < info.subpassCount && !reader.HasFailed(); ++i) {
+        const auto counts = reader.Read<TraceSubpass>();
+        colorReferences[i] = ReadVector<AttachmentReference>(reader, counts.colorCount);
+        if (counts.hasDepthStencil) {
+            depthStencilReferences[i] = reader.Read<AttachmentReference>();
+            subpasses[i].depthStencilAttachment = &depthStencilReferences[i];
+        }
+        inputReferences[i] = ReadVector<AttachmentReference>(reader, counts.inputCount);
+        preserveAttachments[i] = ReadVector<uint32_t>(reader, counts.preserveCount);
+        subpasses[i].colorAttachments = colorReferences[i];
+        subpasses[i].inputAttachments = inputReferences[i];
+        subpasses[i].preserveAttachments = preserveAttachments[i];
+    }
+    const auto dependencies = ReadVector<SubpassDependency>(reader, info.dependencyCount);
+    if (reader.HasFailed()) {
+        return std::unexpected(CorruptTrace("truncated render pass " + std::to_string(info.id)));
+    }
+
+    RenderPassDesc desc;
+    desc.attachments = attachments;
+    desc.subpasses = subpasses;
+    desc.dependencies = dependencies;
+    return Store(info.id, m_device->CreateRenderPass(desc));
+}
+
+// ============================================================================
+// Frame Replay
+// ============================================================================
+
+void MemoryTracePlayer::ReplayFrame(uint32_t frame) {
+    if (!m_device) {
+        LogError("TracePlayer::ReplayFrame called before Prepare");
+        return;
+    }
+    if (frame >= m_frames.size()) {
+        LogWarning("TracePlayer::ReplayFrame: frame index out of range");
+        return;
+    }
+
+    const Frame& range = m_frames[frame];
+    for (size_t i = 0; i < range.recordCount; ++i) {
+        ReplayRecord(m_frameRecords[range.firstRecord + i]);
+    }
+}
+
+void MemoryTracePlayer::ReplayRecord(const Record& record) {
+    TraceReader reader(record.payload);
+    switch (record.type) {
+        case TraceRecordType::UpdateBuffer: {
+            const auto info = reader.Read<TraceUpdateBuffer>();
+            const auto data = reader.ReadBytes(info.size);
+            if (Buffer* buffer = Find<Buffer>(info.id); buffer && !reader.HasFailed()) {
+                buffer->Update(data.data(), data.size(), info.offset);
+            }
+            break;
+        }
+        case TraceRecordType::UpdateTexture: {
+            const auto info = reader.Read<TraceUpdateTexture>();
+            const auto data = reader.ReadBytes(info.size);
+            if (Texture* texture = Find<Texture>(info.id); texture && !reader.HasFailed()) {
+                texture->Update(data.data(), data.size(), info.mipLevel, info.arrayLayer);
+            }
+            break;
+        }
+        case TraceRecordType::UpdateTextureRegion: {
+            const auto info = reader.Read<TraceUpdateTextureRegion>();
+            const auto data = reader.ReadBytes(info.size);
+            if (Texture* texture = Find<Texture>(info.id); texture && !reader.HasFailed()) {
+                texture->UpdateRegion(data.data(), info.x, info.y, info.z,
+                                      info.width, info.height, info.depth,
+                                      info.mipLevel, info.arrayLayer);
+            }
+            break;
+        }
+        case TraceRecordType::GenerateMipmaps:
+            if (Texture* texture = Find<Texture>(reader.Read<TraceGenerateMipmaps>().id)) {
+                texture->GenerateMipmaps(nullptr);
+            }
+            break;
+        case TraceRecordType::RecordCommandBuffer: {
+            const auto info = reader.Read<TraceRecordCommandBuffer>();
+            CommandBuffer* cmd = Find<CommandBuffer>(info.id);
+            cmd->Begin();
+            DecodeCommands(reader.ReadBytes(info.size), *cmd);
+            cmd->End();
+            break;
+        }
+        case TraceRecordType::Submit:
+            if (CommandBuffer* cmd = Find<CommandBuffer>(reader.Read<TraceSubmit>().id)) {
+                m_device->Submit(cmd);
+            }
+            break;
+        case TraceRecordType::Present:
+            m_device->Present();
+            break;
+        case TraceRecordType::Resize: {
+            const auto info = reader.Read<TraceResize>();
+            m_device->Resize(info.width, info.height);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// ============================================================================
+// Loading
+// ============================================================================
+
+std::expected<std::unique_ptr<TracePlayer>, Error>
+TracePlayer::Load(const std::filesystem::path& tracePath) {
+    std::ifstream file(tracePath, std::ios::binary);
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(tracePath, ec);
+    if (!file || ec) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Failed to open trace file: " + tracePath.string()
+        });
+    }
+
+    std::vector<std::byte> data(size);
+    if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size))) {
+        return std::unexpected(Error{
+            Error::Code::InvalidConfig,
+            "Failed to read trace file: " + tracePath.string()
+        });
+    }
+
+    auto player = std::make_unique<MemoryTracePlayer>(std::move(data));
+    if (auto result = player->Parse(); !result) {
+        return std::unexpected(result.error());
+    }
+    return player;
+}
+
+} // namespace VRHI
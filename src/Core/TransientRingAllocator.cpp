@@ -0,0 +1,222 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "TransientRingAllocator.hpp"
+#include <VRHI/Logging.hpp>
+#include <algorithm>
+#include <cinttypes>
+
+namespace VRHI {
+
+namespace {
+    constexpr uint64_t FallbackAlignment = 256;
+
+    uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+TransientRingAllocator::TransientRingAllocator(Device& device, uint64_t alignment, uint64_t capacity)
+    : m_device(&device)
+    , m_alignment(alignment != 0 ? alignment : FallbackAlignment)
+    , m_capacity(capacity)
+{
+}
+
+TransientRingAllocator::~TransientRingAllocator() {
+    Release();
+}
+
+void TransientRingAllocator::Release() {
+    FlushWrites();
+    for (const auto& frame : m_frames) {
+        DeleteFence(frame.fence);
+    }
+    m_frames.clear();
+    m_retiredBuffers.clear();
+    m_buffer.reset();
+    m_head = m_tail = m_used = m_frameBytes = 0;
+}
+
+TransientAllocation TransientRingAllocator::Allocate(uint64_t size, uint64_t alignment) {
+    if (size == 0) {
+        return {};
+    }
+    if (alignment == 0) {
+        alignment = m_alignment;
+    }
+
+    uint64_t offset = 0;
+    if (!m_buffer || !Reserve(size, alignment, offset)) {
+        RetireFrames();
+        if (!m_buffer || !Reserve(size, alignment, offset)) {
+            if (!Grow(size + alignment) || !Reserve(size, alignment, offset)) {
+                return {};
+            }
+        }
+    }
+
+    if (!m_mapping.data) {
+        m_mapping.data = static_cast<std::byte*>(MapRing(*m_buffer));
+        if (!m_mapping.data) {
+            LogError("Failed to map the transient ring");
+            return {};
+        }
+        m_mapping.buffer = m_buffer.get();
+        m_mapping.begin = offset;
+        m_mapping.wrapped = false;
+    } else if (offset < m_mapping.end) {
+        m_mapping.wrapped = true;
+    }
+    m_mapping.end = offset + size;
+
+    TransientAllocation allocation{};
+    allocation.buffer = m_buffer.get();
+    allocation.offset = offset;
+    allocation.data = m_mapping.data + offset;
+    allocation.size = size;
+    return allocation;
+}
+
+bool TransientRingAllocator::Reserve(uint64_t size, uint64_t alignment, uint64_t& offset) {
+    if (m_used == 0) {
+        m_head = m_tail = 0;
+    } else if (m_head == m_tail) {
+        return false;  // Full
+    }
+
+    uint64_t start = AlignUp(m_head, alignment);
+    uint64_t consumed = 0;
+    if (m_head >= m_tail) {
+        if (start + size <= m_capacity) {
+            consumed = start + size - m_head;
+        } else if (size <= m_tail) {
+            // Skip the end of the ring; the skipped bytes retire with this frame
+            start = 0;
+            consumed = m_capacity - m_head + size;
+        } else {
+            return false;
+        }
+    } else {
+        if (start + size > m_tail) {
+            return false;
+        }
+        consumed = start + size - m_head;
+    }
+
+    m_head = start + size;
+    if (m_head == m_capacity) {
+        m_head = 0;
+    }
+    m_used += consumed;
+    m_frameBytes += consumed;
+    offset = start;
+    return true;
+}
+
+void TransientRingAllocator::RetireFrames() {
+    while (!m_frames.empty() && IsFenceSignaled(m_frames.front().fence)) {
+        const Frame& frame = m_frames.front();
+        DeleteFence(frame.fence);
+        if (frame.bytes != 0) {
+            m_tail = frame.end;
+            m_used -= frame.bytes;
+        }
+        m_retiredFrame = frame.id;
+        m_frames.pop_front();
+    }
+
+    std::erase_if(m_retiredBuffers, [this](const RetiredBuffer& retired) {
+        return retired.lastFrame <= m_retiredFrame;
+    });
+}
+
+bool TransientRingAllocator::Grow(uint64_t minSize) {
+    // Earlier slices of this frame may still be written through the old
+    // mapping, so it stays open until the next flush
+    if (m_mapping.data) {
+        m_staleMappings.push_back(m_mapping);
+        m_mapping = {};
+    }
+
+    uint64_t capacity = m_buffer ? m_capacity * 2 : m_capacity;
+    while (capacity < minSize) {
+        capacity *= 2;
+    }
+
+    BufferDesc desc{};
+    desc.size = static_cast<size_t>(capacity);
+    desc.usage = BufferUsage::Vertex | BufferUsage::Index | BufferUsage::Uniform | BufferUsage::Storage;
+    desc.memoryAccess = MemoryAccess::CpuToGpu;
+    desc.streaming = BufferStreaming::None;  // Fenced per frame by the ring itself
+    desc.debugName = "VRHI transient ring";
+
+    auto buffer = m_device->CreateBuffer(desc);
+    if (!buffer) {
+        LogError("Failed to create a %" PRIu64 " byte transient ring: %s",
+                 capacity, buffer.error().message.c_str());
+        return false;
+    }
+
+    if (m_buffer) {
+        LogInfo("Transient ring grew to %" PRIu64 " bytes", capacity);
+        m_retiredBuffers.push_back({std::move(m_buffer), m_currentFrame});
+
+        // The frames in flight only hold memory of the old ring now
+        for (auto& frame : m_frames) {
+            frame.bytes = 0;
+        }
+    }
+
+    m_buffer = std::move(*buffer);
+    m_capacity = capacity;
+    m_head = m_tail = m_used = m_frameBytes = 0;
+    return true;
+}
+
+void TransientRingAllocator::FlushWrites() {
+    if (m_mapping.data) {
+        Unmap(m_mapping);
+        m_mapping = {};
+    }
+    for (const auto& mapping : m_staleMappings) {
+        Unmap(mapping);
+    }
+    m_staleMappings.clear();
+}
+
+void TransientRingAllocator::Unmap(const Mapping& mapping) {
+    if (mapping.wrapped) {
+        FlushRange(*mapping.buffer, mapping.begin, mapping.buffer->GetSize() - mapping.begin);
+        FlushRange(*mapping.buffer, 0, mapping.end);
+    } else {
+        FlushRange(*mapping.buffer, mapping.begin, mapping.end - mapping.begin);
+    }
+    UnmapRing(*mapping.buffer);
+}
+
+void TransientRingAllocator::EndFrame() {
+    if (m_buffer || !m_retiredBuffers.empty()) {
+        FlushWrites();
+        m_frames.push_back({m_currentFrame, m_head, m_frameBytes, InsertFence()});
+        m_frameBytes = 0;
+        RetireFrames();
+    }
+    ++m_currentFrame;
+}
+
+void* TransientRingAllocator::MapRing(Buffer& buffer) {
+    // Frames in flight are never overwritten, so the map need not wait for them
+    return buffer.Map(0, buffer.GetSize(),
+                      MapAccess::Write | MapAccess::Unsynchronized | MapAccess::FlushExplicit);
+}
+
+void TransientRingAllocator::FlushRange(Buffer& buffer, uint64_t offset, uint64_t size) {
+    buffer.FlushRange(static_cast<size_t>(offset), static_cast<size_t>(size));
+}
+
+void TransientRingAllocator::UnmapRing(Buffer& buffer) {
+    buffer.Unmap();
+}
+
+} // namespace VRHI
@@ -0,0 +1,134 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <VRHI/TransientAllocator.hpp>
+#include <VRHI/VRHI.hpp>
+#include <VRHI/Resources.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace VRHI {
+
+/// Transient allocator that sub-allocates one ring buffer per device.
+///
+/// Every frame appends to the ring; Device::Present() calls EndFrame(),
+/// which records where the frame ended and inserts a fence. The memory of a
+/// frame is reused once its fence has signaled. When the frames in flight
+/// fill the ring, a ring of twice the size replaces it and the old buffer is
+/// kept until the last frame that used it has retired, so allocation never
+/// waits for the GPU.
+///
+/// Slices are written through one mapping of the whole ring that is opened
+/// by the first allocation after a submission; the device calls
+/// FlushWrites() before each submission to flush the written ranges and
+/// unmap it. The default hooks map with Buffer::Map() for unsynchronized,
+/// explicitly flushed writes and treat every frame as retired at once,
+/// which is what a device without a GPU (NullDevice) needs. GPU backends
+/// override the mapping and fence hooks.
+class TransientRingAllocator : public TransientAllocator {
+public:
+    static constexpr uint64_t DefaultCapacity = 4ull << 20;
+
+    /// @param alignment Default offset alignment; 0 falls back to 256 bytes
+    /// @param capacity Initial ring size; the buffer is created on first use
+    TransientRingAllocator(Device& device, uint64_t alignment, uint64_t capacity = DefaultCapacity);
+    ~TransientRingAllocator() override;
+
+    // TransientAllocator interface
+    TransientAllocation Allocate(uint64_t size, uint64_t alignment = 0) override;
+    uint64_t GetFrameUsage() const noexcept override { return m_frameBytes; }
+    uint64_t GetCapacity() const noexcept override { return m_capacity; }
+
+    /// Unmap the ring so that submitted commands see the written slices
+    void FlushWrites();
+
+    /// Close the current frame and recycle the frames that have retired
+    void EndFrame();
+
+    /// Free the ring buffers and fences; derived classes call this from
+    /// their destructor, while the hooks can still be dispatched
+    void Release();
+
+    /// Frames whose memory has not been recycled yet
+    size_t GetFramesInFlight() const noexcept { return m_frames.size(); }
+
+protected:
+    /// Map all of `buffer` for writing; only free ranges are written
+    virtual void* MapRing(Buffer& buffer);
+
+    /// Make `size` written bytes at `offset` visible to the GPU
+    virtual void FlushRange(Buffer& buffer, uint64_t offset, uint64_t size);
+
+    virtual void UnmapRing(Buffer& buffer);
+
+    /// Fence covering all work submitted so far; nullptr if none is needed
+    virtual void* InsertFence() { return nullptr; }
+
+    virtual bool IsFenceSignaled(void* fence) { return true; }
+
+    virtual void DeleteFence(void* fence) {}
+
+private:
+    /// A closed frame and the ring bytes it holds
+    struct Frame {
+        uint64_t id;
+        uint64_t end;    // Ring head when the frame was closed
+        uint64_t bytes;  // Including padding; 0 once the ring was replaced
+        void* fence;
+    };
+
+    /// A replaced ring, kept alive until frame `lastFrame` retires
+    struct RetiredBuffer {
+        std::unique_ptr<Buffer> buffer;
+        uint64_t lastFrame;
+    };
+
+    /// A mapped ring and the range written through it since it was mapped
+    struct Mapping {
+        Buffer* buffer = nullptr;
+        std::byte* data = nullptr;
+        uint64_t begin = 0;
+        uint64_t end = 0;
+        bool wrapped = false;  // Writes continued at the start of the ring
+    };
+
+    /// Claim `size` bytes in the ring without overwriting frames in flight
+    bool Reserve(uint64_t size, uint64_t alignment, uint64_t& offset);
+
+    /// Pop the frames whose fences have signaled
+    void RetireFrames();
+
+    /// Replace the ring by one that holds at least `minSize` bytes
+    bool Grow(uint64_t minSize);
+
+    void Unmap(const Mapping& mapping);
+
+    Device* m_device;
+    uint64_t m_alignment;
+    uint64_t m_capacity;
+
+    std::unique_ptr<Buffer> m_buffer;
+    std::vector<RetiredBuffer> m_retiredBuffers;
+
+    // Ring state; bytes in [m_tail, m_head) (wrapping) belong to live frames
+    uint64_t m_head = 0;
+    uint64_t m_tail = 0;
+    uint64_t m_used = 0;
+    uint64_t m_frameBytes = 0;
+
+    std::deque<Frame> m_frames;
+    uint64_t m_currentFrame = 1;
+    uint64_t m_retiredFrame = 0;
+
+    // Current mapping, and mappings of replaced rings that earlier slices
+    // of the frame may still be written through
+    Mapping m_mapping;
+    std::vector<Mapping> m_staleMappings;
+};
+
+} // namespace VRHI
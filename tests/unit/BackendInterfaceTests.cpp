@@ -186,6 +186,14 @@ TEST_F(DeviceInterfaceTest, CreateSyncObjects) {
     EXPECT_NE(semaphore, nullptr);
 }
 
+TEST_F(DeviceInterfaceTest, FrameStatsDefaultToZero) {
+    auto stats = device->GetFrameStats();
+    EXPECT_EQ(stats.stateChangesEmitted, 0u);
+    EXPECT_EQ(stats.stateChangesFiltered, 0u);
+    EXPECT_EQ(stats.drawCalls, 0u);
+    EXPECT_EQ(stats.drawsMerged, 0u);
+}
+
 class CommandBufferInterfaceTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -0,0 +1,296 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include <VRHI/VRHIAll.hpp>
+#include <VRHI/RecordingCommandBuffer.hpp>
+#include <gtest/gtest.h>
+#include <array>
+#include <cstring>
+#include <vector>
+
+// Include internal headers for testing
+#include "../../src/Core/NullDevice.hpp"
+#include "../../src/Core/TlsfAllocator.hpp"
+
+using namespace VRHI;
+
+// ============================================================================
+// TLSF Allocator Tests
+// ============================================================================
+
+TEST(TlsfAllocatorTest, AllocationsDoNotOverlap) {
+    TlsfAllocator tlsf(4096, 16);
+    const uint64_t a = tlsf.Allocate(100);
+    const uint64_t b = tlsf.Allocate(1);
+    const uint64_t c = tlsf.Allocate(500);
+    ASSERT_NE(a, TlsfAllocator::InvalidOffset);
+    ASSERT_NE(b, TlsfAllocator::InvalidOffset);
+    ASSERT_NE(c, TlsfAllocator::InvalidOffset);
+
+    EXPECT_EQ(tlsf.GetAllocationSize(a), 112u);
+    EXPECT_EQ(tlsf.GetAllocationSize(b), 16u);
+    EXPECT_EQ(tlsf.GetUsedBytes(), 112u + 16u + 512u);
+    for (uint64_t offset : {a, b, c}) {
+        EXPECT_EQ(offset % 16, 0u);
+    }
+    EXPECT_TRUE(a + 112 <= b || b + 16 <= a);
+    EXPECT_TRUE(b + 16 <= c || c + 512 <= b);
+    EXPECT_TRUE(a + 112 <= c || c + 512 <= a);
+}
+
+TEST(TlsfAllocatorTest, AlignmentIsHonored) {
+    TlsfAllocator tlsf(8192, 16);
+    ASSERT_NE(tlsf.Allocate(16), TlsfAllocator::InvalidOffset);
+    const uint64_t aligned = tlsf.Allocate(64, 1024);
+    ASSERT_NE(aligned, TlsfAllocator::InvalidOffset);
+    EXPECT_EQ(aligned % 1024, 0u);
+
+    // The padding in front of the aligned range stays allocatable
+    EXPECT_EQ(tlsf.GetUsedBytes(), 16u + 64u);
+    const uint64_t small = tlsf.Allocate(32);
+    ASSERT_NE(small, TlsfAllocator::InvalidOffset);
+    EXPECT_LT(small, aligned);
+}
+
+TEST(TlsfAllocatorTest, FailsWhenFull) {
+    TlsfAllocator tlsf(256, 16);
+    EXPECT_EQ(tlsf.Allocate(256), 0u);
+    EXPECT_EQ(tlsf.Allocate(16), TlsfAllocator::InvalidOffset);
+    EXPECT_EQ(tlsf.Allocate(0), TlsfAllocator::InvalidOffset);
+}
+
+TEST(TlsfAllocatorTest, FreedNeighboursAreMerged) {
+    TlsfAllocator tlsf(1024, 16);
+    std::array<uint64_t, 4> offsets;
+    for (uint64_t& offset : offsets) {
+        offset = tlsf.Allocate(256);
+        ASSERT_NE(offset, TlsfAllocator::InvalidOffset);
+    }
+    EXPECT_EQ(tlsf.Allocate(16), TlsfAllocator::InvalidOffset);
+
+    // Free out of order; the whole range must coalesce again
+    tlsf.Free(offsets[1]);
+    tlsf.Free(offsets[3]);
+    EXPECT_EQ(tlsf.Allocate(512), TlsfAllocator::InvalidOffset);
+    tlsf.Free(offsets[2]);
+    tlsf.Free(offsets[0]);
+    EXPECT_TRUE(tlsf.IsEmpty());
+    EXPECT_EQ(tlsf.GetUsedBytes(), 0u);
+    EXPECT_EQ(tlsf.Allocate(1024), 0u);
+}
+
+TEST(TlsfAllocatorTest, SurvivesRandomChurn) {
+    constexpr uint64_t Size = 1 << 20;
+    TlsfAllocator tlsf(Size, 16);
+    std::vector<std::pair<uint64_t, uint64_t>> live;  // Offset, size
+    uint32_t seed = 12345;
+    auto next = [&] { return seed = seed * 1664525u + 1013904223u; };
+
+    for (int i = 0; i < 5000; ++i) {
+        if (!live.empty() && next() % 3 == 0) {
+            const size_t index = next() % live.size();
+            tlsf.Free(live[index].first);
+            live[index] = live.back();
+            live.pop_back();
+            continue;
+        }
+        const uint64_t size = 1 + next() % 8192;
+        const uint64_t alignment = 16ull << (next() % 5);
+        const uint64_t offset = tlsf.Allocate(size, alignment);
+        if (offset == TlsfAllocator::InvalidOffset) {
+            continue;
+        }
+        EXPECT_EQ(offset % alignment, 0u);
+        EXPECT_LE(offset + size, Size);
+        for (const auto& [otherOffset, otherSize] : live) {
+            ASSERT_TRUE(offset + size <= otherOffset || otherOffset + otherSize <= offset)
+                << "iteration " << i;
+        }
+        live.emplace_back(offset, size);
+    }
+
+    for (const auto& range : live) {
+        tlsf.Free(range.first);
+    }
+    EXPECT_TRUE(tlsf.IsEmpty());
+    EXPECT_EQ(tlsf.Allocate(Size), 0u);
+}
+
+// ============================================================================
+// Buffer Allocator Tests (NullDevice)
+// ============================================================================
+
+class BufferAllocatorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        device = std::make_unique<NullDevice>();
+    }
+
+    static BufferDesc VertexDesc(size_t size, const void* data = nullptr) {
+        BufferDesc desc;
+        desc.size = size;
+        desc.usage = BufferUsage::Vertex;
+        desc.initialData = data;
+        return desc;
+    }
+
+    std::unique_ptr<Device> device;
+};
+
+TEST_F(BufferAllocatorTest, SubAllocatesFromOneBlock) {
+    BufferAllocator allocator(*device, 64 * 1024);
+    auto a = allocator.Allocate(VertexDesc(1000));
+    auto b = allocator.Allocate(VertexDesc(1000));
+    ASSERT_TRUE(a.has_value());
+    ASSERT_TRUE(b.has_value());
+
+    EXPECT_EQ(a->buffer, b->buffer);
+    EXPECT_NE(a->offset, b->offset);
+    EXPECT_EQ(a->size, 1000u);
+    EXPECT_EQ(allocator.GetBlockCount(), 1u);
+    EXPECT_EQ(allocator.GetReservedBytes(), 64u * 1024u);
+    EXPECT_EQ(allocator.GetAllocatedBytes(), 2u * 1008u);
+
+    allocator.Free(*a);
+    allocator.Free(*b);
+    EXPECT_EQ(allocator.GetAllocatedBytes(), 0u);
+    EXPECT_EQ(allocator.GetBlockCount(), 1u);  // The last block of a class is kept
+}
+
+TEST_F(BufferAllocatorTest, InitialDataLandsAtTheOffset) {
+    BufferAllocator allocator(*device, 64 * 1024);
+    const std::array<uint32_t, 4> first = {1, 2, 3, 4};
+    const std::array<uint32_t, 4> second = {5, 6, 7, 8};
+    auto a = allocator.Allocate(VertexDesc(sizeof(first), first.data()));
+    auto b = allocator.Allocate(VertexDesc(sizeof(second), second.data()));
+    ASSERT_TRUE(a.has_value());
+    ASSERT_TRUE(b.has_value());
+
+    std::array<uint32_t, 4> readback{};
+    b->buffer->Read(readback.data(), sizeof(readback), b->offset);
+    EXPECT_EQ(readback, second);
+    a->buffer->Read(readback.data(), sizeof(readback), a->offset);
+    EXPECT_EQ(readback, first);
+
+    allocator.Free(*a);
+    allocator.Free(*b);
+}
+
+TEST_F(BufferAllocatorTest, ClassesGetSeparateBlocks) {
+    BufferAllocator allocator(*device, 64 * 1024);
+    auto vertices = allocator.Allocate(VertexDesc(256));
+
+    BufferDesc indexDesc;
+    indexDesc.size = 256;
+    indexDesc.usage = BufferUsage::Index;
+    auto indices = allocator.Allocate(indexDesc);
+
+    BufferDesc stagingDesc = VertexDesc(256);
+    stagingDesc.memoryAccess = MemoryAccess::CpuToGpu;
+    auto staging = allocator.Allocate(stagingDesc);
+
+    ASSERT_TRUE(vertices && indices && staging);
+    EXPECT_NE(vertices->buffer, indices->buffer);
+    EXPECT_NE(vertices->buffer, staging->buffer);
+    EXPECT_EQ(indices->buffer->GetUsage(), BufferUsage::Index);
+    EXPECT_EQ(allocator.GetBlockCount(), 3u);
+
+    allocator.Free(*vertices);
+    allocator.Free(*indices);
+    allocator.Free(*staging);
+}
+
+TEST_F(BufferAllocatorTest, ExplicitAlignmentIsHonored) {
+    BufferAllocator allocator(*device, 64 * 1024);
+    BufferDesc desc;
+    desc.size = 64;
+    desc.usage = BufferUsage::Uniform;
+    auto a = allocator.Allocate(desc, 256);
+    auto b = allocator.Allocate(desc, 256);
+    ASSERT_TRUE(a && b);
+    EXPECT_EQ(a->offset % 256, 0u);
+    EXPECT_EQ(b->offset % 256, 0u);
+
+    EXPECT_FALSE(allocator.Allocate(desc, 100).has_value());
+
+    allocator.Free(*a);
+    allocator.Free(*b);
+}
+
+TEST_F(BufferAllocatorTest, FullBlocksAddBlocksAndEmptyOnesAreReleased) {
+    BufferAllocator allocator(*device, 4096);
+    std::vector<BufferView> views;
+    for (int i = 0; i < 12; ++i) {
+        auto view = allocator.Allocate(VertexDesc(1024));
+        ASSERT_TRUE(view.has_value());
+        views.push_back(*view);
+    }
+    EXPECT_EQ(allocator.GetBlockCount(), 3u);
+
+    for (const BufferView& view : views) {
+        allocator.Free(view);
+    }
+    EXPECT_EQ(allocator.GetBlockCount(), 1u);
+    EXPECT_EQ(allocator.GetAllocatedBytes(), 0u);
+}
+
+TEST_F(BufferAllocatorTest, LargeRangesGetDedicatedBuffers) {
+    BufferAllocator allocator(*device, 4096);
+    auto large = allocator.Allocate(VertexDesc(3000));
+    ASSERT_TRUE(large.has_value());
+    EXPECT_EQ(large->offset, 0u);
+    EXPECT_EQ(large->buffer->GetSize(), 3000u);
+    EXPECT_EQ(allocator.GetBlockCount(), 1u);
+
+    allocator.Free(*large);
+    EXPECT_EQ(allocator.GetBlockCount(), 0u);
+}
+
+TEST_F(BufferAllocatorTest, ZeroSizeFails) {
+    BufferAllocator allocator(*device);
+    auto view = allocator.Allocate(VertexDesc(0));
+    ASSERT_FALSE(view.has_value());
+    EXPECT_EQ(view.error().code, Error::Code::InvalidConfig);
+    EXPECT_EQ(allocator.GetBlockCount(), 0u);
+}
+
+TEST_F(BufferAllocatorTest, ViewsBindWithTheirOffset) {
+    auto buffer = device->CreateCommandBuffer();
+    auto* cmd = dynamic_cast<RecordingCommandBuffer*>(buffer.get());
+    ASSERT_NE(cmd, nullptr);
+
+    BufferAllocator allocator(*device, 64 * 1024);
+    std::array<BufferView, 2> vertices = {*allocator.Allocate(VertexDesc(64)), *allocator.Allocate(VertexDesc(64))};
+    BufferDesc uniformDesc;
+    uniformDesc.size = 48;
+    uniformDesc.usage = BufferUsage::Uniform;
+    BufferView constants = *allocator.Allocate(uniformDesc);
+
+    cmd->Begin();
+    cmd->BindVertexBuffers(2, vertices);
+    cmd->BindIndexBuffer(vertices[1], true);
+    cmd->BindUniformBuffer(3, constants);
+    cmd->End();
+
+    auto it = cmd->GetCommandStream().begin();
+    const auto& bindVertices = it->As<CmdBindVertexBuffers>();
+    EXPECT_EQ(bindVertices.firstBinding, 2u);
+    ASSERT_EQ(bindVertices.GetBuffers().size(), 2u);
+    EXPECT_EQ(bindVertices.GetBuffers()[1], vertices[1].buffer);
+    EXPECT_EQ(bindVertices.GetOffsets()[0], vertices[0].offset);
+    EXPECT_EQ(bindVertices.GetOffsets()[1], vertices[1].offset);
+
+    const auto& bindIndices = (++it)->As<CmdBindIndexBuffer>();
+    EXPECT_EQ(bindIndices.offset, vertices[1].offset);
+    EXPECT_TRUE(bindIndices.use16BitIndices);
+
+    const auto& bindConstants = (++it)->As<CmdBindUniformBuffer>();
+    EXPECT_EQ(bindConstants.binding, 3u);
+    EXPECT_EQ(bindConstants.buffer, constants.buffer);
+    EXPECT_EQ(bindConstants.offset, constants.offset);
+    EXPECT_EQ(bindConstants.size, 48u);
+
+    allocator.Free(vertices[0]);
+    allocator.Free(vertices[1]);
+    allocator.Free(constants);
+}
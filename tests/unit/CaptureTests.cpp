@@ -0,0 +1,408 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include <VRHI/VRHIAll.hpp>
+#include <VRHI/RecordingCommandBuffer.hpp>
+#include <gtest/gtest.h>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+// Include internal headers for testing
+#include "../../src/Core/CommandDecoder.hpp"
+#include "../../src/Core/NullDevice.hpp"
+
+using namespace VRHI;
+
+namespace {
+
+class TestCommandBuffer : public RecordingCommandBuffer {
+public:
+    explicit TestCommandBuffer(CommandBufferLevel level = CommandBufferLevel::Primary)
+        : RecordingCommandBuffer(level) {}
+};
+
+// Fake resource pointers; neither recording nor decoding dereferences them
+template<typename T>
+T* Fake(uintptr_t id) { return reinterpret_cast<T*>(id * 16); }
+
+std::vector<std::pair<CommandType, uint32_t>> CollectHeaders(const CommandStream& stream) {
+    std::vector<std::pair<CommandType, uint32_t>> headers;
+    for (const CommandHeader& header : stream) {
+        headers.emplace_back(header.type, header.size);
+    }
+    return headers;
+}
+
+void RecordEveryCommand(CommandBuffer& cmd, CommandBuffer* secondary) {
+    Buffer* const vertexBuffers[] = {Fake<Buffer>(1), Fake<Buffer>(2)};
+    const uint64_t offsets[] = {0, 64};
+    const float color[4] = {1.0f, 0.0f, 0.0f, 1.0f};
+    CommandBuffer* const secondaries[] = {secondary};
+    ClearValue clearValues[2] = {};
+    clearValues[0].color.float32[2] = 0.5f;
+    clearValues[1].depthStencil = {0.25f, 7};
+
+    cmd.Begin();
+    cmd.BeginRenderPass(Fake<RenderPass>(3), Fake<Framebuffer>(4), Rect2D{0, 0, 64, 64}, clearValues);
+    cmd.BindPipeline(Fake<Pipeline>(5));
+    cmd.BindVertexBuffers(0, vertexBuffers, offsets);
+    cmd.BindIndexBuffer(Fake<Buffer>(6), 0, true);
+    cmd.BindUniformBuffer(0, Fake<Buffer>(7), 0, 256);
+    cmd.BindStorageBuffer(2, Fake<Buffer>(7), 256, 512);
+    cmd.BindTexture(1, Fake<Texture>(8), Fake<Sampler>(9));
+    const uint32_t pushData[] = {1, 2, 3, 4};
+    cmd.PushConstants(ShaderStage::Vertex | ShaderStage::Fragment, 16, std::as_bytes(std::span(pushData)));
+    cmd.SetViewport(Viewport{0.0f, 0.0f, 64.0f, 64.0f});
+    cmd.SetScissor(Rect2D{0, 0, 64, 64});
+    cmd.SetLineWidth(2.0f);
+    cmd.SetBlendConstants(color);
+    cmd.SetDepthBias(1.0f, 0.0f, 1.0f);
+    cmd.SetDepthBounds(0.0f, 1.0f);
+    cmd.SetStencilCompareMask(true, 0xFF);
+    cmd.SetStencilWriteMask(true, 0x0F);
+    cmd.SetStencilReference(false, 1);
+    cmd.ClearColorAttachment(0, ClearColorValue{}, Rect2D{0, 0, 64, 64});
+    cmd.ClearDepthStencilAttachment(ClearDepthStencilValue{}, Rect2D{0, 0, 64, 64});
+    cmd.Draw(3);
+    cmd.DrawIndexed(36, 2, 0, 0, 0);
+    cmd.DrawIndirect(Fake<Buffer>(10), 0, 1, 16);
+    cmd.DrawIndexedIndirect(Fake<Buffer>(10), 16, 1, 20);
+    cmd.BeginDebugMarker("Pass", color);
+    cmd.InsertDebugMarker("Marker");
+    cmd.EndDebugMarker();
+    cmd.ExecuteCommands(secondaries);
+    cmd.EndRenderPass();
+    cmd.Dispatch(4, 4, 1);
+    cmd.DispatchIndirect(Fake<Buffer>(10), 32);
+    cmd.CopyBuffer(Fake<Buffer>(1), Fake<Buffer>(2), 0, 0, 64);
+    cmd.CopyBufferToTexture(Fake<Buffer>(1), Fake<Texture>(8));
+    cmd.CopyTextureToBuffer(Fake<Texture>(8), Fake<Buffer>(1));
+    cmd.CopyTexture(Fake<Texture>(8), Fake<Texture>(11));
+    cmd.PipelineBarrier();
+    cmd.End();
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// Command Decoder Tests
+// ============================================================================
+
+TEST(CommandDecoderTest, DecodeReproducesRecording) {
+    TestCommandBuffer secondary(CommandBufferLevel::Secondary);
+    secondary.Begin();
+    secondary.End();
+
+    TestCommandBuffer original;
+    RecordEveryCommand(original, &secondary);
+
+    TestCommandBuffer decoded;
+    decoded.Begin();
+    DecodeCommands(original.GetCommandStream().GetData(), decoded);
+    decoded.End();
+
+    EXPECT_EQ(CollectHeaders(decoded.GetCommandStream()), CollectHeaders(original.GetCommandStream()));
+
+    for (const CommandHeader& header : decoded.GetCommandStream()) {
+        if (header.type == CommandType::BeginRenderPass) {
+            const auto clearValues = header.As<CmdBeginRenderPass>().GetClearValues();
+            ASSERT_EQ(clearValues.size(), 2u);
+            EXPECT_EQ(clearValues[0].color.float32[2], 0.5f);
+            EXPECT_EQ(clearValues[1].depthStencil.depth, 0.25f);
+            EXPECT_EQ(clearValues[1].depthStencil.stencil, 7u);
+        } else if (header.type == CommandType::BindVertexBuffers) {
+            const auto& cmd = header.As<CmdBindVertexBuffers>();
+            EXPECT_EQ(cmd.GetBuffers()[1], Fake<Buffer>(2));
+            EXPECT_EQ(cmd.GetOffsets()[1], 64u);
+        } else if (header.type == CommandType::BindStorageBuffer) {
+            const auto& cmd = header.As<CmdBindStorageBuffer>();
+            EXPECT_EQ(cmd.binding, 2u);
+            EXPECT_EQ(cmd.offset, 256u);
+            EXPECT_EQ(cmd.size, 512u);
+        } else if (header.type == CommandType::BeginDebugMarker) {
+            EXPECT_STREQ(header.As<CmdBeginDebugMarker>().GetName(), "Pass");
+            EXPECT_TRUE(header.As<CmdBeginDebugMarker>().hasColor);
+        } else if (header.type == CommandType::DrawIndexed) {
+            EXPECT_EQ(header.As<CmdDrawIndexed>().params.indexCount, 36u);
+            EXPECT_EQ(header.As<CmdDrawIndexed>().params.instanceCount, 2u);
+        } else if (header.type == CommandType::ExecuteCommands) {
+            EXPECT_EQ(header.As<CmdExecuteCommands>().GetCommandBuffers()[0], &secondary);
+        } else if (header.type == CommandType::PushConstants) {
+            const auto& cmd = header.As<CmdPushConstants>();
+            EXPECT_EQ(cmd.offset, 16u);
+            ASSERT_EQ(cmd.GetData().size(), 16u);
+            EXPECT_EQ(static_cast<uint8_t>(cmd.GetData()[12]), 4u);
+        }
+    }
+}
+
+TEST(CommandDecoderTest, RemapVisitsEveryReference) {
+    TestCommandBuffer secondary(CommandBufferLevel::Secondary);
+    secondary.Begin();
+    secondary.End();
+
+    TestCommandBuffer cmd;
+    RecordEveryCommand(cmd, &secondary);
+
+    const auto data = cmd.GetCommandStream().GetData();
+    std::vector<std::byte> copy(data.begin(), data.end());
+    size_t references = 0;
+    RemapCommandResources(copy, [&](auto*& object) {
+        if (object) {
+            ++references;
+        }
+        object = nullptr;
+    });
+
+    // Every pointer recorded above: render pass and framebuffer, pipeline, 2 vertex,
+    // index, uniform and storage buffers, texture and sampler, 3 indirect
+    // buffers, the secondary and 2 per copy command
+    EXPECT_EQ(references, 22u);
+
+    size_t remaining = 0;
+    RemapCommandResources(copy, [&](auto*& object) { remaining += object != nullptr; });
+    EXPECT_EQ(remaining, 0u);
+}
+
+// ============================================================================
+// Capture and Replay Tests
+// ============================================================================
+
+namespace {
+
+/// Null device that keeps track of what the trace player creates on it
+class InspectingDevice : public NullDevice {
+public:
+    std::expected<std::unique_ptr<Buffer>, Error>
+    CreateBuffer(const BufferDesc& desc) override {
+        auto buffer = NullDevice::CreateBuffer(desc);
+        if (buffer) {
+            buffers.push_back(buffer->get());
+        }
+        return buffer;
+    }
+
+    std::unique_ptr<CommandBuffer> CreateCommandBuffer(CommandBufferLevel level) override {
+        auto cmd = NullDevice::CreateCommandBuffer(level);
+        commandBuffers.push_back(static_cast<RecordingCommandBuffer*>(cmd.get()));
+        return cmd;
+    }
+
+    void Present() override { ++presentCount; }
+
+    std::vector<Buffer*> buffers;
+    std::vector<RecordingCommandBuffer*> commandBuffers;
+    uint32_t presentCount = 0;
+};
+
+class CaptureTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        tracePath = std::filesystem::temp_directory_path() /
+                    (std::string("vrhi_") + info->name() + ".vrhitrace");
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove(tracePath, ec);
+    }
+
+    /// Capture a small application: static setup, a secondary recorded once,
+    /// and `frameCount` frames that update a uniform buffer and draw
+    void CaptureFrames(uint32_t frameCount) {
+        auto captureResult = CreateCaptureDevice(std::make_unique<NullDevice>(), tracePath);
+        ASSERT_TRUE(captureResult.has_value());
+        auto& device = *captureResult;
+
+        const std::array<float, 9> vertices{};
+        BufferDesc vertexDesc;
+        vertexDesc.size = sizeof(vertices);
+        vertexDesc.initialData = vertices.data();
+        auto vertexBuffer = device->CreateBuffer(vertexDesc);
+        ASSERT_TRUE(vertexBuffer.has_value());
+
+        BufferDesc uniformDesc;
+        uniformDesc.size = 64;
+        uniformDesc.usage = BufferUsage::Uniform;
+        auto uniformBuffer = device->CreateBuffer(uniformDesc);
+        ASSERT_TRUE(uniformBuffer.has_value());
+
+        const std::array<uint8_t, 16> pixels{};
+        TextureDesc textureDesc;
+        textureDesc.width = 2;
+        textureDesc.height = 2;
+        textureDesc.initialData = pixels.data();
+        auto texture = device->CreateTexture(textureDesc);
+        ASSERT_TRUE(texture.has_value());
+
+        auto sampler = device->CreateSampler(SamplerDesc{});
+        ASSERT_TRUE(sampler.has_value());
+
+        const char source[] = "#version 330 core\nvoid main() {}\n";
+        ShaderDesc shaderDesc;
+        shaderDesc.code = source;
+        shaderDesc.codeSize = sizeof(source) - 1;
+        auto vertexShader = device->CreateShader(shaderDesc);
+        shaderDesc.stage = ShaderStage::Fragment;
+        auto fragmentShader = device->CreateShader(shaderDesc);
+        ASSERT_TRUE(vertexShader.has_value() && fragmentShader.has_value());
+
+        const VertexAttribute attributes[] = {{0, 0, VertexFormat::Float3, 0}};
+        const VertexBinding bindings[] = {{0, 12, VertexInputRate::Vertex}};
+        PipelineDesc pipelineDesc;
+        pipelineDesc.graphics.vertexShader = vertexShader->get();
+        pipelineDesc.graphics.fragmentShader = fragmentShader->get();
+        pipelineDesc.graphics.vertexInput.attributes = attributes;
+        pipelineDesc.graphics.vertexInput.bindings = bindings;
+        auto pipeline = device->CreatePipeline(pipelineDesc);
+        ASSERT_TRUE(pipeline.has_value());
+
+        auto secondary = device->CreateCommandBuffer(CommandBufferLevel::Secondary);
+        secondary->Begin();
+        secondary->Draw(3);
+        secondary->End();
+
+        auto pool = device->CreateCommandPool();
+        Buffer* const vertexBuffers[] = {vertexBuffer->get()};
+        CommandBuffer* const secondaries[] = {secondary.get()};
+        for (uint32_t frame = 0; frame < frameCount; ++frame) {
+            const std::array<float, 16> uniforms{static_cast<float>(frame)};
+            (*uniformBuffer)->Update(uniforms.data(), sizeof(uniforms));
+
+            pool->Reset();
+            CommandBuffer* cmd = pool->Allocate();
+            cmd->Begin();
+            cmd->BindPipeline(pipeline->get());
+            cmd->BindVertexBuffers(0, vertexBuffers);
+            cmd->BindUniformBuffer(0, uniformBuffer->get());
+            cmd->BindTexture(1, texture->get(), sampler->get());
+            cmd->ExecuteCommands(secondaries);
+            cmd->End();
+            device->Submit(cmd);
+            device->Present();
+        }
+
+        // Captured resources forward to the inner device
+        std::array<float, 16> readBack{};
+        (*uniformBuffer)->Read(readBack.data(), sizeof(readBack));
+        EXPECT_EQ(readBack[0], static_cast<float>(frameCount - 1));
+    }
+
+    std::filesystem::path tracePath;
+};
+
+} // anonymous namespace
+
+TEST_F(CaptureTest, TraceDescribesCapturedFrames) {
+    CaptureFrames(3);
+
+    auto player = TracePlayer::Load(tracePath);
+    ASSERT_TRUE(player.has_value()) << player.error().message;
+
+    const TraceStats& stats = (*player)->GetStats();
+    EXPECT_EQ(stats.frameCount, 3u);
+    EXPECT_EQ(stats.resourceCount, 7u);       // 2 buffers, texture, sampler, 2 shaders, pipeline
+    EXPECT_EQ(stats.commandBufferCount, 2u);  // Pooled primary and the secondary
+    EXPECT_EQ(stats.commandCount, 1u + 3u * 5u);
+    EXPECT_EQ(stats.uploadBytes, 3u * 64u);
+}
+
+TEST_F(CaptureTest, ReplayRecreatesResourcesAndCommands) {
+    CaptureFrames(2);
+
+    auto player = TracePlayer::Load(tracePath);
+    ASSERT_TRUE(player.has_value()) << player.error().message;
+
+    InspectingDevice device;
+    auto prepared = (*player)->Prepare(device);
+    ASSERT_TRUE(prepared.has_value()) << prepared.error().message;
+    ASSERT_EQ(device.buffers.size(), 2u);
+    ASSERT_EQ(device.commandBuffers.size(), 2u);
+
+    // Frames can be replayed repeatedly and in any order
+    for (uint32_t loop = 0; loop < 3; ++loop) {
+        (*player)->ReplayFrame(1);
+        (*player)->ReplayFrame(0);
+    }
+    EXPECT_EQ(device.presentCount, 6u);
+
+    // The secondary was created first, the pooled primary second
+    RecordingCommandBuffer* secondary = device.commandBuffers[0];
+    RecordingCommandBuffer* primary = device.commandBuffers[1];
+    EXPECT_EQ(secondary->GetLevel(), CommandBufferLevel::Secondary);
+    EXPECT_EQ(primary->GetState(), CommandBufferState::Submitted);
+
+    // Recorded references point at the replay device's objects
+    size_t checked = 0;
+    for (const CommandHeader& header : primary->GetCommandStream()) {
+        if (header.type == CommandType::BindVertexBuffers) {
+            EXPECT_EQ(header.As<CmdBindVertexBuffers>().GetBuffers()[0], device.buffers[0]);
+            ++checked;
+        } else if (header.type == CommandType::BindUniformBuffer) {
+            EXPECT_EQ(header.As<CmdBindUniformBuffer>().buffer, device.buffers[1]);
+            ++checked;
+        } else if (header.type == CommandType::ExecuteCommands) {
+            EXPECT_EQ(header.As<CmdExecuteCommands>().GetCommandBuffers()[0], secondary);
+            ++checked;
+        }
+    }
+    EXPECT_EQ(checked, 3u);
+
+    // The last replayed frame's uniform upload reached the buffer
+    std::array<float, 16> uniforms{};
+    device.buffers[1]->Read(uniforms.data(), sizeof(uniforms));
+    EXPECT_EQ(uniforms[0], 0.0f);
+}
+
+TEST_F(CaptureTest, ReplayOnCaptureDeviceReproducesTrace) {
+    CaptureFrames(2);
+
+    auto player = TracePlayer::Load(tracePath);
+    ASSERT_TRUE(player.has_value()) << player.error().message;
+
+    const auto recapturePath = tracePath.string() + ".recapture";
+    {
+        auto recapture = CreateCaptureDevice(std::make_unique<NullDevice>(), recapturePath);
+        ASSERT_TRUE(recapture.has_value());
+        ASSERT_TRUE((*player)->Prepare(**recapture).has_value());
+        (*player)->ReplayFrame(0);
+        (*player)->ReplayFrame(1);
+        player->reset();
+    }
+
+    auto replayed = TracePlayer::Load(recapturePath);
+    ASSERT_TRUE(replayed.has_value()) << replayed.error().message;
+    const TraceStats& stats = (*replayed)->GetStats();
+    EXPECT_EQ(stats.frameCount, 2u);
+    EXPECT_EQ(stats.resourceCount, 7u);
+    EXPECT_EQ(stats.commandBufferCount, 2u);
+    // The secondary is re-recorded in frame 0 of the replay as in the capture
+    EXPECT_EQ(stats.commandCount, 1u + 2u * 5u);
+    EXPECT_EQ(stats.uploadBytes, 2u * 64u);
+
+    std::error_code ec;
+    std::filesystem::remove(recapturePath, ec);
+}
+
+TEST_F(CaptureTest, LoadRejectsInvalidFiles) {
+    EXPECT_FALSE(TracePlayer::Load(tracePath).has_value());
+
+    {
+        std::ofstream file(tracePath, std::ios::binary);
+        file << "definitely not a trace";
+    }
+    auto result = TracePlayer::Load(tracePath);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, Error::Code::ValidationError);
+}
+
+TEST(CaptureDeviceTest, RequiresDevice) {
+    auto result = CreateCaptureDevice(nullptr, std::filesystem::temp_directory_path() / "vrhi_unused.vrhitrace");
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, Error::Code::InvalidConfig);
+}
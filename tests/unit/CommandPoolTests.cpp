@@ -0,0 +1,138 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include "MockBackend.hpp"
+#include <VRHI/VRHIAll.hpp>
+#include <VRHI/RecordingCommandBuffer.hpp>
+#include <gtest/gtest.h>
+
+// Include internal headers for testing
+#include "../../src/Core/NullDevice.hpp"
+
+using namespace VRHI;
+
+// ============================================================================
+// Command Pool Tests (NullDevice)
+// ============================================================================
+
+class CommandPoolTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        device = std::make_unique<NullDevice>();
+        pool = device->CreateCommandPool();
+        ASSERT_NE(pool, nullptr);
+    }
+
+    static void RecordFrame(CommandBuffer* cmd, uint32_t drawCount) {
+        cmd->Begin();
+        for (uint32_t i = 0; i < drawCount; ++i) {
+            cmd->Draw(3);
+        }
+        cmd->End();
+    }
+
+    std::unique_ptr<Device> device;
+    std::unique_ptr<CommandPool> pool;
+};
+
+TEST_F(CommandPoolTest, AllocateReturnsInitialBuffer) {
+    CommandBuffer* cmd = pool->Allocate();
+    ASSERT_NE(cmd, nullptr);
+    EXPECT_EQ(cmd->GetState(), CommandBufferState::Initial);
+    EXPECT_EQ(pool->GetAllocatedCount(), 1u);
+    EXPECT_EQ(pool->GetCapacity(), 1u);
+}
+
+TEST_F(CommandPoolTest, AllocateHandsOutDistinctBuffers) {
+    CommandBuffer* a = pool->Allocate();
+    CommandBuffer* b = pool->Allocate();
+    EXPECT_NE(a, b);
+    EXPECT_EQ(pool->GetAllocatedCount(), 2u);
+}
+
+TEST_F(CommandPoolTest, ResetRecyclesBuffers) {
+    CommandBuffer* a = pool->Allocate();
+    CommandBuffer* b = pool->Allocate();
+    RecordFrame(a, 4);
+    device->Submit(a);
+    EXPECT_EQ(a->GetState(), CommandBufferState::Submitted);
+
+    pool->Reset();
+    EXPECT_EQ(pool->GetAllocatedCount(), 0u);
+    EXPECT_EQ(pool->GetCapacity(), 2u);
+
+    // The same buffers come back, ready to record again
+    EXPECT_EQ(pool->Allocate(), a);
+    EXPECT_EQ(pool->Allocate(), b);
+    EXPECT_EQ(a->GetState(), CommandBufferState::Initial);
+    EXPECT_EQ(pool->GetCapacity(), 2u);
+}
+
+TEST_F(CommandPoolTest, RecordingMemoryIsKeptAcrossFrames) {
+    CommandBuffer* cmd = pool->Allocate();
+    RecordFrame(cmd, 1000);
+    device->Submit(cmd);
+
+    auto* recording = static_cast<RecordingCommandBuffer*>(cmd);
+    const size_t warmCapacity = recording->GetCommandStream().GetCapacity();
+    EXPECT_GT(warmCapacity, 0u);
+
+    for (int frame = 0; frame < 3; ++frame) {
+        pool->Reset();
+        CommandBuffer* reused = pool->Allocate();
+        ASSERT_EQ(reused, cmd);
+        RecordFrame(reused, 1000);
+        device->Submit(reused);
+        EXPECT_EQ(recording->GetCommandStream().GetCapacity(), warmCapacity);
+        EXPECT_EQ(recording->GetCommandStream().GetCommandCount(), 1000u);
+    }
+}
+
+TEST_F(CommandPoolTest, LevelsArePooledSeparately) {
+    CommandBuffer* primary = pool->Allocate();
+    CommandBuffer* secondary = pool->Allocate(CommandBufferLevel::Secondary);
+    EXPECT_EQ(primary->GetLevel(), CommandBufferLevel::Primary);
+    EXPECT_EQ(secondary->GetLevel(), CommandBufferLevel::Secondary);
+    EXPECT_EQ(pool->GetAllocatedCount(), 2u);
+
+    pool->Reset();
+    EXPECT_EQ(pool->Allocate(CommandBufferLevel::Secondary), secondary);
+    EXPECT_EQ(pool->Allocate(), primary);
+}
+
+TEST_F(CommandPoolTest, SubmitDoesNotTakeOwnership) {
+    CommandBuffer* cmd = pool->Allocate();
+    RecordFrame(cmd, 1);
+    device->Submit(cmd);
+
+    // Still owned by the pool and usable
+    cmd->Begin();
+    EXPECT_EQ(cmd->GetState(), CommandBufferState::Recording);
+    cmd->End();
+}
+
+// ============================================================================
+// Command Pool Tests (Mock Device)
+// ============================================================================
+
+TEST(MockCommandPoolTest, SubmitSignalsFence) {
+    Mock::MockBackend backend;
+    auto result = backend.CreateDevice(DeviceConfig{});
+    ASSERT_TRUE(result.has_value());
+    auto& device = result.value();
+
+    auto pool = device->CreateCommandPool();
+    auto fence = device->CreateFence(false);
+
+    CommandBuffer* cmd = pool->Allocate();
+    ASSERT_NE(cmd, nullptr);
+    cmd->Begin();
+    cmd->Draw(3);
+    cmd->End();
+    device->Submit(cmd, fence.get());
+    EXPECT_TRUE(fence->IsSignaled());
+
+    fence->Reset();
+    pool->Reset();
+    EXPECT_EQ(pool->Allocate(), cmd);
+}
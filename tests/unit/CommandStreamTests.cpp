@@ -0,0 +1,362 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <VRHI/VRHI.hpp>
+#include <VRHI/CommandBuffer.hpp>
+#include <VRHI/RecordingCommandBuffer.hpp>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace VRHI;
+
+namespace {
+
+/// Recording command buffer without a backend, used to inspect the encoded stream
+class TestCommandBuffer : public RecordingCommandBuffer {
+public:
+    explicit TestCommandBuffer(CommandBufferLevel level = CommandBufferLevel::Primary)
+        : RecordingCommandBuffer(level) {}
+};
+
+std::vector<CommandType> CollectTypes(const CommandStream& stream) {
+    std::vector<CommandType> types;
+    for (const CommandHeader& header : stream) {
+        types.push_back(header.type);
+    }
+    return types;
+}
+
+// Fake resource pointers; the stream never dereferences them
+Buffer* FakeBuffer(uintptr_t id) { return reinterpret_cast<Buffer*>(id * 16); }
+Pipeline* FakePipeline(uintptr_t id) { return reinterpret_cast<Pipeline*>(id * 16); }
+
+} // anonymous namespace
+
+// ============================================================================
+// Command Stream Tests
+// ============================================================================
+
+TEST(CommandStreamTest, EmptyByDefault) {
+    CommandStream stream;
+    EXPECT_TRUE(stream.IsEmpty());
+    EXPECT_EQ(stream.GetCommandCount(), 0);
+    EXPECT_EQ(stream.GetSize(), 0);
+    EXPECT_EQ(stream.begin(), stream.end());
+}
+
+TEST(CommandStreamTest, CommandsAreAligned) {
+    CommandStream stream;
+    stream.Emit<CmdSetLineWidth>().width = 2.0f;
+    stream.Emit<CmdDraw>().params.vertexCount = 3;
+    
+    for (const CommandHeader& header : stream) {
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(&header) % CommandStream::Alignment, 0u);
+        EXPECT_EQ(header.size % CommandStream::Alignment, 0u);
+    }
+}
+
+TEST(CommandStreamTest, ResetKeepsCapacity) {
+    CommandStream stream;
+    for (int i = 0; i < 100; ++i) {
+        stream.Emit<CmdDraw>();
+    }
+    const size_t capacity = stream.GetCapacity();
+    EXPECT_GT(capacity, 0u);
+    
+    stream.Reset();
+    EXPECT_TRUE(stream.IsEmpty());
+    EXPECT_EQ(stream.GetCapacity(), capacity);
+}
+
+TEST(CommandStreamTest, GrowthPreservesRecordedCommands) {
+    CommandStream stream;
+    constexpr uint32_t count = 10000;  // Forces several reallocations
+    for (uint32_t i = 0; i < count; ++i) {
+        stream.Emit<CmdDraw>().params.vertexCount = i;
+    }
+    
+    ASSERT_EQ(stream.GetCommandCount(), count);
+    uint32_t expected = 0;
+    for (const CommandHeader& header : stream) {
+        ASSERT_EQ(header.type, CommandType::Draw);
+        EXPECT_EQ(header.As<CmdDraw>().params.vertexCount, expected++);
+    }
+    EXPECT_EQ(expected, count);
+}
+
+// ============================================================================
+// Recording Command Buffer Tests
+// ============================================================================
+
+TEST(RecordingCommandBufferTest, StateTransitions) {
+    TestCommandBuffer cmd;
+    EXPECT_EQ(cmd.GetState(), CommandBufferState::Initial);
+    
+    cmd.Begin();
+    EXPECT_EQ(cmd.GetState(), CommandBufferState::Recording);
+    
+    cmd.End();
+    EXPECT_EQ(cmd.GetState(), CommandBufferState::Executable);
+    
+    cmd.Reset();
+    EXPECT_EQ(cmd.GetState(), CommandBufferState::Initial);
+    EXPECT_TRUE(cmd.GetCommandStream().IsEmpty());
+}
+
+TEST(RecordingCommandBufferTest, RecordsCommandsInOrder) {
+    TestCommandBuffer cmd;
+    cmd.Begin();
+    cmd.ClearColorAttachment(0, ClearColorValue(0.1f, 0.2f, 0.3f, 1.0f), Rect2D{0, 0, 64, 64});
+    cmd.SetViewport(Viewport{0.0f, 0.0f, 64.0f, 64.0f, 0.0f, 1.0f});
+    cmd.BindPipeline(FakePipeline(1));
+    cmd.DrawIndexed(36, 2, 6, -4, 1);
+    cmd.End();
+    
+    const auto& stream = cmd.GetCommandStream();
+    EXPECT_EQ(CollectTypes(stream), (std::vector<CommandType>{
+        CommandType::ClearColorAttachment,
+        CommandType::SetViewports,
+        CommandType::BindPipeline,
+        CommandType::DrawIndexed,
+    }));
+    
+    auto it = stream.begin();
+    EXPECT_FLOAT_EQ(it->As<CmdClearColorAttachment>().color.float32[2], 0.3f);
+    ++it;
+    ASSERT_EQ(it->As<CmdSetViewports>().GetViewports().size(), 1u);
+    EXPECT_FLOAT_EQ(it->As<CmdSetViewports>().GetViewports()[0].width, 64.0f);
+    ++it;
+    EXPECT_EQ(it->As<CmdBindPipeline>().pipeline, FakePipeline(1));
+    ++it;
+    const auto& draw = it->As<CmdDrawIndexed>().params;
+    EXPECT_EQ(draw.indexCount, 36u);
+    EXPECT_EQ(draw.instanceCount, 2u);
+    EXPECT_EQ(draw.firstIndex, 6u);
+    EXPECT_EQ(draw.vertexOffset, -4);
+    EXPECT_EQ(draw.firstInstance, 1u);
+}
+
+TEST(RecordingCommandBufferTest, VertexBufferSpansAreCopied) {
+    TestCommandBuffer cmd;
+    std::array<Buffer*, 3> buffers = {FakeBuffer(1), FakeBuffer(2), FakeBuffer(3)};
+    std::array<uint64_t, 2> offsets = {16, 32};  // Shorter than buffers: rest defaults to 0
+    
+    cmd.Begin();
+    cmd.BindVertexBuffers(1, buffers, offsets);
+    cmd.End();
+    
+    // Mutating the caller's arrays must not affect the recording
+    buffers.fill(nullptr);
+    offsets.fill(0);
+    
+    const auto& bind = cmd.GetCommandStream().begin()->As<CmdBindVertexBuffers>();
+    EXPECT_EQ(bind.firstBinding, 1u);
+    ASSERT_EQ(bind.GetBuffers().size(), 3u);
+    EXPECT_EQ(bind.GetBuffers()[0], FakeBuffer(1));
+    EXPECT_EQ(bind.GetBuffers()[2], FakeBuffer(3));
+    EXPECT_EQ(bind.GetOffsets()[0], 16u);
+    EXPECT_EQ(bind.GetOffsets()[1], 32u);
+    EXPECT_EQ(bind.GetOffsets()[2], 0u);
+}
+
+TEST(RecordingCommandBufferTest, DebugMarkerNameIsCopied) {
+    TestCommandBuffer cmd;
+    char name[] = "Shadow Pass";
+    const float color[4] = {1.0f, 0.5f, 0.0f, 1.0f};
+    
+    cmd.Begin();
+    cmd.BeginDebugMarker(name, color);
+    cmd.InsertDebugMarker(nullptr);
+    cmd.EndDebugMarker();
+    cmd.End();
+    std::strcpy(name, "overwritten");
+    
+    auto it = cmd.GetCommandStream().begin();
+    const auto& begin = it->As<CmdBeginDebugMarker>();
+    EXPECT_STREQ(begin.GetName(), "Shadow Pass");
+    EXPECT_TRUE(begin.hasColor);
+    EXPECT_FLOAT_EQ(begin.color[1], 0.5f);
+    ++it;
+    EXPECT_STREQ(it->As<CmdInsertDebugMarker>().GetName(), "");
+    EXPECT_FALSE(it->As<CmdInsertDebugMarker>().hasColor);
+    ++it;
+    EXPECT_EQ(it->type, CommandType::EndDebugMarker);
+}
+
+TEST(RecordingCommandBufferTest, PushConstantDataIsCopied) {
+    TestCommandBuffer cmd;
+    float values[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+    
+    cmd.Begin();
+    cmd.PushConstants(ShaderStage::Vertex, 64, std::as_bytes(std::span(values)));
+    cmd.End();
+    values[0] = 0.0f;
+    
+    const auto& push = cmd.GetCommandStream().begin()->As<CmdPushConstants>();
+    EXPECT_EQ(push.stages, ShaderStage::Vertex);
+    EXPECT_EQ(push.offset, 64u);
+    ASSERT_EQ(push.GetData().size(), sizeof(values));
+    float recorded[4] = {};
+    std::memcpy(recorded, push.GetData().data(), sizeof(recorded));
+    EXPECT_FLOAT_EQ(recorded[0], 1.0f);
+    EXPECT_FLOAT_EQ(recorded[3], 4.0f);
+}
+
+TEST(RecordingCommandBufferTest, PushConstantsBeyondBlockAreDropped) {
+    TestCommandBuffer cmd;
+    const std::array<std::byte, 32> data{};
+    
+    cmd.Begin();
+    cmd.PushConstants(ShaderStage::Fragment, MaxPushConstantSize - 16, data);
+    cmd.PushConstants(ShaderStage::Fragment, MaxPushConstantSize - 32, data);
+    cmd.End();
+    
+    EXPECT_EQ(cmd.GetCommandStream().GetCommandCount(), 1u);
+}
+
+TEST(RecordingCommandBufferTest, BeginDiscardsPreviousRecording) {
+    TestCommandBuffer cmd;
+    cmd.Begin();
+    cmd.Draw(3);
+    cmd.Draw(6);
+    cmd.End();
+    EXPECT_EQ(cmd.GetCommandStream().GetCommandCount(), 2u);
+    
+    cmd.Begin();
+    cmd.Dispatch(4, 4, 1);
+    cmd.End();
+    
+    const auto& stream = cmd.GetCommandStream();
+    ASSERT_EQ(stream.GetCommandCount(), 1u);
+    const auto& dispatch = stream.begin()->As<CmdDispatch>().params;
+    EXPECT_EQ(dispatch.groupCountX, 4u);
+    EXPECT_EQ(dispatch.groupCountY, 4u);
+    EXPECT_EQ(dispatch.groupCountZ, 1u);
+}
+
+TEST(RecordingCommandBufferTest, RecordingIsThreadAgnostic) {
+    // Command buffers only touch their own arena, so they can be recorded in parallel
+    std::array<TestCommandBuffer, 4> buffers;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < buffers.size(); ++t) {
+        threads.emplace_back([&cmd = buffers[t], t]() {
+            cmd.Begin();
+            for (uint32_t i = 0; i < 1000; ++i) {
+                cmd.Draw(static_cast<uint32_t>(t), 1, i, 0);
+            }
+            cmd.End();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    for (size_t t = 0; t < buffers.size(); ++t) {
+        const auto& stream = buffers[t].GetCommandStream();
+        ASSERT_EQ(stream.GetCommandCount(), 1000u);
+        uint32_t i = 0;
+        for (const CommandHeader& header : stream) {
+            EXPECT_EQ(header.As<CmdDraw>().params.vertexCount, t);
+            EXPECT_EQ(header.As<CmdDraw>().params.firstVertex, i++);
+        }
+    }
+}
+
+// ============================================================================
+// Secondary Command Buffer Tests
+// ============================================================================
+
+TEST(SecondaryCommandBufferTest, LevelIsReported) {
+    TestCommandBuffer primary;
+    TestCommandBuffer secondary(CommandBufferLevel::Secondary);
+    EXPECT_EQ(primary.GetLevel(), CommandBufferLevel::Primary);
+    EXPECT_EQ(secondary.GetLevel(), CommandBufferLevel::Secondary);
+}
+
+TEST(SecondaryCommandBufferTest, ExecuteCommandsReferencesSecondaries) {
+    TestCommandBuffer a(CommandBufferLevel::Secondary);
+    TestCommandBuffer b(CommandBufferLevel::Secondary);
+    for (auto* cmd : {&a, &b}) {
+        cmd->Begin();
+        cmd->Draw(3);
+        cmd->End();
+    }
+    
+    TestCommandBuffer primary;
+    primary.Begin();
+    CommandBuffer* secondaries[] = {&a, &b};
+    primary.ExecuteCommands(secondaries);
+    primary.End();
+    
+    const auto& stream = primary.GetCommandStream();
+    ASSERT_EQ(stream.GetCommandCount(), 1u);
+    const auto& cmd = stream.begin()->As<CmdExecuteCommands>();
+    ASSERT_EQ(cmd.count, 2u);
+    EXPECT_EQ(cmd.GetCommandBuffers()[0], &a);
+    EXPECT_EQ(cmd.GetCommandBuffers()[1], &b);
+    
+    // Referenced, not copied: the secondaries keep their own streams
+    EXPECT_EQ(a.GetCommandStream().GetCommandCount(), 1u);
+}
+
+TEST(SecondaryCommandBufferTest, InvalidExecuteCommandsIsIgnored) {
+    TestCommandBuffer secondary(CommandBufferLevel::Secondary);
+    TestCommandBuffer otherPrimary;
+    TestCommandBuffer primary;
+    
+    // Only primaries may execute, and only secondaries may be executed
+    secondary.Begin();
+    CommandBuffer* nested[] = {&secondary};
+    secondary.ExecuteCommands(nested);
+    secondary.End();
+    EXPECT_TRUE(secondary.GetCommandStream().IsEmpty());
+    
+    primary.Begin();
+    CommandBuffer* primaries[] = {&otherPrimary};
+    primary.ExecuteCommands(primaries);
+    primary.End();
+    EXPECT_TRUE(primary.GetCommandStream().IsEmpty());
+}
+
+TEST(SecondaryCommandBufferTest, ParallelRecordingIntoOnePrimary) {
+    constexpr size_t ThreadCount = 16;
+    std::vector<std::unique_ptr<TestCommandBuffer>> secondaries;
+    for (size_t t = 0; t < ThreadCount; ++t) {
+        secondaries.push_back(std::make_unique<TestCommandBuffer>(CommandBufferLevel::Secondary));
+    }
+    
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < ThreadCount; ++t) {
+        threads.emplace_back([cmd = secondaries[t].get(), t]() {
+            cmd->Begin();
+            for (uint32_t i = 0; i < 1000; ++i) {
+                cmd->Draw(static_cast<uint32_t>(t), 1, i, 0);
+            }
+            cmd->End();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    std::vector<CommandBuffer*> pointers;
+    for (auto& cmd : secondaries) {
+        pointers.push_back(cmd.get());
+    }
+    TestCommandBuffer primary;
+    primary.Begin();
+    primary.ExecuteCommands(pointers);
+    primary.End();
+    
+    const auto& cmd = primary.GetCommandStream().begin()->As<CmdExecuteCommands>();
+    ASSERT_EQ(cmd.count, ThreadCount);
+    for (size_t t = 0; t < ThreadCount; ++t) {
+        const auto* secondary = static_cast<const TestCommandBuffer*>(cmd.GetCommandBuffers()[t]);
+        EXPECT_EQ(secondary->GetState(), CommandBufferState::Executable);
+        EXPECT_EQ(secondary->GetCommandStream().GetCommandCount(), 1000u);
+    }
+}
@@ -0,0 +1,303 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include <VRHI/VRHI.hpp>
+#include <VRHI/ShaderCompiler.hpp>
+#include <gtest/gtest.h>
+#include "../../src/Core/CpuComputeKernel.hpp"
+#include "../../src/Core/ThreadPool.hpp"
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace VRHI;
+
+namespace {
+
+const char* kFillShader = R"(
+#version 450
+layout (local_size_x = 8) in;
+layout (std430, binding = 1) buffer Data { uint values[]; } data;
+layout (push_constant) uniform Push { uint add; } pc;
+void main() { data.values[gl_GlobalInvocationID.x] = gl_GlobalInvocationID.x * 2u + pc.add; }
+)";
+
+const char* kReduceShader = R"(
+#version 450
+layout (local_size_x = 64) in;
+layout (std430, binding = 0) buffer Data { uint values[]; } data;
+layout (std430, binding = 1) buffer Sums { uint values[]; } sums;
+shared uint partial[64];
+void main() {
+    partial[gl_LocalInvocationIndex] = data.values[gl_GlobalInvocationID.x];
+    barrier();
+    for (uint stride = 32u; stride > 0u; stride >>= 1u) {
+        if (gl_LocalInvocationIndex < stride) {
+            partial[gl_LocalInvocationIndex] += partial[gl_LocalInvocationIndex + stride];
+        }
+        barrier();
+    }
+    if (gl_LocalInvocationIndex == 0u) { sums.values[gl_WorkGroupID.x] = partial[0]; }
+}
+)";
+
+const char* kScaleShader = R"(
+#version 450
+layout (local_size_x = 4, local_size_y = 2) in;
+layout (std140, binding = 0) uniform Params { uvec4 scale; } params;
+layout (std430, binding = 2) readonly buffer Input { uint values[]; } src;
+layout (std430, binding = 3) writeonly buffer Output { uint values[]; } dst;
+void main() {
+    uint width = gl_NumWorkGroups.x * gl_WorkGroupSize.x;
+    uint index = gl_GlobalInvocationID.y * width + gl_GlobalInvocationID.x;
+    dst.values[index] = src.values[index] * params.scale.x + gl_WorkGroupID.y;
+}
+)";
+
+std::vector<uint32_t> Compile(const char* source) {
+    auto spirv = ShaderCompiler::CompileGLSLToSPIRV(source, ShaderStage::Compute, "main");
+    EXPECT_TRUE(spirv.has_value()) << spirv.error().message;
+    return spirv ? *spirv : std::vector<uint32_t>{};
+}
+
+#ifndef _WIN32
+/// Set an environment variable for the lifetime of the object
+class ScopedEnvironment {
+public:
+    ScopedEnvironment(const char* name, const std::string& value) : m_name(name) {
+        if (const char* previous = std::getenv(name)) {
+            m_previous = previous;
+            m_hadValue = true;
+        }
+        setenv(name, value.c_str(), 1);
+    }
+    ~ScopedEnvironment() {
+        if (m_hadValue) {
+            setenv(m_name, m_previous.c_str(), 1);
+        } else {
+            unsetenv(m_name);
+        }
+    }
+
+private:
+    const char* m_name;
+    std::string m_previous;
+    bool m_hadValue = false;
+};
+#endif
+
+} // anonymous namespace
+
+// Building a kernel needs a host compiler and GLM. Without them Create()
+// reports CompilationError and the tests running kernels are skipped.
+#define CREATE_KERNEL_OR_SKIP(kernel, source)                                      \
+    auto kernel = CpuComputeKernel::Create(Compile(source));                       \
+    if (!kernel && kernel.error().code == Error::Code::CompilationError) {         \
+        GTEST_SKIP() << "No toolchain for CPU compute kernels: " << kernel.error().message; \
+    }                                                                              \
+    ASSERT_TRUE(kernel.has_value()) << kernel.error().message
+
+// ============================================================================
+// Validation
+// ============================================================================
+
+TEST(CpuComputeKernelTest, RejectsPaddedArrays) {
+    // std140 pads every float of the array to 16 bytes
+    auto kernel = CpuComputeKernel::Create(Compile(R"(
+#version 450
+layout (local_size_x = 1) in;
+layout (std140, binding = 0) uniform Params { float weights[4]; } params;
+layout (std430, binding = 1) buffer Data { float values[]; } data;
+void main() { data.values[0] = params.weights[1]; }
+)"));
+    ASSERT_FALSE(kernel.has_value());
+    EXPECT_EQ(kernel.error().code, Error::Code::UnsupportedFeature);
+    EXPECT_NE(kernel.error().message.find("array stride of 16 in the shader but 4 in C++"), std::string::npos)
+        << kernel.error().message;
+}
+
+TEST(CpuComputeKernelTest, RejectsAlignedMembers) {
+    // std430 aligns vec4 to 16 bytes, C++ to 4
+    auto kernel = CpuComputeKernel::Create(Compile(R"(
+#version 450
+layout (local_size_x = 1) in;
+layout (std430, binding = 0) buffer Data { float scale; vec4 color; } data;
+void main() { data.color *= data.scale; }
+)"));
+    ASSERT_FALSE(kernel.has_value());
+    EXPECT_EQ(kernel.error().code, Error::Code::UnsupportedFeature);
+    EXPECT_NE(kernel.error().message.find("member 'color' is at offset 16 in the shader but 4 in C++"),
+              std::string::npos) << kernel.error().message;
+}
+
+TEST(CpuComputeKernelTest, RejectsSamplers) {
+    auto kernel = CpuComputeKernel::Create(Compile(R"(
+#version 450
+layout (local_size_x = 1) in;
+layout (binding = 0) uniform sampler2D tex;
+layout (std430, binding = 1) buffer Data { vec4 values[]; } data;
+void main() { data.values[0] = textureLod(tex, vec2(0.5), 0.0); }
+)"));
+    ASSERT_FALSE(kernel.has_value());
+    EXPECT_EQ(kernel.error().code, Error::Code::UnsupportedFeature);
+}
+
+TEST(CpuComputeKernelTest, RejectsOtherDescriptorSets) {
+    auto kernel = CpuComputeKernel::Create(Compile(R"(
+#version 450
+layout (local_size_x = 1) in;
+layout (std430, set = 1, binding = 0) buffer Data { uint values[]; } data;
+void main() { data.values[0] = 1u; }
+)"));
+    ASSERT_FALSE(kernel.has_value());
+    EXPECT_EQ(kernel.error().code, Error::Code::UnsupportedFeature);
+}
+
+#ifndef _WIN32
+TEST(CpuComputeKernelTest, RefusesSharedCacheDirectory) {
+    // A world-writable cache would let other users plant libraries
+    std::string directory = (std::filesystem::temp_directory_path() / "vrhi-cache-test.XXXXXX").string();
+    ASSERT_NE(mkdtemp(directory.data()), nullptr);
+    chmod(directory.c_str(), 0777);
+    const char* previous = std::getenv("VRHI_CPU_COMPUTE_CACHE_DIR");
+    const std::string saved = previous ? previous : "";
+    setenv("VRHI_CPU_COMPUTE_CACHE_DIR", directory.c_str(), 1);
+
+    auto kernel = CpuComputeKernel::Create(Compile(R"(
+#version 450
+layout (local_size_x = 1) in;
+layout (std430, binding = 0) buffer Data { uint values[]; } data;
+void main() { data.values[0] = 7u; }
+)"));
+
+    if (previous) {
+        setenv("VRHI_CPU_COMPUTE_CACHE_DIR", saved.c_str(), 1);
+    } else {
+        unsetenv("VRHI_CPU_COMPUTE_CACHE_DIR");
+    }
+    std::filesystem::remove_all(directory);
+    ASSERT_FALSE(kernel.has_value());
+    EXPECT_EQ(kernel.error().code, Error::Code::InitializationFailed);
+    EXPECT_NE(kernel.error().message.find("writable"), std::string::npos) << kernel.error().message;
+}
+
+TEST(CpuComputeKernelTest, NeverRunsTheBuildThroughAShell) {
+    std::string directory = (std::filesystem::temp_directory_path() / "vrhi-shell-test.XXXXXX").string();
+    ASSERT_NE(mkdtemp(directory.data()), nullptr);
+    const std::filesystem::path marker = std::filesystem::path(directory) / "ran";
+    const std::string injection = "$(touch " + marker.string() + ")";
+    const auto spirv = Compile(R"(
+#version 450
+layout (local_size_x = 1) in;
+layout (std430, binding = 0) buffer Data { uint values[]; } data;
+void main() { data.values[0] = 9u; }
+)");
+
+    {
+        // The whole variable names the compiler, which does not exist
+        ScopedEnvironment cache("VRHI_CPU_COMPUTE_CACHE_DIR", directory + "/cache");
+        ScopedEnvironment compiler("VRHI_CPU_COMPUTE_CXX", "c++; touch " + marker.string());
+        auto kernel = CpuComputeKernel::Create(spirv);
+        ASSERT_FALSE(kernel.has_value());
+        EXPECT_EQ(kernel.error().code, Error::Code::CompilationError);
+        EXPECT_NE(kernel.error().message.find("Cannot execute the compiler"), std::string::npos)
+            << kernel.error().message;
+    }
+    {
+        // Shell syntax in flags and in the cache path reaches the compiler verbatim
+        ScopedEnvironment cache("VRHI_CPU_COMPUTE_CACHE_DIR", directory + "/cache \"" + injection + "\"");
+        const char* flags = std::getenv("VRHI_CPU_COMPUTE_FLAGS");
+        ScopedEnvironment extraFlags("VRHI_CPU_COMPUTE_FLAGS",
+                                     std::string(flags ? flags : "") + " -DUNUSED=" + injection);
+        CpuComputeKernel::Create(spirv);
+    }
+
+    EXPECT_FALSE(std::filesystem::exists(marker));
+    std::filesystem::remove_all(directory);
+}
+#endif
+
+// ============================================================================
+// Execution
+// ============================================================================
+
+TEST(CpuComputeKernelTest, FillsWithPushConstants) {
+    CREATE_KERNEL_OR_SKIP(kernel, kFillShader);
+
+    auto bindings = (*kernel)->GetBindings();
+    ASSERT_EQ(bindings.size(), 1u);
+    EXPECT_EQ(bindings[0].binding, 1u);
+    EXPECT_TRUE(bindings[0].storage);
+    EXPECT_TRUE(bindings[0].writable);
+    EXPECT_EQ(bindings[0].minSize, 0u);
+    EXPECT_EQ((*kernel)->GetPushConstantSize(), 4u);
+    EXPECT_EQ((*kernel)->GetWorkGroupSize(), (std::array<uint32_t, 3>{8, 1, 1}));
+
+    ThreadPool threads(4);
+    std::vector<uint32_t> values(64, 0);
+    std::array<void*, 1> buffers = {values.data()};
+    const uint32_t add = 5;
+    (*kernel)->Dispatch(threads, buffers, &add, 8, 1, 1);
+
+    for (uint32_t i = 0; i < values.size(); ++i) {
+        EXPECT_EQ(values[i], i * 2 + 5) << "index " << i;
+    }
+}
+
+TEST(CpuComputeKernelTest, RunsBarriersAcrossTheWorkgroup) {
+    CREATE_KERNEL_OR_SKIP(kernel, kReduceShader);
+
+    ThreadPool threads(2);
+    std::vector<uint32_t> data(256);
+    for (uint32_t i = 0; i < data.size(); ++i) {
+        data[i] = i;
+    }
+    std::vector<uint32_t> sums(4, 0);
+    std::array<void*, 2> buffers = {data.data(), sums.data()};
+    (*kernel)->Dispatch(threads, buffers, nullptr, 4, 1, 1);
+
+    for (uint32_t group = 0; group < sums.size(); ++group) {
+        // Sum of 64 consecutive integers starting at group * 64
+        EXPECT_EQ(sums[group], group * 64 * 64 + 63 * 64 / 2) << "group " << group;
+    }
+}
+
+TEST(CpuComputeKernelTest, ReadsUniformsAndBuiltinsOnEveryThreadCount) {
+    CREATE_KERNEL_OR_SKIP(kernel, kScaleShader);
+
+    auto bindings = (*kernel)->GetBindings();
+    ASSERT_EQ(bindings.size(), 3u);
+    EXPECT_FALSE(bindings[0].storage);
+    EXPECT_EQ(bindings[0].minSize, 16u);
+    EXPECT_FALSE(bindings[1].writable);
+    EXPECT_TRUE(bindings[2].writable);
+
+    // 3 x 5 workgroups of 4 x 2 invocations
+    constexpr uint32_t Width = 12;
+    constexpr uint32_t Height = 10;
+    const std::array<uint32_t, 4> scale = {3, 0, 0, 0};
+    std::vector<uint32_t> input(Width * Height);
+    for (uint32_t i = 0; i < input.size(); ++i) {
+        input[i] = i;
+    }
+
+    for (uint32_t threadCount : {1u, 3u, 8u}) {
+        ThreadPool threads(threadCount);
+        std::vector<uint32_t> output(Width * Height, 0);
+        std::array<void*, 3> buffers = {const_cast<uint32_t*>(scale.data()), input.data(), output.data()};
+        (*kernel)->Dispatch(threads, buffers, nullptr, 3, 5, 1);
+
+        for (uint32_t y = 0; y < Height; ++y) {
+            for (uint32_t x = 0; x < Width; ++x) {
+                const uint32_t i = y * Width + x;
+                EXPECT_EQ(output[i], i * 3 + y / 2) << threadCount << " threads, index " << i;
+            }
+        }
+    }
+}
@@ -0,0 +1,286 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include <VRHI/VRHIAll.hpp>
+#include <VRHI/RecordingCommandBuffer.hpp>
+#include <gtest/gtest.h>
+#include "MockBackend.hpp"
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace VRHI;
+
+namespace {
+
+class TestCommandBuffer : public RecordingCommandBuffer {
+public:
+    TestCommandBuffer() : RecordingCommandBuffer(CommandBufferLevel::Primary) {}
+
+    std::map<CommandType, uint32_t> CountCommands() const {
+        std::map<CommandType, uint32_t> counts;
+        for (const CommandHeader& header : GetCommandStream()) {
+            ++counts[header.type];
+        }
+        return counts;
+    }
+};
+
+/// Implements the CommandBuffer interface without a command stream
+class CountingCommandBuffer : public Mock::MockCommandBuffer {
+public:
+    CountingCommandBuffer() : MockCommandBuffer(CommandBufferLevel::Primary) {}
+
+    void BindPipeline(Pipeline*) override { ++pipelineBinds; }
+    void DrawIndexed(const DrawIndexedParams&) override { ++draws; }
+
+    uint32_t pipelineBinds = 0;
+    uint32_t draws = 0;
+};
+
+// Fake resource pointers; neither recording nor sorting dereferences them
+template<typename T>
+T* Fake(uintptr_t id) { return reinterpret_cast<T*>(id * 16); }
+
+DrawItem MakeDraw(uint32_t pipeline, uint32_t material, uint32_t mesh) {
+    DrawItem item;
+    item.pipeline = Fake<Pipeline>(1 + pipeline);
+    item.vertexBuffers[0] = Fake<Buffer>(100 + mesh);
+    item.vertexBufferCount = 1;
+    item.indexBuffer = Fake<Buffer>(200 + mesh);
+    item.indexed.indexCount = 36;
+    item.textures[0] = {0, Fake<Texture>(300 + material), Fake<Sampler>(400)};
+    item.textures[1] = {1, Fake<Texture>(500 + material), Fake<Sampler>(400)};
+    item.textureCount = 2;
+    return item;
+}
+
+void ExpectSortedStable(const DrawList& list, const std::vector<uint64_t>& keys) {
+    std::vector<size_t> expected(keys.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        expected[i] = i;
+    }
+    std::ranges::stable_sort(expected, {}, [&](size_t i) { return keys[i]; });
+
+    ASSERT_EQ(list.GetSize(), keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        ASSERT_EQ(list.GetSortedIndex(i), expected[i]) << "at " << i;
+        ASSERT_EQ(list.GetSortedKey(i), keys[expected[i]]);
+    }
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// Sort Key Tests
+// ============================================================================
+
+TEST(DrawSortKeyTest, FieldsOrderByPriority) {
+    EXPECT_LT(MakeDrawSortKey(0, 0xFFFF, 0xFFFFFF, 0xFFFF), MakeDrawSortKey(1, 0, 0, 0));
+    EXPECT_LT(MakeDrawSortKey(0, 1, 0xFFFFFF, 0xFFFF), MakeDrawSortKey(0, 2, 0, 0));
+    EXPECT_LT(MakeDrawSortKey(0, 1, 7, 0xFFFF), MakeDrawSortKey(0, 1, 8, 0));
+    EXPECT_EQ(MakeDrawSortKey(0, 0, 0x1000000, 0), 0u);  // Material is 24 bits
+}
+
+TEST(DrawSortKeyTest, QuantizeDepth) {
+    EXPECT_EQ(QuantizeSortDepth(0.1f, 0.1f, 100.0f), 0u);
+    EXPECT_EQ(QuantizeSortDepth(100.0f, 0.1f, 100.0f), 0xFFFFu);
+    EXPECT_EQ(QuantizeSortDepth(500.0f, 0.1f, 100.0f), 0xFFFFu);
+    EXPECT_LT(QuantizeSortDepth(10.0f, 0.1f, 100.0f), QuantizeSortDepth(20.0f, 0.1f, 100.0f));
+    EXPECT_GT(QuantizeSortDepth(10.0f, 0.1f, 100.0f, true), QuantizeSortDepth(20.0f, 0.1f, 100.0f, true));
+}
+
+// ============================================================================
+// Sort Tests
+// ============================================================================
+
+TEST(DrawListTest, SortIsStable) {
+    DrawList list;
+    std::vector<uint64_t> keys;
+    std::mt19937_64 rng(7);
+    for (uint32_t i = 0; i < 1000; ++i) {
+        keys.push_back(MakeDrawSortKey(rng() % 3, rng() % 4, rng() % 8, 0));
+        list.Add(keys.back(), MakeDraw(0, 0, 0));
+    }
+    list.Sort(1);
+    ExpectSortedStable(list, keys);
+}
+
+TEST(DrawListTest, SortFullWidthKeys) {
+    DrawList list;
+    std::vector<uint64_t> keys;
+    std::mt19937_64 rng(11);
+    for (uint32_t i = 0; i < 5000; ++i) {
+        keys.push_back(rng());
+        list.Add(keys.back(), DrawItem{});
+    }
+    list.Sort(1);
+    ExpectSortedStable(list, keys);
+}
+
+TEST(DrawListTest, ParallelSortMatchesSerial) {
+    DrawList list;
+    std::vector<uint64_t> keys;
+    std::mt19937_64 rng(13);
+    for (uint32_t i = 0; i < 200000; ++i) {
+        // Few distinct high bytes, like real keys, plus random depths
+        keys.push_back(MakeDrawSortKey(rng() % 2, rng() % 16, rng() % 512, static_cast<uint16_t>(rng())));
+        list.Add(keys.back(), DrawItem{});
+    }
+    list.Sort(4);
+    ExpectSortedStable(list, keys);
+}
+
+TEST(DrawListTest, ClearAndReuse) {
+    DrawList list;
+    list.Add(2, DrawItem{});
+    list.Add(1, DrawItem{});
+    list.Sort();
+    EXPECT_EQ(list.GetSortedKey(0), 1u);
+
+    list.Clear();
+    EXPECT_EQ(list.GetSize(), 0u);
+    list.Sort();
+
+    list.Add(5, DrawItem{});
+    list.Add(3, DrawItem{});
+    list.Add(4, DrawItem{});
+    list.Sort();
+    EXPECT_EQ(list.GetSortedIndex(0), 1u);
+    EXPECT_EQ(list.GetSortedIndex(1), 2u);
+    EXPECT_EQ(list.GetSortedIndex(2), 0u);
+}
+
+// ============================================================================
+// Emit Tests
+// ============================================================================
+
+TEST(DrawListTest, EmitSkipsRedundantBinds) {
+    DrawList list;
+    for (uint32_t i = 0; i < 4; ++i) {
+        list.Add(0, MakeDraw(0, 0, 0));
+    }
+
+    TestCommandBuffer cmd;
+    cmd.Begin();
+    const DrawListStats stats = list.Emit(cmd);
+    cmd.End();
+
+    EXPECT_EQ(stats.drawCount, 4u);
+    EXPECT_EQ(stats.pipelineBinds, 1u);
+    EXPECT_EQ(stats.vertexBufferBinds, 1u);
+    EXPECT_EQ(stats.indexBufferBinds, 1u);
+    EXPECT_EQ(stats.textureBinds, 2u);
+
+    auto counts = cmd.CountCommands();
+    EXPECT_EQ(counts[CommandType::BindPipeline], 1u);
+    EXPECT_EQ(counts[CommandType::BindVertexBuffers], 1u);
+    EXPECT_EQ(counts[CommandType::BindIndexBuffer], 1u);
+    EXPECT_EQ(counts[CommandType::BindTexture], 2u);
+    EXPECT_EQ(counts[CommandType::DrawIndexed], 4u);
+}
+
+TEST(DrawListTest, EmitRecordsThroughAnyCommandBuffer) {
+    DrawList list;
+    list.Add(0, MakeDraw(0, 0, 0));
+    list.Add(1, MakeDraw(1, 0, 0));
+    list.Add(2, MakeDraw(1, 0, 1));
+
+    // Not a RecordingCommandBuffer, so Emit() must use the virtual interface
+    CountingCommandBuffer cmd;
+    cmd.Begin();
+    const DrawListStats stats = list.Emit(cmd);
+    cmd.End();
+
+    EXPECT_EQ(stats.drawCount, 3u);
+    EXPECT_EQ(cmd.draws, 3u);
+    EXPECT_EQ(stats.pipelineBinds, 2u);
+    EXPECT_EQ(cmd.pipelineBinds, 2u);
+}
+
+TEST(DrawListTest, EmitRebindsOnlyChangedState) {
+    DrawList list;
+    DrawItem first = MakeDraw(0, 0, 0);
+    first.uniformBuffers[0] = {0, Fake<Buffer>(600), 0, 256};
+    first.uniformBufferCount = 1;
+    DrawItem second = first;
+    second.textures[1].texture = Fake<Texture>(999);  // Only one texture differs
+    second.uniformBuffers[0].offset = 256;            // Per-object uniforms
+    second.vertexBuffers[1] = Fake<Buffer>(700);      // An extra stream
+    second.vertexBufferCount = 2;
+    list.Add(0, first);
+    list.Add(1, second);
+
+    TestCommandBuffer cmd;
+    cmd.Begin();
+    const DrawListStats stats = list.Emit(cmd);
+    cmd.End();
+
+    EXPECT_EQ(stats.pipelineBinds, 1u);
+    EXPECT_EQ(stats.indexBufferBinds, 1u);
+    EXPECT_EQ(stats.textureBinds, 3u);
+    EXPECT_EQ(stats.uniformBufferBinds, 2u);
+    EXPECT_EQ(stats.vertexBufferBinds, 2u);
+
+    // The second vertex buffer bind only covers the slot that changed
+    const CmdBindVertexBuffers* lastBind = nullptr;
+    for (const CommandHeader& header : cmd.GetCommandStream()) {
+        if (header.type == CommandType::BindVertexBuffers) {
+            lastBind = &header.As<CmdBindVertexBuffers>();
+        }
+    }
+    ASSERT_NE(lastBind, nullptr);
+    EXPECT_EQ(lastBind->firstBinding, 1u);
+    ASSERT_EQ(lastBind->bufferCount, 1u);
+    EXPECT_EQ(lastBind->GetBuffers()[0], Fake<Buffer>(700));
+}
+
+TEST(DrawListTest, NonIndexedDraws) {
+    DrawList list;
+    DrawItem item;
+    item.pipeline = Fake<Pipeline>(1);
+    item.vertices.vertexCount = 3;
+    list.Add(0, item);
+
+    TestCommandBuffer cmd;
+    cmd.Begin();
+    list.Emit(cmd);
+    cmd.End();
+
+    auto counts = cmd.CountCommands();
+    EXPECT_EQ(counts[CommandType::Draw], 1u);
+    EXPECT_EQ(counts[CommandType::DrawIndexed], 0u);
+    EXPECT_EQ(counts[CommandType::BindVertexBuffers], 0u);
+    EXPECT_EQ(counts[CommandType::BindIndexBuffer], 0u);
+}
+
+TEST(DrawListTest, SortingReducesStateChanges) {
+    // Scene traversal order interleaves 4 pipelines and 16 materials
+    constexpr uint32_t DrawCount = 4096;
+    DrawList list;
+    std::mt19937 rng(3);
+    for (uint32_t i = 0; i < DrawCount; ++i) {
+        const uint32_t pipeline = rng() % 4;
+        const uint32_t material = rng() % 16;
+        list.Add(MakeDrawSortKey(0, static_cast<uint16_t>(pipeline), material, 0),
+                 MakeDraw(pipeline, material, 0));
+    }
+
+    TestCommandBuffer unsorted;
+    unsorted.Begin();
+    const DrawListStats before = list.Emit(unsorted);
+    unsorted.End();
+
+    list.Sort();
+    TestCommandBuffer sorted;
+    sorted.Begin();
+    const DrawListStats after = list.Emit(sorted);
+    sorted.End();
+
+    EXPECT_EQ(after.drawCount, DrawCount);
+    EXPECT_EQ(after.pipelineBinds, 4u);
+    EXPECT_LE(after.textureBinds, 2u * 4u * 16u);
+    EXPECT_GT(before.pipelineBinds, 10u * after.pipelineBinds);
+    EXPECT_GT(before.textureBinds, 10u * after.textureBinds);
+}
@@ -0,0 +1,119 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include <VRHI/VRHIAll.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+// Include internal headers for testing
+#include "../../src/Core/NullDevice.hpp"
+
+using namespace VRHI;
+
+namespace {
+
+std::unique_ptr<Device> MakeSoftwareDevice(uint32_t maxFramesInFlight) {
+    DeviceConfig config{};
+    config.preferredBackend = BackendType::Software;
+    config.maxFramesInFlight = maxFramesInFlight;
+    auto device = CreateDevice(config);
+    EXPECT_TRUE(device.has_value()) << (device ? "" : device.error().message);
+    return device ? std::move(*device) : nullptr;
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// Frame Context Tests
+// ============================================================================
+
+TEST(FrameContextTest, ContextsAreUsedInTurn) {
+    auto device = MakeSoftwareDevice(3);
+    ASSERT_NE(device, nullptr);
+    EXPECT_EQ(device->GetMaxFramesInFlight(), 3u);
+    EXPECT_EQ(device->GetCurrentFrame(), nullptr);
+
+    for (uint64_t i = 0; i < 7; ++i) {
+        FrameContext& frame = device->BeginFrame();
+        EXPECT_EQ(device->GetCurrentFrame(), &frame);
+        EXPECT_EQ(frame.GetIndex(), i % 3);
+        EXPECT_EQ(frame.GetFrameNumber(), i);
+        EXPECT_EQ(frame.GetTransientAllocator(), device->GetTransientAllocator());
+        device->EndFrame();
+        EXPECT_EQ(device->GetCurrentFrame(), nullptr);
+    }
+}
+
+TEST(FrameContextTest, FenceSignalsAtEndFrame) {
+    auto device = MakeSoftwareDevice(2);
+    ASSERT_NE(device, nullptr);
+
+    FrameContext& frame = device->BeginFrame();
+    ASSERT_NE(frame.GetFence(), nullptr);
+    EXPECT_FALSE(frame.GetFence()->IsSignaled());
+
+    CommandBuffer* cmd = frame.GetCommandPool().Allocate();
+    ASSERT_NE(cmd, nullptr);
+    cmd->Begin();
+    cmd->End();
+    device->Submit(cmd);
+    device->EndFrame();
+    EXPECT_TRUE(frame.GetFence()->IsSignaled());
+}
+
+TEST(FrameContextTest, DeferredWorkRunsWhenContextIsReused) {
+    auto device = MakeSoftwareDevice(2);
+    ASSERT_NE(device, nullptr);
+
+    int calls = 0;
+    FrameContext& first = device->BeginFrame();
+    first.Defer([&calls] { ++calls; });
+    EXPECT_NE(first.GetCommandPool().Allocate(), nullptr);
+
+    BufferDesc desc{};
+    desc.size = 64;
+    auto buffer = device->CreateBuffer(desc);
+    ASSERT_TRUE(buffer.has_value());
+    first.DeferDelete(std::move(*buffer));
+    EXPECT_EQ(first.GetDeferredCount(), 2u);
+    device->EndFrame();
+
+    // The second context does not touch the first one's work
+    device->BeginFrame();
+    device->EndFrame();
+    EXPECT_EQ(calls, 0);
+    EXPECT_EQ(first.GetDeferredCount(), 2u);
+
+    FrameContext& reused = device->BeginFrame();
+    EXPECT_EQ(&reused, &first);
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(reused.GetDeferredCount(), 0u);
+    EXPECT_EQ(reused.GetCommandPool().GetAllocatedCount(), 0u);
+    device->EndFrame();
+}
+
+TEST(FrameContextTest, DeferredWorkRunsWhenDeviceIsDestroyed) {
+    int calls = 0;
+    {
+        auto device = std::make_unique<NullDevice>();
+        FrameContext& frame = device->BeginFrame();
+        EXPECT_EQ(frame.GetFence(), nullptr);
+        frame.Defer([&calls] { ++calls; });
+        device->EndFrame();
+        device->BeginFrame().Defer([&calls] { ++calls; });
+    }
+    EXPECT_EQ(calls, 2);
+}
+
+TEST(FrameContextTest, UnbalancedCallsAreIgnored) {
+    auto device = std::make_unique<NullDevice>();
+    device->EndFrame();
+    EXPECT_EQ(device->GetCurrentFrame(), nullptr);
+
+    FrameContext& frame = device->BeginFrame();
+    EXPECT_EQ(&device->BeginFrame(), &frame);
+    device->EndFrame();
+    EXPECT_EQ(device->BeginFrame().GetFrameNumber(), 1u);
+    device->EndFrame();
+}
@@ -127,6 +127,8 @@ public:
     void Reset() override { m_signaled = false; }
     bool IsSignaled() const noexcept override { return m_signaled; }
     
+    void Signal() { m_signaled = true; }
+    
 private:
     bool m_signaled;
 };
@@ -180,22 +182,26 @@ private:
 
 class MockCommandBuffer : public CommandBuffer {
 public:
-    MockCommandBuffer() = default;
+    explicit MockCommandBuffer(CommandBufferLevel level) : m_level(level) {}
     
     void Begin() override { m_state = CommandBufferState::Recording; }
     void End() override { m_state = CommandBufferState::Executable; }
     void Reset() override { m_state = CommandBufferState::Initial; }
     CommandBufferState GetState() const noexcept override { return m_state; }
+    CommandBufferLevel GetLevel() const noexcept override { return m_level; }
     
-    void BeginRenderPass(RenderPass*, Framebuffer*, const Rect2D&) override {}
+    void BeginRenderPass(RenderPass*, Framebuffer*, const Rect2D&, std::span<const ClearValue>) override {}
     void EndRenderPass() override {}
     
     void BindPipeline(Pipeline*) override {}
     void BindVertexBuffers(uint32_t, std::span<Buffer* const>, std::span<const uint64_t>) override {}
     void BindIndexBuffer(Buffer*, uint64_t, bool) override {}
     void BindUniformBuffer(uint32_t, Buffer*, uint64_t, uint64_t) override {}
+    void BindStorageBuffer(uint32_t, Buffer*, uint64_t, uint64_t) override {}
     void BindTexture(uint32_t, Texture*, Sampler*) override {}
     
+    void PushConstants(ShaderStage, uint32_t, std::span<const std::byte>) override {}
+    
     void SetViewport(const Viewport&) override {}
     void SetViewports(std::span<const Viewport>) override {}
     void SetScissor(const Rect2D&) override {}
@@ -227,6 +233,8 @@ public:
     void CopyTextureToBuffer(Texture*, Buffer*, uint32_t, uint32_t) override {}
     void CopyTexture(Texture*, Texture*, uint32_t, uint32_t, uint32_t, uint32_t) override {}
     
+    void ExecuteCommands(std::span<CommandBuffer* const>) override {}
+    
     void PipelineBarrier() override {}
     
     void BeginDebugMarker(const char*, const float[4]) override {}
@@ -235,6 +243,7 @@ public:
     
 private:
     CommandBufferState m_state = CommandBufferState::Initial;
+    CommandBufferLevel m_level;
 };
 
 // ============================================================================
@@ -347,12 +356,21 @@ public:
         return std::make_unique<MockFramebuffer>(desc);
     }
     
-    std::unique_ptr<CommandBuffer> CreateCommandBuffer() override {
-        return std::make_unique<MockCommandBuffer>();
+    std::unique_ptr<CommandBuffer> CreateCommandBuffer(CommandBufferLevel level) override {
+        return std::make_unique<MockCommandBuffer>(level);
     }
     
-    void Submit(std::unique_ptr<CommandBuffer>) override {}
-    void Submit(std::span<std::unique_ptr<CommandBuffer>>) override {}
+    void Submit(std::unique_ptr<CommandBuffer> cmd, Fence* signalFence) override {
+        Submit(cmd.get(), signalFence);
+    }
+    void Submit(CommandBuffer*, Fence* signalFence) override {
+        if (signalFence) {
+            static_cast<MockFence*>(signalFence)->Signal();
+        }
+    }
+    void Submit(std::span<std::unique_ptr<CommandBuffer>>, Fence* signalFence) override {
+        Submit(nullptr, signalFence);
+    }
     void WaitIdle() override {}
     
     std::unique_ptr<Fence> CreateFence(bool signaled) override {
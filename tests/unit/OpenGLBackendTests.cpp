@@ -0,0 +1,1384 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include <VRHI/VRHIAll.hpp>
+#include "Backends/OpenGL33/OpenGL33Buffer.hpp"
+#include "Backends/OpenGL33/OpenGL33Device.hpp"
+#include "Backends/OpenGL33/OpenGL33Texture.hpp"
+#include "Backends/OpenGL33/OpenGL33UploadQueue.hpp"
+#include <gtest/gtest.h>
+#include <glad/glad.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <span>
+#include <thread>
+#include <vector>
+
+using namespace VRHI;
+
+namespace {
+
+const char* kFillShader = R"(
+#version 450
+layout (local_size_x = 8) in;
+layout (std430, binding = 1) buffer Data { uint values[]; } data;
+layout (push_constant) uniform Push { uint add; } pc;
+void main() { data.values[gl_GlobalInvocationID.x] = gl_GlobalInvocationID.x * 2u + pc.add; }
+)";
+
+const char* kGatherShader = R"(
+#version 450
+layout (local_size_x = 1) in;
+layout (std430, binding = 0) readonly buffer Source { uint value; } source;
+layout (std430, binding = 1) buffer Data { uint values[]; } data;
+layout (push_constant) uniform Push { uint index; } pc;
+void main() { data.values[pc.index] = source.value; }
+)";
+
+const char* kColorVertexShader = R"(
+#version 450
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 aColor;
+layout (location = 0) out vec4 vColor;
+void main() { vColor = aColor; gl_Position = vec4(aPos, 1.0); }
+)";
+
+const char* kColorFragmentShader = R"(
+#version 450
+layout (location = 0) in vec4 vColor;
+layout (location = 0) out vec4 FragColor;
+void main() { FragColor = vColor; }
+)";
+
+const char* kPushColorFragmentShader = R"(
+#version 450
+layout (location = 0) in vec4 vColor;
+layout (location = 0) out vec4 FragColor;
+layout (push_constant) uniform Push { vec4 color; } pc;
+void main() { FragColor = pc.color; }
+)";
+
+struct ColorVertex {
+    float x, y, z;
+    float r, g, b, a;
+};
+
+/// Make a surfaceless EGL context current on this thread, once per process.
+/// Rendering goes to framebuffer objects, as there is no default framebuffer.
+bool MakeHeadlessContext() {
+    static const bool current = [] {
+        // Let llvmpipe rasterize on worker threads even on a single core, so
+        // that, as on a GPU, submitted work can still be pending
+        setenv("LP_NUM_THREADS", "2", 0);
+
+        EGLDisplay display = EGL_NO_DISPLAY;
+        auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay) {
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        }
+        if (display == EGL_NO_DISPLAY) {
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+        EGLint major = 0;
+        EGLint minor = 0;
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor) || !eglBindAPI(EGL_OPENGL_API)) {
+            return false;
+        }
+
+        // Drivers return the newest version compatible with the one asked for
+        const EGLint attributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 3,
+            EGL_CONTEXT_MINOR_VERSION, 3,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE,
+        };
+        EGLContext context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+        return context != EGL_NO_CONTEXT && eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+    }();
+    return current;
+}
+
+std::unique_ptr<Shader> MakeShader(Device& device, ShaderStage stage, const char* source) {
+    ShaderDesc desc{};
+    desc.stage = stage;
+    desc.code = source;
+    desc.codeSize = std::strlen(source);
+    auto shader = device.CreateShader(desc);
+    EXPECT_TRUE(shader.has_value()) << (shader ? "" : shader.error().message);
+    return shader ? std::move(*shader) : nullptr;
+}
+
+std::unique_ptr<Pipeline> MakeComputePipeline(Device& device, Shader* shader) {
+    PipelineDesc desc{};
+    desc.type = PipelineType::Compute;
+    desc.compute.computeShader = shader;
+    auto pipeline = device.CreatePipeline(desc);
+    EXPECT_TRUE(pipeline.has_value()) << (pipeline ? "" : pipeline.error().message);
+    return pipeline ? std::move(*pipeline) : nullptr;
+}
+
+std::unique_ptr<Pipeline> MakeColorPipeline(Device& device, Shader* vs, Shader* fs) {
+    VertexAttribute attributes[] = {
+        {0, 0, VertexFormat::Float3, 0},
+        {1, 0, VertexFormat::Float4, 12},
+    };
+    VertexBinding bindings[] = {{0, sizeof(ColorVertex), VertexInputRate::Vertex}};
+    PipelineDesc desc{};
+    desc.type = PipelineType::Graphics;
+    desc.graphics.vertexShader = vs;
+    desc.graphics.fragmentShader = fs;
+    desc.graphics.vertexInput.attributes = attributes;
+    desc.graphics.vertexInput.bindings = bindings;
+    auto pipeline = device.CreatePipeline(desc);
+    EXPECT_TRUE(pipeline.has_value()) << (pipeline ? "" : pipeline.error().message);
+    return pipeline ? std::move(*pipeline) : nullptr;
+}
+
+std::unique_ptr<Buffer> MakeBuffer(Device& device, BufferUsage usage, const void* data, size_t size) {
+    BufferDesc desc{};
+    desc.size = size;
+    desc.usage = usage;
+    desc.initialData = data;
+    auto buffer = device.CreateBuffer(desc);
+    EXPECT_TRUE(buffer.has_value()) << (buffer ? "" : buffer.error().message);
+    return buffer ? std::move(*buffer) : nullptr;
+}
+
+/// Color render target with its pass and framebuffer
+struct RenderTarget {
+    std::unique_ptr<Texture> color;
+    std::unique_ptr<RenderPass> pass;
+    std::unique_ptr<Framebuffer> framebuffer;
+    uint32_t size = 0;
+
+    std::vector<uint8_t> ReadPixels() {
+        std::vector<uint8_t> pixels(size_t(size) * size * 4);
+        color->Read(pixels.data(), pixels.size());
+        return pixels;
+    }
+};
+
+RenderTarget MakeRenderTarget(Device& device, uint32_t size) {
+    RenderTarget target;
+    target.size = size;
+
+    TextureDesc textureDesc{};
+    textureDesc.format = TextureFormat::RGBA8_UNorm;
+    textureDesc.width = size;
+    textureDesc.height = size;
+    textureDesc.usage = TextureUsage::RenderTarget;
+    target.color = std::move(*device.CreateTexture(textureDesc));
+
+    AttachmentDesc attachment{};
+    attachment.format = TextureFormat::RGBA8_UNorm;
+    RenderPassDesc passDesc{};
+    passDesc.attachments = std::span(&attachment, 1);
+    target.pass = std::move(*device.CreateRenderPass(passDesc));
+
+    Texture* attachments[] = {target.color.get()};
+    FramebufferDesc framebufferDesc{};
+    framebufferDesc.renderPass = target.pass.get();
+    framebufferDesc.attachments = attachments;
+    framebufferDesc.width = size;
+    framebufferDesc.height = size;
+    auto framebuffer = device.CreateFramebuffer(framebufferDesc);
+    EXPECT_TRUE(framebuffer.has_value()) << (framebuffer ? "" : framebuffer.error().message);
+    if (framebuffer) {
+        target.framebuffer = std::move(*framebuffer);
+    }
+    return target;
+}
+
+std::unique_ptr<Texture> MakeTexture(Device& device, TextureType type, TextureFormat format,
+                                     uint32_t size, uint32_t mipLevels, uint32_t arrayLayers) {
+    TextureDesc desc{};
+    desc.type = type;
+    desc.format = format;
+    desc.width = size;
+    desc.height = size;
+    desc.mipLevels = mipLevels;
+    desc.arrayLayers = arrayLayers;
+    auto result = device.CreateTexture(desc);
+    return result ? std::move(*result) : nullptr;
+}
+
+/// Record PushConstants(red), a DrawIndirect that is skipped for its null
+/// buffer, PushConstants(green) and a full-screen Draw
+/// @return The color of the center pixel
+std::array<uint8_t, 4> DrawAfterSkippedIndirectDraw(Device& device) {
+    auto target = MakeRenderTarget(device, 16);
+    auto vs = MakeShader(device, ShaderStage::Vertex, kColorVertexShader);
+    auto fs = MakeShader(device, ShaderStage::Fragment, kPushColorFragmentShader);
+    auto pipeline = MakeColorPipeline(device, vs.get(), fs.get());
+    if (!target.framebuffer || !pipeline) {
+        return {};
+    }
+    const ColorVertex vertices[] = {
+        {-1, -1, 0,  0, 0, 0, 1}, { 3, -1, 0,  0, 0, 0, 1}, {-1,  3, 0,  0, 0, 0, 1},
+    };
+    auto vertexBuffer = MakeBuffer(device, BufferUsage::Vertex, vertices, sizeof(vertices));
+
+    const float red[4] = {1, 0, 0, 1};
+    const float green[4] = {0, 1, 0, 1};
+    ClearValue clear{};
+    clear.color = ClearColorValue(0, 0, 1, 1);
+    auto cmd = device.CreateCommandBuffer();
+    cmd->Begin();
+    cmd->BeginRenderPass(target.pass.get(), target.framebuffer.get(), {0, 0, 16, 16}, std::span(&clear, 1));
+    cmd->SetViewport({0, 0, 16, 16, 0, 1});
+    cmd->BindPipeline(pipeline.get());
+    Buffer* vertexBuffers[] = {vertexBuffer.get()};
+    cmd->BindVertexBuffers(0, vertexBuffers);
+    cmd->PushConstants(ShaderStage::Fragment, 0, std::as_bytes(std::span(red)));
+    cmd->DrawIndirect(nullptr, 0, 1, 16);
+    cmd->PushConstants(ShaderStage::Fragment, 0, std::as_bytes(std::span(green)));
+    cmd->Draw(3);
+    cmd->EndRenderPass();
+    cmd->End();
+    device.Submit(cmd.get());
+
+    auto pixels = target.ReadPixels();
+    const uint8_t* center = &pixels[(8 * 16 + 8) * 4];
+    return {center[0], center[1], center[2], center[3]};
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// OpenGL Backend Tests
+// ============================================================================
+
+/// Runs on a surfaceless EGL context (Mesa in CI) and skips on machines
+/// without one, or whose driver lacks the requested backend's version
+template<BackendType Type>
+class OpenGLBackendTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (!MakeHeadlessContext()) {
+            GTEST_SKIP() << "No headless OpenGL context";
+        }
+        DeviceConfig config{};
+        config.preferredBackend = Type;
+        auto result = CreateDevice(config);
+        if (!result) {
+            GTEST_SKIP() << "No OpenGL device: " << result.error().message;
+        }
+        device = std::move(*result);
+        if (device->GetBackendType() != Type) {
+            GTEST_SKIP() << "Driver does not support " << device->GetBackendInfo().name;
+        }
+    }
+
+    void TearDown() override {
+        if (device) {
+            EXPECT_EQ(glGetError(), static_cast<GLenum>(GL_NO_ERROR));
+        }
+    }
+
+    std::unique_ptr<Device> device;
+};
+
+using OpenGL33BackendTest = OpenGLBackendTest<BackendType::OpenGL33>;
+using OpenGL46BackendTest = OpenGLBackendTest<BackendType::OpenGL46>;
+
+// ============================================================================
+// OpenGL 3.3
+// ============================================================================
+
+TEST_F(OpenGL33BackendTest, SkippedDrawKeepsPushConstantsInStep) {
+    // The skipped draw still uses up the red snapshot, so the draw gets green
+    const auto center = DrawAfterSkippedIndirectDraw(*device);
+    EXPECT_EQ(center[0], 0);
+    EXPECT_EQ(center[1], 255);
+    EXPECT_EQ(center[2], 0);
+}
+
+TEST_F(OpenGL33BackendTest, VertexViewsOfOneBlockShareAVertexArray) {
+    auto target = MakeRenderTarget(*device, 16);
+    ASSERT_NE(target.framebuffer, nullptr);
+    auto vs = MakeShader(*device, ShaderStage::Vertex, kColorVertexShader);
+    auto fs = MakeShader(*device, ShaderStage::Fragment, kColorFragmentShader);
+
+    // Padded to a 32-byte stride so that 16-byte aligned views start on a vertex
+    struct PaddedVertex {
+        float x, y, z, pad;
+        float r, g, b, a;
+    };
+    VertexAttribute attributes[] = {
+        {0, 0, VertexFormat::Float3, 0},
+        {1, 0, VertexFormat::Float4, 16},
+    };
+    VertexBinding bindings[] = {{0, sizeof(PaddedVertex), VertexInputRate::Vertex}};
+    PipelineDesc pipelineDesc{};
+    pipelineDesc.type = PipelineType::Graphics;
+    pipelineDesc.graphics.vertexShader = vs.get();
+    pipelineDesc.graphics.fragmentShader = fs.get();
+    pipelineDesc.graphics.vertexInput.attributes = attributes;
+    pipelineDesc.graphics.vertexInput.bindings = bindings;
+    auto pipeline = std::move(*device->CreatePipeline(pipelineDesc));
+
+    // One two-pixel column per view, each a different shade of green
+    constexpr uint32_t ViewCount = 8;
+    BufferAllocator allocator(*device, 64 * 1024);
+    std::vector<BufferView> views;
+    for (uint32_t i = 0; i < ViewCount; ++i) {
+        const float left = -1.0f + 0.25f * static_cast<float>(i);
+        const float right = left + 0.25f;
+        const float green = static_cast<float>(30 * (i + 1)) / 255.0f;
+        const PaddedVertex vertices[] = {
+            {left, -1, 0, 0,  0, green, 0, 1}, {right, -1, 0, 0,  0, green, 0, 1}, {right, 1, 0, 0,  0, green, 0, 1},
+            {left, -1, 0, 0,  0, green, 0, 1}, {right,  1, 0, 0,  0, green, 0, 1}, {left,  1, 0, 0,  0, green, 0, 1},
+        };
+        BufferDesc desc{};
+        desc.size = sizeof(vertices);
+        desc.usage = BufferUsage::Vertex;
+        desc.initialData = vertices;
+        auto view = allocator.Allocate(desc);
+        ASSERT_TRUE(view.has_value()) << view.error().message;
+        ASSERT_EQ(view->offset % sizeof(PaddedVertex), 0u);
+        views.push_back(*view);
+    }
+    ASSERT_EQ(allocator.GetBlockCount(), 1u);
+    const uint16_t indices[] = {0, 1, 2, 3, 4, 5};
+    auto indexBuffer = MakeBuffer(*device, BufferUsage::Index, indices, sizeof(indices));
+
+    for (bool indexed : {false, true}) {
+        ClearValue clear{};
+        clear.color = ClearColorValue(0, 0, 0, 1);
+        auto cmd = device->CreateCommandBuffer();
+        cmd->Begin();
+        cmd->BeginRenderPass(target.pass.get(), target.framebuffer.get(), {0, 0, 16, 16}, std::span(&clear, 1));
+        cmd->SetViewport({0, 0, 16, 16, 0, 1});
+        cmd->BindPipeline(pipeline.get());
+        if (indexed) {
+            cmd->BindIndexBuffer(indexBuffer.get(), 0, true);
+        }
+        for (const BufferView& view : views) {
+            cmd->BindVertexBuffers(0, std::span(&view, 1));
+            if (indexed) {
+                cmd->DrawIndexed(6);
+            } else {
+                cmd->Draw(6);
+            }
+        }
+        cmd->EndRenderPass();
+        cmd->End();
+        device->Submit(cmd.get());
+        device->Present();
+
+        // One VAO per index buffer, however many views are drawn
+        EXPECT_EQ(device->GetFrameStats().vertexArrayMisses, 1u) << (indexed ? "DrawIndexed" : "Draw");
+        auto pixels = target.ReadPixels();
+        for (uint32_t i = 0; i < ViewCount; ++i) {
+            const uint8_t* pixel = &pixels[(8 * 16 + 2 * i + 1) * 4];
+            EXPECT_EQ(pixel[1], 30 * (i + 1)) << "view " << i << (indexed ? ", DrawIndexed" : ", Draw");
+        }
+    }
+
+    for (const BufferView& view : views) {
+        allocator.Free(view);
+    }
+}
+
+TEST_F(OpenGL33BackendTest, TexturesAllocateImmutableStorage) {
+    if (!GLAD_GL_VERSION_4_2 && !GLAD_GL_ARB_texture_storage) {
+        GTEST_SKIP() << "Driver lacks glTexStorage";
+    }
+    auto texture = MakeTexture(*device, TextureType::Texture2D, TextureFormat::RGBA8_UNorm, 8, 4, 1);
+    ASSERT_NE(texture, nullptr);
+
+    // Restore the binding afterwards, the device's state cache still expects it
+    GLint previous = 0;
+    GLint immutable = GL_FALSE;
+    GLint levels = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+    glBindTexture(GL_TEXTURE_2D, static_cast<OpenGL33Texture*>(texture.get())->GetHandle());
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_IMMUTABLE_FORMAT, &immutable);
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_IMMUTABLE_LEVELS, &levels);
+    glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previous));
+    EXPECT_EQ(immutable, GL_TRUE);
+    EXPECT_EQ(levels, 4);
+
+    // Every level exists without being uploaded first
+    const std::array<uint8_t, 4> texel = {1, 2, 3, 4};
+    texture->Update(texel.data(), texel.size(), 3);
+    std::array<uint8_t, 4> out = {};
+    texture->Read(out.data(), out.size(), 3);
+    EXPECT_EQ(out, texel);
+}
+
+TEST_F(OpenGL33BackendTest, CubeArrayReadsBackEveryLayerFace) {
+    auto texture = MakeTexture(*device, TextureType::TextureCubeArray, TextureFormat::R8_UNorm, 4, 1, 2);
+    if (!texture) {
+        GTEST_SKIP() << "Driver lacks cube map arrays";
+    }
+
+    // One block with a face after another, each filled with its layer-face index
+    constexpr uint32_t kFaces = 12;
+    constexpr size_t kFaceSize = 4 * 4;
+    std::vector<uint8_t> block(kFaces * kFaceSize);
+    std::vector<TextureSubresourceData> subresources(kFaces);
+    for (uint32_t face = 0; face < kFaces; ++face) {
+        std::memset(block.data() + face * kFaceSize, static_cast<int>(face + 1), kFaceSize);
+        subresources[face].arrayLayer = face;
+        subresources[face].offset = face * kFaceSize;
+        subresources[face].size = kFaceSize;
+    }
+    texture->UpdateSubresources(block.data(), subresources);
+
+    for (uint32_t face = 0; face < kFaces; ++face) {
+        std::array<uint8_t, kFaceSize> out = {};
+        texture->Read(out.data(), out.size(), 0, face);
+        EXPECT_EQ(out.front(), face + 1) << "layer-face " << face;
+        EXPECT_EQ(out.back(), face + 1) << "layer-face " << face;
+    }
+}
+
+TEST_F(OpenGL33BackendTest, ArrayLayersReadBackOnTheirOwn) {
+    auto texture = MakeTexture(*device, TextureType::Texture2DArray, TextureFormat::RGBA8_UNorm, 2, 1, 3);
+    ASSERT_NE(texture, nullptr);
+
+    for (uint32_t layer = 0; layer < 3; ++layer) {
+        std::vector<uint32_t> texels(4, 0x01010101u * (layer + 1));
+        texture->Update(texels.data(), texels.size() * sizeof(uint32_t), 0, layer);
+    }
+
+    // A read fills only the caller's layer-sized buffer
+    std::array<uint32_t, 5> out;
+    out.fill(0xCDCDCDCDu);
+    texture->Read(out.data(), 4 * sizeof(uint32_t), 0, 1);
+    EXPECT_EQ(out[0], 0x02020202u);
+    EXPECT_EQ(out[3], 0x02020202u);
+    EXPECT_EQ(out[4], 0xCDCDCDCDu);
+}
+
+TEST_F(OpenGL33BackendTest, CompressedSubresourcesRoundTrip) {
+    if (!GLAD_GL_EXT_texture_compression_s3tc) {
+        GTEST_SKIP() << "Driver lacks S3TC";
+    }
+    auto texture = MakeTexture(*device, TextureType::Texture2DArray, TextureFormat::BC1_UNorm, 8, 1, 2);
+    ASSERT_NE(texture, nullptr);
+
+    // 8x8 BC1 is four 8-byte blocks per layer
+    constexpr size_t kLayerSize = 4 * 8;
+    std::vector<uint8_t> block(2 * kLayerSize);
+    for (size_t i = 0; i < block.size(); ++i) {
+        block[i] = static_cast<uint8_t>(i * 7 + 3);
+    }
+    const TextureSubresourceData subresources[] = {
+        {0, 0, 0, kLayerSize},
+        {0, 1, kLayerSize, kLayerSize},
+    };
+    texture->UpdateSubresources(block.data(), subresources);
+
+    for (uint32_t layer = 0; layer < 2; ++layer) {
+        std::array<uint8_t, kLayerSize> out = {};
+        texture->Read(out.data(), out.size(), 0, layer);
+        EXPECT_EQ(std::memcmp(out.data(), block.data() + layer * kLayerSize, kLayerSize), 0)
+            << "layer " << layer;
+    }
+}
+
+TEST_F(OpenGL33BackendTest, ShortSubresourcesAreSkipped) {
+    auto texture = MakeTexture(*device, TextureType::Texture2DArray, TextureFormat::RGBA8_UNorm, 2, 1, 2);
+    ASSERT_NE(texture, nullptr);
+
+    std::vector<uint32_t> texels(8, 0x11111111u);
+    texture->Update(texels.data(), 4 * sizeof(uint32_t), 0, 0);
+    texture->Update(texels.data(), 4 * sizeof(uint32_t), 0, 1);
+
+    // Layer 1's entry is a texel short, so only layer 0 is written
+    std::fill(texels.begin(), texels.end(), 0x22222222u);
+    const TextureSubresourceData subresources[] = {
+        {0, 0, 0, 4 * sizeof(uint32_t)},
+        {0, 1, 4 * sizeof(uint32_t), 3 * sizeof(uint32_t)},
+    };
+    texture->UpdateSubresources(texels.data(), subresources);
+    texture->Update(texels.data(), 2 * sizeof(uint32_t), 0, 1);
+
+    std::array<uint32_t, 4> out = {};
+    texture->Read(out.data(), sizeof(out), 0, 0);
+    EXPECT_EQ(out[3], 0x22222222u);
+    texture->Read(out.data(), sizeof(out), 0, 1);
+    EXPECT_EQ(out[0], 0x11111111u);
+    EXPECT_EQ(out[3], 0x11111111u);
+}
+
+TEST_F(OpenGL33BackendTest, ClearKeepsPipelineDepthWriteOff) {
+    constexpr uint32_t kSize = 8;
+    TextureDesc textureDesc{};
+    textureDesc.width = kSize;
+    textureDesc.height = kSize;
+    textureDesc.usage = TextureUsage::RenderTarget;
+    auto color = std::move(*device->CreateTexture(textureDesc));
+    textureDesc.format = TextureFormat::Depth32F;
+    textureDesc.usage = TextureUsage::DepthStencil;
+    auto depth = std::move(*device->CreateTexture(textureDesc));
+
+    AttachmentDesc attachmentDescs[2] = {};
+    attachmentDescs[1].format = TextureFormat::Depth32F;
+    RenderPassDesc passDesc{};
+    passDesc.attachments = attachmentDescs;
+    auto pass = std::move(*device->CreateRenderPass(passDesc));
+    Texture* attachments[] = {color.get(), depth.get()};
+    FramebufferDesc framebufferDesc{};
+    framebufferDesc.renderPass = pass.get();
+    framebufferDesc.attachments = attachments;
+    framebufferDesc.width = kSize;
+    framebufferDesc.height = kSize;
+    auto framebuffer = std::move(*device->CreateFramebuffer(framebufferDesc));
+
+    auto vs = MakeShader(*device, ShaderStage::Vertex, kColorVertexShader);
+    auto fs = MakeShader(*device, ShaderStage::Fragment, kColorFragmentShader);
+    VertexAttribute vertexAttributes[] = {
+        {0, 0, VertexFormat::Float3, 0},
+        {1, 0, VertexFormat::Float4, 12},
+    };
+    VertexBinding bindings[] = {{0, sizeof(ColorVertex), VertexInputRate::Vertex}};
+    PipelineDesc pipelineDesc{};
+    pipelineDesc.type = PipelineType::Graphics;
+    pipelineDesc.graphics.vertexShader = vs.get();
+    pipelineDesc.graphics.fragmentShader = fs.get();
+    pipelineDesc.graphics.vertexInput.attributes = vertexAttributes;
+    pipelineDesc.graphics.vertexInput.bindings = bindings;
+    pipelineDesc.graphics.depthStencil.depthWriteEnable = false;
+    auto pipeline = std::move(*device->CreatePipeline(pipelineDesc));
+
+    // A full-screen triangle at depth 0.5
+    const ColorVertex vertices[] = {
+        {-1, -1, 0,  0, 1, 0, 1}, { 3, -1, 0,  0, 1, 0, 1}, {-1,  3, 0,  0, 1, 0, 1},
+    };
+    auto vertexBuffer = MakeBuffer(*device, BufferUsage::Vertex, vertices, sizeof(vertices));
+
+    ClearValue clears[2] = {};
+    clears[1].depthStencil = {1.0f, 0};
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->BeginRenderPass(pass.get(), framebuffer.get(), {0, 0, kSize, kSize}, clears);
+    cmd->SetViewport({0, 0, float(kSize), float(kSize), 0, 1});
+    cmd->BindPipeline(pipeline.get());
+    Buffer* vertexBuffers[] = {vertexBuffer.get()};
+    cmd->BindVertexBuffers(0, vertexBuffers);
+    cmd->ClearDepthStencilAttachment({1.0f, 0}, {0, 0, kSize, kSize});
+    cmd->Draw(3);
+    cmd->EndRenderPass();
+    cmd->End();
+    device->Submit(cmd.get());
+
+    // The draw passes the depth test but must not write depth
+    std::vector<float> depths(kSize * kSize);
+    depth->Read(depths.data(), depths.size() * sizeof(float));
+    EXPECT_EQ(depths[(kSize / 2) * kSize + kSize / 2], 1.0f);
+    std::vector<uint8_t> pixels(kSize * kSize * 4);
+    color->Read(pixels.data(), pixels.size());
+    EXPECT_EQ(pixels[((kSize / 2) * kSize + kSize / 2) * 4 + 1], 255);
+}
+
+TEST_F(OpenGL33BackendTest, BufferUpdateStagesThroughTheRing) {
+    const uint32_t initial[4] = {1, 2, 3, 4};
+    auto buffer = MakeBuffer(*device, BufferUsage::Storage, initial, sizeof(initial));
+    ASSERT_NE(buffer, nullptr);
+    auto* uploads = static_cast<OpenGL33Device*>(device.get())->GetUploadQueue();
+    ASSERT_NE(uploads, nullptr);
+
+    const uint32_t values[2] = {7, 8};
+    buffer->Update(values, sizeof(values), 4);
+    EXPECT_GE(uploads->GetRing().GetFrameUsage(), sizeof(values));
+
+    uint32_t out[4] = {};
+    buffer->Read(out, sizeof(out));
+    EXPECT_EQ(out[0], 1u);
+    EXPECT_EQ(out[1], 7u);
+    EXPECT_EQ(out[2], 8u);
+    EXPECT_EQ(out[3], 4u);
+}
+
+TEST_F(OpenGL33BackendTest, DestroyedResourcesOutliveTheirFrame) {
+    auto target = MakeRenderTarget(*device, 16);
+    auto vs = MakeShader(*device, ShaderStage::Vertex, kColorVertexShader);
+    auto fs = MakeShader(*device, ShaderStage::Fragment, kColorFragmentShader);
+    auto pipeline = MakeColorPipeline(*device, vs.get(), fs.get());
+    const ColorVertex vertices[] = {
+        {-1, -1, 0,  0, 1, 0, 1}, { 3, -1, 0,  0, 1, 0, 1}, {-1,  3, 0,  0, 1, 0, 1},
+    };
+    auto vertexBuffer = MakeBuffer(*device, BufferUsage::Vertex, vertices, sizeof(vertices));
+    auto texture = MakeTexture(*device, TextureType::Texture2D, TextureFormat::RGBA8_UNorm, 4, 1, 1);
+    ASSERT_NE(texture, nullptr);
+    const GLuint buffer = static_cast<OpenGL33Buffer*>(vertexBuffer.get())->GetHandle();
+    const GLuint textureName = static_cast<OpenGL33Texture*>(texture.get())->GetHandle();
+
+    ClearValue clear{};
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->BeginRenderPass(target.pass.get(), target.framebuffer.get(), {0, 0, 16, 16}, std::span(&clear, 1));
+    cmd->SetViewport({0, 0, 16, 16, 0, 1});
+    cmd->BindPipeline(pipeline.get());
+    Buffer* vertexBuffers[] = {vertexBuffer.get()};
+    cmd->BindVertexBuffers(0, vertexBuffers);
+    cmd->Draw(3);
+    cmd->EndRenderPass();
+    cmd->End();
+    device->Submit(cmd.get());
+
+    // The submitted draw still reads the buffer, so its name lives on
+    auto& deletions = static_cast<OpenGL33Device*>(device.get())->GetDeletionQueue();
+    const size_t pending = deletions.GetPendingCount();
+    vertexBuffer.reset();
+    texture.reset();
+    EXPECT_EQ(deletions.GetPendingCount(), pending + 2);
+    EXPECT_TRUE(glIsBuffer(buffer));
+    EXPECT_TRUE(glIsTexture(textureName));
+    EXPECT_EQ(target.ReadPixels()[(8 * 16 + 8) * 4 + 1], 255);
+
+    // The frame's fence retires once the GPU is done, and the next frame deletes the batch
+    device->Present();
+    glFinish();
+    device->Present();
+    EXPECT_EQ(deletions.GetPendingCount(), 0u);
+    EXPECT_FALSE(glIsBuffer(buffer));
+    EXPECT_FALSE(glIsTexture(textureName));
+}
+
+TEST_F(OpenGL33BackendTest, ResourcesCanBeDestroyedOnAnyThread) {
+    auto& deletions = static_cast<OpenGL33Device*>(device.get())->GetDeletionQueue();
+    device->WaitIdle();
+
+    std::vector<std::unique_ptr<Buffer>> buffers;
+    const uint32_t value = 0;
+    for (int i = 0; i < 64; ++i) {
+        buffers.push_back(MakeBuffer(*device, BufferUsage::Uniform, &value, sizeof(value)));
+    }
+    auto texture = MakeTexture(*device, TextureType::Texture2D, TextureFormat::RGBA8_UNorm, 4, 1, 1);
+
+    // Two workers retire concurrently, without a context of their own
+    std::thread first([&] {
+        for (size_t i = 0; i < buffers.size() / 2; ++i) {
+            buffers[i].reset();
+        }
+    });
+    std::thread second([&] {
+        for (size_t i = buffers.size() / 2; i < buffers.size(); ++i) {
+            buffers[i].reset();
+        }
+        texture.reset();
+    });
+    first.join();
+    second.join();
+    EXPECT_EQ(deletions.GetPendingCount(), buffers.size() + 1);
+
+    device->WaitIdle();
+    EXPECT_EQ(deletions.GetPendingCount(), 0u);
+}
+
+TEST_F(OpenGL33BackendTest, RetiredNamesLeaveTheCaches) {
+    auto* glDevice = static_cast<OpenGL33Device*>(device.get());
+    auto& stateCache = glDevice->GetStateCache();
+    auto& vertexArrays = glDevice->GetVertexArrayCache();
+    device->WaitIdle();
+    vertexArrays.Clear();
+
+    auto target = MakeRenderTarget(*device, 16);
+    auto vs = MakeShader(*device, ShaderStage::Vertex, kColorVertexShader);
+    auto fs = MakeShader(*device, ShaderStage::Fragment, kColorFragmentShader);
+    auto pipeline = MakeColorPipeline(*device, vs.get(), fs.get());
+    const ColorVertex vertices[3] = {};
+    auto vertexBuffer = MakeBuffer(*device, BufferUsage::Vertex, vertices, sizeof(vertices));
+    const GLuint buffer = static_cast<OpenGL33Buffer*>(vertexBuffer.get())->GetHandle();
+
+    ClearValue clear{};
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->BeginRenderPass(target.pass.get(), target.framebuffer.get(), {0, 0, 16, 16}, std::span(&clear, 1));
+    cmd->BindPipeline(pipeline.get());
+    Buffer* vertexBuffers[] = {vertexBuffer.get()};
+    cmd->BindVertexBuffers(0, vertexBuffers);
+    cmd->Draw(3);
+    cmd->EndRenderPass();
+    cmd->End();
+    device->Submit(cmd.get());
+    EXPECT_EQ(vertexArrays.GetSize(), 1u);
+    stateCache.BindBuffer(GL_COPY_READ_BUFFER, buffer);
+
+    vertexBuffer.reset();
+    device->WaitIdle();
+    EXPECT_EQ(vertexArrays.GetSize(), 0u);
+
+    // A buffer created later may get the retired name, so binding it must
+    // reach GL; the name itself is gone, which GL reports as an error here
+    const uint64_t emitted = stateCache.GetCounters().emitted;
+    stateCache.BindBuffer(GL_COPY_READ_BUFFER, buffer);
+    EXPECT_EQ(stateCache.GetCounters().emitted, emitted + 1);
+    EXPECT_EQ(glGetError(), static_cast<GLenum>(GL_INVALID_OPERATION));
+    stateCache.Invalidate();
+}
+
+TEST_F(OpenGL33BackendTest, VertexArraysAreReusedAcrossRebinds) {
+    auto* glDevice = static_cast<OpenGL33Device*>(device.get());
+    auto& vertexArrays = glDevice->GetVertexArrayCache();
+    device->WaitIdle();
+    vertexArrays.Clear();
+    vertexArrays.ResetMissCount();
+
+    auto target = MakeRenderTarget(*device, 16);
+    auto vs = MakeShader(*device, ShaderStage::Vertex, kColorVertexShader);
+    auto fs = MakeShader(*device, ShaderStage::Fragment, kColorFragmentShader);
+    auto interleaved = MakeColorPipeline(*device, vs.get(), fs.get());
+
+    // Positions and colors from two vertex buffers
+    VertexAttribute attributes[] = {
+        {0, 0, VertexFormat::Float3, 0},
+        {1, 1, VertexFormat::Float4, 0},
+    };
+    VertexBinding bindings[] = {
+        {0, sizeof(ColorVertex), VertexInputRate::Vertex},
+        {1, 4 * sizeof(float), VertexInputRate::Vertex},
+    };
+    PipelineDesc pipelineDesc{};
+    pipelineDesc.type = PipelineType::Graphics;
+    pipelineDesc.graphics.vertexShader = vs.get();
+    pipelineDesc.graphics.fragmentShader = fs.get();
+    pipelineDesc.graphics.vertexInput.attributes = attributes;
+    pipelineDesc.graphics.vertexInput.bindings = bindings;
+    auto split = std::move(*device->CreatePipeline(pipelineDesc));
+
+    const ColorVertex vertices[3] = {};
+    const float colors[12] = {};
+    auto vertexBuffer = MakeBuffer(*device, BufferUsage::Vertex, vertices, sizeof(vertices));
+    auto colorBuffer = MakeBuffer(*device, BufferUsage::Vertex, colors, sizeof(colors));
+
+    // The second interleaved draw leaves a stale color buffer in slot 1,
+    // which the interleaved layout does not read
+    ClearValue clear{};
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->BeginRenderPass(target.pass.get(), target.framebuffer.get(), {0, 0, 16, 16}, std::span(&clear, 1));
+    Buffer* both[] = {vertexBuffer.get(), colorBuffer.get()};
+    cmd->BindPipeline(interleaved.get());
+    cmd->BindVertexBuffers(0, std::span(both, 1));
+    cmd->Draw(3);
+    cmd->BindPipeline(split.get());
+    cmd->BindVertexBuffers(0, both);
+    cmd->Draw(3);
+    cmd->BindPipeline(interleaved.get());
+    cmd->Draw(3);
+    cmd->EndRenderPass();
+    cmd->End();
+    device->Submit(cmd.get());
+    EXPECT_EQ(vertexArrays.GetMissCount(), 2u);
+    EXPECT_EQ(vertexArrays.GetSize(), 2u);
+
+    // Replaying the same bindings only hits
+    device->Submit(cmd.get());
+    EXPECT_EQ(vertexArrays.GetMissCount(), 2u);
+
+    // Destroying a buffer or a pipeline evicts the vertex arrays built from it
+    colorBuffer.reset();
+    device->WaitIdle();
+    EXPECT_EQ(vertexArrays.GetSize(), 1u);
+    interleaved.reset();
+    device->WaitIdle();
+    EXPECT_EQ(vertexArrays.GetSize(), 0u);
+}
+
+TEST_F(OpenGL33BackendTest, UnsubmittedFenceDoesNotBlock) {
+    auto fence = device->CreateFence();
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(fence->Wait());
+    EXPECT_FALSE(fence->IsSignaled());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+    EXPECT_EQ(fence->GetNativeHandle(), nullptr);
+
+    auto signaled = device->CreateFence(true);
+    EXPECT_TRUE(signaled->Wait(0));
+    EXPECT_TRUE(signaled->IsSignaled());
+}
+
+TEST_F(OpenGL33BackendTest, FenceSignalsAfterSubmissionAndResets) {
+    auto fence = device->CreateFence();
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->End();
+    device->Submit(cmd.get(), fence.get());
+    EXPECT_NE(fence->GetNativeHandle(), nullptr);
+    device->WaitIdle();
+    EXPECT_TRUE(fence->IsSignaled());
+
+    // A reset fence is unsignaled until the next submission reaches it
+    fence->Reset();
+    EXPECT_FALSE(fence->IsSignaled());
+    EXPECT_FALSE(fence->Wait(0));
+    device->Submit(cmd.get(), fence.get());
+    EXPECT_TRUE(fence->Wait());
+    EXPECT_TRUE(fence->IsSignaled());
+}
+
+TEST_F(OpenGL33BackendTest, FenceWaitTimesOutWhileTheGpuIsBusy) {
+    constexpr uint32_t kSize = 256;
+    const char* slowFragmentShader = R"(
+#version 450
+layout (location = 0) in vec4 vColor;
+layout (location = 0) out vec4 FragColor;
+void main() {
+    vec4 color = vColor + gl_FragCoord;
+    for (int i = 0; i < 1024; ++i) { color = fract(color * 1.0001 + 0.0001); }
+    FragColor = color;
+}
+)";
+    auto target = MakeRenderTarget(*device, kSize);
+    auto vs = MakeShader(*device, ShaderStage::Vertex, kColorVertexShader);
+    auto fs = MakeShader(*device, ShaderStage::Fragment, slowFragmentShader);
+    auto pipeline = MakeColorPipeline(*device, vs.get(), fs.get());
+    const ColorVertex vertices[] = {
+        {-1, -1, 0,  0, 1, 0, 1}, { 3, -1, 0,  0, 1, 0, 1}, {-1,  3, 0,  0, 1, 0, 1},
+    };
+    auto vertexBuffer = MakeBuffer(*device, BufferUsage::Vertex, vertices, sizeof(vertices));
+
+    ClearValue clear{};
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->BeginRenderPass(target.pass.get(), target.framebuffer.get(), {0, 0, kSize, kSize}, std::span(&clear, 1));
+    cmd->SetViewport({0, 0, float(kSize), float(kSize), 0, 1});
+    cmd->BindPipeline(pipeline.get());
+    Buffer* vertexBuffers[] = {vertexBuffer.get()};
+    cmd->BindVertexBuffers(0, vertexBuffers);
+    cmd->Draw(3);
+    cmd->EndRenderPass();
+    cmd->End();
+
+    // The first submission also pays for compiling the shader
+    device->Submit(cmd.get());
+    device->WaitIdle();
+
+    auto fence = device->CreateFence();
+    device->Submit(cmd.get(), fence.get());
+    EXPECT_FALSE(fence->Wait(0));
+    EXPECT_TRUE(fence->Wait());
+    EXPECT_TRUE(fence->IsSignaled());
+}
+TEST_F(OpenGL33BackendTest, BufferReadbackCompletesOnTheGpu) {
+    std::array<uint32_t, 64> values{};
+    for (uint32_t i = 0; i < values.size(); ++i) {
+        values[i] = i * 3 + 1;
+    }
+    auto buffer = MakeBuffer(*device, BufferUsage::Storage | BufferUsage::TransferSrc, values.data(), sizeof(values));
+    ASSERT_NE(buffer, nullptr);
+
+    ReadbackQueue readbacks(*device);
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    auto ticket = readbacks.ReadBuffer(*cmd, *buffer, 16 * sizeof(uint32_t), 32 * sizeof(uint32_t));
+    cmd->End();
+    ASSERT_TRUE(ticket.has_value());
+    EXPECT_FALSE(ticket->IsReady());
+    readbacks.Submit(*cmd);
+
+    std::array<uint32_t, 32> result{};
+    ASSERT_TRUE(ticket->Read(result.data(), sizeof(result)));
+    for (uint32_t i = 0; i < result.size(); ++i) {
+        EXPECT_EQ(result[i], values[i + 16]);
+    }
+}
+
+TEST_F(OpenGL33BackendTest, ArrayLayerReadbacksShareOneFramebuffer) {
+    auto texture = MakeTexture(*device, TextureType::Texture2DArray, TextureFormat::RGBA8_UNorm, 4, 1, 3);
+    ASSERT_NE(texture, nullptr);
+    for (uint32_t layer = 0; layer < 3; ++layer) {
+        std::vector<uint32_t> texels(16, 0x01010101u * (layer + 1));
+        texture->Update(texels.data(), texels.size() * sizeof(uint32_t), 0, layer);
+    }
+    auto* glDevice = static_cast<OpenGL33Device*>(device.get());
+    const unsigned int framebuffer = glDevice->GetReadFramebuffer();
+
+    ReadbackQueue readbacks(*device);
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    auto last = readbacks.ReadTexture(*cmd, *texture, 0, 2);
+    auto first = readbacks.ReadTexture(*cmd, *texture, 0, 0);
+    cmd->End();
+    ASSERT_TRUE(last.has_value());
+    ASSERT_TRUE(first.has_value());
+    readbacks.Submit(*cmd);
+
+    std::array<uint32_t, 16> result{};
+    ASSERT_TRUE(last->Read(result.data(), sizeof(result)));
+    EXPECT_EQ(result[0], 0x03030303u);
+    EXPECT_EQ(result[15], 0x03030303u);
+    ASSERT_TRUE(first->Read(result.data(), sizeof(result)));
+    EXPECT_EQ(result[0], 0x01010101u);
+    EXPECT_EQ(result[15], 0x01010101u);
+
+    // The copies neither create framebuffers nor leave the layer attached
+    EXPECT_EQ(glDevice->GetReadFramebuffer(), framebuffer);
+    GLint binding = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &binding);
+    ASSERT_NE(static_cast<GLuint>(binding), framebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    GLint attached = -1;
+    glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                          GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &attached);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(binding));
+    EXPECT_EQ(attached, GL_NONE);
+    EXPECT_EQ(glGetError(), static_cast<GLenum>(GL_NO_ERROR));
+}
+
+TEST_F(OpenGL33BackendTest, CompressedCopiesNeedWholeBlocks) {
+    if (!GLAD_GL_EXT_texture_compression_s3tc) {
+        GTEST_SKIP() << "Driver lacks S3TC";
+    }
+    // 6x6 BC1 rounds up to 2x2 blocks of 8 bytes
+    constexpr size_t kLevelSize = 4 * 8;
+    auto texture = MakeTexture(*device, TextureType::Texture2D, TextureFormat::BC1_UNorm, 6, 1, 1);
+    ASSERT_NE(texture, nullptr);
+    std::array<uint8_t, kLevelSize> blocks{};
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        blocks[i] = static_cast<uint8_t>(i * 5 + 1);
+    }
+    texture->Update(blocks.data(), blocks.size());
+
+    std::array<uint8_t, kLevelSize> sentinel;
+    sentinel.fill(0xCD);
+    auto exact = MakeBuffer(*device, BufferUsage::TransferDst, sentinel.data(), kLevelSize);
+    auto tooSmall = MakeBuffer(*device, BufferUsage::TransferDst, sentinel.data(), kLevelSize / 2);
+    ASSERT_NE(exact, nullptr);
+    ASSERT_NE(tooSmall, nullptr);
+
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->CopyTextureToBuffer(texture.get(), exact.get(), 0, 0);
+    cmd->CopyTextureToBuffer(texture.get(), tooSmall.get(), 0, 0);
+    cmd->End();
+    device->Submit(cmd.get());
+    EXPECT_EQ(glGetError(), static_cast<GLenum>(GL_NO_ERROR));
+
+    std::array<uint8_t, kLevelSize> out{};
+    exact->Read(out.data(), out.size());
+    EXPECT_EQ(out, blocks);
+    tooSmall->Read(out.data(), kLevelSize / 2);
+    EXPECT_EQ(std::memcmp(out.data(), sentinel.data(), kLevelSize / 2), 0);
+}
+
+TEST_F(OpenGL33BackendTest, RedundantBindsAreFiltered) {
+    auto target = MakeRenderTarget(*device, 16);
+    auto vs = MakeShader(*device, ShaderStage::Vertex, kColorVertexShader);
+    auto fs = MakeShader(*device, ShaderStage::Fragment, kColorFragmentShader);
+    auto pipeline = MakeColorPipeline(*device, vs.get(), fs.get());
+    auto texture = MakeTexture(*device, TextureType::Texture2D, TextureFormat::RGBA8_UNorm, 4, 1, 1);
+    const ColorVertex vertices[3] = {};
+    auto vertexBuffer = MakeBuffer(*device, BufferUsage::Vertex, vertices, sizeof(vertices));
+    ASSERT_NE(pipeline, nullptr);
+    ASSERT_NE(texture, nullptr);
+
+    // Two draws, with the pipeline and texture bound once or before each draw
+    auto record = [&](bool rebind) {
+        ClearValue clear{};
+        auto cmd = device->CreateCommandBuffer();
+        cmd->Begin();
+        cmd->BeginRenderPass(target.pass.get(), target.framebuffer.get(), {0, 0, 16, 16}, std::span(&clear, 1));
+        Buffer* vertexBuffers[] = {vertexBuffer.get()};
+        cmd->BindVertexBuffers(0, vertexBuffers);
+        for (int draw = 0; draw < 2; ++draw) {
+            if (draw == 0 || rebind) {
+                cmd->BindPipeline(pipeline.get());
+                cmd->BindTexture(0, texture.get());
+            }
+            cmd->Draw(3);
+        }
+        cmd->EndRenderPass();
+        cmd->End();
+        return cmd;
+    };
+    auto once = record(false);
+    auto twice = record(true);
+
+    // Both leave the context in the same state, so each frame starts alike
+    device->Submit(once.get());
+    device->Present();
+    device->Submit(once.get());
+    device->Present();
+    const FrameStats bindOnce = device->GetFrameStats();
+    device->Submit(twice.get());
+    device->Present();
+    const FrameStats bindTwice = device->GetFrameStats();
+
+    EXPECT_EQ(bindTwice.stateChangesEmitted, bindOnce.stateChangesEmitted);
+    EXPECT_GT(bindTwice.stateChangesFiltered, bindOnce.stateChangesFiltered);
+}
+
+// ============================================================================
+// OpenGL 4.6
+// ============================================================================
+
+TEST_F(OpenGL46BackendTest, DeviceReportsOpenGL46) {
+    EXPECT_EQ(device->GetBackendType(), BackendType::OpenGL46);
+    EXPECT_TRUE(device->IsFeatureSupported(Feature::Compute));
+    EXPECT_EQ(device->GetSwapChain(), nullptr);
+}
+
+TEST_F(OpenGL46BackendTest, BufferUpdateAndReadRoundTrip) {
+    const uint32_t initial[4] = {1, 2, 3, 4};
+    auto buffer = MakeBuffer(*device, BufferUsage::Storage, initial, sizeof(initial));
+    ASSERT_NE(buffer, nullptr);
+
+    uint32_t out[4] = {};
+    buffer->Read(out, sizeof(out));
+    EXPECT_EQ(out[2], 3u);
+
+    const uint32_t value = 99;
+    buffer->Update(&value, sizeof(value), 8);
+    buffer->Read(out, sizeof(out));
+    EXPECT_EQ(out[1], 2u);
+    EXPECT_EQ(out[2], 99u);
+
+    // GPU-only buffers map on demand
+    auto* mapped = static_cast<uint32_t*>(buffer->Map(4, 8, MapAccess::Read));
+    ASSERT_NE(mapped, nullptr);
+    EXPECT_EQ(mapped[0], 2u);
+    EXPECT_EQ(mapped[1], 99u);
+    buffer->Unmap();
+}
+
+TEST_F(OpenGL46BackendTest, PersistentMappingStaysOpen) {
+    BufferDesc desc{};
+    desc.size = 16;
+    desc.usage = BufferUsage::Storage;
+    desc.memoryAccess = MemoryAccess::CpuToGpu;
+    auto buffer = std::move(*device->CreateBuffer(desc));
+
+    auto* mapped = static_cast<uint32_t*>(buffer->Map());
+    ASSERT_NE(mapped, nullptr);
+    mapped[0] = 42;
+    buffer->Unmap();
+
+    // Unmap() leaves the coherent mapping in place, so writes need no flush
+    EXPECT_EQ(buffer->Map(), mapped);
+    mapped[3] = 7;
+    buffer->Unmap();
+    uint32_t out[4] = {};
+    buffer->Read(out, sizeof(out));
+    EXPECT_EQ(out[0], 42u);
+    EXPECT_EQ(out[3], 7u);
+}
+
+TEST_F(OpenGL46BackendTest, MapWaitsForTheGpu) {
+    auto shader = MakeShader(*device, ShaderStage::Compute, kFillShader);
+    auto pipeline = MakeComputePipeline(*device, shader.get());
+    ASSERT_NE(pipeline, nullptr);
+
+    BufferDesc desc{};
+    desc.size = 32 * sizeof(uint32_t);
+    desc.usage = BufferUsage::Storage;
+    desc.memoryAccess = MemoryAccess::CpuOnly;
+    auto buffer = std::move(*device->CreateBuffer(desc));
+
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->BindPipeline(pipeline.get());
+    cmd->BindStorageBuffer(1, buffer.get());
+    const uint32_t add = 7;
+    cmd->PushConstants(ShaderStage::Compute, 0, std::as_bytes(std::span(&add, 1)));
+    cmd->Dispatch(4);
+    cmd->PipelineBarrier();
+    cmd->End();
+    device->Submit(cmd.get());
+
+    // The persistent mapping is read directly, so Map() must have waited
+    const auto* mapped = static_cast<const uint32_t*>(buffer->Map(0, desc.size, MapAccess::Read));
+    ASSERT_NE(mapped, nullptr);
+    EXPECT_EQ(mapped[0], 7u);
+    EXPECT_EQ(mapped[31], 69u);
+    buffer->Unmap();
+}
+
+TEST_F(OpenGL46BackendTest, StreamingBufferWritesIdleCopyEachFrame) {
+    auto shader = MakeShader(*device, ShaderStage::Compute, kGatherShader);
+    auto pipeline = MakeComputePipeline(*device, shader.get());
+    ASSERT_NE(pipeline, nullptr);
+
+    // Auto streams CpuToGpu buffers round robin
+    BufferDesc desc{};
+    desc.size = 16;
+    desc.usage = BufferUsage::Storage;
+    desc.memoryAccess = MemoryAccess::CpuToGpu;
+    desc.streamingCopies = 3;
+    auto source = std::move(*device->CreateBuffer(desc));
+    desc.memoryAccess = MemoryAccess::GpuOnly;
+    auto gathered = std::move(*device->CreateBuffer(desc));
+
+    constexpr uint32_t FrameCount = 4;
+    std::array<void*, FrameCount> mappings{};
+    for (uint32_t frame = 0; frame < FrameCount; ++frame) {
+        void* mapped = source->Map(0, 16, MapAccess::Write | MapAccess::InvalidateBuffer);
+        ASSERT_NE(mapped, nullptr);
+        const uint32_t value = 100 + frame;
+        std::memcpy(mapped, &value, sizeof(value));
+        source->Unmap();
+        mappings[frame] = mapped;
+
+        auto cmd = device->CreateCommandBuffer();
+        cmd->Begin();
+        cmd->BindPipeline(pipeline.get());
+        cmd->BindStorageBuffer(0, source.get());
+        cmd->BindStorageBuffer(1, gathered.get());
+        cmd->PushConstants(ShaderStage::Compute, 0, std::as_bytes(std::span(&frame, 1)));
+        cmd->Dispatch(1);
+        cmd->PipelineBarrier();
+        cmd->End();
+        device->Submit(cmd.get());
+        device->Present();
+    }
+
+    // Each frame wrote the next of the three copies
+    EXPECT_NE(mappings[0], mappings[1]);
+    EXPECT_NE(mappings[1], mappings[2]);
+    EXPECT_EQ(mappings[3], mappings[0]);
+    uint32_t out[FrameCount] = {};
+    gathered->Read(out, sizeof(out));
+    for (uint32_t frame = 0; frame < FrameCount; ++frame) {
+        EXPECT_EQ(out[frame], 100 + frame) << "frame " << frame;
+    }
+}
+
+TEST_F(OpenGL46BackendTest, ComputeWritesBoundStorageBufferRanges) {
+    auto shader = MakeShader(*device, ShaderStage::Compute, kFillShader);
+    ASSERT_NE(shader, nullptr);
+    auto pipeline = MakeComputePipeline(*device, shader.get());
+    ASSERT_NE(pipeline, nullptr);
+
+    BufferDesc desc{};
+    desc.size = 64 * sizeof(uint32_t);
+    desc.usage = BufferUsage::Storage;
+    auto buffer = std::move(*device->CreateBuffer(desc));
+    const uint32_t groups[3] = {4, 1, 1};
+    auto indirect = MakeBuffer(*device, BufferUsage::Indirect, groups, sizeof(groups));
+
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->BindPipeline(pipeline.get());
+    cmd->BindStorageBuffer(1, buffer.get());
+    uint32_t add = 1000;
+    cmd->PushConstants(ShaderStage::Compute, 0, std::as_bytes(std::span(&add, 1)));
+    cmd->Dispatch(4);
+    cmd->PipelineBarrier();
+    cmd->BindStorageBuffer(1, buffer.get(), 128, 128);
+    add = 5000;
+    cmd->PushConstants(ShaderStage::Compute, 0, std::as_bytes(std::span(&add, 1)));
+    cmd->DispatchIndirect(indirect.get(), 0);
+    cmd->PipelineBarrier();
+    cmd->End();
+    device->Submit(cmd.get());
+
+    uint32_t out[64] = {};
+    buffer->Read(out, sizeof(out));
+    EXPECT_EQ(out[0], 1000u);
+    EXPECT_EQ(out[31], 1062u);
+    EXPECT_EQ(out[32], 5000u);
+    EXPECT_EQ(out[63], 5062u);
+}
+
+TEST_F(OpenGL46BackendTest, MultiDrawIndirectIssuesOneDrawCall) {
+    auto target = MakeRenderTarget(*device, 16);
+    ASSERT_NE(target.framebuffer, nullptr);
+    auto vs = MakeShader(*device, ShaderStage::Vertex, kColorVertexShader);
+    auto fs = MakeShader(*device, ShaderStage::Fragment, kColorFragmentShader);
+    auto pipeline = MakeColorPipeline(*device, vs.get(), fs.get());
+    ASSERT_NE(pipeline, nullptr);
+
+    // A green triangle over the left half and a blue one over the right
+    const ColorVertex vertices[] = {
+        {-1, -1, 0,  0, 1, 0, 1}, { 0, -1, 0,  0, 1, 0, 1}, {-1,  3, 0,  0, 1, 0, 1},
+        { 0, -1, 0,  0, 0, 1, 1}, { 3, -1, 0,  0, 0, 1, 1}, { 0,  3, 0,  0, 0, 1, 1},
+    };
+    auto vertexBuffer = MakeBuffer(*device, BufferUsage::Vertex, vertices, sizeof(vertices));
+    // vertexCount, instanceCount, firstVertex, firstInstance
+    const uint32_t commands[8] = {3, 1, 0, 0,  3, 1, 3, 0};
+    auto indirect = MakeBuffer(*device, BufferUsage::Indirect, commands, sizeof(commands));
+
+    ClearValue clear{};
+    clear.color = ClearColorValue(0, 0, 0, 1);
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->BeginRenderPass(target.pass.get(), target.framebuffer.get(), {0, 0, 16, 16}, std::span(&clear, 1));
+    cmd->SetViewport({0, 0, 16, 16, 0, 1});
+    cmd->BindPipeline(pipeline.get());
+    Buffer* vertexBuffers[] = {vertexBuffer.get()};
+    cmd->BindVertexBuffers(0, vertexBuffers);
+    cmd->DrawIndirect(indirect.get(), 0, 2, 16);
+    cmd->EndRenderPass();
+    cmd->End();
+    device->Submit(cmd.get());
+    device->Present();
+
+    EXPECT_EQ(device->GetFrameStats().drawCalls, 1u);
+    auto pixels = target.ReadPixels();
+    const uint8_t* left = &pixels[(8 * 16 + 2) * 4];
+    const uint8_t* right = &pixels[(8 * 16 + 13) * 4];
+    EXPECT_EQ(left[1], 255);
+    EXPECT_EQ(left[2], 0);
+    EXPECT_EQ(right[1], 0);
+    EXPECT_EQ(right[2], 255);
+}
+
+TEST_F(OpenGL46BackendTest, SkippedDrawKeepsPushConstantsInStep) {
+    const auto center = DrawAfterSkippedIndirectDraw(*device);
+    EXPECT_EQ(center[0], 0);
+    EXPECT_EQ(center[1], 255);
+    EXPECT_EQ(center[2], 0);
+}
+
+TEST_F(OpenGL46BackendTest, BufferUpdatesWriteByName) {
+    const uint32_t initial[4] = {};
+    auto buffer = MakeBuffer(*device, BufferUsage::Storage, initial, sizeof(initial));
+    ASSERT_NE(buffer, nullptr);
+    GLint copyRead = 0;
+    GLint copyWrite = 0;
+    glGetIntegerv(GL_COPY_READ_BUFFER_BINDING, &copyRead);
+    glGetIntegerv(GL_COPY_WRITE_BUFFER_BINDING, &copyWrite);
+
+    // Staged, and too large for the ring; neither binds the buffer
+    const uint32_t values[4] = {1, 2, 3, 4};
+    buffer->Update(values, sizeof(values));
+    std::vector<uint8_t> large(OpenGL33UploadQueue::MaxStagedSize + 16, 0x5A);
+    auto largeBuffer = MakeBuffer(*device, BufferUsage::Storage, nullptr, large.size());
+    ASSERT_NE(largeBuffer, nullptr);
+    largeBuffer->Update(large.data(), large.size());
+
+    GLint binding = 0;
+    glGetIntegerv(GL_COPY_READ_BUFFER_BINDING, &binding);
+    EXPECT_EQ(binding, copyRead);
+    glGetIntegerv(GL_COPY_WRITE_BUFFER_BINDING, &binding);
+    EXPECT_EQ(binding, copyWrite);
+
+    uint32_t out[4] = {};
+    buffer->Read(out, sizeof(out));
+    EXPECT_EQ(out[3], 4u);
+    uint8_t tail = 0;
+    largeBuffer->Read(&tail, 1, large.size() - 1);
+    EXPECT_EQ(tail, 0x5A);
+}
+
+TEST_F(OpenGL46BackendTest, AsyncUpdatesLandAtPresent) {
+    const uint32_t zeros[4] = {};
+    auto buffer = MakeBuffer(*device, BufferUsage::Storage, zeros, sizeof(zeros));
+    ASSERT_NE(buffer, nullptr);
+    const GLuint handle = static_cast<OpenGL33Buffer*>(buffer.get())->GetHandle();
+
+    const uint32_t values[4] = {5, 6, 7, 8};
+    buffer->UpdateAsync(values, sizeof(values));
+
+    // Read() would flush the batch; reading the GL buffer directly does not
+    uint32_t out[4] = {};
+    glGetNamedBufferSubData(handle, 0, sizeof(out), out);
+    EXPECT_EQ(out[0], 0u);
+
+    device->Present();
+    glGetNamedBufferSubData(handle, 0, sizeof(out), out);
+    EXPECT_EQ(out[0], 5u);
+    EXPECT_EQ(out[3], 8u);
+
+    const FrameStats stats = device->GetFrameStats();
+    EXPECT_EQ(stats.bytesUploaded, sizeof(values));
+    EXPECT_GT(stats.uploadMegabytesPerSecond, 0.0);
+}
+
+TEST_F(OpenGL46BackendTest, UploadRingWrapsAndReclaimsByFence) {
+    auto* uploads = static_cast<OpenGL33Device*>(device.get())->GetUploadQueue();
+    ASSERT_NE(uploads, nullptr);
+    const OpenGL33TransientAllocator& ring = uploads->GetRing();
+
+    // Staged, and three frames of it overflow the ring
+    constexpr size_t kSize = 3 << 20;
+    auto buffer = MakeBuffer(*device, BufferUsage::Storage, nullptr, kSize);
+    ASSERT_NE(buffer, nullptr);
+    std::vector<uint8_t> data(kSize);
+    for (int frame = 0; frame < 8; ++frame) {
+        std::fill(data.begin(), data.end(), static_cast<uint8_t>(frame + 1));
+        buffer->Update(data.data(), data.size());
+        EXPECT_GE(ring.GetFrameUsage(), kSize) << "frame " << frame;
+
+        device->WaitIdle();
+        device->Present();
+        uint8_t last = 0;
+        buffer->Read(&last, 1, kSize - 1);
+        EXPECT_EQ(last, frame + 1) << "frame " << frame;
+    }
+
+    // Retired frames were recycled instead of growing the ring
+    EXPECT_EQ(ring.GetCapacity(), OpenGL33UploadQueue::RingCapacity);
+    EXPECT_LE(ring.GetFramesInFlight(), 1u);
+    EXPECT_GE(device->GetFrameStats().bytesUploaded, kSize);
+    EXPECT_GT(device->GetFrameStats().uploadMegabytesPerSecond, 0.0);
+}
+
+TEST_F(OpenGL46BackendTest, StaleGLErrorsDoNotFailCreation) {
+    // An error left behind by someone else's call
+    glBindBuffer(GL_ARRAY_BUFFER, 0xFFFFu);
+    auto buffer = MakeBuffer(*device, BufferUsage::Storage, nullptr, 64);
+    EXPECT_NE(buffer, nullptr);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0xFFFFu);
+    auto texture = MakeTexture(*device, TextureType::Texture2D, TextureFormat::RGBA8_UNorm, 4, 1, 1);
+    EXPECT_NE(texture, nullptr);
+}
+
+TEST_F(OpenGL46BackendTest, TexturesAreEditedByName) {
+    GLint binding2D = 0;
+    GLint bindingArray = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &binding2D);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &bindingArray);
+
+    auto texture = MakeTexture(*device, TextureType::Texture2DArray, TextureFormat::RGBA8_UNorm, 4, 3, 2);
+    ASSERT_NE(texture, nullptr);
+    for (uint32_t layer = 0; layer < 2; ++layer) {
+        std::vector<uint32_t> texels(16, 0x01010101u * (layer + 1));
+        texture->Update(texels.data(), texels.size() * sizeof(uint32_t), 0, layer);
+    }
+    texture->GenerateMipmaps(nullptr);
+
+    // Each layer of each level reads back on its own
+    for (uint32_t layer = 0; layer < 2; ++layer) {
+        std::array<uint32_t, 16> out = {};
+        texture->Read(out.data(), sizeof(out), 0, layer);
+        EXPECT_EQ(out[15], 0x01010101u * (layer + 1));
+        uint32_t smallest = 0;
+        texture->Read(&smallest, sizeof(smallest), 2, layer);
+        EXPECT_EQ(smallest, 0x01010101u * (layer + 1));
+    }
+
+    GLint binding = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &binding);
+    EXPECT_EQ(binding, binding2D);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &binding);
+    EXPECT_EQ(binding, bindingArray);
+
+    GLint immutable = GL_FALSE;
+    glGetTextureParameteriv(static_cast<OpenGL33Texture*>(texture.get())->GetHandle(),
+                            GL_TEXTURE_IMMUTABLE_FORMAT, &immutable);
+    EXPECT_EQ(immutable, GL_TRUE);
+}
+
+TEST_F(OpenGL46BackendTest, CubeArrayFacesReadBackByName) {
+    auto texture = MakeTexture(*device, TextureType::TextureCubeArray, TextureFormat::R8_UNorm, 4, 1, 2);
+    ASSERT_NE(texture, nullptr);
+
+    constexpr uint32_t kFaces = 12;
+    constexpr size_t kFaceSize = 4 * 4;
+    std::vector<uint8_t> block(kFaces * kFaceSize);
+    std::vector<TextureSubresourceData> subresources(kFaces);
+    for (uint32_t face = 0; face < kFaces; ++face) {
+        std::memset(block.data() + face * kFaceSize, static_cast<int>(face + 1), kFaceSize);
+        subresources[face] = {0, face, face * kFaceSize, kFaceSize};
+    }
+    texture->UpdateSubresources(block.data(), subresources);
+
+    for (uint32_t face = 0; face < kFaces; ++face) {
+        std::array<uint8_t, kFaceSize> out = {};
+        texture->Read(out.data(), out.size(), 0, face);
+        EXPECT_EQ(out.front(), face + 1) << "layer-face " << face;
+        EXPECT_EQ(out.back(), face + 1) << "layer-face " << face;
+    }
+}
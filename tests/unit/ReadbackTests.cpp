@@ -0,0 +1,173 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include <VRHI/VRHIAll.hpp>
+#include <gtest/gtest.h>
+#include <array>
+#include <cstring>
+#include <vector>
+
+// Include internal headers for testing
+#include "../../src/Core/NullDevice.hpp"
+
+using namespace VRHI;
+
+namespace {
+
+std::unique_ptr<Device> MakeSoftwareDevice() {
+    DeviceConfig config{};
+    config.preferredBackend = BackendType::Software;
+    auto device = CreateDevice(config);
+    EXPECT_TRUE(device.has_value()) << (device ? "" : device.error().message);
+    return device ? std::move(*device) : nullptr;
+}
+
+std::unique_ptr<Buffer> MakeBuffer(Device& device, size_t size, const void* data = nullptr) {
+    BufferDesc desc{};
+    desc.size = size;
+    desc.usage = BufferUsage::Storage | BufferUsage::TransferSrc;
+    desc.initialData = data;
+    auto buffer = device.CreateBuffer(desc);
+    EXPECT_TRUE(buffer.has_value());
+    return buffer ? std::move(*buffer) : nullptr;
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// Readback Queue Tests
+// ============================================================================
+
+TEST(ReadbackTest, BufferReadbackCompletesAfterSubmit) {
+    auto device = MakeSoftwareDevice();
+    ASSERT_NE(device, nullptr);
+
+    std::array<uint32_t, 64> values{};
+    for (uint32_t i = 0; i < values.size(); ++i) {
+        values[i] = i * 3 + 1;
+    }
+    auto buffer = MakeBuffer(*device, sizeof(values), values.data());
+    ASSERT_NE(buffer, nullptr);
+
+    ReadbackQueue readbacks(*device);
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    auto ticket = readbacks.ReadBuffer(*cmd, *buffer, 16 * sizeof(uint32_t), 32 * sizeof(uint32_t));
+    cmd->End();
+    ASSERT_TRUE(ticket.has_value());
+    EXPECT_EQ(ticket->GetSize(), 32 * sizeof(uint32_t));
+
+    // Nothing has been submitted yet
+    EXPECT_FALSE(ticket->IsReady());
+    EXPECT_FALSE(ticket->Wait(0));
+
+    readbacks.Submit(*cmd);
+    EXPECT_TRUE(ticket->IsReady());
+
+    std::array<uint32_t, 32> result{};
+    ASSERT_TRUE(ticket->Read(result.data(), sizeof(result)));
+    for (uint32_t i = 0; i < result.size(); ++i) {
+        EXPECT_EQ(result[i], values[i + 16]);
+    }
+}
+
+TEST(ReadbackTest, TextureReadbackReturnsLayer) {
+    auto device = MakeSoftwareDevice();
+    ASSERT_NE(device, nullptr);
+
+    TextureDesc desc{};
+    desc.type = TextureType::Texture2DArray;
+    desc.format = TextureFormat::RGBA8_UNorm;
+    desc.usage = TextureUsage::Sampled | TextureUsage::TransferSrc;
+    desc.width = 4;
+    desc.height = 2;
+    desc.arrayLayers = 3;
+    auto texture = device->CreateTexture(desc);
+    ASSERT_TRUE(texture.has_value());
+
+    std::vector<uint8_t> layer(4 * 2 * 4);
+    for (size_t i = 0; i < layer.size(); ++i) {
+        layer[i] = static_cast<uint8_t>(i + 100);
+    }
+    (*texture)->Update(layer.data(), layer.size(), 0, 2);
+
+    ReadbackQueue readbacks(*device);
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    auto ticket = readbacks.ReadTexture(*cmd, **texture, 0, 2);
+    cmd->End();
+    ASSERT_TRUE(ticket.has_value());
+    EXPECT_EQ(ticket->GetSize(), layer.size());
+    readbacks.Submit(*cmd);
+
+    std::vector<uint8_t> result(layer.size());
+    ASSERT_TRUE(ticket->Read(result.data(), result.size()));
+    EXPECT_EQ(result, layer);
+}
+
+TEST(ReadbackTest, OutOfRangeRequestsFail) {
+    auto device = std::make_unique<NullDevice>();
+    auto buffer = MakeBuffer(*device, 256);
+    ASSERT_NE(buffer, nullptr);
+
+    TextureDesc desc{};
+    desc.width = 8;
+    desc.height = 8;
+    desc.mipLevels = 2;
+    auto texture = device->CreateTexture(desc);
+    ASSERT_TRUE(texture.has_value());
+
+    ReadbackQueue readbacks(*device);
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+
+    auto pastEnd = readbacks.ReadBuffer(*cmd, *buffer, 128, 129);
+    ASSERT_FALSE(pastEnd.has_value());
+    EXPECT_EQ(pastEnd.error().code, Error::Code::InvalidConfig);
+    EXPECT_FALSE(readbacks.ReadBuffer(*cmd, *buffer, 0, 0).has_value());
+
+    auto badMip = readbacks.ReadTexture(*cmd, **texture, 2);
+    ASSERT_FALSE(badMip.has_value());
+    EXPECT_EQ(badMip.error().code, Error::Code::InvalidConfig);
+    EXPECT_FALSE(readbacks.ReadTexture(*cmd, **texture, 0, 1).has_value());
+
+    // A mip level is tightly packed
+    auto mip = readbacks.ReadTexture(*cmd, **texture, 1);
+    ASSERT_TRUE(mip.has_value());
+    EXPECT_EQ(mip->GetSize(), 4u * 4u * 4u);
+    EXPECT_EQ(readbacks.GetStagingBufferCount(), 1u);
+}
+
+TEST(ReadbackTest, StagingBuffersAreRecycled) {
+    auto device = std::make_unique<NullDevice>();
+    auto buffer = MakeBuffer(*device, 1024);
+    ASSERT_NE(buffer, nullptr);
+
+    ReadbackQueue readbacks(*device);
+    auto cmd = device->CreateCommandBuffer();
+    {
+        cmd->Begin();
+        auto first = readbacks.ReadBuffer(*cmd, *buffer, 0, 1024);
+        auto second = readbacks.ReadBuffer(*cmd, *buffer, 0, 512);
+        cmd->End();
+        ASSERT_TRUE(first.has_value());
+        ASSERT_TRUE(second.has_value());
+        EXPECT_EQ(readbacks.GetStagingBufferCount(), 2u);
+        readbacks.Submit(*cmd);
+    }
+
+    // The tickets are gone and their copies have executed; both buffers are reused
+    cmd->Reset();
+    cmd->Begin();
+    auto small = readbacks.ReadBuffer(*cmd, *buffer, 0, 256);
+    auto large = readbacks.ReadBuffer(*cmd, *buffer, 0, 1024);
+    ASSERT_TRUE(small.has_value());
+    ASSERT_TRUE(large.has_value());
+    EXPECT_EQ(readbacks.GetStagingBufferCount(), 2u);
+
+    // Unsubmitted requests keep their buffers
+    auto third = readbacks.ReadBuffer(*cmd, *buffer, 0, 16);
+    cmd->End();
+    ASSERT_TRUE(third.has_value());
+    EXPECT_EQ(readbacks.GetStagingBufferCount(), 3u);
+}
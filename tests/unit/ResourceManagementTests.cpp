@@ -62,6 +62,43 @@ TEST_F(ResourceManagementTest, BufferCreation_InvalidSize) {
     EXPECT_EQ(result.error().code, VRHI::Error::Code::InvalidConfig);
 }
 
+TEST_F(ResourceManagementTest, BufferCreation_StreamingNeedsTwoCopies) {
+    ASSERT_NE(device, nullptr);
+    
+    VRHI::BufferDesc desc{};
+    desc.size = 256;
+    desc.usage = VRHI::BufferUsage::Uniform;
+    desc.memoryAccess = VRHI::MemoryAccess::CpuToGpu;
+    desc.streaming = VRHI::BufferStreaming::RoundRobin;
+    desc.streamingCopies = 1;
+    
+    auto result = device->CreateBuffer(desc);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, VRHI::Error::Code::InvalidConfig);
+    
+    desc.streamingCopies = 2;
+    EXPECT_TRUE(device->CreateBuffer(desc).has_value());
+}
+
+TEST_F(ResourceManagementTest, BufferCreation_AutoStreamingResolvesPerAccess) {
+    ASSERT_NE(device, nullptr);
+    
+    // Auto is RoundRobin for CpuToGpu buffers, as on the GPU backends
+    VRHI::BufferDesc desc{};
+    desc.size = 256;
+    desc.usage = VRHI::BufferUsage::Uniform;
+    desc.memoryAccess = VRHI::MemoryAccess::CpuToGpu;
+    desc.streamingCopies = 1;
+    
+    auto result = device->CreateBuffer(desc);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, VRHI::Error::Code::InvalidConfig);
+    
+    // and None for everything else
+    desc.memoryAccess = VRHI::MemoryAccess::GpuOnly;
+    EXPECT_TRUE(device->CreateBuffer(desc).has_value());
+}
+
 TEST_F(ResourceManagementTest, BufferCreation_WithInitialData) {
     ASSERT_NE(device, nullptr);
     
@@ -156,6 +193,63 @@ TEST_F(ResourceManagementTest, BufferMapping) {
     }
 }
 
+TEST_F(ResourceManagementTest, BufferMapping_WriteOnlyFlushExplicit) {
+    ASSERT_NE(device, nullptr);
+    
+    VRHI::BufferDesc desc{};
+    desc.size = 512;
+    desc.usage = VRHI::BufferUsage::Vertex;
+    desc.memoryAccess = VRHI::MemoryAccess::CpuToGpu;
+    
+    auto result = device->CreateBuffer(desc);
+    ASSERT_TRUE(result.has_value());
+    
+    auto& buffer = *result;
+    
+    // Map the second half for writing only and flush what was written
+    using VRHI::MapAccess;
+    auto* mapped = static_cast<uint32_t*>(buffer->Map(256, 256, MapAccess::Write | MapAccess::InvalidateRange |
+                                                                MapAccess::FlushExplicit));
+    ASSERT_NE(mapped, nullptr);
+    for (size_t i = 0; i < 64; ++i) {
+        mapped[i] = static_cast<uint32_t>(i + 7);
+    }
+    buffer->FlushRange(256, 256);
+    buffer->Unmap();
+    
+    std::array<uint32_t, 64> readBack{};
+    buffer->Read(readBack.data(), sizeof(readBack), 256);
+    for (size_t i = 0; i < readBack.size(); ++i) {
+        EXPECT_EQ(readBack[i], i + 7);
+    }
+}
+
+TEST_F(ResourceManagementTest, BufferMapping_InvalidAccess) {
+    ASSERT_NE(device, nullptr);
+    
+    VRHI::BufferDesc desc{};
+    desc.size = 512;
+    desc.usage = VRHI::BufferUsage::Vertex;
+    desc.memoryAccess = VRHI::MemoryAccess::CpuToGpu;
+    
+    auto result = device->CreateBuffer(desc);
+    ASSERT_TRUE(result.has_value());
+    
+    auto& buffer = *result;
+    
+    using VRHI::MapAccess;
+    EXPECT_EQ(buffer->Map(256, 512, MapAccess::Write), nullptr);  // Out of bounds
+    EXPECT_EQ(buffer->Map(0, 0, MapAccess::Write), nullptr);      // Empty
+    EXPECT_EQ(buffer->Map(0, 64, MapAccess::InvalidateRange), nullptr);
+    EXPECT_EQ(buffer->Map(0, 64, MapAccess::Read | MapAccess::Unsynchronized), nullptr);
+    EXPECT_EQ(buffer->Map(0, 64, MapAccess::Read | MapAccess::InvalidateBuffer), nullptr);
+    EXPECT_EQ(buffer->Map(0, 64, MapAccess::Read | MapAccess::FlushExplicit), nullptr);
+    
+    // Nothing was left mapped by the rejected requests
+    EXPECT_NE(buffer->Map(0, 64, MapAccess::Read), nullptr);
+    buffer->Unmap();
+}
+
 // ============================================================================
 // Texture Tests
 // ============================================================================
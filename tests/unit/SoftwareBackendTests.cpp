@@ -0,0 +1,564 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include <VRHI/VRHIAll.hpp>
+#include <gtest/gtest.h>
+#include <array>
+#include <cstring>
+#include <span>
+#include <vector>
+
+using namespace VRHI;
+
+namespace {
+
+const char* kFillShader = R"(
+#version 450
+layout (local_size_x = 8) in;
+layout (std430, binding = 1) buffer Data { uint values[]; } data;
+layout (push_constant) uniform Push { uint add; } pc;
+void main() { data.values[gl_GlobalInvocationID.x] = gl_GlobalInvocationID.x * 2u + pc.add; }
+)";
+
+const char* kReduceShader = R"(
+#version 450
+layout (local_size_x = 64) in;
+layout (std430, binding = 0) buffer Data { uint values[]; } data;
+layout (std430, binding = 1) buffer Sums { uint values[]; } sums;
+shared uint partial[64];
+void main() {
+    partial[gl_LocalInvocationIndex] = data.values[gl_GlobalInvocationID.x];
+    barrier();
+    for (uint stride = 32u; stride > 0u; stride >>= 1u) {
+        if (gl_LocalInvocationIndex < stride) {
+            partial[gl_LocalInvocationIndex] += partial[gl_LocalInvocationIndex + stride];
+        }
+        barrier();
+    }
+    if (gl_LocalInvocationIndex == 0u) { sums.values[gl_WorkGroupID.x] = partial[0]; }
+}
+)";
+
+const char* kColorVertexShader = R"(
+#version 450
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 aColor;
+layout (location = 0) out vec4 vColor;
+void main() { vColor = aColor; gl_Position = vec4(aPos, 1.0); }
+)";
+
+const char* kColorFragmentShader = R"(
+#version 450
+layout (location = 0) in vec4 vColor;
+layout (location = 0) out vec4 FragColor;
+void main() { FragColor = vColor; }
+)";
+
+const char* kTexturedVertexShader = R"(
+#version 450
+layout (location = 0) in vec2 aPos;
+layout (location = 0) out vec2 vUV;
+void main() { vUV = aPos * 0.5 + 0.5; gl_Position = vec4(aPos, 0.0, 1.0); }
+)";
+
+const char* kTexturedFragmentShader = R"(
+#version 450
+layout (binding = 0) uniform sampler2D uTexture;
+layout (location = 0) in vec2 vUV;
+layout (location = 0) out vec4 FragColor;
+void main() { FragColor = texture(uTexture, vUV); }
+)";
+
+struct ColorVertex {
+    float x, y, z;
+    float r, g, b, a;
+};
+
+std::unique_ptr<Device> MakeSoftwareDevice(uint32_t workerThreads = 0) {
+    DeviceConfig config{};
+    config.preferredBackend = BackendType::Software;
+    config.workerThreads = workerThreads;
+    auto device = CreateDevice(config);
+    EXPECT_TRUE(device.has_value()) << (device ? "" : device.error().message);
+    return device ? std::move(*device) : nullptr;
+}
+
+std::unique_ptr<Shader> MakeShader(Device& device, ShaderStage stage, const char* source) {
+    ShaderDesc desc{};
+    desc.stage = stage;
+    desc.code = source;
+    desc.codeSize = std::strlen(source);
+    auto shader = device.CreateShader(desc);
+    EXPECT_TRUE(shader.has_value()) << (shader ? "" : shader.error().message);
+    return shader ? std::move(*shader) : nullptr;
+}
+
+std::unique_ptr<Pipeline> MakeComputePipeline(Device& device, Shader* shader) {
+    PipelineDesc desc{};
+    desc.type = PipelineType::Compute;
+    desc.compute.computeShader = shader;
+    auto pipeline = device.CreatePipeline(desc);
+    EXPECT_TRUE(pipeline.has_value()) << (pipeline ? "" : pipeline.error().message);
+    return pipeline ? std::move(*pipeline) : nullptr;
+}
+
+/// Color (and optionally depth) render target with its pass and framebuffer
+struct RenderTarget {
+    std::unique_ptr<Texture> color;
+    std::unique_ptr<Texture> depth;
+    std::unique_ptr<RenderPass> pass;
+    std::unique_ptr<Framebuffer> framebuffer;
+    uint32_t size = 0;
+
+    std::vector<uint8_t> ReadPixels() {
+        std::vector<uint8_t> pixels(size_t(size) * size * 4);
+        color->Read(pixels.data(), pixels.size());
+        return pixels;
+    }
+};
+
+RenderTarget MakeRenderTarget(Device& device, uint32_t size, bool withDepth) {
+    RenderTarget target;
+    target.size = size;
+
+    TextureDesc textureDesc{};
+    textureDesc.format = TextureFormat::RGBA8_UNorm;
+    textureDesc.width = size;
+    textureDesc.height = size;
+    textureDesc.usage = TextureUsage::RenderTarget;
+    target.color = std::move(*device.CreateTexture(textureDesc));
+
+    std::vector<AttachmentDesc> attachments(1);
+    std::vector<Texture*> textures = {target.color.get()};
+    if (withDepth) {
+        textureDesc.format = TextureFormat::Depth32F;
+        textureDesc.usage = TextureUsage::DepthStencil;
+        target.depth = std::move(*device.CreateTexture(textureDesc));
+        attachments.push_back(AttachmentDesc{.format = TextureFormat::Depth32F});
+        textures.push_back(target.depth.get());
+    }
+
+    RenderPassDesc passDesc{};
+    passDesc.attachments = attachments;
+    target.pass = std::move(*device.CreateRenderPass(passDesc));
+
+    FramebufferDesc framebufferDesc{};
+    framebufferDesc.renderPass = target.pass.get();
+    framebufferDesc.attachments = textures;
+    framebufferDesc.width = size;
+    framebufferDesc.height = size;
+    auto framebuffer = device.CreateFramebuffer(framebufferDesc);
+    EXPECT_TRUE(framebuffer.has_value()) << (framebuffer ? "" : framebuffer.error().message);
+    if (framebuffer) {
+        target.framebuffer = std::move(*framebuffer);
+    }
+    return target;
+}
+
+std::unique_ptr<Pipeline> MakeColorPipeline(Device& device, Shader* vs, Shader* fs, bool depthTest) {
+    VertexAttribute attributes[] = {
+        {0, 0, VertexFormat::Float3, 0},
+        {1, 0, VertexFormat::Float4, 12},
+    };
+    VertexBinding bindings[] = {{0, sizeof(ColorVertex), VertexInputRate::Vertex}};
+    PipelineDesc desc{};
+    desc.type = PipelineType::Graphics;
+    desc.graphics.vertexShader = vs;
+    desc.graphics.fragmentShader = fs;
+    desc.graphics.vertexInput.attributes = attributes;
+    desc.graphics.vertexInput.bindings = bindings;
+    desc.graphics.depthStencil.depthTestEnable = depthTest;
+    desc.graphics.depthStencil.depthWriteEnable = depthTest;
+    auto pipeline = device.CreatePipeline(desc);
+    EXPECT_TRUE(pipeline.has_value()) << (pipeline ? "" : pipeline.error().message);
+    return pipeline ? std::move(*pipeline) : nullptr;
+}
+
+std::unique_ptr<Buffer> MakeVertexBuffer(Device& device, std::span<const ColorVertex> vertices) {
+    BufferDesc desc{};
+    desc.size = vertices.size_bytes();
+    desc.usage = BufferUsage::Vertex;
+    desc.initialData = vertices.data();
+    return std::move(*device.CreateBuffer(desc));
+}
+
+/// Overlapping, depth tested triangles across several tiles,
+/// rendered on a device with the given worker count
+std::vector<uint8_t> RenderScene(uint32_t workerThreads) {
+    auto device = MakeSoftwareDevice(workerThreads);
+    if (!device) {
+        return {};
+    }
+    auto target = MakeRenderTarget(*device, 200, true);
+    auto vs = MakeShader(*device, ShaderStage::Vertex, kColorVertexShader);
+    auto fs = MakeShader(*device, ShaderStage::Fragment, kColorFragmentShader);
+    auto pipeline = MakeColorPipeline(*device, vs.get(), fs.get(), true);
+
+    // Deterministic pseudo-random triangles
+    std::vector<ColorVertex> vertices;
+    uint32_t seed = 12345;
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return float(seed >> 8) / float(1u << 24);
+    };
+    for (uint32_t i = 0; i < 300 * 3; ++i) {
+        vertices.push_back({next() * 2.4f - 1.2f, next() * 2.4f - 1.2f, next(),
+                            next(), next(), next(), 1.0f});
+    }
+    auto vertexBuffer = MakeVertexBuffer(*device, vertices);
+
+    ClearValue clears[2]{};
+    clears[0].color = ClearColorValue(0, 0, 0, 1);
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->BeginRenderPass(target.pass.get(), target.framebuffer.get(), {0, 0, 200, 200}, clears);
+    cmd->BindPipeline(pipeline.get());
+    Buffer* vertexBuffers[] = {vertexBuffer.get()};
+    cmd->BindVertexBuffers(0, vertexBuffers);
+    cmd->Draw(static_cast<uint32_t>(vertices.size()));
+    cmd->EndRenderPass();
+    cmd->End();
+    device->Submit(cmd.get());
+    return target.ReadPixels();
+}
+
+} // namespace
+
+// ============================================================================
+// Software Backend Tests
+// ============================================================================
+
+class SoftwareBackendTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        device = MakeSoftwareDevice();
+        ASSERT_NE(device, nullptr);
+    }
+
+    std::unique_ptr<Device> device;
+};
+
+TEST_F(SoftwareBackendTest, DeviceReportsSoftware) {
+    EXPECT_EQ(device->GetBackendType(), BackendType::Software);
+    EXPECT_EQ(device->GetBackendInfo().name, "Software");
+    EXPECT_FALSE(device->GetProperties().deviceName.empty());
+    EXPECT_TRUE(device->IsFeatureSupported(Feature::Compute));
+    EXPECT_EQ(device->GetSwapChain(), nullptr);
+    EXPECT_NE(device->CreateCommandBuffer(), nullptr);
+    EXPECT_NE(device->GetTransientAllocator(), nullptr);
+}
+
+TEST_F(SoftwareBackendTest, ComputeWritesStorageBuffer) {
+    auto shader = MakeShader(*device, ShaderStage::Compute, kFillShader);
+    ASSERT_NE(shader, nullptr);
+    auto pipeline = MakeComputePipeline(*device, shader.get());
+    ASSERT_NE(pipeline, nullptr);
+
+    BufferDesc desc{};
+    desc.size = 64 * sizeof(uint32_t);
+    desc.usage = BufferUsage::Storage;
+    auto buffer = std::move(*device->CreateBuffer(desc));
+
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->BindPipeline(pipeline.get());
+    cmd->BindStorageBuffer(1, buffer.get());
+    uint32_t add = 1000;
+    cmd->PushConstants(ShaderStage::Compute, 0, std::as_bytes(std::span(&add, 1)));
+    cmd->Dispatch(4);
+    cmd->BindStorageBuffer(1, buffer.get(), 128, 128);
+    add = 5000;
+    cmd->PushConstants(ShaderStage::Compute, 0, std::as_bytes(std::span(&add, 1)));
+    cmd->Dispatch(4);
+    cmd->End();
+    device->Submit(cmd.get());
+
+    uint32_t out[64] = {};
+    buffer->Read(out, sizeof(out));
+    EXPECT_EQ(out[0], 1000u);
+    EXPECT_EQ(out[31], 1062u);
+    EXPECT_EQ(out[32], 5000u);
+    EXPECT_EQ(out[63], 5062u);
+}
+
+TEST_F(SoftwareBackendTest, ComputeSharedMemoryAndBarriers) {
+    auto shader = MakeShader(*device, ShaderStage::Compute, kReduceShader);
+    ASSERT_NE(shader, nullptr);
+    auto pipeline = MakeComputePipeline(*device, shader.get());
+    ASSERT_NE(pipeline, nullptr);
+
+    std::vector<uint32_t> values(64 * 16);
+    for (uint32_t i = 0; i < values.size(); ++i) {
+        values[i] = i;
+    }
+    BufferDesc desc{};
+    desc.size = values.size() * sizeof(uint32_t);
+    desc.usage = BufferUsage::Storage;
+    desc.initialData = values.data();
+    auto data = std::move(*device->CreateBuffer(desc));
+    desc.size = 16 * sizeof(uint32_t);
+    desc.initialData = nullptr;
+    auto sums = std::move(*device->CreateBuffer(desc));
+
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->BindPipeline(pipeline.get());
+    cmd->BindStorageBuffer(0, data.get());
+    cmd->BindStorageBuffer(1, sums.get());
+    cmd->Dispatch(16);
+    cmd->End();
+    device->Submit(cmd.get());
+
+    uint32_t out[16] = {};
+    sums->Read(out, sizeof(out));
+    for (uint32_t group = 0; group < 16; ++group) {
+        // Sum of 64 consecutive integers starting at group * 64
+        EXPECT_EQ(out[group], group * 64 * 64 + 63 * 64 / 2) << "group " << group;
+    }
+}
+
+TEST_F(SoftwareBackendTest, ClearAndDrawTriangle) {
+    auto target = MakeRenderTarget(*device, 16, false);
+    ASSERT_NE(target.framebuffer, nullptr);
+    auto vs = MakeShader(*device, ShaderStage::Vertex, kColorVertexShader);
+    auto fs = MakeShader(*device, ShaderStage::Fragment, kColorFragmentShader);
+    auto pipeline = MakeColorPipeline(*device, vs.get(), fs.get(), false);
+    ASSERT_NE(pipeline, nullptr);
+
+    // Triangle over the bottom half of clip space
+    const ColorVertex vertices[] = {
+        {-1, -1, 0,  1, 0, 0, 1},
+        { 3, -1, 0,  1, 0, 0, 1},
+        {-1,  0, 0,  1, 0, 0, 1},
+    };
+    auto vertexBuffer = MakeVertexBuffer(*device, vertices);
+
+    ClearValue clear{};
+    clear.color = ClearColorValue(0, 0, 1, 1);
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->BeginRenderPass(target.pass.get(), target.framebuffer.get(), {0, 0, 16, 16}, std::span(&clear, 1));
+    cmd->BindPipeline(pipeline.get());
+    Buffer* vertexBuffers[] = {vertexBuffer.get()};
+    cmd->BindVertexBuffers(0, vertexBuffers);
+    cmd->Draw(3);
+    cmd->EndRenderPass();
+    cmd->End();
+    device->Submit(cmd.get());
+
+    // Row 0 is clip space y = -1, as on the other backends
+    auto pixels = target.ReadPixels();
+    const uint8_t* bottom = &pixels[(2 * 16 + 8) * 4];
+    const uint8_t* top = &pixels[(13 * 16 + 8) * 4];
+    EXPECT_EQ(bottom[0], 255);
+    EXPECT_EQ(bottom[2], 0);
+    EXPECT_EQ(top[0], 0);
+    EXPECT_EQ(top[2], 255);
+}
+
+TEST_F(SoftwareBackendTest, DepthTestKeepsNearestSurface) {
+    auto target = MakeRenderTarget(*device, 32, true);
+    ASSERT_NE(target.framebuffer, nullptr);
+    auto vs = MakeShader(*device, ShaderStage::Vertex, kColorVertexShader);
+    auto fs = MakeShader(*device, ShaderStage::Fragment, kColorFragmentShader);
+    auto pipeline = MakeColorPipeline(*device, vs.get(), fs.get(), true);
+    ASSERT_NE(pipeline, nullptr);
+
+    // A near green triangle over the left half, then a far red one covering
+    // everything: red only lands where green is not
+    const ColorVertex vertices[] = {
+        {-1, -1, 0.25f,  0, 1, 0, 1},
+        { 0, -1, 0.25f,  0, 1, 0, 1},
+        {-1,  3, 0.25f,  0, 1, 0, 1},
+        {-1, -1, 0.75f,  1, 0, 0, 1},
+        { 3, -1, 0.75f,  1, 0, 0, 1},
+        {-1,  3, 0.75f,  1, 0, 0, 1},
+    };
+    auto vertexBuffer = MakeVertexBuffer(*device, vertices);
+
+    ClearValue clears[2]{};
+    clears[0].color = ClearColorValue(0, 0, 0, 1);
+    clears[1].depthStencil.depth = 1.0f;
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->BeginRenderPass(target.pass.get(), target.framebuffer.get(), {0, 0, 32, 32}, clears);
+    cmd->BindPipeline(pipeline.get());
+    Buffer* vertexBuffers[] = {vertexBuffer.get()};
+    cmd->BindVertexBuffers(0, vertexBuffers);
+    cmd->Draw(6);
+    cmd->EndRenderPass();
+    cmd->End();
+    device->Submit(cmd.get());
+
+    auto pixels = target.ReadPixels();
+    const uint8_t* left = &pixels[(16 * 32 + 4) * 4];
+    const uint8_t* right = &pixels[(16 * 32 + 28) * 4];
+    EXPECT_EQ(left[0], 0);
+    EXPECT_EQ(left[1], 255);
+    EXPECT_EQ(right[0], 255);
+    EXPECT_EQ(right[1], 0);
+
+    // Clip space depth is OpenGL's [-1, 1], as on the other backends
+    std::vector<float> depth(32 * 32);
+    target.depth->Read(depth.data(), depth.size() * sizeof(float));
+    EXPECT_FLOAT_EQ(depth[16 * 32 + 4], 0.625f);
+    EXPECT_FLOAT_EQ(depth[16 * 32 + 28], 0.875f);
+}
+
+TEST_F(SoftwareBackendTest, SamplesTextureWithNearestFilter) {
+    auto target = MakeRenderTarget(*device, 16, false);
+    ASSERT_NE(target.framebuffer, nullptr);
+
+    // 2x2 texture, row 0 first
+    const uint8_t texels[] = {
+        255, 0, 0, 255,    0, 255, 0, 255,
+        0, 0, 255, 255,    255, 255, 255, 255,
+    };
+    TextureDesc textureDesc{};
+    textureDesc.format = TextureFormat::RGBA8_UNorm;
+    textureDesc.width = 2;
+    textureDesc.height = 2;
+    textureDesc.initialData = texels;
+    auto texture = device->CreateTexture(textureDesc);
+    ASSERT_TRUE(texture.has_value()) << (texture ? "" : texture.error().message);
+
+    SamplerDesc samplerDesc{};
+    samplerDesc.minFilter = FilterMode::Nearest;
+    samplerDesc.magFilter = FilterMode::Nearest;
+    samplerDesc.mipmapMode = FilterMode::Nearest;
+    samplerDesc.addressModeU = AddressMode::ClampToEdge;
+    samplerDesc.addressModeV = AddressMode::ClampToEdge;
+    auto sampler = device->CreateSampler(samplerDesc);
+    ASSERT_TRUE(sampler.has_value());
+
+    auto vs = MakeShader(*device, ShaderStage::Vertex, kTexturedVertexShader);
+    auto fs = MakeShader(*device, ShaderStage::Fragment, kTexturedFragmentShader);
+    ASSERT_NE(vs, nullptr);
+    ASSERT_NE(fs, nullptr);
+    VertexAttribute attributes[] = {{0, 0, VertexFormat::Float2, 0}};
+    VertexBinding bindings[] = {{0, 8, VertexInputRate::Vertex}};
+    PipelineDesc pipelineDesc{};
+    pipelineDesc.type = PipelineType::Graphics;
+    pipelineDesc.graphics.vertexShader = vs.get();
+    pipelineDesc.graphics.fragmentShader = fs.get();
+    pipelineDesc.graphics.vertexInput.attributes = attributes;
+    pipelineDesc.graphics.vertexInput.bindings = bindings;
+    pipelineDesc.graphics.depthStencil.depthTestEnable = false;
+    auto pipeline = device->CreatePipeline(pipelineDesc);
+    ASSERT_TRUE(pipeline.has_value()) << (pipeline ? "" : pipeline.error().message);
+
+    // Full screen triangle; the UVs map the texture 1:1 onto the target
+    float vertices[] = {-1, -1,  3, -1,  -1, 3};
+    BufferDesc vertexDesc{};
+    vertexDesc.size = sizeof(vertices);
+    vertexDesc.usage = BufferUsage::Vertex;
+    vertexDesc.initialData = vertices;
+    auto vertexBuffer = std::move(*device->CreateBuffer(vertexDesc));
+
+    ClearValue clear{};
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->BeginRenderPass(target.pass.get(), target.framebuffer.get(), {0, 0, 16, 16}, std::span(&clear, 1));
+    cmd->BindPipeline(pipeline->get());
+    cmd->BindTexture(0, texture->get(), sampler->get());
+    Buffer* vertexBuffers[] = {vertexBuffer.get()};
+    cmd->BindVertexBuffers(0, vertexBuffers);
+    cmd->Draw(3);
+    cmd->EndRenderPass();
+    cmd->End();
+    device->Submit(cmd.get());
+
+    auto pixels = target.ReadPixels();
+    auto pixel = [&](uint32_t x, uint32_t y) { return &pixels[(y * 16 + x) * 4]; };
+    for (uint32_t quadrant = 0; quadrant < 4; ++quadrant) {
+        const uint32_t x = (quadrant % 2) * 8 + 4;
+        const uint32_t y = (quadrant / 2) * 8 + 4;
+        EXPECT_EQ(std::memcmp(pixel(x, y), &texels[quadrant * 4], 4), 0) << "quadrant " << quadrant;
+    }
+}
+
+TEST_F(SoftwareBackendTest, FenceSignalsAfterSubmission) {
+    auto fence = device->CreateFence();
+    EXPECT_FALSE(fence->IsSignaled());
+
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->End();
+    device->Submit(cmd.get(), fence.get());
+    EXPECT_TRUE(fence->Wait());
+    EXPECT_TRUE(fence->IsSignaled());
+
+    fence->Reset();
+    EXPECT_FALSE(fence->IsSignaled());
+    EXPECT_TRUE(device->CreateFence(true)->IsSignaled());
+}
+
+TEST_F(SoftwareBackendTest, OwningSubmissionsSignalFence) {
+    auto fence = device->CreateFence();
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->End();
+    device->Submit(std::move(cmd), fence.get());
+    EXPECT_TRUE(fence->IsSignaled());
+
+    fence->Reset();
+    std::vector<std::unique_ptr<CommandBuffer>> cmds;
+    for (int i = 0; i < 3; ++i) {
+        cmds.push_back(device->CreateCommandBuffer());
+        cmds.back()->Begin();
+        cmds.back()->End();
+    }
+    device->Submit(std::span(cmds), fence.get());
+    EXPECT_TRUE(fence->IsSignaled());
+
+    // An empty batch still signals
+    fence->Reset();
+    device->Submit(std::span<std::unique_ptr<CommandBuffer>>(), fence.get());
+    EXPECT_TRUE(fence->Wait(0));
+}
+
+TEST_F(SoftwareBackendTest, UpdateSubresourcesFillsEveryMipAndLayer) {
+    TextureDesc desc{};
+    desc.type = TextureType::Texture2DArray;
+    desc.format = TextureFormat::RGBA8_UNorm;
+    desc.width = 4;
+    desc.height = 4;
+    desc.mipLevels = 3;
+    desc.arrayLayers = 2;
+    auto texture = device->CreateTexture(desc);
+    ASSERT_TRUE(texture.has_value());
+
+    // Mip-major block with a distinct byte value per subresource
+    std::vector<uint8_t> data;
+    std::vector<TextureSubresourceData> subresources;
+    for (uint32_t mip = 0; mip < desc.mipLevels; ++mip) {
+        const size_t size = size_t{desc.width >> mip} * (desc.height >> mip) * 4;
+        for (uint32_t layer = 0; layer < desc.arrayLayers; ++layer) {
+            subresources.push_back({mip, layer, data.size(), size});
+            data.insert(data.end(), size, static_cast<uint8_t>(mip * 16 + layer + 1));
+        }
+    }
+    (*texture)->UpdateSubresources(data.data(), subresources);
+
+    for (const TextureSubresourceData& subresource : subresources) {
+        std::vector<uint8_t> pixels(subresource.size);
+        (*texture)->Read(pixels.data(), pixels.size(), subresource.mipLevel, subresource.arrayLayer);
+        EXPECT_EQ(pixels.front(), subresource.mipLevel * 16 + subresource.arrayLayer + 1);
+        EXPECT_EQ(pixels.back(), subresource.mipLevel * 16 + subresource.arrayLayer + 1);
+    }
+}
+
+TEST(SoftwareBackendDeterminismTest, OutputIndependentOfThreadCount) {
+    auto single = RenderScene(1);
+    auto multiple = RenderScene(4);
+    ASSERT_FALSE(single.empty());
+    ASSERT_EQ(single.size(), multiple.size());
+    EXPECT_EQ(single, multiple);
+
+    // Something was drawn
+    size_t lit = 0;
+    for (size_t i = 0; i < single.size(); i += 4) {
+        lit += (single[i] | single[i + 1] | single[i + 2]) != 0;
+    }
+    EXPECT_GT(lit, single.size() / 8);
+}
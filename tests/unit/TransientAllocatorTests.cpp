@@ -0,0 +1,181 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include <VRHI/VRHIAll.hpp>
+#include <gtest/gtest.h>
+#include <array>
+#include <cstring>
+
+// Include internal headers for testing
+#include "../../src/Core/NullDevice.hpp"
+#include "../../src/Core/TransientRingAllocator.hpp"
+
+using namespace VRHI;
+
+namespace {
+
+/// Ring whose frames only retire when the test says so, like a GPU that
+/// lags behind the CPU
+class ManualFenceAllocator : public TransientRingAllocator {
+public:
+    ManualFenceAllocator(Device& device, uint64_t capacity)
+        : TransientRingAllocator(device, 16, capacity) {}
+
+    ~ManualFenceAllocator() override { Release(); }
+
+    void CompleteFrames(uintptr_t frame) { m_completed = frame; }
+
+protected:
+    void* InsertFence() override { return reinterpret_cast<void*>(++m_submitted); }
+
+    bool IsFenceSignaled(void* fence) override {
+        return reinterpret_cast<uintptr_t>(fence) <= m_completed;
+    }
+
+private:
+    uintptr_t m_submitted = 0;
+    uintptr_t m_completed = 0;
+};
+
+} // namespace
+
+// ============================================================================
+// Transient Allocator Tests (NullDevice)
+// ============================================================================
+
+class TransientAllocatorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        device = std::make_unique<NullDevice>();
+        transient = device->GetTransientAllocator();
+        ASSERT_NE(transient, nullptr);
+    }
+
+    std::unique_ptr<Device> device;
+    TransientAllocator* transient = nullptr;
+};
+
+TEST_F(TransientAllocatorTest, AllocateReturnsAlignedSlice) {
+    TransientAllocation a = transient->Allocate(100);
+    TransientAllocation b = transient->Allocate(100);
+    ASSERT_TRUE(a);
+    ASSERT_TRUE(b);
+    EXPECT_EQ(a.buffer, b.buffer);
+    EXPECT_EQ(a.size, 100u);
+    EXPECT_EQ(a.offset % 256, 0u);
+    EXPECT_EQ(b.offset % 256, 0u);
+    EXPECT_GE(b.offset, a.offset + a.size);
+    EXPECT_EQ(transient->GetFrameUsage(), b.offset + b.size);
+}
+
+TEST_F(TransientAllocatorTest, ExplicitAlignmentIsHonored) {
+    TransientAllocation a = transient->Allocate(3, 4);
+    TransientAllocation b = transient->Allocate(3, 4);
+    ASSERT_TRUE(a);
+    ASSERT_TRUE(b);
+    EXPECT_EQ(b.offset, a.offset + 4);
+}
+
+TEST_F(TransientAllocatorTest, ZeroSizeAllocationIsEmpty) {
+    EXPECT_FALSE(transient->Allocate(0));
+}
+
+TEST_F(TransientAllocatorTest, UploadIsVisibleAfterSubmit) {
+    const std::array<uint32_t, 4> values = {1, 2, 3, 4};
+    TransientAllocation slice = transient->Upload(values.data(), sizeof(values));
+    ASSERT_TRUE(slice);
+
+    device->Submit(nullptr);
+
+    std::array<uint32_t, 4> readBack{};
+    slice.buffer->Read(readBack.data(), sizeof(readBack), slice.offset);
+    EXPECT_EQ(readBack, values);
+}
+
+TEST_F(TransientAllocatorTest, MemoryIsRecycledAfterPresent) {
+    TransientAllocation first = transient->Allocate(1024);
+    transient->Allocate(1024);
+    device->Present();
+    EXPECT_EQ(transient->GetFrameUsage(), 0u);
+
+    TransientAllocation next = transient->Allocate(1024);
+    EXPECT_EQ(next.buffer, first.buffer);
+    EXPECT_EQ(next.offset, first.offset);
+}
+
+TEST_F(TransientAllocatorTest, GrowsWhenFrameExceedsCapacity) {
+    const uint64_t capacity = TransientRingAllocator::DefaultCapacity;
+    TransientAllocation small = transient->Allocate(16);
+    std::memset(small.data, 0xAB, 16);
+
+    TransientAllocation large = transient->Allocate(capacity);
+    ASSERT_TRUE(large);
+    EXPECT_NE(large.buffer, small.buffer);
+    EXPECT_GE(transient->GetCapacity(), capacity * 2);
+
+    // Slices handed out before the growth stay valid for the frame
+    std::memset(small.data, 0xCD, 16);
+    device->Submit(nullptr);
+    uint8_t byte = 0;
+    small.buffer->Read(&byte, 1, small.offset);
+    EXPECT_EQ(byte, 0xCD);
+}
+
+// ============================================================================
+// Frames In Flight
+// ============================================================================
+
+class TransientRingTest : public ::testing::Test {
+protected:
+    NullDevice device;
+    ManualFenceAllocator ring{device, 1024};
+};
+
+TEST_F(TransientRingTest, InFlightFramesAreNotOverwritten) {
+    TransientAllocation frame1 = ring.Allocate(512);
+    ring.EndFrame();
+    TransientAllocation frame2 = ring.Allocate(512);
+    ring.EndFrame();
+    EXPECT_EQ(frame1.offset, 0u);
+    EXPECT_EQ(frame2.offset, 512u);
+    EXPECT_EQ(ring.GetFramesInFlight(), 2u);
+
+    // Nothing has retired, so the next slice needs a new ring
+    TransientAllocation frame3 = ring.Allocate(256);
+    ASSERT_TRUE(frame3);
+    EXPECT_NE(frame3.buffer, frame1.buffer);
+    EXPECT_EQ(ring.GetCapacity(), 2048u);
+}
+
+TEST_F(TransientRingTest, RetiredFramesAreReused) {
+    ring.Allocate(512);
+    ring.EndFrame();
+    TransientAllocation frame2 = ring.Allocate(256);
+    EXPECT_EQ(frame2.offset, 512u);
+
+    ring.CompleteFrames(1);
+    ring.EndFrame();
+    EXPECT_EQ(ring.GetFramesInFlight(), 1u);
+
+    // Does not fit behind frame 2, so it wraps into the memory of frame 1
+    TransientAllocation frame3 = ring.Allocate(384);
+    ASSERT_TRUE(frame3);
+    EXPECT_EQ(frame3.buffer, frame2.buffer);
+    EXPECT_EQ(frame3.offset, 0u);
+    EXPECT_EQ(ring.GetCapacity(), 1024u);
+
+    // Frame 2 still holds [512, 768)
+    TransientAllocation frame3b = ring.Allocate(256);
+    EXPECT_NE(frame3b.buffer, frame2.buffer);
+}
+
+TEST_F(TransientRingTest, EmptyRingRestartsAtZero) {
+    ring.Allocate(600);
+    ring.EndFrame();
+    ring.CompleteFrames(1);
+
+    // Retiring the only frame empties the ring, so the slice need not wrap
+    TransientAllocation next = ring.Allocate(600);
+    EXPECT_EQ(next.offset, 0u);
+    EXPECT_EQ(ring.GetFramesInFlight(), 0u);
+}
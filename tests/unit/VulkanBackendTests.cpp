@@ -0,0 +1,279 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+#include <VRHI/VRHIAll.hpp>
+#include <gtest/gtest.h>
+#include <array>
+#include <cstring>
+#include <span>
+
+using namespace VRHI;
+
+namespace {
+
+const char* kFillShader = R"(
+#version 450
+layout (local_size_x = 8) in;
+layout (std430, binding = 1) buffer Data { uint values[]; } data;
+layout (push_constant) uniform Push { uint add; } pc;
+void main() { data.values[gl_GlobalInvocationID.x] = gl_GlobalInvocationID.x * 2u + pc.add; }
+)";
+
+const char* kCopyShader = R"(
+#version 450
+layout (local_size_x = 4) in;
+layout (std140, binding = 0) uniform Source { uvec4 values; } source;
+layout (std430, binding = 1) buffer Data { uint values[]; } data;
+void main() { data.values[gl_LocalInvocationID.x] = source.values[gl_LocalInvocationID.x]; }
+)";
+
+const char* kVertexShader = R"(
+#version 450
+layout (location = 0) in vec2 aPos;
+void main() { gl_Position = vec4(aPos, 0.0, 1.0); }
+)";
+
+const char* kFragmentShader = R"(
+#version 450
+layout (location = 0) out vec4 FragColor;
+void main() { FragColor = vec4(1.0, 0.0, 0.0, 1.0); }
+)";
+
+std::unique_ptr<Shader> MakeShader(Device& device, ShaderStage stage, const char* source) {
+    ShaderDesc desc{};
+    desc.stage = stage;
+    desc.code = source;
+    desc.codeSize = std::strlen(source);
+    auto shader = device.CreateShader(desc);
+    EXPECT_TRUE(shader.has_value()) << (shader ? "" : shader.error().message);
+    return shader ? std::move(*shader) : nullptr;
+}
+
+std::unique_ptr<Pipeline> MakeComputePipeline(Device& device, Shader* shader) {
+    PipelineDesc desc{};
+    desc.type = PipelineType::Compute;
+    desc.compute.computeShader = shader;
+    auto pipeline = device.CreatePipeline(desc);
+    EXPECT_TRUE(pipeline.has_value()) << (pipeline ? "" : pipeline.error().message);
+    return pipeline ? std::move(*pipeline) : nullptr;
+}
+
+} // namespace
+
+// ============================================================================
+// Vulkan Backend Tests
+// ============================================================================
+
+/// Runs on whatever Vulkan driver is installed (lavapipe in CI) and skips on
+/// machines without one
+class VulkanBackendTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        DeviceConfig config{};
+        config.preferredBackend = BackendType::Vulkan;
+        auto result = CreateDevice(config);
+        if (!result) {
+            GTEST_SKIP() << "No Vulkan device: " << result.error().message;
+        }
+        device = std::move(*result);
+    }
+
+    std::unique_ptr<Device> device;
+};
+
+TEST_F(VulkanBackendTest, DeviceReportsVulkan) {
+    EXPECT_EQ(device->GetBackendType(), BackendType::Vulkan);
+    EXPECT_EQ(device->GetBackendInfo().name, "Vulkan");
+    EXPECT_FALSE(device->GetProperties().deviceName.empty());
+    EXPECT_TRUE(device->IsFeatureSupported(Feature::Compute));
+    EXPECT_EQ(device->GetSwapChain(), nullptr);
+}
+
+TEST_F(VulkanBackendTest, BufferRoundTrip) {
+    uint32_t initial[4] = {1, 2, 3, 4};
+    BufferDesc desc{};
+    desc.size = sizeof(initial);
+    desc.usage = BufferUsage::Storage;
+    desc.initialData = initial;
+    auto buffer = device->CreateBuffer(desc);
+    ASSERT_TRUE(buffer.has_value());
+
+    uint32_t value = 99;
+    (*buffer)->Update(&value, sizeof(value), 8);
+
+    uint32_t out[4] = {};
+    (*buffer)->Read(out, sizeof(out));
+    EXPECT_EQ(out[0], 1u);
+    EXPECT_EQ(out[2], 99u);
+    EXPECT_EQ(out[3], 4u);
+
+    desc.memoryAccess = MemoryAccess::CpuToGpu;
+    desc.initialData = nullptr;
+    auto upload = device->CreateBuffer(desc);
+    ASSERT_TRUE(upload.has_value());
+    auto* mapped = static_cast<uint32_t*>((*upload)->Map());
+    ASSERT_NE(mapped, nullptr);
+    mapped[1] = 42;
+    (*upload)->Unmap();
+    (*upload)->Read(out, sizeof(out));
+    EXPECT_EQ(out[1], 42u);
+}
+
+TEST_F(VulkanBackendTest, ComputeWritesStorageBuffer) {
+    auto shader = MakeShader(*device, ShaderStage::Compute, kFillShader);
+    ASSERT_NE(shader, nullptr);
+    auto pipeline = MakeComputePipeline(*device, shader.get());
+    ASSERT_NE(pipeline, nullptr);
+
+    BufferDesc desc{};
+    desc.size = 64 * sizeof(uint32_t);
+    desc.usage = BufferUsage::Storage;
+    auto buffer = std::move(*device->CreateBuffer(desc));
+
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->BindPipeline(pipeline.get());
+    cmd->BindStorageBuffer(1, buffer.get());
+    uint32_t add = 1000;
+    cmd->PushConstants(ShaderStage::Compute, 0, std::as_bytes(std::span(&add, 1)));
+    cmd->Dispatch(4);
+    cmd->BindStorageBuffer(1, buffer.get(), 128, 128);
+    add = 5000;
+    cmd->PushConstants(ShaderStage::Compute, 0, std::as_bytes(std::span(&add, 1)));
+    cmd->Dispatch(4);
+    cmd->End();
+    device->Submit(cmd.get());
+
+    uint32_t out[64] = {};
+    buffer->Read(out, sizeof(out));
+    EXPECT_EQ(out[0], 1000u);
+    EXPECT_EQ(out[31], 1062u);
+    EXPECT_EQ(out[32], 5000u);
+    EXPECT_EQ(out[63], 5062u);
+}
+
+TEST_F(VulkanBackendTest, RenderToTextureMatchesOpenGLLayout) {
+    TextureDesc textureDesc{};
+    textureDesc.format = TextureFormat::RGBA8_UNorm;
+    textureDesc.width = 16;
+    textureDesc.height = 16;
+    textureDesc.usage = TextureUsage::RenderTarget;
+    auto color = std::move(*device->CreateTexture(textureDesc));
+
+    AttachmentDesc attachment{};
+    attachment.format = TextureFormat::RGBA8_UNorm;
+    RenderPassDesc passDesc{};
+    passDesc.attachments = std::span(&attachment, 1);
+    auto pass = device->CreateRenderPass(passDesc);
+    ASSERT_TRUE(pass.has_value());
+
+    Texture* attachments[] = {color.get()};
+    FramebufferDesc framebufferDesc{};
+    framebufferDesc.renderPass = pass->get();
+    framebufferDesc.attachments = attachments;
+    framebufferDesc.width = 16;
+    framebufferDesc.height = 16;
+    auto framebuffer = device->CreateFramebuffer(framebufferDesc);
+    ASSERT_TRUE(framebuffer.has_value()) << (framebuffer ? "" : framebuffer.error().message);
+
+    auto vs = MakeShader(*device, ShaderStage::Vertex, kVertexShader);
+    auto fs = MakeShader(*device, ShaderStage::Fragment, kFragmentShader);
+    ASSERT_NE(vs, nullptr);
+    ASSERT_NE(fs, nullptr);
+    VertexAttribute attributes[] = {{0, 0, VertexFormat::Float2, 0}};
+    VertexBinding bindings[] = {{0, 8, VertexInputRate::Vertex}};
+    PipelineDesc pipelineDesc{};
+    pipelineDesc.type = PipelineType::Graphics;
+    pipelineDesc.graphics.vertexShader = vs.get();
+    pipelineDesc.graphics.fragmentShader = fs.get();
+    pipelineDesc.graphics.vertexInput.attributes = attributes;
+    pipelineDesc.graphics.vertexInput.bindings = bindings;
+    pipelineDesc.graphics.rasterization.cullMode = CullMode::Back;
+    auto pipeline = device->CreatePipeline(pipelineDesc);
+    ASSERT_TRUE(pipeline.has_value()) << (pipeline ? "" : pipeline.error().message);
+
+    // Counter-clockwise triangle over the bottom half of clip space
+    float vertices[] = {-1, -1,  3, -1,  -1, 0};
+    BufferDesc vertexDesc{};
+    vertexDesc.size = sizeof(vertices);
+    vertexDesc.usage = BufferUsage::Vertex;
+    vertexDesc.initialData = vertices;
+    auto vertexBuffer = std::move(*device->CreateBuffer(vertexDesc));
+
+    ClearValue clear{};
+    clear.color = ClearColorValue(0, 0, 1, 1);
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->BeginRenderPass(pass->get(), framebuffer->get(), {0, 0, 16, 16}, std::span(&clear, 1));
+    cmd->BindPipeline(pipeline->get());
+    Buffer* vertexBuffers[] = {vertexBuffer.get()};
+    cmd->BindVertexBuffers(0, vertexBuffers);
+    cmd->Draw(3);
+    cmd->EndRenderPass();
+    cmd->End();
+    device->Submit(cmd.get());
+
+    // Row 0 is clip space y = -1, as glReadPixels returns it
+    std::array<uint8_t, 16 * 16 * 4> pixels{};
+    color->Read(pixels.data(), pixels.size());
+    const uint8_t* bottom = &pixels[(2 * 16 + 8) * 4];
+    const uint8_t* top = &pixels[(13 * 16 + 8) * 4];
+    EXPECT_EQ(bottom[0], 255);
+    EXPECT_EQ(bottom[2], 0);
+    EXPECT_EQ(top[0], 0);
+    EXPECT_EQ(top[2], 255);
+}
+
+TEST_F(VulkanBackendTest, FenceSignalsAfterSubmission) {
+    auto fence = device->CreateFence();
+    EXPECT_FALSE(fence->IsSignaled());
+
+    auto cmd = device->CreateCommandBuffer();
+    cmd->Begin();
+    cmd->End();
+    device->Submit(cmd.get(), fence.get());
+    EXPECT_TRUE(fence->Wait());
+    EXPECT_TRUE(fence->IsSignaled());
+
+    fence->Reset();
+    EXPECT_FALSE(fence->IsSignaled());
+    EXPECT_TRUE(device->CreateFence(true)->IsSignaled());
+}
+
+TEST_F(VulkanBackendTest, TransientSliceBindsAsUniformBuffer) {
+    TransientAllocator* transient = device->GetTransientAllocator();
+    ASSERT_NE(transient, nullptr);
+
+    auto shader = MakeShader(*device, ShaderStage::Compute, kCopyShader);
+    ASSERT_NE(shader, nullptr);
+    auto pipeline = MakeComputePipeline(*device, shader.get());
+    ASSERT_NE(pipeline, nullptr);
+
+    BufferDesc desc{};
+    desc.size = 4 * sizeof(uint32_t);
+    desc.usage = BufferUsage::Storage;
+    auto buffer = std::move(*device->CreateBuffer(desc));
+
+    for (uint32_t frame = 0; frame < 3; ++frame) {
+        // Burn a slice so the bound one is not at offset 0
+        ASSERT_TRUE(transient->Allocate(16));
+        const uint32_t values[4] = {frame, frame + 10, frame + 20, frame + 30};
+        TransientAllocation slice = transient->Upload(values, sizeof(values));
+        ASSERT_TRUE(slice);
+
+        auto cmd = device->CreateCommandBuffer();
+        cmd->Begin();
+        cmd->BindPipeline(pipeline.get());
+        cmd->BindUniformBuffer(0, slice.buffer, slice.offset, slice.size);
+        cmd->BindStorageBuffer(1, buffer.get());
+        cmd->Dispatch(1);
+        cmd->End();
+        device->Submit(cmd.get());
+        device->Present();
+
+        uint32_t out[4] = {};
+        buffer->Read(out, sizeof(out));
+        EXPECT_EQ(out[0], frame);
+        EXPECT_EQ(out[3], frame + 30);
+    }
+}
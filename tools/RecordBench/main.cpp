@@ -0,0 +1,143 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+// vrhi-record-bench: records a synthetic frame of draws through the virtual
+// CommandBuffer interface and through VRHI::Devirtualize(), and reports the
+// CPU time per recorded command of each. Build with -DVRHI_DEVIRTUALIZE=ON
+// to compare against inlined recording.
+//
+// Usage: vrhi-record-bench [--objects N] [--loops N]
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <VRHI/RecordingCommandBuffer.hpp>
+#include <VRHI/Resources.hpp>
+#include <VRHI/VRHI.hpp>
+
+#include "../../src/Core/NullDevice.hpp"
+
+namespace {
+
+struct Options {
+    uint32_t objects = 10000;
+    uint32_t loops = 200;
+};
+
+bool ParseCount(const char* text, uint32_t& value) {
+    const char* end = text + std::strlen(text);
+    auto [ptr, ec] = std::from_chars(text, end, value);
+    return ec == std::errc{} && ptr == end && value > 0;
+}
+
+std::optional<Options> ParseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--objects" && hasValue) {
+            if (!ParseCount(argv[++i], options.objects)) {
+                return std::nullopt;
+            }
+        } else if (arg == "--loops" && hasValue) {
+            if (!ParseCount(argv[++i], options.loops)) {
+                return std::nullopt;
+            }
+        } else {
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+struct Scene {
+    std::vector<std::unique_ptr<VRHI::Buffer>> vertexBuffers;
+    std::vector<std::unique_ptr<VRHI::Buffer>> indexBuffers;
+    std::unique_ptr<VRHI::Buffer> uniforms;
+};
+
+constexpr uint32_t MeshCount = 64;
+constexpr uint32_t ObjectsPerPipeline = 256;
+constexpr uint32_t CommandsPerObject = 4;
+constexpr uint64_t UniformStride = 256;
+
+/// One frame: per object its mesh buffers, a uniform slice and a draw
+template<typename Recorder>
+void RecordFrame(Recorder& rec, const Scene& scene, uint32_t objects) {
+    rec.Begin();
+    for (uint32_t i = 0; i < objects; ++i) {
+        if (i % ObjectsPerPipeline == 0) {
+            rec.BindPipeline(nullptr);
+        }
+        VRHI::Buffer* const vertexBuffers[] = {scene.vertexBuffers[i % MeshCount].get()};
+        rec.BindVertexBuffers(0, vertexBuffers);
+        rec.BindIndexBuffer(scene.indexBuffers[i % MeshCount].get());
+        rec.BindUniformBuffer(0, scene.uniforms.get(), i * UniformStride, UniformStride);
+        rec.DrawIndexed(36);
+    }
+    rec.End();
+}
+
+/// Best time per command over all loops, in nanoseconds
+template<typename Recorder>
+double Measure(Recorder& rec, const Scene& scene, const Options& options) {
+    using Clock = std::chrono::steady_clock;
+    RecordFrame(rec, scene, options.objects);  // Warm up the stream storage
+
+    double best = 1e300;
+    for (uint32_t loop = 0; loop < options.loops; ++loop) {
+        const auto start = Clock::now();
+        RecordFrame(rec, scene, options.objects);
+        best = std::min(best, std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+    }
+    return best / (static_cast<double>(options.objects) * CommandsPerObject);
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    const auto options = ParseOptions(argc, argv);
+    if (!options) {
+        std::cerr << "Usage: vrhi-record-bench [--objects N] [--loops N]\n";
+        return 1;
+    }
+
+    VRHI::NullDevice device;
+    Scene scene;
+    VRHI::BufferDesc desc;
+    desc.size = 1024;
+    for (uint32_t i = 0; i < MeshCount; ++i) {
+        scene.vertexBuffers.push_back(std::move(*device.CreateBuffer(desc)));
+        scene.indexBuffers.push_back(std::move(*device.CreateBuffer(desc)));
+    }
+    desc.size = options->objects * UniformStride;
+    desc.usage = VRHI::BufferUsage::Uniform;
+    scene.uniforms = std::move(*device.CreateBuffer(desc));
+
+    auto cmd = device.CreateCommandBuffer();
+    VRHI::CommandBuffer& virtualRecorder = *cmd;
+    VRHI::CommandRecorder& recorder = VRHI::Devirtualize(*cmd);
+
+    const double virtualNs = Measure(virtualRecorder, scene, *options);
+    const double devirtualizedNs = Measure(recorder, scene, *options);
+
+#if VRHI_DEVIRTUALIZE
+    std::printf("VRHI_DEVIRTUALIZE: ON\n");
+#else
+    std::printf("VRHI_DEVIRTUALIZE: OFF\n");
+#endif
+    std::printf("%u objects, %u commands per frame, best of %u loops\n\n",
+                options->objects, options->objects * CommandsPerObject, options->loops);
+    std::printf("%-18s %10s\n", "path", "ns/command");
+    std::printf("%-18s %10.2f\n", "CommandBuffer&", virtualNs);
+    std::printf("%-18s %10.2f\n", "Devirtualize()", devirtualizedNs);
+    std::printf("\nspeedup: %.2fx\n", virtualNs / devirtualizedNs);
+    return 0;
+}
@@ -0,0 +1,209 @@
+// Copyright (c) 2024 Lazy_V
+// SPDX-License-Identifier: MIT
+
+// vrhi-replay: replays a trace written by VRHI::CreateCaptureDevice() in a
+// loop and reports the CPU time spent per frame.
+//
+// Usage: vrhi-replay <trace> [--backend null|auto|vulkan|opengl33|...] [--loops N] [--warmup N]
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <VRHI/Capture.hpp>
+#include <VRHI/VRHI.hpp>
+#include <VRHI/Window.hpp>
+
+#include "../../src/Core/NullDevice.hpp"
+
+namespace {
+
+struct Options {
+    const char* tracePath = nullptr;
+    std::optional<VRHI::BackendType> backend;  // Empty: NullDevice
+    uint32_t loops = 100;
+    uint32_t warmupLoops = 1;
+};
+
+std::optional<VRHI::BackendType> ParseBackend(std::string_view name, bool& valid) {
+    struct Entry { std::string_view name; VRHI::BackendType type; };
+    static constexpr Entry Backends[] = {
+        {"auto", VRHI::BackendType::Auto},
+        {"vulkan", VRHI::BackendType::Vulkan},
+        {"opengl46", VRHI::BackendType::OpenGL46},
+        {"opengl41", VRHI::BackendType::OpenGL41},
+        {"opengl33", VRHI::BackendType::OpenGL33},
+        {"opengles31", VRHI::BackendType::OpenGLES31},
+        {"opengles30", VRHI::BackendType::OpenGLES30},
+        {"software", VRHI::BackendType::Software},
+    };
+
+    valid = true;
+    if (name == "null") {
+        return std::nullopt;
+    }
+    for (const Entry& entry : Backends) {
+        if (entry.name == name) {
+            return entry.type;
+        }
+    }
+    valid = false;
+    return std::nullopt;
+}
+
+bool ParseCount(const char* text, uint32_t& value) {
+    const char* end = text + std::strlen(text);
+    auto [ptr, ec] = std::from_chars(text, end, value);
+    return ec == std::errc{} && ptr == end;
+}
+
+void PrintUsage() {
+    std::cerr << "Usage: vrhi-replay <trace> [--backend null|auto|vulkan|opengl33|...] [--loops N] [--warmup N]\n"
+              << "  --backend  Device to replay on (default: null, no graphics API calls)\n"
+              << "  --loops    Timed passes over all frames of the trace (default: 100)\n"
+              << "  --warmup   Untimed passes before measuring (default: 1)\n";
+}
+
+std::optional<Options> ParseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--backend" && hasValue) {
+            bool valid = false;
+            options.backend = ParseBackend(argv[++i], valid);
+            if (!valid) {
+                std::cerr << "Unknown backend: " << argv[i] << "\n";
+                return std::nullopt;
+            }
+        } else if (arg == "--loops" && hasValue) {
+            if (!ParseCount(argv[++i], options.loops) || options.loops == 0) {
+                std::cerr << "Invalid loop count: " << argv[i] << "\n";
+                return std::nullopt;
+            }
+        } else if (arg == "--warmup" && hasValue) {
+            if (!ParseCount(argv[++i], options.warmupLoops)) {
+                std::cerr << "Invalid warmup count: " << argv[i] << "\n";
+                return std::nullopt;
+            }
+        } else if (!arg.starts_with("--") && !options.tracePath) {
+            options.tracePath = argv[i];
+        } else {
+            return std::nullopt;
+        }
+    }
+    if (!options.tracePath) {
+        return std::nullopt;
+    }
+    return options;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    const auto options = ParseOptions(argc, argv);
+    if (!options) {
+        PrintUsage();
+        return 1;
+    }
+
+    auto playerResult = VRHI::TracePlayer::Load(options->tracePath);
+    if (!playerResult) {
+        std::cerr << "Failed to load trace: " << playerResult.error().message << "\n";
+        return 1;
+    }
+    auto player = std::move(*playerResult);
+    const VRHI::TraceStats& stats = player->GetStats();
+    if (stats.frameCount == 0) {
+        std::cerr << "Trace contains no frames\n";
+        return 1;
+    }
+
+    // OpenGL backends need a context, which comes with a (hidden) window;
+    // Vulkan runs headless
+    std::unique_ptr<VRHI::IWindow> window;
+    std::unique_ptr<VRHI::Device> device;
+    if (options->backend) {
+        VRHI::DeviceConfig deviceConfig{};
+        deviceConfig.preferredBackend = *options->backend;
+        if (*options->backend != VRHI::BackendType::Vulkan) {
+            VRHI::WindowConfig windowConfig{};
+            windowConfig.title = "vrhi-replay";
+            windowConfig.visible = false;
+            auto windowResult = VRHI::CreateWindow(windowConfig);
+            if (!windowResult) {
+                std::cerr << "Failed to create window: " << windowResult.error().message << "\n";
+                return 1;
+            }
+            window = std::move(*windowResult);
+            deviceConfig.windowHandle = window->GetNativeHandle();
+        }
+        auto deviceResult = VRHI::CreateDevice(deviceConfig);
+        if (!deviceResult) {
+            std::cerr << "Failed to create device: " << deviceResult.error().message << "\n";
+            return 1;
+        }
+        device = std::move(*deviceResult);
+    } else {
+        device = std::make_unique<VRHI::NullDevice>();
+    }
+
+    if (auto prepared = player->Prepare(*device); !prepared) {
+        std::cerr << "Failed to prepare trace: " << prepared.error().message << "\n";
+        return 1;
+    }
+
+    std::cout << "Trace:    " << options->tracePath << "\n"
+              << "Device:   " << device->GetProperties().deviceName << "\n"
+              << "Frames:   " << stats.frameCount << "\n"
+              << "Objects:  " << stats.resourceCount << " resources, "
+              << stats.commandBufferCount << " command buffers\n"
+              << "Commands: " << stats.commandCount << " (" << stats.uploadBytes << " upload bytes)\n\n";
+
+    for (uint32_t loop = 0; loop < options->warmupLoops; ++loop) {
+        for (uint32_t frame = 0; frame < stats.frameCount; ++frame) {
+            player->ReplayFrame(frame);
+        }
+    }
+
+    // Per frame of the trace: total, min and max CPU time over all loops
+    using Clock = std::chrono::steady_clock;
+    struct FrameTiming {
+        double total = 0.0;
+        double min = 1e300;
+        double max = 0.0;
+    };
+    std::vector<FrameTiming> timings(stats.frameCount);
+
+    for (uint32_t loop = 0; loop < options->loops; ++loop) {
+        for (uint32_t frame = 0; frame < stats.frameCount; ++frame) {
+            const auto start = Clock::now();
+            player->ReplayFrame(frame);
+            const double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+            FrameTiming& timing = timings[frame];
+            timing.total += us;
+            timing.min = std::min(timing.min, us);
+            timing.max = std::max(timing.max, us);
+        }
+    }
+
+    std::printf("%8s %12s %12s %12s\n", "frame", "avg (us)", "min (us)", "max (us)");
+    double total = 0.0;
+    for (uint32_t frame = 0; frame < stats.frameCount; ++frame) {
+        const FrameTiming& timing = timings[frame];
+        total += timing.total;
+        std::printf("%8u %12.2f %12.2f %12.2f\n", frame, timing.total / options->loops, timing.min, timing.max);
+    }
+
+    const double average = total / (static_cast<double>(options->loops) * stats.frameCount);
+    std::printf("\n%u loops, %.2f us per frame on average (%.0f frames/s)\n",
+                options->loops, average, average > 0.0 ? 1e6 / average : 0.0);
+    return 0;
+}